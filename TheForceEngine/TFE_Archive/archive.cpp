@@ -1,4 +1,5 @@
 #include <cstring>
+#include <cctype>
 
 #include "archive.h"
 #include "gobArchive.h"
@@ -176,3 +177,61 @@ void Archive::deleteCustomArchive(Archive* archive)
 	}
 	delete archive;
 }
+
+// Case-insensitive FNV-1a, names are hashed as upper case.
+static u32 hashFileName(const char* name)
+{
+	u32 hash = 2166136261u;
+	for (; *name; name++)
+	{
+		hash ^= u32(toupper((u8)*name));
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+void Archive::buildFileIndex()
+{
+	const u32 count = getFileCount();
+	u32 tableSize = 16;
+	while (tableSize < count * 2) { tableSize <<= 1; }
+	m_fileHash.assign(tableSize, INVALID_FILE);
+
+	const u32 mask = tableSize - 1;
+	for (u32 i = 0; i < count; i++)
+	{
+		const char* name = getFileName(i);
+		// Keep the first file with a given name, which is what the linear search returned.
+		if (!name || findFileIndex(name) != INVALID_FILE) { continue; }
+
+		u32 slot = hashFileName(name) & mask;
+		while (m_fileHash[slot] != INVALID_FILE)
+		{
+			slot = (slot + 1) & mask;
+		}
+		m_fileHash[slot] = i;
+	}
+}
+
+void Archive::clearFileIndex()
+{
+	m_fileHash.clear();
+}
+
+u32 Archive::findFileIndex(const char* file)
+{
+	if (m_fileHash.empty()) { return INVALID_FILE; }
+
+	const u32 mask = u32(m_fileHash.size()) - 1;
+	u32 slot = hashFileName(file) & mask;
+	while (m_fileHash[slot] != INVALID_FILE)
+	{
+		const u32 index = m_fileHash[slot];
+		if (strcasecmp(file, getFileName(index)) == 0)
+		{
+			return index;
+		}
+		slot = (slot + 1) & mask;
+	}
+	return INVALID_FILE;
+}
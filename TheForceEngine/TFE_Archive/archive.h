@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdio>
+#include <vector>
 
 #include <TFE_System/types.h>
 #include <TFE_FileSystem/paths.h>
@@ -60,9 +61,19 @@ public:
 	virtual const char* getFileName(u32 index) = 0;
 	virtual size_t getFileLength(u32 index) = 0;
 
+	// Zero-copy access to the file data, valid until the archive is closed or edited.
+	// Returns nullptr if the archive cannot provide the data in place, read it with openFile()/readFile() instead.
+	virtual const u8* getFileData(u32 index, size_t* length) { return nullptr; }
+
 	// Edit
 	virtual void addFile(const char* fileName, const char* filePath) = 0;
 
+	// Case-insensitive name -> index lookup, built from getFileCount() and getFileName().
+protected:
+	void buildFileIndex();
+	void clearFileIndex();
+	u32  findFileIndex(const char* file);
+
 	// Shared Private State
 protected:
 	ArchiveType m_type;
@@ -70,4 +81,6 @@ protected:
 	char m_archivePath[TFE_MAX_PATH];
 
 	s32 m_fileOffset;
+	// Open addressing hash table of file indices, INVALID_FILE marks an empty slot.
+	std::vector<u32> m_fileHash;
 };
@@ -53,12 +53,21 @@ bool GobArchive::open(const char *archivePath)
 	strcpy(m_archivePath, archivePath);
 	m_file.close();
 
+	// Map the archive once so files can be read without reopening it, if this fails files are read through m_file.
+	if (!m_mapping.open(archivePath))
+	{
+		TFE_System::logWrite(LOG_WARNING, "GOB", "Cannot memory map \"%s\", files will be read from disk.", archivePath);
+	}
+	buildFileIndex();
+
 	return true;
 }
 
 void GobArchive::close()
 {
 	m_file.close();
+	m_mapping.close();
+	clearFileIndex();
 	m_archiveOpen = false;
 	delete[] m_fileList.entries;
 	m_fileList.entries = nullptr;
@@ -69,30 +78,15 @@ bool GobArchive::openFile(const char *file)
 {
 	if (!m_archiveOpen) { return false; }
 
-	m_file.open(m_archivePath, FileStream::MODE_READ);
-	m_curFile = -1;
-	m_fileOffset = 0;
-
-	//search for this file.
-	for (s32 i = 0; i < m_fileList.MASTERN; i++)
+	const u32 index = findFileIndex(file);
+	if (index == INVALID_FILE)
 	{
-		if (strcasecmp(file, m_fileList.entries[i].NAME) == 0)
-		{
-			m_curFile = i;
-			break;
-		}
-	}
-
-	if (m_curFile == -1)
-	{
-		m_file.close();
+		m_curFile = -1;
+		m_fileOffset = 0;
 		TFE_System::logWrite(LOG_ERROR, "GOB", "Failed to load \"%s\" from \"%s\"", file, m_archivePath);
+		return false;
 	}
-	else
-	{
-		m_file.seek(m_fileList.entries[m_curFile].IX);
-	}
-	return m_curFile > -1 ? true : false;
+	return openFile(index);
 }
 
 bool GobArchive::openFile(u32 index)
@@ -101,8 +95,11 @@ bool GobArchive::openFile(u32 index)
 
 	m_curFile = s32(index);
 	m_fileOffset = 0;
-	m_file.open(m_archivePath, FileStream::MODE_READ);
-	m_file.seek(m_fileList.entries[m_curFile].IX);
+	if (!m_mapping.isOpen())
+	{
+		m_file.open(m_archivePath, FileStream::MODE_READ);
+		m_file.seek(m_fileList.entries[m_curFile].IX);
+	}
 	return true;
 }
 
@@ -115,32 +112,14 @@ void GobArchive::closeFile()
 u32 GobArchive::getFileIndex(const char* file)
 {
 	if (!m_archiveOpen) { return INVALID_FILE; }
-
-	//search for this file.
-	for (s32 i = 0; i < m_fileList.MASTERN; i++)
-	{
-		if (strcasecmp(file, m_fileList.entries[i].NAME) == 0)
-		{
-			return i;
-		}
-	}
-	return INVALID_FILE;
+	return findFileIndex(file);
 }
 
 bool GobArchive::fileExists(const char *file)
 {
 	if (!m_archiveOpen) { return false; }
 	m_curFile = -1;
-
-	//search for this file.
-	for (s32 i = 0; i < m_fileList.MASTERN; i++)
-	{
-		if (strcasecmp(file, m_fileList.entries[i].NAME) == 0)
-		{
-			return true;
-		}
-	}
-	return false;
+	return findFileIndex(file) != INVALID_FILE;
 }
 
 bool GobArchive::fileExists(u32 index)
@@ -161,7 +140,17 @@ size_t GobArchive::readFile(void *data, size_t size)
 	if (size == 0) { size = m_fileList.entries[m_curFile].LEN; }
 	const size_t sizeToRead = std::min(size, (size_t)m_fileList.entries[m_curFile].LEN);
 
-	u32 bytesRead = m_file.readBuffer(data, (u32)sizeToRead);
+	size_t bytesRead;
+	if (m_mapping.isOpen())
+	{
+		const size_t start = std::min(size_t(m_fileList.entries[m_curFile].IX) + m_fileOffset, m_mapping.size());
+		bytesRead = std::min(sizeToRead, m_mapping.size() - start);
+		memcpy(data, m_mapping.data() + start, bytesRead);
+	}
+	else
+	{
+		bytesRead = m_file.readBuffer(data, (u32)sizeToRead);
+	}
 	m_fileOffset += (s32)sizeToRead;
 	return bytesRead;
 }
@@ -193,7 +182,10 @@ bool GobArchive::seekFile(s32 offset, s32 origin)
 		return false;
 	}
 
-	m_file.seek(m_fileList.entries[m_curFile].IX + m_fileOffset);
+	if (!m_mapping.isOpen())
+	{
+		m_file.seek(m_fileList.entries[m_curFile].IX + m_fileOffset);
+	}
 	return true;
 }
 
@@ -221,6 +213,17 @@ size_t GobArchive::getFileLength(u32 index)
 	return m_fileList.entries[index].LEN;
 }
 
+const u8* GobArchive::getFileData(u32 index, size_t* length)
+{
+	if (!m_archiveOpen || !m_mapping.isOpen() || index >= getFileCount()) { return nullptr; }
+
+	const GOB_Entry_t* entry = &m_fileList.entries[index];
+	if (entry->IX < 0 || entry->LEN < 0 || size_t(entry->IX) + size_t(entry->LEN) > m_mapping.size()) { return nullptr; }
+
+	if (length) { *length = size_t(entry->LEN); }
+	return m_mapping.data() + entry->IX;
+}
+
 // Edit
 void GobArchive::addFile(const char* fileName, const char* filePath)
 {
@@ -243,6 +246,10 @@ void GobArchive::addFile(const char* fileName, const char* filePath)
 	strcpy(newFile->NAME, fileName);
 	m_header.MASTERX += newFile->LEN;
 
+	// The archive is rewritten below, so it cannot stay mapped.
+	const bool wasMapped = m_mapping.isOpen();
+	m_mapping.close();
+
 	// Read all of the file data.
 	std::vector<std::vector<u8>> fileData(m_fileList.MASTERN);
 	if (m_file.open(m_archivePath, FileStream::MODE_READ))
@@ -273,4 +280,11 @@ void GobArchive::addFile(const char* fileName, const char* filePath)
 		m_file.writeBuffer(m_fileList.entries, sizeof(GOB_Entry_t), m_fileList.MASTERN);
 		m_file.close();
 	}
+
+	if (wasMapped)
+	{
+		m_mapping.open(m_archivePath);
+	}
+	buildFileIndex();
+	TFE_Paths::onArchiveChanged(this);
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include <TFE_System/types.h>
 #include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/memoryMappedFile.h>
 #include <TFE_FileSystem/paths.h>
 #include "archive.h"
 
@@ -37,6 +38,7 @@ public:
 	u32 getFileCount() override;
 	const char* getFileName(u32 index) override;
 	size_t getFileLength(u32 index) override;
+	const u8* getFileData(u32 index, size_t* length) override;
 
 	// Edit
 	void addFile(const char* fileName, const char* filePath) override;
@@ -67,6 +69,7 @@ private:
 	#pragma pack(pop)
 
 	FileStream m_file;
+	MemoryMappedFile m_mapping;
 	bool m_archiveOpen;
 
 	GOB_Header_t m_header;
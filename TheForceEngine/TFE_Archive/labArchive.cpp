@@ -36,16 +36,27 @@ bool LabArchive::open(const char *archivePath)
 	m_file.close();
 		
 	strcpy(m_archivePath, archivePath);
-	
+
+	// Map the archive once so files can be read without reopening it, if this fails files are read through m_file.
+	if (!m_mapping.open(archivePath))
+	{
+		TFE_System::logWrite(LOG_WARNING, "LAB", "Cannot memory map \"%s\", files will be read from disk.", archivePath);
+	}
+	buildFileIndex();
+
 	return true;
 }
 
 void LabArchive::close()
 {
 	m_file.close();
+	m_mapping.close();
+	clearFileIndex();
 	m_archiveOpen = false;
 	delete[] m_entries;
 	delete[] m_stringTable;
+	m_entries = nullptr;
+	m_stringTable = nullptr;
 }
 
 // File Access
@@ -53,30 +64,15 @@ bool LabArchive::openFile(const char *file)
 {
 	if (!m_archiveOpen) { return false; }
 
-	m_file.open(m_archivePath, FileStream::MODE_READ);
-	m_curFile = -1;
-	m_fileOffset = 0;
-
-	//search for this file.
-	for (u32 i = 0; i < m_header.fileCount; i++)
-	{
-		if (strcasecmp(file, &m_stringTable[m_entries[i].nameOffset]) == 0)
-		{
-			m_curFile = i;
-			break;
-		}
-	}
-
-	if (m_curFile == -1)
+	const u32 index = findFileIndex(file);
+	if (index == INVALID_FILE)
 	{
-		m_file.close();
-		TFE_System::logWrite(LOG_ERROR, "GOB", "Failed to load \"%s\" from \"%s\"", file, m_archivePath);
-	}
-	else
-	{
-		m_file.seek(m_entries[m_curFile].dataOffset);
+		m_curFile = -1;
+		m_fileOffset = 0;
+		TFE_System::logWrite(LOG_ERROR, "LAB", "Failed to load \"%s\" from \"%s\"", file, m_archivePath);
+		return false;
 	}
-	return m_curFile > -1 ? true : false;
+	return openFile(index);
 }
 
 bool LabArchive::openFile(u32 index)
@@ -85,8 +81,11 @@ bool LabArchive::openFile(u32 index)
 
 	m_curFile = s32(index);
 	m_fileOffset = 0;
-	m_file.open(m_archivePath, FileStream::MODE_READ);
-	m_file.seek(m_entries[m_curFile].dataOffset);
+	if (!m_mapping.isOpen())
+	{
+		m_file.open(m_archivePath, FileStream::MODE_READ);
+		m_file.seek(m_entries[m_curFile].dataOffset);
+	}
 	return true;
 }
 
@@ -100,32 +99,14 @@ u32 LabArchive::getFileIndex(const char* file)
 {
 	if (!m_archiveOpen) { return INVALID_FILE; }
 	m_curFile = -1;
-
-	//search for this file.
-	for (u32 i = 0; i < m_header.fileCount; i++)
-	{
-		if (strcasecmp(file, &m_stringTable[m_entries[i].nameOffset]) == 0)
-		{
-			return i;
-		}
-	}
-	return INVALID_FILE;
+	return findFileIndex(file);
 }
 
 bool LabArchive::fileExists(const char *file)
 {
 	if (!m_archiveOpen) { return false; }
 	m_curFile = -1;
-
-	//search for this file.
-	for (u32 i = 0; i < m_header.fileCount; i++)
-	{
-		if (strcasecmp(file, &m_stringTable[m_entries[i].nameOffset]) == 0)
-		{
-			return true;
-		}
-	}
-	return false;
+	return findFileIndex(file) != INVALID_FILE;
 }
 
 bool LabArchive::fileExists(u32 index)
@@ -146,7 +127,17 @@ size_t LabArchive::readFile(void *data, size_t size)
 	if (size == 0) { size = m_entries[m_curFile].len; }
 	const size_t sizeToRead = std::min(size, (size_t)m_entries[m_curFile].len);
 
-	size_t bytesRead = m_file.readBuffer(data, (u32)sizeToRead);
+	size_t bytesRead;
+	if (m_mapping.isOpen())
+	{
+		const size_t start = std::min(size_t(m_entries[m_curFile].dataOffset) + m_fileOffset, m_mapping.size());
+		bytesRead = std::min(sizeToRead, m_mapping.size() - start);
+		memcpy(data, m_mapping.data() + start, bytesRead);
+	}
+	else
+	{
+		bytesRead = m_file.readBuffer(data, (u32)sizeToRead);
+	}
 	m_fileOffset += (s32)sizeToRead;
 	return bytesRead;
 }
@@ -178,7 +169,10 @@ bool LabArchive::seekFile(s32 offset, s32 origin)
 		return false;
 	}
 
-	m_file.seek(m_entries[m_curFile].dataOffset + m_fileOffset);
+	if (!m_mapping.isOpen())
+	{
+		m_file.seek(m_entries[m_curFile].dataOffset + m_fileOffset);
+	}
 	return true;
 }
 
@@ -206,6 +200,18 @@ size_t LabArchive::getFileLength(u32 index)
 	return m_entries[index].len;
 }
 
+const u8* LabArchive::getFileData(u32 index, size_t* length)
+{
+	if (!m_archiveOpen || !m_mapping.isOpen() || index >= getFileCount()) { return nullptr; }
+
+	const size_t offset = size_t(m_entries[index].dataOffset);
+	const size_t len = size_t(m_entries[index].len);
+	if (offset + len > m_mapping.size()) { return nullptr; }
+
+	if (length) { *length = len; }
+	return m_mapping.data() + offset;
+}
+
 // Edit
 void LabArchive::addFile(const char* fileName, const char* filePath)
 {
@@ -1,13 +1,14 @@
 #pragma once
 #include <TFE_System/types.h>
 #include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/memoryMappedFile.h>
 #include <TFE_FileSystem/paths.h>
 #include "archive.h"
 
 class LabArchive : public Archive
 {
 public:
-	LabArchive() : m_archiveOpen(false), m_curFile(-1) {}
+	LabArchive() : m_archiveOpen(false), m_stringTable(nullptr), m_entries(nullptr), m_curFile(-1) {}
 	~LabArchive() override;
 
 	// Archive
@@ -33,6 +34,7 @@ public:
 	u32 getFileCount() override;
 	const char* getFileName(u32 index) override;
 	size_t getFileLength(u32 index) override;
+	const u8* getFileData(u32 index, size_t* length) override;
 
 	// Edit
 	void addFile(const char* fileName, const char* filePath) override;
@@ -58,6 +60,7 @@ private:
 	#pragma pack(pop)
 
 	FileStream m_file;
+	MemoryMappedFile m_mapping;
 	bool m_archiveOpen;
 
 	LAB_Header_t m_header;
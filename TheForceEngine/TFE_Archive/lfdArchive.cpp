@@ -63,12 +63,21 @@ bool LfdArchive::open(const char *archivePath)
 	strcpy(m_archivePath, archivePath);
 	m_file.close();
 
+	// Map the archive once so files can be read without reopening it, if this fails files are read through m_file.
+	if (!m_mapping.open(archivePath))
+	{
+		TFE_System::logWrite(LOG_WARNING, "LFD", "Cannot memory map \"%s\", files will be read from disk.", archivePath);
+	}
+	buildFileIndex();
+
 	return true;
 }
 
 void LfdArchive::close()
 {
 	m_file.close();
+	m_mapping.close();
+	clearFileIndex();
 	m_archiveOpen = false;
 
 	if (m_fileList.entries)
@@ -83,30 +92,15 @@ bool LfdArchive::openFile(const char *file)
 {
 	if (!m_archiveOpen) { return false; }
 
-	m_file.open(m_archivePath, FileStream::MODE_READ);
-	m_curFile = -1;
-	m_fileOffset = 0;
-
-	//search for this file.
-	for (s32 i = 0; i < m_fileList.MASTERN; i++)
-	{
-		if (strcasecmp(file, m_fileList.entries[i].NAME) == 0)
-		{
-			m_curFile = i;
-			break;
-		}
-	}
-
-	if (m_curFile == -1)
+	const u32 index = findFileIndex(file);
+	if (index == INVALID_FILE)
 	{
-		m_file.close();
+		m_curFile = -1;
+		m_fileOffset = 0;
 		TFE_System::logWrite(LOG_ERROR, "LFD", "Failed to load \"%s\" from \"%s\"", file, m_archivePath);
+		return false;
 	}
-	else
-	{
-		m_file.seek(m_fileList.entries[m_curFile].IX);
-	}
-	return m_curFile > -1 ? true : false;
+	return openFile(index);
 }
 
 bool LfdArchive::openFile(u32 index)
@@ -115,8 +109,11 @@ bool LfdArchive::openFile(u32 index)
 
 	m_curFile = s32(index);
 	m_fileOffset = 0;
-	m_file.open(m_archivePath, FileStream::MODE_READ);
-	m_file.seek(m_fileList.entries[m_curFile].IX);
+	if (!m_mapping.isOpen())
+	{
+		m_file.open(m_archivePath, FileStream::MODE_READ);
+		m_file.seek(m_fileList.entries[m_curFile].IX);
+	}
 	return true;
 }
 
@@ -130,32 +127,14 @@ u32 LfdArchive::getFileIndex(const char* file)
 {
 	if (!m_archiveOpen) { return INVALID_FILE; }
 	m_curFile = -1;
-
-	//search for this file.
-	for (s32 i = 0; i < m_fileList.MASTERN; i++)
-	{
-		if (strcasecmp(file, m_fileList.entries[i].NAME) == 0)
-		{
-			return i;
-		}
-	}
-	return INVALID_FILE;
+	return findFileIndex(file);
 }
 
 bool LfdArchive::fileExists(const char *file)
 {
 	if (!m_archiveOpen) { return false; }
 	m_curFile = -1;
-
-	//search for this file.
-	for (s32 i = 0; i < m_fileList.MASTERN; i++)
-	{
-		if (strcasecmp(file, m_fileList.entries[i].NAME) == 0)
-		{
-			return true;
-		}
-	}
-	return false;
+	return findFileIndex(file) != INVALID_FILE;
 }
 
 bool LfdArchive::fileExists(u32 index)
@@ -176,7 +155,17 @@ size_t LfdArchive::readFile(void *data, size_t size)
 	if (size == 0) { size = m_fileList.entries[m_curFile].LENGTH; }
 	const size_t sizeToRead = std::min(size, (size_t)m_fileList.entries[m_curFile].LENGTH);
 
-	size_t bytesRead = m_file.readBuffer(data, (u32)sizeToRead);
+	size_t bytesRead;
+	if (m_mapping.isOpen())
+	{
+		const size_t start = std::min(size_t(m_fileList.entries[m_curFile].IX) + m_fileOffset, m_mapping.size());
+		bytesRead = std::min(sizeToRead, m_mapping.size() - start);
+		memcpy(data, m_mapping.data() + start, bytesRead);
+	}
+	else
+	{
+		bytesRead = m_file.readBuffer(data, (u32)sizeToRead);
+	}
 	m_fileOffset += (s32)sizeToRead;
 	return bytesRead;
 }
@@ -208,7 +197,10 @@ bool LfdArchive::seekFile(s32 offset, s32 origin)
 		return false;
 	}
 
-	m_file.seek(m_fileList.entries[m_curFile].IX + m_fileOffset);
+	if (!m_mapping.isOpen())
+	{
+		m_file.seek(m_fileList.entries[m_curFile].IX + m_fileOffset);
+	}
 	return true;
 }
 
@@ -236,6 +228,18 @@ size_t LfdArchive::getFileLength(u32 index)
 	return m_fileList.entries[index].LENGTH;
 }
 
+const u8* LfdArchive::getFileData(u32 index, size_t* length)
+{
+	if (!m_archiveOpen || !m_mapping.isOpen() || index >= getFileCount()) { return nullptr; }
+
+	const size_t offset = size_t(m_fileList.entries[index].IX);
+	const size_t len = size_t(m_fileList.entries[index].LENGTH);
+	if (offset + len > m_mapping.size()) { return nullptr; }
+
+	if (length) { *length = len; }
+	return m_mapping.data() + offset;
+}
+
 // Edit
 void LfdArchive::addFile(const char* fileName, const char* filePath)
 {
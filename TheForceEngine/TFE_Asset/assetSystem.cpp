@@ -1,6 +1,8 @@
 #include "assetSystem.h"
 #include <TFE_System/system.h>
+#include <TFE_System/jobSystem.h>
 #include <TFE_Archive/archive.h>
+#include <TFE_FileSystem/filestream.h>
 
 namespace TFE_AssetSystem
 {
@@ -111,4 +113,57 @@ namespace TFE_AssetSystem
 		}
 		return false;
 	}
+
+	struct AssetListJob
+	{
+		const FilePath* paths;
+		AssetData* assets;
+	};
+
+	bool readAssetFile(const FilePath* path, AssetData* asset)
+	{
+		FileStream file;
+		if (!file.open(path, FileStream::MODE_READ))
+		{
+			return false;
+		}
+		asset->size = file.getSize();
+		asset->buffer.resize(asset->size);
+		file.readBuffer(asset->buffer.data(), (u32)asset->size);
+		file.close();
+		asset->data = asset->buffer.data();
+		return true;
+	}
+
+	void readAssetListJob(s32 index, void* userData)
+	{
+		AssetListJob* job = (AssetListJob*)userData;
+		const FilePath* path = &job->paths[index];
+		// Loose files only, opening a file inside of an archive is not thread safe.
+		if (!path->archive && path->path[0])
+		{
+			readAssetFile(path, &job->assets[index]);
+		}
+	}
+
+	void readAssetList(const FilePath* paths, s32 count, AssetData* assets)
+	{
+		for (s32 i = 0; i < count; i++)
+		{
+			AssetData* asset = &assets[i];
+			asset->data = nullptr;
+			asset->size = 0;
+			if (!paths[i].archive) { continue; }
+
+			// Archive files are read in place when the archive is memory mapped.
+			asset->data = paths[i].archive->getFileData(paths[i].index, &asset->size);
+			if (!asset->data)
+			{
+				readAssetFile(&paths[i], asset);
+			}
+		}
+
+		AssetListJob job = { paths, assets };
+		TFE_Jobs::run(readAssetListJob, &job, count);
+	}
 }
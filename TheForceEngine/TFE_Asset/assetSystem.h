@@ -5,10 +5,19 @@
 //////////////////////////////////////////////////////////////////////
 #include <TFE_System/types.h>
 #include <TFE_Archive/archive.h>
+#include <TFE_FileSystem/paths.h>
 #include <vector>
 
 namespace TFE_AssetSystem
 {
+	// File contents read by readAssetList(), pointing either into a memory mapped archive or into 'buffer'.
+	struct AssetData
+	{
+		const u8* data;
+		size_t size;
+		std::vector<u8> buffer;
+	};
+
 	void setCustomArchive(Archive* archive);
 	void clearCustomArchive();
 
@@ -17,4 +26,8 @@ namespace TFE_AssetSystem
 	bool readAssetFromArchive(const char* defaultArchive, ArchiveType type, const char* filename, std::vector<char>& buffer);
 	bool readAssetFromArchive(const char* defaultArchive, const char* filename, std::vector<u8>& buffer);
 	bool readAssetFromArchive(const char* defaultArchive, const char* filename, std::vector<char>& buffer);
+
+	// Read a list of files, loose files are read in parallel on the job workers.
+	// Entries with an empty path or that cannot be read get a null data pointer.
+	void readAssetList(const FilePath* paths, s32 count, AssetData* assets);
 }
@@ -2,6 +2,8 @@
 
 #include "dfKeywords.h"
 #include <TFE_System/system.h>
+#include <algorithm>
+#include <assert.h>
 
 // These strings are taken directly from the Dark Forces EXE.
 static const char* c_keywords[] =
@@ -229,7 +231,104 @@ static const char* c_keywords[] =
 
 #define KEYWORD_COUNT TFE_ARRAYSIZE(c_keywords)
 
+// Keywords are looked up through a minimal collision-free hash built from c_keywords, two hashes and one
+// string compare per lookup instead of a linear search. The table is built once, on first use.
+namespace
+{
+	enum
+	{
+		KEYWORD_HASH_SLOTS = 512,
+		KEYWORD_HASH_BUCKETS = 128,
+		KEYWORD_HASH_EMPTY = 0xffff,
+	};
+
+	struct KeywordHash
+	{
+		u16 displacement[KEYWORD_HASH_BUCKETS];
+		u16 slot[KEYWORD_HASH_SLOTS];
+	};
+
+	// Case insensitive FNV-1a.
+	u32 keywordHash(const char* str, u32 seed)
+	{
+		u32 hash = 2166136261u ^ (seed * 0x9e3779b9u);
+		for (; *str; str++)
+		{
+			const u32 c = (*str >= 'a' && *str <= 'z') ? u32(*str - 'a' + 'A') : u32(u8(*str));
+			hash = (hash ^ c) * 16777619u;
+		}
+		return hash ^ (hash >> 15);
+	}
+
+	KeywordHash buildKeywordHash()
+	{
+		KeywordHash table;
+		memset(table.displacement, 0, sizeof(table.displacement));
+		memset(table.slot, 0xff, sizeof(table.slot));
+
+		// Sort keywords into buckets, duplicate keywords resolve to the first entry like the original search.
+		std::vector<u16> buckets[KEYWORD_HASH_BUCKETS];
+		for (s32 i = 0; i < (s32)KEYWORD_COUNT; i++)
+		{
+			bool duplicate = false;
+			for (s32 k = 0; k < i && !duplicate; k++)
+			{
+				duplicate = strcasecmp(c_keywords[i], c_keywords[k]) == 0;
+			}
+			if (!duplicate)
+			{
+				buckets[keywordHash(c_keywords[i], 0) & (KEYWORD_HASH_BUCKETS - 1)].push_back(u16(i));
+			}
+		}
+
+		// Place the largest buckets first, searching for a displacement that puts every keyword into an empty slot.
+		u16 order[KEYWORD_HASH_BUCKETS];
+		for (u16 b = 0; b < KEYWORD_HASH_BUCKETS; b++) { order[b] = b; }
+		std::stable_sort(order, order + KEYWORD_HASH_BUCKETS, [&](u16 a, u16 b) { return buckets[a].size() > buckets[b].size(); });
+
+		for (u32 b = 0; b < KEYWORD_HASH_BUCKETS; b++)
+		{
+			const std::vector<u16>& bucket = buckets[order[b]];
+			if (bucket.empty()) { break; }
+
+			u32 slots[KEYWORD_HASH_SLOTS];
+			for (u32 d = 1; d < 0xffff; d++)
+			{
+				bool fits = true;
+				for (size_t k = 0; k < bucket.size() && fits; k++)
+				{
+					slots[k] = keywordHash(c_keywords[bucket[k]], d) & (KEYWORD_HASH_SLOTS - 1);
+					fits = table.slot[slots[k]] == KEYWORD_HASH_EMPTY;
+					for (size_t j = 0; j < k && fits; j++) { fits = slots[j] != slots[k]; }
+				}
+				if (fits)
+				{
+					table.displacement[order[b]] = u16(d);
+					for (size_t k = 0; k < bucket.size(); k++) { table.slot[slots[k]] = bucket[k]; }
+					break;
+				}
+			}
+			assert(table.displacement[order[b]]);
+		}
+		return table;
+	}
+}
+
 KEYWORD getKeywordIndex(const char* keywordString)
+{
+	static const KeywordHash s_keywordHash = buildKeywordHash();
+
+	const u32 displacement = s_keywordHash.displacement[keywordHash(keywordString, 0) & (KEYWORD_HASH_BUCKETS - 1)];
+	const u16 index = s_keywordHash.slot[keywordHash(keywordString, displacement) & (KEYWORD_HASH_SLOTS - 1)];
+	if (index == KEYWORD_HASH_EMPTY || strcasecmp(keywordString, c_keywords[index]))
+	{
+		return KW_UNKNOWN;
+	}
+	return KEYWORD(index);
+}
+
+// Reference linear search, used to validate the hash table.
+KEYWORD getKeywordIndexLinear(const char* keywordString)
 {
 	s32 result = -1;
 	for (s32 i = 0; i < KEYWORD_COUNT; i++)
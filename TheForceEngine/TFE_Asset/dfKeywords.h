@@ -235,4 +235,6 @@ enum KEYWORD
 	KW_COUNT
 };
 
-extern KEYWORD getKeywordIndex(const char* keywordString);
\ No newline at end of file
+extern KEYWORD getKeywordIndex(const char* keywordString);
+// Reference linear search, used to validate the hash table used by getKeywordIndex().
+extern KEYWORD getKeywordIndexLinear(const char* keywordString);
@@ -1,3 +1,5 @@
+#include <cstring>
+
 #include "gifWriter.h"
 #include <TFE_System/system.h>
 #include <TFE_FileSystem/filestream.h>
@@ -65,4 +67,269 @@ namespace TFE_GIF
 		msf_gif_free(result);
 		return true;
 	}
-}
\ No newline at end of file
+
+	/////////////////////////////////////////////
+	// Indexed GIF
+	// Frames are stored as 8-bit indices with LZW, so
+	// unlike msf_gif there is no color quantization.
+	// Only the rectangle that changed since the previous
+	// frame is encoded, unless the palette changes.
+	/////////////////////////////////////////////
+	enum
+	{
+		GIF_MIN_CODE_SIZE = 8,
+		GIF_CLEAR_CODE = 1 << GIF_MIN_CODE_SIZE,
+		GIF_LZW_MAX_CODE = 4095,
+		GIF_LZW_HASH_BITS = 13,
+		GIF_LZW_HASH_SIZE = 1 << GIF_LZW_HASH_BITS,
+		GIF_BLOCK_SIZE = 255,
+	};
+
+	struct IndexedGif
+	{
+		FileStream file;
+		u32 width;
+		u32 height;
+		u32 globalPalette[256];
+		u32 palette[256];
+		std::vector<u8> prevFrame;
+		bool hasPrevFrame;
+
+		// Output for the current frame.
+		std::vector<u8> output;
+		u8  block[GIF_BLOCK_SIZE];
+		u32 blockSize;
+		u32 bitBuffer;
+		u32 bitCount;
+
+		// LZW dictionary: key = (prefix code << 8) | index, stored as key + 1 so zero is empty.
+		u32 hashKey[GIF_LZW_HASH_SIZE];
+		u16 hashCode[GIF_LZW_HASH_SIZE];
+	};
+	static IndexedGif s_indexedGif;
+
+	void putU16(std::vector<u8>& out, u32 value)
+	{
+		out.push_back(u8(value));
+		out.push_back(u8(value >> 8));
+	}
+
+	void putPalette(std::vector<u8>& out, const u32* palette)
+	{
+		for (s32 i = 0; i < 256; i++)
+		{
+			out.push_back(u8(palette[i]));
+			out.push_back(u8(palette[i] >> 8));
+			out.push_back(u8(palette[i] >> 16));
+		}
+	}
+
+	void lzwFlushBlock()
+	{
+		if (!s_indexedGif.blockSize) { return; }
+		s_indexedGif.output.push_back(u8(s_indexedGif.blockSize));
+		s_indexedGif.output.insert(s_indexedGif.output.end(), s_indexedGif.block, s_indexedGif.block + s_indexedGif.blockSize);
+		s_indexedGif.blockSize = 0;
+	}
+
+	void lzwWriteCode(u32 code, u32 codeSize)
+	{
+		s_indexedGif.bitBuffer |= code << s_indexedGif.bitCount;
+		s_indexedGif.bitCount += codeSize;
+		while (s_indexedGif.bitCount >= 8)
+		{
+			s_indexedGif.block[s_indexedGif.blockSize++] = u8(s_indexedGif.bitBuffer);
+			if (s_indexedGif.blockSize == GIF_BLOCK_SIZE) { lzwFlushBlock(); }
+
+			s_indexedGif.bitBuffer >>= 8;
+			s_indexedGif.bitCount -= 8;
+		}
+	}
+
+	void lzwClearDictionary()
+	{
+		memset(s_indexedGif.hashKey, 0, sizeof(s_indexedGif.hashKey));
+	}
+
+	// Returns the slot holding the key, or the empty slot where it should be inserted.
+	u32 lzwFindSlot(u32 key)
+	{
+		u32 slot = (key * 2654435761u) >> (32 - GIF_LZW_HASH_BITS);
+		while (s_indexedGif.hashKey[slot] && s_indexedGif.hashKey[slot] != key + 1)
+		{
+			slot = (slot + 1) & (GIF_LZW_HASH_SIZE - 1);
+		}
+		return slot;
+	}
+
+	void lzwEncode(const u8* pixels, u32 stride, u32 width, u32 height)
+	{
+		u32 codeSize = GIF_MIN_CODE_SIZE + 1;
+		u32 maxCode = GIF_CLEAR_CODE + 1;
+		s_indexedGif.blockSize = 0;
+		s_indexedGif.bitBuffer = 0;
+		s_indexedGif.bitCount = 0;
+		lzwClearDictionary();
+
+		s_indexedGif.output.push_back(GIF_MIN_CODE_SIZE);
+		lzwWriteCode(GIF_CLEAR_CODE, codeSize);
+
+		s32 curCode = -1;
+		for (u32 y = 0; y < height; y++, pixels += stride)
+		{
+			for (u32 x = 0; x < width; x++)
+			{
+				const u32 value = pixels[x];
+				if (curCode < 0)
+				{
+					curCode = value;
+					continue;
+				}
+
+				const u32 key = (u32(curCode) << 8) | value;
+				const u32 slot = lzwFindSlot(key);
+				if (s_indexedGif.hashKey[slot])
+				{
+					curCode = s_indexedGif.hashCode[slot];
+					continue;
+				}
+
+				lzwWriteCode(curCode, codeSize);
+				s_indexedGif.hashKey[slot] = key + 1;
+				s_indexedGif.hashCode[slot] = u16(++maxCode);
+				if (maxCode >= (1u << codeSize))
+				{
+					codeSize++;
+				}
+				if (maxCode == GIF_LZW_MAX_CODE)
+				{
+					lzwWriteCode(GIF_CLEAR_CODE, codeSize);
+					lzwClearDictionary();
+					codeSize = GIF_MIN_CODE_SIZE + 1;
+					maxCode = GIF_CLEAR_CODE + 1;
+				}
+				curCode = value;
+			}
+		}
+
+		lzwWriteCode(curCode, codeSize);
+		lzwWriteCode(GIF_CLEAR_CODE, codeSize);
+		lzwWriteCode(GIF_CLEAR_CODE + 1, GIF_MIN_CODE_SIZE + 1);
+		if (s_indexedGif.bitCount)
+		{
+			lzwWriteCode(0, 8 - s_indexedGif.bitCount);
+		}
+		lzwFlushBlock();
+		s_indexedGif.output.push_back(0);
+	}
+
+	bool startIndexedGif(const char* path, u32 width, u32 height, const u32* palette)
+	{
+		if (!s_indexedGif.file.open(path, FileStream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_ERROR, "GIF", "Cannot open '%s' for writing.", path);
+			return false;
+		}
+		s_indexedGif.width = width;
+		s_indexedGif.height = height;
+		s_indexedGif.prevFrame.resize(width * height);
+		s_indexedGif.hasPrevFrame = false;
+		memcpy(s_indexedGif.globalPalette, palette, sizeof(u32) * 256);
+		memcpy(s_indexedGif.palette, palette, sizeof(u32) * 256);
+
+		// Header, logical screen with a 256 color global table and the looping extension.
+		std::vector<u8>& out = s_indexedGif.output;
+		out.clear();
+		const u8 header[] = { 'G', 'I', 'F', '8', '9', 'a' };
+		out.insert(out.end(), header, header + sizeof(header));
+		putU16(out, width);
+		putU16(out, height);
+		out.push_back(0xf7);
+		out.push_back(0);
+		out.push_back(0);
+		putPalette(out, palette);
+
+		const u8 loop[] = { 0x21, 0xff, 0x0b, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 0x03, 0x01, 0x00, 0x00, 0x00 };
+		out.insert(out.end(), loop, loop + sizeof(loop));
+		s_indexedGif.file.writeBuffer(out.data(), (u32)out.size());
+		return true;
+	}
+
+	void addIndexedFrame(const u8* pixels, const u32* palette, u32 delayCentiseconds)
+	{
+		const u32 width = s_indexedGif.width;
+		const u32 height = s_indexedGif.height;
+		const bool paletteChanged = palette && memcmp(palette, s_indexedGif.palette, sizeof(u32) * 256) != 0;
+		if (paletteChanged)
+		{
+			memcpy(s_indexedGif.palette, palette, sizeof(u32) * 256);
+		}
+
+		// Find the rectangle that changed, the previous frame is left in place outside of it.
+		u32 x0 = 0, y0 = 0, x1 = width, y1 = height;
+		if (s_indexedGif.hasPrevFrame && !paletteChanged)
+		{
+			const u8* prev = s_indexedGif.prevFrame.data();
+			x0 = width; y0 = height; x1 = 0; y1 = 0;
+			for (u32 y = 0; y < height; y++)
+			{
+				const u8* row = pixels + y * width;
+				const u8* prevRow = prev + y * width;
+				if (memcmp(row, prevRow, width) == 0) { continue; }
+
+				u32 left = 0, right = width;
+				while (row[left] == prevRow[left]) { left++; }
+				while (row[right - 1] == prevRow[right - 1]) { right--; }
+
+				y0 = std::min(y0, y);
+				y1 = y + 1;
+				x0 = std::min(x0, left);
+				x1 = std::max(x1, right);
+			}
+			// Nothing changed: a single unchanged pixel carries the delay.
+			if (x1 <= x0)
+			{
+				x0 = 0; y0 = 0; x1 = 1; y1 = 1;
+			}
+		}
+		const bool localPalette = memcmp(s_indexedGif.palette, s_indexedGif.globalPalette, sizeof(u32) * 256) != 0;
+
+		std::vector<u8>& out = s_indexedGif.output;
+		out.clear();
+		// Graphic control extension: leave the frame in place, no transparency.
+		const u32 delay = std::min(delayCentiseconds, 0xffffu);
+		const u8 control[] = { 0x21, 0xf9, 0x04, 0x04, u8(delay), u8(delay >> 8), 0x00, 0x00 };
+		out.insert(out.end(), control, control + sizeof(control));
+
+		// Image descriptor.
+		out.push_back(0x2c);
+		putU16(out, x0);
+		putU16(out, y0);
+		putU16(out, x1 - x0);
+		putU16(out, y1 - y0);
+		out.push_back(localPalette ? 0x87 : 0x00);
+		if (localPalette)
+		{
+			putPalette(out, s_indexedGif.palette);
+		}
+
+		lzwEncode(pixels + y0 * width + x0, width, x1 - x0, y1 - y0);
+		s_indexedGif.file.writeBuffer(out.data(), (u32)out.size());
+
+		memcpy(s_indexedGif.prevFrame.data(), pixels, width * height);
+		s_indexedGif.hasPrevFrame = true;
+	}
+
+	bool endIndexedGif()
+	{
+		const u8 trailer = 0x3b;
+		s_indexedGif.file.writeBuffer(&trailer, 1);
+		s_indexedGif.file.close();
+
+		s_indexedGif.output.clear();
+		s_indexedGif.output.shrink_to_fit();
+		s_indexedGif.prevFrame.clear();
+		s_indexedGif.prevFrame.shrink_to_fit();
+		return true;
+	}
+}
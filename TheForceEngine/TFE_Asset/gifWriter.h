@@ -11,4 +11,10 @@ namespace TFE_GIF
 	bool startGif(const char* path, u32 width, u32 height, u32 fps);
 	void addFrame(const u8* imageData);
 	bool write();
+
+	// Lossless 8-bit indexed GIF, frames are encoded and written to disk as they are added.
+	// Palettes are 256 colors in the 0xAABBGGRR format; a frame without a palette uses the previous one.
+	bool startIndexedGif(const char* path, u32 width, u32 height, const u32* palette);
+	void addIndexedFrame(const u8* pixels, const u32* palette, u32 delayCentiseconds);
+	bool endIndexedGif();
 }
@@ -181,12 +181,12 @@ namespace TFE_Model
 		ModelObject* object = nullptr;
 		u32 valueIndex = 0;
 		
+		TokenViewList tokens;
 		while (bufferPos < len)
 		{
 			const char* line = parser.readLine(bufferPos);
 			if (!line) { break; }
 
-			TokenList tokens;
 			parser.tokenizeLine(line, tokens);
 			if (tokens.size() < 1) { continue; }
 
@@ -252,7 +252,7 @@ namespace TFE_Model
 					}
 					else
 					{
-						textures.push_back(tokens[1]);
+						textures.push_back(tokens[1].c_str());
 					}
 				}
 			}
@@ -298,7 +298,7 @@ namespace TFE_Model
 
 				if (tokens.size() > 1)
 				{
-					object->name = tokens[1];
+					object->name = tokens[1].c_str();
 				}
 
 				valueType = VALUE_INVALID;
@@ -196,6 +196,11 @@ namespace TFE_Model_Jedi
 			object3d_computeVertexNormals(model);
 		}
 
+		// Float copies in structure-of-arrays form, so the renderer does not convert per vertex each frame.
+		model->verticesSoA = createSoA(model->vertices, model->vertexCount);
+		model->polygonNormalsSoA = createSoA(model->polygonNormals, model->polygonCount);
+		model->vertexNormalsSoA = createSoA(model->vertexNormals, model->vertexCount);
+
 		// Compute the radius of the model (from <0,0,0>).
 		vec3* vertex = model->vertices;
 		fixed16_16 maxDist = 0;
@@ -216,6 +221,26 @@ namespace TFE_Model_Jedi
 		return model;
 	}
 
+	// Convert fixed point vectors to float in structure-of-arrays form: x[stride], y[stride], z[stride].
+	// The padding is zeroed so SIMD code can process whole groups of 4.
+	f32* createSoA(const vec3* vec, s32 count)
+	{
+		if (!vec || count <= 0) { return nullptr; }
+
+		const s32 stride = JM_SOA_STRIDE(count);
+		f32* soa = (f32*)malloc(stride * 3 * sizeof(f32));
+		if (!soa) { return nullptr; }
+		memset(soa, 0, stride * 3 * sizeof(f32));
+
+		for (s32 i = 0; i < count; i++, vec++)
+		{
+			soa[i] = fixed16ToFloat(vec->x);
+			soa[stride + i] = fixed16ToFloat(vec->y);
+			soa[stride * 2 + i] = fixed16ToFloat(vec->z);
+		}
+		return soa;
+	}
+
 	void getModelList(std::vector<JediModel*>& list)
 	{
 		ModelMap::iterator iModel = s_models.begin();
@@ -277,6 +302,9 @@ namespace TFE_Model_Jedi
 		model->textures = 0;
 		model->radius = 0;
 		model->drawId = -1;	// invalid ID initially.
+		model->verticesSoA = nullptr;
+		model->vertexNormalsSoA = nullptr;
+		model->polygonNormalsSoA = nullptr;
 
 		// Check to see if the name has an underscore.
 		// If so, set the "isBridge" field.
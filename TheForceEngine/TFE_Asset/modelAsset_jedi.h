@@ -65,11 +65,20 @@ struct JediModel
 	TextureData** textures;
 	s32 radius;
 	s32 drawId;		// TFE: Added for the GPU renderer.
+	// TFE: Structure-of-arrays float copies for the SIMD transform in the floating point renderer.
+	// Each holds the x values, then y, then z, with the count padded to a multiple of 4 (see JM_SOA_STRIDE).
+	f32* verticesSoA;
+	f32* vertexNormalsSoA;
+	f32* polygonNormalsSoA;
 };
 
+#define JM_SOA_STRIDE(count) (((count) + 3) & ~3)
+
 namespace TFE_Model_Jedi
 {
 	JediModel* get(const char* name);
 	void getModelList(std::vector<JediModel*>& list);
 	void freeAll();
+	// Float structure-of-arrays copy of 'count' vectors, see JediModel::verticesSoA.
+	f32* createSoA(const vec3* vec, s32 count);
 }
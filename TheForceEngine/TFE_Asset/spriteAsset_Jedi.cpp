@@ -5,10 +5,12 @@
 #include <TFE_FileSystem/filestream.h>
 #include <TFE_FileSystem/paths.h>
 #include <TFE_Asset/assetSystem.h>
+#include <TFE_System/jobSystem.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Jedi/Level/robject.h>
 // TODO: dependency on JediRenderer, this should be refactored...
 #include <TFE_Jedi/Renderer/rlimits.h>
+#include <TFE_Jedi/Renderer/rspriteCache.h>
 //
 #include <assert.h>
 #include <algorithm>
@@ -27,32 +29,9 @@ namespace TFE_Sprite_Jedi
 	static SpriteMap s_sprites;
 	static std::vector<u8> s_buffer;
 		
-	JediFrame* getFrame(const char* name)
+	// Convert the frame file data into a runtime frame, this only uses malloc() so it is safe to call from the job workers.
+	JediFrame* loadFrame(const u8* data, size_t len)
 	{
-		FrameMap::iterator iFrame = s_frames.find(name);
-		if (iFrame != s_frames.end())
-		{
-			return iFrame->second;
-		}
-
-		// It doesn't exist yet, try to load the frame.
-		FilePath filePath;
-		if (!TFE_Paths::getFilePath(name, &filePath))
-		{
-			return nullptr;
-		}
-		FileStream file;
-		if (!file.open(&filePath, FileStream::MODE_READ))
-		{
-			return nullptr;
-		}
-		size_t len = file.getSize();
-		s_buffer.resize(len);
-		file.readBuffer(s_buffer.data(), u32(len));
-		file.close();
-
-		const u8* data = s_buffer.data();
-
 		// Determine ahead of time how much we need to allocate.
 		const WaxFrame* base_frame = (WaxFrame*)data;
 		const WaxCell* base_cell = WAX_CellPtr(data, base_frame);
@@ -60,10 +39,10 @@ namespace TFE_Sprite_Jedi
 
 		// This is a "load in place" format in the original code.
 		// We are going to allocate new memory and copy the data.
-		u8* assetPtr = (u8*)malloc(s_buffer.size() + columnSize);
+		u8* assetPtr = (u8*)malloc(len + columnSize);
 		JediFrame* asset = (JediFrame*)assetPtr;
 		
-		memcpy(asset, data, s_buffer.size());
+		memcpy(asset, data, len);
 
 		WaxFrame* frame = asset;
 		WaxCell* cell = WAX_CellPtr(asset, frame);
@@ -85,7 +64,7 @@ namespace TFE_Sprite_Jedi
 		}
 		else
 		{
-			u32* columns = (u32*)((u8*)asset + s_buffer.size());
+			u32* columns = (u32*)((u8*)asset + len);
 			// Local pointer.
 			cell->columnOffset = u32((u8*)columns - (u8*)asset);
 			// Calculate column offsets.
@@ -94,32 +73,38 @@ namespace TFE_Sprite_Jedi
 				columns[c] = cell->sizeY * c;
 			}
 		}
-		
-		s_frames[name] = asset;
 		return asset;
 	}
 
-	static std::vector<u32> s_cellOffsets;
+	// Decompress the cells at load time if the sprite cache is set to preload, safe to call from the job workers.
+	void preloadFrameCells(const JediFrame* frame)
+	{
+		spriteCache_preloadCell(WAX_CellPtr(frame, frame));
+	}
 
-	bool isUniqueCell(u32 offset)
+	void preloadWaxCells(const JediWax* wax)
 	{
-		const size_t count = s_cellOffsets.size();
-		const u32* offsetList = s_cellOffsets.data();
-		for (u32 i = 0; i < count; i++)
+		for (s32 animIdx = 0; animIdx < wax->animCount; animIdx++)
 		{
-			if (offsetList[i] == offset) { return false; }
+			const WaxAnim* anim = WAX_AnimPtr(wax, animIdx);
+			for (s32 v = 0; anim && v < WAX_MAX_VIEWS; v++)
+			{
+				const WaxView* view = WAX_ViewPtr(wax, anim, v);
+				for (s32 f = 0; view && f < WAX_MAX_FRAMES && view->frameOffsets[f]; f++)
+				{
+					const WaxFrame* frame = WAX_FramePtr(wax, view, f);
+					spriteCache_preloadCell(WAX_CellPtr(wax, frame));
+				}
+			}
 		}
-		s_cellOffsets.push_back(offset);
-
-		return true;
 	}
-		
-	JediWax* getWax(const char* name)
+
+	JediFrame* getFrame(const char* name)
 	{
-		SpriteMap::iterator iSprite = s_sprites.find(name);
-		if (iSprite != s_sprites.end())
+		FrameMap::iterator iFrame = s_frames.find(name);
+		if (iFrame != s_frames.end())
 		{
-			return iSprite->second;
+			return iFrame->second;
 		}
 
 		// It doesn't exist yet, try to load the frame.
@@ -138,7 +123,28 @@ namespace TFE_Sprite_Jedi
 		file.readBuffer(s_buffer.data(), u32(len));
 		file.close();
 
-		const u8* data = s_buffer.data();
+		JediFrame* asset = loadFrame(s_buffer.data(), s_buffer.size());
+		preloadFrameCells(asset);
+		s_frames[name] = asset;
+		return asset;
+	}
+
+	bool isUniqueCell(std::vector<u32>& cellOffsets, u32 offset)
+	{
+		const size_t count = cellOffsets.size();
+		const u32* offsetList = cellOffsets.data();
+		for (u32 i = 0; i < count; i++)
+		{
+			if (offsetList[i] == offset) { return false; }
+		}
+		cellOffsets.push_back(offset);
+
+		return true;
+	}
+		
+	// Convert the wax file data into a runtime wax, this only uses malloc() so it is safe to call from the job workers.
+	JediWax* loadWax(const u8* data, size_t len, std::vector<u32>& cellOffsets)
+	{
 		const Wax* srcWax = (Wax*)data;
 		
 		// every animation is filled out until the end, so no animations = no wax.
@@ -146,10 +152,10 @@ namespace TFE_Sprite_Jedi
 		{
 			return nullptr;
 		}
-		s_cellOffsets.clear();
+		cellOffsets.clear();
 
 		// First determine the size to allocate (note that this will overallocate a bit because cells are shared).
-		u32 sizeToAlloc = sizeof(JediWax) + (u32)s_buffer.size();
+		u32 sizeToAlloc = sizeof(JediWax) + (u32)len;
 		const s32* animOffset = srcWax->animOffsets;
 		for (s32 animIdx = 0; animIdx < 32 && animOffset[animIdx]; animIdx++)
 		{
@@ -163,7 +169,7 @@ namespace TFE_Sprite_Jedi
 				{
 					const WaxFrame* frame = (WaxFrame*)(data + frameOffset[f]);
 					const WaxCell* cell = frame->cellOffset ? (WaxCell*)(data + frame->cellOffset) : nullptr;
-					if (cell && cell->compressed == 0 && isUniqueCell(frame->cellOffset))
+					if (cell && cell->compressed == 0 && isUniqueCell(cellOffsets, frame->cellOffset))
 					{
 						sizeToAlloc += cell->sizeX * sizeof(u32);
 					}
@@ -174,7 +180,7 @@ namespace TFE_Sprite_Jedi
 		// Allocate and copy the data (this is a "copy in place" format... mostly.
 		JediWax* asset = (JediWax*)malloc(sizeToAlloc);
 		Wax* dstWax = asset;
-		memcpy(dstWax, srcWax, s_buffer.size());
+		memcpy(dstWax, srcWax, len);
 
 		// Loop through animation list until we reach 32 (maximum count) or a null animation.
 		// This means that animations are contiguous.
@@ -236,7 +242,7 @@ namespace TFE_Sprite_Jedi
 							}
 							else
 							{
-								u32* columns = (u32*)((u8*)asset + s_buffer.size() + cellOffsetPtr);
+								u32* columns = (u32*)((u8*)asset + len + cellOffsetPtr);
 								cellOffsetPtr += dstCell->sizeX * sizeof(u32);
 
 								// Local pointer.
@@ -266,10 +272,140 @@ namespace TFE_Sprite_Jedi
 			}
 		}
 		asset->animCount = animIdx;
+		return asset;
+	}
+
+	JediWax* getWax(const char* name)
+	{
+		SpriteMap::iterator iSprite = s_sprites.find(name);
+		if (iSprite != s_sprites.end())
+		{
+			return iSprite->second;
+		}
 
+		// It doesn't exist yet, try to load the frame.
+		FilePath filePath;
+		if (!TFE_Paths::getFilePath(name, &filePath))
+		{
+			return nullptr;
+		}
+		FileStream file;
+		if (!file.open(&filePath, FileStream::MODE_READ))
+		{
+			return nullptr;
+		}
+		size_t len = file.getSize();
+		s_buffer.resize(len);
+		file.readBuffer(s_buffer.data(), u32(len));
+		file.close();
+
+		std::vector<u32> cellOffsets;
+		JediWax* asset = loadWax(s_buffer.data(), s_buffer.size(), cellOffsets);
+		if (!asset)
+		{
+			return nullptr;
+		}
+		preloadWaxCells(asset);
 		s_sprites[name] = asset;
 		return asset;
 	}
+
+	struct SpriteListJob
+	{
+		const TFE_AssetSystem::AssetData* files;
+		void** assets;
+		bool wax;
+	};
+
+	void loadSpriteJob(s32 index, void* userData)
+	{
+		SpriteListJob* job = (SpriteListJob*)userData;
+		const TFE_AssetSystem::AssetData* file = &job->files[index];
+		if (!file->data) { return; }
+
+		if (job->wax)
+		{
+			std::vector<u32> cellOffsets;
+			JediWax* asset = loadWax(file->data, file->size, cellOffsets);
+			if (asset) { preloadWaxCells(asset); }
+			job->assets[index] = asset;
+		}
+		else
+		{
+			JediFrame* asset = loadFrame(file->data, file->size);
+			preloadFrameCells(asset);
+			job->assets[index] = asset;
+		}
+	}
+
+	void loadSpriteList(const char* const* names, s32 count, void** assets, bool wax)
+	{
+		// Each name that is not already loaded is read and converted once, on the job workers.
+		std::vector<FilePath> paths;
+		std::vector<std::string> pathNames;
+		std::vector<s32> listIndex(count, -1);
+		for (s32 i = 0; i < count; i++)
+		{
+			assets[i] = nullptr;
+			if (!names[i][0]) { continue; }
+			if (wax)
+			{
+				SpriteMap::iterator iSprite = s_sprites.find(names[i]);
+				if (iSprite != s_sprites.end()) { assets[i] = iSprite->second; continue; }
+			}
+			else
+			{
+				FrameMap::iterator iFrame = s_frames.find(names[i]);
+				if (iFrame != s_frames.end()) { assets[i] = iFrame->second; continue; }
+			}
+
+			std::vector<std::string>::iterator iName = std::find(pathNames.begin(), pathNames.end(), names[i]);
+			if (iName != pathNames.end())
+			{
+				listIndex[i] = s32(iName - pathNames.begin());
+				continue;
+			}
+
+			FilePath filePath;
+			if (TFE_Paths::getFilePath(names[i], &filePath))
+			{
+				listIndex[i] = s32(paths.size());
+				paths.push_back(filePath);
+				pathNames.push_back(names[i]);
+			}
+		}
+		if (paths.empty()) { return; }
+
+		const s32 loadCount = s32(paths.size());
+		std::vector<TFE_AssetSystem::AssetData> files(loadCount);
+		std::vector<void*> loaded(loadCount, nullptr);
+		TFE_AssetSystem::readAssetList(paths.data(), loadCount, files.data());
+
+		SpriteListJob job = { files.data(), loaded.data(), wax };
+		TFE_Jobs::run(loadSpriteJob, &job, loadCount);
+
+		// Add the results in list order.
+		for (s32 i = 0; i < loadCount; i++)
+		{
+			if (!loaded[i]) { continue; }
+			if (wax) { s_sprites[pathNames[i]] = (JediWax*)loaded[i]; }
+			else { s_frames[pathNames[i]] = (JediFrame*)loaded[i]; }
+		}
+		for (s32 i = 0; i < count; i++)
+		{
+			if (listIndex[i] >= 0) { assets[i] = loaded[listIndex[i]]; }
+		}
+	}
+
+	void getFrames(const char* const* names, s32 count, JediFrame** frames)
+	{
+		loadSpriteList(names, count, (void**)frames, false);
+	}
+
+	void getWaxes(const char* const* names, s32 count, JediWax** waxes)
+	{
+		loadSpriteList(names, count, (void**)waxes, true);
+	}
 		
 	void getWaxList(std::vector<JediWax*>& list)
 	{
@@ -291,6 +427,9 @@ namespace TFE_Sprite_Jedi
 
 	void freeAll()
 	{
+		// The cache is keyed by cell pointers, which are about to be freed.
+		spriteCache_clear();
+
 		FrameMap::iterator iFrame = s_frames.begin();
 		for (; iFrame != s_frames.end(); ++iFrame)
 		{
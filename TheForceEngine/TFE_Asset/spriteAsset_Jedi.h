@@ -90,8 +90,16 @@ namespace TFE_Sprite_Jedi
 {
 	JediFrame* getFrame(const char* name);
 	JediWax*   getWax(const char* name);
+	// Load a list of frames or waxes, matching getFrame()/getWax() on each name.
+	// Files are read and converted on the job workers, missing files give null.
+	void getFrames(const char* const* names, s32 count, JediFrame** frames);
+	void getWaxes(const char* const* names, s32 count, JediWax** waxes);
 	void freeAll();
 
 	void getWaxList(std::vector<JediWax*>& list);
 	void getFrameList(std::vector<JediFrame*>& list);
+
+	// Convert file data into a runtime frame or wax without adding it to the lists above, the caller frees it with free().
+	JediFrame* loadFrame(const u8* data, size_t len);
+	JediWax*   loadWax(const u8* data, size_t len, std::vector<u32>& cellOffsets);
 }
@@ -110,12 +110,12 @@ namespace TFE_VueAsset
 		u32 frameCount = 0;
 		u32 transformIndex = 0;
 
+		TokenViewList tokens;
 		while (bufferPos < len)
 		{
 			const char* line = parser.readLine(bufferPos);
 			if (!line) { break; }
 
-			TokenList tokens;
 			parser.tokenizeLine(line, tokens);
 			if (tokens.size() < 1) { continue; }
 
@@ -9,6 +9,7 @@
 #include <TFE_System/profiler.h>
 #include <assert.h>
 #include <algorithm>
+#include <thread>
 
 // Comment out the desired sigmoid function and comment all of the others.
 //#define AUDIO_SIGMOID_CLIP 1
@@ -21,30 +22,77 @@
 // Set to 1 to enable audio timing counters.
 #define AUDIO_TIMING 0
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define AUDIO_SIMD_SSE2 1
+#endif
+
+// Must be a power of two.
+#define SOUND_CMD_COUNT 256
+
 enum SoundSourceFlags
 {
 	SND_FLAG_ONE_SHOT = (1 << 0),
-	SND_FLAG_ACTIVE   = (1 << 1),
-	SND_FLAG_LOOPING  = (1 << 2),
-	SND_FLAG_PLAYING  = (1 << 3),
-	SND_FLAG_FINISHED = (1 << 4),
+	SND_FLAG_LOOPING  = (1 << 1),
+	SND_FLAG_PLAYING  = (1 << 2),
+	SND_FLAG_FINISHED = (1 << 3),
 };
 
 struct SoundSource
 {
+	// Client state, only touched by the thread calling the TFE_Audio API.
 	SoundType type;
 	f32 volume;
-	u32 sampleIndex;
-	u32 flags;
 	s32 slot;
-
-	// Sound data.
 	const SoundBuffer* buffer;
+	// Shared state: 'active' is cleared by the mixer when a one shot finishes,
+	// 'playing' is cleared by the mixer when a sound reaches its end.
+	atomic_bool active;
+	atomic_bool playing;
+	// Changed whenever the client gives up the slot, so that a sound that finishes
+	// afterwards does not touch the new owner or call a stale callback.
+	atomic_u32 generation;
 
-	// Callback.
 	SoundFinishedCallback finishedCallback = nullptr;
 	void* finishedUserData = nullptr;
 	s32 finishedArg = 0;
+
+	// Mixer state, only touched by the audio thread.
+	const SoundBuffer* mixBuffer;
+	f32 mixVolume;
+	u32 mixIndex;
+	u32 mixFlags;
+	// Copied from the play command so the client can reuse the source while it is finishing.
+	SoundFinishedCallback mixCallback;
+	void* mixUserData;
+	s32 mixArg;
+	u32 mixGeneration;
+};
+
+// Source changes are passed to the audio thread through a single producer/single consumer
+// queue so that the mixer never waits on the game thread. Nothing on the mix path takes a lock,
+// clients that need to know the mixer is done with some state use waitForMix().
+enum SoundCommandType
+{
+	SCMD_PLAY = 0,
+	SCMD_STOP,
+	SCMD_FREE,
+	SCMD_SET_VOLUME,
+	SCMD_SET_BUFFER,
+	SCMD_STOP_ALL,
+};
+
+struct SoundCommand
+{
+	SoundCommandType type;
+	s32 slot;
+	u32 flags;
+	f32 volume;
+	const SoundBuffer* buffer;
+	SoundFinishedCallback callback;
+	void* userData;
+	s32 arg;
+	u32 generation;
 };
 
 namespace TFE_Audio
@@ -55,12 +103,19 @@ namespace TFE_Audio
 	// Client volume controls, ranging from [0, 1]
 	static f32 s_soundFxVolume = 1.0f;
 
-	static u32 s_sourceCount;
 	static SoundSource s_sources[MAX_SOUND_SOURCES];
+	static u32 s_mixSourceCount;
 	static Mutex s_mutex;
-	static bool s_paused = false;
+	static atomic_bool s_paused(false);
+	// Odd while the audio thread is mixing.
+	static atomic_u32 s_mixEpoch(0);
+	static thread_local bool s_inMix = false;
+
+	static SoundCommand s_commands[SOUND_CMD_COUNT];
+	static atomic_u32 s_commandWrite(0);
+	static atomic_u32 s_commandRead(0);
 
-	static AudioThreadCallback s_audioThreadCallback = nullptr;
+	static std::atomic<AudioThreadCallback> s_audioThreadCallback(nullptr);
 
 	s32 audioCallback(void *outputBuffer, void* inputBuffer, u32 bufferSize, f64 streamTime, u32 status, void* userData);
 	void setSoundVolumeConsole(const ConsoleArgList& args);
@@ -73,11 +128,27 @@ namespace TFE_Audio
 	static s32 s_soundIterAve = 0;
 #endif
 
+	void resetSources()
+	{
+		for (s32 i = 0; i < MAX_SOUND_SOURCES; i++)
+		{
+			SoundSource* snd = &s_sources[i];
+			snd->slot = i;
+			snd->buffer = nullptr;
+			snd->mixBuffer = nullptr;
+			snd->mixFlags = 0u;
+			snd->mixIndex = 0u;
+			snd->active.store(false);
+			snd->playing.store(false);
+			snd->generation.store(0u);
+			snd->mixGeneration = 0u;
+		}
+		s_mixSourceCount = 0u;
+	}
+
 	bool init()
 	{
 		TFE_System::logWrite(LOG_MSG, "Startup", "TFE_AudioSystem::init");
-		s_sourceCount = 0u;
-
 		MUTEX_INITIALIZE(&s_mutex);
 
 		CCMD("setSoundVolume", setSoundVolumeConsole, 1, "Sets the sound volume, range is 0.0 to 1.0");
@@ -90,14 +161,12 @@ namespace TFE_Audio
 
 		TFE_Settings_Sound* soundSettings = TFE_Settings::getSoundSettings();
 		setVolume(soundSettings->soundFxVolume);
+		resetSources();
+		s_commandWrite.store(0);
+		s_commandRead.store(0);
 
-		memset(s_sources, 0, sizeof(SoundSource) * MAX_SOUND_SOURCES);
-		for (s32 i = 0; i < MAX_SOUND_SOURCES; i++)
-		{
-			s_sources[i].slot = i;
-		}
-
-		bool res = TFE_AudioDevice::init();
+		// Smaller buffers lower the latency but leave less time to mix each buffer.
+		bool res = TFE_AudioDevice::init(soundSettings->lowLatencyAudio ? 128u : 256u);
 		res |= TFE_AudioDevice::startOutput(audioCallback, nullptr, 2u, 11025u);
 		return res;
 	}
@@ -111,16 +180,44 @@ namespace TFE_Audio
 		MUTEX_DESTROY(&s_mutex);
 	}
 
+	bool pushCommand(SoundCommandType type, SoundSource* source, u32 flags = 0u, f32 volume = 0.0f, const SoundBuffer* buffer = nullptr)
+	{
+		const u32 write = s_commandWrite.load(std::memory_order_relaxed);
+		if (write - s_commandRead.load(std::memory_order_acquire) >= SOUND_CMD_COUNT)
+		{
+			TFE_System::logWrite(LOG_WARNING, "Audio", "Sound command queue is full, command %d dropped.", type);
+			return false;
+		}
+
+		SoundCommand* cmd = &s_commands[write & (SOUND_CMD_COUNT - 1)];
+		cmd->type = type;
+		cmd->slot = source ? source->slot : -1;
+		cmd->flags = flags;
+		cmd->volume = volume;
+		cmd->buffer = buffer;
+		if (type == SCMD_PLAY)
+		{
+			cmd->callback = source->finishedCallback;
+			cmd->userData = source->finishedUserData;
+			cmd->arg = source->finishedArg;
+			cmd->generation = source->generation.load();
+		}
+		s_commandWrite.store(write + 1, std::memory_order_release);
+		return true;
+	}
+
 	void stopAllSounds()
 	{
-		MUTEX_LOCK(&s_mutex);
-		s_sourceCount = 0u;
-		memset(s_sources, 0, sizeof(SoundSource) * MAX_SOUND_SOURCES);
 		for (s32 i = 0; i < MAX_SOUND_SOURCES; i++)
 		{
-			s_sources[i].slot = i;
+			s_sources[i].generation++;
+			s_sources[i].active.store(false);
+			s_sources[i].playing.store(false);
+			s_sources[i].buffer = nullptr;
 		}
-		MUTEX_UNLOCK(&s_mutex);
+		pushCommand(SCMD_STOP_ALL, nullptr);
+		// Once this returns no callback from a stopped sound can run and no stopped sound can release a slot.
+		waitForMix();
 	}
 
 	void setVolume(f32 volume)
@@ -135,21 +232,22 @@ namespace TFE_Audio
 
 	void pause()
 	{
-		s_paused = true;
+		s_paused.store(true);
 	}
 
 	void resume()
 	{
-		s_paused = false;
+		s_paused.store(false);
 	}
 		
+	// Once this returns, the previous callback is no longer running.
 	void setAudioThreadCallback(AudioThreadCallback callback)
 	{
-		MUTEX_LOCK(&s_mutex);
-		s_audioThreadCallback = callback;
-		MUTEX_UNLOCK(&s_mutex);
+		s_audioThreadCallback.store(callback);
+		waitForMix();
 	}
 
+	// Only serializes the clients (such as the game and iMuse threads), the mixer never takes the lock.
 	void lock()
 	{
 		MUTEX_LOCK(&s_mutex);
@@ -160,47 +258,59 @@ namespace TFE_Audio
 		MUTEX_UNLOCK(&s_mutex);
 	}
 
-	// One shot, play and forget. Only do this if the client needs no control until stopAllSounds() is called.
-	// Note that looping one shots are valid.
-	bool playOneShot(SoundType type, f32 volume, const SoundBuffer* buffer, bool looping, SoundFinishedCallback finishedCallback, void* cbUserData, s32 cbArg)
+	void waitForMix()
 	{
-		if (!buffer) { return false; }
+		// Called from a callback on the audio thread.
+		if (s_inMix) { return; }
+
+		// Pairs with the fence in audioCallback(): either the mix in progress is seen here, or the next mix sees the changes.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const u32 epoch = s_mixEpoch.load();
+		if (!(epoch & 1u)) { return; }
+		while (s_mixEpoch.load() == epoch)
+		{
+			std::this_thread::yield();
+		}
+	}
 
-		MUTEX_LOCK(&s_mutex);
-		// Find the first inactive source.
-		SoundSource* snd = s_sources;
-		SoundSource* newSource = nullptr;
-		for (u32 s = 0; s < s_sourceCount; s++, snd++)
+	SoundSource* allocateSource()
+	{
+		for (s32 s = 0; s < MAX_SOUND_SOURCES; s++)
 		{
-			if (!(snd->flags&SND_FLAG_ACTIVE))
+			if (!s_sources[s].active.load(std::memory_order_acquire))
 			{
-				newSource = snd;
-				break;
+				s_sources[s].active.store(true);
+				return &s_sources[s];
 			}
 		}
-		if (!newSource && s_sourceCount < MAX_SOUND_SOURCES)
-		{
-			newSource = &s_sources[s_sourceCount];
-			s_sourceCount++;
-		}
+		return nullptr;
+	}
+
+	// One shot, play and forget. Only do this if the client needs no control until stopAllSounds() is called.
+	// Note that looping one shots are valid.
+	bool playOneShot(SoundType type, f32 volume, const SoundBuffer* buffer, bool looping, SoundFinishedCallback finishedCallback, void* cbUserData, s32 cbArg)
+	{
+		if (!buffer) { return false; }
 
+		SoundSource* newSource = allocateSource();
 		if (newSource)
 		{
 			newSource->type = type;
-			newSource->flags = SND_FLAG_ACTIVE | SND_FLAG_PLAYING | SND_FLAG_ONE_SHOT;
-			if (looping)
-			{
-				newSource->flags |= SND_FLAG_LOOPING;
-			}
 			newSource->volume = type == SOUND_3D ? 0.0f : volume;
 			newSource->buffer = buffer;
-			newSource->sampleIndex = 0u;
 			newSource->finishedCallback = finishedCallback;
 			newSource->finishedUserData = cbUserData;
 			newSource->finishedArg = cbArg;
-		}
-		MUTEX_UNLOCK(&s_mutex);
+			newSource->playing.store(true);
 
+			const u32 flags = SND_FLAG_ONE_SHOT | (looping ? SND_FLAG_LOOPING : 0u);
+			if (!pushCommand(SCMD_PLAY, newSource, flags, newSource->volume, buffer))
+			{
+				newSource->playing.store(false);
+				newSource->active.store(false);
+				newSource = nullptr;
+			}
+		}
 		return newSource != nullptr;
 	}
 
@@ -210,36 +320,17 @@ namespace TFE_Audio
 		if (!buffer) { return nullptr; }
 		assert(volume >= 0.0f && volume <= 1.0f);
 
-		MUTEX_LOCK(&s_mutex);
-		// Find the first inactive source.
-		SoundSource* snd = s_sources;
-		SoundSource* newSource = nullptr;
-		for (u32 s = 0; s < s_sourceCount; s++, snd++)
-		{
-			if (!(snd->flags&SND_FLAG_ACTIVE))
-			{
-				newSource = snd;
-				break;
-			}
-		}
-		if (!newSource && s_sourceCount < MAX_SOUND_SOURCES)
-		{
-			newSource = &s_sources[s_sourceCount];
-			s_sourceCount++;
-		}
-
+		SoundSource* newSource = allocateSource();
 		if (newSource)
 		{
 			newSource->type = type;
-			newSource->flags = SND_FLAG_ACTIVE;
 			newSource->volume = volume;
 			newSource->buffer = buffer;
-			newSource->sampleIndex = 0u;
 			newSource->finishedCallback = callback;
 			newSource->finishedUserData = userData;
+			newSource->finishedArg = 0;
+			newSource->playing.store(false);
 		}
-		MUTEX_UNLOCK(&s_mutex);
-
 		return newSource;
 	}
 
@@ -255,7 +346,7 @@ namespace TFE_Audio
 		{
 			return nullptr;
 		}
-		if (!(s_sources[slot].flags & SND_FLAG_ACTIVE))
+		if (!s_sources[slot].active.load())
 		{
 			return nullptr;
 		}
@@ -265,53 +356,51 @@ namespace TFE_Audio
 
 	void playSource(SoundSource* source, bool looping)
 	{
-		if (!source || (source->flags & SND_FLAG_PLAYING))
+		if (!source || source->playing.load())
 		{
 			return;
 		}
 		
-		MUTEX_LOCK(&s_mutex);
-			source->flags |= SND_FLAG_PLAYING;
-			if (looping) { source->flags |= SND_FLAG_LOOPING; }
-			source->sampleIndex = 0u;
-		MUTEX_UNLOCK(&s_mutex);
+		source->playing.store(true);
+		pushCommand(SCMD_PLAY, source, looping ? SND_FLAG_LOOPING : 0u, source->volume, source->buffer);
 	}
 
 	void stopSource(SoundSource* source)
 	{
 		if (!source) { return; }
-		MUTEX_LOCK(&s_mutex);
-			source->flags &= ~SND_FLAG_PLAYING;
-		MUTEX_UNLOCK(&s_mutex);
+		source->playing.store(false);
+		pushCommand(SCMD_STOP, source);
 	}
 	
 	void freeSource(SoundSource* source)
 	{
 		if (!source) { return; }
-		MUTEX_LOCK(&s_mutex);
-			source->flags &= ~SND_FLAG_PLAYING;
-			source->flags &= ~SND_FLAG_ACTIVE;
-			source->buffer = nullptr;
-		MUTEX_UNLOCK(&s_mutex);
+		source->buffer = nullptr;
+		// The slot may be reused once this returns, the mixer sees the free before any new command.
+		pushCommand(SCMD_FREE, source);
+
+		source->generation++;
+		source->playing.store(false);
+		source->active.store(false, std::memory_order_release);
+		waitForMix();
 	}
 
 	void setSourceVolume(SoundSource* source, f32 volume)
 	{
 		source->volume = std::max(0.0f, std::min(1.0f, volume));
+		pushCommand(SCMD_SET_VOLUME, source, 0u, source->volume);
 	}
 
 	// This will restart the sound and change the buffer.
 	void setSourceBuffer(SoundSource* source, const SoundBuffer* buffer)
 	{
-		MUTEX_LOCK(&s_mutex);
-			source->sampleIndex = 0u;
-			source->buffer = buffer;
-		MUTEX_UNLOCK(&s_mutex);
+		source->buffer = buffer;
+		pushCommand(SCMD_SET_BUFFER, source, 0u, 0.0f, buffer);
 	}
 
 	bool isSourcePlaying(SoundSource* source)
 	{
-		return (source->flags & SND_FLAG_PLAYING) != 0u;
+		return source->playing.load();
 	}
 
 	f32 getSourceVolume(SoundSource* source)
@@ -323,31 +412,99 @@ namespace TFE_Audio
 	static const f32 c_scale[] = { 2.0f / 255.0f, 2.0f / 65535.0f, 1.0f };
 	static const f32 c_offset[] = { -1.0f, -1.0f, 0.0f };
 
-	void cleanupSources()
+	// Apply queued source changes, audio thread only.
+	void processCommands()
 	{
-		// call any finished callbacks.
-		for (u32 s = 0; s < s_sourceCount; s++)
+		const u32 write = s_commandWrite.load(std::memory_order_acquire);
+		u32 read = s_commandRead.load(std::memory_order_relaxed);
+		for (; read != write; read++)
 		{
-			if (s_sources[s].flags&SND_FLAG_FINISHED)
+			const SoundCommand* cmd = &s_commands[read & (SOUND_CMD_COUNT - 1)];
+			if (cmd->type == SCMD_STOP_ALL)
 			{
-				s_sources[s].flags = 0;
-				s_sources[s].buffer = nullptr;
-				if (s_sources[s].finishedCallback)
+				for (u32 s = 0; s < s_mixSourceCount; s++)
 				{
-					s_sources[s].finishedCallback(s_sources[s].finishedUserData, s_sources[s].finishedArg);
+					s_sources[s].mixFlags = 0u;
+					s_sources[s].mixBuffer = nullptr;
 				}
+				s_mixSourceCount = 0u;
+				continue;
+			}
+
+			SoundSource* snd = &s_sources[cmd->slot];
+			switch (cmd->type)
+			{
+				case SCMD_PLAY:
+				{
+					snd->mixFlags = SND_FLAG_PLAYING | cmd->flags;
+					snd->mixVolume = cmd->volume;
+					snd->mixBuffer = cmd->buffer;
+					snd->mixIndex = 0u;
+					snd->mixCallback = cmd->callback;
+					snd->mixUserData = cmd->userData;
+					snd->mixArg = cmd->arg;
+					snd->mixGeneration = cmd->generation;
+					snd->playing.store(true);
+					s_mixSourceCount = std::max(s_mixSourceCount, u32(cmd->slot) + 1);
+				} break;
+				case SCMD_STOP:
+				{
+					snd->mixFlags &= ~SND_FLAG_PLAYING;
+				} break;
+				case SCMD_FREE:
+				{
+					snd->mixFlags = 0u;
+					snd->mixBuffer = nullptr;
+				} break;
+				case SCMD_SET_VOLUME:
+				{
+					snd->mixVolume = cmd->volume;
+				} break;
+				case SCMD_SET_BUFFER:
+				{
+					snd->mixBuffer = cmd->buffer;
+					snd->mixIndex = 0u;
+				} break;
 			}
 		}
+		s_commandRead.store(read, std::memory_order_release);
+	}
 
-		const s32 end = (s32)s_sourceCount - 1;
-		//shrink the number of sources until an active source is found.
-		for (s32 s = end; s >= 0; s--)
+	void cleanupSources()
+	{
+		// call any finished callbacks.
+		// A client giving up the slot meanwhile waits for the mix to end (see waitForMix()).
+		for (u32 s = 0; s < s_mixSourceCount; s++)
 		{
-			if (s_sources[s].flags&SND_FLAG_ACTIVE)
+			SoundSource* snd = &s_sources[s];
+			if (snd->mixFlags & SND_FLAG_FINISHED)
 			{
-				break;
+				const bool oneShot = (snd->mixFlags & SND_FLAG_ONE_SHOT) != 0;
+				snd->mixFlags = 0;
+				snd->mixBuffer = nullptr;
+				// The slot was stopped or freed after this sound started, it may already belong to a new sound.
+				if (snd->generation.load() != snd->mixGeneration)
+				{
+					continue;
+				}
+
+				snd->playing.store(false);
+				if (snd->mixCallback)
+				{
+					snd->mixCallback(snd->mixUserData, snd->mixArg);
+				}
+				// One shots are owned by the mixer once started, so hand the slot back.
+				if (oneShot)
+				{
+					snd->active.store(false, std::memory_order_release);
+				}
 			}
-			s_sourceCount--;
+		}
+
+		//shrink the number of sources until a playing source is found.
+		while (s_mixSourceCount > 0 && !(s_sources[s_mixSourceCount - 1].mixFlags & SND_FLAG_PLAYING))
+		{
+			s_mixSourceCount--;
 		}
 	}
 		
@@ -364,117 +521,212 @@ namespace TFE_Audio
 		return sampleValue * c_scale[type] + c_offset[type];
 	}
 
-	// Audio callback
-	s32 audioCallback(void *outputBuffer, void* inputBuffer, u32 bufferSize, f64 streamTime, u32 status, void* userData)
+#if AUDIO_SIMD_SSE2
+	// Add 4 mono samples to 4 interleaved stereo frames.
+	inline void mixStereo4(f32* out, __m128 samples)
 	{
-		f32* buffer = (f32*)outputBuffer;
+		_mm_storeu_ps(out,     _mm_add_ps(_mm_loadu_ps(out),     _mm_unpacklo_ps(samples, samples)));
+		_mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_unpackhi_ps(samples, samples)));
+	}
+#endif
 
-	#if AUDIO_TIMING == 1
-		u64 soundIterStart = TFE_System::getCurrentTimeInTicks();
+	// Mix 'count' samples starting at 'start' into the interleaved stereo buffer 'out'.
+	void mixSamples(f32* out, SoundDataType type, const u8* data, u32 start, u32 count, f32 volume)
+	{
+		// (sample * scale + offset) * volume, with the volume folded into the constants.
+		const f32 scale  = c_scale[type] * volume;
+		const f32 offset = c_offset[type] * volume;
+		u32 i = 0;
+	#if AUDIO_SIMD_SSE2
+		const __m128  vScale  = _mm_set1_ps(scale);
+		const __m128  vOffset = _mm_set1_ps(offset);
+		const __m128i zero    = _mm_setzero_si128();
+		switch (type)
+		{
+			case SOUND_DATA_8BIT:
+			{
+				const u8* src = data + start;
+				for (; i + 4 <= count; i += 4, out += 8)
+				{
+					s32 packed;
+					memcpy(&packed, src + i, 4);
+					__m128i v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+					mixStereo4(out, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(v), vScale), vOffset));
+				}
+			} break;
+			case SOUND_DATA_16BIT:
+			{
+				const u16* src = (const u16*)data + start;
+				for (; i + 4 <= count; i += 4, out += 8)
+				{
+					__m128i v = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(src + i)), zero);
+					mixStereo4(out, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(v), vScale), vOffset));
+				}
+			} break;
+			case SOUND_DATA_FLOAT:
+			{
+				const f32* src = (const f32*)data + start;
+				for (; i + 4 <= count; i += 4, out += 8)
+				{
+					mixStereo4(out, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src + i), vScale), vOffset));
+				}
+			} break;
+		}
 	#endif
-
-		// First clear samples
-		memset(buffer, 0, sizeof(f32)*bufferSize*2);
-			   
-		MUTEX_LOCK(&s_mutex);
-		// Then call the audio thread callback
-		if (s_audioThreadCallback && !s_paused)
+		for (; i < count; i++, out += 2)
 		{
-			s_audioThreadCallback(buffer, bufferSize, s_soundFxVolume * c_soundHeadroom);
+			const f32 sample = sampleBuffer(start + i, type, data) * volume;
+			out[0] += sample;
+			out[1] += sample;
 		}
+	}
 
-		// Then loop through the sources.
-		// Note: this is no longer used by Dark Forces. However I decided to keep direct sound support around
-		// so it can be used for tools.
-		SoundSource* snd = s_sources;
-		for (u32 s = 0; s < s_sourceCount && !s_paused; s++, snd++)
+	void mixSource(SoundSource* snd, f32* buffer, u32 bufferSize)
+	{
+		// Skip sound sample processing the sound is too quiet...
+		const u32 sndBufferSize = snd->mixBuffer->size;
+		if (snd->mixVolume < SND_CULL_VOLUME)
 		{
-			if (!(snd->flags&SND_FLAG_PLAYING)) { continue; }
-			assert(snd->buffer->data);
-
-			// Skip sound sample processing the sound is too quiet...
-			const u32 sndBufferSize = snd->buffer->size;
-			if (snd->volume < SND_CULL_VOLUME)
+			// Pretend we played the sound and handle looping.
+			snd->mixIndex += bufferSize;
+			if (snd->mixIndex >= sndBufferSize)
 			{
-				// Pretend we played the sound and handle looping.
-				snd->sampleIndex += bufferSize;
-				if (snd->sampleIndex >= sndBufferSize)
+				if (snd->mixFlags&SND_FLAG_LOOPING)
 				{
-					if (snd->flags&SND_FLAG_LOOPING)
-					{
-						snd->sampleIndex = (snd->sampleIndex % sndBufferSize) + snd->buffer->loopStart;
-					}
-					else
-					{
-						snd->flags &= ~SND_FLAG_PLAYING;
-						snd->flags |= SND_FLAG_FINISHED;
-						snd->sampleIndex = 0u;
-					}
+					snd->mixIndex = (snd->mixIndex % sndBufferSize) + snd->mixBuffer->loopStart;
+				}
+				else
+				{
+					snd->mixFlags &= ~SND_FLAG_PLAYING;
+					snd->mixFlags |= SND_FLAG_FINISHED;
+					snd->mixIndex = 0u;
 				}
-				continue;
 			}
+			return;
+		}
 
-			// Sample loop.
-			buffer = (f32*)outputBuffer;
-			// The sound may be split into multiple iterations if it loops or the loop
-			// may end early, once we reach the end.
-			for (u32 i = 0; i < bufferSize;)
+		// The sound may be split into multiple iterations if it loops or the loop
+		// may end early, once we reach the end.
+		for (u32 i = 0; i < bufferSize;)
+		{
+			if (snd->mixIndex >= sndBufferSize)
 			{
-				if (snd->sampleIndex >= sndBufferSize)
+				if (snd->mixFlags&SND_FLAG_LOOPING)
 				{
-					if (snd->flags&SND_FLAG_LOOPING)
-					{
-						snd->sampleIndex = snd->buffer->loopStart;
-					}
-					else
-					{
-						snd->flags &= ~SND_FLAG_PLAYING;
-						snd->flags |= SND_FLAG_FINISHED;
-						snd->sampleIndex = 0u;
-						break;
-					}
+					snd->mixIndex = snd->mixBuffer->loopStart;
 				}
-
-				const SoundDataType type = snd->buffer->type;
-				const u8* data = snd->buffer->data;
-				const u32 end = std::min(sndBufferSize, snd->sampleIndex + bufferSize - i);
-				u32 sIndex = snd->sampleIndex;
-				for (; sIndex < end; i++, sIndex++, buffer += 2)
+				else
 				{
-					const f32 sample = sampleBuffer(sIndex, type, data) * snd->volume;
-					buffer[0] += sample;
-					buffer[1] += sample;
+					snd->mixFlags &= ~SND_FLAG_PLAYING;
+					snd->mixFlags |= SND_FLAG_FINISHED;
+					snd->mixIndex = 0u;
+					break;
 				}
-				snd->sampleIndex = sIndex;
 			}
+
+			const u32 count = std::min(sndBufferSize - snd->mixIndex, bufferSize - i);
+			mixSamples(buffer + i * 2, snd->mixBuffer->type, snd->mixBuffer->data, snd->mixIndex, count, snd->mixVolume);
+			snd->mixIndex += count;
+			i += count;
 		}
-		// Cleanup sound sources while we are still in the mutex.
-		cleanupSources();
-		MUTEX_UNLOCK(&s_mutex);
+	}
 
-		// Finally handle out of range audio samples.
-		buffer = (f32*)outputBuffer;
-		for (u32 i = 0; i < bufferSize; i++, buffer += 2)
+	// Audio outside of the [-1, 1] range will cause overflow, which is a major artifact.
+	// Instead the audio needs to be limited in range, which can be done in several ways.
+	// Sigmoid functions map an arbitrary range into [-1, 1] generall along an S-Curve, allowing us to avoid overflow.
+	void limitOutput(f32* buffer, u32 sampleCount)
+	{
+		u32 i = 0;
+	#if AUDIO_SIMD_SSE2
+		const __m128 one = _mm_set1_ps(1.0f);
+	#if defined(AUDIO_SIGMOID_CLIP)
+		const __m128 limit = _mm_set1_ps(c_channelLimit);
+		const __m128 negLimit = _mm_set1_ps(-c_channelLimit);
+	#elif defined(AUDIO_SIGMOID_TANH)
+		const __m128 maxValue = _mm_set1_ps(4.8f);
+		const __m128 minValue = _mm_set1_ps(-4.8f);
+		const __m128 a0 = _mm_set1_ps(135135.0f), a1 = _mm_set1_ps(17325.0f), a2 = _mm_set1_ps(378.0f);
+		const __m128 b1 = _mm_set1_ps(62370.0f), b2 = _mm_set1_ps(3150.0f), b3 = _mm_set1_ps(28.0f);
+	#endif
+		for (; i + 4 <= sampleCount; i += 4)
 		{
-			const f32 valueLeft  = buffer[0];
-			const f32 valueRight = buffer[1];
-
-			// Audio outside of the [-1, 1] range will cause overflow, which is a major artifact.
-			// Instead the audio needs to be limited in range, which can be done in several ways.
-			// Sigmoid functions map an arbitrary range into [-1, 1] generall along an S-Curve, allowing us to avoid overflow.
+			const __m128 x = _mm_loadu_ps(buffer + i);
+		#if defined(AUDIO_SIGMOID_CLIP)
+			const __m128 y = _mm_max_ps(negLimit, _mm_min_ps(x, limit));
+		#elif defined(AUDIO_SIGMOID_TANH)
+			// Vector version of TFE_Math::tanhf_series(), including the saturation outside of [-4.8, 4.8].
+			const __m128 x2 = _mm_mul_ps(x, x);
+			const __m128 a = _mm_mul_ps(x, _mm_add_ps(a0, _mm_mul_ps(x2, _mm_add_ps(a1, _mm_mul_ps(x2, _mm_add_ps(a2, x2))))));
+			const __m128 b = _mm_add_ps(a0, _mm_mul_ps(x2, _mm_add_ps(b1, _mm_mul_ps(x2, _mm_add_ps(b2, _mm_mul_ps(x2, b3))))));
+			const __m128 r = _mm_div_ps(a, b);
+			const __m128 hi = _mm_cmpgt_ps(x, maxValue);
+			const __m128 lo = _mm_cmple_ps(x, minValue);
+			const __m128 sat = _mm_or_ps(_mm_and_ps(hi, one), _mm_and_ps(lo, _mm_sub_ps(_mm_setzero_ps(), one)));
+			const __m128 y = _mm_or_ps(_mm_andnot_ps(_mm_or_ps(hi, lo), r), sat);
+		#elif defined(AUDIO_SIGMOID_RCP_SQRT)
+			const __m128 y = _mm_div_ps(x, _mm_sqrt_ps(_mm_add_ps(one, _mm_mul_ps(x, x))));
+		#endif
+			_mm_storeu_ps(buffer + i, y);
+		}
+	#endif
+		for (; i < sampleCount; i++)
+		{
+			const f32 value = buffer[i];
 		#if defined(AUDIO_SIGMOID_CLIP)		// Not really a Sigmoid function but acts in a similar way, naively mapping to the required range.
-			buffer[0] = std::max(-c_channelLimit, std::min(valueLeft,  c_channelLimit));
-			buffer[1] = std::max(-c_channelLimit, std::min(valueRight, c_channelLimit));
+			buffer[i] = std::max(-c_channelLimit, std::min(value, c_channelLimit));
 		#elif defined(AUDIO_SIGMOID_TANH)	// Considered one of the most "musical sounding" sigmoid functions, it avoids hard clipping.
 			// Note the usable range is approximately -4.8 to 4.8 so the volumes should be adjusted to stay within those ranges when possible.
 			// Still much better than the effect -1 to 1 range with hard clipping and cheaper than the more accurate library tanh(). :)
-			buffer[0] = TFE_Math::tanhf_series(valueLeft);
-			buffer[1] = TFE_Math::tanhf_series(valueRight);
+			buffer[i] = TFE_Math::tanhf_series(value);
 		#elif defined(AUDIO_SIGMOID_RCP_SQRT)
-			buffer[0] = valueLeft  / sqrtf(1.0f + valueLeft * valueLeft);
-			buffer[1] = valueRight / sqrtf(1.0f + valueRight * valueRight);
+			buffer[i] = value / sqrtf(1.0f + value * value);
 		#endif
 		}
+	}
+
+	// Audio callback
+	s32 audioCallback(void *outputBuffer, void* inputBuffer, u32 bufferSize, f64 streamTime, u32 status, void* userData)
+	{
+		f32* buffer = (f32*)outputBuffer;
+		TFE_Profiler::setThreadName("AudioThread");
+		TFE_ZONE("Audio Mix");
+
+	#if AUDIO_TIMING == 1
+		u64 soundIterStart = TFE_System::getCurrentTimeInTicks();
+	#endif
+
+		s_inMix = true;
+		s_mixEpoch++;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		// First clear samples
+		memset(buffer, 0, sizeof(f32)*bufferSize*2);
+		const bool paused = s_paused.load();
+
+		// Then call the audio thread callback (iMuse), it keeps its own copy of the state it mixes.
+		const AudioThreadCallback audioThreadCallback = s_audioThreadCallback.load();
+		if (audioThreadCallback && !paused)
+		{
+			audioThreadCallback(buffer, bufferSize, s_soundFxVolume * c_soundHeadroom);
+		}
+
+		// Then loop through the sources.
+		// Note: this is no longer used by Dark Forces. However I decided to keep direct sound support around
+		// so it can be used for tools.
+		processCommands();
+		for (u32 s = 0; s < s_mixSourceCount && !paused; s++)
+		{
+			SoundSource* snd = &s_sources[s];
+			if (!(snd->mixFlags&SND_FLAG_PLAYING) || !snd->mixBuffer) { continue; }
+			assert(snd->mixBuffer->data);
+			mixSource(snd, buffer, bufferSize);
+		}
+		cleanupSources();
+		s_mixEpoch++;
+		s_inMix = false;
+
+		// Finally handle out of range audio samples.
+		limitOutput(buffer, bufferSize * 2);
 
 		// Timing
 	#if AUDIO_TIMING == 1
@@ -64,8 +64,12 @@ namespace TFE_Audio
 	void pause();
 	void resume();
 
+	// Serializes the clients of the audio system, the mixer never takes this lock.
 	void lock();
 	void unlock();
+	// Wait until the mix in progress on the audio thread, if any, is done.
+	// Changes made before the call are seen by every later mix.
+	void waitForMix();
 
 	void setAudioThreadCallback(AudioThreadCallback callback = nullptr);
 
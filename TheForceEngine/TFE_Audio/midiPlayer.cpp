@@ -4,6 +4,7 @@
 #include <TFE_Asset/gmidAsset.h>
 #include <TFE_System/system.h>
 #include <TFE_System/Threads/thread.h>
+#include <TFE_System/profiler.h>
 #include <TFE_Settings/settings.h>
 #include <TFE_FrontEndUI/console.h>
 #include <algorithm>
@@ -55,6 +56,7 @@ namespace TFE_MidiPlayer
 	static Mutex s_mutex;
 
 	static MidiCallback s_midiCallback = {};
+	static MidiCaptureFunc s_messageCapture = nullptr;
 
 	// Hanging note detection.
 	struct Instrument
@@ -237,9 +239,21 @@ namespace TFE_MidiPlayer
 		s_curNoteTime = 0.0;
 	}
 		
+	void setMessageCapture(MidiCaptureFunc capture)
+	{
+		s_messageCapture = capture;
+	}
+
 	void sendMessageDirect(u8 type, u8 arg1, u8 arg2)
 	{
 		u8 msg[] = { type, arg1, arg2 };
+		if (s_messageCapture)
+		{
+			// Program change and channel pressure only have a single data byte.
+			const u8 msgType = (type & 0xf0);
+			s_messageCapture(msg, (msgType == MID_PROGRAM_CHANGE || msgType == MID_CHANNEL_PRESSURE) ? 2 : 3);
+			return;
+		}
 		u8 msgType = (type & 0xf0);
 		if (msgType == MID_CONTROL_CHANGE && arg1 == MID_VOLUME_MSB)
 		{
@@ -302,6 +316,7 @@ namespace TFE_MidiPlayer
 		u64 localTime = 0;
 		u64 localTimeCallback = 0;
 		f64 dt = 0.0;
+		TFE_Profiler::setThreadName("MidiThread");
 		while (runThread)
 		{
 			MUTEX_LOCK(&s_mutex);
@@ -342,6 +357,7 @@ namespace TFE_MidiPlayer
 			// Process the midi callback, if it exists.
 			if (s_midiCallback.callback && !isPaused)
 			{
+				TFE_ZONE("Midi Callback");
 				s_midiCallback.accumulator += TFE_System::updateThreadLocal(&localTimeCallback);
 				while (s_midiCallback.callback && s_midiCallback.accumulator >= s_midiCallback.timeStep)
 				{
@@ -358,6 +374,7 @@ namespace TFE_MidiPlayer
 			runThread = s_runMusicThread.load();
 		};
 		
+		TFE_Profiler::releaseThread();
 		return (TFE_THREADRET)0;
 	}
 
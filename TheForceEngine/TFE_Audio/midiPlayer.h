@@ -21,6 +21,11 @@ namespace TFE_MidiPlayer
 	// Note: this should be called from the midi thread.
 	void sendMessageDirect(u8 type, u8 arg1=0, u8 arg2=0);
 
+	// Redirect messages sent with sendMessageDirect() to 'capture' instead of the midi device,
+	// volumes are passed through without the master volume applied. Used for offline rendering.
+	typedef void(*MidiCaptureFunc)(const u8* msg, u32 size);
+	void setMessageCapture(MidiCaptureFunc capture = nullptr);
+
 	// Callback
 	void midiSetCallback(void(*callback)(void) = nullptr, f64 timeStep = 0.0);
 	void midiClearCallback();
@@ -17,6 +17,7 @@
 #include <TFE_Jedi/InfSystem/message.h>
 #include <TFE_Jedi/Memory/list.h>
 #include <TFE_Jedi/Memory/allocator.h>
+#include <TFE_Memory/snapshot.h>
 
 using namespace TFE_Jedi;
 
@@ -67,6 +68,16 @@ namespace TFE_DarkForces
 		list_clear(s_physicsActors);
 	}
 
+	// TFE: the actor state that changes during play, for snapshots.
+	// The per-enemy "current" pointers are only valid during a task update and the instance counters only
+	// name the tasks, so they are not needed.
+	void actor_registerSnapshot()
+	{
+		SNAPSHOT_GLOBAL(s_istate);
+		SNAPSHOT_GLOBAL(s_physicsActors);
+		SNAPSHOT_GLOBAL(s_actorState);
+	}
+
 	void actor_loadSounds()
 	{
 		s_alertSndSrc[ALERT_GAMOR]    = sound_load("gamor-3.voc",  SOUND_PRIORITY_MED5);
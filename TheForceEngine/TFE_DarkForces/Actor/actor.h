@@ -110,6 +110,7 @@ struct ActorState
 namespace TFE_DarkForces
 {
 	void actor_clearState();
+	void actor_registerSnapshot();
 
 	void actor_loadSounds();
 	void actor_allocatePhysicsActorList();
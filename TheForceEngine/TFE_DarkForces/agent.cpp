@@ -112,6 +112,18 @@ namespace TFE_DarkForces
 		return s_levelGamePaths[s_levelIndex - 1];
 	}
 
+	s32 agent_getLevelIndexByName(const char* name)
+	{
+		for (s32 i = 0; i < s_maxLevelIndex; i++)
+		{
+			if (s_levelGamePaths[i] && strcasecmp(s_levelGamePaths[i], name) == 0)
+			{
+				return i + 1;
+			}
+		}
+		return -1;
+	}
+
 	void  agent_setLevelComplete(JBool complete)
 	{
 		s_levelComplete = complete;
@@ -56,6 +56,8 @@ namespace TFE_DarkForces
 	void  agent_setNextLevelByIndex(s32 index);
 	s32   agent_getLevelIndex();
 	const char* agent_getLevelName();
+	// Returns the index of the level with the given name or -1 if not found.
+	s32   agent_getLevelIndexByName(const char* name);
 
 	void  agent_setLevelComplete(JBool complete);
 	JBool agent_getLevelComplete();
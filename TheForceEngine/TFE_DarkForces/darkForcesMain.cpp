@@ -5,12 +5,14 @@
 #include "config.h"
 #include "briefingList.h"
 #include "gameMessage.h"
+#include "gameSnapshot.h"
 #include "gameMusic.h"
 #include "hud.h"
 #include "item.h"
 #include "mission.h"
 #include "player.h"
 #include "projectile.h"
+#include "soundRender.h"
 #include "time.h"
 #include "weapon.h"
 #include "vueLogic.h"
@@ -25,8 +27,10 @@
 #include <TFE_DarkForces/Landru/cutsceneList.h>
 #include <TFE_DarkForces/Actor/actor.h>
 #include <TFE_Game/reticle.h>
+#include <TFE_Settings/settings.h>
 #include <TFE_Memory/memoryRegion.h>
 #include <TFE_System/system.h>
+#include <TFE_System/benchmark.h>
 #include <TFE_FileSystem/paths.h>
 #include <TFE_FileSystem/fileutil.h>
 #include <TFE_FileSystem/filestream.h>
@@ -36,6 +40,7 @@
 #include <TFE_Archive/archive.h>
 #include <TFE_Archive/zipArchive.h>
 #include <TFE_Archive/gobMemoryArchive.h>
+#include <TFE_Jedi/Collision/collision.h>
 #include <TFE_Jedi/Level/rfont.h>
 #include <TFE_Jedi/Level/level.h>
 #include <TFE_Jedi/InfSystem/infSystem.h>
@@ -209,6 +214,8 @@ namespace TFE_DarkForces
 	void freeAllMidi();
 	void pauseLevelSound();
 	void resumeLevelSound();
+	JBool launchLevel(const char* levelName);
+	void benchmark_updateCamera();
 
 	/////////////////////////////////////////////
 	// API
@@ -241,6 +248,9 @@ namespace TFE_DarkForces
 		
 		// TFE Specific
 		actorDebug_init();
+		collision_init();
+		gameSnapshot_init();
+		soundRender_init();
 
 		return true;
 	}
@@ -257,6 +267,7 @@ namespace TFE_DarkForces
 		briefingList_freeBuffer();
 		cutsceneList_freeBuffer();
 		lsystem_destroy();
+		gameSnapshot_shutdown();
 
 		// Clear paths and archives.
 		TFE_Paths::clearSearchPaths();
@@ -289,6 +300,15 @@ namespace TFE_DarkForces
 		actorDebug_free();
 	}
 
+	void DarkForces::endFrame()
+	{
+		sound_update();
+		if (s_state == GSTATE_MISSION)
+		{
+			mission_endFrame();
+		}
+	}
+
 	void DarkForces::pauseGame(bool pause)
 	{
 		mission_pause(pause ? JTRUE : JFALSE);
@@ -377,12 +397,27 @@ namespace TFE_DarkForces
 	****************************************************/
 	void DarkForces::loopGame()
 	{
+		// TFE: The fixed timestep can be changed from the settings while playing.
+		time_setFixedStep(TFE_Settings::getGameSettings()->df_fixedTimestep);
 		updateTime();
 
 		switch (s_state)
 		{
 			case GSTATE_STARTUP_CUTSCENES:
 			{
+				// TFE: the level given on the command line is started directly.
+				if (s_launchLevelName)
+				{
+					const char* levelName = s_launchLevelName;
+					s_launchLevelName = nullptr;
+					if (launchLevel(levelName))
+					{
+						break;
+					}
+					TFE_System::logWrite(LOG_ERROR, "DarkForcesMain", "Cannot launch level '%s'.", levelName);
+					TFE_Benchmark::fail("Cannot launch the level.");
+				}
+
 				cutscene_play(10);
 				s_state = GSTATE_CUTSCENE;
 				s_invalidLevelIndex = JTRUE;
@@ -452,8 +487,17 @@ namespace TFE_DarkForces
 			{
 				// At this point the mission has already been launched.
 				// The task system will take over. Basically every frame we just check to see if there are any tasks running.
+				gameSnapshot_update();
+				if (TFE_Benchmark::isRunning())
+				{
+					benchmark_updateCamera();
+				}
+
 				if (!task_getCount())
 				{
+					TFE_Benchmark::levelEnded();
+					gameSnapshot_levelEnd();
+
 					// We have returned from the mission tasks.
 					renderer_reset();
 					gameMusic_stop();
@@ -486,6 +530,62 @@ namespace TFE_DarkForces
 		}
 	}
 
+	// TFE: skip the menus, cutscenes and briefing and go straight into the mission.
+	JBool launchLevel(const char* levelName)
+	{
+		const s32 levelIndex = agent_getLevelIndexByName(levelName);
+		if (levelIndex < 0)
+		{
+			return JFALSE;
+		}
+
+		for (s32 i = 0; i < TFE_ARRAYSIZE(s_cutsceneData); i++)
+		{
+			if (s_cutsceneData[i].levelIndex == levelIndex && s_cutsceneData[i].nextGameMode == GMODE_MISSION)
+			{
+				s_levelIndex = levelIndex;
+				s_cutsceneIndex = i;
+				s_invalidLevelIndex = JFALSE;
+				s_abortLevel = JFALSE;
+
+				agent_setNextLevelByIndex(levelIndex);
+				startNextMode();
+				return JTRUE;
+			}
+		}
+		return JFALSE;
+	}
+
+	// TFE: move the camera for the current benchmark frame, either along the path or turning in place.
+	void benchmark_updateCamera()
+	{
+		static angle14_32 s_benchmarkStartYaw = 0;
+		if (s_missionMode != MISSION_MODE_MAIN || !s_playerObject) { return; }
+
+		// The player should not die in the middle of the benchmark.
+		s_invincibility = -2;
+
+		const s32 frame = TFE_Benchmark::getFrame();
+		if (frame == 0)
+		{
+			s_benchmarkStartYaw = s_playerYaw;
+		}
+
+		TFE_Benchmark::BenchmarkPose pose;
+		if (TFE_Benchmark::getCameraPose(frame, &pose))
+		{
+			// Use the same conventions as the "warp" console command.
+			player_warpTo(floatToFixed16(pose.x), -floatToFixed16(pose.y), floatToFixed16(pose.z));
+			s_playerYaw = s32(pose.yaw * f32(ANGLE_MAX) / 360.0f) & ANGLE_MASK;
+		}
+		else
+		{
+			// One full turn over the whole run.
+			const s32 totalFrames = max(TFE_Benchmark::getTotalFrames(), 1);
+			s_playerYaw = (s_benchmarkStartYaw + s32(s64(frame) * ANGLE_MAX / totalFrames)) & ANGLE_MASK;
+		}
+	}
+
 	void loadCutsceneList()
 	{
 		s_cutsceneList = cutsceneList_load("cutscene.lst");
@@ -575,6 +675,7 @@ namespace TFE_DarkForces
 				actor_clearState();
 				actorDebug_clear();
 
+				gameSnapshot_levelStart();
 				task_reset();
 				inf_clearState();
 				s_loadMissionTask = createTask("start mission", mission_startTaskFunc, JTRUE);
@@ -14,6 +14,7 @@ namespace TFE_DarkForces
 		void pauseGame(bool pause) override;
 		void exitGame() override;
 		void loopGame() override;
+		void endFrame() override;
 	};
 
 	extern void saveLevelStatus();
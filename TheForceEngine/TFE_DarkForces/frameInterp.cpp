@@ -0,0 +1,203 @@
+#include "frameInterp.h"
+#include "player.h"
+#include "time.h"
+#include <TFE_Jedi/Level/level.h>
+#include <TFE_Jedi/Level/rsector.h>
+#include <TFE_Jedi/Level/robject.h>
+#include <TFE_Settings/settings.h>
+#include <algorithm>
+#include <vector>
+
+using namespace TFE_Jedi;
+
+namespace TFE_DarkForces
+{
+	// Objects that move further than this in a single step (teleports, respawns, reused objects) are not interpolated.
+	#define INTERP_MAX_MOVE FIXED(32)
+
+	struct InterpState
+	{
+		SecObject* obj;
+		vec3_fixed pos;
+		angle14_16 pitch;
+		angle14_16 yaw;
+		angle14_16 roll;
+	};
+
+	struct InterpRestore
+	{
+		SecObject* obj;
+		vec3_fixed pos;
+	};
+
+	static std::vector<InterpState> s_prevState;
+	static std::vector<InterpState> s_curState;
+	static std::vector<InterpRestore> s_restore;
+	static Tick s_stateTick = 0;
+	static JBool s_hasState = JFALSE;
+
+	// Restore data for the camera.
+	static SecObject* s_eyeObj = nullptr;
+	static RSector* s_eyeSector = nullptr;
+	static angle14_16 s_eyeAngles[3];
+
+	static bool interpStateLess(const InterpState& a, const InterpState& b)
+	{
+		return a.obj < b.obj;
+	}
+
+	const InterpState* frameInterp_find(const std::vector<InterpState>& state, SecObject* obj)
+	{
+		InterpState key = { obj };
+		std::vector<InterpState>::const_iterator iState = std::lower_bound(state.begin(), state.end(), key, interpStateLess);
+		return (iState != state.end() && iState->obj == obj) ? &(*iState) : nullptr;
+	}
+
+	fixed16_16 frameInterp_lerp(fixed16_16 a, fixed16_16 b, fixed16_16 t)
+	{
+		return a + mul16(b - a, t);
+	}
+
+	angle14_16 frameInterp_lerpAngle(angle14_16 a, angle14_16 b, fixed16_16 t)
+	{
+		const s32 delta = ((s32(b) - s32(a) + 8192) & 16383) - 8192;
+		return angle14_16(s32(a) + round16(delta * t));
+	}
+
+	void frameInterp_reset()
+	{
+		s_prevState.clear();
+		s_curState.clear();
+		s_restore.clear();
+		s_hasState = JFALSE;
+		s_eyeObj = nullptr;
+	}
+
+	JBool frameInterp_update()
+	{
+		if (!time_getFixedStep())
+		{
+			if (s_hasState) { frameInterp_reset(); }
+			return JFALSE;
+		}
+		if (s_hasState && s_stateTick == s_curTick)
+		{
+			return JFALSE;
+		}
+		// Time went backwards (a snapshot was restored or a new level started), start over.
+		if (s_hasState && s_curTick < s_stateTick)
+		{
+			frameInterp_reset();
+		}
+
+		s_prevState.swap(s_curState);
+		s_curState.clear();
+		RSector* sector = s_sectors;
+		for (u32 i = 0; i < s_sectorCount; i++, sector++)
+		{
+			for (s32 objIndex = 0, objListIndex = 0; objIndex < sector->objectCount && objListIndex < sector->objectCapacity; objListIndex++)
+			{
+				SecObject* obj = sector->objectList[objListIndex];
+				if (!obj) { continue; }
+				objIndex++;
+
+				InterpState state = { obj, obj->posWS, obj->pitch, obj->yaw, obj->roll };
+				s_curState.push_back(state);
+			}
+		}
+		std::sort(s_curState.begin(), s_curState.end(), interpStateLess);
+
+		s_stateTick = s_curTick;
+		s_hasState = JTRUE;
+		return JTRUE;
+	}
+
+	JBool frameInterp_begin()
+	{
+		if (!s_hasState || s_prevState.empty() || !time_getFixedStep() || !TFE_Settings::getGameSettings()->df_interpolateFrames)
+		{
+			return JFALSE;
+		}
+		// Once a full step has passed, the objects are drawn where the last step left them.
+		const fixed16_16 t = floatToFixed16(time_getStepFraction(s_stateTick));
+
+		// Only objects that are still in the level are touched, the recorded pointers are never dereferenced.
+		s_restore.clear();
+		RSector* sector = s_sectors;
+		for (u32 i = 0; i < s_sectorCount; i++, sector++)
+		{
+			for (s32 objIndex = 0, objListIndex = 0; objIndex < sector->objectCount && objListIndex < sector->objectCapacity; objListIndex++)
+			{
+				SecObject* obj = sector->objectList[objListIndex];
+				if (!obj) { continue; }
+				objIndex++;
+
+				const InterpState* cur = frameInterp_find(s_curState, obj);
+				const InterpState* prev = cur ? frameInterp_find(s_prevState, obj) : nullptr;
+				if (!prev || (prev->pos.x == cur->pos.x && prev->pos.y == cur->pos.y && prev->pos.z == cur->pos.z))
+				{
+					continue;
+				}
+				if (TFE_Jedi::abs(cur->pos.x - prev->pos.x) > INTERP_MAX_MOVE || TFE_Jedi::abs(cur->pos.y - prev->pos.y) > INTERP_MAX_MOVE ||
+					TFE_Jedi::abs(cur->pos.z - prev->pos.z) > INTERP_MAX_MOVE)
+				{
+					continue;
+				}
+
+				InterpRestore restore = { obj, obj->posWS };
+				s_restore.push_back(restore);
+				obj->posWS.x = frameInterp_lerp(prev->pos.x, cur->pos.x, t);
+				obj->posWS.y = frameInterp_lerp(prev->pos.y, cur->pos.y, t);
+				obj->posWS.z = frameInterp_lerp(prev->pos.z, cur->pos.z, t);
+			}
+		}
+
+		// The camera also turns smoothly, and is placed in the sector that holds the interpolated position.
+		s_eyeObj = s_playerEye;
+		if (s_eyeObj)
+		{
+			s_eyeSector = s_eyeObj->sector;
+			s_eyeAngles[0] = s_eyeObj->pitch;
+			s_eyeAngles[1] = s_eyeObj->yaw;
+			s_eyeAngles[2] = s_eyeObj->roll;
+
+			const InterpState* cur = frameInterp_find(s_curState, s_eyeObj);
+			const InterpState* prev = cur ? frameInterp_find(s_prevState, s_eyeObj) : nullptr;
+			if (prev)
+			{
+				s_eyeObj->pitch = frameInterp_lerpAngle(prev->pitch, cur->pitch, t);
+				s_eyeObj->yaw   = frameInterp_lerpAngle(prev->yaw,   cur->yaw,   t);
+				s_eyeObj->roll  = frameInterp_lerpAngle(prev->roll,  cur->roll,  t);
+
+				if (s_eyeObj->posWS.x != cur->pos.x || s_eyeObj->posWS.y != cur->pos.y || s_eyeObj->posWS.z != cur->pos.z)
+				{
+					RSector* eyeSector = sector_which3D(s_eyeObj->posWS.x, s_eyeObj->posWS.y, s_eyeObj->posWS.z);
+					if (eyeSector)
+					{
+						s_eyeObj->sector = eyeSector;
+					}
+				}
+			}
+		}
+		return JTRUE;
+	}
+
+	void frameInterp_end()
+	{
+		const size_t count = s_restore.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			s_restore[i].obj->posWS = s_restore[i].pos;
+		}
+		s_restore.clear();
+
+		if (s_eyeObj)
+		{
+			s_eyeObj->sector = s_eyeSector;
+			s_eyeObj->pitch = s_eyeAngles[0];
+			s_eyeObj->yaw   = s_eyeAngles[1];
+			s_eyeObj->roll  = s_eyeAngles[2];
+			s_eyeObj = nullptr;
+		}
+	}
+}
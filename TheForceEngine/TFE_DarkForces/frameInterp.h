@@ -0,0 +1,22 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Frame Interpolation (TFE)
+// With a fixed simulation timestep, frames rendered between steps
+// move objects and the camera between their positions at the last
+// two steps. The state is recorded after each simulation step and
+// applied only for the duration of a render.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+
+namespace TFE_DarkForces
+{
+	void frameInterp_reset();
+	// Record object positions and the camera angles, called after each simulation step.
+	// Returns JTRUE if a new state was recorded.
+	JBool frameInterp_update();
+
+	// Move objects and the camera to their interpolated positions, returns JFALSE if nothing was changed.
+	// Every successful begin must be matched by frameInterp_end() before the simulation runs again.
+	JBool frameInterp_begin();
+	void  frameInterp_end();
+}
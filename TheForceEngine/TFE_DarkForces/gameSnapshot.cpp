@@ -0,0 +1,209 @@
+#include <cstring>
+
+#include "gameSnapshot.h"
+#include "hud.h"
+#include "mission.h"
+#include "random.h"
+#include "sound.h"
+#include "time.h"
+#include "weapon.h"
+#include <TFE_DarkForces/Actor/actor.h>
+#include <TFE_Jedi/InfSystem/infSystem.h>
+#include <TFE_Jedi/Level/rsectorGrid.h>
+#include <TFE_Game/igame.h>
+#include <TFE_Memory/snapshot.h>
+#include <TFE_FrontEndUI/console.h>
+#include <TFE_System/system.h>
+#include <algorithm>
+
+using namespace TFE_Jedi;
+using namespace TFE_Memory;
+
+namespace TFE_DarkForces
+{
+	enum SnapshotRequest
+	{
+		SNAPSHOT_REQ_NONE = 0,
+		SNAPSHOT_REQ_SAVE,
+		SNAPSHOT_REQ_LOAD,
+		SNAPSHOT_REQ_REWIND,
+		SNAPSHOT_REQ_BENCHMARK,
+	};
+
+	enum
+	{
+		REWIND_SNAPSHOTS_PER_SECOND = 2,
+		REWIND_SECONDS = 30,
+		REWIND_INTERVAL = TICKS_PER_SECOND / REWIND_SNAPSHOTS_PER_SECOND,
+		SNAPSHOT_BENCH_COUNT = 100,
+	};
+
+	static bool s_rewindEnabled = false;
+	static bool s_snapshotInit = false;
+	static Tick s_lastCaptureTick = 0;
+	// Console commands only queue the request, snapshots are taken and restored between frames.
+	static SnapshotRequest s_request = SNAPSHOT_REQ_NONE;
+	static s32 s_requestValue = 0;
+
+	void console_snapshotSave(const ConsoleArgList& args)
+	{
+		s_request = SNAPSHOT_REQ_SAVE;
+	}
+
+	void console_snapshotLoad(const ConsoleArgList& args)
+	{
+		s_request = SNAPSHOT_REQ_LOAD;
+	}
+
+	void console_rewind(const ConsoleArgList& args)
+	{
+		const f32 seconds = args.size() >= 2 ? TFE_Console::getFloatArg(args[1]) : 1.0f;
+		s_request = SNAPSHOT_REQ_REWIND;
+		s_requestValue = s32(seconds * REWIND_SNAPSHOTS_PER_SECOND + 0.5f);
+	}
+
+	void console_snapshotBenchmark(const ConsoleArgList& args)
+	{
+		s_request = SNAPSHOT_REQ_BENCHMARK;
+		s_requestValue = args.size() >= 2 ? s32(TFE_Console::getFloatArg(args[1])) : SNAPSHOT_BENCH_COUNT;
+	}
+
+	void gameSnapshot_init()
+	{
+		snapshot_registerRegion(s_gameRegion);
+		snapshot_registerRegion(s_levelRegion);
+		snapshot_registerRegion(s_resRegion);
+		time_registerSnapshot();
+		random_registerSnapshot();
+		weapon_registerSnapshot();
+		hud_registerSnapshot();
+		actor_registerSnapshot();
+		sound_registerSnapshot();
+		inf_registerSnapshot();
+		sectorGrid_registerSnapshot();
+		snapshot_setCapacity(REWIND_SECONDS * REWIND_SNAPSHOTS_PER_SECOND);
+
+		if (s_snapshotInit) { return; }
+		s_snapshotInit = true;
+		CVAR_BOOL(s_rewindEnabled, "g_rewind", CVFLAG_NONE, "Keep snapshots of the last 30 seconds of the mission so it can be rewound.");
+		CCMD("snapshotSave", console_snapshotSave, 0, "Save the mission state in memory.");
+		CCMD("snapshotLoad", console_snapshotLoad, 0, "Restore the mission state saved with snapshotSave.");
+		CCMD("rewind", console_rewind, 0, "rewind [seconds] - rewind the mission, requires g_rewind. Default: 1 second.");
+		CCMD("snapshotBenchmark", console_snapshotBenchmark, 0, "snapshotBenchmark [count] - time snapshot capture and restore, clears the rewind history.");
+	}
+
+	void gameSnapshot_shutdown()
+	{
+		snapshot_unregisterAll();
+		s_request = SNAPSHOT_REQ_NONE;
+	}
+
+	void gameSnapshot_levelStart()
+	{
+		snapshot_clear();
+		snapshot_clearSave();
+		s_lastCaptureTick = s_curTick;
+		s_request = SNAPSHOT_REQ_NONE;
+	}
+
+	void gameSnapshot_levelEnd()
+	{
+		gameSnapshot_levelStart();
+	}
+
+	void gameSnapshot_benchmark(s32 count)
+	{
+		char msg[256];
+		SnapshotStats stats;
+		snapshot_getStats(&stats);
+		if (stats.count > 1)
+		{
+			sprintf(msg, "Rewind history: %d snapshots, average %.1f KB per snapshot.", stats.count, f64(stats.undoSize) / f64(stats.count - 1) / 1024.0);
+			TFE_Console::addToHistory(msg);
+		}
+
+		// The first capture copies everything, the following ones only the pages that changed.
+		snapshot_clear();
+		snapshot_capture();
+		snapshot_getStats(&stats);
+		sprintf(msg, "Full snapshot: %.3f ms, %.2f MB.", stats.lastCaptureTime * 1000.0, f64(stats.imageSize) / (1024.0 * 1024.0));
+		TFE_Console::addToHistory(msg);
+
+		f64 captureTime = 0.0;
+		size_t captureSize = 0;
+		for (s32 i = 0; i < count; i++)
+		{
+			snapshot_capture();
+			snapshot_getStats(&stats);
+			captureTime += stats.lastCaptureTime;
+			captureSize += stats.lastCaptureSize;
+		}
+		if (count > 0)
+		{
+			sprintf(msg, "Incremental snapshot: %.3f ms, %u bytes (average of %d).", captureTime * 1000.0 / f64(count), u32(captureSize / count), count);
+			TFE_Console::addToHistory(msg);
+		}
+
+		// Nothing changed in between, so this restores the current state.
+		if (snapshot_rewind(snapshot_getCount() - 1))
+		{
+			snapshot_getStats(&stats);
+			sprintf(msg, "Restore: %.3f ms.", stats.lastRestoreTime * 1000.0);
+			TFE_Console::addToHistory(msg);
+		}
+		s_lastCaptureTick = s_curTick;
+	}
+
+	void gameSnapshot_update()
+	{
+		if (s_missionMode != MISSION_MODE_MAIN) { return; }
+
+		const SnapshotRequest request = s_request;
+		s_request = SNAPSHOT_REQ_NONE;
+		switch (request)
+		{
+			case SNAPSHOT_REQ_SAVE:
+			{
+				snapshot_save();
+				TFE_Console::addToHistory("Mission state saved.");
+			} break;
+			case SNAPSHOT_REQ_LOAD:
+			{
+				if (snapshot_load())
+				{
+					s_lastCaptureTick = s_curTick;
+					TFE_Console::addToHistory("Mission state restored.");
+				}
+				else
+				{
+					TFE_Console::addToHistory("There is no saved mission state to restore.");
+				}
+			} break;
+			case SNAPSHOT_REQ_REWIND:
+			{
+				if (!s_rewindEnabled)
+				{
+					TFE_Console::addToHistory("Rewind is disabled, set g_rewind to true to enable it.");
+				}
+				else if (snapshot_rewind(std::min(s_requestValue, snapshot_getCount() - 1)))
+				{
+					s_lastCaptureTick = s_curTick;
+				}
+				else
+				{
+					TFE_Console::addToHistory("There is no snapshot to rewind to.");
+				}
+			} break;
+			case SNAPSHOT_REQ_BENCHMARK:
+			{
+				gameSnapshot_benchmark(s_requestValue);
+			} break;
+		}
+
+		if (s_rewindEnabled && s_curTick - s_lastCaptureTick >= REWIND_INTERVAL)
+		{
+			snapshot_capture();
+			s_lastCaptureTick = s_curTick;
+		}
+	}
+}  // namespace TFE_DarkForces
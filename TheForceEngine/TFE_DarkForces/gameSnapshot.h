@@ -0,0 +1,20 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// TFE Specific in-memory snapshots of the mission state, used for
+// quick save/load and rewinding.
+// The game, level and resource regions are captured along with the
+// time, random seed, task system and player state.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+
+namespace TFE_DarkForces
+{
+	void gameSnapshot_init();
+	void gameSnapshot_shutdown();
+
+	// Snapshots do not survive the level, they are cleared when it starts and ends.
+	void gameSnapshot_levelStart();
+	void gameSnapshot_levelEnd();
+	// Called every frame during the mission, outside of the task system.
+	void gameSnapshot_update();
+}  // namespace TFE_DarkForces
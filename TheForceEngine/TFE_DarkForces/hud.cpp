@@ -10,6 +10,7 @@
 #include <TFE_System/system.h>
 #include <TFE_Settings/settings.h>
 #include <TFE_FrontEndUI/console.h>
+#include <TFE_Memory/snapshot.h>
 #include <TFE_Jedi/Renderer/jediRenderer.h>
 #include <TFE_Jedi/Renderer/screenDraw.h>
 #include <TFE_Jedi/Level/rfont.h>
@@ -247,6 +248,20 @@ namespace TFE_DarkForces
 		s_showData = ~s_showData;
 	}
 
+	// TFE: the HUD message and screen effects follow the game state, the HUD graphics are redrawn as values change.
+	void hud_registerSnapshot()
+	{
+		SNAPSHOT_GLOBAL(s_hudMessage);
+		SNAPSHOT_GLOBAL(s_hudCurrentMsgId);
+		SNAPSHOT_GLOBAL(s_hudMsgPriority);
+		SNAPSHOT_GLOBAL(s_hudMsgExpireTick);
+		SNAPSHOT_GLOBAL(s_flashEffect);
+		SNAPSHOT_GLOBAL(s_healthDamageFx);
+		SNAPSHOT_GLOBAL(s_shieldDamageFx);
+		SNAPSHOT_GLOBAL(s_secretsFound);
+		SNAPSHOT_GLOBAL(s_secretsPercent);
+	}
+
 	void hud_startup()
 	{
 		// Reset cached values.
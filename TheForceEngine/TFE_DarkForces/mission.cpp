@@ -12,6 +12,7 @@
 #include "projectile.h"
 #include "weapon.h"
 #include "darkForcesMain.h"
+#include "frameInterp.h"
 #include <TFE_DarkForces/Actor/actor.h>
 #include <TFE_DarkForces/GameUI/escapeMenu.h>
 #include <TFE_DarkForces/GameUI/pda.h>
@@ -31,7 +32,9 @@
 #include <TFE_FrontEndUI/frontEndUi.h>
 #include <TFE_FrontEndUI/console.h>
 #include <TFE_System/system.h>
+#include <TFE_System/benchmark.h>
 #include <TFE_Input/inputMapping.h>
+#include <assert.h>
 
 using namespace TFE_Jedi;
 using namespace TFE_Input;
@@ -91,11 +94,17 @@ namespace TFE_DarkForces
 
 	static s32 s_visionFxCountdown = 0;
 	static s32 s_visionFxEndCountdown = 0;
+	// TFE: Fixed timestep rendering.
+	static JBool s_deferRender = JFALSE;	// the current main task update leaves rendering to mission_endFrame().
+	static JBool s_renderPending = JFALSE;	// a main task update ran since the last render.
 
 	/////////////////////////////////////////////
 	// Forward Declarations
 	/////////////////////////////////////////////
 	void mission_mainTaskFunc(MessageType msg);
+	void mission_stepEnd();
+	void mission_repeatStep();
+	JBool mission_deferRender();
 	void setPalette(u8* pal);
 	void blitLoadingScreen();
 	void displayLoadingScreen();
@@ -154,6 +163,17 @@ namespace TFE_DarkForces
 
 	void mission_createRenderDisplay()
 	{
+		// TFE: the benchmark picks the sub-renderer and resolution, independent of the settings.
+		if (TFE_Benchmark::isActive())
+		{
+			const TFE_Benchmark::BenchmarkSettings* bench = TFE_Benchmark::getSettings();
+			vfb_setResolution(bench->width, bench->height);
+			s_framebuffer = vfb_getCpuBuffer();
+			TFE_Jedi::setSubRenderer(bench->floatRenderer ? TSR_HIGH_RESOLUTION : TSR_CLASSIC_FIXED);
+			automap_resetScale();
+			return;
+		}
+
 		TFE_Settings_Graphics* graphics = TFE_Settings::getGraphicsSettings();
 		DisplayInfo info;
 		TFE_RenderBackend::getDisplayInfo(&info);
@@ -201,6 +221,10 @@ namespace TFE_DarkForces
 			s_prevTick = s_curTick;
 			s_playerTick = s_curTick;
 			s_mainTask = createTask("main task", mission_mainTaskFunc);
+			task_setStepCallback(mission_stepEnd);
+			task_setRepeatStepCallback(mission_repeatStep);
+			frameInterp_reset();
+			s_renderPending = JFALSE;
 
 			s_invalidLevelIndex = JFALSE;
 			s_levelComplete = JFALSE;
@@ -256,6 +280,7 @@ namespace TFE_DarkForces
 					s_gamePaused = JFALSE;
 					mission_createRenderDisplay();
 					hud_startup();
+					TFE_Benchmark::levelStarted();
 
 					// TFE
 					reticle_enable(true);
@@ -333,6 +358,74 @@ namespace TFE_DarkForces
 		}
 	}
 
+	// TFE: Called after each fixed timestep update, records the state that rendering interpolates between.
+	void mission_stepEnd()
+	{
+		if (s_mainTask && s_missionMode == MISSION_MODE_MAIN)
+		{
+			frameInterp_update();
+		}
+	}
+
+	// TFE: Called before the second and later fixed timestep updates in a frame.
+	// Input is read once per frame, so a press is only seen by the first update - otherwise toggles would fire
+	// once per update and could cancel out.
+	void mission_repeatStep()
+	{
+		TFE_Input::endFrame();
+		inputMapping_clearPressed();
+	}
+
+	// TFE: With a fixed timestep, the main task may run several times per frame (or not at all), so it leaves the
+	// world and HUD rendering to mission_endFrame() which draws it once per displayed frame.
+	JBool mission_deferRender()
+	{
+		return time_getFixedStep() && s_missionMode == MISSION_MODE_MAIN && !escapeMenu_isOpen() && !pda_isOpen();
+	}
+
+	// TFE: Called once the tasks have run for the frame.
+	void mission_endFrame()
+	{
+		if (!s_mainTask || s_missionMode != MISSION_MODE_MAIN || task_getCount() <= 1 || !time_getFixedStep())
+		{
+			frameInterp_reset();
+			s_renderPending = JFALSE;
+			return;
+		}
+		// Frames without a simulation step are only drawn when they can show objects moving between the steps.
+		if (!s_renderPending && (s_gamePaused || escapeMenu_isOpen() || pda_isOpen() || !TFE_Settings::getGameSettings()->df_interpolateFrames))
+		{
+			return;
+		}
+		s_renderPending = JFALSE;
+
+		s_framebuffer = vfb_getCpuBuffer();
+		TFE_Jedi::beginRender();
+
+		// Objects and the camera are drawn between the last two steps.
+		const JBool interpolate = frameInterp_begin();
+		player_setupCamera();
+		updateScreensize();
+		drawWorld(s_framebuffer, s_playerEye->sector, s_levelColorMap, s_lightSourceRamp);
+		weapon_draw(s_framebuffer, (DrawRect*)vfb_getScreenRect(VFB_RECT_UI));
+		if (interpolate)
+		{
+			// The game logic must see the real positions.
+			frameInterp_end();
+			player_setupCamera();
+		}
+
+		if (s_drawAutomap)
+		{
+			automap_draw(s_framebuffer);
+		}
+		hud_drawAndUpdate(s_framebuffer);
+		hud_drawMessage(s_framebuffer);
+
+		TFE_Jedi::endRender();
+		vfb_swap();
+	}
+
 	void mission_mainTaskFunc(MessageType msg)
 	{
 		task_begin;
@@ -346,7 +439,11 @@ namespace TFE_DarkForces
 
 			// Grab the current framebuffer in case in changed.
 			s_framebuffer = vfb_getCpuBuffer();
-			TFE_Jedi::beginRender();
+			s_deferRender = mission_deferRender();
+			if (!s_deferRender)
+			{
+				TFE_Jedi::beginRender();
+			}
 
 			// Handle delta time.
 			s_deltaTime = div16(intToFixed16(s_curTick - s_prevTick), FIXED(TICKS_PER_SECOND));
@@ -354,7 +451,13 @@ namespace TFE_DarkForces
 			s_prevTick  = s_curTick;
 			s_playerTick = s_curTick;
 
-			if (!escapeMenu_isOpen() && !pda_isOpen())
+			if (s_deferRender)
+			{
+				player_setupCamera();
+				handleVisionFx();
+				s_renderPending = JTRUE;
+			}
+			else if (!escapeMenu_isOpen() && !pda_isOpen())
 			{
 				player_setupCamera();
 
@@ -375,12 +478,15 @@ namespace TFE_DarkForces
 			{
 				handleGeneralInput();
 				handlePaletteFx();
-				if (s_drawAutomap)
+				if (!s_deferRender)
 				{
-					automap_draw(s_framebuffer);
+					if (s_drawAutomap)
+					{
+						automap_draw(s_framebuffer);
+					}
+					hud_drawAndUpdate(s_framebuffer);
+					hud_drawMessage(s_framebuffer);
 				}
-				hud_drawAndUpdate(s_framebuffer);
-				hud_drawMessage(s_framebuffer);
 			}
 			else
 			{
@@ -436,8 +542,11 @@ namespace TFE_DarkForces
 			}
 
 			// vgaSwapBuffers() in the DOS code.
-			TFE_Jedi::endRender();
-			vfb_swap();
+			if (!s_deferRender)
+			{
+				TFE_Jedi::endRender();
+				vfb_swap();
+			}
 
 			// Pump tasks and look for any with a different ID.
 			do
@@ -983,8 +1092,26 @@ namespace TFE_DarkForces
 		TFE_Input::clearAccumulatedMouseMove();
 	}
 
+	// TFE: A single press must only toggle once, even when several fixed timestep updates run in the same frame.
+	JBool mission_pressOnlyInFirstStep()
+	{
+		if (task_getFrameStep() == 0)
+		{
+			return JTRUE;
+		}
+		for (s32 i = 0; i < IA_COUNT; i++)
+		{
+			if (inputMapping_getActionState(InputAction(i)) == STATE_PRESSED)
+			{
+				return JFALSE;
+			}
+		}
+		return JTRUE;
+	}
+
 	void handleGeneralInput()
 	{
+		assert(mission_pressOnlyInFirstStep());
 		// In the DOS code, the game would just loop here - checking to see if paused has been pressed and then continue.
 		// Obviously that won't work for TFE, so the game paused variable is set and the game will have to handle it.
 		if (inputMapping_getActionState(IADF_PAUSE) == STATE_PRESSED)
@@ -35,6 +35,7 @@ namespace TFE_DarkForces
 	void disableNightvision();
 
 	void mission_render(s32 rendererIndex = 0);
+	void mission_endFrame();
 		
 	extern JBool s_gamePaused;
 	extern GameMissionMode s_missionMode;
@@ -25,6 +25,7 @@
 #include <TFE_Jedi/Renderer/jediRenderer.h>
 #include <TFE_Jedi/Renderer/RClassic_Fixed/rclassicFixed.h>
 #include <TFE_Audio/audioSystem.h>
+#include <TFE_Memory/snapshot.h>
 
 using namespace TFE_Input;
 
@@ -284,6 +285,98 @@ namespace TFE_DarkForces
 		s_reviveTick = 0;
 
 		CCMD("warp", player_warp, 3, "Warp to the specific x, y, z position.");
+
+		// TFE: the player state that changes during play, for snapshots.
+		SNAPSHOT_GLOBAL(s_externalYawSpd);
+		SNAPSHOT_GLOBAL(s_playerPitch);
+		SNAPSHOT_GLOBAL(s_playerRoll);
+		SNAPSHOT_GLOBAL(s_forwardSpd);
+		SNAPSHOT_GLOBAL(s_strafeSpd);
+		SNAPSHOT_GLOBAL(s_maxMoveDist);
+		SNAPSHOT_GLOBAL(s_playerStopAccel);
+		SNAPSHOT_GLOBAL(s_minEyeDistFromFloor);
+		SNAPSHOT_GLOBAL(s_postLandVel);
+		SNAPSHOT_GLOBAL(s_landUpVel);
+		SNAPSHOT_GLOBAL(s_playerVelX);
+		SNAPSHOT_GLOBAL(s_playerUpVel);
+		SNAPSHOT_GLOBAL(s_playerUpVel2);
+		SNAPSHOT_GLOBAL(s_playerVelZ);
+		SNAPSHOT_GLOBAL(s_externalVelX);
+		SNAPSHOT_GLOBAL(s_externalVelZ);
+		SNAPSHOT_GLOBAL(s_playerCrouchSpd);
+		SNAPSHOT_GLOBAL(s_playerSpeedAve);
+		SNAPSHOT_GLOBAL(s_prevDistFromFloor);
+		SNAPSHOT_GLOBAL(s_wpnSin);
+		SNAPSHOT_GLOBAL(s_wpnCos);
+		SNAPSHOT_GLOBAL(s_moveDirX);
+		SNAPSHOT_GLOBAL(s_moveDirZ);
+		SNAPSHOT_GLOBAL(s_dist);
+		SNAPSHOT_GLOBAL(s_distScale);
+		SNAPSHOT_GLOBAL(s_levelAtten);
+		SNAPSHOT_GLOBAL(s_curSafe);
+		SNAPSHOT_GLOBAL(s_playerUse);
+		SNAPSHOT_GLOBAL(s_playerActionUse);
+		SNAPSHOT_GLOBAL(s_playerPrimaryFire);
+		SNAPSHOT_GLOBAL(s_playerSecFire);
+		SNAPSHOT_GLOBAL(s_playerJumping);
+		SNAPSHOT_GLOBAL(s_playerInWater);
+		SNAPSHOT_GLOBAL(s_limitStepHeight);
+		SNAPSHOT_GLOBAL(s_smallModeEnabled);
+		SNAPSHOT_GLOBAL(s_aiActive);
+		SNAPSHOT_GLOBAL(s_playerPos);
+		SNAPSHOT_GLOBAL(s_playerObjHeight);
+		SNAPSHOT_GLOBAL(s_playerObjPitch);
+		SNAPSHOT_GLOBAL(s_playerObjYaw);
+		SNAPSHOT_GLOBAL(s_playerObjSector);
+		SNAPSHOT_GLOBAL(s_playerSlideWall);
+		SNAPSHOT_GLOBAL(s_playerInfo);
+		SNAPSHOT_GLOBAL(s_playerLogic);
+		SNAPSHOT_GLOBAL(s_energy);
+		SNAPSHOT_GLOBAL(s_lifeCount);
+		SNAPSHOT_GLOBAL(s_playerLight);
+		SNAPSHOT_GLOBAL(s_headwaveVerticalOffset);
+		SNAPSHOT_GLOBAL(s_onFloor);
+		SNAPSHOT_GLOBAL(s_weaponLight);
+		SNAPSHOT_GLOBAL(s_baseAtten);
+		SNAPSHOT_GLOBAL(s_gravityAccel);
+		SNAPSHOT_GLOBAL(s_invincibility);
+		SNAPSHOT_GLOBAL(s_weaponFiring);
+		SNAPSHOT_GLOBAL(s_weaponFiringSec);
+		SNAPSHOT_GLOBAL(s_wearingCleats);
+		SNAPSHOT_GLOBAL(s_wearingGasmask);
+		SNAPSHOT_GLOBAL(s_nightvisionActive);
+		SNAPSHOT_GLOBAL(s_headlampActive);
+		SNAPSHOT_GLOBAL(s_superCharge);
+		SNAPSHOT_GLOBAL(s_superChargeHud);
+		SNAPSHOT_GLOBAL(s_playerSecMoved);
+		SNAPSHOT_GLOBAL(s_playerSector);
+		SNAPSHOT_GLOBAL(s_playerObject);
+		SNAPSHOT_GLOBAL(s_playerEye);
+		SNAPSHOT_GLOBAL(s_eyePos);
+		SNAPSHOT_GLOBAL(s_pitch);
+		SNAPSHOT_GLOBAL(s_yaw);
+		SNAPSHOT_GLOBAL(s_roll);
+		SNAPSHOT_GLOBAL(s_playerEyeFlags);
+		SNAPSHOT_GLOBAL(s_playerTick);
+		SNAPSHOT_GLOBAL(s_prevPlayerTick);
+		SNAPSHOT_GLOBAL(s_nextShieldDmgTick);
+		SNAPSHOT_GLOBAL(s_reviveTick);
+		SNAPSHOT_GLOBAL(s_nextPainSndTick);
+		SNAPSHOT_GLOBAL(s_playerTask);
+		SNAPSHOT_GLOBAL(s_playerYPos);
+		SNAPSHOT_GLOBAL(s_camOffset);
+		SNAPSHOT_GLOBAL(s_camOffsetPitch);
+		SNAPSHOT_GLOBAL(s_camOffsetYaw);
+		SNAPSHOT_GLOBAL(s_camOffsetRoll);
+		SNAPSHOT_GLOBAL(s_playerYaw);
+		SNAPSHOT_GLOBAL(s_itemUnknown1);
+		SNAPSHOT_GLOBAL(s_itemUnknown2);
+		SNAPSHOT_GLOBAL(s_playerHeight);
+		SNAPSHOT_GLOBAL(s_playerRun);
+		SNAPSHOT_GLOBAL(s_jumpScale);
+		SNAPSHOT_GLOBAL(s_playerSlow);
+		SNAPSHOT_GLOBAL(s_onMovingSurface);
+		SNAPSHOT_GLOBAL(s_playerDying);
 	}
 
 	void player_readInfo(u8* inv, s32* ammo)
@@ -2499,15 +2592,22 @@ namespace TFE_DarkForces
 		fixed16_16 x =  floatToFixed16(TFE_Console::getFloatArg(args[1]));
 		fixed16_16 y = -floatToFixed16(TFE_Console::getFloatArg(args[2]));
 		fixed16_16 z =  floatToFixed16(TFE_Console::getFloatArg(args[3]));
-		RSector* sector = sector_which3D(x, y, z);
+		player_warpTo(x, y, z);
+	}
 
-		if (sector)
+	JBool player_warpTo(fixed16_16 x, fixed16_16 y, fixed16_16 z)
+	{
+		RSector* sector = sector_which3D(x, y, z);
+		if (!sector || !s_playerObject)
 		{
-			s_playerObject->posWS = { x, y, z };
-			s_playerPos = s_playerObject->posWS;
-
-			sector_addObject(sector, s_playerObject);
-			s_playerSector = s_playerObject->sector;
+			return JFALSE;
 		}
+
+		s_playerObject->posWS = { x, y, z };
+		s_playerPos = s_playerObject->posWS;
+
+		sector_addObject(sector, s_playerObject);
+		s_playerSector = s_playerObject->sector;
+		return JTRUE;
 	}
 }  // TFE_DarkForces
\ No newline at end of file
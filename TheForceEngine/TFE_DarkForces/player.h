@@ -138,6 +138,8 @@ namespace TFE_DarkForces
 	void player_getVelocity(vec3_fixed* vel);
 	fixed16_16 player_getSquaredDistance(SecObject* obj);
 	void player_setupCamera();
+	// Move the player to the given position, returns JFALSE if the position is not inside of a sector.
+	JBool player_warpTo(fixed16_16 x, fixed16_16 y, fixed16_16 z);
 	void player_applyDamage(fixed16_16 healthDmg, fixed16_16 shieldDmg, JBool playHitSound);
 
 	JBool player_hasWeapon(s32 weaponIndex);
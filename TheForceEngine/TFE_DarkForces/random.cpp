@@ -1,4 +1,5 @@
 #include "random.h"
+#include <TFE_Memory/snapshot.h>
 
 namespace TFE_DarkForces
 {
@@ -41,4 +42,9 @@ namespace TFE_DarkForces
 	{
 		s_seed = seed;
 	}
+
+	void random_registerSnapshot()
+	{
+		SNAPSHOT_GLOBAL(s_seed);
+	}
 }  // TFE_DarkForces
\ No newline at end of file
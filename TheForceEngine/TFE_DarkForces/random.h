@@ -17,4 +17,5 @@ namespace TFE_DarkForces
 	s32 random_next();
 
 	void random_seed(u32 seed);
+	void random_registerSnapshot();
 }  // namespace TFE_DarkForces
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include <cstring>
+#include <string>
+#include <unordered_map>
 
 #include "sound.h"
 #include "player.h"
@@ -8,6 +10,10 @@
 #include <TFE_Asset/vocAsset.h>
 #include <TFE_Audio/audioSystem.h>
 #include <TFE_Audio/midiPlayer.h>
+#include <TFE_FrontEndUI/console.h>
+#include <TFE_Memory/snapshot.h>
+#include <TFE_System/profiler.h>
+#include <TFE_System/system.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Jedi/IMuse/imuse.h>
 #include <TFE_Jedi/Memory/allocator.h>
@@ -33,6 +39,32 @@ namespace TFE_DarkForces
 	#define MAX_LEVEL_SOUNDS 300
 	#define CUE_RING1 FIXED(30)
 	#define CUE_RING2 FIXED(150)
+	// Volume and pan changes to playing sounds are queued during the frame and resolved together in sound_update().
+	#define MAX_CUED_SOUNDS 256
+	#define CUE_HASH_SIZE 512		// Power of two, at least twice MAX_CUED_SOUNDS.
+	#define CUE_UNCHANGED -1
+
+	// Structure of arrays so the distance, volume and pan passes each walk tightly packed data.
+	// The position is stored relative to the listener at the time of the cue, so the result is the same as
+	// resolving the cue immediately even if the listener moves later in the frame.
+	struct SoundCueBatch
+	{
+		s32 count;
+		SoundEffectId id[MAX_CUED_SOUNDS];
+		fixed16_16 dx[MAX_CUED_SOUNDS];
+		fixed16_16 dy[MAX_CUED_SOUNDS];
+		fixed16_16 dz[MAX_CUED_SOUNDS];
+		angle14_32 yaw[MAX_CUED_SOUNDS];
+		s32 baseVolume[MAX_CUED_SOUNDS];
+		// Set by sound_setVolume() / sound_setPan() after the sound was cued, these take priority over the cue.
+		s32 volumeOverride[MAX_CUED_SOUNDS];
+		s32 panOverride[MAX_CUED_SOUNDS];
+		// Final iMuse values.
+		s32 volume[MAX_CUED_SOUNDS];
+		s32 pan[MAX_CUED_SOUNDS];
+		// Instance id -> entry index + 1, zero is empty.
+		s16 hash[CUE_HASH_SIZE];
+	};
 
 	// SoundID is structed as:
 	// <- Higher .... Lower ->
@@ -43,20 +75,34 @@ namespace TFE_DarkForces
 
 	static s32 s_tPan[32] = { 00,-06,-12,-18,-24,-30,-36,-42,-48,-42,-36,-30,-24,-18,-12,-06,00,06,12,18,24,30,36,42,48,42,36,30,24,18,12,06 };
 	static Allocator* s_gameSoundList = nullptr;
+	static std::unordered_map<std::string, GameSound*> s_gameSoundMap;	// Lowercase name -> sound.
+	static SoundCueBatch s_cueBatch = {};
 	static s32 s_instance = 1;
+	static s32 s_cueUpdateCount = 0;
 	s32 s_lastMaintainVolume;
 
 	SoundEffectId soundInstance(SoundSourceId soundId, s32 instance);
 	GameSound* getSoundPtr(SoundSourceId id);
 	void soundCalculateCue(GameSound* sound, fixed16_16 x, fixed16_16 y, fixed16_16 z, s32* vol, s32* pan);
+	s32  soundCalculateVolume(GameSound* sound, fixed16_16 x, fixed16_16 y, fixed16_16 z);
 	u8* sound_getResource(SoundEffectId id);
+	std::string soundKey(const char* name);
+	s32  sound_findCue(SoundEffectId id);
+	void sound_queueCue(SoundEffectId id, GameSound* sound, vec3_fixed pos);
+	void sound_resolveCues(SoundCueBatch* batch);
+	void sound_clearCues();
+	void console_soundCueBenchmark(const ConsoleArgList& args);
 
 	// Called at game startup and shutdown.
 	void sound_open(MemoryRegion* memRegion)
 	{
 		s_gameSoundList = allocator_create(sizeof(GameSound), s_gameRegion);
+		s_gameSoundMap.clear();
+		sound_clearCues();
 		s_instance = 0;
 		ImInitialize(memRegion);
+		TFE_COUNTER(s_cueUpdateCount, "Cued Sound Updates");
+		CCMD("soundCueBenchmark", console_soundCueBenchmark, 0, "soundCueBenchmark [iterations] - compare per sound cue calculations with the batched cue update.");
 		
 		TFE_Settings_Sound* sound = TFE_Settings::getSoundSettings();
 		if (sound->use16Channels)
@@ -70,6 +116,7 @@ namespace TFE_DarkForces
 		sound_levelStop();
 		allocator_free(s_gameSoundList);
 		s_gameSoundList = nullptr;
+		s_gameSoundMap.clear();
 		s_instance = 0;
 		ImTerminate();
 	}
@@ -94,22 +141,21 @@ namespace TFE_DarkForces
 	SoundSourceId sound_load(const char* fileName, u32 priority)
 	{
 		SoundSourceId newId = 0;
-		GameSound* sound = (GameSound*)allocator_getHead(s_gameSoundList);
-		while (sound)
+		const std::string key = soundKey(fileName);
+
+		std::unordered_map<std::string, GameSound*>::iterator iSound = s_gameSoundMap.find(key);
+		if (iSound != s_gameSoundMap.end())
 		{
-			if (!strcasecmp(fileName, sound->name))
-			{
-				sound->refCount++;
-				return soundInstance((SoundSourceId)sound, 0);
-			}
-			sound = (GameSound*)allocator_getNext(s_gameSoundList);
+			GameSound* sound = iSound->second;
+			sound->refCount++;
+			return soundInstance((SoundSourceId)sound, 0);
 		}
 
 		u32 size = 0;
 		u8* data = readVocFileData(fileName, &size);
 		if (data)
 		{
-			sound = (GameSound*)allocator_newItem(s_gameSoundList);
+			GameSound* sound = (GameSound*)allocator_newItem(s_gameSoundList);
 			sound->id = (SoundSourceId)sound;
 			sound->time = s_curTick;
 			sound->data = data;
@@ -119,6 +165,7 @@ namespace TFE_DarkForces
 			sound->volume = 127;
 			sound->refCount = 1;
 			newId = soundInstance(sound->id, 0);
+			s_gameSoundMap[key] = sound;
 		}
 
 		return newId;
@@ -138,6 +185,8 @@ namespace TFE_DarkForces
 					game_free(sound->data);
 				}
 				sound->data = nullptr;
+
+				s_gameSoundMap.erase(soundKey(sound->name));
 				allocator_deleteItem(s_gameSoundList, sound);
 			}
 		}
@@ -156,7 +205,16 @@ namespace TFE_DarkForces
 	{
 		if (id)
 		{
-			ImSetParam(id, soundVol, volume & 0x7f);
+			// If the sound is waiting on a cue update, this volume replaces the cued volume so the call order is kept.
+			s32 index = sound_findCue(id);
+			if (index >= 0)
+			{
+				s_cueBatch.volumeOverride[index] = volume & 0x7f;
+			}
+			else
+			{
+				ImSetParam(id, soundVol, volume & 0x7f);
+			}
 		}
 	}
 
@@ -164,7 +222,15 @@ namespace TFE_DarkForces
 	{
 		if (id)
 		{
-			ImSetParam(id, soundPan, (pan + 64) & 0x7f);
+			s32 index = sound_findCue(id);
+			if (index >= 0)
+			{
+				s_cueBatch.panOverride[index] = (pan + 64) & 0x7f;
+			}
+			else
+			{
+				ImSetParam(id, soundPan, (pan + 64) & 0x7f);
+			}
 		}
 	}
 
@@ -220,11 +286,7 @@ namespace TFE_DarkForces
 	{
 		if (id)
 		{
-			s32 vol, pan;
-			GameSound* sound = getSoundPtr(id);
-			soundCalculateCue(sound, pos.x, pos.y, pos.z, &vol, &pan);
-			sound_setVolume(id, vol);
-			sound_setPan(id, pan);
+			sound_queueCue(id, getSoundPtr(id), pos);
 		}
 	}
 
@@ -238,16 +300,49 @@ namespace TFE_DarkForces
 
 	void sound_stopAll()
 	{
+		sound_clearCues();
 		ImStopAllSounds();
 	}
+
+	// The game sounds live in the game region, so the name map is rebuilt from the restored list.
+	// Playing sounds may use sound data that was not loaded yet at the time of the snapshot, so they are stopped,
+	// sound_maintain() restarts looping sounds.
+	void sound_restoreSnapshot()
+	{
+		sound_stopAll();
+
+		s_gameSoundMap.clear();
+		GameSound* sound = (GameSound*)allocator_getHead(s_gameSoundList);
+		while (sound)
+		{
+			s_gameSoundMap[soundKey(sound->name)] = sound;
+			sound = (GameSound*)allocator_getNext(s_gameSoundList);
+		}
+	}
+
+	void sound_registerSnapshot()
+	{
+		SNAPSHOT_GLOBAL(s_instance);
+		TFE_Memory::snapshot_registerRestoreCallback(sound_restoreSnapshot);
+	}
+
+	void sound_update()
+	{
+		s_cueUpdateCount = s_cueBatch.count;
+		if (!s_cueBatch.count) { return; }
+
+		sound_resolveCues(&s_cueBatch);
+		ImSetVolumePanBatch(s_cueBatch.id, s_cueBatch.volume, s_cueBatch.pan, s_cueBatch.count);
+		sound_clearCues();
+	}
 		
 	SoundEffectId sound_maintain(SoundEffectId idInstance, SoundSourceId idSound, vec3_fixed pos)
 	{
 		if (idSound)
 		{
-			s32 vol, pan;
 			GameSound* sound = getSoundPtr(idSound);
-			soundCalculateCue(sound, pos.x, pos.y, pos.z, &vol, &pan);
+			// The volume is needed right away to decide if the sound should play, the pan can wait for the batch.
+			s32 vol = soundCalculateVolume(sound, pos.x, pos.y, pos.z);
 			s_lastMaintainVolume = vol;
 
 			if (vol)
@@ -264,10 +359,17 @@ namespace TFE_DarkForces
 
 				if (!idInstance)
 				{
+					// New sounds are set up immediately so they never start at the wrong volume or pan.
+					s32 pan;
+					soundCalculateCue(sound, pos.x, pos.y, pos.z, &vol, &pan);
 					idInstance = sound_play(idSound);
+					sound_setVolume(idInstance, vol);
+					sound_setPan(idInstance, pan);
+				}
+				else
+				{
+					sound_queueCue(idInstance, sound, pos);
 				}
-				sound_setVolume(idInstance, vol);
-				sound_setPan(idInstance, pan);
 			}
 			else if (idInstance)
 			{
@@ -311,6 +413,138 @@ namespace TFE_DarkForces
 		angle = getAngleDifference(s_yaw, angle);
 		*pan = s_tPan[((angle + 8192) / 512) & 31];
 	}
+
+	// The same math as soundCalculateCue(), split up for the cue batch and based on the listener relative position.
+	inline fixed16_16 soundCueDistance(fixed16_16 dx, fixed16_16 dy, fixed16_16 dz)
+	{
+		return TFE_Jedi::abs(dy) + distApprox(dx, dz, 0, 0);
+	}
+
+	inline s32 soundCueVolume(fixed16_16 dist, s32 baseVolume)
+	{
+		s32 volume = 0;
+		if (dist < CUE_RING2)
+		{
+			if (dist < CUE_RING1)
+			{
+				volume = baseVolume;
+			}
+			else
+			{
+				fixed16_16 ratio = div16(CUE_RING2 - dist, CUE_RING2 - CUE_RING1);
+				assert(ratio >= 0 && ratio <= ONE_16);
+				volume = floor16(mul16(ratio, intToFixed16(baseVolume)));
+				volume = min(127, volume);
+			}
+		}
+		return volume;
+	}
+
+	inline s32 soundCuePan(fixed16_16 dx, fixed16_16 dz, angle14_32 yaw)
+	{
+		angle14_32 angle = vec2ToAngle(dx, dz);
+		angle = getAngleDifference(yaw, angle);
+		return s_tPan[((angle + 8192) / 512) & 31];
+	}
+
+	s32 soundCalculateVolume(GameSound* sound, fixed16_16 x, fixed16_16 y, fixed16_16 z)
+	{
+		return soundCueVolume(soundCueDistance(x - s_eyePos.x, y - s_eyePos.y, z - s_eyePos.z), sound->volume);
+	}
+
+	u32 soundCueHash(SoundEffectId id)
+	{
+		// Mix the instance bits (top) into the pointer offset bits (bottom).
+		const u64 key = u64(id) ^ (u64(id) >> 29);
+		return u32((key * 0x9E3779B97F4A7C15ull) >> 40) & (CUE_HASH_SIZE - 1);
+	}
+
+	s32 sound_findCue(SoundEffectId id)
+	{
+		if (!s_cueBatch.count) { return -1; }
+
+		u32 slot = soundCueHash(id);
+		while (s_cueBatch.hash[slot])
+		{
+			const s32 index = s_cueBatch.hash[slot] - 1;
+			if (s_cueBatch.id[index] == id) { return index; }
+			slot = (slot + 1) & (CUE_HASH_SIZE - 1);
+		}
+		return -1;
+	}
+
+	void sound_queueCue(SoundEffectId id, GameSound* sound, vec3_fixed pos)
+	{
+		s32 index = sound_findCue(id);
+		if (index < 0)
+		{
+			if (s_cueBatch.count >= MAX_CUED_SOUNDS)
+			{
+				// The batch is full, update this sound directly.
+				s32 vol, pan;
+				soundCalculateCue(sound, pos.x, pos.y, pos.z, &vol, &pan);
+				ImSetParam(id, soundVol, vol & 0x7f);
+				ImSetParam(id, soundPan, (pan + 64) & 0x7f);
+				return;
+			}
+
+			index = s_cueBatch.count++;
+			u32 slot = soundCueHash(id);
+			while (s_cueBatch.hash[slot])
+			{
+				slot = (slot + 1) & (CUE_HASH_SIZE - 1);
+			}
+			s_cueBatch.hash[slot] = s16(index + 1);
+			s_cueBatch.id[index] = id;
+		}
+
+		// A later cue replaces anything set earlier in the frame.
+		s_cueBatch.dx[index] = pos.x - s_eyePos.x;
+		s_cueBatch.dy[index] = pos.y - s_eyePos.y;
+		s_cueBatch.dz[index] = pos.z - s_eyePos.z;
+		s_cueBatch.yaw[index] = s_yaw;
+		s_cueBatch.baseVolume[index] = sound->volume;
+		s_cueBatch.volumeOverride[index] = CUE_UNCHANGED;
+		s_cueBatch.panOverride[index] = CUE_UNCHANGED;
+	}
+
+	// Compute the final iMuse volume and pan for every queued cue against the listener at the time of the cue.
+	void sound_resolveCues(SoundCueBatch* batch)
+	{
+		const s32 count = batch->count;
+		for (s32 i = 0; i < count; i++)
+		{
+			batch->volume[i] = soundCueVolume(soundCueDistance(batch->dx[i], batch->dy[i], batch->dz[i]), batch->baseVolume[i]);
+		}
+		for (s32 i = 0; i < count; i++)
+		{
+			if (batch->volumeOverride[i] != CUE_UNCHANGED) { batch->volume[i] = batch->volumeOverride[i]; }
+			else { batch->volume[i] &= 0x7f; }
+		}
+		// The pan is the expensive part, skip it for sounds that cannot be heard - it is recomputed with the next cue.
+		for (s32 i = 0; i < count; i++)
+		{
+			if (batch->panOverride[i] != CUE_UNCHANGED) { batch->pan[i] = batch->panOverride[i]; }
+			else if (batch->volume[i]) { batch->pan[i] = (soundCuePan(batch->dx[i], batch->dz[i], batch->yaw[i]) + 64) & 0x7f; }
+			else { batch->pan[i] = CUE_UNCHANGED; }
+		}
+	}
+
+	void sound_clearCues()
+	{
+		if (s_cueBatch.count)
+		{
+			memset(s_cueBatch.hash, 0, sizeof(s_cueBatch.hash));
+		}
+		s_cueBatch.count = 0;
+	}
+
+	std::string soundKey(const char* name)
+	{
+		std::string key = name;
+		for (size_t i = 0; i < key.length(); i++) { key[i] = tolower(key[i]); }
+		return key;
+	}
 		
 	SoundEffectId soundInstance(SoundSourceId soundId, s32 instance)
 	{
@@ -330,4 +564,83 @@ namespace TFE_DarkForces
 		GameSound* sound = getSoundPtr(id);
 		return sound ? sound->data : nullptr;
 	}
+
+	/////////////////////////////////////////////////////
+	// Benchmark
+	/////////////////////////////////////////////////////
+	static SoundCueBatch s_benchBatch;
+
+	void console_soundCueBenchmark(const ConsoleArgList& args)
+	{
+		const s32 iterations = args.size() >= 2 ? max(1, atoi(args[1].c_str())) : 1000;
+
+		// Scatter a full batch of sounds around the listener, some inside, some past the audible range.
+		GameSound sound = {};
+		SoundCueBatch* batch = &s_benchBatch;
+		batch->count = MAX_CUED_SOUNDS;
+		u32 seed = 0x1234567;
+		for (s32 i = 0; i < MAX_CUED_SOUNDS; i++)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			batch->dx[i] = FIXED(s32(seed >> 16) % 400 - 200) + s32(seed & 0xffff);
+			seed = seed * 1664525u + 1013904223u;
+			batch->dy[i] = FIXED(s32(seed >> 16) % 40 - 20) + s32(seed & 0xffff);
+			seed = seed * 1664525u + 1013904223u;
+			batch->dz[i] = FIXED(s32(seed >> 16) % 400 - 200) + s32(seed & 0xffff);
+			batch->yaw[i] = s_yaw;
+			batch->baseVolume[i] = 64 + (i & 63);
+			batch->volumeOverride[i] = CUE_UNCHANGED;
+			batch->panOverride[i] = CUE_UNCHANGED;
+		}
+
+		// Per sound, the way sound_adjustCued() used to work: soundCalculateCue() is the original math, which
+		// shares no code with the batch, so matching results show the batch is equivalent.
+		s32 volume[MAX_CUED_SOUNDS], pan[MAX_CUED_SOUNDS];
+		u64 start = TFE_System::getCurrentTimeInTicks();
+		for (s32 it = 0; it < iterations; it++)
+		{
+			for (s32 i = 0; i < MAX_CUED_SOUNDS; i++)
+			{
+				sound.volume = batch->baseVolume[i];
+				soundCalculateCue(&sound, s_eyePos.x + batch->dx[i], s_eyePos.y + batch->dy[i], s_eyePos.z + batch->dz[i], &volume[i], &pan[i]);
+			}
+		}
+		const f64 perSoundTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+
+		start = TFE_System::getCurrentTimeInTicks();
+		for (s32 it = 0; it < iterations; it++)
+		{
+			sound_resolveCues(batch);
+		}
+		const f64 batchTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+
+		s32 mismatches = 0, audible = 0;
+		for (s32 i = 0; i < MAX_CUED_SOUNDS; i++)
+		{
+			if (batch->volume[i] != (volume[i] & 0x7f)) { mismatches++; }
+			if (batch->volume[i])
+			{
+				audible++;
+				if (batch->pan[i] != ((pan[i] + 64) & 0x7f)) { mismatches++; }
+			}
+		}
+		batch->count = 0;
+
+		char res[256];
+		const f64 scale = 1000000.0 / f64(iterations);
+		sprintf(res, "Sound cue benchmark: %d sounds (%d audible), %d iterations.", MAX_CUED_SOUNDS, audible, iterations);
+		TFE_Console::addToHistory(res);
+		sprintf(res, "  Per sound: %0.2f us, batched: %0.2f us (%0.2fx).", perSoundTime * scale, batchTime * scale, batchTime > 0.0 ? perSoundTime / batchTime : 0.0);
+		TFE_Console::addToHistory(res);
+		if (mismatches)
+		{
+			sprintf(res, "  Results MISMATCH: %d values differ.", mismatches);
+			TFE_Console::addToHistory(res);
+			TFE_System::logWrite(LOG_ERROR, "Sound", "Cue benchmark: the batched cue results do not match the per sound results.");
+		}
+		else
+		{
+			TFE_Console::addToHistory("  Results match.");
+		}
+	}
 }  // TFE_DarkForces
\ No newline at end of file
@@ -48,6 +48,10 @@ namespace TFE_DarkForces
 
 	void sound_levelStart();
 	void sound_levelStop();
+	// Apply the cued volume and pan changes queued during the frame, called once the game tasks have run.
+	void sound_update();
+	// Stop playing sounds and rebuild the sound name map when a snapshot is restored.
+	void sound_registerSnapshot();
 
 	SoundEffectId sound_play(SoundSourceId sourceId);
 	SoundEffectId sound_playPriority(SoundSourceId id, s32 priority);
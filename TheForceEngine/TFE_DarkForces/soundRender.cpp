@@ -0,0 +1,347 @@
+#include <cstring>
+#include <cstdio>
+
+#include "soundRender.h"
+#include "sound.h"
+#include <TFE_Audio/midiPlayer.h>
+#include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/paths.h>
+#include <TFE_FrontEndUI/console.h>
+#include <TFE_Jedi/IMuse/imuse.h>
+#include <TFE_System/system.h>
+#include <TFE_System/parser.h>
+#include <algorithm>
+#include <vector>
+
+namespace TFE_DarkForces
+{
+	#define RENDER_SAMPLE_RATE 11025
+	#define RENDER_BLOCK_FRAMES 1024
+	#define RENDER_TAIL_SECONDS 5.0f
+	// Standard midi file timing: 960 ticks per quarter note at 120 bpm = 1920 ticks per second.
+	#define RENDER_MIDI_DIVISION 960
+	#define RENDER_MIDI_TICKS_PER_SECOND 1920
+
+	enum SoundCueType
+	{
+		CUE_MUSIC = 0,
+		CUE_SFX,
+		CUE_STOP,
+	};
+
+	struct SoundCue
+	{
+		f32 time;
+		SoundCueType type;
+		char name[32];
+		s32 volume;
+		s32 pan;
+
+		SoundSourceId sfx;
+		ImSoundId music;
+	};
+
+	static std::vector<SoundCue> s_cues;
+	static std::vector<u8> s_midiTrack;
+	static u64 s_midiLastTick;
+	static u32 s_midiEventCount;
+
+	void console_renderAudio(const ConsoleArgList& args);
+
+	void soundRender_init()
+	{
+		CCMD("renderAudio", console_renderAudio, 2, "renderAudio cueFile outFile [seconds] - render a sound cue list through iMuse to a WAV/raw PCM file (and a .mid file for music) faster than real time.");
+	}
+
+	bool soundRender_loadCues(const char* filename)
+	{
+		s_cues.clear();
+
+		FileStream file;
+		if (!file.open(filename, FileStream::MODE_READ))
+		{
+			char docPath[TFE_MAX_PATH];
+			TFE_Paths::appendPath(PATH_USER_DOCUMENTS, filename, docPath);
+			if (!file.open(docPath, FileStream::MODE_READ))
+			{
+				return false;
+			}
+		}
+		const size_t len = file.getSize();
+		std::vector<char> buffer(len + 1);
+		file.readBuffer(buffer.data(), (u32)len);
+		file.close();
+		buffer[len] = 0;
+
+		TFE_Parser parser;
+		parser.init(buffer.data(), len);
+		parser.addCommentString("#");
+
+		size_t bufferPos = 0;
+		while (bufferPos < len)
+		{
+			const char* line = parser.readLine(bufferPos, true);
+			if (!line) { break; }
+
+			SoundCue cue = {};
+			char type[32];
+			cue.volume = -1;
+			cue.pan = 0;
+			const s32 count = sscanf(line, "%f %31s %31s %d %d", &cue.time, type, cue.name, &cue.volume, &cue.pan);
+			if (count < 2) { continue; }
+
+			if (strcasecmp(type, "music") == 0 && count >= 3)
+			{
+				cue.type = CUE_MUSIC;
+			}
+			else if (strcasecmp(type, "sfx") == 0 && count >= 3)
+			{
+				cue.type = CUE_SFX;
+			}
+			else if (strcasecmp(type, "stop") == 0)
+			{
+				cue.type = CUE_STOP;
+			}
+			else
+			{
+				TFE_System::logWrite(LOG_WARNING, "Sound Render", "Unknown cue '%s'.", line);
+				continue;
+			}
+			cue.time = std::max(cue.time, 0.0f);
+			s_cues.push_back(cue);
+		}
+		std::stable_sort(s_cues.begin(), s_cues.end(), [](const SoundCue& a, const SoundCue& b) { return a.time < b.time; });
+		return !s_cues.empty();
+	}
+
+	// Load everything up front so only iMuse work is timed.
+	void soundRender_loadAssets()
+	{
+		const size_t count = s_cues.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			SoundCue* cue = &s_cues[i];
+			if (cue->type == CUE_SFX)
+			{
+				cue->sfx = sound_load(cue->name, SOUND_PRIORITY_HIGH5);
+				if (!cue->sfx) { TFE_System::logWrite(LOG_WARNING, "Sound Render", "Cannot load sound '%s'.", cue->name); }
+			}
+			else if (cue->type == CUE_MUSIC)
+			{
+				cue->music = ImLoadMidi(cue->name);
+				if (cue->music == IM_NULL_SOUNDID || cue->music == ImSoundId(imFail))
+				{
+					TFE_System::logWrite(LOG_WARNING, "Sound Render", "Cannot load music '%s'.", cue->name);
+					cue->music = IM_NULL_SOUNDID;
+				}
+			}
+		}
+	}
+
+	void soundRender_freeAssets()
+	{
+		const size_t count = s_cues.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			if (s_cues[i].sfx) { sound_free(s_cues[i].sfx); }
+		}
+		s_cues.clear();
+	}
+
+	void soundRender_startCue(const SoundCue* cue)
+	{
+		switch (cue->type)
+		{
+			case CUE_MUSIC:
+			{
+				if (cue->music) { ImStartSound(cue->music, 64); }
+			} break;
+			case CUE_SFX:
+			{
+				if (!cue->sfx) { break; }
+				SoundEffectId id = sound_play(cue->sfx);
+				if (cue->volume >= 0) { sound_setVolume(id, cue->volume); }
+				sound_setPan(id, cue->pan);
+			} break;
+			case CUE_STOP:
+			{
+				ImStopAllSounds();
+			} break;
+		}
+	}
+
+	/////////////////////////////////////////////
+	// Output
+	/////////////////////////////////////////////
+	void writeVarLen(std::vector<u8>& out, u32 value)
+	{
+		u8 bytes[5];
+		s32 count = 0;
+		do
+		{
+			bytes[count++] = value & 0x7f;
+			value >>= 7;
+		} while (value);
+
+		for (s32 i = count - 1; i >= 0; i--)
+		{
+			out.push_back(bytes[i] | (i ? 0x80 : 0x00));
+		}
+	}
+
+	void putU16BE(std::vector<u8>& out, u32 value) { out.push_back(u8(value >> 8)); out.push_back(u8(value)); }
+	void putU32BE(std::vector<u8>& out, u32 value) { putU16BE(out, value >> 16); putU16BE(out, value & 0xffff); }
+	void putU16LE(std::vector<u8>& out, u32 value) { out.push_back(u8(value)); out.push_back(u8(value >> 8)); }
+	void putU32LE(std::vector<u8>& out, u32 value) { putU16LE(out, value & 0xffff); putU16LE(out, value >> 16); }
+
+	void soundRender_captureMidi(const u8* msg, u32 size)
+	{
+		const u64 tick = ImGetOfflineRenderFrame() * RENDER_MIDI_TICKS_PER_SECOND / RENDER_SAMPLE_RATE;
+		writeVarLen(s_midiTrack, u32(tick - s_midiLastTick));
+		s_midiTrack.insert(s_midiTrack.end(), msg, msg + size);
+		s_midiLastTick = tick;
+		s_midiEventCount++;
+	}
+
+	bool writeFile(const char* path, const std::vector<u8>& data)
+	{
+		FileStream file;
+		if (!file.open(path, FileStream::MODE_WRITE))
+		{
+			return false;
+		}
+		file.writeBuffer(data.data(), (u32)data.size());
+		file.close();
+		return true;
+	}
+
+	bool soundRender_writeMidi(const char* path)
+	{
+		std::vector<u8> out;
+		out.insert(out.end(), { 'M', 'T', 'h', 'd' });
+		putU32BE(out, 6);
+		putU16BE(out, 0);	// format 0
+		putU16BE(out, 1);	// one track
+		putU16BE(out, RENDER_MIDI_DIVISION);
+
+		// Tempo: 500000 microseconds per quarter note.
+		std::vector<u8> track = { 0x00, 0xff, 0x51, 0x03, 0x07, 0xa1, 0x20 };
+		track.insert(track.end(), s_midiTrack.begin(), s_midiTrack.end());
+		track.insert(track.end(), { 0x00, 0xff, 0x2f, 0x00 });
+
+		out.insert(out.end(), { 'M', 'T', 'r', 'k' });
+		putU32BE(out, (u32)track.size());
+		out.insert(out.end(), track.begin(), track.end());
+		return writeFile(path, out);
+	}
+
+	bool soundRender_writePcm(const char* path, const std::vector<s16>& samples)
+	{
+		const u32 dataSize = u32(samples.size() * sizeof(s16));
+		std::vector<u8> out;
+		const size_t pathLen = strlen(path);
+		if (pathLen > 4 && strcasecmp(path + pathLen - 4, ".wav") == 0)
+		{
+			out.insert(out.end(), { 'R', 'I', 'F', 'F' });
+			putU32LE(out, 36 + dataSize);
+			out.insert(out.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+			putU32LE(out, 16);
+			putU16LE(out, 1);	// PCM
+			putU16LE(out, 2);	// stereo
+			putU32LE(out, RENDER_SAMPLE_RATE);
+			putU32LE(out, RENDER_SAMPLE_RATE * 4);
+			putU16LE(out, 4);
+			putU16LE(out, 16);
+			out.insert(out.end(), { 'd', 'a', 't', 'a' });
+			putU32LE(out, dataSize);
+		}
+		const size_t headerSize = out.size();
+		out.resize(headerSize + dataSize);
+		memcpy(out.data() + headerSize, samples.data(), dataSize);
+		return writeFile(path, out);
+	}
+
+	/////////////////////////////////////////////
+	// Console
+	/////////////////////////////////////////////
+	void console_renderAudio(const ConsoleArgList& args)
+	{
+		if (args.size() < 3) { return; }
+
+		char res[TFE_MAX_PATH + 256];
+		if (!soundRender_loadCues(args[1].c_str()))
+		{
+			sprintf(res, "Cannot load cue file '%s'.", args[1].c_str());
+			TFE_Console::addToHistory(res);
+			return;
+		}
+		f32 seconds = s_cues.back().time + RENDER_TAIL_SECONDS;
+		if (args.size() >= 4)
+		{
+			seconds = std::max(TFE_Console::getFloatArg(args[3]), 0.1f);
+		}
+
+		char outPath[TFE_MAX_PATH];
+		char midiPath[TFE_MAX_PATH + 4];
+		TFE_Paths::appendPath(PATH_USER_DOCUMENTS, args[2].c_str(), outPath);
+		sprintf(midiPath, "%s.mid", outPath);
+
+		// Silence the live devices, then take over the iMuse clock.
+		ImStopAllSounds();
+		TFE_MidiPlayer::stopMidiSound();
+		soundRender_loadAssets();
+		s_midiTrack.clear();
+		s_midiLastTick = 0;
+		s_midiEventCount = 0;
+		ImBeginOfflineRender();
+		TFE_MidiPlayer::setMessageCapture(soundRender_captureMidi);
+
+		const u32 totalFrames = u32(seconds * RENDER_SAMPLE_RATE);
+		std::vector<s16> samples;
+		samples.reserve(totalFrames * 2);
+		f32 block[RENDER_BLOCK_FRAMES * 2];
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		const size_t cueCount = s_cues.size();
+		size_t cue = 0;
+		u32 frame = 0;
+		while (frame < totalFrames)
+		{
+			for (; cue < cueCount && u32(s_cues[cue].time * RENDER_SAMPLE_RATE) <= frame; cue++)
+			{
+				soundRender_startCue(&s_cues[cue]);
+			}
+			const u32 end = (cue < cueCount) ? std::min(totalFrames, u32(s_cues[cue].time * RENDER_SAMPLE_RATE)) : totalFrames;
+			const u32 count = std::min(end - frame, (u32)RENDER_BLOCK_FRAMES);
+
+			ImRenderOffline(block, count, 1.0f);
+			for (u32 i = 0; i < count * 2; i++)
+			{
+				samples.push_back(s16(std::max(-1.0f, std::min(block[i], 1.0f)) * 32767.0f));
+			}
+			frame += count;
+		}
+		ImStopAllSounds();
+		const f64 renderTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+
+		TFE_MidiPlayer::setMessageCapture();
+		ImEndOfflineRender();
+		soundRender_freeAssets();
+
+		bool written = soundRender_writePcm(outPath, samples);
+		if (written && s_midiEventCount)
+		{
+			written = soundRender_writeMidi(midiPath);
+		}
+
+		const f64 framesPerSecond = renderTime > 0.0 ? f64(totalFrames) / renderTime : 0.0;
+		sprintf(res, "Rendered %0.2f seconds (%u frames, %u midi events) in %0.2f ms: %0.0f frames/sec, %0.1fx real time.",
+			seconds, totalFrames, s_midiEventCount, renderTime * 1000.0, framesPerSecond, framesPerSecond / f64(RENDER_SAMPLE_RATE));
+		TFE_Console::addToHistory(res);
+		TFE_System::logWrite(LOG_MSG, "Sound Render", "%s", res);
+
+		sprintf(res, written ? "Wrote '%s'%s." : "Cannot write '%s'%s.", outPath, s_midiEventCount ? " and its .mid file" : "");
+		TFE_Console::addToHistory(res);
+		s_midiTrack.clear();
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Offline sound rendering
+// Renders a cue list through iMuse faster than real time, without
+// using the audio or midi devices:
+//   renderAudio cueFile outFile [seconds]
+//
+// Cue file lines (times in seconds, '#' starts a comment):
+//   time music NAME                      - load and start a GMID song.
+//   time sfx FILE.VOC [volume] [pan]     - volume 0-127, pan -64 to 63.
+//   time stop                            - stop all sounds.
+//
+// Digital audio is written as 16-bit stereo 11025 Hz PCM, as a WAV
+// file if outFile ends in ".wav" and raw PCM otherwise. Midi output
+// is written next to it as a standard midi file (outFile + ".mid").
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+
+namespace TFE_DarkForces
+{
+	void soundRender_init();
+}
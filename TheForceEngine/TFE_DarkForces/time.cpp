@@ -1,5 +1,6 @@
 #include "time.h"
 #include <TFE_System/system.h>
+#include <TFE_Memory/snapshot.h>
 
 namespace TFE_DarkForces
 {
@@ -10,6 +11,13 @@ namespace TFE_DarkForces
 	fixed16_16 s_frameTicks[13] = { 0 };
 
 	JBool s_pauseTimeUpdate = JFALSE;
+	static s32 s_fixedStep = 0;
+
+	enum
+	{
+		// With a fixed timestep, the simulation never falls further behind than this - time is dropped instead.
+		FIXED_STEP_MAX_LAG = TICKS_PER_SECOND / 4,
+	};
 
 	Tick time_frameRateToDelay(u32 frameRate)
 	{
@@ -26,11 +34,32 @@ namespace TFE_DarkForces
 		return Tick(SECONDS_TO_TICKS_ROUNDED / frameRate);
 	}
 
+	void time_registerSnapshot()
+	{
+		SNAPSHOT_GLOBAL(s_curTick);
+		SNAPSHOT_GLOBAL(s_prevTick);
+		SNAPSHOT_GLOBAL(s_timeAccum);
+		SNAPSHOT_GLOBAL(s_deltaTime);
+		SNAPSHOT_GLOBAL(s_frameTicks);
+	}
+
 	void time_pause(JBool pause)
 	{
 		s_pauseTimeUpdate = pause;
 	}
 
+	void time_setTick(Tick tick)
+	{
+		Tick prevTick = s_curTick;
+		s_curTick = tick;
+
+		fixed16_16 dt = div16(intToFixed16(s_curTick - prevTick), FIXED(TICKS_PER_SECOND));
+		for (s32 i = 0; i < 13; i++)
+		{
+			s_frameTicks[i] += mul16(dt, intToFixed16(i));
+		}
+	}
+
 	void updateTime()
 	{
 		if (!s_pauseTimeUpdate)
@@ -38,13 +67,40 @@ namespace TFE_DarkForces
 			s_timeAccum += TFE_System::getDeltaTime() * TIMER_FREQ;
 		}
 
-		Tick prevTick = s_curTick;
-		s_curTick = Tick(s_timeAccum);
+		if (s_fixedStep)
+		{
+			// The ticks are advanced by time_stepFixed(), one step per task update.
+			const f64 maxAccum = f64(s_curTick) + f64(max(s32(FIXED_STEP_MAX_LAG), 2 * s_fixedStep));
+			if (s_timeAccum > maxAccum) { s_timeAccum = maxAccum; }
+			return;
+		}
+		time_setTick(Tick(s_timeAccum));
+	}
 
-		fixed16_16 dt = div16(intToFixed16(s_curTick - prevTick), FIXED(TICKS_PER_SECOND));
-		for (s32 i = 0; i < 13; i++)
+	void time_setFixedStep(s32 ticks)
+	{
+		s_fixedStep = max(0, ticks);
+	}
+
+	s32 time_getFixedStep()
+	{
+		return s_fixedStep;
+	}
+
+	JBool time_stepFixed()
+	{
+		if (!s_fixedStep || s_timeAccum < f64(s_curTick + s_fixedStep))
 		{
-			s_frameTicks[i] += mul16(dt, intToFixed16(i));
+			return JFALSE;
 		}
+		time_setTick(s_curTick + s_fixedStep);
+		return JTRUE;
+	}
+
+	f32 time_getStepFraction(Tick tick)
+	{
+		if (!s_fixedStep) { return 1.0f; }
+		const f64 fraction = (s_timeAccum - f64(tick)) / f64(s_fixedStep);
+		return f32(fraction < 0.0 ? 0.0 : (fraction > 1.0 ? 1.0 : fraction));
 	}
 }  // TFE_DarkForces
\ No newline at end of file
@@ -52,4 +52,16 @@ namespace TFE_DarkForces
 	Tick time_frameRateToDelay(f32 frameRate);
 	void updateTime();
 	void time_pause(JBool pause);
+
+	// TFE: Fixed timestep.
+	// When the step is non-zero, updateTime() only accumulates time and the simulation advances by exactly
+	// 'ticks' at a time through time_stepFixed(), so the game behaves the same at any frame rate.
+	void time_setFixedStep(s32 ticks);
+	s32  time_getFixedStep();
+	// Advance s_curTick by one fixed step if enough time has accumulated, returns JFALSE otherwise.
+	JBool time_stepFixed();
+	// How far the game time is past the given tick, in fixed steps, used to interpolate rendering between steps.
+	f32 time_getStepFraction(Tick tick);
+	// Add the game time to the state captured by snapshots.
+	void time_registerSnapshot();
 }  // namespace TFE_DarkForces
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <TFE_Jedi/Renderer/RClassic_Fixed/rlightingFixed.h>
 #include <TFE_Jedi/Renderer/virtualFramebuffer.h>
 #include <TFE_Jedi/Renderer/screenDraw.h>
+#include <TFE_Memory/snapshot.h>
 
 namespace TFE_DarkForces
 {
@@ -119,6 +120,34 @@ namespace TFE_DarkForces
 		s_playerWeaponTask = nullptr;
 	}
 
+	// TFE: the weapon state that changes during play, for snapshots.
+	void weapon_registerSnapshot()
+	{
+		SNAPSHOT_GLOBAL(s_switchWeapons);
+		SNAPSHOT_GLOBAL(s_queWeaponSwitch);
+		SNAPSHOT_GLOBAL(s_playerWeaponList);
+		SNAPSHOT_GLOBAL(s_weaponDelayPrimary);
+		SNAPSHOT_GLOBAL(s_weaponDelaySeconary);
+		SNAPSHOT_GLOBAL(s_canFirePrimPtr);
+		SNAPSHOT_GLOBAL(s_canFireSecPtr);
+		SNAPSHOT_GLOBAL(s_weaponAnimState);
+		SNAPSHOT_GLOBAL(s_prevWeapon);
+		SNAPSHOT_GLOBAL(s_curWeapon);
+		SNAPSHOT_GLOBAL(s_nextWeapon);
+		SNAPSHOT_GLOBAL(s_lastWeapon);
+		SNAPSHOT_GLOBAL(s_weaponAutoMount2);
+		SNAPSHOT_GLOBAL(s_secondaryFire);
+		SNAPSHOT_GLOBAL(s_weaponOffAnim);
+		SNAPSHOT_GLOBAL(s_isShooting);
+		SNAPSHOT_GLOBAL(s_canFireWeaponSec);
+		SNAPSHOT_GLOBAL(s_canFireWeaponPrim);
+		SNAPSHOT_GLOBAL(s_fireFrame);
+		SNAPSHOT_GLOBAL(s_repeaterFireSndID);
+		SNAPSHOT_GLOBAL(s_curPlayerWeapon);
+		SNAPSHOT_GLOBAL(s_playerWeaponTask);
+		weaponFire_registerSnapshot();
+	}
+
 	void weapon_startup()
 	{
 		// TODO: Move this into data instead of hard coding it like vanilla Dark Forces.
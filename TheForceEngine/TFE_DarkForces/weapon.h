@@ -96,6 +96,7 @@ namespace TFE_DarkForces
 
 	// Added for TFE.
 	s32 weapon_getTextures(TextureData** textures);
+	void weapon_registerSnapshot();
 
 	extern PlayerWeapon* s_curPlayerWeapon;
 	extern SoundSourceId s_superchargeCountdownSound;
@@ -7,6 +7,7 @@
 #include "hitEffect.h"
 #include <TFE_Jedi/Collision/collision.h>
 #include <TFE_Jedi/Renderer/jediRenderer.h>
+#include <TFE_Memory/snapshot.h>
 
 namespace TFE_DarkForces
 {
@@ -132,6 +133,36 @@ namespace TFE_DarkForces
 	};
 	static JBool s_fusionCycleForward = JTRUE;
 
+	void weaponFire_registerSnapshot()
+	{
+		SNAPSHOT_GLOBAL(s_punchSwingSndId);
+		SNAPSHOT_GLOBAL(s_pistolSndId);
+		SNAPSHOT_GLOBAL(s_rifleSndId);
+		SNAPSHOT_GLOBAL(s_mortarFireSndID);
+		SNAPSHOT_GLOBAL(s_mortarFireSndID2);
+		SNAPSHOT_GLOBAL(s_outOfAmmoSndId);
+		SNAPSHOT_GLOBAL(s_mortarOutofAmmoSndId);
+		SNAPSHOT_GLOBAL(s_repeaterFireSndID1);
+		SNAPSHOT_GLOBAL(s_repeaterOutOfAmmoSndId);
+		SNAPSHOT_GLOBAL(s_fusionFireSndID);
+		SNAPSHOT_GLOBAL(s_fusionOutOfAmmoSndID);
+		SNAPSHOT_GLOBAL(s_mineSndId);
+		SNAPSHOT_GLOBAL(s_concussionFireSndID);
+		SNAPSHOT_GLOBAL(s_concussionFireSndID1);
+		SNAPSHOT_GLOBAL(s_concussionOutOfAmmoSndID);
+		SNAPSHOT_GLOBAL(s_cannonOutOfAmmoSndID);
+		SNAPSHOT_GLOBAL(s_cannonFireSndID);
+		SNAPSHOT_GLOBAL(s_cannonFireSndID1);
+		SNAPSHOT_GLOBAL(s_autoAimDirX);
+		SNAPSHOT_GLOBAL(s_autoAimDirZ);
+		SNAPSHOT_GLOBAL(s_wpnPitchSin);
+		SNAPSHOT_GLOBAL(s_wpnPitchCos);
+		SNAPSHOT_GLOBAL(s_weaponFirePitch);
+		SNAPSHOT_GLOBAL(s_weaponFireYaw);
+		SNAPSHOT_GLOBAL(s_fusionCylinder);
+		SNAPSHOT_GLOBAL(s_fusionCycleForward);
+	}
+
 	extern void weapon_handleState(MessageType msg);
 	extern void weapon_handleState2(MessageType msg);
 	extern void weapon_handleOffAnimation(MessageType msg);
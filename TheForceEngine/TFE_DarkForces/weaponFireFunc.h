@@ -20,4 +20,6 @@ namespace TFE_DarkForces
 	void weaponFire_mine(MessageType msg);
 	void weaponFire_concussion(MessageType msg);
 	void weaponFire_cannon(MessageType msg);
+	// TFE
+	void weaponFire_registerSnapshot();
 }  // namespace TFE_DarkForces
\ No newline at end of file
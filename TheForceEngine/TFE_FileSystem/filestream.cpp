@@ -1,5 +1,6 @@
 #pragma once
 #include "filestream.h"
+#include "paths.h"
 #include <TFE_Archive/archive.h>
 #include <assert.h>
 #include <stdio.h>
@@ -34,6 +35,10 @@ bool FileStream::open(const char* filename, FileMode mode)
 	const char* modeStrings[] = { "rb", "wb", "rb+" };
 	m_file = fopen(filename, modeStrings[mode]);
 	m_mode = mode;
+	if (m_file && mode == MODE_WRITE)
+	{
+		TFE_Paths::onFileWritten();
+	}
 
 	return m_file != nullptr;
 }
@@ -0,0 +1,101 @@
+#include "memoryMappedFile.h"
+
+#ifdef _WIN32
+	#include <Windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+MemoryMappedFile::MemoryMappedFile() : m_data(nullptr), m_size(0)
+{
+#ifdef _WIN32
+	m_fileHandle = INVALID_HANDLE_VALUE;
+	m_mapHandle = nullptr;
+#endif
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	close();
+}
+
+bool MemoryMappedFile::open(const char* filename)
+{
+	close();
+
+#ifdef _WIN32
+	m_fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_fileHandle == INVALID_HANDLE_VALUE) { return false; }
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(m_fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+
+	m_mapHandle = CreateFileMappingA(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_mapHandle)
+	{
+		close();
+		return false;
+	}
+
+	m_data = (const u8*)MapViewOfFile(m_mapHandle, FILE_MAP_READ, 0, 0, 0);
+	if (!m_data)
+	{
+		close();
+		return false;
+	}
+	m_size = size_t(fileSize.QuadPart);
+#else
+	const int fd = ::open(filename, O_RDONLY);
+	if (fd < 0) { return false; }
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	// The mapping keeps its own reference to the file.
+	void* data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) { return false; }
+
+	m_data = (const u8*)data;
+	m_size = size_t(st.st_size);
+#endif
+	return true;
+}
+
+void MemoryMappedFile::close()
+{
+#ifdef _WIN32
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapHandle)
+	{
+		CloseHandle(m_mapHandle);
+		m_mapHandle = nullptr;
+	}
+	if (m_fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_fileHandle);
+		m_fileHandle = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (m_data)
+	{
+		munmap((void*)m_data, m_size);
+	}
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Read-only memory mapped file.
+// The whole file is mapped when opened and stays mapped until closed,
+// so the data can be read in place without copying.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+
+class MemoryMappedFile
+{
+public:
+	MemoryMappedFile();
+	~MemoryMappedFile();
+
+	bool open(const char* filename);
+	void close();
+
+	bool isOpen() const { return m_data != nullptr; }
+	const u8* data() const { return m_data; }
+	size_t size() const { return m_size; }
+
+private:
+	const u8* m_data;
+	size_t m_size;
+#ifdef _WIN32
+	void* m_fileHandle;
+	void* m_mapHandle;
+#endif
+};
@@ -3,8 +3,11 @@
 #include "fileutil.h"
 #include "filestream.h"
 #include <TFE_System/system.h>
+#include <TFE_System/profiler.h>
 #include <TFE_Archive/archive.h>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN 1
@@ -27,11 +30,33 @@ namespace TFE_Paths
 		std::string realPath;
 	};
 
+	// The winning source for a file name, see getFilePath().
+	struct FileIndexEntry
+	{
+		Archive* archive;		// archive or nullptr if the file is on disk.
+		u32 index;				// file index into the archive.
+		std::string path;		// path on disk.
+		s32 searchPath;			// search path the file was found in, or -1.
+	};
+	typedef std::unordered_map<std::string, FileIndexEntry> FileIndex;
+	typedef std::unordered_set<std::string> FileNameSet;
+
 	static std::string s_paths[PATH_COUNT];
 	static std::vector<Archive*> s_localArchives;
 	static std::vector<std::string> s_searchPaths;
 	static std::vector<FileMapping> s_fileMappings;
 
+	// Lower case file name -> source, rebuilt when the mappings or search paths change.
+	// Archives are added and removed incrementally since they are pushed and popped often.
+	static FileIndex s_fileIndex;
+	// Lower case names that were not found, cleared with the index and whenever files are written.
+	static FileNameSet s_missingFiles;
+	static bool s_fileIndexDirty = true;
+	static s32 s_pathLookupCount = 0;
+	static s32 s_pathIndexBuildCount = 0;
+
+	bool getFilePath_Linear(const char* fileName, FilePath* outPath);
+
 	void setPath(TFE_PathType pathType, const char* path)
 	{
 		s_paths[pathType] = path;
@@ -162,6 +187,7 @@ namespace TFE_Paths
 			}
 
 			s_searchPaths.push_back(fullPath);
+			invalidateFileIndex();
 		}
 	}
 
@@ -181,6 +207,7 @@ namespace TFE_Paths
 			}
 
 			s_searchPaths.insert(s_searchPaths.begin(), fullPath);
+			invalidateFileIndex();
 		}
 	}
 
@@ -188,6 +215,7 @@ namespace TFE_Paths
 	{
 		s_searchPaths.clear();
 		s_fileMappings.clear();
+		invalidateFileIndex();
 	}
 
 	void clearLocalArchives()
@@ -199,6 +227,7 @@ namespace TFE_Paths
 			Archive::freeArchive(archive[i]);
 		}
 		s_localArchives.clear();
+		invalidateFileIndex();
 	}
 
 	// Add a single file that can be referenced by 'fileName' even though the real name may be different.
@@ -214,6 +243,7 @@ namespace TFE_Paths
 
 		FileMapping mapping = { fileNameLC, filePathFixed };
 		s_fileMappings.push_back(mapping);
+		invalidateFileIndex();
 	}
 
 	void addLocalSearchPath(const char* localSearchPath)
@@ -243,17 +273,242 @@ namespace TFE_Paths
 		addSearchPath(fullPath);
 	}
 
+	void invalidateFileIndex()
+	{
+		s_fileIndexDirty = true;
+		s_fileIndex.clear();
+		s_missingFiles.clear();
+	}
+
+	void onFileWritten()
+	{
+		s_missingFiles.clear();
+	}
+
+	bool fileIndexHasArchive(const Archive* archive)
+	{
+		const size_t count = s_localArchives.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			if (s_localArchives[i] == archive) { return true; }
+		}
+		return false;
+	}
+
+	void onArchiveChanged(const Archive* archive)
+	{
+		if (!s_fileIndexDirty && fileIndexHasArchive(archive))
+		{
+			invalidateFileIndex();
+		}
+	}
+
+	void lowerCaseName(const char* name, std::string& nameLC)
+	{
+		nameLC = name;
+		const size_t len = nameLC.length();
+		for (size_t i = 0; i < len; i++)
+		{
+			nameLC[i] = tolower(nameLC[i]);
+		}
+	}
+
+	// Add the files in an archive that are not already provided by a higher priority source.
+	void fileIndex_addArchive(Archive* archive)
+	{
+		std::string nameLC;
+		const u32 count = archive->getFileCount();
+		for (u32 i = 0; i < count; i++)
+		{
+			const char* name = archive->getFileName(i);
+			if (!name) { continue; }
+
+			lowerCaseName(name, nameLC);
+			if (s_fileIndex.find(nameLC) == s_fileIndex.end())
+			{
+				FileIndexEntry entry = { archive, i, std::string(), -1 };
+				s_fileIndex[nameLC] = entry;
+			}
+		}
+	}
+
+	// Remove the files provided by the lowest priority archive, nothing can be shadowed by it.
+	void fileIndex_removeArchive(Archive* archive)
+	{
+		std::string nameLC;
+		const u32 count = archive->getFileCount();
+		for (u32 i = 0; i < count; i++)
+		{
+			const char* name = archive->getFileName(i);
+			if (!name) { continue; }
+
+			lowerCaseName(name, nameLC);
+			FileIndex::iterator iEntry = s_fileIndex.find(nameLC);
+			if (iEntry != s_fileIndex.end() && iEntry->second.archive == archive)
+			{
+				s_fileIndex.erase(iEntry);
+			}
+		}
+	}
+
+	// Rebuild the index using the same priority as getFilePath_Linear(): mappings, search paths and then archives.
+	void fileIndex_build()
+	{
+		TFE_ZONE("Path Index Build");
+		if (!s_pathIndexBuildCount)
+		{
+			TFE_COUNTER(s_pathLookupCount, "Path Lookups");
+			TFE_COUNTER(s_pathIndexBuildCount, "Path Index Builds");
+		}
+		s_pathIndexBuildCount++;
+
+		s_fileIndex.clear();
+		s_missingFiles.clear();
+		std::string nameLC;
+
+		const size_t mappingCount = s_fileMappings.size();
+		for (size_t i = 0; i < mappingCount; i++)
+		{
+			const FileMapping* mapping = &s_fileMappings[i];
+			if (s_fileIndex.find(mapping->fileName) == s_fileIndex.end())
+			{
+				FileIndexEntry entry = { nullptr, INVALID_FILE, mapping->realPath, -1 };
+				s_fileIndex[mapping->fileName] = entry;
+			}
+		}
+
+		const size_t pathCount = s_searchPaths.size();
+		for (size_t i = 0; i < pathCount; i++)
+		{
+			const std::string& localPath = s_searchPaths[i];
+			FileList fileList;
+			FileUtil::readDirectory(localPath.c_str(), "*", fileList);
+
+			const size_t fileCount = fileList.size();
+			for (size_t f = 0; f < fileCount; f++)
+			{
+				lowerCaseName(fileList[f].c_str(), nameLC);
+				if (s_fileIndex.find(nameLC) != s_fileIndex.end()) { continue; }
+
+				const std::string fullName = localPath + fileList[f];
+				if (FileUtil::directoryExits(fullName.c_str())) { continue; }
+
+				FileIndexEntry entry = { nullptr, INVALID_FILE, fullName, s32(i) };
+				s_fileIndex[nameLC] = entry;
+			}
+		}
+
+		const size_t archiveCount = s_localArchives.size();
+		for (size_t i = 0; i < archiveCount; i++)
+		{
+			fileIndex_addArchive(s_localArchives[i]);
+		}
+		s_fileIndexDirty = false;
+	}
+
 	void addLocalArchive(Archive* archive)
 	{
 		s_localArchives.push_back(archive);
+		if (!s_fileIndexDirty)
+		{
+			fileIndex_addArchive(archive);
+			s_missingFiles.clear();
+		}
 	}
 
 	void removeLastArchive()
 	{
+		Archive* archive = s_localArchives.back();
 		s_localArchives.pop_back();
+		if (s_fileIndexDirty) { return; }
+
+		// If the same archive is still in the list, its files belong to the earlier entry.
+		if (fileIndexHasArchive(archive))
+		{
+			invalidateFileIndex();
+		}
+		else
+		{
+			fileIndex_removeArchive(archive);
+		}
 	}
 
 	bool getFilePath(const char* fileName, FilePath* outPath)
+	{
+		s_pathLookupCount++;
+
+		// Names with directories are resolved relative to each search path, so use the full search.
+		if (strchr(fileName, '/') || strchr(fileName, '\\'))
+		{
+			return getFilePath_Linear(fileName, outPath);
+		}
+		if (s_fileIndexDirty)
+		{
+			fileIndex_build();
+		}
+
+		outPath->archive = nullptr;
+		outPath->index = INVALID_FILE;
+		outPath->path[0] = 0;
+
+		std::string nameLC;
+		lowerCaseName(fileName, nameLC);
+		FileIndex::const_iterator iEntry = s_fileIndex.find(nameLC);
+		if (iEntry == s_fileIndex.end())
+		{
+			if (s_missingFiles.find(nameLC) != s_missingFiles.end())
+			{
+				return false;
+			}
+			// Files created on disk after the index was built (saves, screenshots, mods) are not in it yet.
+			// The full search uses the same priority, so a file it finds can be added to the index.
+			if (!getFilePath_Linear(fileName, outPath))
+			{
+				s_missingFiles.insert(nameLC);
+				return false;
+			}
+			FileIndexEntry entry = { outPath->archive, outPath->index, outPath->archive ? std::string() : std::string(outPath->path), -1 };
+			if (!outPath->archive)
+			{
+				// Remember which search path the file came from so the lookup below can check it.
+				const size_t pathCount = s_searchPaths.size();
+				for (size_t i = 0; i < pathCount && entry.searchPath < 0; i++)
+				{
+					if (entry.path == s_searchPaths[i] + fileName) { entry.searchPath = s32(i); }
+				}
+			}
+			s_fileIndex[nameLC] = entry;
+			return true;
+		}
+
+		const FileIndexEntry& entry = iEntry->second;
+		if (entry.searchPath >= 0)
+		{
+			// Loose files must match the case exactly on case sensitive file systems and may have been deleted,
+			// so check the file as the full search would and fall back to it if the file is not there.
+			char fullName[TFE_MAX_PATH];
+			sprintf(fullName, "%s%s", s_searchPaths[entry.searchPath].c_str(), fileName);
+			FileStream file;
+			if (file.exists(fullName))
+			{
+				strncpy(outPath->path, fullName, TFE_MAX_PATH);
+				return true;
+			}
+			return getFilePath_Linear(fileName, outPath);
+		}
+		else if (entry.archive)
+		{
+			outPath->archive = entry.archive;
+			outPath->index = entry.index;
+		}
+		else
+		{
+			strncpy(outPath->path, entry.path.c_str(), TFE_MAX_PATH);
+		}
+		return true;
+	}
+
+	bool getFilePath_Linear(const char* fileName, FilePath* outPath)
 	{
 		outPath->archive = nullptr;
 		outPath->index = INVALID_FILE;
@@ -49,6 +49,12 @@ namespace TFE_Paths
 	void addLocalArchive(Archive* archive);
 	void removeLastArchive();
 	bool getFilePath(const char* fileName, FilePath* path);
+	// File names are resolved through an index, names that are not in the index fall back to a full search.
+	void invalidateFileIndex();
+	// Called when files are added to an archive, so the index picks them up.
+	void onArchiveChanged(const Archive* archive);
+	// Called when a file is written, names that were not found before may exist now.
+	void onFileWritten();
 
 	// Add a single file that can be referenced by 'fileName' even though the real name may be different.
 	void addSingleFilePath(const char* fileName, const char* filePath);
@@ -781,6 +781,15 @@ namespace TFE_FrontEndUI
 			gameSettings->df_disableFightMusic = disableFightMusic;
 		}
 
+		ImGui::SetNextItemWidth(196 * s_uiScale);
+		ImGui::SliderInt("Fixed Timestep (ticks)", &gameSettings->df_fixedTimestep, 0, 8);
+		if (gameSettings->df_fixedTimestep > 0)
+		{
+			ImGui::SameLine();
+			ImGui::Text("%.1f Hz", 145.0f / f32(gameSettings->df_fixedTimestep));
+			ImGui::Checkbox("Interpolate Frames", &gameSettings->df_interpolateFrames);
+		}
+
 		// File dialogs...
 		if (browseWinOpen >= 0)
 		{
@@ -1368,6 +1377,11 @@ namespace TFE_FrontEndUI
 		{
 			TFE_System::setVsync(vsync);
 		}
+		if (vsync)
+		{
+			ImGui::SameLine();
+			ImGui::Checkbox("Low Latency", &graphics->lowLatencyMode);
+		}
 		if (ImGui::Checkbox("Windowed", &windowed))
 		{
 			fullscreen = !windowed;
@@ -1441,6 +1455,12 @@ namespace TFE_FrontEndUI
 			ImGui::Checkbox("Async Framebuffer", &graphics->asyncFramebuffer);
 			ImGui::Checkbox("GPU Color Conversion", &graphics->gpuColorConvert);
 			ImGui::Checkbox("Extend Adjoin/Portal Limits", &graphics->extendAjoinLimits);
+			ImGui::SetNextItemWidth(196 * s_uiScale);
+			ImGui::SliderInt("Render Threads", &graphics->rendererThreadCount, 1, 8);
+			ImGui::Checkbox("8-bit GIF Recording", &graphics->indexedGifRecording);
+			ImGui::SetNextItemWidth(196 * s_uiScale);
+			ImGui::SliderInt("Sprite Cache (MB)", &graphics->spriteCacheSizeMB, 0, 64);
+			ImGui::Checkbox("Preload Sprites", &graphics->spriteCachePreload);
 		}
 		else if (s_rendererIndex == 1)
 		{
@@ -1663,6 +1683,7 @@ namespace TFE_FrontEndUI
 				ImSetDigitalChannelCount(8);
 			}
 		}
+		ImGui::Checkbox("Low Latency Audio (requires restart)", &sound->lowLatencyAudio);
 
 		TFE_Audio::setVolume(sound->soundFxVolume);
 		TFE_MidiPlayer::setVolume(sound->musicVolume);
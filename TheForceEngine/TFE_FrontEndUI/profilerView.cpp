@@ -3,25 +3,155 @@
 #include <TFE_RenderBackend/renderBackend.h>
 #include <TFE_System/system.h>
 #include <TFE_System/profiler.h>
+#include <TFE_System/frameLatency.h>
 #include <TFE_FileSystem/fileutil.h>
 #include <TFE_FileSystem/paths.h>
 #include <TFE_Archive/archive.h>
 #include <TFE_Ui/ui.h>
 #include <TFE_Ui/markdown.h>
 #include <TFE_System/parser.h>
+#include <TFE_FrontEndUI/console.h>
 
 #include <TFE_Ui/imGUI/imgui.h>
 #include <algorithm>
 
 namespace TFE_ProfilerView
 {
+	#define FLAME_MAX_LEVEL 32
+	#define FLAME_ROW_HEIGHT 18.0f
+
 	static bool s_open = false;
+	static bool s_showFlameGraph = true;
+
+	static const char* c_latencyStampNames[LSTAMP_COUNT] =
+	{
+		"Frame Begin",
+		"Input Sample",
+		"Simulation End",
+		"Render End",
+		"Upload",
+		"Swap Begin",
+		"Swap End",
+	};
+
+	void console_profilerTrace(const ConsoleArgList& args);
+	void console_latencyStats(const ConsoleArgList& args);
 
 	bool init()
 	{
+		CCMD("profilerTrace", console_profilerTrace, 0, "profilerTrace [frames] [file] - record zones on every thread for the next frames (default 120) and write a Chrome trace (chrome://tracing, Perfetto) to the user documents folder.");
+		CCMD("latencyStats", console_latencyStats, 0, "latencyStats [reset] - show the time from input to display over the last 256 rendered frames, with the time of each frame stage.");
 		return true;
 	}
 
+	void console_profilerTrace(const ConsoleArgList& args)
+	{
+		s32 frameCount = 120;
+		const char* filename = "tfe_trace.json";
+		if (args.size() >= 2)
+		{
+			frameCount = std::max(1, atoi(args[1].c_str()));
+		}
+		if (args.size() >= 3)
+		{
+			filename = args[2].c_str();
+		}
+
+		char tracePath[TFE_MAX_PATH];
+		TFE_Paths::appendPath(PATH_USER_DOCUMENTS, filename, tracePath);
+
+		char res[TFE_MAX_PATH + 64];
+		if (TFE_Profiler::beginTrace(frameCount, tracePath))
+		{
+			sprintf(res, "Recording %d frames to '%s'.", frameCount, tracePath);
+		}
+		else
+		{
+			sprintf(res, "A trace is already being recorded.");
+		}
+		TFE_Console::addToHistory(res);
+	}
+
+	void console_latencyStats(const ConsoleArgList& args)
+	{
+		if (args.size() >= 2 && strcasecmp(args[1].c_str(), "reset") == 0)
+		{
+			TFE_FrameLatency::resetStats();
+			TFE_Console::addToHistory("Latency statistics cleared.");
+			return;
+		}
+
+		LatencyStats stats;
+		TFE_FrameLatency::getStats(&stats);
+
+		char res[256];
+		sprintf(res, "Frames: %d, vsync: %s, low latency: %s, framebuffer delay: %d frame(s).", stats.frameCount, TFE_System::getVSync() ? "on" : "off",
+			stats.lowLatency ? "on" : "off", stats.displayDelay);
+		TFE_Console::addToHistory(res);
+		if (!stats.frameCount) { return; }
+
+		sprintf(res, "Input to display: %0.2fms average, %0.2fms 95th percentile, %0.2fms max.", stats.inputToDisplay.ave, stats.inputToDisplay95, stats.inputToDisplay.max);
+		TFE_Console::addToHistory(res);
+		if (stats.eventFrameCount)
+		{
+			sprintf(res, "Input event to display: %0.2fms average, %0.2fms max (%d events).", stats.eventToDisplay.ave, stats.eventToDisplay.max, stats.eventFrameCount);
+			TFE_Console::addToHistory(res);
+		}
+		if (stats.lowLatency)
+		{
+			sprintf(res, "Low latency wait: %0.2fms average, %0.2fms max.", stats.wait.ave, stats.wait.max);
+			TFE_Console::addToHistory(res);
+		}
+		for (s32 i = LSTAMP_INPUT; i < LSTAMP_COUNT; i++)
+		{
+			sprintf(res, "  %-16s %6.2fms average, %6.2fms max", c_latencyStampNames[i], stats.stage[i].ave, stats.stage[i].max);
+			TFE_Console::addToHistory(res);
+		}
+	}
+
+	// Draw the call paths of a single thread as a flame graph, where the width of each
+	// zone is its average share of the frame.
+	void drawFlameGraph(u32 start, u32 end, u32 maxLevel)
+	{
+		const f32 width = ImGui::GetContentRegionAvail().x;
+		const f32 height = FLAME_ROW_HEIGHT * f32(maxLevel + 1);
+		const ImVec2 origin = ImGui::GetCursorScreenPos();
+		ImDrawList* drawList = ImGui::GetWindowDrawList();
+		const ImVec2 mouse = ImGui::GetMousePos();
+
+		// Children are laid out left to right starting at their parent.
+		f32 levelX[FLAME_MAX_LEVEL + 1] = { 0 };
+		f32 levelWidth[FLAME_MAX_LEVEL + 1];
+		levelWidth[0] = width;
+		for (u32 z = start; z < end; z++)
+		{
+			TFE_ZoneInfo info;
+			TFE_Profiler::getZoneInfo(z, &info);
+			if (info.level >= FLAME_MAX_LEVEL) { continue; }
+
+			const f32 x0 = levelX[info.level];
+			const f32 w = levelWidth[info.level] * std::min(f32(info.fractOfParentAve), 1.0f);
+			levelX[info.level] += w;
+			levelX[info.level + 1] = x0;
+			levelWidth[info.level + 1] = w;
+			if (w < 1.0f) { continue; }
+
+			const ImVec2 p0(origin.x + x0, origin.y + FLAME_ROW_HEIGHT * f32(info.level));
+			const ImVec2 p1(p0.x + w - 1.0f, p0.y + FLAME_ROW_HEIGHT - 1.0f);
+			const u32 hue = (info.lineNumber * 37u) & 63u;
+			drawList->AddRectFilled(p0, p1, IM_COL32(160 + hue, 96 + hue, 32, 255));
+			drawList->PushClipRect(p0, p1, true);
+			drawList->AddText(ImVec2(p0.x + 2.0f, p0.y + 2.0f), IM_COL32(0, 0, 0, 255), info.name);
+			drawList->PopClipRect();
+
+			if (mouse.x >= p0.x && mouse.x < p1.x && mouse.y >= p0.y && mouse.y < p1.y)
+			{
+				ImGui::SetTooltip("%s\n%0.3fms (%0.2f%%)\n%s:%u", info.name, info.timeInZoneAve * 1000.0, info.fractOfParentAve * 100.0, info.func, info.lineNumber);
+			}
+		}
+		ImGui::Dummy(ImVec2(width, height));
+	}
+
 	void destroy()
 	{
 	}
@@ -47,6 +177,23 @@ namespace TFE_ProfilerView
 		}
 		ImGui::Unindent();
 
+		ImGui::Spacing();
+		ImGui::LabelText("##Label", "Latency");
+		ImGui::Separator();
+		LatencyStats latency;
+		TFE_FrameLatency::getStats(&latency);
+		ImGui::Indent();
+		ImGui::Text("%0.3fms", latency.inputToDisplay.ave); ImGui::SameLine(f32(128));
+		ImGui::Text("Input to Display (95%%: %0.3fms, max: %0.3fms)", latency.inputToDisplay95, latency.inputToDisplay.max);
+		ImGui::Text("%0.3fms", latency.eventToDisplay.ave); ImGui::SameLine(f32(128));
+		ImGui::Text("Input Event to Display");
+		for (s32 i = LSTAMP_INPUT; i < LSTAMP_COUNT; i++)
+		{
+			ImGui::Text("%0.3fms", latency.stage[i].ave); ImGui::SameLine(f32(128));
+			ImGui::Text("%s", c_latencyStampNames[i]);
+		}
+		ImGui::Unindent();
+
 		ImGui::Spacing();
 		ImGui::LabelText("##Label", "Zones");
 		ImGui::Separator();
@@ -57,13 +204,46 @@ namespace TFE_ProfilerView
 		ImGui::SameLine(f32(128));
 		ImGui::Text("Frame");
 
+		ImGui::SameLine(f32(256));
+		ImGui::Checkbox("Flame Graph", &s_showFlameGraph);
+		if (TFE_Profiler::isTraceActive())
+		{
+			ImGui::SameLine();
+			ImGui::Text("(recording trace)");
+		}
+
 		u32 zoneCount = TFE_Profiler::getZoneCount();
+		const char* thread = nullptr;
 		ImGui::Indent();
 		for (u32 z = 0; z < zoneCount; z++)
 		{
 			TFE_ZoneInfo info;
 			TFE_Profiler::getZoneInfo(z, &info);
 
+			// Each thread starts with a header, optionally followed by its flame graph.
+			if (!thread || strcmp(thread, info.thread) != 0)
+			{
+				thread = info.thread;
+				ImGui::Unindent();
+				ImGui::Spacing();
+				ImGui::Text("%s", thread);
+				ImGui::Indent();
+
+				if (s_showFlameGraph)
+				{
+					u32 end = z;
+					u32 maxLevel = 0;
+					for (; end < zoneCount; end++)
+					{
+						TFE_ZoneInfo next;
+						TFE_Profiler::getZoneInfo(end, &next);
+						if (strcmp(next.thread, thread) != 0) { break; }
+						maxLevel = std::max(maxLevel, next.level);
+					}
+					drawFlameGraph(z, end, std::min(maxLevel, (u32)FLAME_MAX_LEVEL - 1));
+				}
+			}
+
 			for (u32 l = 0; l < info.level; l++)
 			{
 				ImGui::Indent();
@@ -2,6 +2,10 @@
 #include <TFE_FrontEndUI/console.h>
 #include <TFE_DarkForces/darkForcesMain.h>
 #include <TFE_Outlaws/outlawsMain.h>
+#include <TFE_FileSystem/paths.h>
+#include <TFE_System/system.h>
+#include <TFE_Jedi/Memory/allocator.h>
+#include <algorithm>
 
 enum GameConstants
 {
@@ -36,6 +40,91 @@ void displayMemoryUsage(const ConsoleArgList& args)
 	TFE_Console::addToHistory("-------------------------------------------------------------------");
 }
 
+void displayRegionStats(const char* name, MemoryRegion* region)
+{
+	RegionStats stats;
+	region_getStats(region, &stats);
+
+	char res[256];
+	const f64 allocUs = stats.timedAllocCount ? TFE_System::convertFromTicksToSeconds(stats.allocTicks) * 1000000.0 / f64(stats.timedAllocCount) : 0.0;
+	const f64 freeUs  = stats.timedFreeCount  ? TFE_System::convertFromTicksToSeconds(stats.freeTicks)  * 1000000.0 / f64(stats.timedFreeCount)  : 0.0;
+	sprintf(res, "%-8s | %8u | %8u | %8u | %6u | %11zu | %12zu | %5.1f%% | %6.2f / %7.2f | %5.2f / %7.2f", name,
+		stats.allocCount, stats.freeCount, stats.reallocCount, stats.failedAllocCount, stats.freeBytes, stats.largestFree, stats.fragmentation * 100.0,
+		allocUs, TFE_System::convertFromTicksToSeconds(stats.maxAllocTicks) * 1000000.0,
+		freeUs, TFE_System::convertFromTicksToSeconds(stats.maxFreeTicks) * 1000000.0);
+	TFE_Console::addToHistory(res);
+}
+
+void displayMemoryStats(const ConsoleArgList& args)
+{
+	TFE_Console::addToHistory("-------------------------------------------------------------------------------------------------------------------");
+	TFE_Console::addToHistory("Region   |   Allocs |    Frees | Reallocs | Failed |  Free Bytes | Largest Free |  Frag  | Alloc us avg/max | Free us avg/max");
+	TFE_Console::addToHistory("-------------------------------------------------------------------------------------------------------------------");
+	displayRegionStats("Game", s_gameRegion);
+	displayRegionStats("Level", s_levelRegion);
+	displayRegionStats("Resource", s_resRegion);
+	TFE_Console::addToHistory("-------------------------------------------------------------------------------------------------------------------");
+}
+
+void trackMemoryLatency(const ConsoleArgList& args)
+{
+	const bool enable = TFE_Console::getBoolArg(args[1]);
+	region_setLatencyTracking(enable);
+	if (enable)
+	{
+		region_resetStats(s_gameRegion);
+		region_resetStats(s_levelRegion);
+		region_resetStats(s_resRegion);
+	}
+	TFE_Console::addToHistory(enable ? "Memory latency tracking enabled." : "Memory latency tracking disabled.");
+}
+
+void memoryTrace(const ConsoleArgList& args)
+{
+	if (strcasecmp(args[1].c_str(), "stop") == 0)
+	{
+		region_endTrace();
+		TFE_Console::addToHistory("Memory trace stopped.");
+		return;
+	}
+	if (strcasecmp(args[1].c_str(), "start") != 0 || args.size() < 3)
+	{
+		TFE_Console::addToHistory("Usage: memoryTrace start file | memoryTrace stop");
+		return;
+	}
+
+	char path[TFE_MAX_PATH];
+	char res[TFE_MAX_PATH + 64];
+	TFE_Paths::appendPath(PATH_USER_DOCUMENTS, args[2].c_str(), path);
+	sprintf(res, region_beginTrace(path) ? "Tracing memory regions to '%s'." : "Cannot start a memory trace to '%s'.", path);
+	TFE_Console::addToHistory(res);
+}
+
+void memoryBenchmark(const ConsoleArgList& args)
+{
+	char path[TFE_MAX_PATH];
+	char res[TFE_MAX_PATH + 64];
+	TFE_Paths::appendPath(PATH_USER_DOCUMENTS, args[1].c_str(), path);
+	const s32 iterations = args.size() >= 3 ? atoi(args[2].c_str()) : 10;
+
+	RegionReplayResult result;
+	if (!region_replayTrace(path, iterations, &result))
+	{
+		sprintf(res, "Cannot replay memory trace '%s'.", path);
+		TFE_Console::addToHistory(res);
+		return;
+	}
+
+	const f64 opScale = 1000000000.0 / f64(std::max(result.opCount, 1u) * std::max(iterations, 1));
+	sprintf(res, "%u operations x %d, %u failed allocations.", result.opCount, std::max(iterations, 1), result.failedAllocCount);
+	TFE_Console::addToHistory(res);
+	sprintf(res, "Region: %.1f ns/op, worst %.2f us, fragmentation %.1f%% (peak %.1f%%).", result.regionTime * opScale, result.regionMaxLatency * 1000000.0,
+		result.fragmentation * 100.0, result.peakFragmentation * 100.0);
+	TFE_Console::addToHistory(res);
+	sprintf(res, "Malloc: %.1f ns/op, worst %.2f us.", result.mallocTime * opScale, result.mallocMaxLatency * 1000000.0);
+	TFE_Console::addToHistory(res);
+}
+
 void game_init()
 {
 	s_gameRegion  = region_create("game",  GAME_MEMORY_BASE);	// Region for "permanent" game allocations.
@@ -43,10 +132,16 @@ void game_init()
 	s_resRegion   = region_create("resources", RES_MEMORY_BASE);	// Region for "per-level" resource allocations.
 
 	CCMD("displayMemoryUsage", displayMemoryUsage, 0, "Display memory usage.");
+	CCMD("displayMemoryStats", displayMemoryStats, 0, "Display allocation counts, fragmentation and latency for each memory region.");
+	CCMD("trackMemoryLatency", trackMemoryLatency, 1, "trackMemoryLatency 0/1 - time region allocations and frees, shown by displayMemoryStats.");
+	CCMD("memoryTrace", memoryTrace, 1, "memoryTrace start file / memoryTrace stop - record memory region operations to a file in the documents folder.");
+	CCMD("memoryBenchmark", memoryBenchmark, 1, "memoryBenchmark file [iterations] - replay a memory trace through the region allocator and malloc.");
+	TFE_Jedi::allocator_registerCommands();
 }
 
 void game_destroy()
 {
+	region_endTrace();
 	region_destroy(s_gameRegion);
 	region_destroy(s_levelRegion);
 	region_destroy(s_resRegion);
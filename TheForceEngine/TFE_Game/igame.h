@@ -29,6 +29,8 @@ struct IGame
 	virtual void exitGame() = 0;
 	virtual void pauseGame(bool pause) = 0;
 	virtual void loopGame() {};
+	// Called after the game tasks have run for the frame.
+	virtual void endFrame() {};
 		
 	GameID id;
 };
@@ -257,6 +257,50 @@ namespace TFE_Input
 		}
 	}
 
+	void inputMapping_clearPressed()
+	{
+		bool wasPressed[IA_COUNT];
+		for (u32 i = 0; i < IA_COUNT; i++)
+		{
+			wasPressed[i] = s_actions[i] == STATE_PRESSED;
+			if (wasPressed[i])
+			{
+				s_actions[i] = STATE_UP;
+			}
+		}
+
+		// Actions that are still held stay down.
+		for (u32 i = 0; i < s_inputConfig.bindCount; i++)
+		{
+			InputBinding* bind = &s_inputConfig.binds[i];
+			if (!wasPressed[bind->action])
+			{
+				continue;
+			}
+
+			bool down = false;
+			switch (bind->type)
+			{
+				case ITYPE_KEYBOARD:
+				{
+					down = TFE_Input::keyModDown(bind->keyMod) && TFE_Input::keyDown(bind->keyCode);
+				} break;
+				case ITYPE_MOUSE:
+				{
+					down = TFE_Input::keyModDown(bind->keyMod) && TFE_Input::mouseDown(bind->mouseBtn);
+				} break;
+				case ITYPE_CONTROLLER:
+				{
+					down = (s_inputConfig.controllerFlags & CFLAG_ENABLE) && TFE_Input::buttonDown(bind->ctrlBtn);
+				} break;
+			}
+			if (down)
+			{
+				s_actions[bind->action] = STATE_DOWN;
+			}
+		}
+	}
+
 	void inputMapping_updateInput()
 	{
 		for (u32 i = 0; i < s_inputConfig.bindCount; i++)
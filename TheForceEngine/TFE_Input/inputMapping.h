@@ -173,6 +173,8 @@ namespace TFE_Input
 	void inputMapping_removeState(InputAction action);
 	void inputMapping_clearKeyBinding(KeyboardCode key);
 	void inputMapping_endFrame();
+	// Turn pressed actions into held or released actions, so the same press is not seen again in the frame.
+	void inputMapping_clearPressed();
 
 	InputConfig* inputMapping_get();
 	u32 inputMapping_getBindingsForAction(InputAction action, u32* indices, u32 maxIndices);
@@ -4,6 +4,11 @@
 #include <TFE_Jedi/Level/robject.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Jedi/InfSystem/infSystem.h>
+#include <TFE_Jedi/Level/level.h>
+#include <TFE_System/system.h>
+#include <TFE_FrontEndUI/console.h>
+#include <algorithm>
+#include <vector>
 // Merge player collision into collision
 #include <TFE_DarkForces/playerCollision.h>
 using namespace TFE_DarkForces;
@@ -137,7 +142,18 @@ namespace TFE_Jedi
 	////////////////////////////////////////////////////////
 	IntersectionResult pathIntersectsWall(ColPath* path, RWall* wall);
 	vec2_fixed* computeIntersectPos();
+	// Range queries.
+	// A line of sight path that starts and ends inside of the query box can only cross walls that overlap the box,
+	// so only the sectors connected to the start sector through those walls can contain objects that are hit.
+	static std::vector<RSector*> s_rangeSectors;
+	static std::vector<u32> s_rangeSectorId;
+	static u32 s_rangeQueryId = 0;
+	static JBool s_rangeLinear = JFALSE;	// visit every sector, used to check the results.
+	// Walls are tested against a slightly larger box, so rounding in the intersection tests does not matter.
+	static const fixed16_16 c_rangeWallMargin = ONE_16;
+
 	SecObject* internal_getObjectCollision();
+	void console_rangeBenchmark(const ConsoleArgList& args);
 			
 	////////////////////////////////////////////////////////
 	// API Implementation
@@ -436,6 +452,66 @@ namespace TFE_Jedi
 		return (sector == sector1) ? JTRUE : JFALSE;
 	}
 
+	// Gather the sectors an object in range can be in, in sector index order, appended to s_rangeSectors.
+	// Returns the index of the first sector, the caller resizes s_rangeSectors back to it when done.
+	size_t collision_gatherRangeSectors(RSector* startSector, fixed16_16 x0, fixed16_16 z0, fixed16_16 x1, fixed16_16 z1)
+	{
+		const size_t base = s_rangeSectors.size();
+		if (s_rangeLinear)
+		{
+			RSector* sector = s_sectors;
+			for (u32 i = 0; i < s_sectorCount; i++, sector++)
+			{
+				s_rangeSectors.push_back(sector);
+			}
+			return base;
+		}
+
+		if (s_rangeSectorId.size() != s_sectorCount)
+		{
+			s_rangeSectorId.assign(s_sectorCount, 0);
+			s_rangeQueryId = 0;
+		}
+		s_rangeQueryId++;
+		if (!s_rangeQueryId)
+		{
+			std::fill(s_rangeSectorId.begin(), s_rangeSectorId.end(), 0);
+			s_rangeQueryId = 1;
+		}
+
+		x0 -= c_rangeWallMargin;
+		z0 -= c_rangeWallMargin;
+		x1 += c_rangeWallMargin;
+		z1 += c_rangeWallMargin;
+
+		// Flood fill through the adjoins that overlap the box.
+		s_rangeSectorId[startSector->index] = s_rangeQueryId;
+		s_rangeSectors.push_back(startSector);
+		for (size_t s = base; s < s_rangeSectors.size(); s++)
+		{
+			RSector* sector = s_rangeSectors[s];
+			RWall* wall = sector->walls;
+			for (s32 w = 0; w < sector->wallCount; w++, wall++)
+			{
+				RSector* next = wall->nextSector;
+				if (!next || s_rangeSectorId[next->index] == s_rangeQueryId) { continue; }
+
+				const vec2_fixed* w0 = wall->w0;
+				const vec2_fixed* w1 = wall->w1;
+				if (min(w0->x, w1->x) > x1 || max(w0->x, w1->x) < x0 || min(w0->z, w1->z) > z1 || max(w0->z, w1->z) < z0)
+				{
+					continue;
+				}
+				s_rangeSectorId[next->index] = s_rangeQueryId;
+				s_rangeSectors.push_back(next);
+			}
+		}
+
+		// Visit the sectors in the same order as a linear search.
+		std::sort(s_rangeSectors.begin() + base, s_rangeSectors.end(), [](const RSector* a, const RSector* b) { return a->index < b->index; });
+		return base;
+	}
+
 	// Determines if an object with the correct entityFlag(s) is in range (radius) of (x,y,z) in sector and is not skipObj.
 	// Note only objects with a clear line-of-sight are accepted.
 	JBool collision_isAnyObjectInRange(RSector* sector, fixed16_16 radius, vec3_fixed origin, SecObject* skipObj, u32 entityFlags)
@@ -453,30 +529,27 @@ namespace TFE_Jedi
 		fixed16_16 y1 = origin.y + radius;
 		fixed16_16 z1 = origin.z + radius;
 
-		fixed16_16 secHeightThreshold = origin.y - FIXED(2);
-		RSector* curSector = s_sectors;
-
-		for (u32 i = 0; i < s_sectorCount; i++, curSector++)
+		///////////////////////////////////////////////
+		// These tests only depend on the start sector.
+		///////////////////////////////////////////////
+		if (x0 > sector->boundsMax.x || x1 < sector->boundsMin.x || z0 > sector->boundsMax.z || z1 < sector->boundsMin.z)
 		{
-			///////////////////////////////////////////////
-			// These tests should only happen once I think,
-			// unless x0, x1, z0, z1 change over time.
-			///////////////////////////////////////////////
-			if (x0 > sector->boundsMax.x || x1 < sector->boundsMin.x || z0 > sector->boundsMax.z || z1 < sector->boundsMin.z)
-			{
-				continue;
-			}
+			return JFALSE;
+		}
 
-			fixed16_16 floorHeight, ceilHeight;
-			sector_calculateFloor(sector, origin.y, &floorHeight, &ceilHeight);
-			if (floorHeight < y0 || ceilHeight > y1)
-			{
-				continue;
-			}
-			/////////////////////////////////////////////
-			// End of checks to pull out of the loop.
-			/////////////////////////////////////////////
+		fixed16_16 floorHeight, ceilHeight;
+		sector_calculateFloor(sector, origin.y, &floorHeight, &ceilHeight);
+		if (floorHeight < y0 || ceilHeight > y1)
+		{
+			return JFALSE;
+		}
 
+		JBool result = JFALSE;
+		const size_t base = collision_gatherRangeSectors(sector, x0, z0, x1, z1);
+		const size_t end = s_rangeSectors.size();
+		for (size_t s = base; s < end && !result; s++)
+		{
+			RSector* curSector = s_rangeSectors[s];
 			s32 objCapacity = curSector->objectCapacity;
 			s32 objCount = curSector->objectCount;
 			for (s32 objListIndex = 0, objIndex = 0; objIndex < objCount && objListIndex < objCapacity; objListIndex++)
@@ -492,28 +565,30 @@ namespace TFE_Jedi
 					continue;
 				}
 
-				RSector* curSector = sector;
+				RSector* pathSector = sector;
 				RWall* hitWall = collision_wallCollisionFromPath(sector, origin.x, origin.z, obj->posWS.x, obj->posWS.z);
-				while (hitWall && curSector && curSector != obj->sector)
+				while (hitWall && pathSector && pathSector != obj->sector)
 				{
-					curSector = hitWall->nextSector;
-					if (curSector)
+					pathSector = hitWall->nextSector;
+					if (pathSector)
 					{
-						if (curSector->floorHeight - curSector->ceilingHeight < HALF_16)
+						if (pathSector->floorHeight - pathSector->ceilingHeight < HALF_16)
 						{
 							break;
 						}
-						hitWall = collision_pathWallCollision(curSector);
+						hitWall = collision_pathWallCollision(pathSector);
 					}
 				}
 
-				if (curSector == obj->sector)
+				if (pathSector == obj->sector)
 				{
-					return JTRUE;
+					result = JTRUE;
+					break;
 				}
 			}
 		}
-		return JFALSE;
+		s_rangeSectors.resize(base);
+		return result;
 	}
 		
 	// Call the effectFunc() for each object within 'range' of point (x,y,z). This will only be called for objects in range and that have a valid collision path.
@@ -528,20 +603,20 @@ namespace TFE_Jedi
 		const fixed16_16 y1 = origin.y + range;
 		const fixed16_16 z1 = origin.z + range;
 
-		const fixed16_16 secHeightThreshold = origin.y - FIXED(2);
-		RSector* sector = s_sectors;
-		for (u32 i = 0; i < s_sectorCount; i++, sector++)
+		// The start sector check does not depend on the sector being visited.
+		if (!startSector || x0 > startSector->boundsMax.x || x1 < startSector->boundsMin.x || z0 > startSector->boundsMax.z || z1 < startSector->boundsMin.z)
 		{
-			// Checks the start sector, should be pulled out of the loop.
-			if (x0 > startSector->boundsMax.x || x1 < startSector->boundsMin.x || z0 > startSector->boundsMax.z || z1 < startSector->boundsMin.z)
-			{
-				continue;
-			}
+			return;
+		}
 
+		const size_t base = collision_gatherRangeSectors(startSector, x0, z0, x1, z1);
+		const size_t end = s_rangeSectors.size();
+		for (size_t s = base; s < end; s++)
+		{
+			RSector* sector = s_rangeSectors[s];
 			fixed16_16 floor, ceil;
 			sector_calculateFloor(sector, origin.y, &floor, &ceil);
 			if (y0 > floor || y1 < ceil) { continue; }
-			// End of start sector check.
 
 			for (s32 objIndex = 0, objListIndex = 0; objIndex < sector->objectCount && objListIndex < sector->objectCapacity; objListIndex++)
 			{
@@ -569,6 +644,7 @@ namespace TFE_Jedi
 				}
 			}  // Object Loop.
 		}  // Sector loop.
+		s_rangeSectors.resize(base);
 	}
 
 	// Call the effectFunc() for each object within 'range' of point (x,y,z). This will only be called for objects in range and that have a valid collision path.
@@ -588,23 +664,23 @@ namespace TFE_Jedi
 		const fixed16_16 y1 = origin.y + range;
 		const fixed16_16 z1 = origin.z + range;
 
-		const fixed16_16 secHeightThreshold = origin.y - FIXED(2);
-		RSector* sector = s_sectors;
-		for (u32 i = 0; i < s_sectorCount; i++, sector++)
+		// The start sector checks do not depend on the sector being visited.
+		if (x0 > startSector->boundsMax.x || x1 < startSector->boundsMin.x || z0 > startSector->boundsMax.z || z1 < startSector->boundsMin.z)
 		{
-			// Checks the start sector, should be pulled out of the loop.
-			if (x0 > startSector->boundsMax.x || x1 < startSector->boundsMin.x || z0 > startSector->boundsMax.z || z1 < startSector->boundsMin.z)
-			{
-				continue;
-			}
-			fixed16_16 floor, ceil;
-			sector_calculateFloor(startSector, origin.y, &floor, &ceil);
-			if (y0 > floor || y1 < ceil)
-			{
-				continue;
-			}
-			// End of start sector check.
+			return;
+		}
+		fixed16_16 floor, ceil;
+		sector_calculateFloor(startSector, origin.y, &floor, &ceil);
+		if (y0 > floor || y1 < ceil)
+		{
+			return;
+		}
 
+		const size_t base = collision_gatherRangeSectors(startSector, x0, z0, x1, z1);
+		const size_t end = s_rangeSectors.size();
+		for (size_t s = base; s < end; s++)
+		{
+			RSector* sector = s_rangeSectors[s];
 			for (s32 objIndex = 0, objListIndex = 0; objIndex < sector->objectCount && objListIndex < sector->objectCapacity; objListIndex++)
 			{
 				SecObject* obj = sector->objectList[objListIndex];
@@ -653,6 +729,7 @@ namespace TFE_Jedi
 				}
 			}  // Object Loop.
 		}  // Sector Loop.
+		s_rangeSectors.resize(base);
 	}
 		
 	static RSector*   s_hcolSector;
@@ -1070,4 +1147,90 @@ namespace TFE_Jedi
 
 		return handleCollisionFunc(sector);
 	}
-}
\ No newline at end of file
+
+	////////////////////////////////////////////////////////
+	// Range query benchmark
+	////////////////////////////////////////////////////////
+	enum
+	{
+		RANGE_BENCH_DEFAULT_COUNT = 1000,
+	};
+	static u32 s_rangeBenchHash = 0;
+	static s32 s_rangeBenchHits = 0;
+
+	void collision_init()
+	{
+		CCMD("rangeBenchmark", console_rangeBenchmark, 0, "Time explosion range queries against a search of every sector, optional argument: explosion count (default 1000).");
+	}
+
+	void rangeBenchmark_effectFunc(SecObject* obj)
+	{
+		s_rangeBenchHash = s_rangeBenchHash * 31 + u32(obj->sector->index) * 4099 + u32(obj->posWS.x ^ obj->posWS.z);
+		s_rangeBenchHits++;
+	}
+
+	// Explode in the middle of pseudo-random sectors, with the thermal detonator ranges.
+	f64 collision_runRangeBenchmark(s32 count, JBool linear)
+	{
+		s_rangeLinear = linear;
+		s_rangeBenchHash = 0;
+		s_rangeBenchHits = 0;
+		u32 seed = 0x1234567;
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		for (s32 i = 0; i < count; i++)
+		{
+			seed = seed * 1103515245u + 12345u;
+			RSector* sector = &s_sectors[(seed >> 8) % s_sectorCount];
+			vec3_fixed origin;
+			origin.x = (sector->boundsMin.x + sector->boundsMax.x) >> 1;
+			origin.z = (sector->boundsMin.z + sector->boundsMax.z) >> 1;
+			origin.y = sector->floorHeight - FIXED(2);
+
+			collision_effectObjectsInRange3D(sector, FIXED(30), origin, rangeBenchmark_effectFunc, nullptr, 0xffffffff);
+			collision_effectObjectsInRangeXZ(sector, FIXED(50), origin, rangeBenchmark_effectFunc, nullptr, 0xffffffff);
+			if (collision_isAnyObjectInRange(sector, FIXED(15), origin, nullptr, 0xffffffff))
+			{
+				s_rangeBenchHash = s_rangeBenchHash * 31 + 1;
+			}
+		}
+		const f64 elapsed = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+		s_rangeLinear = JFALSE;
+		return elapsed;
+	}
+
+	void console_rangeBenchmark(const ConsoleArgList& args)
+	{
+		if (!s_sectors || !s_sectorCount)
+		{
+			TFE_Console::addToHistory("The range benchmark requires a level to be loaded.");
+			return;
+		}
+
+		s32 count = RANGE_BENCH_DEFAULT_COUNT;
+		if (args.size() >= 2)
+		{
+			count = max(1, atoi(args[1].c_str()));
+		}
+
+		const f64 linearTime = collision_runRangeBenchmark(count, JTRUE);
+		const u32 linearHash = s_rangeBenchHash;
+		const s32 linearHits = s_rangeBenchHits;
+		const f64 graphTime = collision_runRangeBenchmark(count, JFALSE);
+
+		char msg[256];
+		sprintf(msg, "Range benchmark: %d explosions, %u sectors, %d objects hit.", count, s_sectorCount, s_rangeBenchHits);
+		TFE_Console::addToHistory(msg);
+		sprintf(msg, "  Every sector: %0.4f ms/explosion, Sector graph: %0.4f ms/explosion.", linearTime * 1000.0 / count, graphTime * 1000.0 / count);
+		TFE_Console::addToHistory(msg);
+		if (linearHash != s_rangeBenchHash || linearHits != s_rangeBenchHits)
+		{
+			TFE_Console::addToHistory("  Affected objects MISMATCH between the sector graph and the search of every sector.");
+			TFE_System::logWrite(LOG_ERROR, "Collision", "Range benchmark: the sector graph query affected different objects than the search of every sector.");
+		}
+		else
+		{
+			TFE_Console::addToHistory("  Affected objects match.");
+		}
+	}
+}
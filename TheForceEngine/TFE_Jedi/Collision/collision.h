@@ -76,6 +76,9 @@ typedef void(*CollisionEffectFunc)(SecObject*);
 
 namespace TFE_Jedi
 {
+	// Registers the collision console commands.
+	void collision_init();
+
 	void collision_getHitPoint(fixed16_16* x, fixed16_16* z);
 	fixed16_16 collision_getHitDistance();
 	RSector* collision_tryMove(RSector* sector, fixed16_16 x0, fixed16_16 z0, fixed16_16 x1, fixed16_16 z1);
@@ -85,6 +88,8 @@ namespace TFE_Jedi
 	JBool collision_canHitObject(RSector* startSector, RSector* endSector, vec3_fixed p0, vec3_fixed p1, u32 exclWallFlags3);
 
 	SecObject* collision_getObjectCollision(RSector* sector, CollisionInterval* interval, SecObject* prevObj);
+	// Range queries only visit the sectors connected to the start sector through adjoins that overlap the range,
+	// in sector index order, which gives the same results as searching every sector.
 	JBool collision_isAnyObjectInRange(RSector* sector, fixed16_16 radius, vec3_fixed origin, SecObject* skipObj, u32 entityFlags);
 
 	void collision_effectObjectsInRange3D(RSector* startSector, fixed16_16 range, vec3_fixed origin, CollisionEffectFunc effectFunc, SecObject* excludeObj, u32 entityFlags);
@@ -16,6 +16,11 @@ namespace TFE_Jedi
 	#define DEFAULT_SOUND_CHANNELS 8
 	#define AUDIO_BUFFER_SIZE 512
 
+	// Must be powers of two.
+	#define IM_WAVE_CMD_COUNT 32
+	#define IM_WAVE_EVENT_COUNT 64
+
+	// TFE: The lock only serializes the game and iMuse threads, the mixer never takes it.
 	#define AUDIO_LOCK()   TFE_Audio::lock()
 	#define AUDIO_UNLOCK() TFE_Audio::unlock()
 
@@ -43,6 +48,8 @@ namespace TFE_Jedi
 
 		s32 detuneTrans;
 		s32 mailbox;
+		// TFE: Changes every time the channel starts a sound, so the mixer can tell its copy is stale.
+		u32 serial;
 	};
 
 	struct ImWaveData
@@ -52,6 +59,40 @@ namespace TFE_Jedi
 		s32 chunkSize;
 		s32 baseOffset;
 		s32 chunkIndex;
+		// TFE: Looked up when the sound starts, the audio thread does not access the iMuse sound tables.
+		const u8* sndData;
+	};
+
+	// TFE: The audio thread mixes its own copy of each playing sound, so the mix does not need the audio lock.
+	// Sounds are handed to the mixer through a command queue, markers and finished sounds are handed back
+	// through an event queue and the finished serials, which ImUpdate() picks up on the iMuse thread.
+	struct ImWaveVoice
+	{
+		ImWaveData data;
+		u32 serial;
+		JBool active;
+	};
+
+	struct ImWaveCommand
+	{
+		s32 slot;
+		u32 serial;
+		ImWaveData data;
+	};
+
+	enum ImWaveEventType
+	{
+		IM_WAVE_EVENT_MARKER = 0,
+		IM_WAVE_EVENT_MAILBOX,
+	};
+
+	struct ImWaveEvent
+	{
+		ImWaveEventType type;
+		s32 slot;
+		u32 serial;
+		s32 mailbox;
+		const u8* marker;
 	};
 
 	/////////////////////////////////////////////////////
@@ -62,10 +103,22 @@ namespace TFE_Jedi
 	static ImWaveSound* s_imWaveSoundList = nullptr;
 	static ImWaveSound  s_imWaveSound[MAX_SOUND_CHANNELS];
 	static ImWaveData   s_imWaveData[MAX_SOUND_CHANNELS];
-	static u8  s_imWaveChunkData[48];
 	static s32 s_imWaveMixCount = DEFAULT_SOUND_CHANNELS;
 	static s32 s_imWaveNanosecsPerSample;
 	static iMuseInitData* s_imDigitalData;
+	static atomic_u32 s_imWaveSerial(0);
+
+	// Mixer state, only touched by the audio thread.
+	static ImWaveVoice s_imWaveVoice[MAX_SOUND_CHANNELS];
+	// Serial of the last sound that finished playing in each channel, written by the mixer.
+	static atomic_u32 s_imWaveFinished[MAX_SOUND_CHANNELS];
+
+	static ImWaveCommand s_imWaveCmd[IM_WAVE_CMD_COUNT];
+	static atomic_u32 s_imWaveCmdWrite(0);
+	static atomic_u32 s_imWaveCmdRead(0);
+	static ImWaveEvent s_imWaveEvent[IM_WAVE_EVENT_COUNT];
+	static atomic_u32 s_imWaveEventWrite(0);
+	static atomic_u32 s_imWaveEventRead(0);
 
 	// In DOS these are 8-bit outputs since that is what the driver is accepting.
 	// For TFE, floating-point audio output is used, so these convert to floating-point.
@@ -92,7 +145,10 @@ namespace TFE_Jedi
 	s32 ImGetWaveParamIntern(ImSoundId soundId, s32 param);
 	s32 ImFreeWaveSoundByIdIntern(ImSoundId soundId);
 	s32 ImStartDigitalSoundIntern(ImSoundId soundId, s32 priority, s32 chunkIndex);
-	s32 audioPlaySoundFrame(ImWaveSound* sound);
+	void ImResetWaveMixer();
+	void ImProcessWaveCommands();
+	void ImApplyWaveEvent(const ImWaveEvent* evt);
+	s32 audioPlaySoundFrame(ImWaveVoice* voice, s32 slot, s32 volume, s32 pan);
 	s32 audioWriteToDriver(f32 systemVolume);
 		
 	/////////////////////////////////////////////////////////// 
@@ -134,6 +190,7 @@ namespace TFE_Jedi
 			sound->soundId = IM_NULL_SOUNDID;
 		}
 
+		ImResetWaveMixer();
 		TFE_Audio::setAudioThreadCallback(ImUpdateWave);
 
 		return ImComputeAudioNormalizationInit(initData);
@@ -179,6 +236,39 @@ namespace TFE_Jedi
 		return res;
 	}
 
+	// Set the volume and pan of many wave sounds at once, the sound list is walked once.
+	// Like ImSetWaveParam(), this does not take the audio lock.
+	// Returns the number of sounds updated, sounds that are no longer playing are skipped.
+	s32 ImSetWaveVolumePan(const ImSoundId* soundIds, const s32* volumes, const s32* pans, s32 count)
+	{
+		if (count <= 0) { return 0; }
+
+		s32 updated = 0;
+		ImWaveSound* sound = s_imWaveSoundList;
+		while (sound)
+		{
+			// There are far fewer playing sounds than entries, search backwards so the latest entry wins.
+			for (s32 i = count - 1; i >= 0; i--)
+			{
+				if (soundIds[i] != sound->soundId) { continue; }
+
+				if (volumes[i] >= 0 && volumes[i] <= 127)
+				{
+					sound->baseVolume = volumes[i];
+					sound->volume = ((sound->baseVolume + 1) * ImGetGroupVolume(sound->group)) >> 7;
+				}
+				if (pans[i] >= 0 && pans[i] <= 127)
+				{
+					sound->pan = pans[i];
+				}
+				updated++;
+				break;
+			}
+			sound = sound->next;
+		}
+		return updated;
+	}
+
 	s32 ImGetWaveParam(ImSoundId soundId, s32 param)
 	{
 		return ImGetWaveParamIntern(soundId, param);
@@ -198,18 +288,51 @@ namespace TFE_Jedi
 		memset(s_audioOut, 0, 2 * bufferSize * sizeof(s16));
 
 		// Write sounds to s_audioOut.
-		ImWaveSound* sound = s_imWaveSoundList;
-		while (sound)
+		ImProcessWaveCommands();
+		ImWaveVoice* voice = s_imWaveVoice;
+		for (s32 i = 0; i < MAX_SOUND_CHANNELS; i++, voice++)
 		{
-			ImWaveSound* next = sound->next;
-			audioPlaySoundFrame(sound);
-			sound = next;
+			if (!voice->active) { continue; }
+
+			// The channel was freed or started another sound since the voice started.
+			const ImWaveSound* sound = &s_imWaveSound[i];
+			if (!sound->soundId || sound->serial != voice->serial)
+			{
+				voice->active = JFALSE;
+				continue;
+			}
+			audioPlaySoundFrame(voice, i, sound->volume, sound->pan);
 		}
 
 		// Convert s_audioOut to "driver" buffer.
 		audioWriteToDriver(systemVolume);
 	}
 
+	// Called on the iMuse thread, frees the sounds the mixer finished and runs the markers it found.
+	void ImUpdateWaveEvents()
+	{
+		AUDIO_LOCK();
+		{
+			const u32 write = s_imWaveEventWrite.load(std::memory_order_acquire);
+			u32 read = s_imWaveEventRead.load(std::memory_order_relaxed);
+			for (; read != write; read++)
+			{
+				ImApplyWaveEvent(&s_imWaveEvent[read & (IM_WAVE_EVENT_COUNT - 1)]);
+			}
+			s_imWaveEventRead.store(read, std::memory_order_release);
+
+			ImWaveSound* sound = s_imWaveSound;
+			for (s32 i = 0; i < MAX_SOUND_CHANNELS; i++, sound++)
+			{
+				if (sound->soundId && s_imWaveFinished[i].load(std::memory_order_acquire) == sound->serial)
+				{
+					ImFreeWaveSound(sound);
+				}
+			}
+		}
+		AUDIO_UNLOCK();
+	}
+
 	s32 ImPauseDigitalSound()
 	{
 		s_digitalPause = 1;
@@ -231,6 +354,98 @@ namespace TFE_Jedi
 		return &s_imWaveData[index];
 	}
 
+	s32 ImGetWaveSlot(const ImWaveSound* sound)
+	{
+		return s32(sound - s_imWaveSound);
+	}
+
+	void ImResetWaveMixer()
+	{
+		for (s32 i = 0; i < MAX_SOUND_CHANNELS; i++)
+		{
+			s_imWaveVoice[i].active = JFALSE;
+			s_imWaveFinished[i].store(0u);
+		}
+		s_imWaveCmdWrite.store(0u);
+		s_imWaveCmdRead.store(0u);
+		s_imWaveEventWrite.store(0u);
+		s_imWaveEventRead.store(0u);
+	}
+
+	// Called with the audio lock held, so there is a single producer.
+	JBool ImPushWaveCommand(const ImWaveSound* sound)
+	{
+		const u32 write = s_imWaveCmdWrite.load(std::memory_order_relaxed);
+		if (write - s_imWaveCmdRead.load(std::memory_order_acquire) >= IM_WAVE_CMD_COUNT)
+		{
+			IM_LOG_ERR("Wave command queue is full, soundId: 0x%x", sound->soundId);
+			return JFALSE;
+		}
+
+		ImWaveCommand* cmd = &s_imWaveCmd[write & (IM_WAVE_CMD_COUNT - 1)];
+		cmd->slot = ImGetWaveSlot(sound);
+		cmd->serial = sound->serial;
+		cmd->data = *sound->data;
+		s_imWaveCmdWrite.store(write + 1, std::memory_order_release);
+		return JTRUE;
+	}
+
+	// Audio thread only.
+	void ImProcessWaveCommands()
+	{
+		const u32 write = s_imWaveCmdWrite.load(std::memory_order_acquire);
+		u32 read = s_imWaveCmdRead.load(std::memory_order_relaxed);
+		for (; read != write; read++)
+		{
+			const ImWaveCommand* cmd = &s_imWaveCmd[read & (IM_WAVE_CMD_COUNT - 1)];
+			ImWaveVoice* voice = &s_imWaveVoice[cmd->slot];
+			voice->data = cmd->data;
+			voice->serial = cmd->serial;
+			voice->active = JTRUE;
+		}
+		s_imWaveCmdRead.store(read, std::memory_order_release);
+	}
+
+	// Markers and mailbox changes found while seeking are applied right away on the iMuse thread
+	// and handed back through the event queue on the audio thread.
+	void ImWaveEmitEvent(ImWaveEventType type, s32 slot, u32 serial, s32 mailbox, const u8* marker, JBool mixer)
+	{
+		const ImWaveEvent evt = { type, slot, serial, mailbox, marker };
+		if (!mixer)
+		{
+			ImApplyWaveEvent(&evt);
+			return;
+		}
+
+		const u32 write = s_imWaveEventWrite.load(std::memory_order_relaxed);
+		if (write - s_imWaveEventRead.load(std::memory_order_acquire) >= IM_WAVE_EVENT_COUNT)
+		{
+			// The iMuse thread is not keeping up, dropping a marker is better than blocking the mixer.
+			return;
+		}
+		s_imWaveEvent[write & (IM_WAVE_EVENT_COUNT - 1)] = evt;
+		s_imWaveEventWrite.store(write + 1, std::memory_order_release);
+	}
+
+	void ImApplyWaveEvent(const ImWaveEvent* evt)
+	{
+		ImWaveSound* sound = &s_imWaveSound[evt->slot];
+		// The channel has moved on to another sound.
+		if (!sound->soundId || sound->serial != evt->serial)
+		{
+			return;
+		}
+
+		if (evt->type == IM_WAVE_EVENT_MARKER)
+		{
+			ImSetSoundTrigger((ImSoundId)sound, (void*)evt->marker);
+		}
+		else if (sound->mailbox == 0)
+		{
+			sound->mailbox = evt->mailbox;
+		}
+	}
+
 	s32 ImComputeAudioNormalization(s32 waveMixCount)
 	{
 		s32 volumeMidPoint = 128;
@@ -443,12 +658,15 @@ namespace TFE_Jedi
 		return nullptr;
 	}
 
-	s32 ImSeekToNextChunk(ImWaveData* data)
+	// TFE: Runs on the iMuse thread when a sound starts and on the audio thread afterwards ('mixer').
+	s32 ImSeekToNextChunk(ImWaveData* data, s32 slot, u32 serial, JBool mixer)
 	{
 		while (1)
 		{
-			u8* chunkData = s_imWaveChunkData;
-			u8* sndData = nullptr;
+			// TFE: Local copy of the chunk header since the seek may run on either thread.
+			u8 chunkHeader[48];
+			u8* chunkData = chunkHeader;
+			const u8* sndData = nullptr;
 
 			if (data->chunkIndex)
 			{
@@ -464,17 +682,7 @@ namespace TFE_Jedi
 			}
 			else  // chunkIndex == 0
 			{
-				ImWaveSound* sound = data->sound;
-				sndData = ImInternalGetSoundData(sound->soundId);
-				if (!sndData)
-				{
-					if (sound->mailbox == 0)
-					{
-						sound->mailbox = 8;
-					}
-					IM_LOG_ERR("null sound addr in SeekToNextChunk()...");
-					return imFail;
-				}
+				sndData = data->sndData;
 			}
 
 			memcpy(chunkData, sndData + data->offset, 48);
@@ -493,11 +701,7 @@ namespace TFE_Jedi
 				data->chunkSize = chunkSize;
 				if (chunkSize > 220000)
 				{
-					ImWaveSound* sound = data->sound;
-					if (sound->mailbox == 0)
-					{
-						sound->mailbox = 9;
-					}
+					ImWaveEmitEvent(IM_WAVE_EVENT_MAILBOX, slot, serial, 9, nullptr, mixer);
 				}
 
 				data->offset += 6;
@@ -510,8 +714,8 @@ namespace TFE_Jedi
 			}
 			else if (id == 4)
 			{
-				chunkData += 3;
-				ImSetSoundTrigger((ImSoundId)data->sound, chunkData);
+				// The marker points into the sound data rather than the local chunk copy, it is used after the seek returns.
+				ImWaveEmitEvent(IM_WAVE_EVENT_MARKER, slot, serial, 0, sndData + data->offset + 4, mixer);
 				data->offset += 6;
 			}
 			else if (id == 6)
@@ -570,7 +774,17 @@ namespace TFE_Jedi
 		}
 
 		data->chunkIndex = 0;
-		return ImSeekToNextChunk(data);
+		data->sndData = ImInternalGetSoundData(sound->soundId);
+		if (!data->sndData)
+		{
+			if (sound->mailbox == 0)
+			{
+				sound->mailbox = 8;
+			}
+			IM_LOG_ERR("null sound addr in SeekToNextChunk()...");
+			return imFail;
+		}
+		return ImSeekToNextChunk(data, ImGetWaveSlot(sound), sound->serial, JFALSE);
 	}
 
 	s32 ImStartDigitalSoundIntern(ImSoundId soundId, s32 priority, s32 chunkIndex)
@@ -593,6 +807,7 @@ namespace TFE_Jedi
 		sound->transpose = 0;
 		sound->detuneTrans = 0;
 		sound->mailbox = 0;
+		sound->serial = ++s_imWaveSerial;
 		if (ImWaveSetupSoundData(sound, chunkIndex) != imSuccess)
 		{
 			IM_LOG_ERR("Failed to setup wave player data - soundId: 0x%x, priority: %d", soundId, priority);
@@ -600,13 +815,19 @@ namespace TFE_Jedi
 			return imFail;
 		}
 
+		s32 res = imSuccess;
 		AUDIO_LOCK();
 		{
 			IM_LIST_ADD(s_imWaveSoundList, sound);
+			if (!ImPushWaveCommand(sound))
+			{
+				ImFreeWaveSound(sound);
+				res = imFail;
+			}
 		}
 		AUDIO_UNLOCK();
 
-		return imSuccess;
+		return res;
 	}
 
 	void ImFreeWaveSound(ImWaveSound* sound)
@@ -635,6 +856,8 @@ namespace TFE_Jedi
 			}
 		}
 		AUDIO_UNLOCK();
+		// The sound data may be released once this returns.
+		TFE_Audio::waitForMix();
 		return imSuccess;
 	}
 
@@ -697,9 +920,9 @@ namespace TFE_Jedi
 		digitalAudioOutput_Stereo(&s_audioOut[outOffset * 2], audioFrame, leftMapping, rightMapping, size);
 	}
 
-	s32 audioPlaySoundFrame(ImWaveSound* sound)
+	s32 audioPlaySoundFrame(ImWaveVoice* voice, s32 slot, s32 volume, s32 pan)
 	{
-		ImWaveData* data = sound->data;
+		ImWaveData* data = &voice->data;
 		s32 bufferSize = s_audioOutSize;
 		s32 offset = 0;
 		s32 res = imSuccess;
@@ -708,20 +931,22 @@ namespace TFE_Jedi
 			res = imSuccess;
 			if (!data->chunkSize)
 			{
-				res = ImSeekToNextChunk(data);
+				res = ImSeekToNextChunk(data, slot, voice->serial, JTRUE);
 				if (res != imSuccess)
 				{
 					if (res == imFail)  // Sound has finished playing.
 					{
-						ImFreeWaveSound(sound);
+						// TFE: The sound is freed on the iMuse thread, see ImUpdateWaveEvents().
+						voice->active = JFALSE;
+						s_imWaveFinished[slot].store(voice->serial, std::memory_order_release);
 					}
 					break;
 				}
 			}
 
 			s32 readSize = (bufferSize <= data->chunkSize) ? bufferSize : data->chunkSize;
-			s_audioData = ImInternalGetSoundData(sound->soundId) + data->offset;
-			audioProcessFrame(s_audioData, readSize, offset, sound->volume, sound->pan);
+			s_audioData = (u8*)data->sndData + data->offset;
+			audioProcessFrame(s_audioData, readSize, offset, volume, pan);
 
 			offset += readSize;
 			bufferSize -= readSize;
@@ -767,6 +992,8 @@ namespace TFE_Jedi
 			}
 		}
 		AUDIO_UNLOCK();
+		// The sound data may be released once this returns.
+		TFE_Audio::waitForMix();
 
 		return result;
 	}
@@ -31,8 +31,10 @@ namespace TFE_Jedi
 
 	s32 ImSetWaveParam(ImSoundId soundId, s32 param, s32 value);
 	s32 ImGetWaveParam(ImSoundId soundId, s32 param);
+	s32 ImSetWaveVolumePan(const ImSoundId* soundIds, const s32* volumes, const s32* pans, s32 count);
 	s32 ImStartDigitalSound(ImSoundId soundId, s32 priority);
 	void ImUpdateWave(f32* buffer, u32 bufferSize, f32 systemVolume);
+	void ImUpdateWaveEvents();
 
 	s32 ImFreeWaveSoundById(ImSoundId soundId);
 	s32 ImFreeAllWaveSounds();
@@ -1,6 +1,7 @@
 #include "imuse.h"
 #include <TFE_Audio/midi.h>
 #include <TFE_Audio/midiPlayer.h>
+#include <TFE_Audio/audioSystem.h>
 #include <TFE_System/system.h>
 #include <TFE_System/Threads/thread.h>
 #include <TFE_Memory/memoryRegion.h>
@@ -106,6 +107,7 @@ namespace TFE_Jedi
 	void ImMidiLock();
 	void ImMidiUnlock();
 	s32  ImGetDeltaTime();
+	f64  ImGetTimestep();
 	s32  ImMidiSetSpeed(ImPlayerData* data, u32 value);
 	void ImSetTempo(ImPlayerData* data, u32 tempo);
 	void ImSetMidiTicksPerBeat(ImPlayerData* data, s32 ticksPerBeat, s32 beatsPerMeasure);;
@@ -158,6 +160,9 @@ namespace TFE_Jedi
 	const char* c_midi = "MIDI";
 	const char* c_crea = "Crea";
 	static s32 s_iMuseTimestepMicrosec = 6944;
+	static bool s_offlineRender = false;
+	static u64  s_offlineFrame = 0;
+	static f64  s_offlineFramesToUpdate = 0.0;
 
 	static MemoryRegion* s_memRegion = nullptr;
 	static s32 s_iMuseTimeInMicrosec = 0;
@@ -560,6 +565,12 @@ namespace TFE_Jedi
 		return imFail;
 	}
 
+	s32 ImSetVolumePanBatch(const ImSoundId* soundIds, const s32* volumes, const s32* pans, s32 count)
+	{
+		// Sound effects are always digital, so only the wave sounds need to be searched.
+		return ImSetWaveVolumePan(soundIds, volumes, pans, count);
+	}
+
 	s32 ImGetParam(ImSoundId soundId, s32 param)
 	{
 		iMuseSoundType type = (iMuseSoundType)ImGetSoundType(soundId);
@@ -652,6 +663,7 @@ namespace TFE_Jedi
 		const s32 dtInMicrosec = ImGetDeltaTime();
 
 		// Update Midi and Audio
+		ImUpdateWaveEvents();
 		ImUpdateMidi();
 		if (s_imPause)
 		{
@@ -2490,10 +2502,73 @@ namespace TFE_Jedi
 		}
 
 		// In the original code, the interrupt is setup here, TFE uses a thread to simulate this.
-		const f64 timeStep = TFE_System::microsecondsToSeconds((f64)s_iMuseTimestepMicrosec) / TFE_System::c_gameTimeScale;
-		TFE_MidiPlayer::midiSetCallback(ImUpdate, timeStep);
+		TFE_MidiPlayer::midiSetCallback(ImUpdate, ImGetTimestep());
 		TFE_MidiPlayer::setMaximumNoteLength(8.0f);
 
 		return imSuccess;
 	}
+
+	f64 ImGetTimestep()
+	{
+		return TFE_System::microsecondsToSeconds((f64)s_iMuseTimestepMicrosec) / TFE_System::c_gameTimeScale;
+	}
+
+	////////////////////////////////////////////////////
+	// TFE: Offline rendering
+	////////////////////////////////////////////////////
+	#define IM_OFFLINE_SAMPLE_RATE 11025
+	#define IM_OFFLINE_MAX_BLOCK 256	// ImUpdateWave() output buffer limit.
+
+	s32 ImBeginOfflineRender()
+	{
+		if (s_offlineRender) { return imFail; }
+
+		// Stop the threads from driving iMuse, after this the caller owns the iMuse clock.
+		TFE_MidiPlayer::midiClearCallback();
+		TFE_Audio::setAudioThreadCallback();
+		s_offlineRender = true;
+		s_offlineFrame = 0;
+		s_offlineFramesToUpdate = 0.0;
+		return imSuccess;
+	}
+
+	// Interleave ImUpdate() calls with wave mixing at the same rate as the midi thread would call it.
+	void ImRenderOffline(f32* buffer, u32 frameCount, f32 volume)
+	{
+		if (!s_offlineRender) { return; }
+
+		const f64 framesPerUpdate = ImGetTimestep() * IM_OFFLINE_SAMPLE_RATE;
+		while (frameCount)
+		{
+			if (s_offlineFramesToUpdate <= 0.0)
+			{
+				ImUpdate();
+				s_offlineFramesToUpdate += framesPerUpdate;
+			}
+
+			const u32 framesToUpdate = u32(ceil(s_offlineFramesToUpdate));
+			u32 count = frameCount < IM_OFFLINE_MAX_BLOCK ? frameCount : IM_OFFLINE_MAX_BLOCK;
+			count = count < framesToUpdate ? count : framesToUpdate;
+			ImUpdateWave(buffer, count, volume);
+
+			buffer += count * 2;
+			frameCount -= count;
+			s_offlineFrame += count;
+			s_offlineFramesToUpdate -= f64(count);
+		}
+	}
+
+	u64 ImGetOfflineRenderFrame()
+	{
+		return s_offlineFrame;
+	}
+
+	void ImEndOfflineRender()
+	{
+		if (!s_offlineRender) { return; }
+
+		s_offlineRender = false;
+		TFE_Audio::setAudioThreadCallback(ImUpdateWave);
+		TFE_MidiPlayer::midiSetCallback(ImUpdate, ImGetTimestep());
+	}
 }
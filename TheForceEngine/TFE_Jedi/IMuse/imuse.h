@@ -131,6 +131,17 @@ namespace TFE_Jedi
 	// TFE
 	////////////////////////////////////////////////////
 	s32 ImSetDigitalChannelCount(s32 count);
+	// Set the volume and pan (0 - 127, negative values are left unchanged) of several digital sounds in one call.
+	s32 ImSetVolumePanBatch(const ImSoundId* soundIds, const s32* volumes, const s32* pans, s32 count);
+
+	// Offline rendering: detach iMuse from the audio and midi threads and step it
+	// directly, as fast as the caller wants. Output is interleaved stereo at 11025 Hz.
+	// Midi messages go to the capture function set with TFE_MidiPlayer::setMessageCapture().
+	s32 ImBeginOfflineRender();
+	void ImRenderOffline(f32* buffer, u32 frameCount, f32 volume);
+	// Number of frames rendered since ImBeginOfflineRender().
+	u64 ImGetOfflineRenderFrame();
+	void ImEndOfflineRender();
 
 	////////////////////////////////////////////////////
 	// Low level functions
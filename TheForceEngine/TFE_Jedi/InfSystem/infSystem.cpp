@@ -4,18 +4,22 @@
 #include "message.h"
 #include <TFE_Game/igame.h>
 #include <TFE_Asset/dfKeywords.h>
+#include <TFE_Archive/archive.h>
 #include <TFE_FileSystem/filestream.h>
 #include <TFE_FileSystem/paths.h>
+#include <TFE_FrontEndUI/console.h>
 #include <TFE_DarkForces/hud.h>
 #include <TFE_DarkForces/agent.h>
 #include <TFE_DarkForces/sound.h>
 #include <TFE_FileSystem/paths.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Level/level.h>
+#include <TFE_Memory/snapshot.h>
 #include <TFE_System/parser.h>
 #include <TFE_System/system.h>
 #include <TFE_System/memoryPool.h>
 #include <TFE_System/math.h>
+#include <TFE_System/profiler.h>
 #include <TFE_Jedi/Level/rtexture.h>
 #include <TFE_Jedi/Task/task.h>
 // TODO: This will make adding Outlaws harder, fix the abstraction.
@@ -24,6 +28,7 @@
 #include "infTypesInternal.h"
 // Include update functions
 #include "infElevatorUpdateFunc.h"
+#include <algorithm>
 
 using namespace TFE_Jedi;
 using namespace TFE_DarkForces;
@@ -68,12 +73,202 @@ namespace TFE_Jedi
 	static char s_infArg4[256];
 	static char s_infArgExtra[256];
 	static Stop* s_nextStop;
+
+	// Elevator scheduling.
+	// Instead of checking every elevator each frame, moving elevators are kept in an active list and elevators waiting
+	// on a timed delay in a queue ordered by tick. Each frame the elevators that are due are updated in allocation order,
+	// as the original list walk did. Holding (DELAY_SLEEP) and master off elevators are not queued until a message
+	// changes them.
+	struct ElevScheduleEntry
+	{
+		Tick tick;
+		u32 serial;
+		u32 stamp;
+		InfElevator* elev;
+	};
+
+	struct ElevSchedule
+	{
+		std::vector<ElevScheduleEntry> waiting;	// min-heap ordered by tick.
+		std::vector<ElevScheduleEntry> active;	// elevators that will be due on the next tick, ordered by serial.
+		std::vector<ElevScheduleEntry> due;		// elevators to update this frame, ordered by serial.
+		std::vector<ElevScheduleEntry> late;	// min-heap ordered by serial, elevators that became due during the update.
+		std::vector<ElevScheduleEntry> woken;
+		size_t dueIndex = 0;
+		size_t compactSize = 0;		// size of the waiting queue after the last compaction.
+		u32 stamp = 0;
+		u32 passSerial = 0;			// serial of the elevator being updated.
+		JBool activeSorted = JTRUE;
+		JBool inPass = JFALSE;
+		JBool dirty = JFALSE;		// rebuild from the elevator list before the next update.
+	};
+	static ElevSchedule s_elevSchedule;
+	static u32 s_elevSerial = 0;
+	static s32 s_elevUpdateCount = 0;
+	static std::vector<Teleport*> s_activeTeleports;
+
+	bool elevSchedule_laterTick(const ElevScheduleEntry& a, const ElevScheduleEntry& b)
+	{
+		return a.tick > b.tick;
+	}
+
+	bool elevSchedule_laterSerial(const ElevScheduleEntry& a, const ElevScheduleEntry& b)
+	{
+		return a.serial > b.serial;
+	}
+
+	bool elevSchedule_earlierSerial(const ElevScheduleEntry& a, const ElevScheduleEntry& b)
+	{
+		return a.serial < b.serial;
+	}
+
+	JBool elevSchedule_isValid(const ElevScheduleEntry& entry)
+	{
+		return (entry.elev && entry.stamp == entry.elev->schedStamp) ? JTRUE : JFALSE;
+	}
+
+	void elevSchedule_clear(ElevSchedule* sched)
+	{
+		sched->waiting.clear();
+		sched->active.clear();
+		sched->due.clear();
+		sched->late.clear();
+		sched->dueIndex = 0;
+		sched->compactSize = 0;
+		sched->activeSorted = JTRUE;
+		sched->inPass = JFALSE;
+		sched->dirty = JFALSE;
+	}
+
+	// Queue the elevator based on its current state, this must be called whenever 'nextTick' or ELEV_MASTER_ON changes.
+	void elevSchedule_add(ElevSchedule* sched, InfElevator* elev, Tick curTick)
+	{
+		// Any previous entry is no longer valid.
+		sched->stamp++;
+		elev->schedStamp = sched->stamp;
+		if (!(elev->updateFlags & ELEV_MASTER_ON) || elev->nextTick == DELAY_SLEEP)
+		{
+			return;
+		}
+
+		ElevScheduleEntry entry = { elev->nextTick, elev->serial, sched->stamp, elev };
+		if (sched->inPass && elev->serial > sched->passSerial && elev->nextTick < curTick)
+		{
+			// The list walk has not reached this elevator yet, so it is updated this frame.
+			sched->late.push_back(entry);
+			std::push_heap(sched->late.begin(), sched->late.end(), elevSchedule_laterSerial);
+		}
+		else if (elev->nextTick <= curTick)
+		{
+			if (!sched->active.empty() && sched->active.back().serial > entry.serial)
+			{
+				sched->activeSorted = JFALSE;
+			}
+			sched->active.push_back(entry);
+		}
+		else
+		{
+			sched->waiting.push_back(entry);
+			std::push_heap(sched->waiting.begin(), sched->waiting.end(), elevSchedule_laterTick);
+		}
+	}
+
+	// The elevator is about to be freed. Entries for this update are cleared and the rest are dropped by rebuilding the schedule.
+	void elevSchedule_remove(ElevSchedule* sched, InfElevator* elev)
+	{
+		for (size_t i = sched->dueIndex; i < sched->due.size(); i++)
+		{
+			if (sched->due[i].elev == elev) { sched->due[i].elev = nullptr; }
+		}
+		for (size_t i = 0; i < sched->late.size(); i++)
+		{
+			if (sched->late[i].elev == elev) { sched->late[i].elev = nullptr; }
+		}
+		elev->schedStamp = 0;
+		sched->dirty = JTRUE;
+	}
+
+	// Gather the active elevators and the elevators whose delay has passed.
+	void elevSchedule_beginPass(ElevSchedule* sched, Tick curTick)
+	{
+		// Drop stale entries once they make up most of the waiting queue.
+		if (sched->waiting.size() > 2 * sched->compactSize + 256)
+		{
+			sched->waiting.erase(std::remove_if(sched->waiting.begin(), sched->waiting.end(),
+				[](const ElevScheduleEntry& entry) { return !elevSchedule_isValid(entry); }), sched->waiting.end());
+			std::make_heap(sched->waiting.begin(), sched->waiting.end(), elevSchedule_laterTick);
+			sched->compactSize = sched->waiting.size();
+		}
+
+		sched->woken.clear();
+		while (!sched->waiting.empty() && sched->waiting.front().tick < curTick)
+		{
+			std::pop_heap(sched->waiting.begin(), sched->waiting.end(), elevSchedule_laterTick);
+			if (elevSchedule_isValid(sched->waiting.back()))
+			{
+				sched->woken.push_back(sched->waiting.back());
+			}
+			sched->waiting.pop_back();
+		}
+		std::sort(sched->woken.begin(), sched->woken.end(), elevSchedule_earlierSerial);
+		if (!sched->activeSorted)
+		{
+			std::sort(sched->active.begin(), sched->active.end(), elevSchedule_earlierSerial);
+			sched->activeSorted = JTRUE;
+		}
+
+		sched->due.resize(sched->active.size() + sched->woken.size());
+		std::merge(sched->active.begin(), sched->active.end(), sched->woken.begin(), sched->woken.end(), sched->due.begin(), elevSchedule_earlierSerial);
+		sched->active.clear();
+		sched->late.clear();
+		sched->dueIndex = 0;
+		sched->passSerial = 0;
+		sched->inPass = JTRUE;
+	}
+
+	// Returns the next elevator to update this frame or null when the pass is complete.
+	// Active elevators are returned even if the tick has not changed, so the caller checks 'nextTick' as before.
+	InfElevator* elevSchedule_next(ElevSchedule* sched)
+	{
+		while (sched->dueIndex < sched->due.size() && !elevSchedule_isValid(sched->due[sched->dueIndex]))
+		{
+			sched->dueIndex++;
+		}
+		while (!sched->late.empty() && !elevSchedule_isValid(sched->late.front()))
+		{
+			std::pop_heap(sched->late.begin(), sched->late.end(), elevSchedule_laterSerial);
+			sched->late.pop_back();
+		}
+
+		ElevScheduleEntry entry;
+		if (!sched->late.empty() && (sched->dueIndex >= sched->due.size() || sched->late.front().serial < sched->due[sched->dueIndex].serial))
+		{
+			std::pop_heap(sched->late.begin(), sched->late.end(), elevSchedule_laterSerial);
+			entry = sched->late.back();
+			sched->late.pop_back();
+		}
+		else if (sched->dueIndex < sched->due.size())
+		{
+			entry = sched->due[sched->dueIndex++];
+		}
+		else
+		{
+			sched->inPass = JFALSE;
+			return nullptr;
+		}
+
+		sched->passSerial = entry.serial;
+		return entry.elev;
+	}
 		
 	void inf_elevatorTaskFunc(MessageType msg);
 	void inf_telelporterTaskFunc(MessageType msg);
 	void inf_triggerTaskFunc(MessageType msg);
 
 	void infElevatorMsgFunc(MessageType msgType);
+	void inf_elevatorMessage(MessageType msgType);
+	void inf_scheduleElevator(InfElevator* elev);
+	void inf_beginElevatorUpdate();
 	void infTriggerMsgFunc(MessageType msgType);
 	void inf_handleTriggerMsg(InfTrigger* trigger);
 	
@@ -101,8 +296,14 @@ namespace TFE_Jedi
 	/////////////////////////////////////////////////////
 	// API
 	/////////////////////////////////////////////////////
+	void console_infParseBenchmark(const ConsoleArgList& args);
+	void console_infScheduleBenchmark(const ConsoleArgList& args);
+
 	bool inf_init()
 	{
+		CCMD("infParseBenchmark", console_infParseBenchmark, 0, "Time tokenizing every INF file in DARK.GOB and looking up each token as a keyword, comparing the allocating token list and linear keyword search with token views and the keyword hash. Optional argument: iteration count (default 10).");
+		CCMD("infScheduleBenchmark", console_infScheduleBenchmark, 0, "Simulate elevators to compare walking every elevator each frame against the elevator schedule. Optional arguments: elevator count (default 5000), moving elevator count (default 20), frame count (default 2000).");
+		TFE_COUNTER(s_elevUpdateCount, "INF Elevators Updated");
 		return false;
 	}
 
@@ -132,10 +333,14 @@ namespace TFE_Jedi
 		s_infTriggerTask = nullptr;
 		s_nextStop       = nullptr;
 		s_triggerCount   = 0;
+		elevSchedule_clear(&s_elevSchedule);
+		s_activeTeleports.clear();
 	}
 
 	void inf_createElevatorTask()
 	{
+		elevSchedule_clear(&s_elevSchedule);
+		s_elevSerial = 0;
 		s_infElevators = allocator_create(sizeof(InfElevator));
 		s_infElevTask = createSubTask("elevator", inf_elevatorTaskFunc, inf_elevatorTaskLocal);
 	}
@@ -145,6 +350,7 @@ namespace TFE_Jedi
 		s_teleportTask = createSubTask("teleporter", inf_telelporterTaskFunc, inf_teleporterTaskLocal);
 		task_setNextTick(s_teleportTask, TASK_SLEEP);
 		s_infTeleports = allocator_create(sizeof(Teleport));
+		s_activeTeleports.clear();
 	}
 
 	void inf_createTriggerTask()
@@ -153,6 +359,33 @@ namespace TFE_Jedi
 		s_triggerCount = 0;
 	}
 
+	// The elevators and teleports are restored with the level memory, but the schedule and active list still refer to
+	// the state before the restore.
+	void inf_restoreSnapshot()
+	{
+		elevSchedule_clear(&s_elevSchedule);
+		s_elevSchedule.dirty = JTRUE;
+
+		s_activeTeleports.clear();
+		Teleport* teleport = (Teleport*)allocator_getHead(s_infTeleports);
+		while (teleport)
+		{
+			if (teleport->active)
+			{
+				s_activeTeleports.push_back(teleport);
+			}
+			teleport = (Teleport*)allocator_getNext(s_infTeleports);
+		}
+	}
+
+	void inf_registerSnapshot()
+	{
+		SNAPSHOT_GLOBAL(s_triggerCount);
+		SNAPSHOT_GLOBAL(s_nextStop);
+		SNAPSHOT_GLOBAL(s_elevSerial);
+		TFE_Memory::snapshot_registerRestoreCallback(inf_restoreSnapshot);
+	}
+
 	InfLink* allocateLink(Allocator* infLinks, InfElevator* elev)
 	{
 		InfLink* link = (InfLink*)allocator_newItem(infLinks);
@@ -270,6 +503,10 @@ namespace TFE_Jedi
 		elev->self = elev;
 		elev->sector = sector;
 		elev->updateFlags = ELEV_MASTER_ON;
+		elev->serial = ++s_elevSerial;
+		elev->schedStamp = 0;
+		// Elevators are setup after allocation, so the schedule is built on the next update.
+		s_elevSchedule.dirty = JTRUE;
 		elev->sound0 = NULL_SOUND;
 		elev->sound1 = NULL_SOUND;
 		elev->sound2 = NULL_SOUND;
@@ -715,6 +952,7 @@ namespace TFE_Jedi
 		teleport->sector = sector;
 		teleport->type = type;
 		teleport->target = nullptr;
+		teleport->active = JFALSE;
 
 		if (!sector->infLink)
 		{
@@ -1462,7 +1700,29 @@ namespace TFE_Jedi
 		}
 	}
 			
-	// Per frame update.
+	void inf_scheduleElevator(InfElevator* elev)
+	{
+		elevSchedule_add(&s_elevSchedule, elev, s_curTick);
+	}
+
+	void inf_beginElevatorUpdate()
+	{
+		s_elevUpdateCount = 0;
+		if (s_elevSchedule.dirty)
+		{
+			// Elevators were added or removed, queue all of them again.
+			elevSchedule_clear(&s_elevSchedule);
+			InfElevator* elev = (InfElevator*)allocator_getHead(s_infElevators);
+			while (elev)
+			{
+				elevSchedule_add(&s_elevSchedule, elev, s_curTick);
+				elev = (InfElevator*)allocator_getNext(s_infElevators);
+			}
+		}
+		elevSchedule_beginPass(&s_elevSchedule, s_curTick);
+	}
+
+	// Per frame update, only elevators that are due are visited (see ElevSchedule).
 	void inf_elevatorTaskFunc(MessageType msg)
 	{
 		struct LocalContext
@@ -1482,9 +1742,11 @@ namespace TFE_Jedi
 			}
 			else  // id == MSG_RUN_TASK
 			{
-				taskCtx->elev = (InfElevator*)allocator_getHead(s_infElevators);
+				inf_beginElevatorUpdate();
+				taskCtx->elev = elevSchedule_next(&s_elevSchedule);
 				while (taskCtx->elev)
 				{
+					s_elevUpdateCount++;
 					taskCtx->elevDeleted = 0;
 					if ((taskCtx->elev->updateFlags & ELEV_MASTER_ON) && taskCtx->elev->nextTick < s_curTick)
 					{
@@ -1572,8 +1834,13 @@ namespace TFE_Jedi
 						}
 					} // ((elev->updateFlags & ELEV_MASTER_ON) && elev->nextTick < s_curTick)
 
+					// Queue the elevator again based on its new state.
+					if (!taskCtx->elevDeleted)
+					{
+						inf_scheduleElevator(taskCtx->elev);
+					}
 					// Next elevator.
-					taskCtx->elev = (InfElevator*)allocator_getNext(s_infElevators);
+					taskCtx->elev = elevSchedule_next(&s_elevSchedule);
 				} // while (elev)
 			}  // id == 0 (main elevator update loop)
 			task_yield(TASK_NO_DELAY);
@@ -1582,10 +1849,51 @@ namespace TFE_Jedi
 		task_end;
 	}
 		
+	void inf_activateTeleport(Teleport* teleport)
+	{
+		if (!teleport->active)
+		{
+			teleport->active = JTRUE;
+			s_activeTeleports.push_back(teleport);
+		}
+	}
+
+	// Teleports in the target sector need to run as well, in case the object is sent on again.
+	void inf_activateSectorTeleports(RSector* sector)
+	{
+		if (!sector || !sector->infLink) { return; }
+		InfLink* link = (InfLink*)allocator_getHead(sector->infLink);
+		while (link)
+		{
+			if (link->type == LTYPE_TELEPORT)
+			{
+				inf_activateTeleport(link->teleport);
+			}
+			link = (InfLink*)allocator_getNext(sector->infLink);
+		}
+	}
+
+	// The original task checked every teleport when woken, so objects that were already in a teleport sector
+	// without entering it (placed or spawned there) were sent on as well.
+	void inf_activateOccupiedTeleports()
+	{
+		Teleport* teleport = (Teleport*)allocator_getHead(s_infTeleports);
+		while (teleport)
+		{
+			if (teleport->sector->objectCount)
+			{
+				inf_activateTeleport(teleport);
+			}
+			teleport = (Teleport*)allocator_getNext(s_infTeleports);
+		}
+	}
+
 	void inf_teleporterTaskLocal(MessageType msg)
 	{
 		if (msg == MSG_TRIGGER && s_msgEvent == INF_EVENT_ENTER_SECTOR)
 		{
+			inf_activateTeleport((Teleport*)s_msgTarget);
+			inf_activateOccupiedTeleports();
 			task_makeActive(s_teleportTask);
 		}
 		else
@@ -1613,9 +1921,10 @@ namespace TFE_Jedi
 			}
 			else
 			{
-				Teleport* teleport = (Teleport*)allocator_getHead(s_infTeleports);
-				while (teleport)
+				// Only teleports that have been entered are checked, they stay active while objects remain in their sector.
+				for (size_t t = 0; t < s_activeTeleports.size();)
 				{
+					Teleport* teleport = s_activeTeleports[t];
 					RSector* sector = teleport->sector;
 					s32 objCount = sector->objectCount;
 					SecObject** objList = sector->objectList;
@@ -1636,6 +1945,7 @@ namespace TFE_Jedi
 								obj->yaw   = teleport->dstAngle[1];
 								obj->roll  = teleport->dstAngle[2];
 								sector_addObject(teleport->target, obj);
+								inf_activateSectorTeleports(teleport->target);
 							}
 							else if (type == TELEPORT_CHUTE)
 							{
@@ -1645,6 +1955,7 @@ namespace TFE_Jedi
 								if (floorThreshold < obj->posWS.y)
 								{
 									sector_addObject(teleport->target, obj);
+									inf_activateSectorTeleports(teleport->target);
 								}
 							}
 
@@ -1654,8 +1965,17 @@ namespace TFE_Jedi
 							}
 						}  // if (obj)
 					}  // for (s32 i = 0; i < objCount; objList++)
-					teleport = (Teleport*)allocator_getNext(s_infTeleports);
-				}  // while (teleport)
+
+					if (objCount)
+					{
+						t++;
+					}
+					else
+					{
+						teleport->active = JFALSE;
+						s_activeTeleports.erase(s_activeTeleports.begin() + t);
+					}
+				}  // for (t < s_activeTeleports.size())
 			}
 
 			task_yield(taskCtx->delay);
@@ -2750,6 +3070,14 @@ namespace TFE_Jedi
 		}
 	}
 
+	// The message may start, stop or delay the elevator, so queue it again afterward.
+	void inf_elevatorMessage(MessageType msgType)
+	{
+		InfElevator* elev = (InfElevator*)s_msgTarget;
+		infElevatorMessageInternal(msgType);
+		inf_scheduleElevator(elev);
+	}
+
 	void infElevatorMsgFunc(MessageType msgType)
 	{
 		if (msgType == MSG_FREE)
@@ -2757,7 +3085,7 @@ namespace TFE_Jedi
 			deleteElevator((InfElevator*)s_msgTarget);
 			return;
 		}
-		infElevatorMessageInternal(msgType);
+		inf_elevatorMessage(msgType);
 	}
 		
 	void infTriggerMsgFunc(MessageType msgType)
@@ -2918,6 +3246,7 @@ namespace TFE_Jedi
 			allocator_free(elev->stops);
 		}
 		inf_deleteSectorElevatorLink(elev->sector, elev);
+		elevSchedule_remove(&s_elevSchedule, elev);
 		allocator_deleteItem(s_infElevators, elev);
 	}
 		
@@ -3128,7 +3457,7 @@ namespace TFE_Jedi
 
 							if (msg != MSG_RUN_TASK)
 							{
-								infElevatorMessageInternal(msg);
+								inf_elevatorMessage(msg);
 								task_yield(TASK_NO_DELAY);
 							}
 
@@ -3624,4 +3953,292 @@ namespace TFE_Jedi
 		}
 		return JFALSE;
 	}
+
+	/////////////////////////////////////////////////////
+	// Parse benchmark
+	/////////////////////////////////////////////////////
+	enum
+	{
+		INF_PARSE_BENCH_DEFAULT_ITERATIONS = 10,
+	};
+
+	struct InfParseBenchResult
+	{
+		f64 time;
+		u32 lines;
+		u32 tokens;
+		u32 keywordHash;
+	};
+
+	InfParseBenchResult inf_runParseBenchmark(const std::vector<std::vector<char>>& files, s32 iterations, JBool legacy)
+	{
+		InfParseBenchResult result = {};
+		TokenList tokenList;
+		TokenViewList tokenViews;
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		for (s32 i = 0; i < iterations; i++)
+		{
+			const size_t fileCount = files.size();
+			for (size_t f = 0; f < fileCount; f++)
+			{
+				TFE_Parser parser;
+				parser.init(files[f].data(), files[f].size());
+				parser.addCommentString("//");
+				parser.addCommentString("#");
+				parser.enableBlockComments();
+
+				size_t bufferPos = 0;
+				while (const char* line = parser.readLine(bufferPos))
+				{
+					result.lines++;
+					if (legacy)
+					{
+						parser.tokenizeLine(line, tokenList);
+						const size_t count = tokenList.size();
+						for (size_t t = 0; t < count; t++)
+						{
+							result.keywordHash = result.keywordHash * 31 + u32(getKeywordIndexLinear(tokenList[t].c_str()) + 1);
+						}
+						result.tokens += u32(count);
+					}
+					else
+					{
+						parser.tokenizeLine(line, tokenViews);
+						const size_t count = tokenViews.size();
+						for (size_t t = 0; t < count; t++)
+						{
+							result.keywordHash = result.keywordHash * 31 + u32(getKeywordIndex(tokenViews[t].c_str()) + 1);
+						}
+						result.tokens += u32(count);
+					}
+				}
+			}
+		}
+		result.time = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+		return result;
+	}
+
+	void console_infParseBenchmark(const ConsoleArgList& args)
+	{
+		s32 iterations = INF_PARSE_BENCH_DEFAULT_ITERATIONS;
+		if (args.size() >= 2)
+		{
+			iterations = max(1, atoi(args[1].c_str()));
+		}
+
+		char gobPath[TFE_MAX_PATH];
+		TFE_Paths::appendPath(PATH_SOURCE_DATA, "DARK.GOB", gobPath);
+		Archive* archive = Archive::getArchive(ARCHIVE_GOB, "DARK.GOB", gobPath);
+		if (!archive)
+		{
+			TFE_Console::addToHistory("Cannot open DARK.GOB.");
+			return;
+		}
+
+		// Read every INF file up front so only parsing is timed.
+		std::vector<std::vector<char>> files;
+		size_t totalSize = 0;
+		const u32 fileCount = archive->getFileCount();
+		for (u32 i = 0; i < fileCount; i++)
+		{
+			const char* name = archive->getFileName(i);
+			const size_t nameLen = strlen(name);
+			if (nameLen < 4 || strcasecmp(name + nameLen - 4, ".INF") != 0 || !archive->openFile(i))
+			{
+				continue;
+			}
+
+			std::vector<char> buffer(archive->getFileLength());
+			archive->readFile(buffer.data(), buffer.size());
+			archive->closeFile();
+			totalSize += buffer.size();
+			files.push_back(std::move(buffer));
+		}
+		if (files.empty())
+		{
+			TFE_Console::addToHistory("No INF files found in DARK.GOB.");
+			return;
+		}
+
+		const InfParseBenchResult legacy = inf_runParseBenchmark(files, iterations, JTRUE);
+		const InfParseBenchResult views = inf_runParseBenchmark(files, iterations, JFALSE);
+
+		char msg[256];
+		sprintf(msg, "INF parse benchmark: %u files, %u KB, %u lines, %u tokens per iteration, %d iterations.",
+			(u32)files.size(), u32(totalSize / 1024), legacy.lines / iterations, legacy.tokens / iterations, iterations);
+		TFE_Console::addToHistory(msg);
+		sprintf(msg, "  Token list + linear search: %0.3f ms/iteration, Token views + keyword hash: %0.3f ms/iteration (%0.2fx).",
+			legacy.time * 1000.0 / iterations, views.time * 1000.0 / iterations, views.time > 0.0 ? legacy.time / views.time : 0.0);
+		TFE_Console::addToHistory(msg);
+		if (legacy.tokens != views.tokens || legacy.keywordHash != views.keywordHash)
+		{
+			TFE_Console::addToHistory("  Tokens or keywords MISMATCH between the two parsers.");
+			TFE_System::logWrite(LOG_ERROR, "INF", "Parse benchmark: token views or keyword hash do not match the token list and linear search.");
+		}
+		else
+		{
+			TFE_Console::addToHistory("  Tokens and keywords match.");
+		}
+	}
+
+	/////////////////////////////////////////////////////
+	// Schedule benchmark
+	/////////////////////////////////////////////////////
+	enum
+	{
+		INF_SCHED_BENCH_DEFAULT_ELEVATORS = 5000,
+		INF_SCHED_BENCH_DEFAULT_MOVING    = 20,
+		INF_SCHED_BENCH_DEFAULT_FRAMES    = 2000,
+		INF_SCHED_BENCH_TRIGGERS          = 2,		// Elevators triggered per frame.
+	};
+
+	struct InfScheduleBenchResult
+	{
+		f64 time;
+		u32 updates;
+		u32 updateHash;
+	};
+
+	// Stand-in for the elevator update: elevators move for a number of frames and then either hold until triggered again,
+	// wait for a timed delay or, for the first 'moving' elevators, keep moving.
+	void inf_scheduleBenchUpdate(InfElevator* elev, s32 moving, Tick tick, u32* rng)
+	{
+		if (elev->serial <= u32(moving)) { return; }
+		if (--elev->iValue > 0) { return; }
+
+		*rng = (*rng) * 1103515245u + 12345u;
+		if (elev->serial % 16 == 0)
+		{
+			elev->nextTick = tick + 50 + ((*rng) >> 16) % 500;
+			elev->iValue = 30;
+		}
+		else
+		{
+			elev->nextTick = DELAY_SLEEP;
+		}
+	}
+
+	InfScheduleBenchResult inf_runScheduleBenchmark(Allocator* elevators, s32 moving, s32 frames, JBool useSchedule)
+	{
+		// Setup the same initial state for both runs.
+		std::vector<InfElevator*> elevList;
+		u32 rng = 1;
+		InfElevator* elev = (InfElevator*)allocator_getHead(elevators);
+		while (elev)
+		{
+			rng = rng * 1103515245u + 12345u;
+			elev->serial = u32(elevList.size() + 1);
+			elev->schedStamp = 0;
+			elev->updateFlags = ELEV_MASTER_ON;
+			elev->iValue = 30;
+			elev->nextTick = (elev->serial <= u32(moving)) ? 0 : (elev->serial % 16 == 0) ? Tick(1 + (rng >> 16) % 500) : DELAY_SLEEP;
+			elevList.push_back(elev);
+			elev = (InfElevator*)allocator_getNext(elevators);
+		}
+		const u32 count = u32(elevList.size());
+
+		ElevSchedule sched;
+		if (useSchedule)
+		{
+			for (u32 i = 0; i < count; i++)
+			{
+				elevSchedule_add(&sched, elevList[i], 0);
+			}
+		}
+
+		InfScheduleBenchResult result = {};
+		u32 triggerRng = 7;
+		u32 updateRng = 3;
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		for (s32 f = 0; f < frames; f++)
+		{
+			// Like the game, the tick does not advance every frame.
+			const Tick tick = Tick(1 + f / 2);
+
+			// Messages from triggers start elevators, as inf_startElevator() does.
+			for (s32 t = 0; t < INF_SCHED_BENCH_TRIGGERS; t++)
+			{
+				triggerRng = triggerRng * 1103515245u + 12345u;
+				elev = elevList[(triggerRng >> 8) % count];
+				elev->nextTick = tick;
+				elev->iValue = 30;
+				if (useSchedule) { elevSchedule_add(&sched, elev, tick); }
+			}
+
+			if (useSchedule)
+			{
+				elevSchedule_beginPass(&sched, tick);
+				elev = elevSchedule_next(&sched);
+			}
+			else
+			{
+				elev = (InfElevator*)allocator_getHead(elevators);
+			}
+
+			while (elev)
+			{
+				if ((elev->updateFlags & ELEV_MASTER_ON) && elev->nextTick < tick)
+				{
+					inf_scheduleBenchUpdate(elev, moving, tick, &updateRng);
+					result.updates++;
+					result.updateHash = result.updateHash * 31 + elev->serial;
+				}
+
+				if (useSchedule)
+				{
+					elevSchedule_add(&sched, elev, tick);
+					elev = elevSchedule_next(&sched);
+				}
+				else
+				{
+					elev = (InfElevator*)allocator_getNext(elevators);
+				}
+			}
+		}
+		result.time = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+		return result;
+	}
+
+	void console_infScheduleBenchmark(const ConsoleArgList& args)
+	{
+		s32 count = INF_SCHED_BENCH_DEFAULT_ELEVATORS;
+		s32 moving = INF_SCHED_BENCH_DEFAULT_MOVING;
+		s32 frames = INF_SCHED_BENCH_DEFAULT_FRAMES;
+		if (args.size() >= 2) { count = max(1, atoi(args[1].c_str())); }
+		if (args.size() >= 3) { moving = clamp(atoi(args[2].c_str()), 0, count); }
+		if (args.size() >= 4) { frames = max(1, atoi(args[3].c_str())); }
+
+		// The elevators are allocated in their own region, interleaved with stops like a loaded level.
+		// Only the scheduling fields are used, so they are not part of the level.
+		MemoryRegion* region = TFE_Memory::region_create("InfScheduleBench", 8 * 1024 * 1024);
+		Allocator* elevators = allocator_create(sizeof(InfElevator), region);
+		Allocator* stops = allocator_create(sizeof(Stop), region);
+		for (s32 i = 0; i < count; i++)
+		{
+			memset(allocator_newItem(elevators), 0, sizeof(InfElevator));
+			allocator_newItem(stops);
+			allocator_newItem(stops);
+		}
+		const InfScheduleBenchResult walk = inf_runScheduleBenchmark(elevators, moving, frames, JFALSE);
+		const InfScheduleBenchResult sched = inf_runScheduleBenchmark(elevators, moving, frames, JTRUE);
+		TFE_Memory::region_destroy(region);
+
+		char msg[256];
+		sprintf(msg, "INF schedule benchmark: %d elevators, %d always moving, %d frames, %0.1f elevator updates per frame.",
+			count, moving, frames, f64(walk.updates) / f64(frames));
+		TFE_Console::addToHistory(msg);
+		sprintf(msg, "  List walk: %0.4f ms/frame, Schedule: %0.4f ms/frame (%0.2fx).",
+			walk.time * 1000.0 / frames, sched.time * 1000.0 / frames, sched.time > 0.0 ? walk.time / sched.time : 0.0);
+		TFE_Console::addToHistory(msg);
+		if (walk.updates != sched.updates || walk.updateHash != sched.updateHash)
+		{
+			TFE_Console::addToHistory("  Elevator updates MISMATCH between the list walk and the schedule.");
+			TFE_System::logWrite(LOG_ERROR, "INF", "Schedule benchmark: the schedule does not update the same elevators in the same order as the list walk.");
+		}
+		else
+		{
+			TFE_Console::addToHistory("  Elevator updates match.");
+		}
+	}
 }
@@ -34,6 +34,8 @@ namespace TFE_Jedi
 	void inf_createElevatorTask();
 	void inf_createTeleportTask();
 	void inf_createTriggerTask();
+	// Register the INF state that is not in region memory, and rebuild the elevator schedule and active teleports on restore.
+	void inf_registerSnapshot();
 	
 	// ** Runtime API **
 	// Messages are the way entities and the player interact with the INF system during gameplay.
@@ -89,6 +89,8 @@ namespace TFE_Jedi
 
 		vec3_fixed dstPosition;
 		angle14_16  dstAngle[3];
+		// TFE
+		JBool active;			// JTRUE while in the active teleport list.
 	};
 
 	struct TriggerTarget
@@ -189,5 +191,7 @@ namespace TFE_Jedi
 		s32 updateFlags;
 		// TFE
 		fixed16_16 prevValue;
+		u32 serial;				// Allocation order, due elevators are updated in this order.
+		u32 schedStamp;			// Stamp of the valid schedule entry, older entries are ignored.
 	};
 }
\ No newline at end of file
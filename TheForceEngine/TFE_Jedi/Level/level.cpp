@@ -4,6 +4,8 @@
 #include "level.h"
 #include "rwall.h"
 #include "rtexture.h"
+#include "rsectorGrid.h"
+#include "levelCache.h"
 #include <TFE_Game/igame.h>
 #include <TFE_Asset/assetSystem.h>
 #include <TFE_Asset/dfKeywords.h>
@@ -42,6 +44,11 @@ namespace TFE_Jedi
 		vec3_fixed pos;
 	};
 
+	struct LevelAssetName
+	{
+		char name[32];
+	};
+
 	static s32 s_dataIndex;
 	static s32 s_textureCount;
 
@@ -67,6 +74,13 @@ namespace TFE_Jedi
 
 	static char s_readBuffer[256];
 	static std::vector<char> s_buffer;
+
+	// Level geometry as read from the text, before it is built or written to the level cache.
+	static std::vector<s32> s_parsedTextures;
+	static std::vector<LevelCacheSector> s_parsedSectors;
+	static std::vector<LevelCacheWall> s_parsedWalls;
+	static std::vector<vec2_fixed> s_parsedVertices;
+	static std::vector<char> s_parsedStrings;
 	
 	s32 s_minLayer;
 	s32 s_maxLayer;
@@ -82,6 +96,9 @@ namespace TFE_Jedi
 	fixed16_16 s_parallax1;
 
 	JBool level_loadGeometry(const char* levelName);
+	JBool level_parseGeometry(LevelGeometryData* data);
+	JBool level_buildGeometry(const LevelGeometryData* data);
+	s32   level_addParsedString(const char* str);
 	JBool level_loadObjects(const char* levelName, u8 difficulty);
 	JBool level_loadGoals(const char* levelName);
 
@@ -95,6 +112,7 @@ namespace TFE_Jedi
 		s_mohcSector       = nullptr;
 
 		s_sectors  = nullptr;
+		sectorGrid_clear();
 		s_pods     = nullptr;
 		s_sprites  = nullptr;
 		s_frames   = nullptr;
@@ -121,6 +139,10 @@ namespace TFE_Jedi
 	JBool level_load(const char* levelName, u8 difficulty)
 	{
 		if (!levelName) { return JFALSE; }
+		// Pick up loose files added or removed since the last level.
+		TFE_Paths::invalidateFileIndex();
+		levelCache_init();
+		const u64 loadStart = TFE_System::getCurrentTimeInTicks();
 
 		// Clear just in case.
 		for (s32 i = 0; i < NUM_COMPLETE; i++)
@@ -137,6 +159,8 @@ namespace TFE_Jedi
 		inf_load(levelName);
 		level_loadGoals(levelName);
 
+		const f64 loadTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - loadStart);
+		TFE_System::logWrite(LOG_MSG, "Level Load", "Loaded '%s' in %.1f ms.", levelName, loadTime * 1000.0);
 		return JTRUE;
 	}
 		
@@ -169,6 +193,32 @@ namespace TFE_Jedi
 		file.readBuffer(s_buffer.data(), u32(len));
 		file.close();
 
+		// TFE: Use the cached geometry if the source has not changed since it was written.
+		const u64 sourceHash = levelCache_hash((const u8*)s_buffer.data(), len);
+		LevelGeometryData data;
+		if (!levelCache_read(levelName, sourceHash, u32(len), &data))
+		{
+			if (!level_parseGeometry(&data))
+			{
+				return false;
+			}
+			levelCache_write(levelName, sourceHash, u32(len), &data);
+		}
+
+		const JBool result = level_buildGeometry(&data);
+		levelCache_close();
+		return result;
+	}
+
+	// Parse the level text into s_parsed*, only the values are read here - runtime data is created by level_buildGeometry().
+	JBool level_parseGeometry(LevelGeometryData* data)
+	{
+		s_parsedTextures.clear();
+		s_parsedSectors.clear();
+		s_parsedWalls.clear();
+		s_parsedVertices.clear();
+		s_parsedStrings.clear();
+
 		TFE_Parser parser;
 		size_t bufferPos = 0;
 		parser.init(s_buffer.data(), s_buffer.size());
@@ -191,7 +241,7 @@ namespace TFE_Jedi
 			TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Invalid level version %d.%d.", versionMajor, versionMinor);
 			return false;
 		}
-		
+
 		line = parser.readLine(bufferPos);
 		char name[256];
 		if (sscanf(line, "LEVELNAME %s", name) != 1)
@@ -207,7 +257,7 @@ namespace TFE_Jedi
 			TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read palette name.");
 			return false;
 		}
-		
+
 		// Another value that is ignored.
 		line = parser.readLine(bufferPos);
 		if (sscanf(line, "MUSIC %s", s_readBuffer) != 1)
@@ -226,80 +276,48 @@ namespace TFE_Jedi
 			TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read parallax values.");
 			return false;
 		}
-		s_parallax0 = floatToFixed16(parallax0);
-		s_parallax1 = floatToFixed16(parallax1);
+		data->parallax0 = floatToFixed16(parallax0);
+		data->parallax1 = floatToFixed16(parallax1);
 
 		// Number of textures used by the level.
 		line = parser.readLine(bufferPos);
-		if (sscanf(line, " TEXTURES %d", &s_textureCount) != 1)
+		s32 textureCount;
+		if (sscanf(line, " TEXTURES %d", &textureCount) != 1)
 		{
 			TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read texture count.");
 			return false;
 		}
-		s_textures = (TextureData**)res_alloc(s_textureCount * sizeof(TextureData**));
-		memset(s_textures, 0, s_textureCount * sizeof(TextureData**));
 
-		// Load Textures.
-		TextureData** texture = s_textures;
-		for (s32 i = 0; i < s_textureCount; i++, texture++)
+		// Texture names.
+		for (s32 i = 0; i < textureCount; i++)
 		{
 			line = parser.readLine(bufferPos);
 			char textureName[256];
 			if (sscanf(line, " TEXTURE: %s ", textureName) != 1)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read texture name.");
-				TFE_Paths::getFilePath("default.bm", &filePath);
-				*texture = bitmap_load(&filePath, 1);
-			}
-			else if (strcasecmp(textureName, "<NoTexture>") == 0)
-			{
-				*texture = nullptr;
+				s_parsedTextures.push_back(LEVEL_CACHE_NO_NAME);
 			}
 			else
 			{
-				TextureData* tex = nullptr;
-				if (TFE_Paths::getFilePath(textureName, &filePath))
-				{
-					tex = bitmap_load(&filePath, 1);
-				}
-				if (!tex)
-				{
-					TFE_System::logWrite(LOG_WARNING, "level_loadGeometry", "Could not open '%s', using 'default.bm' instead.", textureName);
-
-					TFE_Paths::getFilePath("default.bm", &filePath);
-					tex = bitmap_load(&filePath, 1);
-					if (!tex)
-					{
-						TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "'default.bm' is not a valid BM file!");
-						assert(0);
-						return false;
-					}
-				}
-				*texture = tex;
-
-				// Setup an animated texture.
-				if (tex->uvWidth == BM_ANIMATED_TEXTURE)
-				{
-					bitmap_setupAnimatedTexture(texture);
-				}
+				s_parsedTextures.push_back(level_addParsedString(textureName));
 			}
 		}
 
-		// Load Sectors.
+		// Sectors.
 		line = parser.readLine(bufferPos);
-		if (sscanf(line, "NUMSECTORS %d", &s_sectorCount) != 1)
+		s32 sectorCount;
+		if (sscanf(line, "NUMSECTORS %d", &sectorCount) != 1)
 		{
 			TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read sector count.");
 			return false;
 		}
 
-		s_sectors = (RSector*)level_alloc(sizeof(RSector) * s_sectorCount);
-		memset(s_sectors, 0, sizeof(RSector) * s_sectorCount);
-		for (u32 i = 0; i < s_sectorCount; i++)
+		s_parsedSectors.resize(sectorCount);
+		for (s32 i = 0; i < sectorCount; i++)
 		{
-			RSector* sector = &s_sectors[i];
-			sector_clear(sector);
-			sector->index = i;
+			LevelCacheSector* sector = &s_parsedSectors[i];
+			memset(sector, 0, sizeof(LevelCacheSector));
 
 			// Sector ID and Name
 			line = parser.readLine(bufferPos);
@@ -312,51 +330,29 @@ namespace TFE_Jedi
 			line = parser.readLine(bufferPos);
 			// Sectors missing a name are valid but do not get "addresses" - and thus cannot be
 			// used by the INF system (except in the case of doors and exploding walls, see the flags section below).
+			sector->nameOffset = LEVEL_CACHE_NO_NAME;
 			if (sscanf(line, " NAME %s", name) == 1)
 			{
-				// Add the sector "address" for later use by the INF system.
-				message_addAddress(name, 0, 0, sector);
-
-				// Track special elevators.
-				if (!strcasecmp(name, "complete"))
-				{
-					s_completeSector = sector;
-				}
-				else if (!strcasecmp(name, "boss"))
-				{
-					s_bossSector = sector;
-				}
-				else if (!strcasecmp(name, "mohc"))
-				{
-					s_mohcSector = sector;
-				}
+				sector->nameOffset = level_addParsedString(name);
 			}
 
 			// Lighting
 			line = parser.readLine(bufferPos);
-			s32 ambient;
-			if (sscanf(line, " AMBIENT %d", &ambient) != 1)
+			if (sscanf(line, " AMBIENT %d", &sector->ambient) != 1)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read sector ambient.");
 				return false;
 			}
-			sector->ambient = intToFixed16(ambient);
 
 			// Floor Texture & Offset
 			line = parser.readLine(bufferPos);
-			s32 index, tmp;
+			s32 tmp;
 			f32 offsetX, offsetZ;
-			if (sscanf(line, " FLOOR TEXTURE %d %f %f %d", &index, &offsetX, &offsetZ, &tmp) != 4)
+			if (sscanf(line, " FLOOR TEXTURE %d %f %f %d", &sector->floorTex, &offsetX, &offsetZ, &tmp) != 4)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read floor texture.");
 				return false;
 			}
-
-			sector->floorTex = nullptr;
-			if (index != -1)
-			{
-				sector->floorTex = &s_textures[index];
-			}
 			sector->floorOffset.x = floatToFixed16(offsetX);
 			sector->floorOffset.z = floatToFixed16(offsetZ);
 
@@ -372,16 +368,11 @@ namespace TFE_Jedi
 
 			// Ceiling Texture & Offset
 			line = parser.readLine(bufferPos);
-			if (sscanf(line, " CEILING TEXTURE %d %f %f %d", &index, &offsetX, &offsetZ, &tmp) != 4)
+			if (sscanf(line, " CEILING TEXTURE %d %f %f %d", &sector->ceilTex, &offsetX, &offsetZ, &tmp) != 4)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read ceiling texture.");
 				return false;
 			}
-			sector->ceilTex = nullptr;
-			if (index != -1)
-			{
-				sector->ceilTex = &s_textures[index];
-			}
 			sector->ceilOffset.x = floatToFixed16(offsetX);
 			sector->ceilOffset.z = floatToFixed16(offsetZ);
 
@@ -392,7 +383,7 @@ namespace TFE_Jedi
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read ceiling altitude.");
 				return false;
 			}
-			sector->ceilingHeight = floatToFixed16(alt);
+			sector->ceilHeight = floatToFixed16(alt);
 
 			// Second Altitude
 			line = parser.readLine(bufferPos);
@@ -410,22 +401,6 @@ namespace TFE_Jedi
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read sector flags.");
 				return false;
 			}
-			// Create a door if needed.
-			if (sector->flags1 & SEC_FLAGS1_DOOR)
-			{
-				InfElevator* elev = inf_allocateSpecialElevator(sector, IELEV_SP_DOOR);
-				if (elev) { elev->flags |= INF_EFLAG_DOOR; }
-			}
-			// Create an exploding wall if needed.
-			if (sector->flags1 & SEC_FLAGS1_EXP_WALL)
-			{
-				inf_allocateSpecialElevator(sector, IELEV_SP_EXPLOSIVE_WALL);
-			}
-			// Add secrets.
-			if (sector->flags1 & SEC_FLAGS1_SECRET)
-			{
-				s_secretCount++;
-			}
 
 			// Layer
 			line = parser.readLine(bufferPos);
@@ -434,8 +409,6 @@ namespace TFE_Jedi
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read sector layer.");
 				return false;
 			}
-			s_minLayer = min(s_minLayer, sector->layer);
-			s_maxLayer = max(s_maxLayer, sector->layer);
 
 			// Vertices
 			line = parser.readLine(bufferPos);
@@ -445,9 +418,7 @@ namespace TFE_Jedi
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read sector vertices.");
 				return false;
 			}
-			const size_t vtxSize = vertexCount * sizeof(vec2_fixed);
-			sector->verticesWS = (vec2_fixed*)level_alloc(vtxSize);
-			sector->verticesVS = (vec2_fixed*)level_alloc(vtxSize);
+			sector->vertexStart = s32(s_parsedVertices.size());
 			sector->vertexCount = vertexCount;
 
 			for (s32 v = 0; v < vertexCount; v++)
@@ -456,8 +427,8 @@ namespace TFE_Jedi
 
 				f32 x, z;
 				sscanf(line, " X: %f Z: %f ", &x, &z);
-				sector->verticesWS[v].x = floatToFixed16(x);
-				sector->verticesWS[v].z = floatToFixed16(z);
+				const vec2_fixed vtx = { floatToFixed16(x), floatToFixed16(z) };
+				s_parsedVertices.push_back(vtx);
 			}
 
 			// Walls
@@ -468,7 +439,7 @@ namespace TFE_Jedi
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read sector walls.");
 				return false;
 			}
-			sector->walls = (RWall*)level_alloc(wallCount * sizeof(RWall));
+			sector->wallStart = s32(s_parsedWalls.size());
 			sector->wallCount = wallCount;
 
 			for (s32 w = 0; w < wallCount; w++)
@@ -490,73 +461,285 @@ namespace TFE_Jedi
 					return false;
 				}
 
+				LevelCacheWall wall;
+				memset(&wall, 0, sizeof(LevelCacheWall));
+				wall.left = left;
+				wall.right = right;
+				wall.midTex = midTex;
+				wall.topTex = topTex;
+				wall.botTex = botTex;
+				wall.signTex = signTex;
+				wall.adjoin = adjoin;
+				wall.mirror = mirror;
+				wall.flags1 = flags1;
+				wall.flags2 = flags2;
+				wall.flags3 = flags3;
+				wall.light = light;
+				if (midTex != -1)
+				{
+					wall.midOffset.x = floatToFixed16(midOffsetX) * 8;
+					wall.midOffset.z = floatToFixed16(midOffsetZ) * 8;
+				}
+				if (topTex != -1)
+				{
+					wall.topOffset.x = floatToFixed16(topOffsetX) * 8;
+					wall.topOffset.z = floatToFixed16(topOffsetZ) * 8;
+				}
+				if (botTex != -1)
+				{
+					wall.botOffset.x = floatToFixed16(botOffsetX) * 8;
+					wall.botOffset.z = floatToFixed16(botOffsetZ) * 8;
+				}
+				if (signTex != -1)
+				{
+					wall.signOffset.x = floatToFixed16(signOffsetX) * 8;
+					wall.signOffset.z = floatToFixed16(signOffsetZ) * 8;
+				}
+				s_parsedWalls.push_back(wall);
+			}
+		}
+
+		data->textureCount = textureCount;
+		data->sectorCount  = sectorCount;
+		data->wallCount    = s32(s_parsedWalls.size());
+		data->vertexCount  = s32(s_parsedVertices.size());
+		data->stringSize   = s32(s_parsedStrings.size());
+		data->textureNames = s_parsedTextures.data();
+		data->sectors      = s_parsedSectors.data();
+		data->walls        = s_parsedWalls.data();
+		data->vertices     = s_parsedVertices.data();
+		data->strings      = s_parsedStrings.data();
+		return true;
+	}
+
+	s32 level_addParsedString(const char* str)
+	{
+		const s32 offset = s32(s_parsedStrings.size());
+		s_parsedStrings.insert(s_parsedStrings.end(), str, str + strlen(str) + 1);
+		return offset;
+	}
+
+	// Create the runtime textures, sectors and walls from the parsed or cached level data.
+	JBool level_buildGeometry(const LevelGeometryData* data)
+	{
+		FilePath filePath;
+		s_parallax0 = data->parallax0;
+		s_parallax1 = data->parallax1;
+
+		// Load Textures.
+		s_textureCount = data->textureCount;
+		s_textures = (TextureData**)res_alloc(s_textureCount * sizeof(TextureData**));
+		memset(s_textures, 0, s_textureCount * sizeof(TextureData**));
+
+		// Resolve the paths first, so the textures can be read and decompressed in parallel.
+		std::vector<FilePath> texturePaths(s_textureCount);
+		for (s32 i = 0; i < s_textureCount; i++)
+		{
+			FilePath* path = &texturePaths[i];
+			path->archive = nullptr;
+			path->index = INVALID_FILE;
+			path->path[0] = 0;
+
+			const char* textureName = data->textureNames[i] == LEVEL_CACHE_NO_NAME ? "default.bm" : &data->strings[data->textureNames[i]];
+			if (strcasecmp(textureName, "<NoTexture>") && !TFE_Paths::getFilePath(textureName, path))
+			{
+				path->archive = nullptr;
+				path->path[0] = 0;
+			}
+		}
+		bitmap_loadList(texturePaths.data(), s_textureCount, 1, s_textures);
+
+		TextureData** texture = s_textures;
+		for (s32 i = 0; i < s_textureCount; i++, texture++)
+		{
+			const char* textureName = data->textureNames[i] == LEVEL_CACHE_NO_NAME ? "default.bm" : &data->strings[data->textureNames[i]];
+			if (!strcasecmp(textureName, "<NoTexture>"))
+			{
+				continue;
+			}
+
+			TextureData* tex = *texture;
+			if (!tex)
+			{
+				TFE_System::logWrite(LOG_WARNING, "level_loadGeometry", "Could not open '%s', using 'default.bm' instead.", textureName);
+
+				TFE_Paths::getFilePath("default.bm", &filePath);
+				tex = bitmap_load(&filePath, 1);
+				if (!tex)
+				{
+					TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "'default.bm' is not a valid BM file!");
+					assert(0);
+					return false;
+				}
+				*texture = tex;
+			}
+
+			// Setup an animated texture.
+			if (tex->uvWidth == BM_ANIMATED_TEXTURE)
+			{
+				bitmap_setupAnimatedTexture(texture);
+			}
+		}
+
+		// Load Sectors.
+		s_sectorCount = u32(data->sectorCount);
+		s_sectors = (RSector*)level_alloc(sizeof(RSector) * s_sectorCount);
+		memset(s_sectors, 0, sizeof(RSector) * s_sectorCount);
+		for (u32 i = 0; i < s_sectorCount; i++)
+		{
+			const LevelCacheSector* src = &data->sectors[i];
+			RSector* sector = &s_sectors[i];
+			sector_clear(sector);
+			sector->index = i;
+			sector->id = src->id;
+
+			if (src->nameOffset != LEVEL_CACHE_NO_NAME)
+			{
+				const char* name = &data->strings[src->nameOffset];
+				// Add the sector "address" for later use by the INF system.
+				message_addAddress(name, 0, 0, sector);
+
+				// Track special elevators.
+				if (!strcasecmp(name, "complete"))
+				{
+					s_completeSector = sector;
+				}
+				else if (!strcasecmp(name, "boss"))
+				{
+					s_bossSector = sector;
+				}
+				else if (!strcasecmp(name, "mohc"))
+				{
+					s_mohcSector = sector;
+				}
+			}
+
+			// Lighting
+			sector->ambient = intToFixed16(src->ambient);
+
+			// Floor & Ceiling
+			sector->floorTex = nullptr;
+			if (src->floorTex != -1)
+			{
+				sector->floorTex = &s_textures[src->floorTex];
+			}
+			sector->floorOffset = src->floorOffset;
+			sector->floorHeight = src->floorHeight;
+
+			sector->ceilTex = nullptr;
+			if (src->ceilTex != -1)
+			{
+				sector->ceilTex = &s_textures[src->ceilTex];
+			}
+			sector->ceilOffset = src->ceilOffset;
+			sector->ceilingHeight = src->ceilHeight;
+			sector->secHeight = src->secHeight;
+
+			// Sector flags
+			sector->flags1 = src->flags1;
+			sector->flags2 = src->flags2;
+			sector->flags3 = src->flags3;
+			// Create a door if needed.
+			if (sector->flags1 & SEC_FLAGS1_DOOR)
+			{
+				InfElevator* elev = inf_allocateSpecialElevator(sector, IELEV_SP_DOOR);
+				if (elev) { elev->flags |= INF_EFLAG_DOOR; }
+			}
+			// Create an exploding wall if needed.
+			if (sector->flags1 & SEC_FLAGS1_EXP_WALL)
+			{
+				inf_allocateSpecialElevator(sector, IELEV_SP_EXPLOSIVE_WALL);
+			}
+			// Add secrets.
+			if (sector->flags1 & SEC_FLAGS1_SECRET)
+			{
+				s_secretCount++;
+			}
+
+			// Layer
+			sector->layer = src->layer;
+			s_minLayer = min(s_minLayer, sector->layer);
+			s_maxLayer = max(s_maxLayer, sector->layer);
+
+			// Vertices
+			const s32 vertexCount = src->vertexCount;
+			const size_t vtxSize = vertexCount * sizeof(vec2_fixed);
+			sector->verticesWS = (vec2_fixed*)level_alloc(vtxSize);
+			sector->verticesVS = (vec2_fixed*)level_alloc(vtxSize);
+			sector->vertexCount = vertexCount;
+			memcpy(sector->verticesWS, &data->vertices[src->vertexStart], vtxSize);
+
+			// Walls
+			const s32 wallCount = src->wallCount;
+			sector->walls = (RWall*)level_alloc(wallCount * sizeof(RWall));
+			sector->wallCount = wallCount;
+
+			for (s32 w = 0; w < wallCount; w++)
+			{
+				const LevelCacheWall* srcWall = &data->walls[src->wallStart + w];
 				RWall* wall = &sector->walls[w];
 				wall->id = w;
 				wall->sector = sector;
 				wall->mirrorWall = nullptr;
 				wall->seen = JFALSE;
-				wall->flags1 = flags1;
-				wall->flags2 = flags2;
-				wall->flags3 = flags3;
+				wall->flags1 = srcWall->flags1;
+				wall->flags2 = srcWall->flags2;
+				wall->flags3 = srcWall->flags3;
 
-				vec2_fixed* leftVtxWS = &sector->verticesWS[left];
-				vec2_fixed* rightVtxWS = &sector->verticesWS[right];
+				vec2_fixed* leftVtxWS = &sector->verticesWS[srcWall->left];
+				vec2_fixed* rightVtxWS = &sector->verticesWS[srcWall->right];
 				wall->w0 = leftVtxWS;
 				wall->w1 = rightVtxWS;
-				wall->v0 = &sector->verticesVS[left];
-				wall->v1 = &sector->verticesVS[right];
+				wall->v0 = &sector->verticesVS[srcWall->left];
+				wall->v1 = &sector->verticesVS[srcWall->right];
 				// Store the original position 0 in the wall since it is used by the sector rotation INF.
 				wall->worldPos0.x = leftVtxWS->x;
 				wall->worldPos0.z = leftVtxWS->z;
 
 				wall->nextSector = nullptr;
 				wall->mirror = -1;
-				if (adjoin != -1)
+				if (srcWall->adjoin != -1)
 				{
-					wall->nextSector = &s_sectors[adjoin];
-					if (mirror == -1)
+					wall->nextSector = &s_sectors[srcWall->adjoin];
+					if (srcWall->mirror == -1)
 					{
 						TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Adjoining wall missing mirror.");
 					}
-					wall->mirror = mirror;
+					wall->mirror = srcWall->mirror;
 				}
 
 				wall->infLink = nullptr;
 				wall->collisionFrame = 0;
 				wall->drawFrame = 0;
 				wall->drawFlags = 0;
-				wall->wallLight = intToFixed16(light);
+				wall->wallLight = intToFixed16(srcWall->light);
 
 				wall->midTex = nullptr;
-				if (midTex != -1)
+				if (srcWall->midTex != -1)
 				{
-					wall->midTex = &s_textures[midTex];
-					wall->midOffset.x = floatToFixed16(midOffsetX) * 8;
-					wall->midOffset.z = floatToFixed16(midOffsetZ) * 8;
+					wall->midTex = &s_textures[srcWall->midTex];
+					wall->midOffset = srcWall->midOffset;
 				}
 
 				wall->topTex = nullptr;
-				if (topTex != -1)
+				if (srcWall->topTex != -1)
 				{
-					wall->topTex = &s_textures[topTex];
-					wall->topOffset.x = floatToFixed16(topOffsetX) * 8;
-					wall->topOffset.z = floatToFixed16(topOffsetZ) * 8;
+					wall->topTex = &s_textures[srcWall->topTex];
+					wall->topOffset = srcWall->topOffset;
 				}
 
 				wall->botTex = nullptr;
-				if (botTex != -1)
+				if (srcWall->botTex != -1)
 				{
-					wall->botTex = &s_textures[botTex];
-					wall->botOffset.x = floatToFixed16(botOffsetX) * 8;
-					wall->botOffset.z = floatToFixed16(botOffsetZ) * 8;
+					wall->botTex = &s_textures[srcWall->botTex];
+					wall->botOffset = srcWall->botOffset;
 				}
 
 				wall->signTex = nullptr;
-				if (signTex != -1)
+				if (srcWall->signTex != -1)
 				{
-					wall->signTex = &s_textures[signTex];
-					wall->signOffset.x = floatToFixed16(signOffsetX) * 8;
-					wall->signOffset.z = floatToFixed16(signOffsetZ) * 8;
+					wall->signTex = &s_textures[srcWall->signTex];
+					wall->signOffset = srcWall->signOffset;
 				}
 
 				fixed16_16 dx = rightVtxWS->x - leftVtxWS->x;
@@ -591,6 +774,8 @@ namespace TFE_Jedi
 			// TFE: Added to support non-fixed-point rendering.
 			sector->dirtyFlags = SDF_ALL;
 		}
+		// TFE: Spatial index used by sector_which3D() and sector_which3D_Map().
+		sectorGrid_build();
 
 		return true;
 	}
@@ -807,52 +992,54 @@ namespace TFE_Jedi
 			else if (sscanf(line, "SPRS %d", &s_spriteCount) == 1)
 			{
 				s_sprites = (JediWax**)res_alloc(sizeof(JediWax*)*s_spriteCount);
+				// Gather the names first, so the sprites can be loaded in parallel.
+				std::vector<LevelAssetName> names(s_spriteCount);
+				std::vector<const char*> nameList(s_spriteCount);
 				for (s32 s = 0; s < s_spriteCount; s++)
 				{
 					line = parser.readLine(bufferPos);
-					s_sprites[s] = nullptr;
+					names[s].name[0] = 0;
+					nameList[s] = names[s].name;
 
-					if (line)
+					if (line && sscanf(line, " SPR: %s ", names[s].name) != 1)
 					{
-						char name[32];
-						if (sscanf(line, " SPR: %s ", name) == 1)
-						{
-							s_sprites[s] = TFE_Sprite_Jedi::getWax(name);
-							if (!s_sprites[s])
-							{
-								s_sprites[s] = TFE_Sprite_Jedi::getWax("default.wax");
-							}
-						}
-						else
-						{
-							TFE_System::logWrite(LOG_WARNING, "Level Load", "Unknown line in sprite list '%s' - skipping.", line);
-						}
+						names[s].name[0] = 0;
+						TFE_System::logWrite(LOG_WARNING, "Level Load", "Unknown line in sprite list '%s' - skipping.", line);
+					}
+				}
+				TFE_Sprite_Jedi::getWaxes(nameList.data(), s_spriteCount, s_sprites);
+				for (s32 s = 0; s < s_spriteCount; s++)
+				{
+					if (names[s].name[0] && !s_sprites[s])
+					{
+						s_sprites[s] = TFE_Sprite_Jedi::getWax("default.wax");
 					}
 				}
 			}
 			else if (sscanf(line, "FMES %d", &s_fmeCount) == 1)
 			{
 				s_frames = (JediFrame**)res_alloc(sizeof(JediFrame*)*s_fmeCount);
+				// Gather the names first, so the frames can be loaded in parallel.
+				std::vector<LevelAssetName> names(s_fmeCount);
+				std::vector<const char*> nameList(s_fmeCount);
 				for (s32 f = 0; f < s_fmeCount; f++)
 				{
 					line = parser.readLine(bufferPos);
-					s_frames[f] = nullptr;
+					names[f].name[0] = 0;
+					nameList[f] = names[f].name;
 
-					if (line)
+					if (line && sscanf(line, " FME: %s ", names[f].name) != 1)
 					{
-						char name[32];
-						if (sscanf(line, " FME: %s ", name) == 1)
-						{
-							s_frames[f] = TFE_Sprite_Jedi::getFrame(name);
-							if (!s_frames[f])
-							{
-								s_frames[f] = TFE_Sprite_Jedi::getFrame("default.fme");
-							}
-						}
-						else
-						{
-							TFE_System::logWrite(LOG_WARNING, "Level Load", "Unknown line in fme list '%s' - skipping.", line);
-						}
+						names[f].name[0] = 0;
+						TFE_System::logWrite(LOG_WARNING, "Level Load", "Unknown line in fme list '%s' - skipping.", line);
+					}
+				}
+				TFE_Sprite_Jedi::getFrames(nameList.data(), s_fmeCount, s_frames);
+				for (s32 f = 0; f < s_fmeCount; f++)
+				{
+					if (names[f].name[0] && !s_frames[f])
+					{
+						s_frames[f] = TFE_Sprite_Jedi::getFrame("default.fme");
 					}
 				}
 			}
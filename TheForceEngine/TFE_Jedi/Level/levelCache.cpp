@@ -0,0 +1,215 @@
+#include <cstring>
+
+#include "levelCache.h"
+#include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/fileutil.h>
+#include <TFE_FileSystem/memoryMappedFile.h>
+#include <TFE_FileSystem/paths.h>
+#include <TFE_FrontEndUI/console.h>
+#include <TFE_System/system.h>
+
+namespace TFE_Jedi
+{
+	enum
+	{
+		// Increment when the format or the way the source is read changes.
+		LEVEL_CACHE_VERSION = 1,
+	};
+
+	struct LevelCacheHeader
+	{
+		char magic[4];
+		u32 version;
+		u64 sourceHash;
+		u32 sourceSize;
+		fixed16_16 parallax0;
+		fixed16_16 parallax1;
+		s32 textureCount;
+		s32 sectorCount;
+		s32 wallCount;
+		s32 vertexCount;
+		s32 stringSize;
+	};
+
+	static const char c_levelCacheMagic[4] = { 'T', 'F', 'L', 'C' };
+	static bool s_levelCacheEnabled = true;
+	static bool s_levelCacheInit = false;
+	static MemoryMappedFile s_cacheFile;
+
+	void levelCache_init()
+	{
+		if (s_levelCacheInit) { return; }
+		s_levelCacheInit = true;
+		CVAR_BOOL(s_levelCacheEnabled, "g_levelCache", CVFLAG_NONE, "Cache the parsed level geometry on disk to speed up level loading.");
+	}
+
+	// FNV-1a
+	u64 levelCache_hash(const u8* data, size_t size)
+	{
+		u64 hash = 14695981039346656037ull;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= data[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	void levelCache_getPath(const char* levelName, char* path, JBool createDir)
+	{
+		char dir[TFE_MAX_PATH];
+		snprintf(dir, TFE_MAX_PATH, "%sLevelCache/", TFE_Paths::getPath(PATH_PROGRAM_DATA));
+		if (createDir && !FileUtil::directoryExits(dir))
+		{
+			FileUtil::makeDirectory(dir);
+		}
+		snprintf(path, TFE_MAX_PATH, "%s%s.lvc", dir, levelName);
+	}
+
+	JBool levelCache_validString(const LevelGeometryData* data, s32 offset)
+	{
+		if (offset == LEVEL_CACHE_NO_NAME) { return JTRUE; }
+		return (offset >= 0 && offset < data->stringSize && memchr(data->strings + offset, 0, data->stringSize - offset)) ? JTRUE : JFALSE;
+	}
+
+	JBool levelCache_validTexture(const LevelGeometryData* data, s32 index)
+	{
+		return (index >= -1 && index < data->textureCount) ? JTRUE : JFALSE;
+	}
+
+	// Make sure a damaged cache file cannot produce out of range indices.
+	JBool levelCache_validate(const LevelGeometryData* data)
+	{
+		for (s32 i = 0; i < data->textureCount; i++)
+		{
+			if (!levelCache_validString(data, data->textureNames[i])) { return JFALSE; }
+		}
+
+		for (s32 i = 0; i < data->sectorCount; i++)
+		{
+			const LevelCacheSector* sector = &data->sectors[i];
+			if (!levelCache_validString(data, sector->nameOffset)) { return JFALSE; }
+			if (!levelCache_validTexture(data, sector->floorTex) || !levelCache_validTexture(data, sector->ceilTex)) { return JFALSE; }
+			if (sector->vertexStart < 0 || sector->vertexCount < 0 || sector->vertexCount > data->vertexCount - sector->vertexStart) { return JFALSE; }
+			if (sector->wallStart < 0 || sector->wallCount < 0 || sector->wallCount > data->wallCount - sector->wallStart) { return JFALSE; }
+
+			for (s32 w = 0; w < sector->wallCount; w++)
+			{
+				const LevelCacheWall* wall = &data->walls[sector->wallStart + w];
+				if (wall->left < 0 || wall->left >= sector->vertexCount || wall->right < 0 || wall->right >= sector->vertexCount) { return JFALSE; }
+				if (!levelCache_validTexture(data, wall->midTex) || !levelCache_validTexture(data, wall->topTex) ||
+					!levelCache_validTexture(data, wall->botTex) || !levelCache_validTexture(data, wall->signTex)) { return JFALSE; }
+				if (wall->adjoin < -1 || wall->adjoin >= data->sectorCount) { return JFALSE; }
+			}
+		}
+		// Mirrors reference the walls of the adjoined sector.
+		for (s32 i = 0; i < data->wallCount; i++)
+		{
+			const LevelCacheWall* wall = &data->walls[i];
+			if (wall->adjoin >= 0 && (wall->mirror < 0 || wall->mirror >= data->sectors[wall->adjoin].wallCount)) { return JFALSE; }
+		}
+		return JTRUE;
+	}
+
+	JBool levelCache_read(const char* levelName, u64 sourceHash, u32 sourceSize, LevelGeometryData* data)
+	{
+		levelCache_close();
+		if (!s_levelCacheEnabled) { return JFALSE; }
+
+		char path[TFE_MAX_PATH];
+		levelCache_getPath(levelName, path, JFALSE);
+		if (!FileUtil::exists(path) || !s_cacheFile.open(path))
+		{
+			return JFALSE;
+		}
+
+		const u8* base = s_cacheFile.data();
+		const size_t size = s_cacheFile.size();
+		const LevelCacheHeader* header = (const LevelCacheHeader*)base;
+		if (size < sizeof(LevelCacheHeader) || memcmp(header->magic, c_levelCacheMagic, 4) || header->version != LEVEL_CACHE_VERSION ||
+			header->sourceHash != sourceHash || header->sourceSize != sourceSize)
+		{
+			levelCache_close();
+			return JFALSE;
+		}
+		if (header->textureCount < 0 || header->sectorCount < 0 || header->wallCount < 0 || header->vertexCount < 0 || header->stringSize < 0)
+		{
+			levelCache_close();
+			return JFALSE;
+		}
+
+		const size_t expectedSize = sizeof(LevelCacheHeader) + sizeof(s32) * size_t(header->textureCount) + sizeof(LevelCacheSector) * size_t(header->sectorCount)
+			+ sizeof(LevelCacheWall) * size_t(header->wallCount) + sizeof(vec2_fixed) * size_t(header->vertexCount) + size_t(header->stringSize);
+		if (size != expectedSize)
+		{
+			TFE_System::logWrite(LOG_WARNING, "Level Cache", "Level cache '%s' has an invalid size, it will be rebuilt.", path);
+			levelCache_close();
+			return JFALSE;
+		}
+
+		const u8* ptr = base + sizeof(LevelCacheHeader);
+		data->parallax0 = header->parallax0;
+		data->parallax1 = header->parallax1;
+		data->textureCount = header->textureCount;
+		data->sectorCount  = header->sectorCount;
+		data->wallCount    = header->wallCount;
+		data->vertexCount  = header->vertexCount;
+		data->stringSize   = header->stringSize;
+
+		data->textureNames = (const s32*)ptr;              ptr += sizeof(s32) * data->textureCount;
+		data->sectors      = (const LevelCacheSector*)ptr; ptr += sizeof(LevelCacheSector) * data->sectorCount;
+		data->walls        = (const LevelCacheWall*)ptr;   ptr += sizeof(LevelCacheWall) * data->wallCount;
+		data->vertices     = (const vec2_fixed*)ptr;       ptr += sizeof(vec2_fixed) * data->vertexCount;
+		data->strings      = (const char*)ptr;
+
+		if (!levelCache_validate(data))
+		{
+			TFE_System::logWrite(LOG_WARNING, "Level Cache", "Level cache '%s' is invalid, it will be rebuilt.", path);
+			levelCache_close();
+			return JFALSE;
+		}
+		return JTRUE;
+	}
+
+	void levelCache_close()
+	{
+		s_cacheFile.close();
+	}
+
+	void levelCache_write(const char* levelName, u64 sourceHash, u32 sourceSize, const LevelGeometryData* data)
+	{
+		if (!s_levelCacheEnabled) { return; }
+
+		char path[TFE_MAX_PATH];
+		levelCache_getPath(levelName, path, JTRUE);
+
+		FileStream file;
+		if (!file.open(path, FileStream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_WARNING, "Level Cache", "Cannot write level cache '%s'.", path);
+			return;
+		}
+
+		LevelCacheHeader header;
+		memset(&header, 0, sizeof(LevelCacheHeader));
+		memcpy(header.magic, c_levelCacheMagic, 4);
+		header.version      = LEVEL_CACHE_VERSION;
+		header.sourceHash   = sourceHash;
+		header.sourceSize   = sourceSize;
+		header.parallax0    = data->parallax0;
+		header.parallax1    = data->parallax1;
+		header.textureCount = data->textureCount;
+		header.sectorCount  = data->sectorCount;
+		header.wallCount    = data->wallCount;
+		header.vertexCount  = data->vertexCount;
+		header.stringSize   = data->stringSize;
+
+		file.writeBuffer(&header, sizeof(LevelCacheHeader));
+		if (data->textureCount) { file.writeBuffer(data->textureNames, sizeof(s32), data->textureCount); }
+		if (data->sectorCount)  { file.writeBuffer(data->sectors, sizeof(LevelCacheSector), data->sectorCount); }
+		if (data->wallCount)    { file.writeBuffer(data->walls, sizeof(LevelCacheWall), data->wallCount); }
+		if (data->vertexCount)  { file.writeBuffer(data->vertices, sizeof(vec2_fixed), data->vertexCount); }
+		if (data->stringSize)   { file.writeBuffer(data->strings, data->stringSize); }
+		file.close();
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Level Cache
+// Binary copy of the parsed level geometry (.LEV), stored in the
+// program data directory and keyed by a hash of the source file.
+// When the source has not changed the cache file is memory mapped
+// and the geometry is built from it directly, skipping the text
+// parsing.
+//
+// The cache holds the values exactly as they are read from the text,
+// the same code builds the runtime sectors and walls from either
+// source (see level_buildGeometry()).
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include <TFE_Jedi/Math/core_math.h>
+
+namespace TFE_Jedi
+{
+	enum
+	{
+		LEVEL_CACHE_NO_NAME = -1,		// sector without a name / unreadable texture line.
+	};
+
+	struct LevelCacheSector
+	{
+		s32 id;
+		s32 nameOffset;					// offset into the string table or LEVEL_CACHE_NO_NAME.
+		s32 ambient;
+		s32 floorTex;
+		vec2_fixed floorOffset;
+		fixed16_16 floorHeight;
+		s32 ceilTex;
+		vec2_fixed ceilOffset;
+		fixed16_16 ceilHeight;
+		fixed16_16 secHeight;
+		u32 flags1;
+		u32 flags2;
+		u32 flags3;
+		s32 layer;
+		s32 vertexStart;
+		s32 vertexCount;
+		s32 wallStart;
+		s32 wallCount;
+	};
+
+	struct LevelCacheWall
+	{
+		s32 left;
+		s32 right;
+		s32 midTex;
+		s32 topTex;
+		s32 botTex;
+		s32 signTex;
+		// Offsets are already converted to fixed point texels.
+		vec2_fixed midOffset;
+		vec2_fixed topOffset;
+		vec2_fixed botOffset;
+		vec2_fixed signOffset;
+		s32 adjoin;
+		s32 mirror;
+		u32 flags1;
+		u32 flags2;
+		u32 flags3;
+		s32 light;
+	};
+
+	// Level geometry as read from the source, pointing either to the parsed data or into the mapped cache file.
+	struct LevelGeometryData
+	{
+		fixed16_16 parallax0;
+		fixed16_16 parallax1;
+
+		s32 textureCount;
+		s32 sectorCount;
+		s32 wallCount;
+		s32 vertexCount;
+		s32 stringSize;
+
+		const s32* textureNames;		// string table offsets or LEVEL_CACHE_NO_NAME.
+		const LevelCacheSector* sectors;
+		const LevelCacheWall* walls;
+		const vec2_fixed* vertices;
+		const char* strings;
+	};
+
+	void  levelCache_init();
+	u64   levelCache_hash(const u8* data, size_t size);
+
+	// Map the cache for 'levelName', returns JFALSE if it is missing, out of date or invalid.
+	// The data remains valid until levelCache_close() is called.
+	JBool levelCache_read(const char* levelName, u64 sourceHash, u32 sourceSize, LevelGeometryData* data);
+	void  levelCache_close();
+	// Write the parsed geometry to the cache.
+	void  levelCache_write(const char* levelName, u64 sourceHash, u32 sourceSize, const LevelGeometryData* data);
+}
@@ -2,6 +2,7 @@
 #include <cstring>
 
 #include "rsector.h"
+#include "rsectorGrid.h"
 #include "rwall.h"
 #include "robject.h"
 #include "level.h"
@@ -198,6 +199,7 @@ namespace TFE_Jedi
 		sector->boundsMax.x = maxX;
 		sector->boundsMin.z = minZ;
 		sector->boundsMax.z = maxZ;
+		sectorGrid_updateSector(sector);
 
 		// Setup when needed.
 		//s_minX = minX;
@@ -482,12 +484,14 @@ namespace TFE_Jedi
 		fixed16_16 iz = dz;
 		fixed16_16 y = dy;
 		
-		RSector* sector = s_sectors;
 		RSector* foundSector = nullptr;
 		s32 sectorUnitArea = 0;
 		s32 prevSectorUnitArea = INT_MAX;
 
-		for (u32 i = 0; i < s_sectorCount; i++, sector++)
+		// Only the sectors whose bounds may contain the point are visited, in the same order as the full sector list.
+		SectorGridIter iter;
+		sectorGrid_begin(&iter, ix, iz);
+		while (RSector* sector = sectorGrid_next(&iter))
 		{
 			if (y >= sector->ceilingHeight && y <= sector->floorHeight)
 			{
@@ -521,12 +525,14 @@ namespace TFE_Jedi
 		fixed16_16 ix = dx;
 		fixed16_16 iz = dz;
 
-		RSector* sector = s_sectors;
 		RSector* foundSector = nullptr;
 		s32 sectorUnitArea = 0;
 		s32 prevSectorUnitArea = INT_MAX;
 
-		for (u32 i = 0; i < s_sectorCount; i++, sector++)
+		// Only the sectors whose bounds may contain the point are visited, in the same order as the full sector list.
+		SectorGridIter iter;
+		sectorGrid_begin(&iter, ix, iz);
+		while (RSector* sector = sectorGrid_next(&iter))
 		{
 			if (sector->layer == layer)
 			{
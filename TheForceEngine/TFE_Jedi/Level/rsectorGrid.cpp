@@ -0,0 +1,264 @@
+#include <cstring>
+#include <cmath>
+
+#include "rsectorGrid.h"
+#include "rsector.h"
+#include "level.h"
+#include <TFE_Game/igame.h>
+#include <TFE_Memory/snapshot.h>
+#include <TFE_System/system.h>
+
+namespace TFE_Jedi
+{
+	// Aim for about one cell per sector, but never smaller than this (in world units).
+	#define GRID_MIN_CELL_SIZE 8
+	// Use larger cells if large sectors would be duplicated more than this on average.
+	#define GRID_MAX_ENTRIES_PER_SECTOR 16
+
+	struct CellRange
+	{
+		s32 x0, z0;
+		s32 x1, z1;
+	};
+
+	static RSector* s_gridSectors = nullptr;
+	static s32 s_gridSectorCount = 0;
+	static fixed16_16 s_gridMinX;
+	static fixed16_16 s_gridMinZ;
+	static s64 s_gridCellSize;		// fixed point, 64 bits so large levels do not overflow.
+	static s32 s_gridWidth;
+	static s32 s_gridHeight;
+
+	static s32* s_cellStart;		// offsets into s_cellSectors, one per cell + 1.
+	static s32* s_cellSectors;		// sector indices, sorted within each cell.
+	static CellRange* s_sectorRange;	// the cells each sector was added to.
+
+	static s32* s_overflow;			// sector indices, sorted.
+	static s32  s_overflowCount;
+	static u8*  s_inOverflow;
+
+	s32 sectorGrid_cellCoord(fixed16_16 value, fixed16_16 gridMin)
+	{
+		const s64 offset = s64(value) - s64(gridMin);
+		return offset < 0 ? -1 : s32(offset / s_gridCellSize);
+	}
+
+	void sectorGrid_getRange(RSector* sector, CellRange* range)
+	{
+		range->x0 = sectorGrid_cellCoord(sector->boundsMin.x, s_gridMinX);
+		range->z0 = sectorGrid_cellCoord(sector->boundsMin.z, s_gridMinZ);
+		range->x1 = sectorGrid_cellCoord(sector->boundsMax.x, s_gridMinX);
+		range->z1 = sectorGrid_cellCoord(sector->boundsMax.z, s_gridMinZ);
+	}
+
+	void sectorGrid_clear()
+	{
+		s_gridSectors = nullptr;
+		s_gridSectorCount = 0;
+		s_cellStart = nullptr;
+		s_cellSectors = nullptr;
+		s_sectorRange = nullptr;
+		s_overflow = nullptr;
+		s_overflowCount = 0;
+		s_inOverflow = nullptr;
+	}
+
+	void sectorGrid_build()
+	{
+		sectorGrid_clear();
+		const s32 count = s32(s_sectorCount);
+		if (!count || !s_sectors) { return; }
+
+		fixed16_16 maxX = s_sectors[0].boundsMax.x;
+		fixed16_16 maxZ = s_sectors[0].boundsMax.z;
+		s_gridMinX = s_sectors[0].boundsMin.x;
+		s_gridMinZ = s_sectors[0].boundsMin.z;
+		for (s32 i = 1; i < count; i++)
+		{
+			s_gridMinX = min(s_gridMinX, s_sectors[i].boundsMin.x);
+			s_gridMinZ = min(s_gridMinZ, s_sectors[i].boundsMin.z);
+			maxX = max(maxX, s_sectors[i].boundsMax.x);
+			maxZ = max(maxZ, s_sectors[i].boundsMax.z);
+		}
+
+		const f64 extentX = f64(s64(maxX) - s64(s_gridMinX)) / 65536.0 + 1.0;
+		const f64 extentZ = f64(s64(maxZ) - s64(s_gridMinZ)) / 65536.0 + 1.0;
+		f64 cellSize = sqrt(extentX * extentZ / f64(count));
+		if (cellSize < GRID_MIN_CELL_SIZE) { cellSize = GRID_MIN_CELL_SIZE; }
+
+		// Find the cell size and total entry count.
+		s64 entryCount;
+		while (1)
+		{
+			s_gridCellSize = s64(cellSize * 65536.0);
+			s_gridWidth  = sectorGrid_cellCoord(maxX, s_gridMinX) + 1;
+			s_gridHeight = sectorGrid_cellCoord(maxZ, s_gridMinZ) + 1;
+
+			entryCount = 0;
+			for (s32 i = 0; i < count; i++)
+			{
+				CellRange range;
+				sectorGrid_getRange(&s_sectors[i], &range);
+				entryCount += s64(range.x1 - range.x0 + 1) * s64(range.z1 - range.z0 + 1);
+			}
+			if (entryCount <= s64(count) * GRID_MAX_ENTRIES_PER_SECTOR || s_gridWidth * s_gridHeight == 1) { break; }
+			cellSize *= 2.0;
+		}
+
+		const s32 cellCount = s_gridWidth * s_gridHeight;
+		s_cellStart   = (s32*)level_alloc(sizeof(s32) * (cellCount + 1));
+		s_cellSectors = (s32*)level_alloc(sizeof(s32) * entryCount);
+		s_sectorRange = (CellRange*)level_alloc(sizeof(CellRange) * count);
+		s_overflow    = (s32*)level_alloc(sizeof(s32) * count);
+		s_inOverflow  = (u8*)level_alloc(count);
+		if (!s_cellStart || !s_cellSectors || !s_sectorRange || !s_overflow || !s_inOverflow)
+		{
+			TFE_System::logWrite(LOG_ERROR, "Sector Grid", "Cannot allocate the sector grid, falling back to a linear search.");
+			sectorGrid_clear();
+			return;
+		}
+		memset(s_cellStart, 0, sizeof(s32) * (cellCount + 1));
+		memset(s_inOverflow, 0, count);
+
+		// Count the sectors in each cell, then turn the counts into offsets.
+		for (s32 i = 0; i < count; i++)
+		{
+			CellRange* range = &s_sectorRange[i];
+			sectorGrid_getRange(&s_sectors[i], range);
+			for (s32 z = range->z0; z <= range->z1; z++)
+			{
+				for (s32 x = range->x0; x <= range->x1; x++)
+				{
+					s_cellStart[z * s_gridWidth + x + 1]++;
+				}
+			}
+		}
+		for (s32 c = 0; c < cellCount; c++)
+		{
+			s_cellStart[c + 1] += s_cellStart[c];
+		}
+
+		// Fill in the cells in sector order, using the start of the next cell as the write cursor.
+		for (s32 i = 0; i < count; i++)
+		{
+			const CellRange* range = &s_sectorRange[i];
+			for (s32 z = range->z0; z <= range->z1; z++)
+			{
+				for (s32 x = range->x0; x <= range->x1; x++)
+				{
+					s_cellSectors[s_cellStart[z * s_gridWidth + x]++] = i;
+				}
+			}
+		}
+		// Each cursor now points to the end of its cell, shift them back.
+		memmove(&s_cellStart[1], &s_cellStart[0], sizeof(s32) * cellCount);
+		s_cellStart[0] = 0;
+
+		s_gridSectors = s_sectors;
+		s_gridSectorCount = count;
+		TFE_System::logWrite(LOG_MSG, "Sector Grid", "Built a %d x %d sector grid with %d entries for %d sectors.", s_gridWidth, s_gridHeight, s32(entryCount), count);
+	}
+
+	void sectorGrid_updateSector(RSector* sector)
+	{
+		if (!s_gridSectors || s_gridSectors != s_sectors) { return; }
+		if (sector < s_gridSectors || sector >= s_gridSectors + s_gridSectorCount) { return; }
+
+		const s32 index = s32(sector - s_gridSectors);
+		if (s_inOverflow[index]) { return; }
+
+		// Bounds that shrink or move within the original cells are still covered.
+		CellRange range;
+		sectorGrid_getRange(sector, &range);
+		const CellRange* cells = &s_sectorRange[index];
+		if (range.x0 >= cells->x0 && range.x1 <= cells->x1 && range.z0 >= cells->z0 && range.z1 <= cells->z1)
+		{
+			return;
+		}
+
+		// Insert into the overflow list, keeping it sorted.
+		s32 pos = s_overflowCount;
+		for (; pos > 0 && s_overflow[pos - 1] > index; pos--)
+		{
+			s_overflow[pos] = s_overflow[pos - 1];
+		}
+		s_overflow[pos] = index;
+		s_overflowCount++;
+		s_inOverflow[index] = 1;
+	}
+
+	// The overflow flags live in level memory and are restored with a snapshot, so the count is rebuilt from them.
+	void sectorGrid_restore()
+	{
+		if (!s_gridSectors) { return; }
+
+		s_overflowCount = 0;
+		for (s32 i = 0; i < s_gridSectorCount; i++)
+		{
+			if (s_inOverflow[i])
+			{
+				s_overflow[s_overflowCount++] = i;
+			}
+		}
+	}
+
+	void sectorGrid_registerSnapshot()
+	{
+		TFE_Memory::snapshot_registerRestoreCallback(sectorGrid_restore);
+	}
+
+	void sectorGrid_begin(SectorGridIter* iter, fixed16_16 x, fixed16_16 z)
+	{
+		iter->cell = nullptr;
+		iter->cellCount = 0;
+		iter->overflow = nullptr;
+		iter->overflowCount = 0;
+		iter->linearIndex = 0;
+		if (!s_gridSectors || s_gridSectors != s_sectors || s_gridSectorCount != s32(s_sectorCount)) { return; }
+
+		iter->overflow = s_overflow;
+		iter->overflowCount = s_overflowCount;
+
+		const s32 cx = sectorGrid_cellCoord(x, s_gridMinX);
+		const s32 cz = sectorGrid_cellCoord(z, s_gridMinZ);
+		if (cx >= 0 && cx < s_gridWidth && cz >= 0 && cz < s_gridHeight)
+		{
+			const s32 cell = cz * s_gridWidth + cx;
+			iter->cell = &s_cellSectors[s_cellStart[cell]];
+			iter->cellCount = s_cellStart[cell + 1] - s_cellStart[cell];
+		}
+	}
+
+	RSector* sectorGrid_next(SectorGridIter* iter)
+	{
+		if (!s_gridSectors || s_gridSectors != s_sectors || s_gridSectorCount != s32(s_sectorCount))
+		{
+			return (iter->linearIndex < s32(s_sectorCount)) ? &s_sectors[iter->linearIndex++] : nullptr;
+		}
+
+		// Merge the cell and overflow lists, both are in index order.
+		s32 index;
+		if (iter->cellCount && (!iter->overflowCount || *iter->cell <= *iter->overflow))
+		{
+			index = *iter->cell;
+			iter->cell++;
+			iter->cellCount--;
+			if (iter->overflowCount && *iter->overflow == index)
+			{
+				iter->overflow++;
+				iter->overflowCount--;
+			}
+		}
+		else if (iter->overflowCount)
+		{
+			index = *iter->overflow;
+			iter->overflow++;
+			iter->overflowCount--;
+		}
+		else
+		{
+			return nullptr;
+		}
+		return &s_gridSectors[index];
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Sector Grid
+// A uniform grid over the sector bounds, built when the level is
+// loaded, used to limit the sectors tested by point queries such as
+// sector_which3D(). Each cell lists the sectors whose bounds overlap
+// it, in sector index order, so a query visits the same sectors in
+// the same order as a linear search - minus the ones that cannot
+// contain the point.
+//
+// Sectors whose bounds grow beyond their cells (moving or rotating
+// walls) are moved to an overflow list that every query visits.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include <TFE_Jedi/Math/core_math.h>
+
+struct RSector;
+
+namespace TFE_Jedi
+{
+	struct SectorGridIter
+	{
+		const s32* cell;
+		s32 cellCount;
+		const s32* overflow;
+		s32 overflowCount;
+		// Used to iterate every sector when the grid has not been built.
+		s32 linearIndex;
+	};
+
+	// Build the grid from the current sector bounds, called after the level geometry is loaded.
+	void sectorGrid_build();
+	// Forget the grid, the memory is owned by the level region.
+	void sectorGrid_clear();
+	// Called when the bounds of a sector change after the grid has been built.
+	void sectorGrid_updateSector(RSector* sector);
+	// Rebuild the overflow list when a snapshot is restored.
+	void sectorGrid_registerSnapshot();
+
+	// Iterate, in index order, the sectors whose bounds may contain (x, z).
+	void sectorGrid_begin(SectorGridIter* iter, fixed16_16 x, fixed16_16 z);
+	RSector* sectorGrid_next(SectorGridIter* iter);
+}
@@ -7,6 +7,7 @@
 #include <TFE_Asset/assetSystem.h>
 #include <TFE_FileSystem/paths.h>
 #include <TFE_FileSystem/filestream.h>
+#include <TFE_System/jobSystem.h>
 #include <TFE_Jedi/Task/task.h>
 
 using namespace TFE_DarkForces;
@@ -25,6 +26,13 @@ namespace TFE_Jedi
 	static Task* s_textureAnimTask = nullptr;
 	static MemoryRegion* s_memoryRegion = nullptr;
 
+	// Where the image is copied or decompressed from.
+	struct BitmapSource
+	{
+		const u8* data;		// file data after the common header.
+		u8 compressed;		// compression of the file data.
+	};
+
 	void decompressColumn_Type1(const u8* src, u8* dst, s32 pixelCount);
 	void decompressColumn_Type2(const u8* src, u8* dst, s32 pixelCount);
 	void textureAnimationTaskFunc(MessageType msg);
@@ -73,33 +81,23 @@ namespace TFE_Jedi
 		s_memoryRegion = allocator;
 	}
 
-	TextureData* bitmap_load(FilePath* filepath, u32 decompress)
+	// Parse the header and allocate the texture, the image itself is filled in by bitmap_fillImage().
+	TextureData* bitmap_allocate(const u8* data, const char* name, u32 decompress, BitmapSource* src)
 	{
-		FileStream file;
-		if (!file.open(filepath, FileStream::MODE_READ))
-		{
-			return nullptr;
-		}
-		size_t size = file.getSize();
-		s_buffer.resize(size);
-		file.readBuffer(s_buffer.data(), (u32)size);
-		file.close();
-
 		TextureData* texture = (TextureData*)region_alloc(s_memoryRegion, sizeof(TextureData));
-		const u8* data = s_buffer.data();
 		const u8* fheader = data;
 		data += 3;
 
 		if (strncmp((char*)fheader, "BM ", 3))
 		{
-			TFE_System::logWrite(LOG_ERROR, "bitmap_load", "File '%s' is not a valid BM file.", filepath);
+			TFE_System::logWrite(LOG_ERROR, "bitmap_load", "File '%s' is not a valid BM file.", name);
 			return nullptr;
 		}
 
 		u8 version = readByte(data);
 		if (version != DF_BM_VERSION)
 		{
-			TFE_System::logWrite(LOG_ERROR, "bitmap_load", "File '%s' has invalid BM version '%u'.", filepath, version);
+			TFE_System::logWrite(LOG_ERROR, "bitmap_load", "File '%s' has invalid BM version '%u'.", name, version);
 			return nullptr;
 		}
 
@@ -112,76 +110,144 @@ namespace TFE_Jedi
 		texture->compressed = readByte(data);
 		// value is ignored.
 		data++;
-		
+
+		src->data = data;
+		src->compressed = texture->compressed;
 		if (texture->compressed)
 		{
 			s32 inSize = readInt(data);
-			// values are ignored.
-			data += 12;
-
 			if (decompress & 1)
 			{
 				texture->dataSize = texture->width * texture->height;
 				texture->image = (u8*)region_alloc(s_memoryRegion, texture->dataSize);
+				texture->compressed = 0;
+				texture->columns = nullptr;
+			}
+			else
+			{
+				texture->dataSize = inSize;
+				texture->image = (u8*)region_alloc(s_memoryRegion, texture->dataSize);
+				texture->columns = (u32*)region_alloc(s_memoryRegion, texture->width * sizeof(u32));
+			}
+		}
+		else
+		{
+			texture->dataSize = texture->width * texture->height;
+			texture->columns = nullptr;
+			// Allocate the BM image.
+			texture->image = (u8*)region_alloc(s_memoryRegion, texture->dataSize);
+		}
+		return texture;
+	}
+
+	// Copy or decompress the image into the memory allocated by bitmap_allocate().
+	// This does not touch any shared state, so it can run on the job workers.
+	void bitmap_fillImage(TextureData* texture, const BitmapSource* src)
+	{
+		const u8* data = src->data;
+		if (src->compressed)
+		{
+			s32 inSize = readInt(data);
+			// values are ignored.
+			data += 12;
 
+			if (!texture->compressed)
+			{
 				const u8* inBuffer = data;
 				data += inSize;
 
 				const u32* columns = (u32*)data;
-				data += sizeof(u32) * texture->width;
-
-				if (texture->compressed == 1)
+				if (src->compressed == 1)
 				{
 					u8* dst = texture->image;
 					for (s32 i = 0; i < texture->width; i++, dst += texture->height)
 					{
-						const u8* src = &inBuffer[columns[i]];
-						decompressColumn_Type1(src, dst, texture->height);
+						decompressColumn_Type1(&inBuffer[columns[i]], dst, texture->height);
 					}
 				}
-				else if (texture->compressed == 2)
+				else if (src->compressed == 2)
 				{
 					u8* dst = texture->image;
 					for (s32 i = 0; i < texture->width; i++, dst += texture->height)
 					{
-						const u8* src = &inBuffer[columns[i]];
-						decompressColumn_Type2(src, dst, texture->height);
+						decompressColumn_Type2(&inBuffer[columns[i]], dst, texture->height);
 					}
 				}
-				texture->compressed = 0;
-				texture->columns = nullptr;
 			}
 			else
 			{
-				texture->dataSize = inSize;
-				texture->image = (u8*)region_alloc(s_memoryRegion, texture->dataSize);
 				memcpy(texture->image, data, texture->dataSize);
 				data += texture->dataSize;
-
-				texture->columns = (u32*)region_alloc(s_memoryRegion, texture->width * sizeof(u32));
 				memcpy(texture->columns, data, texture->width * sizeof(u32));
-				data += texture->width * sizeof(u32);
 			}
 		}
 		else
 		{
-			texture->dataSize = texture->width * texture->height;
-			// Datasize, ignored.
-			data += 4;
-			texture->columns = nullptr;
-
-			// Padding, ignored.
-			data += 12;
-
-			// Allocate and read the BM image.
-			texture->image = (u8*)region_alloc(s_memoryRegion, texture->dataSize);
+			// Datasize and padding, ignored.
+			data += 16;
 			memcpy(texture->image, data, texture->dataSize);
-			data += texture->dataSize;
+		}
+	}
+
+	TextureData* bitmap_load(FilePath* filepath, u32 decompress)
+	{
+		// Parse the data in place if the archive is memory mapped, otherwise read it into the work buffer.
+		size_t size = 0;
+		const u8* data = filepath->archive ? filepath->archive->getFileData(filepath->index, &size) : nullptr;
+		if (!data)
+		{
+			FileStream file;
+			if (!file.open(filepath, FileStream::MODE_READ))
+			{
+				return nullptr;
+			}
+			size = file.getSize();
+			s_buffer.resize(size);
+			file.readBuffer(s_buffer.data(), (u32)size);
+			file.close();
+			data = s_buffer.data();
 		}
 
+		BitmapSource src;
+		TextureData* texture = bitmap_allocate(data, filepath->path, decompress, &src);
+		if (texture)
+		{
+			bitmap_fillImage(texture, &src);
+		}
 		return texture;
 	}
 
+	struct BitmapListJob
+	{
+		TextureData** textures;
+		const BitmapSource* sources;
+	};
+
+	void bitmap_fillImageJob(s32 index, void* userData)
+	{
+		BitmapListJob* job = (BitmapListJob*)userData;
+		if (job->textures[index])
+		{
+			bitmap_fillImage(job->textures[index], &job->sources[index]);
+		}
+	}
+
+	void bitmap_loadList(const FilePath* paths, s32 count, u32 decompress, TextureData** textures)
+	{
+		std::vector<TFE_AssetSystem::AssetData> files(count);
+		std::vector<BitmapSource> sources(count);
+		TFE_AssetSystem::readAssetList(paths, count, files.data());
+
+		// Allocate in list order on this thread, so the region layout does not depend on the workers.
+		for (s32 i = 0; i < count; i++)
+		{
+			textures[i] = files[i].data ? bitmap_allocate(files[i].data, paths[i].path, decompress, &sources[i]) : nullptr;
+		}
+
+		BitmapListJob job = { textures, sources.data() };
+		TFE_Jobs::run(bitmap_fillImageJob, &job, count);
+	}
+
 	TextureData* bitmap_loadFromMemory(const u8* data, size_t size, u32 decompress)
 	{
 		TextureData* texture = (TextureData*)malloc(sizeof(TextureData));
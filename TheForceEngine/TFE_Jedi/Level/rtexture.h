@@ -83,6 +83,9 @@ namespace TFE_Jedi
 	void bitmap_setAllocator(MemoryRegion* allocator);
 	MemoryRegion* bitmap_getAllocator();
 	TextureData* bitmap_load(FilePath* filepath, u32 decompress);
+	// Load a list of textures, matching bitmap_load() on each path in order. Files are read and decompressed
+	// on the job workers while allocations are made on the calling thread. Empty paths or invalid files give null.
+	void bitmap_loadList(const FilePath* paths, s32 count, u32 decompress, TextureData** textures);
 	void bitmap_setupAnimatedTexture(TextureData** texture);
 
 	Allocator* bitmap_getAnimatedTextures();
@@ -1,13 +1,34 @@
 #include "allocator.h"
 #include <TFE_System/system.h>
 #include <TFE_Memory/memoryRegion.h>
+#include <TFE_FrontEndUI/console.h>
 #include <TFE_Game/igame.h>
 #include <assert.h>
+#include <algorithm>
+#include <vector>
+
+struct AllocSlab;
 
 struct AllocHeader
 {
 	AllocHeader* prev;
-	AllocHeader* next;
+	AllocHeader* next;		// Next item in the list or next free slot in the slab.
+	AllocSlab* slab;		// The slab holding this item, null if the slot is free.
+};
+
+// Items are allocated from slabs, so items allocated together are next to each other in memory.
+// The item list is still a linked list, so the order and iterator behavior match the original allocator.
+struct AllocSlab
+{
+	AllocSlab* prev;		// All slabs.
+	AllocSlab* next;
+	AllocSlab* prevPartial;	// Slabs with free slots.
+	AllocSlab* nextPartial;
+	AllocHeader* freeList;
+	s32 capacity;
+	s32 used;				// Slots handed out in order, slots past this have never been used.
+	s32 liveCount;
+	s32 pad;
 };
 
 struct Allocator
@@ -18,8 +39,15 @@ struct Allocator
 	AllocHeader* iterPrev;
 	AllocHeader* iter;
 	MemoryRegion* region;
-	s32 size;
+	s32 size;				// Item stride, including the header.
 	s32 refCount;
+
+	// Slab storage.
+	AllocSlab* slabs;
+	AllocSlab* partial;		// Slabs with free slots, new items are taken from the first one.
+	AllocSlab* spare;		// One empty slab is kept to avoid freeing and allocating as a list empties and fills.
+	s32 count;
+	s32 nextCapacity;		// Capacity of the next slab, this grows as the list grows.
 };
 
 namespace TFE_Jedi
@@ -31,6 +59,88 @@ namespace TFE_Jedi
 	#define ALLOC_INVALID_PTR ((AllocHeader*)c_invalidPtr)
 	#define MAX_ALLOC_SIZE (8*1024*1024)  // 8MB
 
+	enum AllocatorConstants
+	{
+		ALLOC_SLAB_MIN_ITEMS = 2,
+		ALLOC_SLAB_MAX_ITEMS = 256,
+		ALLOC_SLAB_MAX_BYTES = 16 * 1024,	// Slabs only go past this size if a single item is larger.
+	};
+
+	void console_allocatorBenchmark(const ConsoleArgList& args);
+
+	void allocator_registerCommands()
+	{
+		CCMD("allocatorBenchmark", console_allocatorBenchmark, 0, "allocatorBenchmark [lists] [items] [iterations] - compare iterating lists of individually allocated items with the slab allocator.");
+	}
+
+	AllocHeader* allocator_getSlot(AllocSlab* slab, s32 size, s32 index)
+	{
+		return (AllocHeader*)((u8*)slab + sizeof(AllocSlab) + size_t(index) * size_t(size));
+	}
+
+	void allocator_linkPartial(Allocator* alloc, AllocSlab* slab)
+	{
+		slab->prevPartial = nullptr;
+		slab->nextPartial = alloc->partial;
+		if (alloc->partial) { alloc->partial->prevPartial = slab; }
+		alloc->partial = slab;
+	}
+
+	void allocator_unlinkPartial(Allocator* alloc, AllocSlab* slab)
+	{
+		if (slab->prevPartial) { slab->prevPartial->nextPartial = slab->nextPartial; }
+		else { alloc->partial = slab->nextPartial; }
+		if (slab->nextPartial) { slab->nextPartial->prevPartial = slab->prevPartial; }
+		slab->prevPartial = nullptr;
+		slab->nextPartial = nullptr;
+	}
+
+	AllocSlab* allocator_addSlab(Allocator* alloc)
+	{
+		AllocSlab* slab = alloc->spare;
+		if (slab)
+		{
+			alloc->spare = nullptr;
+		}
+		else
+		{
+			const s32 maxItems = std::max(1, s32(ALLOC_SLAB_MAX_BYTES / alloc->size));
+			const s32 capacity = std::min(alloc->nextCapacity, maxItems);
+			slab = (AllocSlab*)TFE_Memory::region_alloc(alloc->region, sizeof(AllocSlab) + size_t(capacity) * size_t(alloc->size));
+			if (!slab) { return nullptr; }
+
+			slab->capacity = capacity;
+			alloc->nextCapacity = std::min(capacity * 2, s32(ALLOC_SLAB_MAX_ITEMS));
+		}
+		slab->freeList = nullptr;
+		slab->used = 0;
+		slab->liveCount = 0;
+
+		slab->prev = nullptr;
+		slab->next = alloc->slabs;
+		if (alloc->slabs) { alloc->slabs->prev = slab; }
+		alloc->slabs = slab;
+		allocator_linkPartial(alloc, slab);
+		return slab;
+	}
+
+	void allocator_removeSlab(Allocator* alloc, AllocSlab* slab)
+	{
+		allocator_unlinkPartial(alloc, slab);
+		if (slab->prev) { slab->prev->next = slab->next; }
+		else { alloc->slabs = slab->next; }
+		if (slab->next) { slab->next->prev = slab->prev; }
+
+		if (!alloc->spare)
+		{
+			alloc->spare = slab;
+		}
+		else
+		{
+			TFE_Memory::region_free(alloc->region, slab);
+		}
+	}
+
 	// Create and free an allocator.
 	Allocator* allocator_create(s32 allocSize, MemoryRegion* region)
 	{
@@ -56,9 +166,16 @@ namespace TFE_Jedi
 		res->tail = ALLOC_INVALID_PTR;
 		res->iterPrev = ALLOC_INVALID_PTR;
 		res->iter = ALLOC_INVALID_PTR;
-		res->size = allocSize + sizeof(AllocHeader);
+		// Keep items 8 byte aligned.
+		res->size = (allocSize + s32(sizeof(AllocHeader)) + 7) & ~7;
 		res->refCount = 0;
 
+		res->slabs = nullptr;
+		res->partial = nullptr;
+		res->spare = nullptr;
+		res->count = 0;
+		res->nextCapacity = ALLOC_SLAB_MIN_ITEMS;
+
 		return res;
 	}
 
@@ -66,11 +183,17 @@ namespace TFE_Jedi
 	{
 		if (!alloc) { return; }
 
-		void* item = allocator_getHead(alloc);
-		while (item)
+		// Items don't need to be freed individually, the slabs hold all of them.
+		AllocSlab* slab = alloc->slabs;
+		while (slab)
 		{
-			allocator_deleteItem(alloc, item);
-			item = allocator_getNext(alloc);
+			AllocSlab* next = slab->next;
+			TFE_Memory::region_free(alloc->region, slab);
+			slab = next;
+		}
+		if (alloc->spare)
+		{
+			TFE_Memory::region_free(alloc->region, alloc->spare);
 		}
 
 		alloc->self = (Allocator*)ALLOC_INVALID_PTR;
@@ -82,14 +205,33 @@ namespace TFE_Jedi
 	{
 		if (!alloc) { return nullptr; }
 
-		AllocHeader* header = (AllocHeader*)TFE_Memory::region_alloc(alloc->region, alloc->size);
-		if (!header)
+		AllocSlab* slab = alloc->partial ? alloc->partial : allocator_addSlab(alloc);
+		if (!slab)
 		{
-			TFE_System::logWrite(LOG_ERROR, "Allocator", "allocator_newItem - cannot allocate header of size %d", alloc->size);
+			TFE_System::logWrite(LOG_ERROR, "Allocator", "allocator_newItem - cannot allocate slab for items of size %d", alloc->size);
 			assert(0);
 			return nullptr;
 		}
 
+		AllocHeader* header;
+		if (slab->freeList)
+		{
+			header = slab->freeList;
+			slab->freeList = header->next;
+		}
+		else
+		{
+			header = allocator_getSlot(slab, alloc->size, slab->used);
+			slab->used++;
+		}
+		slab->liveCount++;
+		if (!slab->freeList && slab->used == slab->capacity)
+		{
+			allocator_unlinkPartial(alloc, slab);
+		}
+		alloc->count++;
+
+		header->slab = slab;
 		header->next = ALLOC_INVALID_PTR;
 		header->prev = alloc->tail;
 
@@ -130,20 +272,30 @@ namespace TFE_Jedi
 			alloc->iterPrev = header->next;
 		}
 
-		TFE_Memory::region_free(alloc->region, header);
+		// Return the slot to its slab.
+		AllocSlab* slab = header->slab;
+		const bool wasFull = !slab->freeList && slab->used == slab->capacity;
+		header->slab = nullptr;
+		header->next = slab->freeList;
+		slab->freeList = header;
+		slab->liveCount--;
+		alloc->count--;
+
+		if (!slab->liveCount)
+		{
+			if (wasFull) { allocator_linkPartial(alloc, slab); }
+			allocator_removeSlab(alloc, slab);
+		}
+		else if (wasFull)
+		{
+			allocator_linkPartial(alloc, slab);
+		}
 	}
 
 	// Random access.
 	s32 allocator_getCount(Allocator* alloc)
 	{
-		s32 count = 0;
-		AllocHeader* header = alloc->head;
-		while (header != ALLOC_INVALID_PTR)
-		{
-			count++;
-			header = header->next;
-		}
-		return count;
+		return alloc ? alloc->count : 0;
 	}
 
 	void* allocator_getByIndex(Allocator* alloc, s32 index)
@@ -247,4 +399,187 @@ namespace TFE_Jedi
 	{
 		return alloc ? alloc->refCount : 0;
 	}
-}
\ No newline at end of file
+
+	/////////////////////////////////////////////////////
+	// Benchmark
+	/////////////////////////////////////////////////////
+	enum
+	{
+		ALLOC_BENCH_DEFAULT_LISTS = 1000,
+		ALLOC_BENCH_DEFAULT_ITEMS = 16,
+		ALLOC_BENCH_DEFAULT_ITERATIONS = 100,
+		ALLOC_BENCH_ITEM_SIZE = 64,
+	};
+
+	// The previous layout: every item is allocated from the region on its own.
+	struct LegacyListItem
+	{
+		LegacyListItem* prev;
+		LegacyListItem* next;
+		u32 value;
+	};
+
+	struct LegacyList
+	{
+		LegacyListItem* head;
+		LegacyListItem* tail;
+	};
+
+	LegacyListItem* legacy_newItem(MemoryRegion* region, LegacyList* list)
+	{
+		LegacyListItem* item = (LegacyListItem*)TFE_Memory::region_alloc(region, sizeof(AllocHeader) + ALLOC_BENCH_ITEM_SIZE);
+		item->prev = list->tail;
+		item->next = nullptr;
+		if (list->tail) { list->tail->next = item; }
+		else { list->head = item; }
+		list->tail = item;
+		return item;
+	}
+
+	void legacy_deleteItem(MemoryRegion* region, LegacyList* list, LegacyListItem* item)
+	{
+		if (item->prev) { item->prev->next = item->next; }
+		else { list->head = item->next; }
+		if (item->next) { item->next->prev = item->prev; }
+		else { list->tail = item->prev; }
+		TFE_Memory::region_free(region, item);
+	}
+
+	u32 legacy_iterate(std::vector<LegacyList>& lists)
+	{
+		u32 sum = 0;
+		for (size_t l = 0; l < lists.size(); l++)
+		{
+			for (LegacyListItem* item = lists[l].head; item; item = item->next)
+			{
+				sum += item->value;
+			}
+		}
+		return sum;
+	}
+
+	u32 allocator_iterate(std::vector<Allocator*>& lists)
+	{
+		// Walk the headers directly so both layouts pay the same per item cost, only the memory layout differs.
+		u32 sum = 0;
+		for (size_t l = 0; l < lists.size(); l++)
+		{
+			for (AllocHeader* header = lists[l]->head; header != ALLOC_INVALID_PTR; header = header->next)
+			{
+				sum += *(u32*)((u8*)header + sizeof(AllocHeader));
+			}
+		}
+		return sum;
+	}
+
+	void console_allocatorBenchmark(const ConsoleArgList& args)
+	{
+		const s32 listCount  = args.size() >= 2 ? std::max(1, atoi(args[1].c_str())) : ALLOC_BENCH_DEFAULT_LISTS;
+		const s32 itemCount  = args.size() >= 3 ? std::max(1, atoi(args[2].c_str())) : ALLOC_BENCH_DEFAULT_ITEMS;
+		const s32 iterations = args.size() >= 4 ? std::max(1, atoi(args[3].c_str())) : ALLOC_BENCH_DEFAULT_ITERATIONS;
+
+		// Items are added to the lists in turn, the way a level loads sectors, elevators and their stops.
+		MemoryRegion* region = TFE_Memory::region_create("AllocatorBench", 8 * 1024 * 1024);
+		std::vector<LegacyList> legacyLists(listCount);
+		std::vector<Allocator*> slabLists(listCount);
+		for (s32 l = 0; l < listCount; l++)
+		{
+			legacyLists[l] = { nullptr, nullptr };
+			slabLists[l] = allocator_create(ALLOC_BENCH_ITEM_SIZE, region);
+		}
+
+		f64 buildTime[2] = { 0 };
+		u64 start = TFE_System::getCurrentTimeInTicks();
+		for (s32 i = 0; i < itemCount; i++)
+		{
+			for (s32 l = 0; l < listCount; l++)
+			{
+				legacy_newItem(region, &legacyLists[l])->value = u32(l + i);
+			}
+		}
+		buildTime[0] = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+
+		start = TFE_System::getCurrentTimeInTicks();
+		for (s32 i = 0; i < itemCount; i++)
+		{
+			for (s32 l = 0; l < listCount; l++)
+			{
+				*(u32*)allocator_newItem(slabLists[l]) = u32(l + i);
+			}
+		}
+		buildTime[1] = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+
+		// Iterate, then delete every other item and add them back to see how iteration holds up with reused slots.
+		f64 iterTime[2][2] = { 0 };
+		u32 sums[2][2] = { 0 };
+		for (s32 pass = 0; pass < 2; pass++)
+		{
+			start = TFE_System::getCurrentTimeInTicks();
+			for (s32 it = 0; it < iterations; it++) { sums[pass][0] += legacy_iterate(legacyLists); }
+			iterTime[pass][0] = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+
+			start = TFE_System::getCurrentTimeInTicks();
+			for (s32 it = 0; it < iterations; it++) { sums[pass][1] += allocator_iterate(slabLists); }
+			iterTime[pass][1] = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+
+			if (pass == 0)
+			{
+				for (s32 l = 0; l < listCount; l++)
+				{
+					LegacyListItem* legacyItem = legacyLists[l].head;
+					u32* item = (u32*)allocator_getHead(slabLists[l]);
+					for (s32 i = 0; i < itemCount; i++)
+					{
+						LegacyListItem* legacyNext = legacyItem->next;
+						if (i & 1)
+						{
+							legacy_deleteItem(region, &legacyLists[l], legacyItem);
+							// Safe to delete during iteration, the next item is still returned.
+							allocator_deleteItem(slabLists[l], item);
+						}
+						legacyItem = legacyNext;
+						item = (u32*)allocator_getNext(slabLists[l]);
+					}
+				}
+				for (s32 i = 1; i < itemCount; i += 2)
+				{
+					for (s32 l = 0; l < listCount; l++)
+					{
+						legacy_newItem(region, &legacyLists[l])->value = u32(l + i);
+						*(u32*)allocator_newItem(slabLists[l]) = u32(l + i);
+					}
+				}
+			}
+		}
+
+		bool countsMatch = true;
+		for (s32 l = 0; l < listCount; l++)
+		{
+			countsMatch = countsMatch && allocator_getCount(slabLists[l]) == itemCount;
+			allocator_free(slabLists[l]);
+		}
+		TFE_Memory::region_destroy(region);
+
+		char res[256];
+		const f64 scale = 1000.0 / f64(iterations);
+		sprintf(res, "Allocator benchmark: %d lists x %d items of %d bytes, %d iterations.", listCount, itemCount, (s32)ALLOC_BENCH_ITEM_SIZE, iterations);
+		TFE_Console::addToHistory(res);
+		sprintf(res, "  Build:            item allocations %0.3f ms, slabs %0.3f ms.", buildTime[0] * 1000.0, buildTime[1] * 1000.0);
+		TFE_Console::addToHistory(res);
+		sprintf(res, "  Iterate:          item allocations %0.3f ms, slabs %0.3f ms (%0.2fx).", iterTime[0][0] * scale, iterTime[0][1] * scale,
+			iterTime[0][1] > 0.0 ? iterTime[0][0] / iterTime[0][1] : 0.0);
+		TFE_Console::addToHistory(res);
+		sprintf(res, "  Iterate (reused): item allocations %0.3f ms, slabs %0.3f ms (%0.2fx).", iterTime[1][0] * scale, iterTime[1][1] * scale,
+			iterTime[1][1] > 0.0 ? iterTime[1][0] / iterTime[1][1] : 0.0);
+		TFE_Console::addToHistory(res);
+		if (sums[0][0] != sums[0][1] || sums[1][0] != sums[1][1] || !countsMatch)
+		{
+			TFE_Console::addToHistory("  Item values MISMATCH between the two layouts.");
+			TFE_System::logWrite(LOG_ERROR, "Allocator", "Benchmark: the slab allocator lists do not match the individually allocated lists.");
+		}
+		else
+		{
+			TFE_Console::addToHistory("  Item values match.");
+		}
+	}
+}
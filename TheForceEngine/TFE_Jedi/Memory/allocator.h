@@ -33,4 +33,7 @@ namespace TFE_Jedi
 	void allocator_addRef(Allocator* alloc);
 	void allocator_release(Allocator* alloc);
 	s32  allocator_getRefCount(Allocator* alloc);
+
+	// Console commands.
+	void allocator_registerCommands();
 }
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include "redgePairFixed.h"
 #include "rclassicFixedSharedState.h"
 #include "../rcommon.h"
+#include "../rspriteCache.h"
 #include "../jediRenderer.h"
 
 namespace TFE_Jedi
@@ -2280,6 +2281,8 @@ namespace RClassic_Fixed
 
 		// This should be set to handle all sizes, repeating is not required.
 		s_texHeightMask = 0xffff;
+		// Compressed cells are read directly from the decompressed copy in the sprite cache when enabled.
+		const u8* cachedImage = compressed ? spriteCache_getCell(cell) : nullptr;
 
 		const u32* columnOffset = (u32*)(basePtr + cell->columnOffset);
 		for (s32 x = x0_pixel; x <= x1_pixel; x++, uCoord += uCoordStep)
@@ -2312,7 +2315,11 @@ namespace RClassic_Fixed
 						texelU = cell->sizeX - texelU - 1;
 					}
 										
-					if (compressed)
+					if (cachedImage)
+					{
+						s_texImage = (u8*)cachedImage + texelU * cell->sizeY;
+					}
+					else if (compressed)
 					{
 						const u8* colPtr = (u8*)cell + columnOffset[texelU];
 
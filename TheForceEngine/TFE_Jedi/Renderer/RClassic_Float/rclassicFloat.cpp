@@ -45,9 +45,9 @@ namespace RClassic_Float
 
 	void transformPointByCamera(vec3_float* worldPoint, vec3_float* viewPoint)
 	{
-		viewPoint->x = worldPoint->x * s_rcfltState.cosYaw + worldPoint->z * s_rcfltState.sinYaw + s_rcfltState.cameraTrans.x;
-		viewPoint->y = worldPoint->y - s_rcfltState.eyeHeight;
-		viewPoint->z = worldPoint->z * s_rcfltState.cosYaw + worldPoint->x * s_rcfltState.negSinYaw + s_rcfltState.cameraTrans.z;
+		viewPoint->x = worldPoint->x * s_rcfltState->cosYaw + worldPoint->z * s_rcfltState->sinYaw + s_rcfltState->cameraTrans.x;
+		viewPoint->y = worldPoint->y - s_rcfltState->eyeHeight;
+		viewPoint->z = worldPoint->z * s_rcfltState->cosYaw + worldPoint->x * s_rcfltState->negSinYaw + s_rcfltState->cameraTrans.z;
 	}
 
 	void setCameraWorldPos(f32 x, f32 z, f32 eyeHeight)
@@ -59,42 +59,42 @@ namespace RClassic_Float
 
 	void computeCameraTransform(RSector* sector, f32 pitch, f32 yaw, f32 camX, f32 camY, f32 camZ)
 	{
-		s_rcfltState.cameraPos.x = camX;
-		s_rcfltState.cameraPos.z = camZ;
-		s_rcfltState.eyeHeight = camY;
+		s_rcfltState->cameraPos.x = camX;
+		s_rcfltState->cameraPos.z = camZ;
+		s_rcfltState->eyeHeight = camY;
 
 		s_sector = sector;
 
-		s_rcfltState.cameraYaw = yaw;
-		s_rcfltState.cameraPitch = pitch;
+		s_rcfltState->cameraYaw = yaw;
+		s_rcfltState->cameraPitch = pitch;
 
 		s_xOffset = -camX;
 		s_zOffset = -camZ;
-		sinCosFlt(-yaw, &s_rcfltState.sinYaw, &s_rcfltState.cosYaw);
+		sinCosFlt(-yaw, &s_rcfltState->sinYaw, &s_rcfltState->cosYaw);
 
-		s_rcfltState.negSinYaw = -s_rcfltState.sinYaw;
-		if (s_maxPitch != s_rcfltState.cameraPitch)
+		s_rcfltState->negSinYaw = -s_rcfltState->sinYaw;
+		if (s_maxPitch != s_rcfltState->cameraPitch)
 		{
-			f32 pitchOffset = tanFlt(pitch) * s_rcfltState.focalLenAspect;
-			s_rcfltState.projOffsetY = s_rcfltState.projOffsetYBase + pitchOffset;
+			f32 pitchOffset = tanFlt(pitch) * s_rcfltState->focalLenAspect;
+			s_rcfltState->projOffsetY = s_rcfltState->projOffsetYBase + pitchOffset;
 			s_screenYMidFlt = s_screenYMidBase + (s32)floorf(pitchOffset);
 
 			// yMax*0.5 / halfWidth; ~pixel Aspect
-			s_rcfltState.yPlaneBot =  (s_viewHeight*0.5f - pitchOffset) / s_rcfltState.focalLenAspect;
-			s_rcfltState.yPlaneTop = -(s_viewHeight*0.5f + pitchOffset) / s_rcfltState.focalLenAspect;
+			s_rcfltState->yPlaneBot =  (s_viewHeight*0.5f - pitchOffset) / s_rcfltState->focalLenAspect;
+			s_rcfltState->yPlaneTop = -(s_viewHeight*0.5f + pitchOffset) / s_rcfltState->focalLenAspect;
 		}
 
-		s_rcfltState.cameraTrans.z = s_zOffset * s_rcfltState.cosYaw + s_xOffset * s_rcfltState.negSinYaw;
-		s_rcfltState.cameraTrans.x = s_xOffset * s_rcfltState.cosYaw + s_zOffset * s_rcfltState.sinYaw;
-		setCameraWorldPos(s_rcfltState.cameraPos.x, s_rcfltState.cameraPos.z, s_rcfltState.eyeHeight);
-		s_worldYaw = s_rcfltState.cameraYaw;
+		s_rcfltState->cameraTrans.z = s_zOffset * s_rcfltState->cosYaw + s_xOffset * s_rcfltState->negSinYaw;
+		s_rcfltState->cameraTrans.x = s_xOffset * s_rcfltState->cosYaw + s_zOffset * s_rcfltState->sinYaw;
+		setCameraWorldPos(s_rcfltState->cameraPos.x, s_rcfltState->cameraPos.z, s_rcfltState->eyeHeight);
+		s_worldYaw = s_rcfltState->cameraYaw;
 
 		// Camera Transform:
-		s_rcfltState.cameraMtx[0] = s_rcfltState.cosYaw;
-		s_rcfltState.cameraMtx[2] = s_rcfltState.negSinYaw;
-		s_rcfltState.cameraMtx[4] = 1.0f;
-		s_rcfltState.cameraMtx[6] = s_rcfltState.sinYaw;
-		s_rcfltState.cameraMtx[8] = s_rcfltState.cosYaw;
+		s_rcfltState->cameraMtx[0] = s_rcfltState->cosYaw;
+		s_rcfltState->cameraMtx[2] = s_rcfltState->negSinYaw;
+		s_rcfltState->cameraMtx[4] = 1.0f;
+		s_rcfltState->cameraMtx[6] = s_rcfltState->sinYaw;
+		s_rcfltState->cameraMtx[8] = s_rcfltState->cosYaw;
 	}
 
 	void computeSkyOffsets()
@@ -103,8 +103,8 @@ namespace RClassic_Float
 		TFE_Jedi::getSkyParallax(&parallax[0], &parallax[1]);
 
 		// angles range from -16384 to 16383; multiply by 4 to convert to [-1, 1) range.
-		s_rcfltState.skyYawOffset   = -s_rcfltState.cameraYaw   / 16384.0f * fixed16ToFloat(parallax[0]);
-		s_rcfltState.skyPitchOffset = -s_rcfltState.cameraPitch / 16384.0f * fixed16ToFloat(parallax[1]);
+		s_rcfltState->skyYawOffset   = -s_rcfltState->cameraYaw   / 16384.0f * fixed16ToFloat(parallax[0]);
+		s_rcfltState->skyPitchOffset = -s_rcfltState->cameraPitch / 16384.0f * fixed16ToFloat(parallax[1]);
 	}
 
 	void setupScreenParameters(s32 w, s32 h, s32 x0, s32 y0)
@@ -121,8 +121,8 @@ namespace RClassic_Float
 
 		s_minScreenY = y0;
 		s_maxScreenY = y0 + h - 1;
-		s_rcfltState.windowMinY = f32(y0);
-		s_rcfltState.windowMaxY = f32(y0 + h - 1);
+		s_rcfltState->windowMinY = f32(y0);
+		s_rcfltState->windowMaxY = f32(y0 + h - 1);
 
 		s_fullDetail = JTRUE;
 		s_pixelCount = w * h;
@@ -130,45 +130,45 @@ namespace RClassic_Float
 		
 	void setupProjectionParameters(f32 halfWidthFlt, s32 xc, s32 yc)
 	{
-		s_rcfltState.halfWidth = halfWidthFlt;
+		s_rcfltState->halfWidth = halfWidthFlt;
 		s_screenXMid = xc;
 		s_screenYMidFlt = yc;
 		s_screenYMidBase = yc;
 
-		s_rcfltState.projOffsetX = f32(xc);
-		s_rcfltState.projOffsetY = f32(yc);
-		s_rcfltState.projOffsetYBase = s_rcfltState.projOffsetY;
+		s_rcfltState->projOffsetX = f32(xc);
+		s_rcfltState->projOffsetY = f32(yc);
+		s_rcfltState->projOffsetYBase = s_rcfltState->projOffsetY;
 
 		s_windowX0 = s_minScreenX_Pixels;
 		s_windowX1 = s_maxScreenX_Pixels;
 
-		s_rcfltState.oneOverHalfWidth = 1.0f / halfWidthFlt;
+		s_rcfltState->oneOverHalfWidth = 1.0f / halfWidthFlt;
 
 		// TFE
-		s_rcfltState.focalLength = s_rcfltState.halfWidth;
-		s_rcfltState.focalLenAspect = s_rcfltState.halfWidth;
-		s_rcfltState.aspectScaleX = 1.0f;
-		s_rcfltState.aspectScaleY = 1.0f;
-		s_rcfltState.nearPlaneHalfLen = 1.0f;
+		s_rcfltState->focalLength = s_rcfltState->halfWidth;
+		s_rcfltState->focalLenAspect = s_rcfltState->halfWidth;
+		s_rcfltState->aspectScaleX = 1.0f;
+		s_rcfltState->aspectScaleY = 1.0f;
+		s_rcfltState->nearPlaneHalfLen = 1.0f;
 
 		if (TFE_RenderBackend::getWidescreen())
 		{
 			// 200p and 400p get special handling because they are 16:10 resolutions in 4:3.
 			if (s_height == 200 || s_height == 400)
 			{
-				s_rcfltState.focalLenAspect = (s_height == 200) ? 160.0f : 320.0f;
+				s_rcfltState->focalLenAspect = (s_height == 200) ? 160.0f : 320.0f;
 			}
 			else
 			{
-				s_rcfltState.focalLenAspect = (s_height * 4 / 3) * 0.5f;
+				s_rcfltState->focalLenAspect = (s_height * 4 / 3) * 0.5f;
 			}
 
 			const f32 aspectScale = (s_height == 200 || s_height == 400) ? (10.0f / 16.0f) : (3.0f / 4.0f);
-			s_rcfltState.nearPlaneHalfLen = aspectScale * (f32(s_width) / f32(s_height));
+			s_rcfltState->nearPlaneHalfLen = aspectScale * (f32(s_width) / f32(s_height));
 			// at low resolution, increase the nearPlaneHalfLen slightly to avoid cutting off the last column.
 			if (s_height == 200)
 			{
-				s_rcfltState.nearPlaneHalfLen += 0.001f;
+				s_rcfltState->nearPlaneHalfLen += 0.001f;
 			}
 		}
 
@@ -177,16 +177,16 @@ namespace RClassic_Float
 			// The (4/3) or (16/10) factor removes the 4:3 or 16:10 aspect ratio already factored in 's_halfWidth' 
 			// The (height/width) factor adjusts for the resolution pixel aspect ratio.
 			const f32 scaleFactor = (s_height == 200 || s_height == 400) ? (16.0f / 10.0f) : (4.0f / 3.0f);
-			s_rcfltState.focalLength = s_rcfltState.halfWidth * scaleFactor * f32(s_height) / f32(s_width);
+			s_rcfltState->focalLength = s_rcfltState->halfWidth * scaleFactor * f32(s_height) / f32(s_width);
 		}
 		if (s_height != 200 && s_height != 400)
 		{
 			// Scale factor to account for converting from rectangular pixels to square pixels when computing flat texture coordinates.
 			// Factor = (16/10) / (4/3)
-			s_rcfltState.aspectScaleX = 1.2f;
-			s_rcfltState.aspectScaleY = 1.2f;
+			s_rcfltState->aspectScaleX = 1.2f;
+			s_rcfltState->aspectScaleY = 1.2f;
 		}
-		s_rcfltState.focalLenAspect *= s_rcfltState.aspectScaleY;
+		s_rcfltState->focalLenAspect *= s_rcfltState->aspectScaleY;
 	}
 
 	void setWidthFraction(f32 widthFract)
@@ -197,8 +197,8 @@ namespace RClassic_Float
 
 	void resetState()
 	{
-		s_rcfltState.depth1d_all = nullptr;
-		s_rcfltState.skyTable = nullptr;
+		s_rcfltState->depth1d_all = nullptr;
+		s_rcfltState->skyTable = nullptr;
 	}
 
 	void buildProjectionTables(s32 xc, s32 yc, s32 w, s32 h)
@@ -210,13 +210,13 @@ namespace RClassic_Float
 		setupProjectionParameters(f32(halfWidth), xc, yc);
 		setWidthFraction(1.0f);
 
-		EdgePairFloat* flatEdge = &s_rcfltState.flatEdgeList[s_flatCount];
-		s_rcfltState.flatEdge = flatEdge;
-		flat_addEdges(s_screenWidth, s_minScreenX_Pixels, 0, s_rcfltState.windowMaxY, 0, s_rcfltState.windowMinY);
+		EdgePairFloat* flatEdge = &s_rcfltState->flatEdgeList[s_flatCount];
+		s_rcfltState->flatEdge = flatEdge;
+		flat_addEdges(s_screenWidth, s_minScreenX_Pixels, 0, s_rcfltState->windowMaxY, 0, s_rcfltState->windowMinY);
 		
 		s_columnTop = (s32*)game_realloc(s_columnTop, s_width * sizeof(s32));
 		s_columnBot = (s32*)game_realloc(s_columnBot, s_width * sizeof(s32));
-		s_rcfltState.depth1d_all = (f32*)game_realloc(s_rcfltState.depth1d_all, s_width * sizeof(f32) * (MAX_ADJOIN_DEPTH_EXT + 1));
+		s_rcfltState->depth1d_all = (f32*)game_realloc(s_rcfltState->depth1d_all, s_width * sizeof(f32) * (MAX_ADJOIN_DEPTH_EXT + 1));
 		s_windowTop_all = (s32*)game_realloc(s_windowTop_all, s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH_EXT + 1));
 		s_windowBot_all = (s32*)game_realloc(s_windowBot_all, s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH_EXT + 1));
 
@@ -224,7 +224,7 @@ namespace RClassic_Float
 		memset(s_windowBot_all, s_maxScreenY, s_width);
 
 		// Build tables
-		s_rcfltState.skyTable = (f32*)game_realloc(s_rcfltState.skyTable, (s_width + 1) * sizeof(f32));
+		s_rcfltState->skyTable = (f32*)game_realloc(s_rcfltState->skyTable, (s_width + 1) * sizeof(f32));
 	}
 
 	void computeSkyTable()
@@ -234,8 +234,8 @@ namespace RClassic_Float
 		f32 parallaxFlt = fixed16ToFloat(parallax0);
 
 		s32 xMid   = s_screenXMid;
-		f32 xScale = s_rcfltState.nearPlaneHalfLen * 2.0f / f32(s_width);
-		s_rcfltState.skyTable[0] = 0;
+		f32 xScale = s_rcfltState->nearPlaneHalfLen * 2.0f / f32(s_width);
+		s_rcfltState->skyTable[0] = 0;
 		for (s32 i = 0, x = 0; x < s_width; i++, x++)
 		{
 			f32 xOffset = f32(x - xMid);
@@ -243,7 +243,7 @@ namespace RClassic_Float
 			f32 angleFract =  angleFractF / 16384.0f;
 
 			// This intentionally overflows when x = 0 and becomes 0...
-			s_rcfltState.skyTable[1 + i] = angleFract * parallaxFlt;
+			s_rcfltState->skyTable[1 + i] = angleFract * parallaxFlt;
 		}
 	}
 
@@ -314,7 +314,7 @@ namespace RClassic_Float
 
 		TFE_Jedi::setSkyParallax(prevParallax0, prevParallax1);
 
-		setIdentityMatrix(s_rcfltState.cameraMtx);
+		setIdentityMatrix(s_rcfltState->cameraMtx);
 		computeCameraTransform(nullptr, 0, 0, 0, 0, 0);
 
 		s_lightCount = 0;
@@ -2,5 +2,6 @@
 
 namespace TFE_Jedi
 {
-	RClassicFloatState s_rcfltState = { 0 };
+	static RClassicFloatState s_rcfltMainState = { 0 };
+	thread_local RClassicFloatState* s_rcfltState = &s_rcfltMainState;
 }  // TFE_Jedi
\ No newline at end of file
@@ -52,6 +52,12 @@ namespace TFE_Jedi
 		f32 windowMinY;
 		f32 windowMaxY;
 
+		// Strip - the column range this context writes pixels to (see rstripsFloat.h).
+		s32 stripX0;
+		s32 stripX1;
+		JBool stripClip;		// JTRUE when the frame is split between multiple strips.
+		JBool stripWorker;		// JTRUE for contexts owned by strip worker threads.
+
 		// Flats
 		EdgePairFloat* flatEdge;
 		EdgePairFloat  flatEdgeList[MAX_SEG];
@@ -62,5 +68,7 @@ namespace TFE_Jedi
 		RWallSegmentFloat   wallSegListSrc[MAX_SEG];
 		RWallSegmentFloat** adjoinSegment;
 	};
-	extern RClassicFloatState s_rcfltState;
+	// The state used by the calling thread. This points to the main state except on
+	// strip worker threads, which each own a private copy.
+	extern thread_local RClassicFloatState* s_rcfltState;
 }  // TFE_Jedi
\ No newline at end of file
@@ -6,35 +6,38 @@
 #include "redgePairFloat.h"
 #include "rclassicFloat.h"
 #include "rclassicFloatSharedState.h"
+#include "rstripsFloat.h"
+#include "rsimdFloat.h"
 #include "fixedPoint20.h"
 #include "../rscanline.h"
 #include "../rsectorRender.h"
 #include "../redgePair.h"
 #include "../rcommon.h"
 #include <assert.h>
+#include <cstring>
 
 namespace TFE_Jedi
 {
 
 namespace RClassic_Float
 {
-	static s32 s_scanlineX0;
-
-	static fixed44_20 s_scanlineU0;
-	static fixed44_20 s_scanlineV0;
-	static fixed44_20 s_scanline_dUdX;
-	static fixed44_20 s_scanline_dVdX;
-
-	static s32 s_scanlineWidth;
-	static const u8* s_scanlineLight;
-	static u8* s_scanlineOut;
-
-	static u8* s_ftexImage;
-	static s32 s_ftexDataEnd;
-	static s32 s_ftexHeight;
-	static s32 s_ftexWidthMask;
-	static s32 s_ftexHeightMask;
-	static s32 s_ftexHeightLog2;
+	static thread_local s32 s_scanlineX0;
+
+	static thread_local fixed44_20 s_scanlineU0;
+	static thread_local fixed44_20 s_scanlineV0;
+	static thread_local fixed44_20 s_scanline_dUdX;
+	static thread_local fixed44_20 s_scanline_dVdX;
+
+	static thread_local s32 s_scanlineWidth;
+	static thread_local const u8* s_scanlineLight;
+	static thread_local u8* s_scanlineOut;
+
+	static thread_local u8* s_ftexImage;
+	static thread_local s32 s_ftexDataEnd;
+	static thread_local s32 s_ftexHeight;
+	static thread_local s32 s_ftexWidthMask;
+	static thread_local s32 s_ftexHeightMask;
+	static thread_local s32 s_ftexHeightLog2;
 		
 	void flat_addEdges(s32 length, s32 x0, f32 dyFloor_dx, f32 yFloor, f32 dyCeil_dx, f32 yCeil)
 	{
@@ -53,15 +56,15 @@ namespace RClassic_Float
 				yFloor1 += dyFloor_dx * lengthFlt;
 			}
 
-			edgePair_setup(length, x0, dyFloor_dx, yFloor1, yFloor, dyCeil_dx, yCeil, yCeil1, s_rcfltState.flatEdge);
+			edgePair_setup(length, x0, dyFloor_dx, yFloor1, yFloor, dyCeil_dx, yCeil, yCeil1, s_rcfltState->flatEdge);
 
-			if (s_rcfltState.flatEdge->yPixel_C1 - 1 > s_wallMaxCeilY)
+			if (s_rcfltState->flatEdge->yPixel_C1 - 1 > s_wallMaxCeilY)
 			{
-				s_wallMaxCeilY = s_rcfltState.flatEdge->yPixel_C1 - 1;
+				s_wallMaxCeilY = s_rcfltState->flatEdge->yPixel_C1 - 1;
 			}
-			if (s_rcfltState.flatEdge->yPixel_F1 + 1 < s_wallMinFloorY)
+			if (s_rcfltState->flatEdge->yPixel_F1 + 1 < s_wallMinFloorY)
 			{
-				s_wallMinFloorY = s_rcfltState.flatEdge->yPixel_F1 + 1;
+				s_wallMinFloorY = s_rcfltState->flatEdge->yPixel_F1 + 1;
 			}
 			if (s_wallMaxCeilY < s_windowMinY_Pixels)
 			{
@@ -72,7 +75,7 @@ namespace RClassic_Float
 				s_wallMinFloorY = s_windowMaxY_Pixels;
 			}
 
-			s_rcfltState.flatEdge++;
+			s_rcfltState->flatEdge++;
 			s_flatCount++;
 		}
 	}
@@ -146,6 +149,85 @@ namespace RClassic_Float
 			if (baseColor) { s_scanlineOut[i] = baseColor; }
 		}
 	}
+
+#ifdef RCLASSIC_FLOAT_SSE2
+	#define SCANLINE_LIT
+	#include "rflatFloat_ScanlineSimd.h"
+	#define SCANLINE_TRANS
+	#include "rflatFloat_ScanlineSimd.h"
+	#undef SCANLINE_LIT
+	#include "rflatFloat_ScanlineSimd.h"
+	#undef SCANLINE_TRANS
+	#include "rflatFloat_ScanlineSimd.h"
+#endif
+
+	typedef void(*ScanlineFunction)();
+	enum ScanlineFuncId
+	{
+		SCANFUNC_LIT = 0,
+		SCANFUNC_FULLBRIGHT,
+		SCANFUNC_TRANS,
+		SCANFUNC_FULLBRIGHT_TRANS,
+		SCANFUNC_COUNT
+	};
+	static const ScanlineFunction c_scanlineFuncScalar[SCANFUNC_COUNT] =
+	{
+		drawScanline,
+		drawScanline_Fullbright,
+		drawScanline_Trans,
+		drawScanline_Fullbright_Trans
+	};
+#ifdef RCLASSIC_FLOAT_SSE2
+	static const ScanlineFunction c_scanlineFuncSSE2[SCANFUNC_COUNT] =
+	{
+		drawScanline_SSE2,
+		drawScanline_Fullbright_SSE2,
+		drawScanline_Trans_SSE2,
+		drawScanline_Fullbright_Trans_SSE2
+	};
+#endif
+	// Scanline functions used to draw flats, selected by flat_setSimdKernels().
+	static ScanlineFunction s_scanlineFunc[SCANFUNC_COUNT] =
+	{
+		drawScanline,
+		drawScanline_Fullbright,
+		drawScanline_Trans,
+		drawScanline_Fullbright_Trans
+	};
+
+	void flat_setSimdKernels(JBool enable)
+	{
+	#ifdef RCLASSIC_FLOAT_SSE2
+		memcpy(s_scanlineFunc, enable ? c_scanlineFuncSSE2 : c_scanlineFuncScalar, sizeof(s_scanlineFunc));
+	#else
+		memcpy(s_scanlineFunc, c_scanlineFuncScalar, sizeof(s_scanlineFunc));
+	#endif
+	}
+
+	// When the frame is split into strips, clip the scanline to the columns owned by this context.
+	// U0/V0 are at the right end of the scanline so clipping the right side steps them forward,
+	// which matches the values the full scanline would have produced.
+	JBool flat_clipScanlineToStrip()
+	{
+		if (!s_rcfltState->stripClip) { return JTRUE; }
+
+		const s32 x1 = s_scanlineX0 + s_scanlineWidth - 1;
+		if (x1 > s_rcfltState->stripX1)
+		{
+			const s32 clip = x1 - s_rcfltState->stripX1;
+			s_scanlineU0 += fixed44_20(clip) * s_scanline_dUdX;
+			s_scanlineV0 += fixed44_20(clip) * s_scanline_dVdX;
+			s_scanlineWidth -= clip;
+		}
+		if (s_scanlineX0 < s_rcfltState->stripX0)
+		{
+			const s32 clip = s_rcfltState->stripX0 - s_scanlineX0;
+			s_scanlineX0 += clip;
+			s_scanlineOut += clip;
+			s_scanlineWidth -= clip;
+		}
+		return s_scanlineWidth > 0 ? JTRUE : JFALSE;
+	}
 			   
 	bool flat_setTexture(TextureData* tex)
 	{
@@ -163,15 +245,15 @@ namespace RClassic_Float
 	
 	void flat_drawCeiling(SectorCached* sectorCached, EdgePairFloat* edges, s32 count)
 	{
-		f32 textureOffsetU = s_rcfltState.cameraPos.x - sectorCached->ceilOffset.x;
-		f32 textureOffsetV = sectorCached->ceilOffset.z - s_rcfltState.cameraPos.z;
+		f32 textureOffsetU = s_rcfltState->cameraPos.x - sectorCached->ceilOffset.x;
+		f32 textureOffsetV = sectorCached->ceilOffset.z - s_rcfltState->cameraPos.z;
 
-		f32 relCeil          = sectorCached->ceilingHeight - s_rcfltState.eyeHeight;
-		f32 scaledRelCeil    =  relCeil * s_rcfltState.focalLenAspect;
-		f32 cosScaledRelCeil =  scaledRelCeil * s_rcfltState.cosYaw;
-		f32 negSinRelCeil    = -relCeil * s_rcfltState.sinYaw;
-		f32 sinScaledRelCeil =  scaledRelCeil * s_rcfltState.sinYaw;
-		f32 negCosRelCeil    = -relCeil * s_rcfltState.cosYaw;
+		f32 relCeil          = sectorCached->ceilingHeight - s_rcfltState->eyeHeight;
+		f32 scaledRelCeil    =  relCeil * s_rcfltState->focalLenAspect;
+		f32 cosScaledRelCeil =  scaledRelCeil * s_rcfltState->cosYaw;
+		f32 negSinRelCeil    = -relCeil * s_rcfltState->sinYaw;
+		f32 sinScaledRelCeil =  scaledRelCeil * s_rcfltState->sinYaw;
+		f32 negCosRelCeil    = -relCeil * s_rcfltState->cosYaw;
 
 		if (!flat_setTexture(*sectorCached->sector->ceilTex)) { return; }
 
@@ -200,25 +282,26 @@ namespace RClassic_Float
 					s_scanlineOut = &s_display[left + yOffset];
 
 					const f32 worldToTexelScale = 8.0f;
-					f32 rightClip = f32(right - s_screenXMid) * s_rcfltState.aspectScaleX;
+					f32 rightClip = f32(right - s_screenXMid) * s_rcfltState->aspectScaleX;
 					f32 v0 = (cosScaledRelCeil - (negSinRelCeil*rightClip)) * yRcp;
 					f32 u0 = (sinScaledRelCeil + (negCosRelCeil*rightClip)) * yRcp;
 
 					s_scanlineV0 = floatToFixed20((v0 - textureOffsetV) * worldToTexelScale);
 					s_scanlineU0 = floatToFixed20((u0 - textureOffsetU) * worldToTexelScale);
 
-					const f32 worldTexelScaleAspect = yRcp * worldToTexelScale * s_rcfltState.aspectScaleY;
+					const f32 worldTexelScaleAspect = yRcp * worldToTexelScale * s_rcfltState->aspectScaleY;
 					s_scanline_dVdX =  floatToFixed20(negSinRelCeil * worldTexelScaleAspect);
 					s_scanline_dUdX = -floatToFixed20(negCosRelCeil * worldTexelScaleAspect);
 					s_scanlineLight =  computeLighting(z, 0);
+					if (!flat_clipScanlineToStrip()) { continue; }
 					
 					if (s_scanlineLight)
 					{
-						drawScanline();
+						s_scanlineFunc[SCANFUNC_LIT]();
 					}
 					else
 					{
-						drawScanline_Fullbright();
+						s_scanlineFunc[SCANFUNC_FULLBRIGHT]();
 					}
 				}
 			} // while (i < count)
@@ -227,16 +310,16 @@ namespace RClassic_Float
 		
 	void flat_drawFloor(SectorCached* sectorCached, EdgePairFloat* edges, s32 count)
 	{
-		f32 textureOffsetU = s_rcfltState.cameraPos.x - sectorCached->floorOffset.x;
-		f32 textureOffsetV = sectorCached->floorOffset.z - s_rcfltState.cameraPos.z;
+		f32 textureOffsetU = s_rcfltState->cameraPos.x - sectorCached->floorOffset.x;
+		f32 textureOffsetV = sectorCached->floorOffset.z - s_rcfltState->cameraPos.z;
 
-		f32 relFloor       = sectorCached->floorHeight - s_rcfltState.eyeHeight;
-		f32 scaledRelFloor = relFloor * s_rcfltState.focalLenAspect;
+		f32 relFloor       = sectorCached->floorHeight - s_rcfltState->eyeHeight;
+		f32 scaledRelFloor = relFloor * s_rcfltState->focalLenAspect;
 
-		f32 cosScaledRelFloor = scaledRelFloor * s_rcfltState.cosYaw;
-		f32 negSinRelFloor    =-relFloor * s_rcfltState.sinYaw;
-		f32 sinScaledRelFloor = scaledRelFloor * s_rcfltState.sinYaw;
-		f32 negCosRelFloor    =-relFloor * s_rcfltState.cosYaw;
+		f32 cosScaledRelFloor = scaledRelFloor * s_rcfltState->cosYaw;
+		f32 negSinRelFloor    =-relFloor * s_rcfltState->sinYaw;
+		f32 sinScaledRelFloor = scaledRelFloor * s_rcfltState->sinYaw;
+		f32 negCosRelFloor    =-relFloor * s_rcfltState->cosYaw;
 
 		if (!flat_setTexture(*sectorCached->sector->floorTex)) { return; }
 
@@ -268,24 +351,25 @@ namespace RClassic_Float
 					s_scanlineOut = &s_display[left + yOffset];
 
 					const f32 worldToTexelScale = 8.0f;
-					f32 rightClip = f32(right - s_screenXMid) * s_rcfltState.aspectScaleX;
+					f32 rightClip = f32(right - s_screenXMid) * s_rcfltState->aspectScaleX;
 					f32 v0 = (cosScaledRelFloor - (negSinRelFloor * rightClip)) * yRcp;
 					f32 u0 = (sinScaledRelFloor + (negCosRelFloor * rightClip)) * yRcp;
 					s_scanlineV0 = floatToFixed20((v0 - textureOffsetV) * worldToTexelScale);
 					s_scanlineU0 = floatToFixed20((u0 - textureOffsetU) * worldToTexelScale);
 
-					const f32 worldTexelScaleAspect = yRcp * worldToTexelScale * s_rcfltState.aspectScaleY;
+					const f32 worldTexelScaleAspect = yRcp * worldToTexelScale * s_rcfltState->aspectScaleY;
 					s_scanline_dVdX =  floatToFixed20(negSinRelFloor * worldTexelScaleAspect);
 					s_scanline_dUdX = -floatToFixed20(negCosRelFloor * worldTexelScaleAspect);
 					s_scanlineLight = computeLighting(z, 0);
+					if (!flat_clipScanlineToStrip()) { continue; }
 
 					if (s_scanlineLight)
 					{
-						drawScanline();
+						s_scanlineFunc[SCANFUNC_LIT]();
 					}
 					else
 					{
-						drawScanline_Fullbright();
+						s_scanlineFunc[SCANFUNC_FULLBRIGHT]();
 					}
 				}
 			} // while (i < count)
@@ -295,36 +379,27 @@ namespace RClassic_Float
 	//////////////////////////////////////////////////////////////////////
 	// Polygon Scanline rendering using the same algorithms as flats.
 	//////////////////////////////////////////////////////////////////////
-	typedef void(*ScanlineFunction)();
-	static const ScanlineFunction c_scanlineDrawFunc[] =
-	{
-		drawScanline,
-		drawScanline_Fullbright,
-		drawScanline_Trans,
-		drawScanline_Fullbright_Trans
-	};
+	static thread_local f32 s_poly_offsetX;
+	static thread_local f32 s_poly_offsetZ;
 
-	static f32 s_poly_offsetX;
-	static f32 s_poly_offsetZ;
+	static thread_local f32 s_poly_scaledHOffset;
+	static thread_local f32 s_poly_sinYawHOffset;
+	static thread_local f32 s_poly_cosYawHOffset;
 
-	static f32 s_poly_scaledHOffset;
-	static f32 s_poly_sinYawHOffset;
-	static f32 s_poly_cosYawHOffset;
-
-	static f32 s_poly_cosYawScaledHOffset;
-	static f32 s_poly_sinYawScaledHOffset;
+	static thread_local f32 s_poly_cosYawScaledHOffset;
+	static thread_local f32 s_poly_sinYawScaledHOffset;
 		
 	void flat_preparePolygon(f32 heightOffset, f32 offsetX, f32 offsetZ, TextureData* texture)
 	{
-		s_poly_offsetX = s_rcfltState.cameraPos.x - offsetX;
-		s_poly_offsetZ = offsetZ - s_rcfltState.cameraPos.z;
+		s_poly_offsetX = s_rcfltState->cameraPos.x - offsetX;
+		s_poly_offsetZ = offsetZ - s_rcfltState->cameraPos.z;
 
-		s_poly_scaledHOffset = heightOffset * s_rcfltState.focalLenAspect;
-		s_poly_sinYawHOffset = s_rcfltState.sinYaw * heightOffset;
-		s_poly_cosYawHOffset = s_rcfltState.cosYaw * heightOffset;
+		s_poly_scaledHOffset = heightOffset * s_rcfltState->focalLenAspect;
+		s_poly_sinYawHOffset = s_rcfltState->sinYaw * heightOffset;
+		s_poly_cosYawHOffset = s_rcfltState->cosYaw * heightOffset;
 
-		s_poly_cosYawScaledHOffset = s_rcfltState.cosYaw * s_poly_scaledHOffset;
-		s_poly_sinYawScaledHOffset = s_rcfltState.sinYaw * s_poly_scaledHOffset;
+		s_poly_cosYawScaledHOffset = s_rcfltState->cosYaw * s_poly_scaledHOffset;
+		s_poly_sinYawScaledHOffset = s_rcfltState->sinYaw * s_poly_scaledHOffset;
 
 		s_ftexWidthMask  = texture->width - 1;
 		s_ftexHeightMask = texture->height - 1;
@@ -348,20 +423,84 @@ namespace RClassic_Float
 		const f32 yShear = f32(y - s_screenYMidFlt);
 		const f32 yRcp = (yShear != 0.0f) ? 1.0f/yShear : 1.0f;
 		const f32 z = s_poly_scaledHOffset * yRcp;
-		const f32 right = f32(x1 - 1 - s_screenXMid) * s_rcfltState.aspectScaleX;
+		const f32 right = f32(x1 - 1 - s_screenXMid) * s_rcfltState->aspectScaleX;
 
 		const f32 u0 = s_poly_sinYawScaledHOffset - (s_poly_cosYawHOffset*right);
 		const f32 v0 = s_poly_cosYawScaledHOffset + (s_poly_sinYawHOffset*right);
 		s_scanlineU0 = floatToFixed20((u0*yRcp - s_poly_offsetX) * 8.0f);
 		s_scanlineV0 = floatToFixed20((v0*yRcp - s_poly_offsetZ) * 8.0f);
 
-		const f32 worldTexelScaleAspect = yRcp * 8.0f * s_rcfltState.aspectScaleY;
+		const f32 worldTexelScaleAspect = yRcp * 8.0f * s_rcfltState->aspectScaleY;
 		s_scanline_dVdX = -floatToFixed20(s_poly_sinYawHOffset*worldTexelScaleAspect);
 		s_scanline_dUdX =  floatToFixed20(s_poly_cosYawHOffset*worldTexelScaleAspect);
 
 		s_scanlineLight = computeLighting(z, 0);
+		if (!flat_clipScanlineToStrip()) { return; }
+
 		const s32 index = (!s_scanlineLight) + trans*2;
-		c_scanlineDrawFunc[index]();
+		s_scanlineFunc[index]();
+	}
+
+	s32 flat_compareSimdKernels(s32 count, u32* seed)
+	{
+	#ifdef RCLASSIC_FLOAT_SSE2
+		static u8 texture[64 * 64];
+		static u8 light[256];
+		static u8 scalarOut[1024];
+		static u8 simdOut[1024];
+		for (s32 i = 0; i < 64 * 64; i++)
+		{
+			// Include plenty of transparent texels.
+			texture[i] = (simd_random(seed) & 3) ? u8(simd_random(seed)) : 0;
+		}
+		for (s32 i = 0; i < 256; i++)
+		{
+			light[i] = u8(simd_random(seed));
+		}
+
+		s32 failCount = 0;
+		for (s32 n = 0; n < count; n++)
+		{
+			const s32 width = 1 + simd_random(seed) % 1024;
+			const s32 log2Size = 3 + simd_random(seed) % 4;
+			const fixed44_20 u0 = (fixed44_20(simd_random(seed)) << 24) ^ fixed44_20(simd_random(seed));
+			const fixed44_20 v0 = (fixed44_20(simd_random(seed)) << 24) ^ fixed44_20(simd_random(seed));
+			// Steps up to +/- 8 texels per pixel, occasionally large enough to wrap the low 32 bits.
+			const fixed44_20 dUdX = (simd_random(seed) & 15) ? fixed44_20(simd_random(seed) % (16 << 20)) - (8 << 20) : fixed44_20(s32(simd_random(seed) << 8)) * 64;
+			const fixed44_20 dVdX = (simd_random(seed) & 15) ? fixed44_20(simd_random(seed) % (16 << 20)) - (8 << 20) : fixed44_20(s32(simd_random(seed) << 8)) * 64;
+
+			for (s32 f = 0; f < SCANFUNC_COUNT; f++)
+			{
+				for (s32 i = 0; i < width; i++)
+				{
+					scalarOut[i] = u8(simd_random(seed));
+				}
+				memcpy(simdOut, scalarOut, width);
+
+				s_ftexImage = texture;
+				s_ftexDataEnd = (1 << (2 * log2Size)) - 1;
+				s_scanlineLight = light;
+				s_scanlineWidth = width;
+				s_scanlineU0 = u0;
+				s_scanlineV0 = v0;
+				s_scanline_dUdX = dUdX;
+				s_scanline_dVdX = dVdX;
+
+				s_scanlineOut = scalarOut;
+				c_scanlineFuncScalar[f]();
+				s_scanlineOut = simdOut;
+				c_scanlineFuncSSE2[f]();
+
+				if (memcmp(scalarOut, simdOut, width) != 0)
+				{
+					failCount++;
+				}
+			}
+		}
+		return failCount;
+	#else
+		return 0;
+	#endif
 	}
 
 }  // RFlatFixed
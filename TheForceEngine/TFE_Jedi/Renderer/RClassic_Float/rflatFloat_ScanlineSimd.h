@@ -0,0 +1,91 @@
+//////////////////////////////////////////////////////////////////////
+// SSE2 scanline drawing, matches the scalar drawScanline*() functions.
+// This is included once per variant, based on SCANLINE_LIT and
+// SCANLINE_TRANS.
+//////////////////////////////////////////////////////////////////////
+#if defined(SCANLINE_LIT) && defined(SCANLINE_TRANS)
+void drawScanline_Trans_SSE2()
+#elif defined(SCANLINE_LIT)
+void drawScanline_SSE2()
+#elif defined(SCANLINE_TRANS)
+void drawScanline_Fullbright_Trans_SSE2()
+#else
+void drawScanline_Fullbright_SSE2()
+#endif
+{
+	const fixed44_20 dVdX = s_scanline_dVdX;
+	const fixed44_20 dUdX = s_scanline_dUdX;
+	fixed44_20 V = s_scanlineV0;
+	fixed44_20 U = s_scanlineU0;
+	s32 i = s_scanlineWidth - 1;
+
+	// Only bits 20 - 25 of U and V select the texel, so stepping the low 32 bits of
+	// each coordinate in the lanes produces the same texels as the 64 bit loop.
+	const u32 dU = u32(dUdX);
+	const u32 dV = u32(dVdX);
+	const __m128i uLane = _mm_setr_epi32(0, s32(dU), s32(dU * 2u), s32(dU * 3u));
+	const __m128i vLane = _mm_setr_epi32(0, s32(dV), s32(dV * 2u), s32(dV * 3u));
+	const __m128i uStep = _mm_set1_epi32(s32(dU * 4u));
+	const __m128i vStep = _mm_set1_epi32(s32(dV * 4u));
+	const __m128i uMask = _mm_set1_epi32(63 << 6);
+	const __m128i vMask = _mm_set1_epi32(63);
+	const __m128i dataEnd = _mm_set1_epi32(s_ftexDataEnd);
+
+	// 16 pixels at a time, right to left like the scalar loop.
+	for (; i >= 15; i -= 16, U += dUdX * 16, V += dVdX * 16)
+	{
+		u32 texel[16];
+		__m128i u = _mm_add_epi32(_mm_set1_epi32(s32(U)), uLane);
+		__m128i v = _mm_add_epi32(_mm_set1_epi32(s32(V)), vLane);
+		for (s32 k = 0; k < 16; k += 4, u = _mm_add_epi32(u, uStep), v = _mm_add_epi32(v, vStep))
+		{
+			const __m128i uTexel = _mm_and_si128(_mm_srli_epi32(u, 14), uMask);
+			const __m128i vTexel = _mm_and_si128(_mm_srli_epi32(v, 20), vMask);
+			_mm_storeu_si128((__m128i*)&texel[k], _mm_and_si128(_mm_or_si128(uTexel, vTexel), dataEnd));
+		}
+
+		// Texel j is drawn at pixel (i - j), so reverse the order to get screen order.
+		u8 baseColor[16];
+		for (s32 j = 0; j < 16; j++)
+		{
+			baseColor[15 - j] = s_ftexImage[texel[j]];
+		}
+	#ifdef SCANLINE_LIT
+		u8 color[16];
+		for (s32 j = 0; j < 16; j++)
+		{
+			color[j] = s_scanlineLight[baseColor[j]];
+		}
+	#else
+		const u8* color = baseColor;
+	#endif
+
+		u8* out = &s_scanlineOut[i - 15];
+		const __m128i result = _mm_loadu_si128((const __m128i*)color);
+	#ifdef SCANLINE_TRANS
+		// Keep the existing pixels where the base color is 0.
+		const __m128i transparent = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)baseColor), _mm_setzero_si128());
+		const __m128i existing = _mm_loadu_si128((const __m128i*)out);
+		_mm_storeu_si128((__m128i*)out, _mm_or_si128(_mm_and_si128(transparent, existing), _mm_andnot_si128(transparent, result)));
+	#else
+		_mm_storeu_si128((__m128i*)out, result);
+	#endif
+	}
+
+	// Remaining pixels.
+	for (; i >= 0; i--, U += dUdX, V += dVdX)
+	{
+		const u32 texel = ((floor20(U) & 63) * 64 + (floor20(V) & 63)) & s_ftexDataEnd;
+	#if defined(SCANLINE_LIT) && defined(SCANLINE_TRANS)
+		const u8 baseColor = s_ftexImage[texel];
+		if (baseColor) { s_scanlineOut[i] = s_scanlineLight[baseColor]; }
+	#elif defined(SCANLINE_LIT)
+		s_scanlineOut[i] = s_scanlineLight[s_ftexImage[texel]];
+	#elif defined(SCANLINE_TRANS)
+		const u8 baseColor = s_ftexImage[texel];
+		if (baseColor) { s_scanlineOut[i] = baseColor; }
+	#else
+		s_scanlineOut[i] = s_ftexImage[texel];
+	#endif
+	}
+}
@@ -12,6 +12,7 @@
 #include "robj3dFloat_Clipping.h"
 #include "robj3dFloat_PolygonDraw.h"
 #include "../rclassicFloatSharedState.h"
+#include "../rstripsFloat.h"
 #include "../../rcommon.h"
 
 namespace TFE_Jedi
@@ -84,8 +85,8 @@ namespace RClassic_Float
 			const f32 z = vertex->z;
 			if (z <= 1.0f) { continue; }
 
-			const s32 pixel_x = roundFloat((vertex->x*s_rcfltState.focalLength)    / z + s_rcfltState.projOffsetX);
-			const s32 pixel_y = roundFloat((vertex->y*s_rcfltState.focalLenAspect) / z + s_rcfltState.projOffsetY);
+			const s32 pixel_x = roundFloat((vertex->x*s_rcfltState->focalLength)    / z + s_rcfltState->projOffsetX);
+			const s32 pixel_y = roundFloat((vertex->y*s_rcfltState->focalLenAspect) / z + s_rcfltState->projOffsetY);
 
 			// If the X position is out of view, skip the vertex.
 			if (pixel_x < s_minScreenX_Pixels || pixel_x > s_maxScreenX_Pixels)
@@ -93,7 +94,7 @@ namespace RClassic_Float
 				continue;
 			}
 			// Check the 1d depth buffer and Y positon and skip if occluded.
-			if (z >= s_rcfltState.depth1d[pixel_x] || pixel_y > s_windowMaxY_Pixels || pixel_y < s_windowMinY_Pixels || pixel_y < s_windowTop[pixel_x] || pixel_y > s_windowBot[pixel_x])
+			if (z >= s_rcfltState->depth1d[pixel_x] || pixel_y > s_windowMaxY_Pixels || pixel_y < s_windowMinY_Pixels || pixel_y < s_windowTop[pixel_x] || pixel_y > s_windowBot[pixel_x])
 			{
 				continue;
 			}
@@ -102,6 +103,7 @@ namespace RClassic_Float
 			{
 				const s32 x = clamp(pixel_x - halfSize + (i % size), s_minScreenX_Pixels, s_maxScreenX_Pixels);
 				const s32 y = clamp(pixel_y - halfSize + (i / size), s_windowMinY_Pixels, s_windowMaxY_Pixels);
+				if (!strip_ownsColumn(x)) { continue; }
 				s_display[y*s_width + x] = color;
 			}
 		}
@@ -113,8 +115,8 @@ namespace RClassic_Float
 		{
 			const f32 rcpZ = 1.0f / pos->z;
 
-			out->x = (f32)roundFloat((pos->x*s_rcfltState.focalLength)   *rcpZ + s_rcfltState.projOffsetX);
-			out->y = (f32)roundFloat((pos->y*s_rcfltState.focalLenAspect)*rcpZ + s_rcfltState.projOffsetY);
+			out->x = (f32)roundFloat((pos->x*s_rcfltState->focalLength)   *rcpZ + s_rcfltState->projOffsetX);
+			out->y = (f32)roundFloat((pos->y*s_rcfltState->focalLenAspect)*rcpZ + s_rcfltState->projOffsetY);
 			out->z = pos->z;
 		}
 	}
@@ -123,7 +125,7 @@ namespace RClassic_Float
 	{
 		JmPolygon* p0 = *((JmPolygon**)r0);
 		JmPolygon* p1 = *((JmPolygon**)r1);
-		return signZero(p1->zAvef - p0->zAvef);
+		return signZero(s_polygonZAve[p1->index] - s_polygonZAve[p0->index]);
 	}
 
 }}  // TFE_Jedi
\ No newline at end of file
@@ -19,7 +19,7 @@ namespace RClassic_Float
 	};
 
 	// List of potentially visible polygons (after backface culling).
-	JmPolygon* s_visPolygons[MAX_POLYGON_COUNT_3DO];
+	thread_local JmPolygon* s_visPolygons[MAX_POLYGON_COUNT_3DO];
 
 	s32 getPolygonFacing(const vec3_float* normal, const vec3_float* pos)
 	{
@@ -32,7 +32,9 @@ namespace RClassic_Float
 		vec3_float* polygonNormal = s_polygonNormalsVS;
 		s32 polygonCount = model->polygonCount;
 		JmPolygon* polygon = model->polygons;
-		for (s32 i = 0; i < polygonCount; i++, polygonNormal++, polygon++)
+		// The SIMD transform has already done this step and computed the facing.
+		const JBool facingReady = s_polygonFacingReady;
+		for (s32 i = 0; i < polygonCount && !facingReady; i++, polygonNormal++, polygon++)
 		{
 			vec3_float* vertex = &s_verticesVS[polygon->indices[1]];
 			polygonNormal->x -= vertex->x;
@@ -47,9 +49,16 @@ namespace RClassic_Float
 		polygonNormal = s_polygonNormalsVS;
 		for (s32 i = 0; i < model->polygonCount; i++, polygon++, polygonNormal++)
 		{
-			vec3_float* pos = &s_verticesVS[polygon->indices[1]];
-			s32 facing = getPolygonFacing(polygonNormal, pos);
-			if (facing == POLYGON_BACK_FACING) { continue; }
+			if (facingReady)
+			{
+				if (s_polygonBackFacing[i]) { continue; }
+			}
+			else
+			{
+				vec3_float* pos = &s_verticesVS[polygon->indices[1]];
+				s32 facing = getPolygonFacing(polygonNormal, pos);
+				if (facing == POLYGON_BACK_FACING) { continue; }
+			}
 
 			visPolygonCount++;
 			s32 vertexCount = polygon->vertexCount;
@@ -61,7 +70,8 @@ namespace RClassic_Float
 				zAve += s_verticesVS[indices[v]].z;
 			}
 
-			polygon->zAvef = zAve / f32(vertexCount);
+			// Store the depth per-thread rather than in the shared model data.
+			s_polygonZAve[polygon->index] = zAve / f32(vertexCount);
 			*visPolygon = polygon;
 			visPolygon++;
 		}
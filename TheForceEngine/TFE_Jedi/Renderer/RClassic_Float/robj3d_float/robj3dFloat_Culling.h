@@ -10,7 +10,7 @@ namespace TFE_Jedi
 {
 	namespace RClassic_Float
 	{
-		extern JmPolygon* s_visPolygons[MAX_POLYGON_COUNT_3DO];
+		extern thread_local JmPolygon* s_visPolygons[MAX_POLYGON_COUNT_3DO];
 		s32 robj3d_backfaceCull(JediModel* model);
 	}
 }
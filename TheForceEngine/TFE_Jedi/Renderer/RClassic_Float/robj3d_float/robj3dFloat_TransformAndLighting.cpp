@@ -1,9 +1,12 @@
+#include <cstring>
 #include <TFE_System/profiler.h>
 #include <TFE_Jedi/Level/robject.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include "robj3dFloat_TransformAndLighting.h"
+#include "robj3dFloat_Culling.h"
 #include "../rclassicFloatSharedState.h"
 #include "../rlightingFloat.h"
+#include "../rsimdFloat.h"
 #include "../../rcommon.h"
 
 namespace TFE_Jedi
@@ -20,16 +23,29 @@ namespace RClassic_Float
 	// Vertex Processing
 	/////////////////////////////////////////////
 	// Vertex attributes transformed to viewspace.
-	vec3_float s_verticesVS[MAX_VERTEX_COUNT_3DO];
-	vec3_float s_vertexNormalsVS[MAX_VERTEX_COUNT_3DO];
+	thread_local vec3_float s_verticesVS[MAX_VERTEX_COUNT_3DO];
+	thread_local vec3_float s_vertexNormalsVS[MAX_VERTEX_COUNT_3DO];
 	// Vertex Lighting.
-	f32 s_vertexIntensity[MAX_VERTEX_COUNT_3DO];
+	thread_local f32 s_vertexIntensity[MAX_VERTEX_COUNT_3DO];
 
 	/////////////////////////////////////////////
 	// Polygon Processing
 	/////////////////////////////////////////////
 	// Polygon normals in viewspace (used for culling).
-	vec3_float s_polygonNormalsVS[MAX_POLYGON_COUNT_3DO];
+	thread_local vec3_float s_polygonNormalsVS[MAX_POLYGON_COUNT_3DO];
+	// Average polygon depth in viewspace (used for sorting and flat shading).
+	thread_local f32 s_polygonZAve[MAX_POLYGON_COUNT_3DO];
+	// Set when the SIMD path has already made the polygon normals relative and computed facing.
+	thread_local JBool s_polygonFacingReady = JFALSE;
+	thread_local u8 s_polygonBackFacing[MAX_POLYGON_COUNT_3DO];
+
+	// Selected by robj3d_setSimdKernels().
+	static JBool s_simdTransform = JFALSE;
+#ifdef RCLASSIC_FLOAT_SSE2
+	// Structure-of-arrays copies of the view space vertices and vertex normals, used by the SIMD lighting kernel.
+	thread_local f32 s_verticesVS_SoA[JM_SOA_STRIDE(MAX_VERTEX_COUNT_3DO) * 3];
+	thread_local f32 s_vertexNormalsVS_SoA[JM_SOA_STRIDE(MAX_VERTEX_COUNT_3DO) * 3];
+#endif
 			
 	void robj3d_transformVertices(s32 vertexCount, vec3_fixed* vtxIn, f32* xform, vec3_float* offset, vec3_float* vtxOut)
 	{
@@ -139,36 +155,451 @@ namespace RClassic_Float
 		}
 	}
 		
-	void robj3d_transformAndLight(SecObject* obj, JediModel* model)
+	void robj3d_transformAndLightScalar(JediModel* model, f32* xform, vec3_float* offsetVS)
 	{
-		vec3_float offsetWS;
-		offsetWS.x = fixed16ToFloat(obj->posWS.x) - s_rcfltState.cameraPos.x;
-		offsetWS.y = fixed16ToFloat(obj->posWS.y) - s_rcfltState.eyeHeight;
-		offsetWS.z = fixed16ToFloat(obj->posWS.z) - s_rcfltState.cameraPos.z;
-
-		// Calculate the view space object camera offset.
-		vec3_float offsetVS;
-		rotateVectorM3x3(&offsetWS, &offsetVS, s_rcfltState.cameraMtx);
-
-		// Concatenate the camera and object rotation matrices.
-		f32 xform[9];
-		robj3d_mulMatrix3x3(s_rcfltState.cameraMtx, obj->transform, xform);
+		s_polygonFacingReady = JFALSE;
 
 		// Transform model vertices into view space.
-		robj3d_transformVertices(model->vertexCount, (vec3_fixed*)model->vertices, xform, &offsetVS, s_verticesVS);
+		robj3d_transformVertices(model->vertexCount, (vec3_fixed*)model->vertices, xform, offsetVS, s_verticesVS);
 
 		// No need for polygon normals or lighting if MFLAG_DRAW_VERTICES is set.
 		if (model->flags & MFLAG_DRAW_VERTICES) { return; }
 
 		// Polygon normals (used for backface culling)
-		robj3d_transformVertices(model->polygonCount, (vec3_fixed*)model->polygonNormals, xform, &offsetVS, s_polygonNormalsVS);
+		robj3d_transformVertices(model->polygonCount, (vec3_fixed*)model->polygonNormals, xform, offsetVS, s_polygonNormalsVS);
 
 		// Lighting
 		if (model->flags & MFLAG_VERTEX_LIT)
 		{
-			robj3d_transformVertices(model->vertexCount, (vec3_fixed*)model->vertexNormals, xform, &offsetVS, s_vertexNormalsVS);
+			robj3d_transformVertices(model->vertexCount, (vec3_fixed*)model->vertexNormals, xform, offsetVS, s_vertexNormalsVS);
 			robj3d_shadeVertices(model->vertexCount, s_vertexIntensity, s_verticesVS, s_vertexNormalsVS);
 		}
 	}
 
+#ifdef RCLASSIC_FLOAT_SSE2
+	///////////////////////////////////////////////////////////
+	// SSE2 kernels
+	// These work on 4 vertices at a time from the SoA copies
+	// built at load time and use the same operations in the
+	// same order as the scalar code, so the results match.
+	///////////////////////////////////////////////////////////
+	// Write 4 vectors as 4 consecutive vec3_float (12 floats).
+	static inline void simd_storeVec3x4(f32* out, __m128 x, __m128 y, __m128 z)
+	{
+		const __m128 xy01 = _mm_unpacklo_ps(x, y);										// x0 y0 x1 y1
+		const __m128 xy23 = _mm_unpackhi_ps(x, y);										// x2 y2 x3 y3
+		const __m128 t0 = _mm_shuffle_ps(z, xy01, _MM_SHUFFLE(2, 2, 0, 0));				// z0 z0 x1 x1
+		const __m128 t1 = _mm_shuffle_ps(xy01, z, _MM_SHUFFLE(1, 1, 3, 3));				// y1 y1 z1 z1
+		const __m128 t2 = _mm_shuffle_ps(z, xy23, _MM_SHUFFLE(3, 2, 3, 2));				// z2 z3 x3 y3
+		_mm_storeu_ps(out + 0, _mm_shuffle_ps(xy01, t0, _MM_SHUFFLE(2, 0, 1, 0)));		// x0 y0 z0 x1
+		_mm_storeu_ps(out + 4, _mm_shuffle_ps(t1, xy23, _MM_SHUFFLE(1, 0, 2, 0)));		// y1 z1 x2 y2
+		_mm_storeu_ps(out + 8, _mm_shuffle_ps(t2, t2, _MM_SHUFFLE(1, 3, 2, 0)));		// z2 x3 y3 z3
+	}
+
+	// Store 4 vectors to 'out[index]', only writing the first 'count' entries.
+	static inline void simd_storeVec3(vec3_float* out, s32 count, __m128 x, __m128 y, __m128 z)
+	{
+		if (count >= 4)
+		{
+			simd_storeVec3x4(&out->x, x, y, z);
+			return;
+		}
+		f32 tmp[12];
+		simd_storeVec3x4(tmp, x, y, z);
+		memcpy(out, tmp, count * sizeof(vec3_float));
+	}
+
+	struct SimdXform
+	{
+		__m128 m[9];
+		__m128 offset[3];
+	};
+
+	static inline void simd_setupXform(SimdXform* simdXform, const f32* xform, const vec3_float* offset)
+	{
+		for (s32 i = 0; i < 9; i++)
+		{
+			simdXform->m[i] = _mm_set1_ps(xform[i]);
+		}
+		simdXform->offset[0] = _mm_set1_ps(offset->x);
+		simdXform->offset[1] = _mm_set1_ps(offset->y);
+		simdXform->offset[2] = _mm_set1_ps(offset->z);
+	}
+
+	static inline void simd_transform(const SimdXform* xf, const f32* soa, s32 stride, s32 index, __m128* x, __m128* y, __m128* z)
+	{
+		const __m128 vx = _mm_loadu_ps(soa + index);
+		const __m128 vy = _mm_loadu_ps(soa + stride + index);
+		const __m128 vz = _mm_loadu_ps(soa + stride * 2 + index);
+		*x = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, xf->m[0]), _mm_mul_ps(vy, xf->m[3])), _mm_mul_ps(vz, xf->m[6])), xf->offset[0]);
+		*y = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, xf->m[1]), _mm_mul_ps(vy, xf->m[4])), _mm_mul_ps(vz, xf->m[7])), xf->offset[1]);
+		*z = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, xf->m[2]), _mm_mul_ps(vy, xf->m[5])), _mm_mul_ps(vz, xf->m[8])), xf->offset[2]);
+	}
+
+	// Transform to view space, optionally keeping an SoA copy of the result.
+	void robj3d_transformVertices_SSE2(s32 count, const f32* soaIn, const SimdXform* xf, vec3_float* vtxOut, f32* soaOut)
+	{
+		const s32 stride = JM_SOA_STRIDE(count);
+		for (s32 v = 0; v < count; v += 4)
+		{
+			__m128 x, y, z;
+			simd_transform(xf, soaIn, stride, v, &x, &y, &z);
+			simd_storeVec3(&vtxOut[v], count - v, x, y, z);
+			if (soaOut)
+			{
+				_mm_storeu_ps(soaOut + v, x);
+				_mm_storeu_ps(soaOut + stride + v, y);
+				_mm_storeu_ps(soaOut + stride * 2 + v, z);
+			}
+		}
+	}
+
+	// Transform the polygon normals, make them relative to the second polygon vertex (as robj3d_backfaceCull() would)
+	// and compute the polygon facing while the values are still in registers.
+	void robj3d_transformPolygonNormals_SSE2(const JediModel* model, const SimdXform* xf)
+	{
+		const s32 count = model->polygonCount;
+		const s32 stride = JM_SOA_STRIDE(count);
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		const __m128 zero = _mm_setzero_ps();
+
+		const JmPolygon* polygon = model->polygons;
+		for (s32 p = 0; p < count; p += 4, polygon += 4)
+		{
+			__m128 nx, ny, nz;
+			simd_transform(xf, model->polygonNormalsSoA, stride, p, &nx, &ny, &nz);
+
+			// Gather the polygon positions.
+			const s32 laneCount = min(4, count - p);
+			f32 pos[3][4] = { 0 };
+			for (s32 i = 0; i < laneCount; i++)
+			{
+				const vec3_float* vertex = &s_verticesVS[polygon[i].indices[1]];
+				pos[0][i] = vertex->x;
+				pos[1][i] = vertex->y;
+				pos[2][i] = vertex->z;
+			}
+			const __m128 px = _mm_loadu_ps(pos[0]);
+			const __m128 py = _mm_loadu_ps(pos[1]);
+			const __m128 pz = _mm_loadu_ps(pos[2]);
+			nx = _mm_sub_ps(nx, px);
+			ny = _mm_sub_ps(ny, py);
+			nz = _mm_sub_ps(nz, pz);
+			simd_storeVec3(&s_polygonNormalsVS[p], laneCount, nx, ny, nz);
+
+			// Back facing if dot(normal, -pos) < 0, see getPolygonFacing().
+			const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_xor_ps(px, signMask)), _mm_mul_ps(ny, _mm_xor_ps(py, signMask))), _mm_mul_ps(nz, _mm_xor_ps(pz, signMask)));
+			const s32 backFacing = _mm_movemask_ps(_mm_cmplt_ps(d, zero));
+			for (s32 i = 0; i < laneCount; i++)
+			{
+				s_polygonBackFacing[p + i] = (backFacing >> i) & 1;
+			}
+		}
+		s_polygonFacingReady = JTRUE;
+	}
+
+	// Select 'b' where 'mask' is set, otherwise 'a'.
+	static inline __m128 simd_select(__m128 mask, __m128 a, __m128 b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+	}
+
+	// See robj3d_shadeVertices(), the inputs are the SoA view space vertices and normals.
+	void robj3d_shadeVertices_SSE2(s32 vertexCount, f32* outShading, const f32* vertices, const f32* normals)
+	{
+		if (s_sectorAmbient >= 31)
+		{
+			for (s32 i = 0; i < vertexCount; i++)
+			{
+				outShading[i] = VSHADE_MAX_INTENSITY_FLT;
+			}
+			return;
+		}
+
+		const s32 stride = JM_SOA_STRIDE(vertexCount);
+		const JBool lightSource = (s_worldAmbient < 31 || s_cameraLightSource) ? JTRUE : JFALSE;
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 ambientFraction = _mm_set1_ps(fixed16ToFloat(s_sectorAmbientFraction));
+		const __m128 sectorAmbient = _mm_set1_ps(f32(s_sectorAmbient));
+		const __m128 scaledAmbient = _mm_set1_ps(f32(s_scaledAmbient));
+		const __m128 maxIntensity = _mm_set1_ps(VSHADE_MAX_INTENSITY_FLT);
+		const __m128 depthScale = _mm_set1_ps(4.0f);
+		// Scaling by a power of 2 is exact, so these match the divides in the scalar code.
+		const __m128 falloffScale0 = _mm_set1_ps(1.0f / 16.0f);
+		const __m128 falloffScale1 = _mm_set1_ps(1.0f / 32.0f);
+		const __m128i maxDepth = _mm_set1_epi32(127);
+		const __m128i lightSourceBase = _mm_set1_epi32(MAX_LIGHT_LEVEL + s_worldAmbient);
+		const __m128i zeroInt = _mm_setzero_si128();
+
+		for (s32 v = 0; v < vertexCount; v += 4)
+		{
+			const __m128 vx = _mm_loadu_ps(vertices + v);
+			const __m128 vy = _mm_loadu_ps(vertices + stride + v);
+			const __m128 vz = _mm_loadu_ps(vertices + stride * 2 + v);
+			const __m128 nx = _mm_sub_ps(_mm_loadu_ps(normals + v), vx);
+			const __m128 ny = _mm_sub_ps(_mm_loadu_ps(normals + stride + v), vy);
+			const __m128 nz = _mm_sub_ps(_mm_loadu_ps(normals + stride * 2 + v), vz);
+
+			// Lighting
+			__m128 lightIntensity = zero;
+			for (s32 i = 0; i < s_lightCount; i++)
+			{
+				const CameraLightFlt* light = &s_cameraLight[i];
+				const __m128 dx = _mm_sub_ps(_mm_add_ps(vx, _mm_set1_ps(light->lightVS.x)), vx);
+				const __m128 dy = _mm_sub_ps(_mm_add_ps(vy, _mm_set1_ps(light->lightVS.y)), vy);
+				const __m128 dz = _mm_sub_ps(_mm_add_ps(vz, _mm_set1_ps(light->lightVS.z)), vz);
+				const __m128 I = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, dx), _mm_mul_ps(ny, dy)), _mm_mul_ps(nz, dz));
+
+				const __m128 sourceIntensity = _mm_set1_ps(VSHADE_MAX_INTENSITY_FLT * light->brightness);
+				lightIntensity = simd_select(_mm_cmpgt_ps(I, zero), lightIntensity, _mm_add_ps(lightIntensity, _mm_mul_ps(I, sourceIntensity)));
+			}
+			__m128 intensity = _mm_add_ps(zero, _mm_mul_ps(lightIntensity, ambientFraction));
+
+			// Distance falloff
+			const __m128 z = _mm_max_ps(zero, vz);
+			if (lightSource)
+			{
+				// SSE2 has no 32-bit integer min.
+				__m128i depthScaled = _mm_cvttps_epi32(_mm_mul_ps(z, depthScale));
+				const __m128i clampMask = _mm_cmpgt_epi32(depthScaled, maxDepth);
+				depthScaled = _mm_or_si128(_mm_and_si128(clampMask, maxDepth), _mm_andnot_si128(clampMask, depthScaled));
+
+				s32 depth[4];
+				_mm_storeu_si128((__m128i*)depth, depthScaled);
+				const __m128i ramp = _mm_setr_epi32(s_lightSourceRamp[depth[0]], s_lightSourceRamp[depth[1]], s_lightSourceRamp[depth[2]], s_lightSourceRamp[depth[3]]);
+				const __m128i lightLevel = _mm_sub_epi32(lightSourceBase, ramp);
+				intensity = simd_select(_mm_castsi128_ps(_mm_cmpgt_epi32(lightLevel, zeroInt)), intensity, _mm_add_ps(intensity, _mm_cvtepi32_ps(lightLevel)));
+			}
+			intensity = _mm_max_ps(intensity, sectorAmbient);
+
+			const __m128i falloff = _mm_add_epi32(_mm_cvttps_epi32(_mm_mul_ps(z, falloffScale0)), _mm_cvttps_epi32(_mm_mul_ps(z, falloffScale1)));
+			intensity = _mm_max_ps(_mm_sub_ps(intensity, _mm_cvtepi32_ps(falloff)), scaledAmbient);
+			intensity = _mm_min_ps(_mm_max_ps(intensity, zero), maxIntensity);
+
+			if (vertexCount - v >= 4)
+			{
+				_mm_storeu_ps(outShading + v, intensity);
+			}
+			else
+			{
+				f32 tmp[4];
+				_mm_storeu_ps(tmp, intensity);
+				memcpy(outShading + v, tmp, (vertexCount - v) * sizeof(f32));
+			}
+		}
+	}
+
+	void robj3d_transformAndLight_SSE2(JediModel* model, f32* xform, vec3_float* offsetVS)
+	{
+		SimdXform xf;
+		simd_setupXform(&xf, xform, offsetVS);
+
+		const JBool vertexLit = (model->flags & MFLAG_VERTEX_LIT) && !(model->flags & MFLAG_DRAW_VERTICES) ? JTRUE : JFALSE;
+		robj3d_transformVertices_SSE2(model->vertexCount, model->verticesSoA, &xf, s_verticesVS, vertexLit ? s_verticesVS_SoA : nullptr);
+
+		s_polygonFacingReady = JFALSE;
+		if (model->flags & MFLAG_DRAW_VERTICES) { return; }
+
+		// Polygon normals and facing (used for backface culling)
+		robj3d_transformPolygonNormals_SSE2(model, &xf);
+
+		// Lighting
+		if (vertexLit)
+		{
+			robj3d_transformVertices_SSE2(model->vertexCount, model->vertexNormalsSoA, &xf, s_vertexNormalsVS, s_vertexNormalsVS_SoA);
+			robj3d_shadeVertices_SSE2(model->vertexCount, s_vertexIntensity, s_verticesVS_SoA, s_vertexNormalsVS_SoA);
+		}
+	}
+
+	// The SoA copies are only missing if the allocation failed.
+	static JBool robj3d_hasSoA(const JediModel* model)
+	{
+		if (!model->verticesSoA && model->vertexCount > 0) { return JFALSE; }
+		if (!model->polygonNormalsSoA && model->polygonCount > 0) { return JFALSE; }
+		if (!model->vertexNormalsSoA && (model->flags & MFLAG_VERTEX_LIT) && model->vertexCount > 0) { return JFALSE; }
+		return JTRUE;
+	}
+
+	static fixed16_16 simd_randomFixed(u32* seed, s32 range)
+	{
+		return fixed16_16(simd_random(seed) % u32(2 * range)) - range;
+	}
+
+	static void simd_randomVec3(u32* seed, s32 range, vec3* out)
+	{
+		out->x = simd_randomFixed(seed, range);
+		out->y = simd_randomFixed(seed, range);
+		out->z = simd_randomFixed(seed, range);
+	}
+
+	// Results from one path, compared with memcmp().
+	struct Obj3dTestResult
+	{
+		vec3_float vertices[MAX_VERTEX_COUNT_3DO];
+		vec3_float polygonNormals[MAX_POLYGON_COUNT_3DO];
+		f32 intensity[MAX_VERTEX_COUNT_3DO];
+		f32 zAve[MAX_POLYGON_COUNT_3DO];
+		JmPolygon* visPolygons[MAX_POLYGON_COUNT_3DO];
+		s32 visCount;
+	};
+
+	static void robj3d_captureTestResult(JediModel* model, Obj3dTestResult* result)
+	{
+		memset(result, 0, sizeof(Obj3dTestResult));
+		memcpy(result->vertices, s_verticesVS, model->vertexCount * sizeof(vec3_float));
+		if (model->flags & MFLAG_VERTEX_LIT)
+		{
+			memcpy(result->intensity, s_vertexIntensity, model->vertexCount * sizeof(f32));
+		}
+		result->visCount = robj3d_backfaceCull(model);
+		memcpy(result->polygonNormals, s_polygonNormalsVS, model->polygonCount * sizeof(vec3_float));
+		memcpy(result->visPolygons, s_visPolygons, result->visCount * sizeof(JmPolygon*));
+		for (s32 i = 0; i < result->visCount; i++)
+		{
+			result->zAve[i] = s_polygonZAve[s_visPolygons[i]->index];
+		}
+	}
+#endif
+
+	s32 robj3d_compareSimdKernels(s32 count, u32* seed)
+	{
+	#ifdef RCLASSIC_FLOAT_SSE2
+		static vec3 vertices[MAX_VERTEX_COUNT_3DO];
+		static vec3 vertexNormals[MAX_VERTEX_COUNT_3DO];
+		static vec3 polygonNormals[MAX_POLYGON_COUNT_3DO];
+		static JmPolygon polygons[MAX_POLYGON_COUNT_3DO];
+		static s32 indices[MAX_POLYGON_COUNT_3DO][4];
+		static u8 ramp[128];
+		static Obj3dTestResult scalarResult, simdResult;
+
+		// The test changes the lighting state, which is restored afterward.
+		const s32 sectorAmbient = s_sectorAmbient;
+		const s32 scaledAmbient = s_scaledAmbient;
+		const s32 sectorAmbientFraction = s_sectorAmbientFraction;
+		const s32 worldAmbient = s_worldAmbient;
+		const s32 cameraLightSource = s_cameraLightSource;
+		const s32 lightCount = s_lightCount;
+		const u8* lightSourceRamp = s_lightSourceRamp;
+		CameraLightFlt cameraLight[3];
+		memcpy(cameraLight, s_cameraLight, sizeof(cameraLight));
+
+		for (s32 i = 0; i < 128; i++)
+		{
+			ramp[i] = u8(simd_random(seed) % 32);
+		}
+		s_lightSourceRamp = ramp;
+
+		s32 failCount = 0;
+		for (s32 n = 0; n < count; n++)
+		{
+			JediModel model = {};
+			model.vertexCount = 1 + simd_random(seed) % MAX_VERTEX_COUNT_3DO;
+			model.polygonCount = 1 + simd_random(seed) % MAX_POLYGON_COUNT_3DO;
+			model.vertices = vertices;
+			model.vertexNormals = vertexNormals;
+			model.polygonNormals = polygonNormals;
+			model.polygons = polygons;
+			model.flags = (simd_random(seed) & 1) ? MFLAG_VERTEX_LIT : 0;
+			for (s32 v = 0; v < model.vertexCount; v++)
+			{
+				simd_randomVec3(seed, FIXED(32), &vertices[v]);
+				simd_randomVec3(seed, FIXED(33), &vertexNormals[v]);
+			}
+			for (s32 p = 0; p < model.polygonCount; p++)
+			{
+				simd_randomVec3(seed, FIXED(33), &polygonNormals[p]);
+				polygons[p].index = p;
+				polygons[p].vertexCount = 3 + simd_random(seed) % 2;
+				polygons[p].indices = indices[p];
+				for (s32 i = 0; i < polygons[p].vertexCount; i++)
+				{
+					indices[p][i] = simd_random(seed) % model.vertexCount;
+				}
+			}
+			model.verticesSoA = TFE_Model_Jedi::createSoA(vertices, model.vertexCount);
+			model.vertexNormalsSoA = TFE_Model_Jedi::createSoA(vertexNormals, model.vertexCount);
+			model.polygonNormalsSoA = TFE_Model_Jedi::createSoA(polygonNormals, model.polygonCount);
+
+			// Random orthonormal-ish transform and an offset that covers the whole depth ramp.
+			f32 xform[9];
+			for (s32 i = 0; i < 9; i++)
+			{
+				xform[i] = fixed16ToFloat(simd_randomFixed(seed, ONE_16));
+			}
+			vec3_float offset = { fixed16ToFloat(simd_randomFixed(seed, FIXED(64))), fixed16ToFloat(simd_randomFixed(seed, FIXED(64))), fixed16ToFloat(simd_randomFixed(seed, FIXED(48)) + FIXED(40)) };
+
+			s_sectorAmbient = simd_random(seed) % 33;
+			s_scaledAmbient = simd_random(seed) % 32;
+			s_sectorAmbientFraction = simd_random(seed) % (ONE_16 + 1);
+			s_worldAmbient = simd_random(seed) % 32;
+			s_cameraLightSource = simd_random(seed) & 1;
+			s_lightCount = simd_random(seed) % 4;
+			for (s32 i = 0; i < s_lightCount; i++)
+			{
+				s_cameraLight[i].lightVS = { fixed16ToFloat(simd_randomFixed(seed, ONE_16)), fixed16ToFloat(simd_randomFixed(seed, ONE_16)), fixed16ToFloat(simd_randomFixed(seed, ONE_16)) };
+				s_cameraLight[i].brightness = fixed16ToFloat(simd_random(seed) % (ONE_16 + 1));
+			}
+
+			robj3d_transformAndLightScalar(&model, xform, &offset);
+			robj3d_captureTestResult(&model, &scalarResult);
+			robj3d_transformAndLight_SSE2(&model, xform, &offset);
+			robj3d_captureTestResult(&model, &simdResult);
+			if (memcmp(&scalarResult, &simdResult, sizeof(Obj3dTestResult)) != 0)
+			{
+				failCount++;
+			}
+
+			free(model.verticesSoA);
+			free(model.vertexNormalsSoA);
+			free(model.polygonNormalsSoA);
+		}
+
+		s_sectorAmbient = sectorAmbient;
+		s_scaledAmbient = scaledAmbient;
+		s_sectorAmbientFraction = sectorAmbientFraction;
+		s_worldAmbient = worldAmbient;
+		s_cameraLightSource = cameraLightSource;
+		s_lightCount = lightCount;
+		s_lightSourceRamp = lightSourceRamp;
+		memcpy(s_cameraLight, cameraLight, sizeof(cameraLight));
+		return failCount;
+	#else
+		return 0;
+	#endif
+	}
+
+	void robj3d_setSimdKernels(JBool enable)
+	{
+	#ifdef RCLASSIC_FLOAT_SSE2
+		s_simdTransform = enable;
+	#else
+		s_simdTransform = JFALSE;
+	#endif
+	}
+
+	void robj3d_transformAndLight(SecObject* obj, JediModel* model)
+	{
+		vec3_float offsetWS;
+		offsetWS.x = fixed16ToFloat(obj->posWS.x) - s_rcfltState->cameraPos.x;
+		offsetWS.y = fixed16ToFloat(obj->posWS.y) - s_rcfltState->eyeHeight;
+		offsetWS.z = fixed16ToFloat(obj->posWS.z) - s_rcfltState->cameraPos.z;
+
+		// Calculate the view space object camera offset.
+		vec3_float offsetVS;
+		rotateVectorM3x3(&offsetWS, &offsetVS, s_rcfltState->cameraMtx);
+
+		// Concatenate the camera and object rotation matrices.
+		f32 xform[9];
+		robj3d_mulMatrix3x3(s_rcfltState->cameraMtx, obj->transform, xform);
+
+	#ifdef RCLASSIC_FLOAT_SSE2
+		if (s_simdTransform && robj3d_hasSoA(model))
+		{
+			robj3d_transformAndLight_SSE2(model, xform, &offsetVS);
+			return;
+		}
+	#endif
+		robj3d_transformAndLightScalar(model, xform, &offsetVS);
+	}
+
 }}  // TFE_Jedi
\ No newline at end of file
@@ -17,12 +17,17 @@ namespace TFE_Jedi
 	{
 		extern s32 s_enableFlatShading;
 		// Vertex attributes transformed to viewspace.
-		extern vec3_float s_verticesVS[MAX_VERTEX_COUNT_3DO];
-		extern vec3_float s_vertexNormalsVS[MAX_VERTEX_COUNT_3DO];
+		extern thread_local vec3_float s_verticesVS[MAX_VERTEX_COUNT_3DO];
+		extern thread_local vec3_float s_vertexNormalsVS[MAX_VERTEX_COUNT_3DO];
 		// Vertex Lighting.
-		extern f32 s_vertexIntensity[MAX_VERTEX_COUNT_3DO];
+		extern thread_local f32 s_vertexIntensity[MAX_VERTEX_COUNT_3DO];
 		// Polygon normals in viewspace (used for culling).
-		extern vec3_float s_polygonNormalsVS[MAX_POLYGON_COUNT_3DO];
+		extern thread_local vec3_float s_polygonNormalsVS[MAX_POLYGON_COUNT_3DO];
+		// Average polygon depth in viewspace (used for sorting and flat shading).
+		extern thread_local f32 s_polygonZAve[MAX_POLYGON_COUNT_3DO];
+		// Set when the polygon normals are already relative to the polygon and the facing is stored in s_polygonBackFacing.
+		extern thread_local JBool s_polygonFacingReady;
+		extern thread_local u8 s_polygonBackFacing[MAX_POLYGON_COUNT_3DO];
 
 		void robj3d_transformAndLight(SecObject* obj, JediModel* model);
 	}
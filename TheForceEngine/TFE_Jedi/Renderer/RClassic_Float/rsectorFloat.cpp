@@ -16,6 +16,7 @@
 #include "rlightingFloat.h"
 #include "redgePairFloat.h"
 #include "rclassicFloatSharedState.h"
+#include "rstripsFloat.h"
 #include "robj3d_float/robj3dFloat.h"
 #include "../rcommon.h"
 
@@ -26,7 +27,7 @@ namespace TFE_Jedi
 {
 	namespace
 	{
-		static TFE_Sectors_Float* s_ctx = nullptr;
+		static thread_local TFE_Sectors_Float* s_ctx = nullptr;
 
 		s32 wallSortX(const void* r0, const void* r1)
 		{
@@ -130,10 +131,10 @@ namespace TFE_Jedi
 
 						// Cull against the current "window."
 						const f32 rcpZ = 1.0f / cached->objPosVS[curObj->index].z;
-						const s32 x0 = roundFloat((xMin*s_rcfltState.focalLength)*rcpZ) + s_screenXMid;
+						const s32 x0 = roundFloat((xMin*s_rcfltState->focalLength)*rcpZ) + s_screenXMid;
 						if (x0 > s_windowMaxX_Pixels) { continue; }
 
-						const s32 x1 = roundFloat((xMax*s_rcfltState.focalLength)*rcpZ) + s_screenXMid;
+						const s32 x1 = roundFloat((xMax*s_rcfltState->focalLength)*rcpZ) + s_screenXMid;
 						if (x1 < s_windowMinX_Pixels) { continue; }
 
 						// Finally add the object to render.
@@ -176,9 +177,9 @@ namespace TFE_Jedi
 	{
 		allocateCachedData();
 
-		EdgePairFloat* flatEdge = &s_rcfltState.flatEdgeList[s_flatCount];
-		s_rcfltState.flatEdge = flatEdge;
-		flat_addEdges(s_screenWidth, s_minScreenX_Pixels, 0, s_rcfltState.windowMaxY, 0, s_rcfltState.windowMinY);
+		EdgePairFloat* flatEdge = &s_rcfltState->flatEdgeList[s_flatCount];
+		s_rcfltState->flatEdge = flatEdge;
+		flat_addEdges(s_screenWidth, s_minScreenX_Pixels, 0, s_rcfltState->windowMaxY, 0, s_rcfltState->windowMinY);
 
 		light_transformDirLights();
 	}
@@ -189,9 +190,9 @@ namespace TFE_Jedi
 		const f32 y = fixed16ToFloat(worldPoint->y);
 		const f32 z = fixed16ToFloat(worldPoint->z);
 
-		viewPoint->x = x*s_rcfltState.cosYaw + z*s_rcfltState.sinYaw + s_rcfltState.cameraTrans.x;
-		viewPoint->y = y - s_rcfltState.eyeHeight;
-		viewPoint->z = z*s_rcfltState.cosYaw + x*s_rcfltState.negSinYaw + s_rcfltState.cameraTrans.z;
+		viewPoint->x = x*s_rcfltState->cosYaw + z*s_rcfltState->sinYaw + s_rcfltState->cameraTrans.x;
+		viewPoint->y = y - s_rcfltState->eyeHeight;
+		viewPoint->z = z*s_rcfltState->cosYaw + x*s_rcfltState->negSinYaw + s_rcfltState->cameraTrans.z;
 	}
 	
 	void TFE_Sectors_Float::draw(RSector* sector)
@@ -210,10 +211,11 @@ namespace TFE_Jedi
 		s32* winTopNext = &s_windowTop_all[s_adjoinDepth * s_width];
 		s32* winBotNext = &s_windowBot_all[s_adjoinDepth * s_width];
 
-		s_rcfltState.depth1d = &s_rcfltState.depth1d_all[(s_adjoinDepth - 1) * s_width];
+		s_rcfltState->depth1d = &s_rcfltState->depth1d_all[(s_adjoinDepth - 1) * s_width];
 
-		s32 startWall = s_curSector->startWall;
-		s32 drawWallCount = s_curSector->drawWallCnt;
+		SectorCached* cachedSector = &m_cachedSectors[s_curSector->index];
+		s32 startWall = cachedSector->startWall;
+		s32 drawWallCount = cachedSector->drawWallCnt;
 
 		if (s_flatLighting)
 		{
@@ -231,18 +233,19 @@ namespace TFE_Jedi
 		f32* depthPrev = nullptr;
 		if (s_adjoinDepth > 1)
 		{
-			depthPrev = &s_rcfltState.depth1d_all[(s_adjoinDepth - 2) * s_width];
-			memcpy(&s_rcfltState.depth1d[s_minScreenX_Pixels], &depthPrev[s_minScreenX_Pixels], s_width * 4);
+			depthPrev = &s_rcfltState->depth1d_all[(s_adjoinDepth - 2) * s_width];
+			memcpy(&s_rcfltState->depth1d[s_minScreenX_Pixels], &depthPrev[s_minScreenX_Pixels], s_width * 4);
 		}
 
 		s_wallMaxCeilY  = s_windowMinY_Pixels;
 		s_wallMinFloorY = s_windowMaxY_Pixels;
-		SectorCached* cachedSector = &m_cachedSectors[s_curSector->index];
 
-		if (s_drawFrame != s_curSector->prevDrawFrame)
+		if (s_drawFrame != cachedSector->prevDrawFrame)
 		{
 			TFE_ZONE_BEGIN(secUpdateCache, "Update Sector Cache");
-				updateCachedSector(cachedSector, s_curSector->dirtyFlags);
+				// Initial setup already happened in allocateCachedData(), so drawing never allocates.
+				updateCachedSector(cachedSector, (s_curSector->dirtyFlags | cachedSector->pendingFlags) & ~SDF_INIT_SETUP);
+				cachedSector->pendingFlags = 0;
 			TFE_ZONE_END(secUpdateCache);
 
 			TFE_ZONE_BEGIN(secXform, "Sector Vertex Transform");
@@ -253,8 +256,8 @@ namespace TFE_Jedi
 					const f32 x = fixed16ToFloat(vtxWS->x);
 					const f32 z = fixed16ToFloat(vtxWS->z);
 
-					vtxVS->x = x*s_rcfltState.cosYaw     + z*s_rcfltState.sinYaw + s_rcfltState.cameraTrans.x;
-					vtxVS->z = x*s_rcfltState.negSinYaw  + z*s_rcfltState.cosYaw + s_rcfltState.cameraTrans.z;
+					vtxVS->x = x*s_rcfltState->cosYaw     + z*s_rcfltState->sinYaw + s_rcfltState->cameraTrans.x;
+					vtxVS->z = x*s_rcfltState->negSinYaw  + z*s_rcfltState->cosYaw + s_rcfltState->cameraTrans.z;
 					vtxVS++;
 					vtxWS++;
 				}
@@ -288,13 +291,13 @@ namespace TFE_Jedi
 				}
 				drawWallCount = s_nextWall - startWall;
 
-				s_curSector->startWall = startWall;
-				s_curSector->drawWallCnt = drawWallCount;
-				s_curSector->prevDrawFrame = s_drawFrame;
+				cachedSector->startWall = startWall;
+				cachedSector->drawWallCnt = drawWallCount;
+				cachedSector->prevDrawFrame = s_drawFrame;
 			TFE_ZONE_END(wallProcess);
 		}
 
-		RWallSegmentFloat* wallSegment = &s_rcfltState.wallSegListDst[s_curWallSeg];
+		RWallSegmentFloat* wallSegment = &s_rcfltState->wallSegListDst[s_curWallSeg];
 		s32 drawSegCnt = wall_mergeSort(wallSegment, MAX_SEG - s_curWallSeg, startWall, drawWallCount);
 		s_curWallSeg += drawSegCnt;
 
@@ -303,15 +306,15 @@ namespace TFE_Jedi
 		TFE_ZONE_END(wallQSort);
 
 		s32 flatCount = s_flatCount;
-		EdgePairFloat* flatEdge = &s_rcfltState.flatEdgeList[s_flatCount];
-		s_rcfltState.flatEdge = flatEdge;
+		EdgePairFloat* flatEdge = &s_rcfltState->flatEdgeList[s_flatCount];
+		s_rcfltState->flatEdge = flatEdge;
 
 		s32 adjoinStart = s_adjoinSegCount;
-		EdgePairFloat* adjoinEdges = &s_rcfltState.adjoinEdgeList[adjoinStart];
+		EdgePairFloat* adjoinEdges = &s_rcfltState->adjoinEdgeList[adjoinStart];
 		RWallSegmentFloat* adjoinList[MAX_ADJOIN_DEPTH_EXT];
 
-		s_rcfltState.adjoinEdge = adjoinEdges;
-		s_rcfltState.adjoinSegment = adjoinList;
+		s_rcfltState->adjoinEdge = adjoinEdges;
+		s_rcfltState->adjoinSegment = adjoinList;
 
 		// Draw each wall segment in the sector.
 		TFE_ZONE_BEGIN(secDrawWalls, "Draw Walls");
@@ -437,7 +440,8 @@ namespace TFE_Jedi
 				prevAdjoinSeg = curAdjoinSeg;
 				curAdjoinSeg = *seg;
 
-				RWall* srcWall = curAdjoinSeg->srcWall->wall;
+				WallCached* srcWallCached = curAdjoinSeg->srcWall;
+				RWall* srcWall = srcWallCached->wall;
 				RWallSegmentFloat* nextAdjoin = (i < adjoinEnd) ? *(seg + 1) : nullptr;
 				RSector* nextSector = srcWall->nextSector;
 				if (s_adjoinDepth < s_maxAdjoinDepthRecursion && s_adjoinDepth < s_maxDepthCount)
@@ -452,7 +456,7 @@ namespace TFE_Jedi
 						s_maxAdjoinDepth = s_adjoinDepth;
 					}
 
-					srcWall->drawFrame = s_drawFrame;
+					srcWallCached->drawFrame = s_drawFrame;
 					s_windowTop = winTopNext;
 					s_windowBot = winBotNext;
 					if (prevAdjoinSeg != 0)
@@ -470,7 +474,7 @@ namespace TFE_Jedi
 						}
 					}
 
-					s_rcfltState.windowMinZ = min(curAdjoinSeg->z0, curAdjoinSeg->z1);
+					s_rcfltState->windowMinZ = min(curAdjoinSeg->z0, curAdjoinSeg->z1);
 					draw(nextSector);
 					
 					if (s_adjoinDepth)
@@ -479,7 +483,7 @@ namespace TFE_Jedi
 						s_adjoinDepth--;
 						restoreValues(index);
 					}
-					srcWall->drawFrame = 0;
+					srcWallCached->drawFrame = 0;
 					if (srcWall->flags1 & WF1_ADJ_MID_TEX)
 					{
 						TFE_ZONE("Draw Transparent Walls");
@@ -489,9 +493,9 @@ namespace TFE_Jedi
 			}
 		}
 
-		if (!(s_curSector->flags1 & SEC_FLAGS1_SUBSECTOR) && depthPrev && s_drawFrame != s_prevSector->prevDrawFrame2)
+		if (!(s_curSector->flags1 & SEC_FLAGS1_SUBSECTOR) && depthPrev && s_drawFrame != m_cachedSectors[s_prevSector->index].prevDrawFrame2)
 		{
-			memcpy(&depthPrev[s_windowMinX_Pixels], &s_rcfltState.depth1d[s_windowMinX_Pixels], (s_windowMaxX_Pixels - s_windowMinX_Pixels + 1) * sizeof(f32));
+			memcpy(&depthPrev[s_windowMinX_Pixels], &s_rcfltState->depth1d[s_windowMinX_Pixels], (s_windowMaxX_Pixels - s_windowMinX_Pixels + 1) * sizeof(f32));
 		}
 
 		// Objects
@@ -530,8 +534,8 @@ namespace TFE_Jedi
 				{
 					TFE_ZONE("Draw WAX");
 
-					f32 dx = s_rcfltState.cameraPos.x - fixed16ToFloat(obj->posWS.x);
-					f32 dz = s_rcfltState.cameraPos.z - fixed16ToFloat(obj->posWS.z);
+					f32 dx = s_rcfltState->cameraPos.x - fixed16ToFloat(obj->posWS.x);
+					f32 dz = s_rcfltState->cameraPos.z - fixed16ToFloat(obj->posWS.z);
 					s32 angle = vec2ToAngle(dx, dz);
 
 					sprite_drawWax(angle, obj, &cachedPosVS[obj->index]);
@@ -552,8 +556,12 @@ namespace TFE_Jedi
 		}
 		TFE_ZONE_END(secDrawObjects);
 
-		s_curSector->flags1 |= SEC_FLAGS1_RENDERED;
-		s_curSector->prevDrawFrame2 = s_drawFrame;
+		// Strip workers traverse the same sectors as the main context, so only it updates shared flags.
+		if (!s_rcfltState->stripWorker)
+		{
+			s_curSector->flags1 |= SEC_FLAGS1_RENDERED;
+		}
+		cachedSector->prevDrawFrame2 = s_drawFrame;
 	}
 		
 	void TFE_Sectors_Float::adjoin_setupAdjoinWindow(s32* winBot, s32* winBotNext, s32* winTop, s32* winTopNext, EdgePairFloat* adjoinEdges, s32 adjoinCount)
@@ -635,7 +643,7 @@ namespace TFE_Jedi
 		SectorSaveValues* dst = &s_sectorStack[index];
 		dst->curSector = s_curSector;
 		dst->prevSector = s_prevSector;
-		dst->depth1d = s_rcfltState.depth1d;
+		dst->depth1d = s_rcfltState->depth1d;
 		dst->windowX0 = s_windowX0;
 		dst->windowX1 = s_windowX1;
 		dst->windowMinY = s_windowMinY_Pixels;
@@ -660,7 +668,7 @@ namespace TFE_Jedi
 		const SectorSaveValues* src = &s_sectorStack[index];
 		s_curSector = src->curSector;
 		s_prevSector = src->prevSector;
-		s_rcfltState.depth1d = (f32*)src->depth1d;
+		s_rcfltState->depth1d = (f32*)src->depth1d;
 		s_windowX0 = src->windowX0;
 		s_windowX1 = src->windowX1;
 		s_windowMinY_Pixels = src->windowMinY;
@@ -771,7 +779,14 @@ namespace TFE_Jedi
 		}
 
 		updateCachedWalls(cached, flags);
-		srcSector->dirtyFlags = 0;
+		// When drawing strips every context reads the same dirty flags, so they are cleared
+		// after all strips finish (see clearDrawnDirtyFlags()).
+		if (!s_rcfltState->stripClip && srcSector->dirtyFlags)
+		{
+			// The strip workers keep their own copy, they may not have seen the changes yet.
+			strips_deferDirtyFlags(srcSector);
+			srcSector->dirtyFlags = 0;
+		}
 	}
 
 	void TFE_Sectors_Float::allocateCachedData()
@@ -789,12 +804,52 @@ namespace TFE_Jedi
 
 			for (u32 i = 0; i < m_cachedSectorCount; i++)
 			{
+				// Keep the dirty flags, other renderer instances may not have seen the changes yet.
+				const u32 dirtyFlags = s_sectors[i].dirtyFlags;
 				m_cachedSectors[i].sector = &s_sectors[i];
 				updateCachedSector(&m_cachedSectors[i], SDF_ALL);
+				s_sectors[i].dirtyFlags = dirtyFlags;
 			}
 		}
 	}
 
+	void TFE_Sectors_Float::reserveCachedData()
+	{
+		allocateCachedData();
+
+		SectorCached* cached = m_cachedSectors;
+		for (u32 i = 0; i < m_cachedSectorCount; i++, cached++)
+		{
+			const RSector* srcSector = cached->sector;
+			if (cached->objectCapacity < srcSector->objectCapacity)
+			{
+				cached->objectCapacity = srcSector->objectCapacity;
+				cached->objPosVS = (vec3_float*)level_realloc(cached->objPosVS, sizeof(vec3_float) * cached->objectCapacity);
+			}
+		}
+	}
+
+	void TFE_Sectors_Float::clearDrawnDirtyFlags()
+	{
+		const SectorCached* cached = m_cachedSectors;
+		for (u32 i = 0; i < m_cachedSectorCount; i++, cached++)
+		{
+			if (cached->prevDrawFrame == s_drawFrame && cached->sector->dirtyFlags)
+			{
+				strips_deferDirtyFlags(cached->sector);
+				cached->sector->dirtyFlags = 0;
+			}
+		}
+	}
+
+	void TFE_Sectors_Float::deferDirtyFlags(const RSector* sector)
+	{
+		if (m_cachedSectors && u32(sector->index) < m_cachedSectorCount)
+		{
+			m_cachedSectors[sector->index].pendingFlags |= sector->dirtyFlags;
+		}
+	}
+
 	// Switch from float to fixed.
 	void TFE_Sectors_Float::subrendererChanged()
 	{
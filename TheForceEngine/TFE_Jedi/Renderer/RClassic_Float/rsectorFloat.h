@@ -30,6 +30,14 @@ namespace TFE_Jedi
 		// Cached Texture offsets
 		vec2_float floorOffset;
 		vec2_float ceilOffset;
+		// Per-frame traversal state, stored here rather than in RSector so that each
+		// renderer instance (strip worker) tracks it separately.
+		s32 startWall;			// wall segment start index for rendering
+		s32 drawWallCnt;		// wall segment draw count for rendering
+		s32 prevDrawFrame;		// previous frame that this sector was drawn/updated.
+		s32 prevDrawFrame2;		// previous frame drawn (again...)
+		// Dirty flags cleared by another renderer instance before this one drew the sector.
+		u32 pendingFlags;
 	};
 
 	class TFE_Sectors_Float : public TFE_Sectors
@@ -43,6 +51,14 @@ namespace TFE_Jedi
 		void draw(RSector* sector) override;
 		void subrendererChanged() override;
 
+		// Make sure cached data exists and object buffers can hold every object in the level,
+		// so that drawing does not allocate. Must be called from the main thread.
+		void reserveCachedData();
+		// Clear sector dirty flags deferred while drawing strips (see updateCachedSector()).
+		void clearDrawnDirtyFlags();
+		// Keep the sector dirty flags for this instance, called before another instance clears them.
+		void deferDirtyFlags(const RSector* sector);
+
 	private:
 		void saveValues(s32 index);
 		void restoreValues(s32 index);
@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <TFE_System/system.h>
+#include <TFE_Jedi/Math/core_math.h>
+#include <TFE_FrontEndUI/console.h>
+#include "rsimdFloat.h"
+
+namespace TFE_Jedi
+{
+
+namespace RClassic_Float
+{
+	// SSE2 is part of the x64 baseline, so availability is decided at compile time.
+#ifdef RCLASSIC_FLOAT_SSE2
+	static const JBool c_simdAvailable = JTRUE;
+#else
+	static const JBool c_simdAvailable = JFALSE;
+#endif
+
+	static bool s_simdKernels = true;
+	static JBool s_simdActive = JFALSE;
+
+	void console_simdTest(const std::vector<std::string>& args);
+
+	void simd_init()
+	{
+		CVAR_BOOL(s_simdKernels, "r_simdKernels", CVFLAG_DO_NOT_SERIALIZE, "Use the SIMD scanline, column and 3D object kernels in the software renderer.");
+		CCMD("rsimdTest", console_simdTest, 0, "Compare the SIMD and scalar software renderer kernels, optional argument: test count.");
+
+		s_simdActive = JFALSE;
+		flat_setSimdKernels(JFALSE);
+		wall_setSimdKernels(JFALSE);
+		robj3d_setSimdKernels(JFALSE);
+		simd_selectKernels();
+	}
+
+	void simd_selectKernels()
+	{
+		const JBool enable = (s_simdKernels && c_simdAvailable) ? JTRUE : JFALSE;
+		if (enable == s_simdActive) { return; }
+
+		flat_setSimdKernels(enable);
+		wall_setSimdKernels(enable);
+		robj3d_setSimdKernels(enable);
+		s_simdActive = enable;
+	}
+
+	void console_simdTest(const std::vector<std::string>& args)
+	{
+		if (!c_simdAvailable)
+		{
+			TFE_Console::addToHistory("SIMD kernels are not available in this build.");
+			return;
+		}
+
+		s32 count = 1000;
+		if (args.size() >= 2)
+		{
+			count = max(1, atoi(args[1].c_str()));
+		}
+
+		u32 seed = 0x1234567u;
+		const s32 flatFails = flat_compareSimdKernels(count, &seed);
+		const s32 wallFails = wall_compareSimdKernels(count, &seed);
+		// Each model test covers up to 500 vertices and 400 polygons, so fewer are needed.
+		const s32 obj3dCount = max(1, count / 10);
+		const s32 obj3dFails = robj3d_compareSimdKernels(obj3dCount, &seed);
+
+		char msg[256];
+		sprintf(msg, "Scanlines: %d tests, %d mismatches.", count * 4, flatFails);
+		TFE_Console::addToHistory(msg);
+		sprintf(msg, "Columns: %d tests, %d mismatches.", count * 4, wallFails);
+		TFE_Console::addToHistory(msg);
+		sprintf(msg, "3D objects: %d tests, %d mismatches.", obj3dCount, obj3dFails);
+		TFE_Console::addToHistory(msg);
+		if (flatFails || wallFails || obj3dFails)
+		{
+			TFE_System::logWrite(LOG_ERROR, "Renderer", "SIMD kernel test failed: %d scanline, %d column and %d 3D object mismatches.", flatFails, wallFails, obj3dFails);
+		}
+	}
+}  // RClassic_Float
+
+}  // TFE_Jedi
@@ -0,0 +1,42 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// SIMD support for the floating-point software renderer.
+// The scanline, column and 3D object transform and lighting kernels
+// have SSE2 versions that produce exactly the same output as the
+// scalar versions. The kernels are
+// chosen at runtime and can be toggled with "r_simdKernels" and
+// verified with "rsimdTest".
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define RCLASSIC_FLOAT_SSE2 1
+	#include <emmintrin.h>
+#endif
+
+namespace TFE_Jedi
+{
+	namespace RClassic_Float
+	{
+		void simd_init();
+		// Apply the "r_simdKernels" setting, called at the start of the frame.
+		void simd_selectKernels();
+
+		// Kernel selection and verification for each module.
+		void flat_setSimdKernels(JBool enable);
+		void wall_setSimdKernels(JBool enable);
+		void robj3d_setSimdKernels(JBool enable);
+		// Draw 'count' random spans or columns with both kernels, returns the number that differ.
+		s32  flat_compareSimdKernels(s32 count, u32* seed);
+		s32  wall_compareSimdKernels(s32 count, u32* seed);
+		// Transform, cull and light 'count' random models with both kernels, returns the number that differ.
+		s32  robj3d_compareSimdKernels(s32 count, u32* seed);
+
+		// Simple LCG so the tests do not disturb the game random number generator.
+		inline u32 simd_random(u32* seed)
+		{
+			*seed = (*seed) * 1664525u + 1013904223u;
+			return (*seed) >> 8;
+		}
+	}
+}
@@ -0,0 +1,346 @@
+#include <cstring>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+
+#include <TFE_System/system.h>
+#include <TFE_System/profiler.h>
+#include <TFE_System/Threads/thread.h>
+#include <TFE_System/Threads/signal.h>
+#include <TFE_Jedi/Math/core_math.h>
+#include "rstripsFloat.h"
+#include "rsectorFloat.h"
+#include "rclassicFloatSharedState.h"
+#include "../rcommon.h"
+
+namespace TFE_Jedi
+{
+
+namespace RClassic_Float
+{
+	// Strips narrower than this are not worth the redundant sector traversal.
+	#define MIN_STRIP_WIDTH 32
+
+	// Traversal globals at the start of the frame (after prepare()), copied to each worker.
+	struct StripFrameStart
+	{
+		RSector* sector;
+		s32 windowMinX;
+		s32 windowMaxX;
+		s32 windowMinY;
+		s32 windowMaxY;
+		s32 windowMaxCeil;
+		s32 windowMinFloor;
+		s32 windowX0;
+		s32 windowX1;
+		s32 flatCount;
+		s32 wallMaxCeilY;
+		s32 wallMinFloorY;
+		s32 nextWall;
+		s32 curWallSeg;
+		s32 adjoinSegCount;
+		s32 adjoinDepth;
+	};
+
+	struct StripWorker
+	{
+		Thread* thread;
+		Signal* start;
+		Signal* done;
+
+		TFE_Sectors_Float* sectors;
+		RClassicFloatState* state;
+
+		// Private column buffers.
+		s32  bufferWidth;
+		s32* columnTop;
+		s32* columnBot;
+		s32* windowTop_all;
+		s32* windowBot_all;
+		f32* depth1d_all;
+	};
+
+	static s32 s_threadCount = 1;
+	static s32 s_workerCount = 0;
+	static StripWorker s_workers[MAX_STRIP_THREADS - 1];
+	static StripFrameStart s_frameStart;
+	static atomic_bool s_runWorkers;
+
+	TFE_THREADRET TFE_STDCALL strips_workerFunc(void* userData);
+
+	/////////////////////////////////////////////
+	// Workers
+	/////////////////////////////////////////////
+	void strips_destroyWorkers()
+	{
+		if (!s_workerCount) { return; }
+
+		s_runWorkers.store(false);
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			s_workers[i].start->fire();
+		}
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			StripWorker* worker = &s_workers[i];
+			if (worker->thread)
+			{
+				worker->thread->waitOnExit();
+				delete worker->thread;
+			}
+			delete worker->start;
+			delete worker->done;
+
+			// Release the cached sector data back to the level.
+			worker->sectors->subrendererChanged();
+			delete worker->sectors;
+			free(worker->state);
+			free(worker->columnTop);
+			free(worker->columnBot);
+			free(worker->windowTop_all);
+			free(worker->windowBot_all);
+			free(worker->depth1d_all);
+		}
+		memset(s_workers, 0, sizeof(s_workers));
+		s_workerCount = 0;
+	}
+
+	bool strips_createWorkers(s32 count)
+	{
+		s_runWorkers.store(true);
+		for (s32 i = 0; i < count; i++)
+		{
+			StripWorker* worker = &s_workers[i];
+			memset(worker, 0, sizeof(StripWorker));
+			worker->state = (RClassicFloatState*)malloc(sizeof(RClassicFloatState));
+			if (!worker->state)
+			{
+				TFE_System::logWrite(LOG_ERROR, "Renderer", "Cannot allocate the state for strip worker %d.", i + 1);
+				return false;
+			}
+			memset(worker->state, 0, sizeof(RClassicFloatState));
+
+			worker->sectors = new TFE_Sectors_Float();
+			worker->start = Signal::create();
+			worker->done  = Signal::create();
+
+			char name[64];
+			sprintf(name, "RenderStrip%d", i + 1);
+			worker->thread = Thread::create(name, strips_workerFunc, worker);
+			s_workerCount++;
+
+			if (!worker->thread || !worker->thread->run())
+			{
+				TFE_System::logWrite(LOG_ERROR, "Renderer", "Cannot start strip worker thread %d.", i + 1);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void strips_resizeBuffers(StripWorker* worker)
+	{
+		if (worker->bufferWidth == s_width) { return; }
+		worker->bufferWidth = s_width;
+
+		const size_t depthCount = size_t(s_width) * (MAX_ADJOIN_DEPTH_EXT + 1);
+		worker->columnTop = (s32*)realloc(worker->columnTop, s_width * sizeof(s32));
+		worker->columnBot = (s32*)realloc(worker->columnBot, s_width * sizeof(s32));
+		worker->windowTop_all = (s32*)realloc(worker->windowTop_all, depthCount * sizeof(s32));
+		worker->windowBot_all = (s32*)realloc(worker->windowBot_all, depthCount * sizeof(s32));
+		worker->depth1d_all = (f32*)realloc(worker->depth1d_all, depthCount * sizeof(f32));
+	}
+
+	// Called on the main thread before the workers start, while the main context still holds the frame start state.
+	void strips_setupWorker(StripWorker* worker, s32 x0, s32 x1)
+	{
+		strips_resizeBuffers(worker);
+		worker->sectors->reserveCachedData();
+
+		// Copy the per-frame state, the lists that follow are filled in while drawing.
+		RClassicFloatState* state = worker->state;
+		memcpy(state, s_rcfltState, offsetof(RClassicFloatState, flatEdge));
+		memcpy(state->flatEdgeList, s_rcfltState->flatEdgeList, s_flatCount * sizeof(EdgePairFloat));
+		state->depth1d_all = worker->depth1d_all;
+		state->depth1d = worker->depth1d_all;
+		state->stripX0 = x0;
+		state->stripX1 = x1;
+		state->stripClip = JTRUE;
+		state->stripWorker = JTRUE;
+
+		memcpy(worker->columnTop, s_columnTop, s_width * sizeof(s32));
+		memcpy(worker->columnBot, s_columnBot, s_width * sizeof(s32));
+		memcpy(worker->windowTop_all, s_windowTop_all, s_width * sizeof(s32));
+		memcpy(worker->windowBot_all, s_windowBot_all, s_width * sizeof(s32));
+		memcpy(worker->depth1d_all, s_rcfltState->depth1d_all, s_width * sizeof(f32));
+	}
+
+	// Called on the worker thread, the traversal globals are thread local.
+	void strips_beginWorkerFrame(StripWorker* worker)
+	{
+		s_columnTop = worker->columnTop;
+		s_columnBot = worker->columnBot;
+		s_windowTop_all = worker->windowTop_all;
+		s_windowBot_all = worker->windowBot_all;
+		s_windowTop = s_windowTop_all;
+		s_windowBot = s_windowBot_all;
+		s_windowTopPrev = s_windowTop_all;
+		s_windowBotPrev = s_windowBot_all;
+		s_objWindowTop = s_windowTop_all;
+		s_objWindowBot = s_windowBot_all;
+
+		s_windowMinX_Pixels = s_frameStart.windowMinX;
+		s_windowMaxX_Pixels = s_frameStart.windowMaxX;
+		s_windowMinY_Pixels = s_frameStart.windowMinY;
+		s_windowMaxY_Pixels = s_frameStart.windowMaxY;
+		s_windowMaxCeil  = s_frameStart.windowMaxCeil;
+		s_windowMinFloor = s_frameStart.windowMinFloor;
+		s_windowX0 = s_frameStart.windowX0;
+		s_windowX1 = s_frameStart.windowX1;
+
+		s_flatCount = s_frameStart.flatCount;
+		s_wallMaxCeilY  = s_frameStart.wallMaxCeilY;
+		s_wallMinFloorY = s_frameStart.wallMinFloorY;
+		s_nextWall   = s_frameStart.nextWall;
+		s_curWallSeg = s_frameStart.curWallSeg;
+
+		s_prevSector = nullptr;
+		s_sectorIndex = 0;
+		s_maxAdjoinIndex = 0;
+		s_adjoinSegCount = s_frameStart.adjoinSegCount;
+		s_adjoinIndex = 0;
+		s_adjoinDepth = s_frameStart.adjoinDepth;
+		s_maxAdjoinDepth = s_frameStart.adjoinDepth;
+	}
+
+	TFE_THREADRET TFE_STDCALL strips_workerFunc(void* userData)
+	{
+		StripWorker* worker = (StripWorker*)userData;
+		s_rcfltState = worker->state;
+
+		char name[64];
+		sprintf(name, "RenderStrip%d", s32(worker - s_workers) + 1);
+		TFE_Profiler::setThreadName(name);
+
+		while (1)
+		{
+			worker->start->wait();
+			if (!s_runWorkers.load()) { break; }
+
+			strips_beginWorkerFrame(worker);
+			worker->sectors->draw(s_frameStart.sector);
+			worker->done->fire();
+		}
+		TFE_Profiler::releaseThread();
+		return (TFE_THREADRET)0;
+	}
+
+	/////////////////////////////////////////////
+	// API
+	/////////////////////////////////////////////
+	void strips_setThreadCount(s32 count)
+	{
+		count = clamp(count, 1, MAX_STRIP_THREADS);
+		if (count == s_threadCount) { return; }
+
+		strips_destroyWorkers();
+		s_threadCount = count;
+		if (count > 1 && !strips_createWorkers(count - 1))
+		{
+			strips_destroyWorkers();
+			s_threadCount = 1;
+		}
+	}
+
+	s32 strips_getThreadCount()
+	{
+		return s_threadCount;
+	}
+
+	void strips_draw(TFE_Sectors_Float* mainRenderer, RSector* sector)
+	{
+		const s32 stripCount = min(s_workerCount + 1, s_screenWidth / MIN_STRIP_WIDTH);
+		if (stripCount <= 1)
+		{
+			mainRenderer->draw(sector);
+			return;
+		}
+
+		s_frameStart.sector = sector;
+		s_frameStart.windowMinX = s_windowMinX_Pixels;
+		s_frameStart.windowMaxX = s_windowMaxX_Pixels;
+		s_frameStart.windowMinY = s_windowMinY_Pixels;
+		s_frameStart.windowMaxY = s_windowMaxY_Pixels;
+		s_frameStart.windowMaxCeil  = s_windowMaxCeil;
+		s_frameStart.windowMinFloor = s_windowMinFloor;
+		s_frameStart.windowX0 = s_windowX0;
+		s_frameStart.windowX1 = s_windowX1;
+		s_frameStart.flatCount = s_flatCount;
+		s_frameStart.wallMaxCeilY  = s_wallMaxCeilY;
+		s_frameStart.wallMinFloorY = s_wallMinFloorY;
+		s_frameStart.nextWall   = s_nextWall;
+		s_frameStart.curWallSeg = s_curWallSeg;
+		s_frameStart.adjoinSegCount = s_adjoinSegCount;
+		s_frameStart.adjoinDepth = s_adjoinDepth;
+
+		// Split the screen into evenly sized strips, the main thread draws the first one.
+		const s32 x0 = s_minScreenX_Pixels;
+		const s32 width = s_maxScreenX_Pixels - s_minScreenX_Pixels + 1;
+		s_rcfltState->stripX0 = x0;
+		s_rcfltState->stripX1 = x0 + width / stripCount - 1;
+		s_rcfltState->stripClip = JTRUE;
+		s_rcfltState->stripWorker = JFALSE;
+
+		for (s32 i = 1; i < stripCount; i++)
+		{
+			const s32 stripX0 = x0 + width * i / stripCount;
+			const s32 stripX1 = x0 + width * (i + 1) / stripCount - 1;
+			strips_setupWorker(&s_workers[i - 1], stripX0, stripX1);
+		}
+		for (s32 i = 1; i < stripCount; i++)
+		{
+			s_workers[i - 1].start->fire();
+		}
+
+		mainRenderer->draw(sector);
+
+		for (s32 i = 1; i < stripCount; i++)
+		{
+			s_workers[i - 1].done->wait();
+		}
+		mainRenderer->clearDrawnDirtyFlags();
+		s_rcfltState->stripClip = JFALSE;
+	}
+
+	void strips_deferDirtyFlags(const RSector* sector)
+	{
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			s_workers[i].sectors->deferDirtyFlags(sector);
+		}
+	}
+
+	void strips_reset()
+	{
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			s_workers[i].sectors->reset();
+		}
+	}
+
+	void strips_subrendererChanged()
+	{
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			s_workers[i].sectors->subrendererChanged();
+		}
+	}
+
+	void strips_destroy()
+	{
+		strips_destroyWorkers();
+		s_threadCount = 1;
+	}
+}  // RClassic_Float
+
+}  // TFE_Jedi
@@ -0,0 +1,45 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Strip Rendering
+// The 3D view is split into vertical column strips which are drawn
+// in parallel. Each worker thread owns a full renderer context and
+// runs the complete sector traversal, but only writes the pixels
+// inside of its own strip - so the result is identical to drawing
+// the view on a single thread.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include "rclassicFloatSharedState.h"
+
+struct RSector;
+
+namespace TFE_Jedi
+{
+	class TFE_Sectors_Float;
+
+	namespace RClassic_Float
+	{
+		#define MAX_STRIP_THREADS 8
+
+		// Set the number of threads used to draw the view, including the main thread.
+		// 1 = single-threaded.
+		void strips_setThreadCount(s32 count);
+		s32  strips_getThreadCount();
+
+		// Draw the view starting at 'sector', splitting the columns between the strip threads.
+		// This is called after 'mainRenderer->prepare()'.
+		void strips_draw(TFE_Sectors_Float* mainRenderer, RSector* sector);
+
+		// Mirrors the TFE_Sectors interface for the worker contexts.
+		void strips_reset();
+		void strips_subrendererChanged();
+		void strips_destroy();
+		// Called on the main thread, while the workers are idle, before the shared sector dirty flags are cleared.
+		void strips_deferDirtyFlags(const RSector* sector);
+
+		// Returns JTRUE if the current context should write to pixel column 'x'.
+		inline JBool strip_ownsColumn(s32 x)
+		{
+			return !s_rcfltState->stripClip || (x >= s_rcfltState->stripX0 && x <= s_rcfltState->stripX1);
+		}
+	}  // RClassic_Float
+}  // TFE_Jedi
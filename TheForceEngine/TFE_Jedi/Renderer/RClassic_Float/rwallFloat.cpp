@@ -1,4 +1,5 @@
 #include <cstring>
+#include <cstdlib>
 
 #include <TFE_System/profiler.h>
 #include <TFE_Jedi/Math/fixedPoint.h>
@@ -12,7 +13,10 @@
 #include "rsectorFloat.h"
 #include "redgePairFloat.h"
 #include "rclassicFloatSharedState.h"
+#include "rstripsFloat.h"
+#include "rsimdFloat.h"
 #include "../rcommon.h"
+#include "../rspriteCache.h"
 #include "../jediRenderer.h"
 
 namespace TFE_Jedi
@@ -28,15 +32,15 @@ namespace RClassic_Float
 		BACK = 0,
 	};
 
-	static f32 s_segmentCross;
-	static s32 s_texHeightMask;
-	static s32 s_yPixelCount;
-	static fixed44_20 s_vCoordStep;
-	static fixed44_20 s_vCoordFixed;
-	static const u8* s_columnLight;
-	static u8* s_texImage;
-	static u8* s_columnOut;
-	static u8  s_workBuffer[1024];
+	static thread_local f32 s_segmentCross;
+	static thread_local s32 s_texHeightMask;
+	static thread_local s32 s_yPixelCount;
+	static thread_local fixed44_20 s_vCoordStep;
+	static thread_local fixed44_20 s_vCoordFixed;
+	static thread_local const u8* s_columnLight;
+	static thread_local u8* s_texImage;
+	static thread_local u8* s_columnOut;
+	static thread_local u8  s_workBuffer[1024];
 
 	s32 segmentCrossesLine(f32 ax0, f32 ay0, f32 ax1, f32 ay1, f32 bx0, f32 by0, f32 bx1, f32 by1);
 	f32 solveForZ_Numerator(RWallSegmentFloat* wallSegment);
@@ -91,7 +95,7 @@ namespace RClassic_Float
 	{
 		f32 xz;
 		xz = (x0 * z1) - (z0 * x1);
-		f32 dyx = dz * s_rcfltState.nearPlaneHalfLen - dx;
+		f32 dyx = dz * s_rcfltState->nearPlaneHalfLen - dx;
 		if (dyx != 0.0f)
 		{
 			xz /= dyx;
@@ -125,11 +129,11 @@ namespace RClassic_Float
 			}
 			else if (dx != 0)
 			{
-				s = (-xz * s_rcfltState.nearPlaneHalfLen - x0) / dx;
+				s = (-xz * s_rcfltState->nearPlaneHalfLen - x0) / dx;
 			}
 
 			// Update the x0,y0 coordinate of the segment.
-			x0 = -xz * s_rcfltState.nearPlaneHalfLen;
+			x0 = -xz * s_rcfltState->nearPlaneHalfLen;
 			z0 = xz;
 
 			if (s != 0)
@@ -166,11 +170,11 @@ namespace RClassic_Float
 			}
 			else if (dx != 0)
 			{
-				s = (xz*s_rcfltState.nearPlaneHalfLen - x1) / dx;
+				s = (xz*s_rcfltState->nearPlaneHalfLen - x1) / dx;
 			}
 
 			// Update the x1,y1 coordinate of the segment.
-			x1 = xz * s_rcfltState.nearPlaneHalfLen;
+			x1 = xz * s_rcfltState->nearPlaneHalfLen;
 			z1 = xz;
 			if (s != 0)
 			{
@@ -191,7 +195,7 @@ namespace RClassic_Float
 		//////////////////////////////////////////////////
 		// Clip the Wall Segment by the near plane.
 		//////////////////////////////////////////////////
-		if ((z0 < 0 || z1 < 0) && segmentCrossesLine(0.0f, 0.0f, 0.0f, -s_rcfltState.halfHeight, x0, x0, x1, z1) != 0)
+		if ((z0 < 0 || z1 < 0) && segmentCrossesLine(0.0f, 0.0f, 0.0f, -s_rcfltState->halfHeight, x0, x0, x1, z1) != 0)
 		{
 			return false;
 		}
@@ -291,10 +295,10 @@ namespace RClassic_Float
 		f32 z1 = p1->z;
 
 		// x values of frustum lines that pass through (x0,z0) and (x1,z1)
-		f32 left0 = -z0 * s_rcfltState.nearPlaneHalfLen;
-		f32 left1 = -z1 * s_rcfltState.nearPlaneHalfLen;
-		f32 right0 = z0 * s_rcfltState.nearPlaneHalfLen;
-		f32 right1 = z1 * s_rcfltState.nearPlaneHalfLen;
+		f32 left0 = -z0 * s_rcfltState->nearPlaneHalfLen;
+		f32 left1 = -z1 * s_rcfltState->nearPlaneHalfLen;
+		f32 right0 = z0 * s_rcfltState->nearPlaneHalfLen;
+		f32 right1 = z1 * s_rcfltState->nearPlaneHalfLen;
 
 		// Cull the wall if it is completely beyind the camera.
 		if (z0 < 0.0f && z1 < 0.0f)
@@ -342,21 +346,21 @@ namespace RClassic_Float
 		//////////////////////////////////////////////////
 		// Project.
 		//////////////////////////////////////////////////
-		f32 x0proj = (x0*s_rcfltState.focalLength)/z0 + s_rcfltState.projOffsetX;
-		f32 x1proj = (x1*s_rcfltState.focalLength)/z1 + s_rcfltState.projOffsetX;
+		f32 x0proj = (x0*s_rcfltState->focalLength)/z0 + s_rcfltState->projOffsetX;
+		f32 x1proj = (x1*s_rcfltState->focalLength)/z1 + s_rcfltState->projOffsetX;
 		s32 x0pixel = roundFloat(x0proj);
 		s32 x1pixel = roundFloat(x1proj) - 1;
 		
 		// Handle near plane clipping by adjusting the walls to avoid holes.
 		if (clipX0_Near != 0 && x0pixel > s_minScreenX_Pixels)
 		{
-			x0 = -s_rcfltState.nearPlaneHalfLen;
-			dx = x1 + s_rcfltState.nearPlaneHalfLen;
+			x0 = -s_rcfltState->nearPlaneHalfLen;
+			dx = x1 + s_rcfltState->nearPlaneHalfLen;
 			x0pixel = s_minScreenX_Pixels;
 		}
 		if (clipX1_Near != 0 && x1pixel < s_maxScreenX_Pixels)
 		{
-			dx = s_rcfltState.nearPlaneHalfLen - x0;
+			dx = s_rcfltState->nearPlaneHalfLen - x0;
 			x1pixel = s_maxScreenX_Pixels;
 		}
 
@@ -379,7 +383,7 @@ namespace RClassic_Float
 			return;
 		}
 	
-		RWallSegmentFloat* wallSeg = &s_rcfltState.wallSegListSrc[s_nextWall];
+		RWallSegmentFloat* wallSeg = &s_rcfltState->wallSegListSrc[s_nextWall];
 		s_nextWall++;
 
 		if (x0pixel < s_minScreenX_Pixels)
@@ -434,7 +438,7 @@ namespace RClassic_Float
 		s32 splitWallCount = 0;
 		s32 splitWallIndex = -count;
 
-		RWallSegmentFloat* srcSeg = &s_rcfltState.wallSegListSrc[start];
+		RWallSegmentFloat* srcSeg = &s_rcfltState->wallSegListSrc[start];
 		RWallSegmentFloat* curSegOut = segOutList;
 
 		RWallSegmentFloat  tempSeg;
@@ -444,8 +448,8 @@ namespace RClassic_Float
 		while (1)
 		{
 			WallCached* srcWall = srcSeg->srcWall;
-			JBool processed = (s_drawFrame == srcWall->wall->drawFrame) ? JTRUE : JFALSE;
-			JBool insideWindow = ((srcSeg->z0 >= s_rcfltState.windowMinZ || srcSeg->z1 >= s_rcfltState.windowMinZ) && srcSeg->wallX0 <= s_windowMaxX_Pixels && srcSeg->wallX1 >= s_windowMinX_Pixels) ? JTRUE : JFALSE;
+			JBool processed = (s_drawFrame == srcWall->drawFrame) ? JTRUE : JFALSE;
+			JBool insideWindow = ((srcSeg->z0 >= s_rcfltState->windowMinZ || srcSeg->z1 >= s_rcfltState->windowMinZ) && srcSeg->wallX0 <= s_windowMaxX_Pixels && srcSeg->wallX1 >= s_windowMinX_Pixels) ? JTRUE : JFALSE;
 			if (!processed && insideWindow)
 			{
 				// Copy the source segment into "newSeg" so it can be modified.
@@ -758,16 +762,16 @@ namespace RClassic_Float
 		f32 ceilingHeight = cachedSector->ceilingHeight;
 		f32 floorHeight = cachedSector->floorHeight;
 
-		f32 ceilEyeRel  = ceilingHeight - s_rcfltState.eyeHeight;
-		f32 floorEyeRel = floorHeight   - s_rcfltState.eyeHeight;
+		f32 ceilEyeRel  = ceilingHeight - s_rcfltState->eyeHeight;
+		f32 floorEyeRel = floorHeight   - s_rcfltState->eyeHeight;
 
 		f32 z0 = wallSegment->z0;
 		f32 z1 = wallSegment->z1;
 
-		f32 y0C = (ceilEyeRel  * s_rcfltState.focalLenAspect) / z0 + s_rcfltState.projOffsetY;
-		f32 y1C = (ceilEyeRel  * s_rcfltState.focalLenAspect) / z1 + s_rcfltState.projOffsetY;
-		f32 y0F = (floorEyeRel * s_rcfltState.focalLenAspect) / z0 + s_rcfltState.projOffsetY;
-		f32 y1F = (floorEyeRel * s_rcfltState.focalLenAspect) / z1 + s_rcfltState.projOffsetY;
+		f32 y0C = (ceilEyeRel  * s_rcfltState->focalLenAspect) / z0 + s_rcfltState->projOffsetY;
+		f32 y1C = (ceilEyeRel  * s_rcfltState->focalLenAspect) / z1 + s_rcfltState->projOffsetY;
+		f32 y0F = (floorEyeRel * s_rcfltState->focalLenAspect) / z0 + s_rcfltState->projOffsetY;
+		f32 y1F = (floorEyeRel * s_rcfltState->focalLenAspect) / z1 + s_rcfltState->projOffsetY;
 
 		s32 y0C_pixel = roundFloat(y0C);
 		s32 y1C_pixel = roundFloat(y1C);
@@ -786,7 +790,7 @@ namespace RClassic_Float
 
 			for (s32 i = 0; i < length; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, numerator);
+				s_rcfltState->depth1d[x] = solveForZ(wallSegment, x, numerator);
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
 
@@ -832,7 +836,7 @@ namespace RClassic_Float
 
 			f32 dxView = 0;
 			f32 z = solveForZ(wallSegment, x, numerator, &dxView);
-			s_rcfltState.depth1d[x] = z;
+			s_rcfltState->depth1d[x] = z;
 
 			f32 uScale  = wallSegment->uScale;
 			f32 uCoord0 = wallSegment->uCoord0 + cachedWall->midOffset.x;
@@ -870,11 +874,11 @@ namespace RClassic_Float
 				// draw the column
 				if (s_columnLight)
 				{
-					drawColumn_Lit();
+					s_columnFunc[COLFUNC_LIT]();
 				}
 				else
 				{
-					drawColumn_Fullbright();
+					s_columnFunc[COLFUNC_FULLBRIGHT]();
 				}
 
 				// Handle the "sign texture" - a wall overlay.
@@ -965,16 +969,16 @@ namespace RClassic_Float
 				s_vCoordFixed = floatToFixed20((yF0 - f32(yF_pixel) + 0.5f)*vCoordStep + cachedWall->midOffset.z);
 
 				s_columnOut = &s_display[yC_pixel*s_width + x];
-				s_rcfltState.depth1d[x] = z;
+				s_rcfltState->depth1d[x] = z;
 				s_columnLight = computeLighting(z, floor16(srcWall->wallLight));
 
 				if (s_columnLight)
 				{
-					drawColumn_Lit_Trans();
+					s_columnFunc[COLFUNC_LIT_TRANS]();
 				}
 				else
 				{
-					drawColumn_Fullbright_Trans();
+					s_columnFunc[COLFUNC_FULLBRIGHT_TRANS]();
 				}
 			}
 
@@ -1000,13 +1004,13 @@ namespace RClassic_Float
 		f32 cProj0, cProj1;
 		if ((flags1 & SEC_FLAGS1_EXTERIOR) && (nextFlags1 & SEC_FLAGS1_EXT_ADJ))  // ceiling
 		{
-			cProj0 = cProj1 = s_rcfltState.windowMinY;
+			cProj0 = cProj1 = s_rcfltState->windowMinY;
 		}
 		else
 		{
-			f32 ceilRel = cachedSector->ceilingHeight - s_rcfltState.eyeHeight;
-			cProj0 = ((ceilRel*s_rcfltState.focalLenAspect)/z0) + s_rcfltState.projOffsetY;
-			cProj1 = ((ceilRel*s_rcfltState.focalLenAspect)/z1) + s_rcfltState.projOffsetY;
+			f32 ceilRel = cachedSector->ceilingHeight - s_rcfltState->eyeHeight;
+			cProj0 = ((ceilRel*s_rcfltState->focalLenAspect)/z0) + s_rcfltState->projOffsetY;
+			cProj1 = ((ceilRel*s_rcfltState->focalLenAspect)/z1) + s_rcfltState->projOffsetY;
 		}
 
 		s32 c0pixel = roundFloat(cProj0);
@@ -1019,7 +1023,7 @@ namespace RClassic_Float
 			const f32 numerator = solveForZ_Numerator(wallSegment);
 			for (s32 i = 0; i < length; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, numerator);
+				s_rcfltState->depth1d[x] = solveForZ(wallSegment, x, numerator);
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
 
@@ -1031,13 +1035,13 @@ namespace RClassic_Float
 		f32 fProj0, fProj1;
 		if ((sector->flags1 & SEC_FLAGS1_PIT) && (nextFlags1 & SEC_FLAGS1_EXT_FLOOR_ADJ))	// floor
 		{
-			fProj0 = fProj1 = s_rcfltState.windowMaxY;
+			fProj0 = fProj1 = s_rcfltState->windowMaxY;
 		}
 		else
 		{
-			f32 floorRel = cachedSector->floorHeight - s_rcfltState.eyeHeight;
-			fProj0 = ((floorRel*s_rcfltState.focalLenAspect)/z0) + s_rcfltState.projOffsetY;
-			fProj1 = ((floorRel*s_rcfltState.focalLenAspect)/z1) + s_rcfltState.projOffsetY;
+			f32 floorRel = cachedSector->floorHeight - s_rcfltState->eyeHeight;
+			fProj0 = ((floorRel*s_rcfltState->focalLenAspect)/z0) + s_rcfltState->projOffsetY;
+			fProj1 = ((floorRel*s_rcfltState->focalLenAspect)/z1) + s_rcfltState->projOffsetY;
 		}
 
 		s32 f0pixel = roundFloat(fProj0);
@@ -1051,7 +1055,7 @@ namespace RClassic_Float
 			const f32 numerator = solveForZ_Numerator(wallSegment);
 			for (s32 i = 0; i < length; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, numerator);
+				s_rcfltState->depth1d[x] = solveForZ(wallSegment, x, numerator);
 				s_columnBot[x] = s_windowMinY_Pixels;
 			}
 			srcWall->visible = 0;
@@ -1097,7 +1101,7 @@ namespace RClassic_Float
 				s_columnTop[x] = y0_pixel - 1;
 				s_columnBot[x] = y1_pixel + 1;
 
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, numerator);
+				s_rcfltState->depth1d[x] = solveForZ(wallSegment, x, numerator);
 				y0 += dydxCeil;
 				y1 += dydxFloor;
 			}
@@ -1123,14 +1127,14 @@ namespace RClassic_Float
 		f32 cProj0, cProj1;
 		if ((sector->flags1 & SEC_FLAGS1_EXTERIOR) && (nextSector->flags1 & SEC_FLAGS1_EXT_ADJ))
 		{
-			cProj0 = s_rcfltState.windowMinY;
+			cProj0 = s_rcfltState->windowMinY;
 			cProj1 = cProj0;
 		}
 		else
 		{
-			f32 ceilRel = cachedSector->ceilingHeight - s_rcfltState.eyeHeight;
-			cProj0 = (ceilRel*s_rcfltState.focalLenAspect)/z0 + s_rcfltState.projOffsetY;
-			cProj1 = (ceilRel*s_rcfltState.focalLenAspect)/z1 + s_rcfltState.projOffsetY;
+			f32 ceilRel = cachedSector->ceilingHeight - s_rcfltState->eyeHeight;
+			cProj0 = (ceilRel*s_rcfltState->focalLenAspect)/z0 + s_rcfltState->projOffsetY;
+			cProj1 = (ceilRel*s_rcfltState->focalLenAspect)/z1 + s_rcfltState->projOffsetY;
 		}
 
 		s32 cy0 = roundFloat(cProj0);
@@ -1146,16 +1150,16 @@ namespace RClassic_Float
 			f32 num = solveForZ_Numerator(wallSegment);
 			for (s32 i = 0; i < length; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltState->depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
 			srcWall->seen = JTRUE;
 			return;
 		}
 
-		f32 floorRel = cachedSector->floorHeight - s_rcfltState.eyeHeight;
-		f32 fProj0 = (floorRel*s_rcfltState.focalLenAspect)/z0 + s_rcfltState.projOffsetY;
-		f32 fProj1 = (floorRel*s_rcfltState.focalLenAspect)/z1 + s_rcfltState.projOffsetY;
+		f32 floorRel = cachedSector->floorHeight - s_rcfltState->eyeHeight;
+		f32 fProj0 = (floorRel*s_rcfltState->focalLenAspect)/z0 + s_rcfltState->projOffsetY;
+		f32 fProj1 = (floorRel*s_rcfltState->focalLenAspect)/z1 + s_rcfltState->projOffsetY;
 
 		s32 fy0 = roundFloat(fProj0);
 		s32 fy1 = roundFloat(fProj1);
@@ -1171,16 +1175,16 @@ namespace RClassic_Float
 			f32 num = solveForZ_Numerator(wallSegment);
 			for (s32 i = 0; i < length; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltState->depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnBot[x] = s_windowMinY_Pixels;
 			}
 			srcWall->seen = JTRUE;
 			return;
 		}
 
-		f32 floorRelNext = fixed16ToFloat(nextSector->floorHeight) - s_rcfltState.eyeHeight;
-		f32 fNextProj0 = (floorRelNext*s_rcfltState.focalLenAspect)/z0 + s_rcfltState.projOffsetY;
-		f32 fNextProj1 = (floorRelNext*s_rcfltState.focalLenAspect)/z1 + s_rcfltState.projOffsetY;
+		f32 floorRelNext = fixed16ToFloat(nextSector->floorHeight) - s_rcfltState->eyeHeight;
+		f32 fNextProj0 = (floorRelNext*s_rcfltState->focalLenAspect)/z0 + s_rcfltState->projOffsetY;
+		f32 fNextProj1 = (floorRelNext*s_rcfltState->focalLenAspect)/z1 + s_rcfltState->projOffsetY;
 
 		s32 xOffset = wallSegment->wallX0 - wallSegment->wallX0_raw;
 		s32 length  = wallSegment->wallX1 - wallSegment->wallX0 + 1;
@@ -1226,7 +1230,7 @@ namespace RClassic_Float
 				s32 yC_pixel = min(roundFloat(yC), s_windowBot[x]);
 				s_columnTop[x] = yC_pixel - 1;
 				s_columnBot[x] = bot;
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltState->depth1d[x] = solveForZ(wallSegment, x, num);
 			}
 			srcWall->seen = JTRUE;
 			return;
@@ -1278,7 +1282,7 @@ namespace RClassic_Float
 					f32 dz = z - z0;
 					uCoord = u0 + (dz*wallSegment->uScale) + cachedWall->botOffset.x;
 				}
-				s_rcfltState.depth1d[x] = z;
+				s_rcfltState->depth1d[x] = z;
 				if (s_yPixelCount > 0)
 				{
 					s32 widthMask = tex->width - 1;
@@ -1298,11 +1302,11 @@ namespace RClassic_Float
 					s_columnLight = computeLighting(z, floor16(srcWall->wallLight));
 					if (s_columnLight)
 					{
-						drawColumn_Lit();
+						s_columnFunc[COLFUNC_LIT]();
 					}
 					else
 					{
-						drawColumn_Fullbright();
+						s_columnFunc[COLFUNC_FULLBRIGHT]();
 					}
 
 					// Handle the "sign texture" - a wall overlay.
@@ -1360,9 +1364,9 @@ namespace RClassic_Float
 		s32 x0 = wallSegment->wallX0;
 		s32 lengthInPixels = wallSegment->wallX1 - wallSegment->wallX0 + 1;
 
-		f32 ceilRel = cachedSector->ceilingHeight - s_rcfltState.eyeHeight;
-		f32 yC0 =((ceilRel*s_rcfltState.focalLenAspect)/z0) + s_rcfltState.projOffsetY;
-		f32 yC1 =((ceilRel*s_rcfltState.focalLenAspect)/z1) + s_rcfltState.projOffsetY;
+		f32 ceilRel = cachedSector->ceilingHeight - s_rcfltState->eyeHeight;
+		f32 yC0 =((ceilRel*s_rcfltState->focalLenAspect)/z0) + s_rcfltState->projOffsetY;
+		f32 yC1 =((ceilRel*s_rcfltState->focalLenAspect)/z1) + s_rcfltState->projOffsetY;
 
 		s32 yC0_pixel = roundFloat(yC0);
 		s32 yC1_pixel = roundFloat(yC1);
@@ -1376,7 +1380,7 @@ namespace RClassic_Float
 			flat_addEdges(lengthInPixels, x0, 0, f32(s_windowMaxY_Pixels + 1), 0, f32(s_windowMaxY_Pixels + 1));
 			for (s32 i = 0, x = x0; i < lengthInPixels; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltState->depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
 			srcWall->seen = JTRUE;
@@ -1390,9 +1394,9 @@ namespace RClassic_Float
 		}
 		else
 		{
-			f32 floorRel = cachedSector->floorHeight - s_rcfltState.eyeHeight;
-			yF0 = (floorRel*s_rcfltState.focalLenAspect)/z0 + s_rcfltState.projOffsetY;
-			yF1 = (floorRel*s_rcfltState.focalLenAspect)/z1 + s_rcfltState.projOffsetY;
+			f32 floorRel = cachedSector->floorHeight - s_rcfltState->eyeHeight;
+			yF0 = (floorRel*s_rcfltState->focalLenAspect)/z0 + s_rcfltState->projOffsetY;
+			yF1 = (floorRel*s_rcfltState->focalLenAspect)/z1 + s_rcfltState->projOffsetY;
 		}
 
 		s32 yF0_pixel = roundFloat(yF0);
@@ -1404,16 +1408,16 @@ namespace RClassic_Float
 			flat_addEdges(lengthInPixels, x0, 0, f32(s_windowMinY_Pixels - 1), 0, f32(s_windowMinY_Pixels - 1));
 			for (s32 i = 0, x = x0; i < lengthInPixels; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltState->depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnBot[x] = s_windowMinY_Pixels;
 			}
 			srcWall->seen = JTRUE;
 			return;
 		}
 
-		f32 next_ceilRel = fixed16ToFloat(next->ceilingHeight) - s_rcfltState.eyeHeight;
-		f32 next_yC0 = (next_ceilRel*s_rcfltState.focalLenAspect)/z0 + s_rcfltState.projOffsetY;
-		f32 next_yC1 = (next_ceilRel*s_rcfltState.focalLenAspect)/z1 + s_rcfltState.projOffsetY;
+		f32 next_ceilRel = fixed16ToFloat(next->ceilingHeight) - s_rcfltState->eyeHeight;
+		f32 next_yC0 = (next_ceilRel*s_rcfltState->focalLenAspect)/z0 + s_rcfltState->projOffsetY;
+		f32 next_yC1 = (next_ceilRel*s_rcfltState->focalLenAspect)/z1 + s_rcfltState->projOffsetY;
 
 		f32 xOffset = f32(wallSegment->wallX0 - wallSegment->wallX0_raw);
 		f32 length  = f32(wallSegment->wallX1_raw - wallSegment->wallX0_raw);
@@ -1453,7 +1457,7 @@ namespace RClassic_Float
 				}
 
 				s_columnBot[x] = yF0_pixel + 1;
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltState->depth1d[x] = solveForZ(wallSegment, x, num);
 				yF0 += floor_dYdX;
 			}
 			srcWall->seen = JTRUE;
@@ -1496,7 +1500,7 @@ namespace RClassic_Float
 			f32 uCoord0 = wallSegment->uCoord0 + cachedWall->topOffset.x;
 			f32 uCoord = uCoord0 + ((wallSegment->orient == WORIENT_DZ_DX) ? dxView*uScale : (z - z0)*uScale);
 
-			s_rcfltState.depth1d[x] = z;
+			s_rcfltState->depth1d[x] = z;
 			if (s_yPixelCount > 0)
 			{
 				s32 widthMask = texture->width - 1;
@@ -1516,11 +1520,11 @@ namespace RClassic_Float
 				s_columnLight = computeLighting(z, floor16(srcWall->wallLight));
 				if (s_columnLight)
 				{
-					drawColumn_Lit();
+					s_columnFunc[COLFUNC_LIT]();
 				}
 				else
 				{
-					drawColumn_Fullbright();
+					s_columnFunc[COLFUNC_FULLBRIGHT]();
 				}
 
 				// Handle the "sign texture" - a wall overlay.
@@ -1577,9 +1581,9 @@ namespace RClassic_Float
 		s32 length  = wallSegment->wallX1 - wallSegment->wallX0 + 1;
 		f32 lengthRaw = f32(wallSegment->wallX1_raw - wallSegment->wallX0_raw);
 
-		f32 ceilRel = cachedSector->ceilingHeight - s_rcfltState.eyeHeight;
-		f32 cProj0 = (ceilRel*s_rcfltState.focalLenAspect)/z0 + s_rcfltState.projOffsetY;
-		f32 cProj1 = (ceilRel*s_rcfltState.focalLenAspect)/z1 + s_rcfltState.projOffsetY;
+		f32 ceilRel = cachedSector->ceilingHeight - s_rcfltState->eyeHeight;
+		f32 cProj0 = (ceilRel*s_rcfltState->focalLenAspect)/z0 + s_rcfltState->projOffsetY;
+		f32 cProj1 = (ceilRel*s_rcfltState->focalLenAspect)/z1 + s_rcfltState->projOffsetY;
 
 		s32 c0_pixel = roundFloat(cProj0);
 		s32 c1_pixel = roundFloat(cProj1);
@@ -1593,16 +1597,16 @@ namespace RClassic_Float
 			f32 num = solveForZ_Numerator(wallSegment);
 			for (s32 i = 0, x = x0; i < length; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltState->depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
 			srcWall->seen = JTRUE;
 			return;
 		}
 
-		f32 floorRel = cachedSector->floorHeight - s_rcfltState.eyeHeight;
-		f32 fProj0 = (floorRel*s_rcfltState.focalLenAspect)/z0 + s_rcfltState.projOffsetY;
-		f32 fProj1 = (floorRel*s_rcfltState.focalLenAspect)/z1 + s_rcfltState.projOffsetY;
+		f32 floorRel = cachedSector->floorHeight - s_rcfltState->eyeHeight;
+		f32 fProj0 = (floorRel*s_rcfltState->focalLenAspect)/z0 + s_rcfltState->projOffsetY;
+		f32 fProj1 = (floorRel*s_rcfltState->focalLenAspect)/z1 + s_rcfltState->projOffsetY;
 
 		s32 f0_pixel = roundFloat(fProj0);
 		s32 f1_pixel = roundFloat(fProj1);
@@ -1616,7 +1620,7 @@ namespace RClassic_Float
 
 			for (s32 i = 0, x = x0; i < length; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltState->depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnBot[x] = s_windowMinY_Pixels;
 			}
 			srcWall->seen = JTRUE;
@@ -1624,9 +1628,9 @@ namespace RClassic_Float
 		}
 
 		RSector* nextSector = srcWall->nextSector;
-		f32 next_ceilRel = fixed16ToFloat(nextSector->ceilingHeight) - s_rcfltState.eyeHeight;
-		f32 next_cProj0 = (next_ceilRel*s_rcfltState.focalLenAspect)/z0 + s_rcfltState.projOffsetY;
-		f32 next_cProj1 = (next_ceilRel*s_rcfltState.focalLenAspect)/z1 + s_rcfltState.projOffsetY;
+		f32 next_ceilRel = fixed16ToFloat(nextSector->ceilingHeight) - s_rcfltState->eyeHeight;
+		f32 next_cProj0 = (next_ceilRel*s_rcfltState->focalLenAspect)/z0 + s_rcfltState->projOffsetY;
+		f32 next_cProj1 = (next_ceilRel*s_rcfltState->focalLenAspect)/z1 + s_rcfltState->projOffsetY;
 
 		f32 ceil_dYdX = 0;
 		f32 next_ceil_dYdX = 0;
@@ -1683,7 +1687,7 @@ namespace RClassic_Float
 					f32 dz = z - z0;
 					u = u0 + (dz*wallSegment->uScale) + cachedWall->topOffset.x;
 				}
-				s_rcfltState.depth1d[x] = z;
+				s_rcfltState->depth1d[x] = z;
 				if (s_yPixelCount > 0)
 				{
 					s32 widthMask = topTex->width - 1;
@@ -1703,11 +1707,11 @@ namespace RClassic_Float
 
 					if (s_columnLight)
 					{
-						drawColumn_Lit();
+						s_columnFunc[COLFUNC_LIT]();
 					}
 					else
 					{
-						drawColumn_Fullbright();
+						s_columnFunc[COLFUNC_FULLBRIGHT]();
 					}
 				}
 				yC0 += ceil_dYdX;
@@ -1719,9 +1723,9 @@ namespace RClassic_Float
 			for (s32 i = 0; i < length; i++) { s_columnTop[x0 + i] = s_windowMinY_Pixels - 1; }
 		}
 
-		f32 next_floorRel = fixed16ToFloat(nextSector->floorHeight) - s_rcfltState.eyeHeight;
-		f32 next_fProj0 = (next_floorRel*s_rcfltState.focalLenAspect)/z0 + s_rcfltState.projOffsetY;
-		f32 next_fProj1 = (next_floorRel*s_rcfltState.focalLenAspect)/z1 + s_rcfltState.projOffsetY;
+		f32 next_floorRel = fixed16ToFloat(nextSector->floorHeight) - s_rcfltState->eyeHeight;
+		f32 next_fProj0 = (next_floorRel*s_rcfltState->focalLenAspect)/z0 + s_rcfltState->projOffsetY;
+		f32 next_fProj1 = (next_floorRel*s_rcfltState->focalLenAspect)/z1 + s_rcfltState->projOffsetY;
 
 		f32 next_floor_dYdX = 0;
 		f32 floor_dYdX = 0;
@@ -1787,7 +1791,7 @@ namespace RClassic_Float
 						f32 dz = z - z0;
 						uCoord = u0 + (dz*wallSegment->uScale) + cachedWall->botOffset.x;
 					}
-					s_rcfltState.depth1d[x] = z;
+					s_rcfltState->depth1d[x] = z;
 					if (s_yPixelCount > 0)
 					{
 						s32 widthMask = botTex->width - 1;
@@ -1806,11 +1810,11 @@ namespace RClassic_Float
 
 						if (s_columnLight)
 						{
-							drawColumn_Lit();
+							s_columnFunc[COLFUNC_LIT]();
 						}
 						else
 						{
-							drawColumn_Fullbright();
+							s_columnFunc[COLFUNC_FULLBRIGHT]();
 						}
 
 						// Handle the "sign texture" - a wall overlay.
@@ -1904,17 +1908,17 @@ namespace RClassic_Float
 			{
 				if (s_height == SKY_BASE_HEIGHT)
 				{
-					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask - y1) - s_rcfltState.skyPitchOffset - fixed16ToFloat(sector->ceilOffset.z));
+					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask - y1) - s_rcfltState->skyPitchOffset - fixed16ToFloat(sector->ceilOffset.z));
 				}
 				else
 				{
-					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask) - (f32(y1)*heightScale) - s_rcfltState.skyPitchOffset - fixed16ToFloat(sector->ceilOffset.z));
+					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask) - (f32(y1)*heightScale) - s_rcfltState->skyPitchOffset - fixed16ToFloat(sector->ceilOffset.z));
 				}
 
-				s32 texelU = (floorFloat(fixed16ToFloat(sector->ceilOffset.x) - s_rcfltState.skyYawOffset + s_rcfltState.skyTable[x]) ) & texWidthMask;
+				s32 texelU = (floorFloat(fixed16ToFloat(sector->ceilOffset.x) - s_rcfltState->skyYawOffset + s_rcfltState->skyTable[x]) ) & texWidthMask;
 				s_texImage = &texture->image[texelU << texture->logSizeY];
 				s_columnOut = &s_display[y0*s_width + x];
-				drawColumn_Fullbright();
+				s_columnFunc[COLFUNC_FULLBRIGHT]();
 			}
 		}
 	}
@@ -1951,19 +1955,19 @@ namespace RClassic_Float
 			{
 				if (s_height == SKY_BASE_HEIGHT)
 				{
-					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask - y1) - s_rcfltState.skyPitchOffset - fixed16ToFloat(sector->ceilOffset.z));
+					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask - y1) - s_rcfltState->skyPitchOffset - fixed16ToFloat(sector->ceilOffset.z));
 				}
 				else
 				{
-					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask) - (f32(y1)*heightScale) - s_rcfltState.skyPitchOffset - fixed16ToFloat(sector->ceilOffset.z));
+					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask) - (f32(y1)*heightScale) - s_rcfltState->skyPitchOffset - fixed16ToFloat(sector->ceilOffset.z));
 				}
 
 				s32 widthMask = texture->width - 1;
-				s32 texelU = floorFloat(fixed16ToFloat(sector->ceilOffset.x) - s_rcfltState.skyYawOffset + s_rcfltState.skyTable[x]) & widthMask;
+				s32 texelU = floorFloat(fixed16ToFloat(sector->ceilOffset.x) - s_rcfltState->skyYawOffset + s_rcfltState->skyTable[x]) & widthMask;
 				s_texImage = &texture->image[texelU << texture->logSizeY];
 				s_columnOut = &s_display[y0*s_width + x];
 
-				drawColumn_Fullbright();
+				s_columnFunc[COLFUNC_FULLBRIGHT]();
 			}
 		}
 	}
@@ -2005,17 +2009,17 @@ namespace RClassic_Float
 			{
 				if (s_height == SKY_BASE_HEIGHT)
 				{
-					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask - y1) - s_rcfltState.skyPitchOffset - fixed16ToFloat(sector->floorOffset.z));
+					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask - y1) - s_rcfltState->skyPitchOffset - fixed16ToFloat(sector->floorOffset.z));
 				}
 				else
 				{
-					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask) - (f32(y1)*heightScale) - s_rcfltState.skyPitchOffset - fixed16ToFloat(sector->floorOffset.z));
+					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask) - (f32(y1)*heightScale) - s_rcfltState->skyPitchOffset - fixed16ToFloat(sector->floorOffset.z));
 				}
 
-				s32 texelU = floorFloat(fixed16ToFloat(sector->floorOffset.x) - s_rcfltState.skyYawOffset + s_rcfltState.skyTable[x]) & texWidthMask;
+				s32 texelU = floorFloat(fixed16ToFloat(sector->floorOffset.x) - s_rcfltState->skyYawOffset + s_rcfltState->skyTable[x]) & texWidthMask;
 				s_texImage = &texture->image[texelU << texture->logSizeY];
 				s_columnOut = &s_display[y0*s_width + x];
-				drawColumn_Fullbright();
+				s_columnFunc[COLFUNC_FULLBRIGHT]();
 			}
 		}
 	}
@@ -2052,19 +2056,19 @@ namespace RClassic_Float
 			{
 				if (s_height == SKY_BASE_HEIGHT)
 				{
-					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask - y1) - s_rcfltState.skyPitchOffset - fixed16ToFloat(sector->floorOffset.z));
+					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask - y1) - s_rcfltState->skyPitchOffset - fixed16ToFloat(sector->floorOffset.z));
 				}
 				else
 				{
-					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask) - (f32(y1)*heightScale) - s_rcfltState.skyPitchOffset - fixed16ToFloat(sector->floorOffset.z));
+					s_vCoordFixed = floatToFixed20(f32(s_texHeightMask) - (f32(y1)*heightScale) - s_rcfltState->skyPitchOffset - fixed16ToFloat(sector->floorOffset.z));
 				}
 
 				s32 widthMask = texture->width - 1;
-				s32 texelU = floorFloat(fixed16ToFloat(sector->floorOffset.x) - s_rcfltState.skyYawOffset + s_rcfltState.skyTable[x]) & widthMask;
+				s32 texelU = floorFloat(fixed16ToFloat(sector->floorOffset.x) - s_rcfltState->skyYawOffset + s_rcfltState->skyTable[x]) & widthMask;
 				s_texImage = &texture->image[texelU << texture->logSizeY];
 				s_columnOut = &s_display[y0*s_width + x];
 
-				drawColumn_Fullbright();
+				s_columnFunc[COLFUNC_FULLBRIGHT]();
 			}
 		}
 	}
@@ -2109,7 +2113,7 @@ namespace RClassic_Float
 			const f32 fx = f32(x);
 			// Scale halfWidthOverX by focal length to account for widescreen.
 			// Note in the original code s_focalLength == s_halfWidth, so in that case the code is functionally equivalent.
-			const f32 halfWidthOverX = ((fx != s_rcfltState.halfWidth) ? s_rcfltState.focalLength / (fx - s_rcfltState.halfWidth) : s_rcfltState.focalLength);
+			const f32 halfWidthOverX = ((fx != s_rcfltState->halfWidth) ? s_rcfltState->focalLength / (fx - s_rcfltState->halfWidth) : s_rcfltState->focalLength);
 			f32 den = halfWidthOverX - wallSegment->slope;
 			// Avoid divide by zero.
 			if (den == 0.0f) { den = 1.0f; }
@@ -2129,7 +2133,7 @@ namespace RClassic_Float
 			// Directly solve for Z at the current pixel x coordinate.
 			// Scale xOverHalfWidth by focal length to account for widescreen.
 			// Note in the original code s_focalLength == s_halfWidth, so in that case the code is functionally equivalent.
-			const f32 xOverHalfWidth = (f32(x) - s_rcfltState.halfWidth) / s_rcfltState.focalLength;
+			const f32 xOverHalfWidth = (f32(x) - s_rcfltState->halfWidth) / s_rcfltState->focalLength;
 			f32 den = xOverHalfWidth - wallSegment->slope;
 			// Avoid divide by 0.
 			if (den == 0.0f) { den = 1.0f; }
@@ -2140,8 +2144,19 @@ namespace RClassic_Float
 		return z;
 	}
 
+	// Column kernels are shared by every wall, sign and sprite path, so the strip check lives here.
+	// The column is recovered from the output pointer since the display pointer is fixed for the frame.
+	inline JBool columnInStrip()
+	{
+		if (!s_rcfltState->stripClip) { return JTRUE; }
+		const s32 x = s32((s_columnOut - s_display) % s_width);
+		return strip_ownsColumn(x);
+	}
+
 	void drawColumn_Fullbright()
 	{
+		if (!columnInStrip()) { return; }
+
 		fixed44_20 vCoordFixed = s_vCoordFixed;
 		const u8* tex = s_texImage;
 		const s32 end = s_yPixelCount - 1;
@@ -2156,6 +2171,8 @@ namespace RClassic_Float
 
 	void drawColumn_Lit()
 	{
+		if (!columnInStrip()) { return; }
+
 		fixed44_20 vCoordFixed = s_vCoordFixed;
 		const u8* tex = s_texImage;
 		const s32 end = s_yPixelCount - 1;
@@ -2170,6 +2187,8 @@ namespace RClassic_Float
 
 	void drawColumn_Fullbright_Trans()
 	{
+		if (!columnInStrip()) { return; }
+
 		fixed44_20 vCoordFixed = s_vCoordFixed;
 		const u8* tex = s_texImage;
 		const s32 end = s_yPixelCount - 1;
@@ -2185,6 +2204,8 @@ namespace RClassic_Float
 
 	void drawColumn_Lit_Trans()
 	{
+		if (!columnInStrip()) { return; }
+
 		fixed44_20 vCoordFixed = s_vCoordFixed;
 		const u8* tex = s_texImage;
 		const s32 end = s_yPixelCount - 1;
@@ -2198,6 +2219,116 @@ namespace RClassic_Float
 		}
 	}
 
+#ifdef RCLASSIC_FLOAT_SSE2
+	#define COLUMN_LIT
+	#include "rwallFloat_ColumnSimd.h"
+	#define COLUMN_TRANS
+	#include "rwallFloat_ColumnSimd.h"
+	#undef COLUMN_LIT
+	#include "rwallFloat_ColumnSimd.h"
+	#undef COLUMN_TRANS
+	#include "rwallFloat_ColumnSimd.h"
+
+	static const ColumnFunction c_columnFuncSSE2[COLFUNC_COUNT] =
+	{
+		drawColumn_Fullbright_SSE2,			// COLFUNC_FULLBRIGHT
+		drawColumn_Lit_SSE2,				// COLFUNC_LIT
+		drawColumn_Fullbright_Trans_SSE2,	// COLFUNC_FULLBRIGHT_TRANS
+		drawColumn_Lit_Trans_SSE2,			// COLFUNC_LIT_TRANS
+	};
+#endif
+	static const ColumnFunction c_columnFuncScalar[COLFUNC_COUNT] =
+	{
+		drawColumn_Fullbright,			// COLFUNC_FULLBRIGHT
+		drawColumn_Lit,					// COLFUNC_LIT
+		drawColumn_Fullbright_Trans,	// COLFUNC_FULLBRIGHT_TRANS
+		drawColumn_Lit_Trans,			// COLFUNC_LIT_TRANS
+	};
+
+	void wall_setSimdKernels(JBool enable)
+	{
+	#ifdef RCLASSIC_FLOAT_SSE2
+		memcpy(s_columnFunc, enable ? c_columnFuncSSE2 : c_columnFuncScalar, sizeof(s_columnFunc));
+	#else
+		memcpy(s_columnFunc, c_columnFuncScalar, sizeof(s_columnFunc));
+	#endif
+	}
+
+	s32 wall_compareSimdKernels(s32 count, u32* seed)
+	{
+	#ifdef RCLASSIC_FLOAT_SSE2
+		// The kernels write with the display stride.
+		if (s_width <= 0) { return 0; }
+
+		const s32 maxHeight = 512;
+		static u8 texture[65536];
+		static u8 light[256];
+		u8* scalarOut = (u8*)malloc(maxHeight * s_width);
+		u8* simdOut = (u8*)malloc(maxHeight * s_width);
+		if (!scalarOut || !simdOut)
+		{
+			free(scalarOut);
+			free(simdOut);
+			return 0;
+		}
+
+		for (s32 i = 0; i < 65536; i++)
+		{
+			// Include plenty of transparent texels.
+			texture[i] = (simd_random(seed) & 3) ? u8(simd_random(seed)) : 0;
+		}
+		for (s32 i = 0; i < 256; i++)
+		{
+			light[i] = u8(simd_random(seed));
+		}
+
+		s32 failCount = 0;
+		for (s32 n = 0; n < count; n++)
+		{
+			// Texture heights from 8 to 4096 use the SIMD path, 65536 exercises the scalar fallback.
+			const s32 log2Height = (simd_random(seed) & 15) ? 3 + simd_random(seed) % 10 : 16;
+			const s32 height = 1 + simd_random(seed) % maxHeight;
+			const fixed44_20 v0 = (fixed44_20(simd_random(seed)) << 24) ^ fixed44_20(simd_random(seed));
+			const fixed44_20 dV = (simd_random(seed) & 15) ? fixed44_20(simd_random(seed) % (16 << 20)) - (8 << 20) : fixed44_20(s32(simd_random(seed) << 8)) * 64;
+
+			for (s32 f = 0; f < COLFUNC_COUNT; f++)
+			{
+				for (s32 i = 0; i < height; i++)
+				{
+					scalarOut[i * s_width] = u8(simd_random(seed));
+					simdOut[i * s_width] = scalarOut[i * s_width];
+				}
+
+				s_texImage = texture;
+				s_texHeightMask = (1 << log2Height) - 1;
+				s_columnLight = light;
+				s_yPixelCount = height;
+				s_vCoordFixed = v0;
+				s_vCoordStep = dV;
+
+				s_columnOut = scalarOut;
+				c_columnFuncScalar[f]();
+				s_columnOut = simdOut;
+				c_columnFuncSSE2[f]();
+
+				for (s32 i = 0; i < height; i++)
+				{
+					if (scalarOut[i * s_width] != simdOut[i * s_width])
+					{
+						failCount++;
+						break;
+					}
+				}
+			}
+		}
+		free(scalarOut);
+		free(simdOut);
+		return failCount;
+	#else
+		return 0;
+	#endif
+	}
+
 	void wall_addAdjoinSegment(s32 length, s32 x0, f32 top_dydx, f32 y1, f32 bot_dydx, f32 y0, RWallSegmentFloat* wallSegment)
 	{
 		if (s_adjoinSegCount < s_maxAdjoinSegCount)
@@ -2213,13 +2344,13 @@ namespace RClassic_Float
 			{
 				y1End += (top_dydx * lengthFlt);
 			}
-			edgePair_setup(length, x0, top_dydx, y1End, y1, bot_dydx, y0, y0End, s_rcfltState.adjoinEdge);
+			edgePair_setup(length, x0, top_dydx, y1End, y1, bot_dydx, y0, y0End, s_rcfltState->adjoinEdge);
 
-			s_rcfltState.adjoinEdge++;
+			s_rcfltState->adjoinEdge++;
 			s_adjoinSegCount++;
 
-			*s_rcfltState.adjoinSegment = wallSegment;
-			s_rcfltState.adjoinSegment++;
+			*s_rcfltState->adjoinSegment = wallSegment;
+			s_rcfltState->adjoinSegment++;
 		}
 	}
 
@@ -2245,8 +2376,8 @@ namespace RClassic_Float
 		const f32 y0 = cachedPosVS->y - yOffset;
 
 		const f32 rcpZ = 1.0f/z;
-		const f32 projX0 = x0*s_rcfltState.focalLength   *rcpZ + s_rcfltState.projOffsetX;
-		const f32 projY0 = y0*s_rcfltState.focalLenAspect*rcpZ + s_rcfltState.projOffsetY;
+		const f32 projX0 = x0*s_rcfltState->focalLength   *rcpZ + s_rcfltState->projOffsetX;
+		const f32 projY0 = y0*s_rcfltState->focalLenAspect*rcpZ + s_rcfltState->projOffsetY;
 
 		s32 x0_pixel = roundFloat(projX0);
 		s32 y0_pixel = roundFloat(projY0);
@@ -2257,8 +2388,8 @@ namespace RClassic_Float
 
 		const f32 x1 = x0 + widthWS;
 		const f32 y1 = y0 + heightWS;
-		const f32 projX1 = x1*s_rcfltState.focalLength   *rcpZ + s_rcfltState.projOffsetX;
-		const f32 projY1 = y1*s_rcfltState.focalLenAspect*rcpZ + s_rcfltState.projOffsetY;
+		const f32 projX1 = x1*s_rcfltState->focalLength   *rcpZ + s_rcfltState->projOffsetX;
+		const f32 projY1 = y1*s_rcfltState->focalLenAspect*rcpZ + s_rcfltState->projOffsetY;
 
 		s32 x1_pixel = roundFloat(projX1);
 		s32 y1_pixel = roundFloat(projY1);
@@ -2328,11 +2459,13 @@ namespace RClassic_Float
 
 		// This should be set to handle all sizes, repeating is not required.
 		s_texHeightMask = 0xffff;
+		// Compressed cells are read directly from the decompressed copy in the sprite cache when enabled.
+		const u8* cachedImage = compressed ? spriteCache_getCell(cell) : nullptr;
 
 		const u32* columnOffset = (u32*)(basePtr + cell->columnOffset);
 		for (s32 x = x0_pixel; x <= x1_pixel; x++, uCoord += uCoordStep)
 		{
-			if (z < s_rcfltState.depth1d[x])
+			if (z < s_rcfltState->depth1d[x])
 			{
 				s32 y0 = y0_pixel;
 				s32 y1 = y1_pixel;
@@ -2351,6 +2484,10 @@ namespace RClassic_Float
 				s_yPixelCount = y1 - y0 + 1;
 				if (s_yPixelCount > 0)
 				{
+					if (s_yPixelCount > 1) { drawn = JTRUE; }
+					// Skip decompressing columns owned by other strips.
+					if (!strip_ownsColumn(x)) { continue; }
+
 					const f32 vOffset = f32(y1_pixel - y1);
 					s_vCoordFixed = floatToFixed20(vOffset*vCoordStep);
 
@@ -2360,7 +2497,11 @@ namespace RClassic_Float
 						texelU = cell->sizeX - texelU - 1;
 					}
 
-					if (compressed)
+					if (cachedImage)
+					{
+						s_texImage = (u8*)cachedImage + texelU * cell->sizeY;
+					}
+					else if (compressed)
 					{
 						const u8* colPtr = (u8*)cell + columnOffset[texelU];
 
@@ -2377,12 +2518,12 @@ namespace RClassic_Float
 					s_columnOut = &s_display[y0 * s_width + x];
 					// Draw the column.
 					spriteColumnFunc();
-					if (s_yPixelCount > 1) { drawn = JTRUE; }
 				}
 			}
 		}
 
-		if (drawn && s_drawnSpriteCount < MAX_DRAWN_SPRITE_STORE)
+		// Only the main context records drawn sprites, strip workers see the same set.
+		if (drawn && !s_rcfltState->stripWorker && s_drawnSpriteCount < MAX_DRAWN_SPRITE_STORE)
 		{
 			s_drawnSprites[s_drawnSpriteCount++] = obj;
 		}
@@ -43,6 +43,9 @@ namespace TFE_Jedi
 		// Direction and length.
 		vec2_float wallDir;
 		f32 length;
+
+		// Frame this wall's adjoin is being traversed, used to avoid recursing back through it.
+		s32 drawFrame;
 	};
 
 	namespace RClassic_Float
@@ -0,0 +1,83 @@
+//////////////////////////////////////////////////////////////////////
+// SSE2 column drawing, matches the scalar drawColumn_*() functions.
+// This is included once per variant, based on COLUMN_LIT and
+// COLUMN_TRANS.
+//////////////////////////////////////////////////////////////////////
+#if defined(COLUMN_LIT) && defined(COLUMN_TRANS)
+void drawColumn_Lit_Trans_SSE2()
+#elif defined(COLUMN_LIT)
+void drawColumn_Lit_SSE2()
+#elif defined(COLUMN_TRANS)
+void drawColumn_Fullbright_Trans_SSE2()
+#else
+void drawColumn_Fullbright_SSE2()
+#endif
+{
+	// The lanes hold the low 32 bits of the coordinate, which only covers texture heights up to 4096.
+	// Taller masks (such as sprites) use the scalar version.
+	if (u32(s_texHeightMask) > 0xfff)
+	{
+	#if defined(COLUMN_LIT) && defined(COLUMN_TRANS)
+		drawColumn_Lit_Trans();
+	#elif defined(COLUMN_LIT)
+		drawColumn_Lit();
+	#elif defined(COLUMN_TRANS)
+		drawColumn_Fullbright_Trans();
+	#else
+		drawColumn_Fullbright();
+	#endif
+		return;
+	}
+	if (!columnInStrip()) { return; }
+
+	fixed44_20 vCoordFixed = s_vCoordFixed;
+	const u8* tex = s_texImage;
+	s32 i = s_yPixelCount - 1;
+	s32 offset = i * s_width;
+
+	const u32 dV = u32(s_vCoordStep);
+	const __m128i vLane = _mm_setr_epi32(0, s32(dV), s32(dV * 2u), s32(dV * 3u));
+	const __m128i vStep = _mm_set1_epi32(s32(dV * 4u));
+	const __m128i mask  = _mm_set1_epi32(s_texHeightMask);
+
+	// Compute the texel coordinates 8 pixels at a time, the writes are strided so they remain scalar.
+	for (; i >= 7; i -= 8, vCoordFixed += s_vCoordStep * 8)
+	{
+		s32 texel[8];
+		const __m128i v = _mm_add_epi32(_mm_set1_epi32(s32(vCoordFixed)), vLane);
+		_mm_storeu_si128((__m128i*)&texel[0], _mm_and_si128(_mm_srli_epi32(v, 20), mask));
+		_mm_storeu_si128((__m128i*)&texel[4], _mm_and_si128(_mm_srli_epi32(_mm_add_epi32(v, vStep), 20), mask));
+
+		for (s32 j = 0; j < 8; j++, offset -= s_width)
+		{
+		#if defined(COLUMN_LIT) && defined(COLUMN_TRANS)
+			const u8 c = tex[texel[j]];
+			if (c) { s_columnOut[offset] = s_columnLight[c]; }
+		#elif defined(COLUMN_LIT)
+			s_columnOut[offset] = s_columnLight[tex[texel[j]]];
+		#elif defined(COLUMN_TRANS)
+			const u8 c = tex[texel[j]];
+			if (c) { s_columnOut[offset] = c; }
+		#else
+			s_columnOut[offset] = tex[texel[j]];
+		#endif
+		}
+	}
+
+	// Remaining pixels.
+	for (; i >= 0; i--, offset -= s_width, vCoordFixed += s_vCoordStep)
+	{
+		const s32 v = floor20(vCoordFixed) & s_texHeightMask;
+	#if defined(COLUMN_LIT) && defined(COLUMN_TRANS)
+		const u8 c = tex[v];
+		if (c) { s_columnOut[offset] = s_columnLight[c]; }
+	#elif defined(COLUMN_LIT)
+		s_columnOut[offset] = s_columnLight[tex[v]];
+	#elif defined(COLUMN_TRANS)
+		const u8 c = tex[v];
+		if (c) { s_columnOut[offset] = c; }
+	#else
+		s_columnOut[offset] = tex[v];
+	#endif
+	}
+}
@@ -38,8 +38,8 @@ namespace RClassic_GPU
 	void computeCameraTransform(RSector* sector, f32 pitch, f32 yaw, f32 camX, f32 camY, f32 camZ)
 	{
 		s_cameraPos = { camX, camY, camZ };
-		s_cameraProj = TFE_Math::computeProjMatrixExplicit(2.0f*s_rcfltState.focalLength / f32(s_width),
-			2.0f*s_rcfltState.focalLenAspect / f32(s_height), 0.01f, 1000.0f);
+		s_cameraProj = TFE_Math::computeProjMatrixExplicit(2.0f*s_rcfltState->focalLength / f32(s_width),
+			2.0f*s_rcfltState->focalLenAspect / f32(s_height), 0.01f, 1000.0f);
 
 		f32 sinYaw, cosYaw, sinPitch, cosPitch;
 		sinCosFlt(-yaw, &sinYaw, &cosYaw);
@@ -1,8 +1,15 @@
+#include <climits>
 #include <cstring>
 
 #include <TFE_System/profiler.h>
+#include <TFE_System/system.h>
 #include <TFE_System/math.h>
+#include <TFE_System/parser.h>
+#include <TFE_Archive/archive.h>
 #include <TFE_Asset/modelAsset_jedi.h>
+#include <TFE_Asset/spriteAsset_Jedi.h>
+#include <TFE_FileSystem/paths.h>
+#include <TFE_FrontEndUI/console.h>
 #include <TFE_Game/igame.h>
 #include <TFE_Jedi/Level/level.h>
 #include <TFE_Jedi/Level/rsector.h>
@@ -18,11 +25,11 @@
 #include <TFE_RenderBackend/shaderBuffer.h>
 
 #include <TFE_Asset/imageAsset.h>
-#include <TFE_Memory/chunkedArray.h>
 
 #include "texturePacker.h"
 #include "../rcommon.h"
 
+#include <algorithm>
 #include <map>
 
 #define DEBUG_TEXTURE_ATLAS 0
@@ -36,65 +43,61 @@ namespace TFE_DarkForces
 
 namespace TFE_Jedi
 {
-	// TODO: Sort textures from largest to smallest before inserting.
-
-	struct TextureNode
-	{
-		TextureNode*  child[2] = { 0 };	// Binary tree.
-		Vec4ui rect = { 0 };
-		void* tex = nullptr;
-	};
-
 	enum
 	{
-		TIGHT_FIT_PIXELS = 2,
 		MAX_TEXTURE_COUNT = 16384,
 		MAX_TEXTURE_PAGES = 16,
+		TEXTURE_BENCH_DEFAULT_ITERATIONS = 10,
 	};
 
-	static std::vector<TextureNode*> s_nodes;
-	static TextureNode* s_root;
 	static TexturePacker* s_texturePacker;
 	static std::map<TextureData*, s32> s_textureDataMap;
 	static std::map<WaxCell*, s32> s_waxDataMap;
 	static std::vector<TextureInfo> s_texInfoPool;
-	static std::vector<TextureInfo*> s_unpackedTextures[2];
-	static ChunkedArray* s_nodePool = nullptr;
+	static std::vector<u8> s_cellImage;
+	// Set when a texture does not fit because the pages are holding textures from previous sets.
+	static bool s_needsRepack = false;
 
-	static s32 s_usedTexels = 0;
-	static s32 s_totalTexels = 0;
-	static s32 s_nodePoolIndex = 0;
-	static s32 s_unpackedBuffer = 0;
-	static s32 s_currentPage = 0;
-
-	TextureNode* allocateNode();
+	void console_texturePackerBenchmark(const ConsoleArgList& args);
 
 #if DEBUG_TEXTURE_ATLAS
 	void debug_writeOutAtlas();
 #endif
 
+	void texturepacker_registerCommands()
+	{
+		CCMD("texturePackerBenchmark", console_texturePackerBenchmark, 0, "Pack the textures and sprites of every level in DARK.GOB without the GPU, reporting occupancy, reuse and pack time. Optional argument: iteration count (default 10).");
+	}
+
 	TexturePage* allocateTexturePage(s32 width, s32 height)
 	{
 		TexturePage* page = (TexturePage*)malloc(sizeof(TexturePage));
 		memset(page, 0, sizeof(TexturePage));
 		page->backingMemory = (u8*)malloc(width * height);
 		memset(page->backingMemory, 0, width * height);
-		page->root = nullptr;
+		// Each segment is at least one texel wide, with room for one extra while inserting.
+		page->skyline = (SkylineNode*)malloc(sizeof(SkylineNode) * (width + 1));
+		page->skyline[0] = { 0, 0, width };
+		page->skylineCount = 1;
 		page->textureCount = 0;
+		page->usedTexels = 0;
 		return page;
 	}
 
+	void freeTexturePage(TexturePage* page)
+	{
+		if (!page) { return; }
+		free(page->backingMemory);
+		free(page->skyline);
+		free(page);
+	}
+
 	// Initialize the texture packer once, it is persistent across levels.
 	TexturePacker* texturepacker_init(const char* name, s32 width, s32 height)
 	{
-		TexturePacker* texturePacker = (TexturePacker*)malloc(sizeof(TexturePacker));
+		TexturePacker* texturePacker = new TexturePacker();
 		if (!texturePacker) { return nullptr; }
 
-		if (!s_nodePool)
-		{
-			s_nodePool = TFE_Memory::createChunkedArray(sizeof(TextureNode), 256, 1, s_gameRegion);
-		}
-
 		// Initialize with one page.
 		texturePacker->pageCount = 1;
 		texturePacker->pages = (TexturePage**)malloc(sizeof(TexturePage*) * MAX_TEXTURE_PAGES);
@@ -106,7 +109,8 @@ namespace TFE_Jedi
 		texturePacker->pages[0] = allocateTexturePage(width, height);
 
 		texturePacker->textureTable = (Vec4i*)malloc(sizeof(Vec4i) * MAX_TEXTURE_COUNT);	// 256Kb (count can be up to 64K).
-		if (!texturePacker->textureTable)
+		texturePacker->packed = (PackedTexture*)malloc(sizeof(PackedTexture) * MAX_TEXTURE_COUNT);
+		if (!texturePacker->textureTable || !texturePacker->packed)
 		{
 			texturepacker_destroy(texturePacker);
 			return nullptr;
@@ -116,169 +120,291 @@ namespace TFE_Jedi
 		texturePacker->height = height;
 		texturePacker->texture = nullptr;
 
-		ShaderBufferDef textureTableDef =
-		{
-			4,				// 1, 2, 4 channels (R, RG, RGBA)
-			sizeof(s32),	// 1, 2, 4 bytes (u8; s16,u16; s32,u32,f32)
-			BUF_CHANNEL_INT
-		};
-		texturePacker->textureTableGPU.create(MAX_TEXTURE_COUNT, textureTableDef, true, nullptr);
-
 		strncpy(texturePacker->name, name, 64);
+		texturePacker->name[63] = 0;
 		return texturePacker;
 	}
 
 	// Free memory and GPU buffers. Note: GPU textures need to be persistent, so the level allocator will not be used.
 	void texturepacker_destroy(TexturePacker* texturePacker)
 	{
-		TFE_RenderBackend::freeTexture(texturePacker->texture);
-		texturePacker->textureTableGPU.destroy();
+		if (texturePacker->gpuCreated)
+		{
+			TFE_RenderBackend::freeTexture(texturePacker->texture);
+			texturePacker->textureTableGPU.destroy();
+		}
 		free(texturePacker->textureTable);
-		for (s32 p = 0; p < texturePacker->pageCount; p++)
+		free(texturePacker->packed);
+		if (texturePacker->pages)
 		{
-			free(texturePacker->pages[p]->backingMemory);
+			for (s32 p = 0; p < texturePacker->pageCount; p++)
+			{
+				freeTexturePage(texturePacker->pages[p]);
+			}
 		}
 		free(texturePacker->pages);
-		free(texturePacker);
-	}
-		
-	bool textureFitsInNode(TextureNode* cur, u32 width, u32 height)
-	{
-		return width <= cur->rect.z && height <= cur->rect.w;
+		if (s_texturePacker == texturePacker)
+		{
+			s_texturePacker = nullptr;
+		}
+		delete texturePacker;
 	}
 
-	bool textureTightFit(TextureNode* cur, u32 width, u32 height)
+	/////////////////////////////////////////////
+	// Skyline packing
+	/////////////////////////////////////////////
+	// Returns the y position of a 'width' x 'height' rectangle placed at the start of segment 'index', or -1 if it doesn't fit.
+	s32 skyline_fit(const TexturePage* page, s32 index, s32 width, s32 height)
 	{
-		return (cur->rect.z - width <= TIGHT_FIT_PIXELS) && (cur->rect.w - height <= TIGHT_FIT_PIXELS);
-	}
+		const SkylineNode* node = &page->skyline[index];
+		if (node->x + width > s_texturePacker->width) { return -1; }
 
-	TextureNode* insertNode(TextureNode* cur, void* tex, u32 width, u32 height)
-	{
-		TextureNode* newNode = nullptr;
-		if (!s_root)
+		s32 y = node->y;
+		for (s32 widthLeft = width; widthLeft > 0; node++)
 		{
-			newNode = allocateNode();
-			newNode->child[0] = nullptr;
-			newNode->child[1] = nullptr;
-			newNode->rect = {0u, 0u, (u32)s_texturePacker->width, (u32)s_texturePacker->height};
-			newNode->tex  = tex;
-			s_root = newNode;
-
-			s_nodes.push_back(newNode);
-			return newNode;
+			y = max(y, node->y);
+			if (y + height > s_texturePacker->height) { return -1; }
+			widthLeft -= node->width;
 		}
+		return y;
+	}
 
-		// We are not a leaf...
-		if (cur->child[0])
+	// Bottom-left: pick the position with the lowest top edge, then the narrowest segment so wide segments are kept for wide textures.
+	bool skyline_find(const TexturePage* page, s32 width, s32 height, s32* outIndex, s32* outY)
+	{
+		s32 bestTop = INT_MAX;
+		s32 bestWidth = INT_MAX;
+		s32 bestIndex = -1;
+		for (s32 i = 0; i < page->skylineCount; i++)
 		{
-			// Try inserting left.
-			newNode = insertNode(cur->child[0], tex, width, height);
-			if (newNode) { return newNode; }
+			const s32 y = skyline_fit(page, i, width, height);
+			if (y < 0) { continue; }
 
-			// Then right.
-			return insertNode(cur->child[1], tex, width, height);
+			const s32 top = y + height;
+			if (top < bestTop || (top == bestTop && page->skyline[i].width < bestWidth))
+			{
+				bestTop = top;
+				bestWidth = page->skyline[i].width;
+				bestIndex = i;
+			}
 		}
-		else // Leaf node.
-		{
-			// If the node is already full...
-			if (cur->tex) { return nullptr; }
+		if (bestIndex < 0) { return false; }
+
+		*outIndex = bestIndex;
+		*outY = bestTop - height;
+		return true;
+	}
 
-			// Check to see if the texture fits.
-			if (!textureFitsInNode(cur, width, height)) { return nullptr; }
+	void skyline_remove(TexturePage* page, s32 index)
+	{
+		memmove(&page->skyline[index], &page->skyline[index + 1], sizeof(SkylineNode) * (page->skylineCount - index - 1));
+		page->skylineCount--;
+	}
 
-			// Check to see if it is a tight fit.
-			if (textureTightFit(cur, width, height))
+	void skyline_add(TexturePage* page, s32 index, s32 y, s32 width, s32 height)
+	{
+		// Insert the top edge of the new rectangle.
+		SkylineNode* nodes = page->skyline;
+		const s32 x = nodes[index].x;
+		memmove(&nodes[index + 1], &nodes[index], sizeof(SkylineNode) * (page->skylineCount - index));
+		nodes[index] = { x, y + height, width };
+		page->skylineCount++;
+
+		// Then shrink or remove the segments underneath it.
+		const s32 right = x + width;
+		for (s32 i = index + 1; i < page->skylineCount;)
+		{
+			if (nodes[i].x >= right) { break; }
+			const s32 overlap = right - nodes[i].x;
+			if (nodes[i].width > overlap)
 			{
-				cur->tex = tex;
-				return cur;
+				nodes[i].x += overlap;
+				nodes[i].width -= overlap;
+				break;
 			}
+			skyline_remove(page, i);
+		}
 
-			// Split the node.
-			cur->child[0] = allocateNode();
-			cur->child[1] = allocateNode();
-
-			// Push nodes so they can be deleted later.
-			s_nodes.push_back(cur->child[0]);
-			s_nodes.push_back(cur->child[1]);
-			
-			// Binary split along the longest axis.
-			const s32 dw = cur->rect.z - width;
-			const s32 dh = cur->rect.w - height;
-			if (dw > dh)
+		// Merge neighboring segments at the same height.
+		for (s32 i = max(index - 1, 0); i < page->skylineCount - 1 && i <= index + 1;)
+		{
+			if (nodes[i].y == nodes[i + 1].y)
 			{
-				cur->child[0]->rect = { cur->rect.x, cur->rect.y, width, cur->rect.w };
-				cur->child[1]->rect = { cur->rect.x + width, cur->rect.y, cur->rect.z - width, cur->rect.w };
+				nodes[i].width += nodes[i + 1].width;
+				skyline_remove(page, i + 1);
+				index--;
 			}
 			else
 			{
-				cur->child[0]->rect = { cur->rect.x, cur->rect.y, cur->rect.z, height };
-				cur->child[1]->rect = { cur->rect.x, cur->rect.y + height, cur->rect.z, cur->rect.w - height };
+				i++;
 			}
+		}
+	}
 
-			// Then insert into the first child.
-			return insertNode(cur->child[0], tex, width, height);
+	void markDirty(TexturePage* page, s32 x0, s32 y0, s32 x1, s32 y1)
+	{
+		if (page->dirtyX0 >= page->dirtyX1)
+		{
+			page->dirtyX0 = x0;
+			page->dirtyY0 = y0;
+			page->dirtyX1 = x1;
+			page->dirtyY1 = y1;
+		}
+		else
+		{
+			page->dirtyX0 = min(page->dirtyX0, x0);
+			page->dirtyY0 = min(page->dirtyY0, y0);
+			page->dirtyX1 = max(page->dirtyX1, x1);
+			page->dirtyY1 = max(page->dirtyY1, y1);
 		}
 	}
-		
-	void packNode(const TextureNode* node, const TextureData* texData, Vec4i* tableEntry)
+
+	// Find space for a texture, adding a page if none of the current pages have room.
+	bool allocateRect(s32 width, s32 height, s32* outPage, s32* outX, s32* outY)
 	{
-		// Copy the texture into place.
-		const u8* srcImage = texData->image;
-		u8* output = &s_texturePacker->pages[s_currentPage]->backingMemory[node->rect.y * s_texturePacker->width + node->rect.x];
-		for (s32 y = 0; y < texData->height; y++, output += s_texturePacker->width)
+		if (width <= 0 || height <= 0 || width > s_texturePacker->width || height > s_texturePacker->height)
+		{
+			return false;
+		}
+
+		s32 index, y;
+		for (s32 p = 0; p < s_texturePacker->pageCount; p++)
 		{
-			for (s32 x = 0; x < texData->width; x++)
+			TexturePage* page = s_texturePacker->pages[p];
+			if (skyline_find(page, width, height, &index, &y))
 			{
-				output[x] = srcImage[x*texData->height + y];
+				*outPage = p;
+				*outX = page->skyline[index].x;
+				*outY = y;
+				skyline_add(page, index, y, width, height);
+				return true;
 			}
 		}
-		s_usedTexels += texData->width * texData->height;
 
-		// Copy the mapping into the texture table.
-		tableEntry->x = (s32)node->rect.x;
-		tableEntry->y = (s32)node->rect.y;
-		tableEntry->z = (s32)node->rect.z;
-		tableEntry->w = (s32)node->rect.w;
+		// Repack instead of growing if some of the space is used by textures from previous sets.
+		if (s_texturePacker->currentTextures < s_texturePacker->texturesPacked)
+		{
+			s_needsRepack = true;
+			return false;
+		}
+		if (s_texturePacker->pageCount >= MAX_TEXTURE_PAGES)
+		{
+			return false;
+		}
 
-		// Page the page index into the x offset.
-		tableEntry->x |= (s_currentPage << 12);
+		const s32 p = s_texturePacker->pageCount;
+		s_texturePacker->pages[p] = allocateTexturePage(s_texturePacker->width, s_texturePacker->height);
+		s_texturePacker->pageCount++;
+
+		TexturePage* page = s_texturePacker->pages[p];
+		if (!skyline_find(page, width, height, &index, &y)) { return false; }
+		*outPage = p;
+		*outX = page->skyline[index].x;
+		*outY = y;
+		skyline_add(page, index, y, width, height);
+		return true;
 	}
 
-	void packNodeCell(const TextureNode* node, const void* basePtr, const WaxCell* cell, Vec4i* tableEntry)
+	// Identifies an image independently of where it was loaded, so textures shared between levels are only packed once.
+	u64 hashImage(const u8* image, s32 width, s32 height)
 	{
-		// Copy the texture into place.
-		const s32 compressed = cell->compressed;
-		u8* imageData = (u8*)cell + sizeof(WaxCell);
-		u8* image = (compressed == 1) ? imageData + (cell->sizeX * sizeof(u32)) : imageData;
-		u8* output = &s_texturePacker->pages[s_currentPage]->backingMemory[node->rect.y*s_texturePacker->width + node->rect.x];
+		const u64 prime = 0x100000001b3ull;
+		u64 hash = 0xcbf29ce484222325ull ^ (u64(width) << 32u) ^ u64(height);
+		const size_t size = size_t(width) * size_t(height);
+		size_t i = 0;
+		for (; i + 8 <= size; i += 8)
+		{
+			u64 value;
+			memcpy(&value, image + i, 8);
+			hash = (hash ^ value) * prime;
+			hash ^= hash >> 29u;
+		}
+		for (; i < size; i++)
+		{
+			hash = (hash ^ image[i]) * prime;
+		}
+		return hash;
+	}
 
-		u8 columnWorkBuffer[1024];
-		const u32* columnOffset = (u32*)((u8*)basePtr + cell->columnOffset);
-		for (s32 x = 0; x < cell->sizeX; x++)
+	// Compare a column major image with the texels of a packed texture, so a hash collision never reuses the wrong image.
+	bool packedImageMatches(const PackedTexture* packed, const u8* image, s32 width, s32 height)
+	{
+		if (packed->width != width || packed->height != height) { return false; }
+
+		const TexturePage* page = s_texturePacker->pages[packed->page];
+		const u8* texels = &page->backingMemory[packed->y * s_texturePacker->width + packed->x];
+		for (s32 r = 0; r < height; r++, texels += s_texturePacker->width)
 		{
-			u8* column = (u8*)image + columnOffset[x];
-			if (compressed)
+			for (s32 c = 0; c < width; c++)
 			{
-				const u8* colPtr = (u8*)cell + columnOffset[x];
-				sprite_decompressColumn(colPtr, columnWorkBuffer, cell->sizeY);
-				column = columnWorkBuffer;
+				if (texels[c] != image[c*height + r]) { return false; }
 			}
+		}
+		return true;
+	}
 
-			for (s32 y = 0; y < cell->sizeY; y++)
+	// Copy a column major image into the atlas, or find the copy already there.
+	// Returns the texture id or -1 if it does not fit.
+	s32 packImage(const u8* image, s32 width, s32 height)
+	{
+		const u64 key = hashImage(image, width, height);
+		std::unordered_map<u64, s32>::iterator iKey = s_texturePacker->keyMap.find(key);
+		if (iKey != s_texturePacker->keyMap.end())
+		{
+			PackedTexture* packed = &s_texturePacker->packed[iKey->second];
+			if (packedImageMatches(packed, image, width, height))
 			{
-				output[y*s_texturePacker->width + x] = column[y];
+				if (packed->generation != s_texturePacker->generation)
+				{
+					packed->generation = s_texturePacker->generation;
+					s_texturePacker->currentTextures++;
+				}
+				s_texturePacker->texturesReused++;
+				return iKey->second;
 			}
 		}
-		s_usedTexels += cell->sizeX * cell->sizeY;
 
-		// Copy the mapping into the texture table.
-		tableEntry->x = (s32)node->rect.x;
-		tableEntry->y = (s32)node->rect.y;
-		tableEntry->z = (s32)node->rect.z;
-		tableEntry->w = (s32)node->rect.w;
+		if (s_texturePacker->texturesPacked >= MAX_TEXTURE_COUNT)
+		{
+			s_needsRepack = s_texturePacker->currentTextures < s_texturePacker->texturesPacked;
+			return -1;
+		}
+
+		s32 pageIndex, x, y;
+		if (!allocateRect(width, height, &pageIndex, &x, &y))
+		{
+			return -1;
+		}
+
+		// Copy the texture into place.
+		TexturePage* page = s_texturePacker->pages[pageIndex];
+		u8* output = &page->backingMemory[y * s_texturePacker->width + x];
+		for (s32 r = 0; r < height; r++, output += s_texturePacker->width)
+		{
+			for (s32 c = 0; c < width; c++)
+			{
+				output[c] = image[c*height + r];
+			}
+		}
+		markDirty(page, x, y, x + width, y + height);
+		page->usedTexels += width * height;
+		page->textureCount++;
 
-		// Page the page index into the x offset.
-		tableEntry->x |= (s_currentPage << 12);
+		const s32 id = s_texturePacker->texturesPacked;
+		s_texturePacker->packed[id] = { key, pageIndex, x, y, width, height, s_texturePacker->generation };
+		s_texturePacker->keyMap[key] = id;
+		s_texturePacker->texturesPacked++;
+		s_texturePacker->currentTextures++;
+		s_texturePacker->texturesAdded++;
+
+		// Copy the mapping into the texture table, the page index goes into the x offset.
+		Vec4i* tableEntry = &s_texturePacker->textureTable[id];
+		tableEntry->x = x | (pageIndex << 12);
+		tableEntry->y = y;
+		tableEntry->z = width;
+		tableEntry->w = height;
+		s_texturePacker->tableDirty = true;
+		return id;
 	}
 
 	bool isTextureInMap(TextureData* tex)
@@ -304,41 +430,56 @@ namespace TFE_Jedi
 	bool insertTexture(TextureData* tex)
 	{
 		if (!tex || isTextureInMap(tex)) { return true; }
-		TextureNode* node = insertNode(s_root, tex, tex->width, tex->height);
-		if (!node)
+		const s32 id = packImage(tex->image, tex->width, tex->height);
+		if (id < 0)
 		{
 			return false;
 		}
 
-		s_totalTexels += tex->width * tex->height;
-		insertTextureIntoMap(tex, s_texturePacker->texturesPacked);
-
-		assert(node->tex == tex && s_texturePacker->texturesPacked < MAX_TEXTURE_COUNT);
-		tex->textureId = s_texturePacker->texturesPacked;
-		packNode(node, tex, &s_texturePacker->textureTable[s_texturePacker->texturesPacked]);
-		s_texturePacker->texturesPacked++;
+		insertTextureIntoMap(tex, id);
+		tex->textureId = id;
 		return true;
 	}
 
+	// Decompress the cell into a column major image.
+	const u8* getCellImage(const void* basePtr, const WaxCell* cell)
+	{
+		const s32 compressed = cell->compressed;
+		u8* imageData = (u8*)cell + sizeof(WaxCell);
+		u8* image = (compressed == 1) ? imageData + (cell->sizeX * sizeof(u32)) : imageData;
+
+		s_cellImage.resize(cell->sizeX * cell->sizeY);
+		u8* output = s_cellImage.data();
+		const u32* columnOffset = (u32*)((u8*)basePtr + cell->columnOffset);
+		for (s32 x = 0; x < cell->sizeX; x++, output += cell->sizeY)
+		{
+			if (compressed)
+			{
+				const u8* colPtr = (u8*)cell + columnOffset[x];
+				sprite_decompressColumn(colPtr, output, cell->sizeY);
+			}
+			else
+			{
+				memcpy(output, image + columnOffset[x], cell->sizeY);
+			}
+		}
+		return s_cellImage.data();
+	}
+
 	bool insertWaxFrame(void* basePtr, WaxFrame* frame)
 	{
 		if (!basePtr || !frame) { return true; }
 		WaxCell* cell = WAX_CellPtr(basePtr, frame);
 		if (!cell || isWaxCellInMap(cell)) { return true; }
-		
-		TextureNode* node = insertNode(s_root, cell, cell->sizeX, cell->sizeY);
-		if (!node)
+
+		const s32 id = packImage(getCellImage(basePtr, cell), cell->sizeX, cell->sizeY);
+		if (id < 0)
 		{
 			return false;
 		}
 
-		s_totalTexels += cell->sizeX * cell->sizeY;
-		insertWaxCellIntoMap(cell, s_texturePacker->texturesPacked);
-
-		assert(node->tex == cell && s_texturePacker->texturesPacked < MAX_TEXTURE_COUNT);
-		cell->textureId = s_texturePacker->texturesPacked;
-		packNodeCell(node, basePtr, cell, &s_texturePacker->textureTable[s_texturePacker->texturesPacked]);
-		s_texturePacker->texturesPacked++;
+		insertWaxCellIntoMap(cell, id);
+		cell->textureId = id;
 		return true;
 	}
 
@@ -354,7 +495,7 @@ namespace TFE_Jedi
 		}
 		return true;
 	}
-		
+
 	s32 textureSort(const void* a, const void* b)
 	{
 		const TextureInfo* texA = (TextureInfo*)a;
@@ -364,14 +505,29 @@ namespace TFE_Jedi
 		return 0;
 	}
 
-	TextureNode* allocateNode()
+	void texturepacker_reset(TexturePacker* texturePacker)
 	{
-		TextureNode* node = (TextureNode*)TFE_Memory::allocFromChunkedArray(s_nodePool);
-		memset(node, 0, sizeof(TextureNode));
-		return node;
+		for (s32 p = 0; p < texturePacker->pageCount; p++)
+		{
+			TexturePage* page = texturePacker->pages[p];
+			page->skyline[0] = { 0, 0, texturePacker->width };
+			page->skylineCount = 1;
+			page->textureCount = 0;
+			page->usedTexels = 0;
+		}
+		texturePacker->keyMap.clear();
+		texturePacker->texturesPacked = 0;
+		texturePacker->currentTextures = 0;
+		texturePacker->tableDirty = true;
+
+		if (s_texturePacker == texturePacker)
+		{
+			s_textureDataMap.clear();
+			s_waxDataMap.clear();
+		}
 	}
 
-	// Begin the packing process, this clears out the texture packer.
+	// Begin a new set of textures, textures from previous sets are kept until space is needed.
 	bool texturepacker_begin(TexturePacker* texturePacker)
 	{
 		if (!texturePacker) { return false; }
@@ -381,33 +537,47 @@ namespace TFE_Jedi
 		}
 
 		s_texturePacker = texturePacker;
-		s_texturePacker->texturesPacked = 0;
-		// Clear pages.
-		for (s32 p = 0; p < s_texturePacker->pageCount; p++)
-		{
-			s_texturePacker->pages[p]->root = nullptr;
-			s_texturePacker->pages[p]->textureCount = 0;
-		}
-
-		TFE_Memory::chunkedArrayClear(s_nodePool);
+		s_texturePacker->generation++;
+		s_texturePacker->currentTextures = 0;
+		s_texturePacker->texturesAdded = 0;
+		s_texturePacker->texturesReused = 0;
+		s_texturePacker->repackCount = 0;
+		s_texturePacker->lists.clear();
+
+		// Texture pointers are only valid for the current set, the atlas contents are found by key.
 		s_textureDataMap.clear();
 		s_waxDataMap.clear();
 		s_texInfoPool.clear();
-
-		// Insert the parent that covers all of the available space.
-		s_root = nullptr;
-		insertNode(nullptr, nullptr, 0, 0);
-		s_texturePacker->pages[0]->root = s_root;
 		return true;
 	}
 
-	// Commit the final packing to GPU memory.
+	// Commit the changes to GPU memory.
 	void texturepacker_commit()
 	{
+		TFE_ZONE("Texture Packer Commit");
+		if (!s_texturePacker->gpuCreated)
+		{
+			ShaderBufferDef textureTableDef =
+			{
+				4,				// 1, 2, 4 channels (R, RG, RGBA)
+				sizeof(s32),	// 1, 2, 4 bytes (u8; s16,u16; s32,u32,f32)
+				BUF_CHANNEL_INT
+			};
+			s_texturePacker->textureTableGPU.create(MAX_TEXTURE_COUNT, textureTableDef, true, nullptr);
+			s_texturePacker->gpuCreated = true;
+			s_texturePacker->tableDirty = true;
+		}
+
 		// Update the texture table.
-		s_texturePacker->textureTableGPU.update(s_texturePacker->textureTable, sizeof(Vec4i) * s_texturePacker->texturesPacked);
+		if (s_texturePacker->tableDirty)
+		{
+			s_texturePacker->textureTableGPU.update(s_texturePacker->textureTable, sizeof(Vec4i) * s_texturePacker->texturesPacked);
+			s_texturePacker->tableDirty = false;
+		}
 
 		// Create the texture if one doesn't exist or we need more layers.
+		const s32 width = s_texturePacker->width;
+		const s32 height = s_texturePacker->height;
 		if (!s_texturePacker->texture || s_texturePacker->pageCount > (s32)s_texturePacker->texture->getLayers())
 		{
 			if (s_texturePacker->texture)
@@ -415,15 +585,25 @@ namespace TFE_Jedi
 				TFE_RenderBackend::freeTexture(s_texturePacker->texture);
 			}
 			// Allocate at least 2 layers.
-			s_texturePacker->texture = TFE_RenderBackend::createTextureArray(s_texturePacker->width, s_texturePacker->height, max(2, s_texturePacker->pageCount), 1);
+			s_texturePacker->texture = TFE_RenderBackend::createTextureArray(width, height, max(2, s_texturePacker->pageCount), 1);
+
+			// Everything has to be uploaded to the new texture.
+			for (s32 p = 0; p < s_texturePacker->pageCount; p++)
+			{
+				markDirty(s_texturePacker->pages[p], 0, 0, width, height);
+			}
 		}
 
-		// Then update each page.
-		const size_t size = s_texturePacker->width * s_texturePacker->height;
+		// Then upload the modified area of each page.
 		for (s32 p = 0; p < s_texturePacker->pageCount; p++)
 		{
 			TexturePage* page = s_texturePacker->pages[p];
-			s_texturePacker->texture->update(page->backingMemory, size, p);
+			if (page->dirtyX0 >= page->dirtyX1) { continue; }
+
+			const u8* src = &page->backingMemory[page->dirtyY0 * width + page->dirtyX0];
+			s_texturePacker->texture->updateRegion(src, width, page->dirtyX0, page->dirtyY0, page->dirtyX1 - page->dirtyX0, page->dirtyY1 - page->dirtyY0, p);
+			page->dirtyX0 = page->dirtyX1 = 0;
+			page->dirtyY0 = page->dirtyY1 = 0;
 		}
 
 		// Write out the debug atlas if enabled.
@@ -432,133 +612,404 @@ namespace TFE_Jedi
 		#endif
 	}
 
-	s32 texturepacker_pack(TextureListCallback getList)
+	f32 texturepacker_getOccupancy(TexturePacker* texturePacker)
 	{
-		if (!getList) { return 0; }
+		if (!texturePacker || !texturePacker->pageCount) { return 0.0f; }
+		f64 usedTexels = 0.0;
+		for (s32 p = 0; p < texturePacker->pageCount; p++)
+		{
+			usedTexels += f64(texturePacker->pages[p]->usedTexels);
+		}
+		return f32(usedTexels / (f64(texturePacker->width) * f64(texturePacker->height) * f64(texturePacker->pageCount)));
+	}
 
+	// Pack a single list, returns false if any texture did not fit.
+	bool packList(TextureListCallback getList)
+	{
 		// Get textures.
 		s_texInfoPool.clear();
-		if (getList(s_texInfoPool))
+		if (!getList(s_texInfoPool)) { return true; }
+
+		s32 count = (s32)s_texInfoPool.size();
+		TextureInfo* list = s_texInfoPool.data();
+		// 1. Calculate the sort key, by height then width which suits the skyline packer.
+		for (s32 i = 0; i < count; i++)
 		{
-			s32 count = (s32)s_texInfoPool.size();
-			TextureInfo* list = s_texInfoPool.data();
-			// 1. Calculate the sort key (uses the area metric).
-			for (s32 i = 0; i < count; i++)
+			s32 width = 0, height = 0;
+			switch (list[i].type)
 			{
-				switch (list[i].type)
+				case TEXINFO_DF_TEXTURE_DATA:
 				{
-					case TEXINFO_DF_TEXTURE_DATA:
-					{
-						if (list[i].texData->uvWidth == BM_ANIMATED_TEXTURE)
-						{
-							AnimatedTexture* animTex = (AnimatedTexture*)list[i].texData->image;
-							list[i].sortKey = animTex->frameList[0]->width + animTex->frameList[0]->height;
-						}
-						else
-						{
-							list[i].sortKey = list[i].texData->width * list[i].texData->height;
-						}
-					} break;
-					case TEXINFO_DF_ANIM_TEX:
+					if (list[i].texData->uvWidth == BM_ANIMATED_TEXTURE)
 					{
-						list[i].sortKey = list[i].animTex->frameList[0]->width * list[i].animTex->frameList[0]->height;
-					} break;
-					case TEXINFO_DF_WAX_CELL:
+						AnimatedTexture* animTex = (AnimatedTexture*)list[i].texData->image;
+						width  = animTex->frameList[0]->width;
+						height = animTex->frameList[0]->height;
+					}
+					else
 					{
-						WaxCell* cell = WAX_CellPtr(list[i].basePtr, list[i].frame);
-						list[i].sortKey = cell->sizeX * cell->sizeY;
-					} break;
-				}
+						width  = list[i].texData->width;
+						height = list[i].texData->height;
+					}
+				} break;
+				case TEXINFO_DF_ANIM_TEX:
+				{
+					width  = list[i].animTex->frameList[0]->width;
+					height = list[i].animTex->frameList[0]->height;
+				} break;
+				case TEXINFO_DF_WAX_CELL:
+				{
+					WaxCell* cell = list[i].frame ? WAX_CellPtr(list[i].basePtr, list[i].frame) : nullptr;
+					width  = cell ? cell->sizeX : 0;
+					height = cell ? cell->sizeY : 0;
+				} break;
 			}
+			list[i].sortKey = height * 4096 + min(width, 4095);
+		}
 
-			// 2. Sort textures by perimeter from largest to smallest - simplified to w+h
-			std::qsort(list, size_t(count), sizeof(TextureInfo), textureSort);
+		// 2. Sort textures from tallest to shortest.
+		std::qsort(list, size_t(count), sizeof(TextureInfo), textureSort);
 
-			// 3. Put all textures into the unpacked list.
-			s_unpackedTextures[0].resize(count);
-			TextureInfo** unpackedList = s_unpackedTextures[0].data();
-			for (s32 i = 0; i < count; i++)
+		// 3. Insert each texture, pages are added as needed.
+		bool allPacked = true;
+		for (s32 i = 0; i < count && !s_needsRepack; i++)
+		{
+			bool packed = true;
+			switch (list[i].type)
 			{
-				unpackedList[i] = &list[i];
+				case TEXINFO_DF_TEXTURE_DATA:
+				{
+					if (list[i].texData->uvWidth == BM_ANIMATED_TEXTURE)
+					{
+						packed = insertAnimatedTextureFrames((AnimatedTexture*)list[i].texData->image);
+					}
+					else
+					{
+						packed = insertTexture(list[i].texData);
+					}
+				} break;
+				case TEXINFO_DF_ANIM_TEX:
+				{
+					packed = insertAnimatedTextureFrames(list[i].animTex);
+				} break;
+				case TEXINFO_DF_WAX_CELL:
+				{
+					packed = insertWaxFrame(list[i].basePtr, list[i].frame);
+				} break;
 			}
+			allPacked = allPacked && packed;
+		}
+		return allPacked && !s_needsRepack;
+	}
 
-			// 4. Insert each texture into the tree, adding pages as needed.
-			s_root = s_texturePacker->pages[0]->root;
-			s_currentPage = 0;
-			s_unpackedBuffer = 0;
-			while (!s_unpackedTextures[s_unpackedBuffer].empty())
+	s32 texturepacker_pack(TextureListCallback getList)
+	{
+		if (!getList || !s_texturePacker) { return 0; }
+		TFE_ZONE("Texture Packer");
+
+		if (std::find(s_texturePacker->lists.begin(), s_texturePacker->lists.end(), getList) == s_texturePacker->lists.end())
+		{
+			s_texturePacker->lists.push_back(getList);
+		}
+
+		s_needsRepack = false;
+		bool packed = packList(getList);
+		if (!packed && s_needsRepack)
+		{
+			// Drop the textures from previous sets and pack everything in the current set again.
+			texturepacker_reset(s_texturePacker);
+			s_texturePacker->repackCount++;
+			s_needsRepack = false;
+
+			packed = true;
+			const size_t listCount = s_texturePacker->lists.size();
+			for (size_t l = 0; l < listCount; l++)
 			{
-				count = (s32)s_unpackedTextures[s_unpackedBuffer].size();
-				TextureInfo** unpackedList = s_unpackedTextures[s_unpackedBuffer].data();
+				packed = packList(s_texturePacker->lists[l]) && packed;
+			}
+		}
+		if (!packed)
+		{
+			TFE_System::logWrite(LOG_WARNING, "Texture Packer", "Not all textures fit in '%s', %d pages of %dx%d are in use.",
+				s_texturePacker->name, s_texturePacker->pageCount, s_texturePacker->width, s_texturePacker->height);
+		}
+		return s_texturePacker->texturesPacked;
+	}
+
+	/////////////////////////////////////////////
+	// Benchmark
+	/////////////////////////////////////////////
+	struct BenchLevel
+	{
+		char name[32];
+		std::vector<TextureData*> textures;
+		std::vector<JediWax*> waxes;
+		std::vector<JediFrame*> frames;
+	};
+	static BenchLevel* s_benchLevel = nullptr;
 
-				s_unpackedBuffer = (s_unpackedBuffer + 1)&1;
-				s_unpackedTextures[s_unpackedBuffer].clear();
+	bool bench_getTextures(TextureInfoList& textures)
+	{
+		for (size_t i = 0; i < s_benchLevel->textures.size(); i++)
+		{
+			TextureInfo texInfo = {};
+			texInfo.type = TEXINFO_DF_TEXTURE_DATA;
+			texInfo.texData = s_benchLevel->textures[i];
+			textures.push_back(texInfo);
+		}
+		return !textures.empty();
+	}
 
-				for (s32 i = 0; i < count; i++)
+	bool bench_getObjectTextures(TextureInfoList& textures)
+	{
+		for (size_t i = 0; i < s_benchLevel->waxes.size(); i++)
+		{
+			JediWax* wax = s_benchLevel->waxes[i];
+			for (s32 animId = 0; animId < wax->animCount; animId++)
+			{
+				WaxAnim* anim = WAX_AnimPtr(wax, animId);
+				if (!anim) { continue; }
+				for (s32 v = 0; v < WAX_MAX_VIEWS; v++)
 				{
-					switch (unpackedList[i]->type)
+					WaxView* view = WAX_ViewPtr(wax, anim, v);
+					if (!view) { continue; }
+					for (s32 f = 0; f < anim->frameCount; f++)
 					{
-						case TEXINFO_DF_TEXTURE_DATA:
-						{
-							if (unpackedList[i]->texData->uvWidth == BM_ANIMATED_TEXTURE)
-							{
-								AnimatedTexture* animTex = (AnimatedTexture*)unpackedList[i]->texData->image;
-								if (!insertAnimatedTextureFrames(animTex))
-								{
-									s_unpackedTextures[s_unpackedBuffer].push_back(unpackedList[i]);
-								}
-							}
-							else
-							{
-								if (!insertTexture(unpackedList[i]->texData))
-								{
-									s_unpackedTextures[s_unpackedBuffer].push_back(unpackedList[i]);
-								}
-							}
-						} break;
-						case TEXINFO_DF_ANIM_TEX:
-						{
-							if (!insertAnimatedTextureFrames(unpackedList[i]->animTex))
-							{
-								s_unpackedTextures[s_unpackedBuffer].push_back(unpackedList[i]);
-							}
-						} break;
-						case TEXINFO_DF_WAX_CELL:
-						{
-							if (!insertWaxFrame(unpackedList[i]->basePtr, unpackedList[i]->frame))
-							{
-								s_unpackedTextures[s_unpackedBuffer].push_back(unpackedList[i]);
-							}
-						} break;
+						TextureInfo texInfo = {};
+						texInfo.type = TEXINFO_DF_WAX_CELL;
+						texInfo.frame = WAX_FramePtr(wax, view, f);
+						texInfo.basePtr = wax;
+						textures.push_back(texInfo);
 					}
 				}
+			}
+		}
+		for (size_t i = 0; i < s_benchLevel->frames.size(); i++)
+		{
+			TextureInfo texInfo = {};
+			texInfo.type = TEXINFO_DF_WAX_CELL;
+			texInfo.frame = s_benchLevel->frames[i];
+			texInfo.basePtr = s_benchLevel->frames[i];
+			textures.push_back(texInfo);
+		}
+		return !textures.empty();
+	}
 
-				// Allocate another page...
-				if (!s_unpackedTextures[s_unpackedBuffer].empty())
+	bool bench_readFile(Archive* archive, const char* name, std::vector<u8>& buffer)
+	{
+		if (!archive || !archive->openFile(name)) { return false; }
+		buffer.resize(archive->getFileLength());
+		archive->readFile(buffer.data(), buffer.size());
+		archive->closeFile();
+		return !buffer.empty();
+	}
+
+	// Load the textures listed in the level and the sprites listed in its objects, without using the asset system.
+	s32 bench_loadLevel(BenchLevel* level, Archive* darkGob, Archive* textureGob, Archive* spriteGob)
+	{
+		s32 skipped = 0;
+		std::vector<u8> buffer, file;
+		std::vector<u32> cellOffsets;
+		char fileName[64], assetName[256];
+		TFE_Parser parser;
+		size_t bufferPos;
+
+		// Level textures, animated textures need the animation system so they are skipped.
+		sprintf(fileName, "%s.LEV", level->name);
+		if (bench_readFile(darkGob, fileName, buffer))
+		{
+			parser.init((char*)buffer.data(), buffer.size());
+			parser.addCommentString("#");
+			bufferPos = 0;
+			while (const char* line = parser.readLine(bufferPos))
+			{
+				if (sscanf(line, " TEXTURE: %s ", assetName) != 1) { continue; }
+				TextureData* texture = bench_readFile(textureGob, assetName, file) ? bitmap_loadFromMemory(file.data(), file.size(), 1) : nullptr;
+				if (texture && texture->width == 1 && texture->height != 1)
 				{
-					s_currentPage++;
-					if (s_currentPage >= s_texturePacker->pageCount)
-					{
-						s_texturePacker->pages[s_texturePacker->pageCount] = allocateTexturePage(s_texturePacker->width, s_texturePacker->height);
-						s_texturePacker->pageCount++;
+					free(texture->image);
+					free(texture);
+					texture = nullptr;
+				}
+				if (texture) { level->textures.push_back(texture); }
+				else { skipped++; }
+			}
+		}
 
-						s_root = nullptr;
-						insertNode(nullptr, nullptr, 0, 0);
-						s_texturePacker->pages[s_currentPage]->root = s_root;
-					}
-					else
+		sprintf(fileName, "%s.O", level->name);
+		if (bench_readFile(darkGob, fileName, buffer))
+		{
+			parser.init((char*)buffer.data(), buffer.size());
+			parser.addCommentString("#");
+			bufferPos = 0;
+			while (const char* line = parser.readLine(bufferPos))
+			{
+				if (sscanf(line, " SPR: %s ", assetName) == 1)
+				{
+					JediWax* wax = bench_readFile(spriteGob, assetName, file) ? TFE_Sprite_Jedi::loadWax(file.data(), file.size(), cellOffsets) : nullptr;
+					if (wax) { level->waxes.push_back(wax); }
+					else { skipped++; }
+				}
+				else if (sscanf(line, " FME: %s ", assetName) == 1)
+				{
+					JediFrame* frame = bench_readFile(spriteGob, assetName, file) ? TFE_Sprite_Jedi::loadFrame(file.data(), file.size()) : nullptr;
+					if (frame) { level->frames.push_back(frame); }
+					else { skipped++; }
+				}
+			}
+		}
+		return skipped;
+	}
+
+	void bench_freeLevel(BenchLevel* level)
+	{
+		for (size_t i = 0; i < level->textures.size(); i++)
+		{
+			free(level->textures[i]->image);
+			free(level->textures[i]);
+		}
+		for (size_t i = 0; i < level->waxes.size(); i++) { free(level->waxes[i]); }
+		for (size_t i = 0; i < level->frames.size(); i++) { free(level->frames[i]); }
+		level->textures.clear();
+		level->waxes.clear();
+		level->frames.clear();
+	}
+
+	// Check that no textures overlap and that every packed texture matches its source image.
+	s32 bench_verify(TexturePacker* packer)
+	{
+		s32 errors = 0;
+		std::vector<u8> coverage(size_t(packer->width) * size_t(packer->height));
+		for (s32 p = 0; p < packer->pageCount; p++)
+		{
+			memset(coverage.data(), 0, coverage.size());
+			for (s32 t = 0; t < packer->texturesPacked; t++)
+			{
+				const PackedTexture* packed = &packer->packed[t];
+				if (packed->page != p) { continue; }
+				for (s32 y = packed->y; y < packed->y + packed->height; y++)
+				{
+					for (s32 x = packed->x; x < packed->x + packed->width; x++)
 					{
-						s_root = s_texturePacker->pages[s_currentPage]->root;
-						if (!s_root)
-						{
-							insertNode(nullptr, nullptr, 0, 0);
-							s_texturePacker->pages[s_currentPage]->root = s_root;
-						}
+						errors += coverage[y * packer->width + x];
+						coverage[y * packer->width + x] = 1;
 					}
 				}
 			}
 		}
-		return s_texturePacker->texturesPacked;
+
+		for (size_t i = 0; i < s_benchLevel->textures.size(); i++)
+		{
+			const TextureData* tex = s_benchLevel->textures[i];
+			const PackedTexture* packed = &packer->packed[tex->textureId];
+			const u8* atlas = &packer->pages[packed->page]->backingMemory[packed->y * packer->width + packed->x];
+			bool match = packed->width == tex->width && packed->height == tex->height;
+			for (s32 y = 0; y < tex->height && match; y++)
+			{
+				for (s32 x = 0; x < tex->width && match; x++)
+				{
+					match = atlas[y * packer->width + x] == tex->image[x * tex->height + y];
+				}
+			}
+			errors += match ? 0 : 1;
+		}
+		return errors;
+	}
+
+	void console_texturePackerBenchmark(const ConsoleArgList& args)
+	{
+		s32 iterations = TEXTURE_BENCH_DEFAULT_ITERATIONS;
+		if (args.size() >= 2)
+		{
+			iterations = max(1, atoi(args[1].c_str()));
+		}
+
+		const char* gobNames[] = { "DARK.GOB", "TEXTURES.GOB", "SPRITES.GOB" };
+		Archive* gobs[3];
+		for (s32 i = 0; i < 3; i++)
+		{
+			char gobPath[TFE_MAX_PATH];
+			TFE_Paths::appendPath(PATH_SOURCE_DATA, gobNames[i], gobPath);
+			gobs[i] = Archive::getArchive(ARCHIVE_GOB, gobNames[i], gobPath);
+			if (!gobs[i])
+			{
+				char res[256];
+				sprintf(res, "Cannot open %s.", gobNames[i]);
+				TFE_Console::addToHistory(res);
+				return;
+			}
+		}
+
+		// The same page size as the GPU renderer, the packer is only used on the CPU.
+		TexturePacker* prevPacker = s_texturePacker;
+		TexturePacker* fullPacker = texturepacker_init("Benchmark", 4096, 4096);
+		TexturePacker* incPacker = texturepacker_init("Incremental", 4096, 4096);
+
+		char res[256];
+		TFE_Console::addToHistory("-------------------------------------------------------------------------------------");
+		TFE_Console::addToHistory("Level    | Textures | Pages | Occupancy | Pack ms | Added | Reused | Inc Pages | Repacks | Errors");
+		TFE_Console::addToHistory("-------------------------------------------------------------------------------------");
+
+		s32 levelCount = 0, totalErrors = 0, totalSkipped = 0;
+		f64 totalTime = 0.0;
+		const u32 fileCount = gobs[0]->getFileCount();
+		for (u32 f = 0; f < fileCount; f++)
+		{
+			const char* fileName = gobs[0]->getFileName(f);
+			const size_t nameLen = strlen(fileName);
+			if (nameLen < 5 || nameLen > 31 || strcasecmp(fileName + nameLen - 4, ".LEV") != 0) { continue; }
+
+			BenchLevel level;
+			memcpy(level.name, fileName, nameLen - 4);
+			level.name[nameLen - 4] = 0;
+			s_benchLevel = &level;
+			totalSkipped += bench_loadLevel(&level, gobs[0], gobs[1], gobs[2]);
+
+			// Full pack from scratch, timed.
+			u64 ticks = 0;
+			for (s32 i = 0; i < iterations; i++)
+			{
+				const u64 start = TFE_System::getCurrentTimeInTicks();
+				texturepacker_reset(fullPacker);
+				texturepacker_begin(fullPacker);
+				texturepacker_pack(bench_getTextures);
+				texturepacker_pack(bench_getObjectTextures);
+				ticks += TFE_System::getCurrentTimeInTicks() - start;
+			}
+			const f64 packTime = TFE_System::convertFromTicksToSeconds(ticks) / f64(iterations);
+			s32 errors = bench_verify(fullPacker);
+			const s32 textureCount = fullPacker->texturesPacked;
+			const s32 pageCount = fullPacker->pageCount;
+			const f32 occupancy = texturepacker_getOccupancy(fullPacker);
+			// Pages are kept by the packer, only count the pages with textures.
+			s32 usedPages = 0;
+			for (s32 p = 0; p < fullPacker->pageCount; p++) { usedPages += fullPacker->pages[p]->textureCount ? 1 : 0; }
+
+			// Incremental pack, following the previous levels.
+			texturepacker_begin(incPacker);
+			texturepacker_pack(bench_getTextures);
+			texturepacker_pack(bench_getObjectTextures);
+			errors += bench_verify(incPacker);
+
+			sprintf(res, "%-8s | %8d | %5d | %8.1f%% | %7.2f | %5d | %6d | %9d | %7d | %6d", level.name, textureCount, usedPages,
+				occupancy * 100.0f * f32(pageCount) / f32(max(usedPages, 1)), packTime * 1000.0, incPacker->texturesAdded, incPacker->texturesReused,
+				incPacker->pageCount, incPacker->repackCount, errors);
+			TFE_Console::addToHistory(res);
+
+			totalErrors += errors;
+			totalTime += packTime;
+			levelCount++;
+			bench_freeLevel(&level);
+		}
+		s_benchLevel = nullptr;
+
+		texturepacker_destroy(fullPacker);
+		texturepacker_destroy(incPacker);
+		s_texturePacker = prevPacker;
+
+		TFE_Console::addToHistory("-------------------------------------------------------------------------------------");
+		sprintf(res, "%d levels, %.2f ms total pack time, %d errors, %d assets skipped (animated or missing).", levelCount, totalTime * 1000.0, totalErrors, totalSkipped);
+		TFE_Console::addToHistory(res);
 	}
 
 #if DEBUG_TEXTURE_ATLAS
@@ -597,4 +1048,4 @@ namespace TFE_Jedi
 		free(image);
 	}
 #endif
-}
\ No newline at end of file
+}
@@ -1,6 +1,13 @@
 #pragma once
 //////////////////////////////////////////////////////////////////////
 // Pack level textures into an atlas texture or array of textures.
+//
+// Each page is packed with a skyline (bottom-left) packer. Packing is
+// incremental: textures are keyed by their contents, so textures
+// already in the atlas from a previous level or list keep their place
+// and only new textures are copied and uploaded. When the pages fill
+// up with textures from previous levels, the current textures are
+// repacked from scratch.
 //////////////////////////////////////////////////////////////////////
 #include <TFE_System/types.h>
 #include <TFE_System/memoryPool.h>
@@ -8,6 +15,8 @@
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_RenderBackend/textureGpu.h>
 #include <TFE_RenderBackend/shaderBuffer.h>
+#include <unordered_map>
+#include <vector>
 
 struct TextureData;
 struct AnimatedTexture;
@@ -38,13 +47,35 @@ namespace TFE_Jedi
 	typedef std::vector<TextureInfo> TextureInfoList;
 	typedef bool(*TextureListCallback)(TextureInfoList& texList);
 
-	struct TextureNode;
+	// A horizontal segment of the skyline, the packed area below 'y' is used or wasted.
+	struct SkylineNode
+	{
+		s32 x, y;
+		s32 width;
+	};
 
 	struct TexturePage
 	{
 		s32 textureCount;
 		u8* backingMemory = nullptr;
-		TextureNode* root = nullptr;
+
+		SkylineNode* skyline = nullptr;	// Segments from left to right, at most one per column.
+		s32 skylineCount = 0;
+		s32 usedTexels = 0;
+
+		// Area modified since the last commit, empty if x0 >= x1.
+		s32 dirtyX0, dirtyY0;
+		s32 dirtyX1, dirtyY1;
+	};
+
+	// Atlas placement of a packed texture, indexed by texture id.
+	struct PackedTexture
+	{
+		u64 key;			// Hash of the image contents.
+		s32 page;
+		s32 x, y;
+		s32 width, height;
+		s32 generation;		// Last time the texture was packed, see texturepacker_begin().
 	};
 
 	struct TexturePacker
@@ -53,15 +84,28 @@ namespace TFE_Jedi
 		ShaderBuffer textureTableGPU;	// full texture table, includes all pages.
 		TextureGpu* texture = nullptr;	// texture array, where each slice is a page.
 
+		bool gpuCreated = false;		// GPU resources are created on the first commit, so packing works without a renderer.
+		bool tableDirty = false;		// The texture table changed since the last commit.
+
 		// CPU memory, this is kept around so it can be used on multiple levels.
 		Vec4i* textureTable = nullptr;	// CPU memory for texture table.
 		TexturePage** pages = nullptr;	// CPU copy of texture pages.
+		PackedTexture* packed = nullptr;		// Placement of each texture in the table.
+		std::unordered_map<u64, s32> keyMap;	// Content key -> texture id.
+		std::vector<TextureListCallback> lists;	// Lists packed since texturepacker_begin(), used to repack.
 
 		// General Data
 		s32 width = 0;					// Page dimensions.
 		s32 height = 0;
 		s32 texturesPacked = 0;			// Total textures packed over all pages.
 		s32 pageCount = 0;				// Number of texture pages.
+		s32 generation = 0;				// Incremented by texturepacker_begin().
+		s32 currentTextures = 0;		// Textures used by the current generation.
+
+		// Statistics since texturepacker_begin().
+		s32 texturesAdded = 0;			// Copied into the atlas.
+		s32 texturesReused = 0;			// Already in the atlas.
+		s32 repackCount = 0;
 
 		// For debugging.
 		char name[64];
@@ -72,13 +116,20 @@ namespace TFE_Jedi
 	// Free memory and GPU buffers. Note: GPU textures need to be persistent, so the level allocator will not be used.
 	void texturepacker_destroy(TexturePacker* texturePacker);
 
-	// Begin the packing process, this clears out the texture packer.
+	// Begin a new set of textures, such as a level. Textures from previous sets stay in the atlas
+	// and are reused if they are packed again, until space is needed.
 	bool texturepacker_begin(TexturePacker* texturePacker);
-	// Commit the final packing to GPU memory.
+	// Clear out the texture packer, removing all textures.
+	void texturepacker_reset(TexturePacker* texturePacker);
+	// Commit the changes to GPU memory, only modified pages are uploaded.
 	void texturepacker_commit();
+	// Fraction of the allocated pages covered by textures.
+	f32 texturepacker_getOccupancy(TexturePacker* texturePacker);
+	void texturepacker_registerCommands();
 
 	// Pack textures of various types into a single texture atlas.
 	// The client must provide a 'getList' function to get a list of 'TextureInfo' (see above).
 	// Note this may be called multiple times on the same texture packer, new pages are created as needed.
+	// Returns the number of textures in the texture table.
 	s32 texturepacker_pack(TextureListCallback getList);
 }  // TFE_Jedi
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <TFE_Jedi/Level/level.h>
 #include "rcommon.h"
 #include "rsectorRender.h"
+#include "rspriteCache.h"
 #include "screenDraw.h"
 #include "RClassic_Fixed/rclassicFixedSharedState.h"
 #include "RClassic_Fixed/rclassicFixed.h"
@@ -12,10 +13,13 @@
 #include "RClassic_Float/rclassicFloat.h"
 #include "RClassic_Float/rsectorFloat.h"
 #include "RClassic_Float/rclassicFloatSharedState.h"
+#include "RClassic_Float/rstripsFloat.h"
+#include "RClassic_Float/rsimdFloat.h"
 
 #include "RClassic_GPU/rclassicGPU.h"
 #include "RClassic_GPU/rsectorGPU.h"
 #include "RClassic_GPU/screenDrawGPU.h"
+#include "RClassic_GPU/texturePacker.h"
 
 #include <TFE_System/profiler.h>
 #include <TFE_RenderBackend/renderBackend.h>
@@ -62,6 +66,9 @@ namespace TFE_Jedi
 		// Remove temporarily until they do something useful again.
 		CCMD("rsetSubRenderer", console_setSubRenderer, 1, "Set the sub-renderer - valid values are: Classic_Fixed, Classic_Float, Classic_GPU");
 		CCMD("rgetSubRenderer", console_getSubRenderer, 0, "Get the current sub-renderer.");
+		RClassic_Float::simd_init();
+		spriteCache_init();
+		texturepacker_registerCommands();
 
 		// Setup performance counters.
 		TFE_COUNTER(s_maxAdjoinDepth, "Maximum Adjoin Depth");
@@ -77,6 +84,8 @@ namespace TFE_Jedi
 
 	void renderer_destroy()
 	{
+		RClassic_Float::strips_destroy();
+		spriteCache_destroy();
 		delete s_sectorRenderer;
 	}
 
@@ -86,6 +95,7 @@ namespace TFE_Jedi
 		{
 			s_sectorRenderer->reset();
 		}
+		RClassic_Float::strips_reset();
 	}
 
 	void renderer_setLimits()
@@ -192,6 +202,7 @@ namespace TFE_Jedi
 			if (s_sectorRenderer)
 			{
 				s_sectorRenderer->subrendererChanged();
+				RClassic_Float::strips_subrendererChanged();
 			}
 			delete s_sectorRenderer;
 			s_sectorRenderer = nullptr;
@@ -249,6 +260,7 @@ namespace TFE_Jedi
 		if (s_sectorRenderer)
 		{
 			s_sectorRenderer->subrendererChanged();
+			RClassic_Float::strips_subrendererChanged();
 		}
 
 		delete s_sectorRenderer;
@@ -390,6 +402,10 @@ namespace TFE_Jedi
 
 		s_adjoinDepth = 1;
 		s_maxAdjoinDepth = 1;
+		if (s_subRenderer != TSR_CLASSIC_GPU)
+		{
+			spriteCache_beginFrame();
+		}
 
 		if (s_subRenderer != TSR_CLASSIC_GPU)
 		{
@@ -406,7 +422,16 @@ namespace TFE_Jedi
 		{
 			TFE_ZONE("Sector Draw");
 			s_sectorRenderer->prepare();
-			s_sectorRenderer->draw(sector);
+			if (s_subRenderer == TSR_CLASSIC_FLOAT)
+			{
+				RClassic_Float::simd_selectKernels();
+				RClassic_Float::strips_setThreadCount(TFE_Settings::getGraphicsSettings()->rendererThreadCount);
+				RClassic_Float::strips_draw((TFE_Sectors_Float*)s_sectorRenderer, sector);
+			}
+			else
+			{
+				s_sectorRenderer->draw(sector);
+			}
 		}
 	}
 
@@ -422,8 +447,8 @@ namespace TFE_Jedi
 		}
 		else if (s_subRenderer == TSR_CLASSIC_FLOAT)
 		{
-			memset(s_rcfltState.depth1d_all, 0, s_width * sizeof(f32));
-			s_rcfltState.windowMinZ = 0.0f;
+			memset(s_rcfltState->depth1d_all, 0, s_width * sizeof(f32));
+			s_rcfltState->windowMinZ = 0.0f;
 		}
 	}
 }
@@ -0,0 +1,200 @@
+#include <cstring>
+#include <cstdlib>
+#include <unordered_map>
+
+#include "rspriteCache.h"
+#include "rcommon.h"
+#include <TFE_Jedi/Math/core_math.h>
+#include <TFE_Asset/spriteAsset_Jedi.h>
+#include <TFE_Settings/settings.h>
+#include <TFE_System/profiler.h>
+#include <TFE_System/Threads/mutex.h>
+
+namespace TFE_Jedi
+{
+	struct CachedCell
+	{
+		const WaxCell* cell;
+		CachedCell* prev;	// Toward the most recently used.
+		CachedCell* next;	// Toward the least recently used.
+		u32 size;
+		JBool pinned;		// Preloaded cells are not part of the LRU list.
+		// Followed by sizeX * sizeY texels.
+	};
+	typedef std::unordered_map<const WaxCell*, CachedCell*> CellMap;
+
+	static CellMap s_cells;
+	static CachedCell* s_lruHead = nullptr;
+	static CachedCell* s_lruTail = nullptr;
+	static Mutex* s_cacheMutex = nullptr;
+	static u32 s_lruBytes = 0;
+	static u32 s_pinnedBytes = 0;
+	static u32 s_cacheBudget = 0;
+
+	// Performance counters, reset every frame.
+	static s32 s_cellCacheHits = 0;
+	static s32 s_cellCacheMisses = 0;
+	static s32 s_cellCacheSizeKB = 0;
+
+	void spriteCache_init()
+	{
+		if (s_cacheMutex) { return; }
+		s_cacheMutex = Mutex::create();
+
+		TFE_COUNTER(s_cellCacheHits, "Sprite Cache Hits");
+		TFE_COUNTER(s_cellCacheMisses, "Sprite Cache Misses");
+		TFE_COUNTER(s_cellCacheSizeKB, "Sprite Cache Size (KB)");
+	}
+
+	void spriteCache_destroy()
+	{
+		spriteCache_clear();
+		delete s_cacheMutex;
+		s_cacheMutex = nullptr;
+	}
+
+	static void lru_remove(CachedCell* entry)
+	{
+		if (entry->prev) { entry->prev->next = entry->next; }
+		else { s_lruHead = entry->next; }
+		if (entry->next) { entry->next->prev = entry->prev; }
+		else { s_lruTail = entry->prev; }
+		entry->prev = nullptr;
+		entry->next = nullptr;
+	}
+
+	static void lru_pushFront(CachedCell* entry)
+	{
+		entry->prev = nullptr;
+		entry->next = s_lruHead;
+		if (s_lruHead) { s_lruHead->prev = entry; }
+		else { s_lruTail = entry; }
+		s_lruHead = entry;
+	}
+
+	static CachedCell* spriteCache_decompress(const WaxCell* cell, JBool pinned)
+	{
+		const u32 size = u32(cell->sizeX * cell->sizeY);
+		CachedCell* entry = (CachedCell*)malloc(sizeof(CachedCell) + size);
+		if (!entry) { return nullptr; }
+
+		entry->cell = cell;
+		entry->prev = nullptr;
+		entry->next = nullptr;
+		entry->size = size;
+		entry->pinned = pinned;
+
+		// Compressed cells store the column offsets (relative to the cell) right after the cell header.
+		// The output uses the same layout as uncompressed cells, see sprite_drawFrame().
+		const u32* columnOffset = (u32*)((u8*)cell + sizeof(WaxCell));
+		u8* image = (u8*)(entry + 1);
+		for (s32 x = 0; x < cell->sizeX; x++)
+		{
+			sprite_decompressColumn((u8*)cell + columnOffset[x], image + x * cell->sizeY, cell->sizeY);
+		}
+		return entry;
+	}
+
+	void spriteCache_clear()
+	{
+		if (!s_cacheMutex) { return; }
+		s_cacheMutex->lock();
+		for (CellMap::iterator iCell = s_cells.begin(); iCell != s_cells.end(); ++iCell)
+		{
+			free(iCell->second);
+		}
+		s_cells.clear();
+		s_lruHead = nullptr;
+		s_lruTail = nullptr;
+		s_lruBytes = 0;
+		s_pinnedBytes = 0;
+		s_cacheMutex->unlock();
+	}
+
+	void spriteCache_beginFrame()
+	{
+		const s32 sizeMB = TFE_Settings::getGraphicsSettings()->spriteCacheSizeMB;
+		s_cacheBudget = u32(max(0, sizeMB)) << 20u;
+
+		// Evict least recently used cells until the cache fits, no sprites are being drawn at this point.
+		while (s_lruTail && s_lruBytes > s_cacheBudget)
+		{
+			CachedCell* entry = s_lruTail;
+			lru_remove(entry);
+			s_cells.erase(entry->cell);
+			s_lruBytes -= entry->size;
+			free(entry);
+		}
+
+		s_cellCacheHits = 0;
+		s_cellCacheMisses = 0;
+		s_cellCacheSizeKB = s32((s_lruBytes + s_pinnedBytes) >> 10u);
+	}
+
+	const u8* spriteCache_getCell(const WaxCell* cell)
+	{
+		if (!s_cacheMutex || cell->compressed != 1) { return nullptr; }
+
+		s_cacheMutex->lock();
+		CachedCell* entry = nullptr;
+		CellMap::iterator iCell = s_cells.find(cell);
+		if (iCell != s_cells.end())
+		{
+			entry = iCell->second;
+			if (!entry->pinned)
+			{
+				lru_remove(entry);
+				lru_pushFront(entry);
+			}
+			s_cellCacheHits++;
+		}
+		else
+		{
+			s_cellCacheMisses++;
+			// Cells are only added while the cache is enabled, it may grow past the budget until the next frame.
+			if (s_cacheBudget)
+			{
+				entry = spriteCache_decompress(cell, JFALSE);
+				if (entry)
+				{
+					s_cells[cell] = entry;
+					lru_pushFront(entry);
+					s_lruBytes += entry->size;
+				}
+			}
+		}
+		s_cacheMutex->unlock();
+
+		return entry ? (u8*)(entry + 1) : nullptr;
+	}
+
+	void spriteCache_preloadCell(const WaxCell* cell)
+	{
+		if (!s_cacheMutex || !cell || cell->compressed != 1) { return; }
+		if (!TFE_Settings::getGraphicsSettings()->spriteCachePreload) { return; }
+
+		// Decompress outside of the lock, so sprites loaded on the job workers are decompressed in parallel.
+		CachedCell* entry = spriteCache_decompress(cell, JTRUE);
+		if (!entry) { return; }
+
+		s_cacheMutex->lock();
+		CellMap::iterator iCell = s_cells.find(cell);
+		if (iCell == s_cells.end())
+		{
+			s_cells[cell] = entry;
+			s_pinnedBytes += entry->size;
+			entry = nullptr;
+		}
+		else if (!iCell->second->pinned)
+		{
+			// Already cached on demand, keep that copy.
+			CachedCell* cached = iCell->second;
+			lru_remove(cached);
+			s_lruBytes -= cached->size;
+			s_pinnedBytes += cached->size;
+			cached->pinned = JTRUE;
+		}
+		s_cacheMutex->unlock();
+		free(entry);
+	}
+}  // namespace TFE_Jedi
@@ -0,0 +1,31 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Sprite Cell Cache
+// Keeps decompressed copies of RLE compressed WAX/FME cells so the
+// software renderers do not decode the same columns every frame.
+// Cells are keyed by pointer and stored column major, the same
+// layout as uncompressed cells (column x starts at x * sizeY).
+//
+// Entries are only evicted (least recently used first) at the start
+// of a frame, so pointers returned during the frame remain valid
+// while the strip workers are drawing. Preloaded cells are never
+// evicted, everything is freed when the sprite assets are freed.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+
+struct WaxCell;
+
+namespace TFE_Jedi
+{
+	void spriteCache_init();
+	void spriteCache_destroy();
+	// Apply the cache size setting and evict old cells, must be called while no sprites are being drawn.
+	void spriteCache_beginFrame();
+	// Free all cached cells, called when the cells themselves are freed.
+	void spriteCache_clear();
+
+	// Returns the decompressed cell image, or null if the cache is disabled. Safe to call from the strip workers.
+	const u8* spriteCache_getCell(const WaxCell* cell);
+	// Decompress a cell at load time and keep it until the cache is cleared.
+	void spriteCache_preloadCell(const WaxCell* cell);
+}
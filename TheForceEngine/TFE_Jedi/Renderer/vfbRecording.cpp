@@ -0,0 +1,207 @@
+#include <cstring>
+
+#include "virtualFramebuffer.h"
+#include <TFE_Asset/gifWriter.h>
+#include <TFE_System/system.h>
+#include <TFE_System/profiler.h>
+#include <TFE_System/Threads/thread.h>
+#include <TFE_System/Threads/signal.h>
+#include <algorithm>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////
+// Records the 8-bit virtual framebuffer to a lossless indexed GIF.
+// The game thread only copies the frame (and palette if it changed)
+// into a ring buffer, the encoder thread compresses and writes it.
+//////////////////////////////////////////////////////////////////////
+namespace TFE_Jedi
+{
+	enum
+	{
+		VFB_RECORD_RING_SIZE = 16,
+		VFB_RECORD_MIN_DELAY = 2,	// In centiseconds, most GIF players do not honor smaller delays.
+		VFB_RECORD_WAIT_MS = 100,
+	};
+
+	struct RecordedFrame
+	{
+		std::vector<u8> pixels;
+		u32 palette[256];
+		JBool paletteChanged;
+		u32 time;		// Centiseconds since the recording started.
+	};
+
+	static RecordedFrame s_frames[VFB_RECORD_RING_SIZE];
+	// The encoder keeps the oldest frame until the next one arrives, since GIF delays are stored per frame.
+	static atomic_u32 s_frameWrite;
+	static atomic_u32 s_frameRead;
+	static atomic_bool s_encoderRunning;
+	static Thread* s_encoderThread = nullptr;
+	static Signal* s_frameSignal = nullptr;
+
+	static JBool s_recording = JFALSE;
+	static u32 s_recordWidth;
+	static u32 s_recordHeight;
+	static u32 s_recordPalette[256];
+	static f64 s_recordStart;
+	static u32 s_lastFrameTime;
+	static u32 s_endTime;
+	static u32 s_framesRecorded;
+	static u32 s_framesDropped;
+
+	u32 vfb_getRecordingTime()
+	{
+		return u32((TFE_System::getTime() - s_recordStart) * 100.0);
+	}
+
+	void vfb_encodeFrame(u32 index, u32 nextTime)
+	{
+		TFE_ZONE("Encode GIF Frame");
+		const RecordedFrame* frame = &s_frames[index % VFB_RECORD_RING_SIZE];
+		const u32 delay = std::max(nextTime - frame->time, u32(VFB_RECORD_MIN_DELAY));
+		TFE_GIF::addIndexedFrame(frame->pixels.data(), frame->paletteChanged ? frame->palette : nullptr, delay);
+		s_frameRead.store(index + 1);
+	}
+
+	TFE_THREADRET TFE_STDCALL vfb_encoderFunc(void* userData)
+	{
+		TFE_Profiler::setThreadName("GIF Encoder");
+
+		u32 read = s_frameRead.load();
+		while (s_encoderRunning.load())
+		{
+			s_frameSignal->wait(VFB_RECORD_WAIT_MS);
+
+			const u32 write = s_frameWrite.load();
+			for (; write - read >= 2; read++)
+			{
+				vfb_encodeFrame(read, s_frames[(read + 1) % VFB_RECORD_RING_SIZE].time);
+			}
+		}
+
+		// Flush the remaining frames, the last one lasts until the recording was stopped.
+		const u32 write = s_frameWrite.load();
+		for (; read != write; read++)
+		{
+			vfb_encodeFrame(read, (write - read >= 2) ? s_frames[(read + 1) % VFB_RECORD_RING_SIZE].time : s_endTime);
+		}
+		TFE_GIF::endIndexedGif();
+
+		TFE_Profiler::releaseThread();
+		return (TFE_THREADRET)0;
+	}
+
+	JBool vfb_beginRecording(const char* path)
+	{
+		if (s_recording) { return JFALSE; }
+
+		u8* buffer = vfb_getCpuBuffer();
+		if (!buffer || vfb_getMode() != VFB_TEXTURE)
+		{
+			return JFALSE;
+		}
+
+		vfb_getResolution(&s_recordWidth, &s_recordHeight);
+		memcpy(s_recordPalette, vfb_getPalette(), sizeof(u32) * 256);
+		if (!TFE_GIF::startIndexedGif(path, s_recordWidth, s_recordHeight, s_recordPalette))
+		{
+			return JFALSE;
+		}
+
+		for (s32 i = 0; i < VFB_RECORD_RING_SIZE; i++)
+		{
+			s_frames[i].pixels.resize(s_recordWidth * s_recordHeight);
+		}
+		s_frameWrite.store(0);
+		s_frameRead.store(0);
+		s_recordStart = TFE_System::getTime();
+		s_lastFrameTime = 0;
+		s_framesRecorded = 0;
+		s_framesDropped = 0;
+
+		s_encoderRunning.store(true);
+		s_frameSignal = Signal::create();
+		s_encoderThread = Thread::create("GIF Encoder", vfb_encoderFunc, nullptr);
+		if (!s_encoderThread || !s_encoderThread->run())
+		{
+			TFE_System::logWrite(LOG_ERROR, "Recording", "Cannot start the GIF encoder thread.");
+			delete s_encoderThread;
+			delete s_frameSignal;
+			s_encoderThread = nullptr;
+			s_frameSignal = nullptr;
+			TFE_GIF::endIndexedGif();
+			return JFALSE;
+		}
+
+		s_recording = JTRUE;
+		TFE_System::logWrite(LOG_MSG, "Recording", "Recording %ux%u indexed GIF to '%s'.", s_recordWidth, s_recordHeight, path);
+		return JTRUE;
+	}
+
+	void vfb_endRecording()
+	{
+		if (!s_recording) { return; }
+		s_recording = JFALSE;
+
+		s_endTime = std::max(vfb_getRecordingTime(), s_lastFrameTime + VFB_RECORD_MIN_DELAY);
+		s_encoderRunning.store(false);
+		s_frameSignal->fire();
+		s_encoderThread->waitOnExit();
+
+		delete s_encoderThread;
+		delete s_frameSignal;
+		s_encoderThread = nullptr;
+		s_frameSignal = nullptr;
+		for (s32 i = 0; i < VFB_RECORD_RING_SIZE; i++)
+		{
+			s_frames[i].pixels.clear();
+			s_frames[i].pixels.shrink_to_fit();
+		}
+		TFE_System::logWrite(LOG_MSG, "Recording", "Recording finished: %u frames, %u dropped because the encoder fell behind.", s_framesRecorded, s_framesDropped);
+	}
+
+	JBool vfb_isRecording()
+	{
+		return s_recording;
+	}
+
+	// Called on vfb_swap(), the copy is the only per-frame cost on the game thread.
+	void vfb_recordFrame(const u8* pixels, u32 width, u32 height, const u32* palette)
+	{
+		TFE_ZONE("Record Frame");
+		if (width != s_recordWidth || height != s_recordHeight)
+		{
+			TFE_System::logWrite(LOG_WARNING, "Recording", "The resolution changed, stopping the recording.");
+			vfb_endRecording();
+			return;
+		}
+
+		const u32 time = vfb_getRecordingTime();
+		const u32 write = s_frameWrite.load();
+		if (write && time - s_lastFrameTime < VFB_RECORD_MIN_DELAY)
+		{
+			return;
+		}
+		if (write - s_frameRead.load() >= VFB_RECORD_RING_SIZE)
+		{
+			// The previous frame is simply shown for longer.
+			s_framesDropped++;
+			return;
+		}
+
+		RecordedFrame* frame = &s_frames[write % VFB_RECORD_RING_SIZE];
+		memcpy(frame->pixels.data(), pixels, width * height);
+		frame->paletteChanged = memcmp(palette, s_recordPalette, sizeof(u32) * 256) != 0 ? JTRUE : JFALSE;
+		if (frame->paletteChanged)
+		{
+			memcpy(s_recordPalette, palette, sizeof(u32) * 256);
+			memcpy(frame->palette, palette, sizeof(u32) * 256);
+		}
+		frame->time = time;
+		s_lastFrameTime = time;
+		s_framesRecorded++;
+
+		s_frameWrite.store(write + 1);
+		s_frameSignal->fire();
+	}
+}  // namespace TFE_Jedi
@@ -3,6 +3,7 @@
 #include "virtualFramebuffer.h"
 #include <TFE_RenderBackend/renderBackend.h>
 #include <TFE_Settings/settings.h>
+#include <TFE_System/frameLatency.h>
 
 namespace TFE_Jedi
 {
@@ -29,6 +30,8 @@ namespace TFE_Jedi
 	static FramebufferMode s_nextMode = VFB_TEXTURE;
 
 	void vfb_createVirtualDisplay(u32 width, u32 height);
+	// vfbRecording.cpp
+	void vfb_recordFrame(const u8* pixels, u32 width, u32 height, const u32* palette);
 		
 	////////////////////////////////////////////////////////////////////////
 	// Setup
@@ -191,6 +194,11 @@ namespace TFE_Jedi
 	// Frame rendering is done, copy the results to GPU memory.
 	void vfb_swap()
 	{
+		TFE_FrameLatency::stamp(LSTAMP_RENDER_END);
+		if (vfb_isRecording() && s_mode == VFB_TEXTURE)
+		{
+			vfb_recordFrame(s_curFrameBuffer, s_width, s_height, s_palette);
+		}
 		TFE_RenderBackend::updateVirtualDisplay(s_curFrameBuffer, s_width * s_height);
 	}
 
@@ -234,6 +242,11 @@ namespace TFE_Jedi
 		return s_width;
 	}
 
+	FramebufferMode vfb_getMode()
+	{
+		return s_mode;
+	}
+
 	////////////////////////////
 	// Internal
 	////////////////////////////
@@ -77,4 +77,14 @@ namespace TFE_Jedi
 	void vfb_getResolution(u32* width, u32* height);
 	// Returns the stride for rendering stride
 	u32 vfb_getStride();
+	FramebufferMode vfb_getMode();
+
+	////////////////////////////
+	// Recording
+	////////////////////////////
+	// Record the 8-bit framebuffer to a lossless GIF, encoded on a background thread.
+	// Only available in VFB_TEXTURE mode, returns JFALSE otherwise.
+	JBool vfb_beginRecording(const char* path);
+	void  vfb_endRecording();
+	JBool vfb_isRecording();
 }  // namespace TFE_Jedi
\ No newline at end of file
@@ -2,11 +2,15 @@
 
 #include "task.h"
 #include <TFE_Memory/chunkedArray.h>
+#include <TFE_Memory/snapshot.h>
 #include <TFE_DarkForces/time.h>
 #include <TFE_System/system.h>
 #include <TFE_Game/igame.h>
 #include <TFE_System/profiler.h>
+#include <TFE_FrontEndUI/console.h>
 #include <stdarg.h>
+#include <algorithm>
+#include <set>
 #include <tuple>
 #include <vector>
 
@@ -62,6 +66,14 @@ struct Task
 	// Timing.
 	Tick nextTick;
 	s32 activeIndex;
+
+	// Scheduling (TFE): tasks are linked in execution order and labelled so the
+	// scheduler can find the next runnable task without visiting idle tasks.
+	Task* orderPrev;
+	Task* orderNext;
+	u64 order;
+	u32 timerId;		// Changes whenever the task is rescheduled, invalidating older timer entries.
+	JBool ready;		// JTRUE if the task is in the ready set.
 };
 
 namespace TFE_Jedi
@@ -90,9 +102,205 @@ namespace TFE_Jedi
 	static f64 s_minIntervalInSec = 0.0;
 	static s32 s_frameActiveTaskCount = 0;
 	static JBool s_taskSystemPaused = JFALSE;
+	static s32 s_frameStepCount = 0;
+	static TaskStepCallback s_stepCallback = nullptr;
+	static TaskStepCallback s_repeatStepCallback = nullptr;
 	static Task* s_taskPauseTask = nullptr;
 
 	void selectNextTask();
+	void task_runUpdate();
+	void task_clearSchedule();
+	void task_rebuildSchedule();
+	void console_taskBenchmark(const ConsoleArgList& args);
+
+	/////////////////////////////////////////////
+	// Scheduler
+	// Execution order is a post-order walk of the task tree: the subtasks
+	// of a task run before it, and the main tasks follow the ring that
+	// starts at the root (the root's own subtasks run last, just before
+	// the walk wraps around). Each task gets a label that increases along
+	// this order.
+	//
+	// Tasks that can run this tick (nextTick <= s_curTick, or framebreak)
+	// are kept in a set sorted by label. Delayed tasks wait in a timer heap
+	// keyed on nextTick. Sleeping tasks are in neither until woken. So
+	// selectNextTask() only looks at tasks that can actually run, and picks
+	// the same task as walking the whole list.
+	/////////////////////////////////////////////
+	struct TaskOrder
+	{
+		bool operator()(const Task* a, const Task* b) const { return a->order < b->order; }
+	};
+
+	struct TaskTimer
+	{
+		Tick tick;
+		u32  id;
+		Task* task;
+	};
+
+	static std::set<Task*, TaskOrder> s_readyTasks;
+	static std::vector<TaskTimer> s_timers;
+	static u32  s_timerId = 0;
+	static Tick s_scheduleTick = 0;
+	// Use the original linear walk, for comparison.
+	static JBool s_linearSchedule = JFALSE;
+
+	static bool timerLater(const TaskTimer& a, const TaskTimer& b)
+	{
+		return a.tick > b.tick;
+	}
+
+	void task_resetRootOrder()
+	{
+		s_rootTask.orderPrev = &s_rootTask;
+		s_rootTask.orderNext = &s_rootTask;
+		s_rootTask.order = 0;
+	}
+
+	// Spread the labels evenly, this keeps the relative order so the ready set remains valid.
+	void task_relabel()
+	{
+		u64 count = 0;
+		for (Task* task = s_rootTask.orderNext; task != &s_rootTask; task = task->orderNext)
+		{
+			count++;
+		}
+		const u64 step = UINT64_MAX / (count + 1);
+		u64 order = step;
+		for (Task* task = s_rootTask.orderNext; task != &s_rootTask; task = task->orderNext, order += step)
+		{
+			task->order = order;
+		}
+	}
+
+	// Insert 'task' into the execution order just before 'next', which may be the root (the end of the order).
+	void task_insertOrder(Task* task, Task* next)
+	{
+		Task* prev = next->orderPrev;
+		task->orderPrev = prev;
+		task->orderNext = next;
+		prev->orderNext = task;
+		next->orderPrev = task;
+
+		const u64 lo = prev->order;
+		const u64 hi = (next == &s_rootTask) ? UINT64_MAX : next->order;
+		if (hi - lo < 2)
+		{
+			task_relabel();
+		}
+		else
+		{
+			task->order = lo + (hi - lo) / 2;
+		}
+	}
+
+	void task_removeOrder(Task* task)
+	{
+		if (task->orderPrev) { task->orderPrev->orderNext = task->orderNext; }
+		if (task->orderNext) { task->orderNext->orderPrev = task->orderPrev; }
+		task->orderPrev = nullptr;
+		task->orderNext = nullptr;
+	}
+
+	// The first task in execution order within the task's tree, which is where the tree starts.
+	Task* task_getFirstInTree(Task* task)
+	{
+		while (task->subtaskNext)
+		{
+			task = task->subtaskNext;
+		}
+		return task;
+	}
+
+	void task_setReady(Task* task, JBool ready)
+	{
+		if (task->ready == ready) { return; }
+		task->ready = ready;
+		if (ready)
+		{
+			s_readyTasks.insert(task);
+		}
+		else
+		{
+			s_readyTasks.erase(task);
+		}
+	}
+
+	// Called whenever nextTick changes.
+	void task_schedule(Task* task)
+	{
+		if (task == &s_rootTask) { return; }
+
+		task->timerId = ++s_timerId;
+		const JBool ready = (task->framebreak || task->nextTick <= s_curTick) ? JTRUE : JFALSE;
+		task_setReady(task, ready);
+		if (!ready && task->nextTick != TASK_SLEEP)
+		{
+			s_timers.push_back({ task->nextTick, task->timerId, task });
+			std::push_heap(s_timers.begin(), s_timers.end(), timerLater);
+		}
+	}
+
+	// Move the tasks that became runnable since the last update into the ready set.
+	void task_updateTimers()
+	{
+		if (s_curTick < s_scheduleTick)
+		{
+			// Time went backwards, reschedule everything.
+			s_timers.clear();
+			for (Task* task = s_rootTask.orderNext; task && task != &s_rootTask; task = task->orderNext)
+			{
+				task_schedule(task);
+			}
+		}
+		s_scheduleTick = s_curTick;
+
+		while (!s_timers.empty() && s_timers.front().tick <= s_curTick)
+		{
+			const TaskTimer timer = s_timers.front();
+			std::pop_heap(s_timers.begin(), s_timers.end(), timerLater);
+			s_timers.pop_back();
+			// Skip entries for tasks that have been rescheduled or freed since.
+			if (timer.task->timerId == timer.id)
+			{
+				task_setReady(timer.task, JTRUE);
+			}
+		}
+
+		// Drop stale entries if they start to pile up.
+		if (s_timers.size() > size_t(2 * s_taskCount + 256))
+		{
+			size_t count = 0;
+			for (size_t i = 0; i < s_timers.size(); i++)
+			{
+				if (s_timers[i].task->timerId == s_timers[i].id) { s_timers[count++] = s_timers[i]; }
+			}
+			s_timers.resize(count);
+			std::make_heap(s_timers.begin(), s_timers.end(), timerLater);
+		}
+	}
+
+	void task_clearSchedule()
+	{
+		s_readyTasks.clear();
+		s_timers.clear();
+		s_scheduleTick = s_curTick;
+		task_resetRootOrder();
+	}
+
+	// The ready set and timers are not part of a snapshot, rebuild them from the restored tasks.
+	void task_rebuildSchedule()
+	{
+		s_readyTasks.clear();
+		s_timers.clear();
+		s_scheduleTick = s_curTick;
+		for (Task* task = s_rootTask.orderNext; task && task != &s_rootTask; task = task->orderNext)
+		{
+			task->ready = JFALSE;
+			task_schedule(task);
+		}
+	}
 
 	void createRootTask()
 	{
@@ -103,6 +311,7 @@ namespace TFE_Jedi
 		s_rootTask.prev = &s_rootTask;
 		s_rootTask.next = &s_rootTask;
 		s_rootTask.nextTick = TASK_SLEEP;
+		task_clearSchedule();
 
 		s_taskIter = &s_rootTask;
 		s_curTask = &s_rootTask;
@@ -123,6 +332,9 @@ namespace TFE_Jedi
 		s_taskCount++;
 		strcpy(newTask->name, name);
 
+		// The new subtask runs first in the current task's tree.
+		task_insertOrder(newTask, task_getFirstInTree(s_curTask));
+
 		// Insert newTask at the head of the subtask list in the current "mainline" task.
 		newTask->next = s_curTask->subtaskNext;
 		newTask->prev = nullptr;
@@ -146,6 +358,9 @@ namespace TFE_Jedi
 		newTask->context.callstack[0] = func;
 		newTask->localRunFunc = localRunFunc;
 		newTask->context.level = TASK_INIT_LEVEL;
+
+		newTask->ready = JFALSE;
+		task_schedule(newTask);
 		return newTask;
 	}
 
@@ -170,6 +385,8 @@ namespace TFE_Jedi
 		}
 		newTask->prev = s_taskIter;
 		s_taskIter->next = newTask;
+		// The task tree for 's_taskIter' ends with 's_taskIter' itself.
+		task_insertOrder(newTask, s_taskIter->orderNext);
 		
 		newTask->subtaskNext = nullptr;
 		newTask->subtaskParent = nullptr;
@@ -183,6 +400,8 @@ namespace TFE_Jedi
 		newTask->context.level = TASK_INIT_LEVEL;
 		newTask->nextTick = s_curTick;
 
+		newTask->ready = JFALSE;
+		task_schedule(newTask);
 		return newTask;
 	}
 
@@ -226,6 +445,11 @@ namespace TFE_Jedi
 			parent->subtaskNext = task->next;
 		}
 		
+		// Remove the task from the scheduler.
+		task_setReady(task, JFALSE);
+		task_removeOrder(task);
+		task->timerId = ++s_timerId;
+
 		// Free any memory allocated for the local context.
 		freeToChunkedArray(s_stackBlocks, task->context.stackMem);
 		// Finally free the task itself from the chunked array.
@@ -239,6 +463,7 @@ namespace TFE_Jedi
 		s_rootTask.prev = &s_rootTask;
 		s_rootTask.next = &s_rootTask;
 		s_rootTask.nextTick = TASK_SLEEP;
+		task_clearSchedule();
 
 		s_taskIter = &s_rootTask;
 		s_curTask = &s_rootTask;
@@ -250,6 +475,7 @@ namespace TFE_Jedi
 	{
 		chunkedArrayClear(s_tasks);
 		chunkedArrayClear(s_stackBlocks);
+		task_clearSchedule();
 
 		s_curTask    = nullptr;
 		s_curContext = nullptr;
@@ -261,6 +487,7 @@ namespace TFE_Jedi
 		freeChunkedArray(s_tasks);
 		freeChunkedArray(s_stackBlocks);
 
+		task_clearSchedule();
 		s_curTask     = nullptr;
 		s_taskIter    = nullptr;
 		s_tasks       = nullptr;
@@ -271,17 +498,21 @@ namespace TFE_Jedi
 		s_prevTime = 0.0;
 		s_minIntervalInSec = 0.0;
 		s_frameActiveTaskCount = 0;
+		s_stepCallback = nullptr;
+		s_repeatStepCallback = nullptr;
 		s_taskPauseTask = nullptr;
 	}
 
 	void task_makeActive(Task* task)
 	{
 		task->nextTick = 0;
+		task_schedule(task);
 	}
 
 	void task_setNextTick(Task* task, Tick tick)
 	{
 		task->nextTick = tick;
+		task_schedule(task);
 	}
 
 	void task_setUserData(Task* task, void* data)
@@ -360,7 +591,8 @@ namespace TFE_Jedi
 		}
 	}
 
-	void selectNextTask()
+	// The original walk over every task, kept for comparison (see "taskBenchmark").
+	JBool selectNextTask_Linear()
 	{
 		// Find the next task to run.
 		Task* task = s_curTask;
@@ -389,7 +621,7 @@ namespace TFE_Jedi
 				{
 					s_currentMsg = MSG_RUN_TASK;
 					s_curTask = task;
-					return;
+					return JTRUE;
 				}
 			}
 			else if (task->subtaskParent)
@@ -400,7 +632,7 @@ namespace TFE_Jedi
 				{
 					s_currentMsg = MSG_RUN_TASK;
 					s_curTask = task;
-					return;
+					return JTRUE;
 				}
 			}
 			else
@@ -414,6 +646,43 @@ namespace TFE_Jedi
 		{
 			s_curTask = (Task*)chunkedArrayGet(s_tasks, 0);
 		}
+		return JFALSE;
+	}
+
+	// Returns JFALSE if no task can run.
+	JBool selectNextTask_Scheduled()
+	{
+		task_updateTimers();
+
+		// The next runnable task after the current one in execution order, wrapping around.
+		std::set<Task*, TaskOrder>::iterator next = s_readyTasks.upper_bound(s_curTask);
+		if (next == s_readyTasks.end())
+		{
+			next = s_readyTasks.begin();
+		}
+		if (next != s_readyTasks.end())
+		{
+			s_currentMsg = MSG_RUN_TASK;
+			s_curTask = *next;
+			return JTRUE;
+		}
+
+		// If no selection is possible, assign the first task.
+		if (!s_curTask && s_taskCount)
+		{
+			s_curTask = (Task*)chunkedArrayGet(s_tasks, 0);
+		}
+		return JFALSE;
+	}
+
+	JBool selectNextTask_Internal()
+	{
+		return s_linearSchedule ? selectNextTask_Linear() : selectNextTask_Scheduled();
+	}
+
+	void selectNextTask()
+	{
+		selectNextTask_Internal();
 	}
 
 	void itask_run(Task* task, MessageType msg)
@@ -476,6 +745,7 @@ namespace TFE_Jedi
 
 		// Update the current tick based on the delay.
 		s_curTask->nextTick = (delay < TASK_SLEEP) ? s_curTick + delay : delay;
+		task_schedule(s_curTask);
 		
 		// Find the next task to run.
 		selectNextTask();
@@ -489,6 +759,21 @@ namespace TFE_Jedi
 		s_minIntervalInSec = minIntervalInSec;
 	}
 
+	void task_setStepCallback(TaskStepCallback callback)
+	{
+		s_stepCallback = callback;
+	}
+
+	void task_setRepeatStepCallback(TaskStepCallback callback)
+	{
+		s_repeatStepCallback = callback;
+	}
+
+	s32 task_getFrameStep()
+	{
+		return s_frameStepCount;
+	}
+
 	JBool task_canRun()
 	{
 		if (s_taskCount)
@@ -512,6 +797,27 @@ namespace TFE_Jedi
 		}
 		TFE_ZONE("Task System");
 
+		// TFE: With a fixed timestep, the game time decides how many updates run this frame - possibly none.
+		// While paused the game time is frozen, so the pause task runs at the normal rate below.
+		if (time_getFixedStep() && !s_taskSystemPaused)
+		{
+			s_frameStepCount = 0;
+			while (s_taskCount && !s_taskSystemPaused && time_stepFixed())
+			{
+				if (s_frameStepCount && s_repeatStepCallback)
+				{
+					s_repeatStepCallback();
+				}
+				task_runUpdate();
+				s_frameStepCount++;
+				if (s_stepCallback)
+				{
+					s_stepCallback();
+				}
+			}
+			return s_frameStepCount ? JTRUE : JFALSE;
+		}
+
 		// Limit the update rate by the minimum interval.
 		// Dark Forces uses discrete 'ticks' to track time and the game behavior is very odd with 0 tick frames.
 		const f64 time = TFE_System::getTime();
@@ -520,6 +826,15 @@ namespace TFE_Jedi
 			return JFALSE;
 		}
 		s_prevTime = time;
+		s_frameStepCount = 0;
+		task_runUpdate();
+		s_frameStepCount = 1;
+		return JTRUE;
+	}
+
+	// Run the tasks for a single update.
+	void task_runUpdate()
+	{
 		s_currentMsg = MSG_RUN_TASK;
 		s_frameActiveTaskCount = 0;
 
@@ -544,7 +859,7 @@ namespace TFE_Jedi
 					}
 				}
 			}
-			return JTRUE;
+			return;
 		}
 
 		// Keep processing tasks until the "framebreak" task is hit.
@@ -571,9 +886,10 @@ namespace TFE_Jedi
 					runFunc(s_currentMsg);
 				}
 			}
-			else
+			else if (!selectNextTask_Internal())
 			{
-				selectNextTask();
+				// Nothing can run (there is no framebreak task).
+				break;
 			}
 
 			if (framebreak)
@@ -581,7 +897,6 @@ namespace TFE_Jedi
 				break;
 			}
 		}
-		return JTRUE;
 	}
 
 	void task_setDefaults()
@@ -591,6 +906,22 @@ namespace TFE_Jedi
 
 		TFE_COUNTER(s_taskCount, "Task Count");
 		TFE_COUNTER(s_frameActiveTaskCount, "Active Tasks");
+		TFE_COUNTER(s_frameStepCount, "Task Updates");
+
+		// The tasks themselves live in the game region.
+		SNAPSHOT_GLOBAL(s_tasks);
+		SNAPSHOT_GLOBAL(s_stackBlocks);
+		SNAPSHOT_GLOBAL(s_taskCount);
+		SNAPSHOT_GLOBAL(s_rootTask);
+		SNAPSHOT_GLOBAL(s_taskIter);
+		SNAPSHOT_GLOBAL(s_curTask);
+		SNAPSHOT_GLOBAL(s_currentMsg);
+		SNAPSHOT_GLOBAL(s_curContext);
+		SNAPSHOT_GLOBAL(s_taskSystemPaused);
+		SNAPSHOT_GLOBAL(s_taskPauseTask);
+		SNAPSHOT_GLOBAL(s_timerId);
+		TFE_Memory::snapshot_registerRestoreCallback(task_rebuildSchedule);
+		CCMD("taskBenchmark", console_taskBenchmark, 0, "Run the task scheduler benchmark, optional argument: task count (default 10000).");
 	}
 
 	s32 task_getCount()
@@ -598,6 +929,220 @@ namespace TFE_Jedi
 		return s_taskCount;
 	}
 
+	/////////////////////////////////////////////
+	// Benchmark
+	// Runs a private task tree of sleeping and delayed subtasks with both
+	// the scheduler and the original linear walk, and checks that the
+	// tasks ran in the same order.
+	/////////////////////////////////////////////
+	enum
+	{
+		BENCH_GROUP_COUNT = 8,
+		BENCH_FRAME_COUNT = 1000,
+		BENCH_WAKE_PER_FRAME = 4,
+	};
+
+	static u32 s_benchHash;
+	static s32 s_benchRunCount;
+	static u32 s_benchWakeIndex;
+	static Task** s_benchSleepers;
+	static s32 s_benchSleeperCount;
+
+	static u32 benchRandom(u32 x)
+	{
+		x ^= x >> 16;
+		x *= 0x7feb352du;
+		x ^= x >> 15;
+		x *= 0x846ca68bu;
+		x ^= x >> 16;
+		return x;
+	}
+
+	static u32 benchRecordRun()
+	{
+		const u32 id = u32(size_t(task_getUserData()));
+		s_benchHash = (s_benchHash ^ id) * 16777619u;
+		s_benchRunCount++;
+		return id;
+	}
+
+	void benchSleepTaskFunc(MessageType msg)
+	{
+		task_begin;
+		while (1)
+		{
+			benchRecordRun();
+			task_yield(TASK_SLEEP);
+		}
+		task_end;
+	}
+
+	void benchDelayTaskFunc(MessageType msg)
+	{
+		task_begin;
+		while (1)
+		{
+			task_yield(16 + benchRandom(benchRecordRun() ^ s_curTick) % 512);
+		}
+		task_end;
+	}
+
+	void benchOnceTaskFunc(MessageType msg)
+	{
+		task_begin;
+		benchRecordRun();
+		task_end;
+	}
+
+	// Runs every frame and wakes a few of the sleeping tasks, similar to messages sent to elevators.
+	// Short lived subtasks are also added to exercise task creation and removal.
+	void benchFrameTaskFunc(MessageType msg)
+	{
+		task_begin;
+		while (1)
+		{
+			if ((benchRecordRun() + s_benchRunCount) % 8 == 0)
+			{
+				Task* once = createSubTask("bench once", benchOnceTaskFunc);
+				task_setUserData(once, (void*)size_t(s_benchRunCount));
+			}
+			for (s32 i = 0; i < BENCH_WAKE_PER_FRAME && s_benchSleeperCount; i++)
+			{
+				task_makeActive(s_benchSleepers[benchRandom(s_benchWakeIndex++) % u32(s_benchSleeperCount)]);
+			}
+			task_yield(TASK_NO_DELAY);
+		}
+		task_end;
+	}
+
+	// Returns the time in seconds spent running the tasks.
+	f64 task_runBenchmark(s32 count, JBool linear)
+	{
+		// Swap out the task system state, so the benchmark starts from scratch and the game is not disturbed.
+		ChunkedArray* tasks = s_tasks;
+		ChunkedArray* stackBlocks = s_stackBlocks;
+		const Task rootTask = s_rootTask;
+		Task* taskIter = s_taskIter;
+		Task* curTask = s_curTask;
+		TaskContext* curContext = s_curContext;
+		const MessageType currentMsg = s_currentMsg;
+		const s32 taskCount = s_taskCount;
+		const s32 frameActiveTaskCount = s_frameActiveTaskCount;
+		const JBool taskSystemPaused = s_taskSystemPaused;
+		const f64 prevTime = s_prevTime;
+		const f64 minIntervalInSec = s_minIntervalInSec;
+		const s32 fixedStep = time_getFixedStep();
+		const Tick curTick = s_curTick;
+		const Tick scheduleTick = s_scheduleTick;
+		const JBool linearSchedule = s_linearSchedule;
+		std::set<Task*, TaskOrder> readyTasks;
+		std::vector<TaskTimer> timers;
+		readyTasks.swap(s_readyTasks);
+		timers.swap(s_timers);
+
+		s_curTick = 0;
+		s_taskSystemPaused = JFALSE;
+		s_minIntervalInSec = 0.0;
+		time_setFixedStep(0);
+		s_linearSchedule = linear;
+		createRootTask();
+
+		s_benchHash = 2166136261u;
+		s_benchRunCount = 0;
+		s_benchWakeIndex = 0;
+		s_benchSleeperCount = 0;
+		s_benchSleepers = (Task**)malloc(sizeof(Task*) * count);
+
+		// The framebreak task is created first, so it is last in the ring.
+		Task* frameTask = createTask("bench frame", benchFrameTaskFunc, JTRUE);
+		task_setUserData(frameTask, (void*)size_t(1));
+		for (s32 g = 0; g < BENCH_GROUP_COUNT; g++)
+		{
+			Task* group = createTask("bench group", benchDelayTaskFunc);
+			task_setUserData(group, (void*)size_t(2 + g));
+
+			s_curTask = group;
+			for (s32 i = g; i < count; i += BENCH_GROUP_COUNT)
+			{
+				const JBool sleeping = (i & 1) ? JTRUE : JFALSE;
+				Task* task = createSubTask(sleeping ? "bench sleep" : "bench delay", sleeping ? benchSleepTaskFunc : benchDelayTaskFunc);
+				task_setUserData(task, (void*)size_t(2 + BENCH_GROUP_COUNT + i));
+				if (sleeping) { s_benchSleepers[s_benchSleeperCount++] = task; }
+			}
+			s_curTask = &s_rootTask;
+		}
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		for (s32 f = 0; f < BENCH_FRAME_COUNT; f++)
+		{
+			// About 2 ticks per frame at 60 fps.
+			s_curTick += 2;
+			task_run();
+		}
+		const f64 elapsed = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+
+		free(s_benchSleepers);
+		s_benchSleepers = nullptr;
+		s_benchSleeperCount = 0;
+		freeChunkedArray(s_tasks);
+		freeChunkedArray(s_stackBlocks);
+
+		s_tasks = tasks;
+		s_stackBlocks = stackBlocks;
+		s_rootTask = rootTask;
+		s_taskIter = taskIter;
+		s_curTask = curTask;
+		s_curContext = curContext;
+		s_currentMsg = currentMsg;
+		s_taskCount = taskCount;
+		s_frameActiveTaskCount = frameActiveTaskCount;
+		s_taskSystemPaused = taskSystemPaused;
+		s_prevTime = prevTime;
+		s_minIntervalInSec = minIntervalInSec;
+		time_setFixedStep(fixedStep);
+		s_curTick = curTick;
+		s_scheduleTick = scheduleTick;
+		s_linearSchedule = linearSchedule;
+		s_readyTasks.swap(readyTasks);
+		s_timers.swap(timers);
+		return elapsed;
+	}
+
+	void console_taskBenchmark(const ConsoleArgList& args)
+	{
+		if (!s_gameRegion)
+		{
+			TFE_Console::addToHistory("The task benchmark requires the game memory to be allocated.");
+			return;
+		}
+
+		s32 count = 10000;
+		if (args.size() >= 2)
+		{
+			count = max(1, atoi(args[1].c_str()));
+		}
+
+		const f64 linearTime = task_runBenchmark(count, JTRUE);
+		const u32 linearHash = s_benchHash;
+		const s32 linearRuns = s_benchRunCount;
+		const f64 scheduledTime = task_runBenchmark(count, JFALSE);
+
+		char msg[256];
+		sprintf(msg, "Task benchmark: %d tasks, %d frames, %d task runs.", count + BENCH_GROUP_COUNT + 1, BENCH_FRAME_COUNT, s_benchRunCount);
+		TFE_Console::addToHistory(msg);
+		sprintf(msg, "  Linear walk: %0.3f ms/frame, Scheduler: %0.3f ms/frame.", linearTime * 1000.0 / BENCH_FRAME_COUNT, scheduledTime * 1000.0 / BENCH_FRAME_COUNT);
+		TFE_Console::addToHistory(msg);
+		if (linearHash != s_benchHash || linearRuns != s_benchRunCount)
+		{
+			TFE_Console::addToHistory("  Execution order MISMATCH between the scheduler and the linear walk.");
+			TFE_System::logWrite(LOG_ERROR, "Task", "Task benchmark: the scheduler ran the tasks in a different order than the linear walk.");
+		}
+		else
+		{
+			TFE_Console::addToHistory("  Execution order matches.");
+		}
+	}
+
 	s32 ctxGetIP()
 	{
 		assert(s_curContext->level >= 0 && s_curContext->level < TASK_MAX_LEVELS);
@@ -25,6 +25,9 @@ enum TaskDelay
 	TASK_NO_DELAY = 0,
 };
 
+// TFE: Called after each task update when the game runs with a fixed timestep.
+typedef void(*TaskStepCallback)();
+
 ////////////////////////////////////////////////////////////////////////
 // Task System API
 namespace TFE_Jedi
@@ -64,6 +67,11 @@ namespace TFE_Jedi
 	JBool task_canRun();
 	void task_setDefaults();
 	void task_setMinStepInterval(f64 minIntervalInSec);
+	void task_setStepCallback(TaskStepCallback callback);
+	// TFE: Called before every update after the first in a frame, so per-frame input can be consumed by a single update.
+	void task_setRepeatStepCallback(TaskStepCallback callback);
+	// TFE: Index of the update being run in the current frame, 0 for the first.
+	s32  task_getFrameStep();
 
 	s32 task_getCount();
 }
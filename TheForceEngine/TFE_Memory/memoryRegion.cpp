@@ -10,6 +10,11 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <algorithm>
+#include <unordered_map>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 // #define _VERIFY_MEMORY
 
@@ -24,34 +29,69 @@ using namespace TFE_Jedi;
 enum
 {
 	MIN_SPLIT_SIZE = 32,
+	MIN_ALLOC_SIZE = 32,	// Room for the free header and the size stored at the end of free allocations.
 	BLOCK_ARR_STEP = 16,
 	ALIGNMENT = 8,
-	ALLOC_BIN_COUNT = 6,
-	ALLOC_BIN_LAST = 5,
+	ALIGNMENT_LOG2 = 3,
 	// No more then 256 blocks, and no more than 16MB per block for a total of 4GB.
 	MAX_BLOCK_COUNT = 256,
 	MAX_BLOCK_SIZE  = 16 * 1024 * 1024,
+	MAX_BLOCK_SIZE_LOG2 = 24,
 	RELATIVE_NON_NULL_BIT = 1u,
 	SHARED_HEADER_SIZE = 8,	// 8 bytes are shared between RegionAllocHeader{} and AllocHeaderFree{}
+
+	// Two level segregated fit (TLSF) free lists.
+	// The first level is the power of 2 size range, the second level splits each range into 16 linear classes.
+	// Sizes below FREE_SMALL_SIZE all use first level 0, with classes that are ALIGNMENT bytes apart.
+	FREE_SL_LOG2 = 4,
+	FREE_SL_COUNT = 1 << FREE_SL_LOG2,
+	FREE_FL_SHIFT = FREE_SL_LOG2 + ALIGNMENT_LOG2,
+	FREE_SMALL_SIZE = 1 << FREE_FL_SHIFT,
+	FREE_FL_COUNT = MAX_BLOCK_SIZE_LOG2 - FREE_FL_SHIFT + 2,
+};
+
+// Operations recorded by region_beginTrace().
+enum RegionTraceOpType
+{
+	TRACE_CREATE = 0,	// id = max blocks, size = block size.
+	TRACE_ALLOC,
+	TRACE_REALLOC,
+	TRACE_FREE,
+	TRACE_CLEAR,
+	TRACE_DESTROY,
+	TRACE_COUNT
+};
+
+struct RegionTraceOp
+{
+	u8  op;
+	u8  region;	// Index in the order the regions were first seen.
+	u16 pad16;
+	u32 id;		// Allocation id, 0 = not traced.
+	u32 size;	// Requested size.
 };
 
 struct RegionAllocHeader
 {
 	u32 size;
 	u8  free;
-	u8  bin;
-	u8  pad8[2];
+	u8  prevFree;	// The previous allocation in the block is free, its size is stored in the 4 bytes before this header.
+	u8  blockIndex;	// Block that owns the allocation, so freeing does not have to search.
+	u8  pad8;
 	u64 pad; // pad to 16 bytes.
 };
 
 // free structure is larger than header, because it fits within the
 // alignment: align(8, sizeof(header)=16 + size), so at least 24 bytes is allocated.
+// Free allocations also store their size in the last 4 bytes, so the next
+// allocation can merge backward when freed - see MIN_ALLOC_SIZE.
 struct AllocHeaderFree
 {
 	u32 size;
 	u8  free;
-	u8  bin;
-	u8  pad8[2];
+	u8  prevFree;
+	u8  blockIndex;
+	u8  pad8;
 	AllocHeaderFree* binNext;
 	AllocHeaderFree* binPrev;
 };
@@ -60,15 +100,12 @@ struct MemoryBlock
 {
 	u32 sizeFree;
 	u32 count;
-	// Head pointer to each bin.
-	// Bin index = clamp(log2(nextPow2(size)) - 5, 0, 5)
-	// bin 0: [0,  32]
-	//     1: [33, 64]
-	//     2: [65, 128]
-	//     3: [129, 256]
-	//     4: [257, 512]
-	//     5: [513+]
-	AllocHeaderFree* freeListBins[ALLOC_BIN_COUNT];
+	// Bit 'fl' is set if any list in freeLists[fl][] is not empty.
+	u32 flBitmap;
+	// Bit 'sl' is set if freeLists[fl][sl] is not empty.
+	u16 slBitmap[FREE_FL_COUNT];
+	// Head pointer to each size class.
+	AllocHeaderFree* freeLists[FREE_FL_COUNT][FREE_SL_COUNT];
 };
 
 struct MemoryRegion
@@ -80,10 +117,15 @@ struct MemoryRegion
 	size_t blockCount;
 	size_t blockSize;
 	size_t maxBlocks;
+
+	// Statistics, not part of the serialized state.
+	RegionStats stats;
 };
 
 static_assert(sizeof(RegionAllocHeader) == 16, "RegionAllocHeader is the wrong size.");
 static_assert(sizeof(AllocHeaderFree) == 24, "AllocHeaderFree is the wrong size.");
+static_assert((sizeof(MemoryBlock) & (ALIGNMENT - 1)) == 0, "MemoryBlock must keep allocations aligned.");
+static_assert(FREE_FL_COUNT <= 32 && FREE_SL_COUNT <= 16, "The free list bitmaps are too small.");
 
 namespace TFE_Memory
 {
@@ -92,12 +134,104 @@ namespace TFE_Memory
 	static const u32 c_relativeBlockShift = 24u;
 	static const u32 c_relativeOffsetMask = (1u << c_relativeBlockShift) - 1u;
 
-	void freeSlot(RegionAllocHeader* alloc, RegionAllocHeader* next, MemoryBlock* block);
+	static bool s_trackLatency = false;
+
+	void freeSlot(RegionAllocHeader* alloc, MemoryBlock* block, u8* blockEnd);
 	size_t alloc_align(size_t baseSize);
-	s32  getBinFromSize(u32 size);
 	bool allocateNewBlock(MemoryRegion* region);
 	void removeHeaderFromFreelist(MemoryBlock* block, RegionAllocHeader* header);
-	void insertBlockIntoFreelist(MemoryBlock* block, RegionAllocHeader* header);
+	void insertBlockIntoFreelist(MemoryBlock* block, RegionAllocHeader* header, u8* blockEnd);
+	void linkFreeHeader(MemoryBlock* block, AllocHeaderFree* header);
+	void trace_record(MemoryRegion* region, u8 op, void* ptr, void* newPtr, size_t size);
+
+	// Index of the lowest and highest set bits, 'x' must not be zero.
+	static inline s32 bitScanForward(u32 x)
+	{
+	#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, x);
+		return s32(index);
+	#else
+		return __builtin_ctz(x);
+	#endif
+	}
+
+	static inline s32 bitScanReverse(u32 x)
+	{
+	#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse(&index, x);
+		return s32(index);
+	#else
+		return 31 - __builtin_clz(x);
+	#endif
+	}
+
+	// Size class that an allocation of 'size' bytes belongs to.
+	static inline void getFreeListFromSize(u32 size, s32* fl, s32* sl)
+	{
+		if (size < FREE_SMALL_SIZE)
+		{
+			*fl = 0;
+			*sl = s32(size >> ALIGNMENT_LOG2);
+		}
+		else
+		{
+			const s32 topBit = bitScanReverse(size);
+			*sl = s32(size >> (topBit - FREE_SL_LOG2)) ^ FREE_SL_COUNT;
+			*fl = topBit - FREE_FL_SHIFT + 1;
+		}
+	}
+
+	// Find a free allocation of at least 'size' bytes without searching lists:
+	// round the size up to the next class so that any allocation in it is large enough.
+	static AllocHeaderFree* findFreeHeader(MemoryBlock* block, u32 size)
+	{
+		if (size >= FREE_SMALL_SIZE)
+		{
+			size += (1u << (bitScanReverse(size) - FREE_SL_LOG2)) - 1u;
+		}
+		s32 fl, sl;
+		getFreeListFromSize(size, &fl, &sl);
+		if (fl >= FREE_FL_COUNT) { return nullptr; }
+
+		u32 slMap = block->slBitmap[fl] & (~0u << sl);
+		if (!slMap)
+		{
+			const u32 flMap = (fl + 1 < 32) ? block->flBitmap & (~0u << (fl + 1)) : 0u;
+			if (!flMap) { return nullptr; }
+			fl = bitScanForward(flMap);
+			slMap = block->slBitmap[fl];
+		}
+		sl = bitScanForward(slMap);
+		return block->freeLists[fl][sl];
+	}
+
+	// Allocations that are larger than the size but share its class are skipped by findFreeHeader(),
+	// this is only checked before giving up on a block.
+	static AllocHeaderFree* findFreeHeaderInClass(MemoryBlock* block, u32 size)
+	{
+		s32 fl, sl;
+		getFreeListFromSize(size, &fl, &sl);
+		AllocHeaderFree* header = block->freeLists[fl][sl];
+		while (header && header->size < size)
+		{
+			header = header->binNext;
+		}
+		return header;
+	}
+
+	static inline u8* getBlockEnd(MemoryRegion* region, MemoryBlock* block)
+	{
+		return (u8*)block + sizeof(MemoryBlock) + region->blockSize;
+	}
+
+	static inline void initBlockFreelists(MemoryBlock* block)
+	{
+		block->flBitmap = 0;
+		memset(block->slBitmap, 0, sizeof(block->slBitmap));
+		memset(block->freeLists, 0, sizeof(block->freeLists));
+	}
 
 	void verifyMemory(MemoryRegion* region)
 	{
@@ -107,23 +241,38 @@ namespace TFE_Memory
 			assert(block->sizeFree <= region->blockSize);
 			u8* mem = (u8*)block + sizeof(MemoryBlock);
 			RegionAllocHeader* prev = nullptr;
+			u32 sizeFree = 0;
 			for (u32 a = 0; a < block->count; a++)
 			{
 				RegionAllocHeader* header = (RegionAllocHeader*)mem;
 				assert(header->free == 0 || header->free == 1);
 				assert(header->size <= region->blockSize);
+				assert(header->blockIndex == i);
+				assert(header->prevFree == (prev ? prev->free : 0));
+				assert(!(prev && prev->free && header->free));
+				if (header->free)
+				{
+					assert(*(u32*)(mem + header->size - sizeof(u32)) == header->size);
+					sizeFree += header->size;
+				}
 				mem += header->size;
 				prev = header;
 			}
+			assert(mem == getBlockEnd(region, block));
+			assert(sizeFree == block->sizeFree);
 
-			for (s32 b = 0; b < ALLOC_BIN_COUNT; b++)
+			for (s32 fl = 0; fl < FREE_FL_COUNT; fl++)
 			{
-				if (block->freeListBins[b])
+				assert(!(block->flBitmap & (1u << fl)) == !block->slBitmap[fl]);
+				for (s32 sl = 0; sl < FREE_SL_COUNT; sl++)
 				{
-					AllocHeaderFree* slot = block->freeListBins[b];
+					AllocHeaderFree* slot = block->freeLists[fl][sl];
+					assert(!(block->slBitmap[fl] & (1u << sl)) == !slot);
 					while (slot)
 					{
-						assert(slot->free == 1 && slot->bin == b);
+						s32 slotFl, slotSl;
+						getFreeListFromSize(slot->size, &slotFl, &slotSl);
+						assert(slot->free == 1 && slotFl == fl && slotSl == sl);
 						assert(slot->size <= block->sizeFree);
 						slot = slot->binNext;
 					}
@@ -155,6 +304,7 @@ namespace TFE_Memory
 		region->blockCount = 0;
 		region->blockSize = blockSize;
 		region->maxBlocks = maxSize ? (maxSize + blockSize - 1) / blockSize : 0;
+		memset(&region->stats, 0, sizeof(RegionStats));
 		if (!allocateNewBlock(region))
 		{
 			free(region);
@@ -162,6 +312,7 @@ namespace TFE_Memory
 			return nullptr;
 		}
 		VERIFY_MEMORY();
+		trace_record(region, TRACE_CREATE, nullptr, nullptr, 0);
 
 		return region;
 	}
@@ -169,6 +320,7 @@ namespace TFE_Memory
 	void region_clear(MemoryRegion* region)
 	{
 		assert(region);
+		trace_record(region, TRACE_CLEAR, nullptr, nullptr, 0);
 		for (s32 i = 0; i < region->blockCount; i++)
 		{
 			MemoryBlock* block = region->memBlocks[i];
@@ -178,8 +330,10 @@ namespace TFE_Memory
 			RegionAllocHeader* header = (RegionAllocHeader*)((u8*)block + sizeof(MemoryBlock));
 			header->size = block->sizeFree;
 			header->free = 0;
-			memset(block->freeListBins, 0, sizeof(AllocHeaderFree*)*ALLOC_BIN_COUNT);
-			insertBlockIntoFreelist(block, header);
+			header->prevFree = 0;
+			header->blockIndex = u8(i);
+			initBlockFreelists(block);
+			insertBlockIntoFreelist(block, header, getBlockEnd(region, block));
 			VERIFY_MEMORY();
 		}
 	}
@@ -187,6 +341,7 @@ namespace TFE_Memory
 	void region_destroy(MemoryRegion* region)
 	{
 		assert(region);
+		trace_record(region, TRACE_DESTROY, nullptr, nullptr, 0);
 		for (s32 i = 0; i < region->blockCount; i++)
 		{
 			free(region->memBlocks[i]);
@@ -195,46 +350,44 @@ namespace TFE_Memory
 		free(region);
 	}
 		
-	void* allocFromHeader(MemoryBlock* block, RegionAllocHeader* header, u32 size)
+	void* allocFromHeader(MemoryBlock* block, RegionAllocHeader* header, u32 size, u8* blockEnd)
 	{
 		assert(header->free == 1);
+		removeHeaderFromFreelist(block, header);
 		if (header->size - size >= MIN_SPLIT_SIZE)
 		{
 			// Split.
 			size_t split0 = size;
 			size_t split1 = header->size - split0;
 			RegionAllocHeader* next = (RegionAllocHeader*)((u8*)header + split0);
-
-			// Cleanup the free list.
-			removeHeaderFromFreelist(block, header);
 			header->size = u32(split0);
 
 			// Create a new free block.
 			next->size = u32(split1);
 			next->free = 0;
+			next->prevFree = 0;
+			next->blockIndex = header->blockIndex;
 			block->count++;
-						
+
 			// Add the new block to the free list.
-			insertBlockIntoFreelist(block, next);
+			insertBlockIntoFreelist(block, next, blockEnd);
 		}
 		else
 		{
 			// Consume the whole block.
-			removeHeaderFromFreelist(block, header);
+			RegionAllocHeader* next = (RegionAllocHeader*)((u8*)header + header->size);
+			if ((u8*)next < blockEnd)
+			{
+				next->prevFree = 0;
+			}
 		}
 		block->sizeFree -= header->size;
 		return (u8*)header + sizeof(RegionAllocHeader);
 	}
 
-	void* region_alloc(MemoryRegion* region, size_t size)
+	void* region_allocInternal(MemoryRegion* region, size_t size)
 	{
-		assert(region);
-		if (size == 0) { return nullptr; }
-
-		size = alloc_align(size + sizeof(RegionAllocHeader));
-		assert(size >= 24);	// at least 24 bytes is required to hold the free header.
-		if (size > region->blockSize) { return nullptr; }
-		
+		// Find a large enough free allocation in constant time, blocks are only skipped when full or fragmented.
 		for (s32 i = 0; i < region->blockCount; i++)
 		{
 			MemoryBlock* block = region->memBlocks[i];
@@ -243,122 +396,169 @@ namespace TFE_Memory
 				continue;
 			}
 
-			// Try to allocate from the closest matching bin.
-			s32 bin = getBinFromSize((u32)size);
-			for (s32 b = bin; b < ALLOC_BIN_COUNT; b++)
+			AllocHeaderFree* header = findFreeHeader(block, (u32)size);
+			if (header)
 			{
-				AllocHeaderFree* header = block->freeListBins[b];
-				while (header)
-				{
-					if (header->size >= size)
-					{
-						VERIFY_MEMORY();
-						void* mem = allocFromHeader(block, (RegionAllocHeader*)header, (u32)size);
-						VERIFY_MEMORY();
-						return mem;
-					}
-					header = header->binNext;
-				}
+				VERIFY_MEMORY();
+				void* mem = allocFromHeader(block, (RegionAllocHeader*)header, (u32)size, getBlockEnd(region, block));
+				VERIFY_MEMORY();
+				return mem;
 			}
 		}
 
-		if (!region->maxBlocks || region->blockCount < region->maxBlocks)
+		// Before growing the region, check the allocations that only fit exactly.
+		for (s32 i = 0; i < region->blockCount; i++)
 		{
-			if (allocateNewBlock(region))
+			MemoryBlock* block = region->memBlocks[i];
+			AllocHeaderFree* header = (block->sizeFree >= size) ? findFreeHeaderInClass(block, (u32)size) : nullptr;
+			if (header)
 			{
-				VERIFY_MEMORY();
-				void* mem = region_alloc(region, size);
+				void* mem = allocFromHeader(block, (RegionAllocHeader*)header, (u32)size, getBlockEnd(region, block));
 				VERIFY_MEMORY();
 				return mem;
 			}
 		}
-		
+
+		if (!region->maxBlocks || region->blockCount < region->maxBlocks)
+		{
+			if (allocateNewBlock(region))
+			{
+				MemoryBlock* block = region->memBlocks[region->blockCount - 1];
+				AllocHeaderFree* header = findFreeHeaderInClass(block, (u32)size);
+				if (!header) { header = findFreeHeader(block, (u32)size); }
+				if (header)
+				{
+					void* mem = allocFromHeader(block, (RegionAllocHeader*)header, (u32)size, getBlockEnd(region, block));
+					VERIFY_MEMORY();
+					return mem;
+				}
+			}
+		}
+
 		// We are all out of memory...
+		region->stats.failedAllocCount++;
 		TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Failed to allocate %u bytes in region '%s'.", size, region->name);
 		return nullptr;
 	}
 
+	void* region_alloc(MemoryRegion* region, size_t size)
+	{
+		assert(region);
+		if (size == 0) { return nullptr; }
+
+		const size_t allocSize = alloc_align(std::max(size + sizeof(RegionAllocHeader), size_t(MIN_ALLOC_SIZE)));
+		if (allocSize > region->blockSize) { return nullptr; }
+
+		const u64 start = s_trackLatency ? TFE_System::getCurrentTimeInTicks() : 0;
+		void* mem = region_allocInternal(region, allocSize);
+		region->stats.allocCount++;
+		if (s_trackLatency)
+		{
+			const u64 delta = TFE_System::getCurrentTimeInTicks() - start;
+			region->stats.allocTicks += delta;
+			region->stats.maxAllocTicks = std::max(region->stats.maxAllocTicks, delta);
+			region->stats.timedAllocCount++;
+		}
+		trace_record(region, TRACE_ALLOC, nullptr, mem, size);
+		return mem;
+	}
+
+	// Returns the block that owns the allocation, or null if the pointer is not in the region.
+	static MemoryBlock* getAllocBlock(MemoryRegion* region, RegionAllocHeader* header)
+	{
+		if (header->blockIndex >= region->blockCount) { return nullptr; }
+		MemoryBlock* block = region->memBlocks[header->blockIndex];
+		if ((u8*)header < (u8*)block + sizeof(MemoryBlock) || (u8*)header >= getBlockEnd(region, block))
+		{
+			return nullptr;
+		}
+		return block;
+	}
+
 	void* region_realloc(MemoryRegion* region, void* ptr, size_t size)
 	{
 		assert(region);
 		if (!ptr) { return region_alloc(region, size); }
 		if (size == 0) { return nullptr; }
 
-		size = alloc_align(size + sizeof(RegionAllocHeader));
+		const size_t requestSize = size;
+		size = alloc_align(std::max(size + sizeof(RegionAllocHeader), size_t(MIN_ALLOC_SIZE)));
 		if (size > region->blockSize) { return nullptr; }
+		region->stats.reallocCount++;
 
 		// If the current block is already large enough, skip looping over the memory blocks.
 		RegionAllocHeader* header = (RegionAllocHeader*)((u8*)ptr - sizeof(RegionAllocHeader));
 		if (header->size >= size)
 		{
+			trace_record(region, TRACE_REALLOC, ptr, ptr, requestSize);
 			return ptr;
 		}
 
 		// First try to reallocate in the same region.
-		u32 prevSize = 0;
-		for (s32 i = (s32)region->blockCount - 1; i >= 0; i--)
+		MemoryBlock* block = getAllocBlock(region, header);
+		assert(block && header->free == 0);
+		if (!block)
 		{
-			MemoryBlock* block = region->memBlocks[i];
-			if (ptr >= block)
-			{
-				RegionAllocHeader* header = (RegionAllocHeader*)((u8*)ptr - sizeof(RegionAllocHeader));
-				RegionAllocHeader* nextHeader = (RegionAllocHeader*)((u8*)header + header->size);
-				assert(header->free == 0);
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Attempted to reallocate pointer %x which is not part of region '%s'.", ptr, region->name);
+			return nullptr;
+		}
 
-				if ((u8*)nextHeader >= (u8*)block + region->blockSize)
-				{
-					nextHeader = nullptr;
-				}
-				// If it is big enough, just stick to the same memory.
-				if (header->size >= size)
+		u8* blockEnd = getBlockEnd(region, block);
+		RegionAllocHeader* nextHeader = (RegionAllocHeader*)((u8*)header + header->size);
+		if ((u8*)nextHeader >= blockEnd)
+		{
+			nextHeader = nullptr;
+		}
+		// If the next block is free, merge the two blocks and then allocate from that.
+		if (nextHeader && nextHeader->free && header->size + nextHeader->size >= size)
+		{
+			VERIFY_MEMORY();
+			// Remove the nextHeader from the freelist.
+			removeHeaderFromFreelist(block, nextHeader);
+
+			// Merge blocks.
+			const u32 prevSize = header->size;
+			header->size += nextHeader->size;
+			block->count--;
+
+			// Allocate from the new header.
+			if (header->size - size >= MIN_SPLIT_SIZE)
+			{
+				// Split.
+				size_t split0 = size;
+				size_t split1 = header->size - split0;
+				RegionAllocHeader* next = (RegionAllocHeader*)((u8*)header + split0);
+
+				// Reset the header.
+				header->size = u32(split0);
+
+				// Create a new free block.
+				next->size = u32(split1);
+				next->free = 0;
+				next->prevFree = 0;
+				next->blockIndex = header->blockIndex;
+				block->count++;
+
+				// Add the new block to the free list.
+				insertBlockIntoFreelist(block, next, blockEnd);
+			}
+			else
+			{
+				RegionAllocHeader* next = (RegionAllocHeader*)((u8*)header + header->size);
+				if ((u8*)next < blockEnd)
 				{
-					return ptr;
+					next->prevFree = 0;
 				}
-				// If the next block is free, merge the two blocks and then allocate from that.
-				if (nextHeader && nextHeader->free && header->size + nextHeader->size >= size)
-				{
-					VERIFY_MEMORY();
-					// Remove the nextHeader from the freelist.
-					assert(nextHeader->free == 1);
-					removeHeaderFromFreelist(block, nextHeader);
-
-					// Merge blocks.
-					block->sizeFree += header->size;
-					header->size += nextHeader->size;
-					block->count--;
-									
-					// Allocate from the new header.
-					if (header->size - size >= MIN_SPLIT_SIZE)
-					{
-						// Split.
-						size_t split0 = size;
-						size_t split1 = header->size - split0;
-						RegionAllocHeader* next = (RegionAllocHeader*)((u8*)header + split0);
-
-						// Reset the header.
-						header->free = 0;
-						header->size = u32(split0);
-
-						// Create a new free block.
-						next->size = u32(split1);
-						next->free = 0;
-						block->count++;
-
-						// Add the new block to the free list.
-						insertBlockIntoFreelist(block, next);
-					}
-					block->sizeFree -= header->size;
-					VERIFY_MEMORY();
-					return (u8*)header + sizeof(RegionAllocHeader);
-				}
-				// Otherwise break, we have to free and reallocate.
-				prevSize = header->size;
-				break;
 			}
+			block->sizeFree -= (header->size - prevSize);
+			VERIFY_MEMORY();
+			trace_record(region, TRACE_REALLOC, ptr, ptr, requestSize);
+			return ptr;
 		}
 
-		// Allocate a new block of memory.
-		void* newMem = region_alloc(region, size);
+		// Otherwise we have to free and reallocate.
+		const u32 prevSize = header->size;
+		void* newMem = region_allocInternal(region, size);
 		if (!newMem) { return nullptr; }
 		// Copy over the contents from the previous block.
 		if (prevSize > sizeof(RegionAllocHeader))
@@ -366,43 +566,84 @@ namespace TFE_Memory
 			memcpy(newMem, ptr, std::min((u32)size, prevSize) - sizeof(RegionAllocHeader));
 		}
 		// Free the previous block
-		region_free(region, ptr);
+		freeSlot(header, block, blockEnd);
 		// Then return the new block.
 		VERIFY_MEMORY();
+		trace_record(region, TRACE_REALLOC, ptr, newMem, requestSize);
 		return newMem;
 	}
-		
+
 	void region_free(MemoryRegion* region, void* ptr)
 	{
 		if (!ptr || !region) { return; }
 
-		for (s32 i = (s32)region->blockCount - 1; i >= 0; i--)
+		const u64 start = s_trackLatency ? TFE_System::getCurrentTimeInTicks() : 0;
+		RegionAllocHeader* header = (RegionAllocHeader*)((u8*)ptr - sizeof(RegionAllocHeader));
+		MemoryBlock* block = getAllocBlock(region, header);
+		if (!block)
 		{
-			MemoryBlock* block = region->memBlocks[i];
-			if (ptr >= block)
-			{
-				RegionAllocHeader* header = (RegionAllocHeader*)((u8*)ptr - sizeof(RegionAllocHeader));
-				RegionAllocHeader* nextHeader = (RegionAllocHeader*)((u8*)header + header->size);
-				if ((u8*)nextHeader >= (u8*)block + region->blockSize)
-				{
-					nextHeader = nullptr;
-				}
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Attempted to free pointer %x which is not part of region '%s'.", ptr, region->name);
+			return;
+		}
+
+		assert(!header->free);
+		if (header->free)
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Attempted to double free pointer %x in region '%s'.", ptr, region->name);
+			return;
+		}
 
-				assert(!header->free);
+		VERIFY_MEMORY();
+		freeSlot(header, block, getBlockEnd(region, block));
+		VERIFY_MEMORY();
+
+		region->stats.freeCount++;
+		if (s_trackLatency)
+		{
+			const u64 delta = TFE_System::getCurrentTimeInTicks() - start;
+			region->stats.freeTicks += delta;
+			region->stats.maxFreeTicks = std::max(region->stats.maxFreeTicks, delta);
+			region->stats.timedFreeCount++;
+		}
+		trace_record(region, TRACE_FREE, ptr, nullptr, 0);
+	}
+
+	void region_getStats(MemoryRegion* region, RegionStats* stats)
+	{
+		*stats = region->stats;
+		stats->freeBytes = 0;
+		stats->largestFree = 0;
+		stats->freeAllocCount = 0;
+		for (s32 i = 0; i < region->blockCount; i++)
+		{
+			const MemoryBlock* block = region->memBlocks[i];
+			stats->freeBytes += block->sizeFree;
+
+			const u8* mem = (u8*)block + sizeof(MemoryBlock);
+			for (u32 a = 0; a < block->count; a++)
+			{
+				const RegionAllocHeader* header = (RegionAllocHeader*)mem;
 				if (header->free)
 				{
-					TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Attempted to double free pointer %x in region '%s'.", ptr, region->name);
-					return;
+					stats->freeAllocCount++;
+					stats->largestFree = std::max(stats->largestFree, size_t(header->size));
 				}
-
-				VERIFY_MEMORY();
-				freeSlot(header, nextHeader, block);
-				VERIFY_MEMORY();
-				return;
+				mem += header->size;
 			}
 		}
+		stats->fragmentation = stats->freeBytes ? 1.0 - f64(stats->largestFree) / f64(stats->freeBytes) : 0.0;
 	}
-		
+
+	void region_resetStats(MemoryRegion* region)
+	{
+		memset(&region->stats, 0, sizeof(RegionStats));
+	}
+
+	void region_setLatencyTracking(bool enable)
+	{
+		s_trackLatency = enable;
+	}
+
 	size_t region_getMemoryUsed(MemoryRegion* region)
 	{
 		size_t used = 0;
@@ -419,6 +660,13 @@ namespace TFE_Memory
 		*blockSize = region->blockSize;
 	}
 
+	void* region_getBlockMemory(MemoryRegion* region, size_t index, size_t* size)
+	{
+		if (!region || index >= region->blockCount) { return nullptr; }
+		*size = sizeof(MemoryBlock) + region->blockSize;
+		return region->memBlocks[index];
+	}
+
 	size_t region_getMemoryCapacity(MemoryRegion* region)
 	{
 		return region->blockCount * region->blockSize;
@@ -485,25 +733,15 @@ namespace TFE_Memory
 			MemoryBlock* block = region->memBlocks[b];
 			file->write(&block->count);
 			file->write(&block->sizeFree);
-			for (s32 bin = 0; bin < ALLOC_BIN_COUNT; bin++)
-			{
-				RelativePointer ptr = region_getRelativePointer(region, block->freeListBins[bin]);
-				file->write(&ptr);
-			}
 
+			// The free lists are rebuilt on restore, so only the shared part of free headers is written.
 			u8* memPtr = (u8*)block + sizeof(MemoryBlock);
 			for (u32 al = 0; al < block->count; al++)
 			{
 				RegionAllocHeader* header = (RegionAllocHeader*)memPtr;
 				if (header->free)
 				{
-					AllocHeaderFree* freeHeader = (AllocHeaderFree*)memPtr;
-					file->writeBuffer(freeHeader, SHARED_HEADER_SIZE);
-
-					RelativePointer binNext = region_getRelativePointer(region, freeHeader->binNext);
-					RelativePointer binPrev = region_getRelativePointer(region, freeHeader->binPrev);
-					file->write(&binNext);
-					file->write(&binPrev);
+					file->writeBuffer(header, SHARED_HEADER_SIZE);
 				}
 				else
 				{
@@ -526,7 +764,11 @@ namespace TFE_Memory
 		if (!region)
 		{
 			region = (MemoryRegion*)malloc(sizeof(MemoryRegion));
-			region->blockArrCapacity = 0;
+			if (region)
+			{
+				region->blockArrCapacity = 0;
+				memset(&region->stats, 0, sizeof(RegionStats));
+			}
 		}
 		if (!region)
 		{
@@ -610,12 +852,7 @@ namespace TFE_Memory
 
 			file->read(&block->count);
 			file->read(&block->sizeFree);
-			for (s32 bin = 0; bin < ALLOC_BIN_COUNT; bin++)
-			{
-				RelativePointer ptr;
-				file->read(&ptr);
-				block->freeListBins[bin] = (AllocHeaderFree*)region_getRealPointer(region, ptr);
-			}
+			initBlockFreelists(block);
 
 			u8* memPtr = (u8*)block + sizeof(MemoryBlock);
 			for (u32 al = 0; al < block->count; al++)
@@ -625,13 +862,8 @@ namespace TFE_Memory
 
 				if (header->free)
 				{
-					AllocHeaderFree* freeHeader = (AllocHeaderFree*)memPtr;
-					RelativePointer binNext, binPrev;
-					file->read(&binNext);
-					file->read(&binPrev);
-
-					freeHeader->binNext = (AllocHeaderFree*)region_getRealPointer(region, binNext);
-					freeHeader->binPrev = (AllocHeaderFree*)region_getRealPointer(region, binPrev);
+					linkFreeHeader(block, (AllocHeaderFree*)header);
+					*(u32*)(memPtr + header->size - sizeof(u32)) = header->size;
 				}
 				else
 				{
@@ -641,18 +873,19 @@ namespace TFE_Memory
 				memPtr += header->size;
 			}
 		}
+		VERIFY_MEMORY();
 
 		return region;
 	}
 
-	void freeSlot(RegionAllocHeader* alloc, RegionAllocHeader* next, MemoryBlock* block)
+	void freeSlot(RegionAllocHeader* alloc, MemoryBlock* block, u8* blockEnd)
 	{
 		block->sizeFree += alloc->size;
 
 		assert(alloc->free == 0);
-		if (next && next->free)  // Then try merging the current and next.
+		RegionAllocHeader* next = (RegionAllocHeader*)((u8*)alloc + alloc->size);
+		if ((u8*)next < blockEnd && next->free)  // Then try merging the current and next.
 		{
-			assert(next->free == 1);
 			// Remove the next block from the freelist.
 			removeHeaderFromFreelist(block, next);
 
@@ -660,85 +893,88 @@ namespace TFE_Memory
 			alloc->size += next->size;
 			block->count--;
 		}
+		if (alloc->prevFree)  // Then try merging the previous and current.
+		{
+			const u32 prevSize = *(u32*)((u8*)alloc - sizeof(u32));
+			RegionAllocHeader* prev = (RegionAllocHeader*)((u8*)alloc - prevSize);
+			assert(prev->free == 1 && prev->size == prevSize);
+			removeHeaderFromFreelist(block, prev);
+
+			// Merge
+			prev->size += alloc->size;
+			block->count--;
+			alloc = prev;
+		}
 		// Then add the new item to the free list.
-		insertBlockIntoFreelist(block, alloc);
+		insertBlockIntoFreelist(block, alloc, blockEnd);
 	}
 
 	size_t alloc_align(size_t baseSize)
 	{
 		return (baseSize + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
 	}
-		
-	s32 getBinFromSize(u32 size)
-	{
-		if (size < 32) { return 0; }
-		else if (size <= 64) { return 1; }
-		else if (size <= 128) { return 2; }
-		else if (size <= 256) { return 3; }
-		else if (size <= 512) { return 4; }
-		return 5;
-	}
 
 	void removeHeaderFromFreelist(MemoryBlock* block, RegionAllocHeader* header)
 	{
 		AllocHeaderFree* freeHeader = (AllocHeaderFree*)header;
 		assert(freeHeader->free == 1);
-		assert(freeHeader->bin < ALLOC_BIN_COUNT);
 
-		u8 bin = freeHeader->bin;
+		s32 fl, sl;
+		getFreeListFromSize(freeHeader->size, &fl, &sl);
 		freeHeader->free = 0;
-		freeHeader->bin = 0;
-		if (freeHeader->binPrev)
+		if (freeHeader->binNext)
 		{
-			AllocHeaderFree* nextFree = freeHeader->binNext;
-			AllocHeaderFree* prevFree = freeHeader->binPrev;
-			prevFree->binNext = nextFree;
-			if (nextFree)
-			{
-				nextFree->binPrev = prevFree;
-			}
+			freeHeader->binNext->binPrev = freeHeader->binPrev;
 		}
-		else if (freeHeader->binNext)
+		if (freeHeader->binPrev)
 		{
-			assert(freeHeader == block->freeListBins[bin]);
-			if (freeHeader == block->freeListBins[bin])
-			{
-				block->freeListBins[bin] = freeHeader->binNext;
-				block->freeListBins[bin]->binPrev = nullptr;
-			}
+			freeHeader->binPrev->binNext = freeHeader->binNext;
 		}
 		else
 		{
-			assert(freeHeader->binPrev || freeHeader == block->freeListBins[bin]);
-			if (freeHeader == block->freeListBins[bin])
+			assert(freeHeader == block->freeLists[fl][sl]);
+			block->freeLists[fl][sl] = freeHeader->binNext;
+			if (!block->freeLists[fl][sl])
 			{
-				block->freeListBins[bin] = nullptr;
+				block->slBitmap[fl] &= ~(1u << sl);
+				if (!block->slBitmap[fl])
+				{
+					block->flBitmap &= ~(1u << fl);
+				}
 			}
 		}
 	}
 
-	void insertBlockIntoFreelist(MemoryBlock* block, RegionAllocHeader* header)
+	// Add a free header to the list for its size class, without touching the surrounding memory.
+	void linkFreeHeader(MemoryBlock* block, AllocHeaderFree* header)
+	{
+		s32 fl, sl;
+		getFreeListFromSize(header->size, &fl, &sl);
+		header->binPrev = nullptr;
+		header->binNext = block->freeLists[fl][sl];
+		if (header->binNext)
+		{
+			header->binNext->binPrev = header;
+		}
+		block->freeLists[fl][sl] = header;
+		block->slBitmap[fl] |= (1u << sl);
+		block->flBitmap |= (1u << fl);
+	}
+
+	void insertBlockIntoFreelist(MemoryBlock* block, RegionAllocHeader* header, u8* blockEnd)
 	{
 		AllocHeaderFree* freeNext = (AllocHeaderFree*)header;
 		assert(freeNext->free == 0);
-		s32 bin = getBinFromSize(header->size);
 		freeNext->free = 1;
-		freeNext->bin = bin;
-		freeNext->pad8[0] = 0;
-		freeNext->pad8[1] = 0;
-		if (!block->freeListBins[bin])
-		{
-			block->freeListBins[bin] = freeNext;
-			freeNext->binPrev = nullptr;
-			freeNext->binNext = nullptr;
-		}
-		else
-		{
-			block->freeListBins[bin]->binPrev = freeNext;
-			freeNext->binNext = block->freeListBins[bin];
-			freeNext->binPrev = nullptr;
+		freeNext->pad8 = 0;
+		linkFreeHeader(block, freeNext);
 
-			block->freeListBins[bin] = freeNext;
+		// Store the size at the end, so the next allocation can find this one when it is freed.
+		*(u32*)((u8*)header + header->size - sizeof(u32)) = header->size;
+		RegionAllocHeader* next = (RegionAllocHeader*)((u8*)header + header->size);
+		if ((u8*)next < blockEnd)
+		{
+			next->prevFree = 1;
 		}
 	}
 
@@ -784,9 +1020,334 @@ namespace TFE_Memory
 		RegionAllocHeader* header = (RegionAllocHeader*)((u8*)block + sizeof(MemoryBlock));
 		header->size = block->sizeFree;
 		header->free = 0;
-		memset(block->freeListBins, 0, sizeof(AllocHeaderFree*)*ALLOC_BIN_COUNT);
-		insertBlockIntoFreelist(block, header);
+		header->prevFree = 0;
+		header->blockIndex = u8(blockIndex);
+		initBlockFreelists(block);
+		insertBlockIntoFreelist(block, header, getBlockEnd(region, block));
+
+		return true;
+	}
+
+	/////////////////////////////////////////////
+	// Tracing and replay
+	/////////////////////////////////////////////
+	static const u32 c_traceMagic = 0x43525452;	// "RTRC"
+	static const u32 c_traceVersion = 1;
+
+	struct TracedAlloc
+	{
+		u32 id;
+		u8  region;
+	};
+	typedef std::unordered_map<void*, TracedAlloc> TracedAllocMap;
+
+	static FileStream s_traceFile;
+	static bool s_tracing = false;
+	static u32 s_traceNextId = 1;
+	static u32 s_traceOpCount = 0;
+	static std::vector<MemoryRegion*> s_traceRegions;
+	static TracedAllocMap s_traceAllocs;
+
+	static void trace_write(u8 op, u8 region, u32 id, u32 size)
+	{
+		RegionTraceOp traceOp = { op, region, 0, id, size };
+		s_traceFile.writeBuffer(&traceOp, sizeof(RegionTraceOp));
+		s_traceOpCount++;
+	}
+
+	static void trace_forgetRegion(u8 regionIndex)
+	{
+		for (TracedAllocMap::iterator iAlloc = s_traceAllocs.begin(); iAlloc != s_traceAllocs.end();)
+		{
+			if (iAlloc->second.region == regionIndex) { iAlloc = s_traceAllocs.erase(iAlloc); }
+			else { ++iAlloc; }
+		}
+	}
+
+	void trace_record(MemoryRegion* region, u8 op, void* ptr, void* newPtr, size_t size)
+	{
+		if (!s_tracing) { return; }
+
+		// Regions that existed before tracing started are added the first time they are used.
+		s32 regionIndex = -1;
+		for (size_t i = 0; i < s_traceRegions.size(); i++)
+		{
+			if (s_traceRegions[i] == region) { regionIndex = s32(i); break; }
+		}
+		if (regionIndex < 0)
+		{
+			if (op == TRACE_DESTROY || s_traceRegions.size() > 255) { return; }
+			regionIndex = s32(s_traceRegions.size());
+			s_traceRegions.push_back(region);
+			trace_write(TRACE_CREATE, u8(regionIndex), u32(region->maxBlocks), u32(region->blockSize));
+		}
+		const u8 index = u8(regionIndex);
+
+		switch (op)
+		{
+			case TRACE_ALLOC:
+			{
+				if (!newPtr) { break; }
+				const TracedAlloc alloc = { s_traceNextId++, index };
+				s_traceAllocs[newPtr] = alloc;
+				trace_write(TRACE_ALLOC, index, alloc.id, u32(size));
+			} break;
+			case TRACE_REALLOC:
+			{
+				if (!newPtr) { break; }
+				TracedAllocMap::iterator iAlloc = s_traceAllocs.find(ptr);
+				if (iAlloc == s_traceAllocs.end())
+				{
+					// Allocated before tracing started, so it becomes a new allocation.
+					trace_record(region, TRACE_ALLOC, nullptr, newPtr, size);
+					break;
+				}
+				const TracedAlloc alloc = iAlloc->second;
+				s_traceAllocs.erase(iAlloc);
+				s_traceAllocs[newPtr] = alloc;
+				trace_write(TRACE_REALLOC, index, alloc.id, u32(size));
+			} break;
+			case TRACE_FREE:
+			{
+				TracedAllocMap::iterator iAlloc = s_traceAllocs.find(ptr);
+				if (iAlloc == s_traceAllocs.end()) { break; }
+				trace_write(TRACE_FREE, index, iAlloc->second.id, 0);
+				s_traceAllocs.erase(iAlloc);
+			} break;
+			case TRACE_CLEAR:
+			case TRACE_DESTROY:
+			{
+				trace_forgetRegion(index);
+				trace_write(op, index, 0, 0);
+				if (op == TRACE_DESTROY)
+				{
+					// The region pointer may be reused by a new region.
+					s_traceRegions[index] = nullptr;
+				}
+			} break;
+		}
+	}
+
+	bool region_beginTrace(const char* path)
+	{
+		if (s_tracing) { return false; }
+		if (!s_traceFile.open(path, FileStream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Cannot open trace file '%s'.", path);
+			return false;
+		}
+		s_traceFile.write(&c_traceMagic);
+		s_traceFile.write(&c_traceVersion);
+
+		s_tracing = true;
+		s_traceNextId = 1;
+		s_traceOpCount = 0;
+		s_traceRegions.clear();
+		s_traceAllocs.clear();
+		TFE_System::logWrite(LOG_MSG, "MemoryRegion", "Tracing region operations to '%s'.", path);
+		return true;
+	}
+
+	void region_endTrace()
+	{
+		if (!s_tracing) { return; }
+		s_tracing = false;
+		s_traceFile.close();
+		s_traceRegions.clear();
+		s_traceAllocs.clear();
+		TFE_System::logWrite(LOG_MSG, "MemoryRegion", "Trace finished with %u operations.", s_traceOpCount);
+	}
+
+	bool region_isTracing()
+	{
+		return s_tracing;
+	}
+
+	enum ReplayTarget
+	{
+		REPLAY_REGION = 0,
+		REPLAY_MALLOC,
+	};
+
+	struct ReplayState
+	{
+		std::vector<MemoryRegion*> regions;
+		std::vector<void*> ptrs;
+		std::vector<u8> ptrRegion;
+	};
+
+	static void replay_releaseRegion(ReplayState* state, u8 regionIndex, ReplayTarget target)
+	{
+		for (size_t id = 0; id < state->ptrs.size(); id++)
+		{
+			if (!state->ptrs[id] || state->ptrRegion[id] != regionIndex) { continue; }
+			if (target == REPLAY_MALLOC) { free(state->ptrs[id]); }
+			state->ptrs[id] = nullptr;
+		}
+	}
+
+	static f64 replay_getFragmentation(ReplayState* state)
+	{
+		f64 fragmentation = 0.0;
+		for (size_t i = 0; i < state->regions.size(); i++)
+		{
+			if (!state->regions[i]) { continue; }
+			RegionStats stats;
+			region_getStats(state->regions[i], &stats);
+			fragmentation = std::max(fragmentation, stats.fragmentation);
+		}
+		return fragmentation;
+	}
+
+	// Returns the time spent in the allocator in ticks.
+	static u64 replay_run(const std::vector<RegionTraceOp>& ops, u32 maxId, ReplayTarget target, RegionReplayResult* result, u64* maxTicks)
+	{
+		ReplayState state;
+		state.regions.resize(256, nullptr);
+		state.ptrs.resize(maxId + 1, nullptr);
+		state.ptrRegion.resize(maxId + 1, 0);
+
+		u64 totalTicks = 0;
+		for (size_t i = 0; i < ops.size(); i++)
+		{
+			const RegionTraceOp& op = ops[i];
+			MemoryRegion* region = state.regions[op.region];
+			if (op.op != TRACE_CREATE && target == REPLAY_REGION && !region) { continue; }
+			if (op.id > maxId) { continue; }
+			if (target == REPLAY_REGION && (op.op == TRACE_CLEAR || op.op == TRACE_DESTROY))
+			{
+				result->peakFragmentation = std::max(result->peakFragmentation, replay_getFragmentation(&state));
+			}
+
+			const u64 start = TFE_System::getCurrentTimeInTicks();
+			switch (op.op)
+			{
+				case TRACE_CREATE:
+				{
+					if (target == REPLAY_REGION && !region)
+					{
+						state.regions[op.region] = region_create("Replay", op.size, op.id * op.size);
+					}
+				} break;
+				case TRACE_ALLOC:
+				{
+					void* mem = (target == REPLAY_REGION) ? region_alloc(region, op.size) : malloc(op.size);
+					if (!mem && target == REPLAY_REGION) { result->failedAllocCount++; }
+					state.ptrs[op.id] = mem;
+					state.ptrRegion[op.id] = op.region;
+				} break;
+				case TRACE_REALLOC:
+				{
+					void* mem = (target == REPLAY_REGION) ? region_realloc(region, state.ptrs[op.id], op.size) : realloc(state.ptrs[op.id], op.size);
+					if (mem) { state.ptrs[op.id] = mem; }
+					else if (target == REPLAY_REGION) { result->failedAllocCount++; }
+				} break;
+				case TRACE_FREE:
+				{
+					if (target == REPLAY_REGION) { region_free(region, state.ptrs[op.id]); }
+					else { free(state.ptrs[op.id]); }
+					state.ptrs[op.id] = nullptr;
+				} break;
+				case TRACE_CLEAR:
+				{
+					if (target == REPLAY_REGION) { region_clear(region); }
+					replay_releaseRegion(&state, op.region, target);
+				} break;
+				case TRACE_DESTROY:
+				{
+					if (target == REPLAY_REGION)
+					{
+						region_destroy(region);
+						state.regions[op.region] = nullptr;
+					}
+					replay_releaseRegion(&state, op.region, target);
+				} break;
+			}
+			const u64 delta = TFE_System::getCurrentTimeInTicks() - start;
+			totalTicks += delta;
+			*maxTicks = std::max(*maxTicks, delta);
+
+			// Sample fragmentation outside of the timed section.
+			if (target == REPLAY_REGION && (i & 4095) == 4095)
+			{
+				result->peakFragmentation = std::max(result->peakFragmentation, replay_getFragmentation(&state));
+			}
+		}
+
+		// Cleanup whatever is still allocated at the end of the trace.
+		if (target == REPLAY_REGION)
+		{
+			result->fragmentation = replay_getFragmentation(&state);
+			result->peakFragmentation = std::max(result->peakFragmentation, result->fragmentation);
+			for (size_t i = 0; i < state.regions.size(); i++)
+			{
+				if (state.regions[i]) { region_destroy(state.regions[i]); }
+			}
+		}
+		else
+		{
+			for (size_t id = 0; id < state.ptrs.size(); id++)
+			{
+				free(state.ptrs[id]);
+			}
+		}
+		return totalTicks;
+	}
+
+	bool region_replayTrace(const char* path, s32 iterations, RegionReplayResult* result)
+	{
+		if (s_tracing || !result) { return false; }
+		memset(result, 0, sizeof(RegionReplayResult));
+
+		FileStream file;
+		if (!file.open(path, FileStream::MODE_READ))
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Cannot open trace file '%s'.", path);
+			return false;
+		}
+		u32 magic = 0, version = 0;
+		file.read(&magic);
+		file.read(&version);
+		const size_t opCount = (file.getSize() - 2 * sizeof(u32)) / sizeof(RegionTraceOp);
+		if (magic != c_traceMagic || version != c_traceVersion)
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "'%s' is not a valid region trace.", path);
+			file.close();
+			return false;
+		}
+		std::vector<RegionTraceOp> ops(opCount);
+		if (opCount)
+		{
+			file.readBuffer(ops.data(), u32(opCount * sizeof(RegionTraceOp)));
+		}
+		file.close();
+
+		u32 maxId = 0;
+		for (size_t i = 0; i < opCount; i++)
+		{
+			if (ops[i].op >= TRACE_COUNT) { ops[i].op = TRACE_COUNT; }
+			maxId = std::max(maxId, ops[i].id);
+		}
+		result->opCount = u32(opCount);
+
+		// Latency tracking would add to the region timings only.
+		const bool trackLatency = s_trackLatency;
+		s_trackLatency = false;
+
+		u64 regionTicks = 0, mallocTicks = 0;
+		u64 regionMax = 0, mallocMax = 0;
+		iterations = std::max(iterations, 1);
+		for (s32 i = 0; i < iterations; i++)
+		{
+			regionTicks += replay_run(ops, maxId, REPLAY_REGION, result, &regionMax);
+			mallocTicks += replay_run(ops, maxId, REPLAY_MALLOC, result, &mallocMax);
+		}
+		s_trackLatency = trackLatency;
 
+		result->regionTime = TFE_System::convertFromTicksToSeconds(regionTicks);
+		result->mallocTime = TFE_System::convertFromTicksToSeconds(mallocTicks);
+		result->regionMaxLatency = TFE_System::convertFromTicksToSeconds(regionMax);
+		result->mallocMaxLatency = TFE_System::convertFromTicksToSeconds(mallocMax);
 		return true;
 	}
 
@@ -13,6 +13,44 @@ typedef u32 RelativePointer;
 
 #define NULL_RELATIVE_POINTER 0
 
+struct RegionStats
+{
+	// Operation counts since the region was created or the stats were reset.
+	u32 allocCount;
+	u32 freeCount;
+	u32 reallocCount;
+	u32 failedAllocCount;
+
+	// Free space, computed by region_getStats().
+	size_t freeBytes;
+	size_t largestFree;
+	u32 freeAllocCount;
+	f64 fragmentation;		// 1 - largestFree / freeBytes, 0 = all free memory is contiguous.
+
+	// Latency in ticks, only recorded while latency tracking is enabled.
+	u32 timedAllocCount;
+	u32 timedFreeCount;
+	u64 allocTicks;
+	u64 maxAllocTicks;
+	u64 freeTicks;
+	u64 maxFreeTicks;
+};
+
+struct RegionReplayResult
+{
+	u32 opCount;
+	u32 failedAllocCount;
+	// Totals in seconds for all iterations.
+	f64 regionTime;
+	f64 mallocTime;
+	// Worst single operation in seconds.
+	f64 regionMaxLatency;
+	f64 mallocMaxLatency;
+	// Fragmentation of the replayed regions, sampled while replaying.
+	f64 fragmentation;
+	f64 peakFragmentation;
+};
+
 namespace TFE_Memory
 {
 	MemoryRegion* region_create(const char* name, size_t blockSize, size_t maxSize = 0u);
@@ -25,7 +63,15 @@ namespace TFE_Memory
 
 	size_t region_getMemoryUsed(MemoryRegion* region);
 	size_t region_getMemoryCapacity(MemoryRegion* region);
+	// Statistics and fragmentation, see RegionStats.
+	void region_getStats(MemoryRegion* region, RegionStats* stats);
+	void region_resetStats(MemoryRegion* region);
+	// Time each allocation and free, this adds two timer reads per call so it is disabled by default.
+	void region_setLatencyTracking(bool enable);
 	void region_getBlockInfo(MemoryRegion* region, size_t* blockCount, size_t* blockSize);
+	// Raw memory of a block, including its header. Blocks never move once allocated, so a copy
+	// written back later restores the region in place with all pointers still valid.
+	void* region_getBlockMemory(MemoryRegion* region, size_t index, size_t* size);
 
 	RelativePointer region_getRelativePointer(MemoryRegion* region, void* ptr);
 	void* region_getRealPointer(MemoryRegion* region, RelativePointer ptr);
@@ -36,5 +82,12 @@ namespace TFE_Memory
 	// otherwise it will attempt to reuse the existing region.
 	MemoryRegion* region_restoreFromDisk(MemoryRegion* region, FileStream* file);
 
+	// Record every region operation to a binary trace file, which can be replayed later to compare allocators.
+	bool region_beginTrace(const char* path);
+	void region_endTrace();
+	bool region_isTracing();
+	// Replay a trace through new regions and through malloc/realloc/free.
+	bool region_replayTrace(const char* path, s32 iterations, RegionReplayResult* result);
+
 	void region_test();
 }
\ No newline at end of file
@@ -0,0 +1,311 @@
+#include <cstring>
+
+#include "snapshot.h"
+#include "memoryRegion.h"
+#include <TFE_System/system.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+namespace TFE_Memory
+{
+	enum
+	{
+		SNAPSHOT_PAGE_SIZE = 4096,
+		SNAPSHOT_DEFAULT_CAPACITY = 60,
+	};
+
+	struct SnapshotRange
+	{
+		u8* ptr;
+		size_t size;
+	};
+
+	struct UndoPage
+	{
+		size_t offset;		// offset into the image.
+		u32 size;
+	};
+
+	// The pages needed to go from the next snapshot back to this one.
+	struct Snapshot
+	{
+		std::vector<UndoPage> pages;
+		std::vector<u8> data;
+	};
+
+	static std::vector<MemoryRegion*> s_regions;
+	static std::vector<SnapshotRange> s_globals;
+	static std::vector<SnapshotRestoreFunc> s_restoreFuncs;
+
+	// Rewind ring, the newest snapshot is at the back and matches the image.
+	static std::deque<Snapshot> s_ring;
+	static std::vector<SnapshotRange> s_imageLayout;
+	static std::vector<u8> s_image;
+	static s32 s_capacity = SNAPSHOT_DEFAULT_CAPACITY;
+
+	// Single full save.
+	static std::vector<SnapshotRange> s_saveLayout;
+	static std::vector<u8> s_saveImage;
+
+	static f64 s_lastCaptureTime = 0.0;
+	static f64 s_captureTimeTotal = 0.0;
+	static s32 s_captureCount = 0;
+	static f64 s_lastRestoreTime = 0.0;
+	static size_t s_lastCaptureSize = 0;
+
+	void snapshot_registerRegion(MemoryRegion* region)
+	{
+		if (!region || std::find(s_regions.begin(), s_regions.end(), region) != s_regions.end()) { return; }
+		s_regions.push_back(region);
+	}
+
+	void snapshot_registerGlobal(void* ptr, size_t size)
+	{
+		if (!ptr || !size) { return; }
+		for (size_t i = 0; i < s_globals.size(); i++)
+		{
+			if (s_globals[i].ptr == ptr) { return; }
+		}
+		s_globals.push_back({ (u8*)ptr, size });
+	}
+
+	void snapshot_registerRestoreCallback(SnapshotRestoreFunc func)
+	{
+		if (!func || std::find(s_restoreFuncs.begin(), s_restoreFuncs.end(), func) != s_restoreFuncs.end()) { return; }
+		s_restoreFuncs.push_back(func);
+	}
+
+	void snapshot_unregisterAll()
+	{
+		snapshot_clear();
+		s_regions.clear();
+		s_globals.clear();
+		s_restoreFuncs.clear();
+		snapshot_clearSave();
+	}
+
+	// The memory ranges that make up a snapshot: every region block followed by the globals.
+	size_t snapshot_buildLayout(std::vector<SnapshotRange>& layout)
+	{
+		layout.clear();
+		size_t total = 0;
+		for (size_t r = 0; r < s_regions.size(); r++)
+		{
+			size_t blockCount, blockSize;
+			region_getBlockInfo(s_regions[r], &blockCount, &blockSize);
+			for (size_t b = 0; b < blockCount; b++)
+			{
+				SnapshotRange range;
+				range.ptr = (u8*)region_getBlockMemory(s_regions[r], b, &range.size);
+				layout.push_back(range);
+				total += range.size;
+			}
+		}
+		for (size_t g = 0; g < s_globals.size(); g++)
+		{
+			layout.push_back(s_globals[g]);
+			total += s_globals[g].size;
+		}
+		return total;
+	}
+
+	bool snapshot_sameLayout(const std::vector<SnapshotRange>& a, const std::vector<SnapshotRange>& b)
+	{
+		if (a.size() != b.size()) { return false; }
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			if (a[i].ptr != b[i].ptr || a[i].size != b[i].size) { return false; }
+		}
+		return true;
+	}
+
+	void snapshot_copyToImage(const std::vector<SnapshotRange>& layout, std::vector<u8>& image)
+	{
+		u8* dst = image.data();
+		for (size_t i = 0; i < layout.size(); i++)
+		{
+			memcpy(dst, layout[i].ptr, layout[i].size);
+			dst += layout[i].size;
+		}
+	}
+
+	void snapshot_copyFromImage(const std::vector<SnapshotRange>& layout, const std::vector<u8>& image)
+	{
+		const u8* src = image.data();
+		for (size_t i = 0; i < layout.size(); i++)
+		{
+			memcpy(layout[i].ptr, src, layout[i].size);
+			src += layout[i].size;
+		}
+	}
+
+	void snapshot_restored()
+	{
+		for (size_t i = 0; i < s_restoreFuncs.size(); i++)
+		{
+			s_restoreFuncs[i]();
+		}
+	}
+
+	void snapshot_setCapacity(s32 count)
+	{
+		s_capacity = std::max(count, 1);
+		while (s32(s_ring.size()) > s_capacity)
+		{
+			s_ring.pop_front();
+		}
+	}
+
+	void snapshot_capture()
+	{
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+
+		std::vector<SnapshotRange> layout;
+		const size_t total = snapshot_buildLayout(layout);
+		if (s_ring.empty() || !snapshot_sameLayout(layout, s_imageLayout))
+		{
+			// Start again with a full image, older snapshots cannot be restored with a different layout.
+			s_ring.clear();
+			s_imageLayout = layout;
+			s_image.resize(total);
+			snapshot_copyToImage(layout, s_image);
+			s_lastCaptureSize = total;
+		}
+		else
+		{
+			// Move the pages that changed since the previous snapshot into its undo log.
+			Snapshot& prev = s_ring.back();
+			const size_t prevSize = prev.data.size();
+			size_t offset = 0;
+			for (size_t i = 0; i < layout.size(); i++)
+			{
+				const SnapshotRange& range = layout[i];
+				for (size_t pos = 0; pos < range.size; pos += SNAPSHOT_PAGE_SIZE)
+				{
+					const u32 size = u32(std::min(range.size - pos, size_t(SNAPSHOT_PAGE_SIZE)));
+					u8* image = &s_image[offset + pos];
+					if (memcmp(range.ptr + pos, image, size))
+					{
+						prev.pages.push_back({ offset + pos, size });
+						prev.data.insert(prev.data.end(), image, image + size);
+						memcpy(image, range.ptr + pos, size);
+					}
+				}
+				offset += range.size;
+			}
+			s_lastCaptureSize = prev.data.size() - prevSize;
+		}
+		s_ring.push_back(Snapshot());
+		while (s32(s_ring.size()) > s_capacity)
+		{
+			s_ring.pop_front();
+		}
+
+		s_lastCaptureTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+		s_captureTimeTotal += s_lastCaptureTime;
+		s_captureCount++;
+	}
+
+	JBool snapshot_rewind(s32 stepsBack)
+	{
+		const s32 target = s32(s_ring.size()) - 1 - stepsBack;
+		if (stepsBack < 0 || target < 0) { return JFALSE; }
+
+		std::vector<SnapshotRange> layout;
+		snapshot_buildLayout(layout);
+		if (!snapshot_sameLayout(layout, s_imageLayout))
+		{
+			TFE_System::logWrite(LOG_WARNING, "Snapshot", "The memory layout has changed, the snapshots cannot be restored.");
+			snapshot_clear();
+			return JFALSE;
+		}
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		// Walk the image back to the target snapshot, discarding the newer ones.
+		for (s32 i = s32(s_ring.size()) - 2; i >= target; i--)
+		{
+			const Snapshot& snapshot = s_ring[i];
+			const u8* data = snapshot.data.data();
+			for (size_t p = 0; p < snapshot.pages.size(); p++)
+			{
+				memcpy(&s_image[snapshot.pages[p].offset], data, snapshot.pages[p].size);
+				data += snapshot.pages[p].size;
+			}
+		}
+		s_ring.resize(target + 1);
+		s_ring.back().pages.clear();
+		s_ring.back().data.clear();
+
+		snapshot_copyFromImage(layout, s_image);
+		snapshot_restored();
+		s_lastRestoreTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+		return JTRUE;
+	}
+
+	void snapshot_clear()
+	{
+		s_ring.clear();
+		s_imageLayout.clear();
+		s_image.clear();
+		s_image.shrink_to_fit();
+	}
+
+	s32 snapshot_getCount()
+	{
+		return s32(s_ring.size());
+	}
+
+	void snapshot_save()
+	{
+		const size_t total = snapshot_buildLayout(s_saveLayout);
+		s_saveImage.resize(total);
+		snapshot_copyToImage(s_saveLayout, s_saveImage);
+	}
+
+	JBool snapshot_load()
+	{
+		if (s_saveLayout.empty()) { return JFALSE; }
+
+		std::vector<SnapshotRange> layout;
+		snapshot_buildLayout(layout);
+		if (!snapshot_sameLayout(layout, s_saveLayout))
+		{
+			TFE_System::logWrite(LOG_WARNING, "Snapshot", "The memory layout has changed, the saved snapshot cannot be restored.");
+			return JFALSE;
+		}
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		snapshot_copyFromImage(layout, s_saveImage);
+		snapshot_restored();
+		s_lastRestoreTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+		return JTRUE;
+	}
+
+	void snapshot_clearSave()
+	{
+		s_saveLayout.clear();
+		s_saveImage.clear();
+		s_saveImage.shrink_to_fit();
+	}
+
+	JBool snapshot_hasSave()
+	{
+		return s_saveLayout.empty() ? JFALSE : JTRUE;
+	}
+
+	void snapshot_getStats(SnapshotStats* stats)
+	{
+		stats->count = s32(s_ring.size());
+		stats->imageSize = s_image.size();
+		stats->undoSize = 0;
+		for (size_t i = 0; i < s_ring.size(); i++)
+		{
+			stats->undoSize += s_ring[i].data.size();
+		}
+		stats->lastCaptureTime = s_lastCaptureTime;
+		stats->aveCaptureTime = s_captureCount ? s_captureTimeTotal / f64(s_captureCount) : 0.0;
+		stats->lastRestoreTime = s_lastRestoreTime;
+		stats->lastCaptureSize = s_lastCaptureSize;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// In-memory snapshots of the game state.
+// Registered memory regions and globals are copied as raw memory,
+// region blocks never move so pointers remain valid when a snapshot
+// is written back (in the same process).
+//
+// The rewind ring keeps a single full image of the newest snapshot,
+// older snapshots only store the pages that changed afterwards (an
+// undo log), so each snapshot costs about as much memory as the
+// state that changed in between.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+
+struct MemoryRegion;
+typedef void(*SnapshotRestoreFunc)();
+
+#define SNAPSHOT_GLOBAL(var) TFE_Memory::snapshot_registerGlobal(&var, sizeof(var))
+
+namespace TFE_Memory
+{
+	struct SnapshotStats
+	{
+		s32 count;				// snapshots in the ring.
+		size_t imageSize;		// size of the full image.
+		size_t undoSize;		// total size of the undo pages.
+		f64 lastCaptureTime;	// in seconds.
+		f64 aveCaptureTime;
+		f64 lastRestoreTime;
+		size_t lastCaptureSize;	// bytes stored by the last capture.
+	};
+
+	// Registration, registering the same memory twice is ignored.
+	void snapshot_registerRegion(MemoryRegion* region);
+	void snapshot_registerGlobal(void* ptr, size_t size);
+	// Called after a snapshot is restored, to rebuild state that is derived from the snapshot memory.
+	void snapshot_registerRestoreCallback(SnapshotRestoreFunc func);
+	void snapshot_unregisterAll();
+
+	// Rewind ring.
+	void  snapshot_setCapacity(s32 count);
+	void  snapshot_capture();
+	// Restore the snapshot 'stepsBack' captures before the newest (0 = newest), newer snapshots are discarded.
+	JBool snapshot_rewind(s32 stepsBack);
+	void  snapshot_clear();
+	s32   snapshot_getCount();
+
+	// A single full snapshot, independent of the ring.
+	// It points into the current level's assets, so clear it when the level changes.
+	void  snapshot_save();
+	JBool snapshot_load();
+	void  snapshot_clearSave();
+	JBool snapshot_hasSave();
+
+	void snapshot_getStats(SnapshotStats* stats);
+}
@@ -6,6 +6,7 @@
 #include <TFE_Ui/ui.h>
 #include <TFE_Asset/imageAsset.h>	// For image saving, this should be refactored...
 #include <TFE_System/profiler.h>
+#include <TFE_System/frameLatency.h>
 #include <TFE_PostProcess/blit.h>
 #include <TFE_PostProcess/postprocess.h>
 #include "renderTarget.h"
@@ -204,7 +205,9 @@ namespace TFE_RenderBackend
 
 		TFE_ZONE_BEGIN(swapGpu, "GPU Swap Buffers");
 		// Update the window.
+		TFE_FrameLatency::stamp(LSTAMP_SWAP_BEGIN);
 		SDL_GL_SwapWindow((SDL_Window*)m_window);
+		TFE_FrameLatency::stamp(LSTAMP_SWAP_END);
 		TFE_ZONE_END(swapGpu);
 
 		if (s_screenshotQueued)
@@ -231,6 +234,11 @@ namespace TFE_RenderBackend
 		s_screenCapture->endRecording();
 	}
 
+	bool isGifRecording()
+	{
+		return s_screenCapture && s_screenCapture->isRecording();
+	}
+
 	void updateSettings()
 	{
 		TFE_Settings_Window* windowSettings = TFE_Settings::getWindowSettings();
@@ -457,6 +465,8 @@ namespace TFE_RenderBackend
 			setupPostEffectChain(true);
 			result = s_virtualDisplay->create(s_virtualWidth, s_virtualHeight, s_asyncFrameBuffer ? 2 : 1, s_gpuColorConvert ? DTEX_R8 : DTEX_RGBA8);
 		}
+		// The asynchronous framebuffer displays the previous upload.
+		TFE_FrameLatency::setDisplayDelay(!s_useRenderTarget && s_asyncFrameBuffer ? 1 : 0);
 		return result;
 	}
 
@@ -514,6 +524,7 @@ namespace TFE_RenderBackend
 		{
 			s_virtualDisplay->update(buffer, size);
 		}
+		TFE_FrameLatency::stamp(LSTAMP_UPLOAD);
 	}
 
 	void bindVirtualDisplay()
@@ -11,7 +11,7 @@
 class ScreenCapture
 {
 public:
-	ScreenCapture() : m_bufferCount(0), m_writeBuffer(0), m_readIndex(nullptr), m_stagingBuffers(nullptr), m_frame(0), m_readCount(0), m_recordingFrame(0) {}
+	ScreenCapture() : m_bufferCount(0), m_writeBuffer(0), m_readIndex(nullptr), m_stagingBuffers(nullptr), m_frame(0), m_readCount(0), m_recordingStarted(false), m_recordingFrame(0) {}
 	~ScreenCapture();
 
 	bool create(u32 width, u32 height, u32 bufferCount);
@@ -23,6 +23,7 @@ public:
 
 	void beginRecording(const char* path);
 	void endRecording();
+	bool isRecording() const { return m_recordingStarted; }
 	
 private:
 	struct Capture
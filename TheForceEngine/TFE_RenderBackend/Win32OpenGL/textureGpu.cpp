@@ -137,6 +137,30 @@ bool TextureGpu::update(const void* buffer, size_t size, s32 layer)
 	return true;
 }
 
+bool TextureGpu::updateRegion(const void* buffer, u32 stride, s32 x, s32 y, u32 width, u32 height, s32 layer)
+{
+	if (x < 0 || y < 0 || x + width > m_width || y + height > m_height || layer < 0 || layer >= (s32)m_layers) { return false; }
+
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
+	if (m_layers == 1)
+	{
+		glBindTexture(GL_TEXTURE_2D, m_gpuHandle);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, m_channels == 4 ? GL_RGBA : GL_RED, GL_UNSIGNED_BYTE, buffer);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+	else
+	{
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_gpuHandle);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0/*level*/, x, y, layer, width, height, 1,
+			m_channels == 4 ? GL_RGBA : GL_RED, GL_UNSIGNED_BYTE, buffer);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+	assert(glGetError() == GL_NO_ERROR);
+	return true;
+}
+
 void TextureGpu::bind(u32 slot/* = 0*/) const
 {
 	glActiveTexture(GL_TEXTURE0 + slot);
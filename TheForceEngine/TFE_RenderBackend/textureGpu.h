@@ -29,6 +29,8 @@ public:
 	bool createArray(u32 width, u32 height, u32 layers, u32 channels = 4);
 	bool createWithData(u32 width, u32 height, const void* buffer, MagFilter magFilter = MAG_FILTER_NONE);
 	bool update(const void* buffer, size_t size, s32 layer = -1);	// layer = -1 means update all layers, otherwise it is the layer index.
+	// Update a rectangle of a single layer, 'buffer' points to the first texel and 'stride' is its row length in texels.
+	bool updateRegion(const void* buffer, u32 stride, s32 x, s32 y, u32 width, u32 height, s32 layer = 0);
 	void bind(u32 slot = 0) const;
 	static void clear(u32 slot = 0);
 
@@ -286,7 +286,12 @@ namespace TFE_Settings
 		writeKeyValue_Bool(settings, "colorCorrection", s_graphicsSettings.colorCorrection);
 		writeKeyValue_Bool(settings, "perspectiveCorrect3DO", s_graphicsSettings.perspectiveCorrectTexturing);
 		writeKeyValue_Bool(settings, "extendAjoinLimits", s_graphicsSettings.extendAjoinLimits);
+		writeKeyValue_Int(settings, "rendererThreadCount", s_graphicsSettings.rendererThreadCount);
+		writeKeyValue_Bool(settings, "indexedGifRecording", s_graphicsSettings.indexedGifRecording);
+		writeKeyValue_Int(settings, "spriteCacheSizeMB", s_graphicsSettings.spriteCacheSizeMB);
+		writeKeyValue_Bool(settings, "spriteCachePreload", s_graphicsSettings.spriteCachePreload);
 		writeKeyValue_Bool(settings, "vsync", s_graphicsSettings.vsync);
+		writeKeyValue_Bool(settings, "lowLatencyMode", s_graphicsSettings.lowLatencyMode);
 		writeKeyValue_Float(settings, "brightness", s_graphicsSettings.brightness);
 		writeKeyValue_Float(settings, "contrast", s_graphicsSettings.contrast);
 		writeKeyValue_Float(settings, "saturation", s_graphicsSettings.saturation);
@@ -319,6 +324,7 @@ namespace TFE_Settings
 		writeKeyValue_Float(settings, "cutsceneSoundFxVolume", s_soundSettings.cutsceneSoundFxVolume);
 		writeKeyValue_Float(settings, "cutsceneMusicVolume", s_soundSettings.cutsceneMusicVolume);
 		writeKeyValue_Bool(settings, "use16Channels", s_soundSettings.use16Channels);
+		writeKeyValue_Bool(settings, "lowLatencyAudio", s_soundSettings.lowLatencyAudio);
 	}
 
 	void writeGameSettings(FileStream& settings)
@@ -340,6 +346,8 @@ namespace TFE_Settings
 				writeKeyValue_Int(settings, "airControl", s_gameSettings.df_airControl);
 				writeKeyValue_Bool(settings, "fixBobaFettFireDir", s_gameSettings.df_fixBobaFettFireDir);
 				writeKeyValue_Bool(settings, "disableFightMusic", s_gameSettings.df_disableFightMusic);
+				writeKeyValue_Int(settings, "fixedTimestep", s_gameSettings.df_fixedTimestep);
+				writeKeyValue_Bool(settings, "interpolateFrames", s_gameSettings.df_interpolateFrames);
 			}
 		}
 	}
@@ -541,10 +549,30 @@ namespace TFE_Settings
 		{
 			s_graphicsSettings.extendAjoinLimits = parseBool(value);
 		}
+		else if (strcasecmp("rendererThreadCount", key) == 0)
+		{
+			s_graphicsSettings.rendererThreadCount = parseInt(value);
+		}
+		else if (strcasecmp("indexedGifRecording", key) == 0)
+		{
+			s_graphicsSettings.indexedGifRecording = parseBool(value);
+		}
+		else if (strcasecmp("spriteCacheSizeMB", key) == 0)
+		{
+			s_graphicsSettings.spriteCacheSizeMB = parseInt(value);
+		}
+		else if (strcasecmp("spriteCachePreload", key) == 0)
+		{
+			s_graphicsSettings.spriteCachePreload = parseBool(value);
+		}
 		else if (strcasecmp("vsync", key) == 0)
 		{
 			s_graphicsSettings.vsync = parseBool(value);
 		}
+		else if (strcasecmp("lowLatencyMode", key) == 0)
+		{
+			s_graphicsSettings.lowLatencyMode = parseBool(value);
+		}
 		else if (strcasecmp("brightness", key) == 0)
 		{
 			s_graphicsSettings.brightness = parseFloat(value);
@@ -651,6 +679,10 @@ namespace TFE_Settings
 		{
 			s_soundSettings.use16Channels = parseBool(value);
 		}
+		else if (strcasecmp("lowLatencyAudio", key) == 0)
+		{
+			s_soundSettings.lowLatencyAudio = parseBool(value);
+		}
 	}
 
 	void parseGame(const char* key, const char* value)
@@ -705,6 +737,14 @@ namespace TFE_Settings
 		{
 			s_gameSettings.df_disableFightMusic = parseBool(value);
 		}
+		else if (strcasecmp("fixedTimestep", key) == 0)
+		{
+			s_gameSettings.df_fixedTimestep = std::min(std::max(parseInt(value), 0), 8);
+		}
+		else if (strcasecmp("interpolateFrames", key) == 0)
+		{
+			s_gameSettings.df_interpolateFrames = parseBool(value);
+		}
 	}
 
 	void parseOutlawsSettings(const char* key, const char* value)
@@ -32,7 +32,12 @@ struct TFE_Settings_Graphics
 	bool  colorCorrection = false;
 	bool  perspectiveCorrectTexturing = false;
 	bool  extendAjoinLimits = true;
+	s32   rendererThreadCount = 1;	// Threads used by the software renderer at high resolutions (1 = single-threaded).
+	bool  indexedGifRecording = true;	// Record GIFs from the 8-bit framebuffer when using the software renderer.
+	s32   spriteCacheSizeMB = 16;	// Memory used to keep decompressed sprite cells for the software renderer (0 = disabled).
+	bool  spriteCachePreload = false;	// Decompress all sprite cells when they are loaded instead of when first drawn.
 	bool  vsync = true;
+	bool  lowLatencyMode = false;	// With vsync, sample input and simulate as late as possible before the vertical blank.
 	f32   brightness = 1.0f;
 	f32   contrast = 1.0f;
 	f32   saturation = 1.0f;
@@ -93,6 +98,7 @@ struct TFE_Settings_Sound
 	f32 cutsceneSoundFxVolume = 0.9f;
 	f32 cutsceneMusicVolume = 1.0f;
 	bool use16Channels = false;
+	bool lowLatencyAudio = false;	// 128 sample audio buffers instead of 256, takes effect on restart.
 };
 
 struct TFE_Game
@@ -117,6 +123,8 @@ struct TFE_Settings_Game
 	bool df_fixBobaFettFireDir = false;	// By default, Boba Fett does not correctly check the angle difference between him and the player in
 										// one direction, enabling this will fix that.
 	bool df_disableFightMusic = false;	// Set to true to disable fight music and music transitions during gameplay.
+	s32  df_fixedTimestep = 0;			// 0 = the simulation runs once per frame (default), N = the simulation advances exactly N ticks at a time (145 / N Hz); range = [0, 8]
+	bool df_interpolateFrames = true;	// With a fixed timestep, draw objects and the camera between simulation steps on frames that do not run the simulation.
 };
 
 namespace TFE_Settings
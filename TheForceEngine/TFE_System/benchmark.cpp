@@ -0,0 +1,350 @@
+#include <cstring>
+#include <cstdarg>
+#include <cmath>
+
+#include "benchmark.h"
+#include "system.h"
+#include "profiler.h"
+#include "parser.h"
+#include <TFE_FileSystem/filestream.h>
+#include <SDL.h>
+#include <algorithm>
+#include <vector>
+#include <string>
+
+namespace TFE_Benchmark
+{
+	enum BenchmarkState
+	{
+		BENCH_INACTIVE = 0,
+		BENCH_LOADING,		// waiting for the level to load.
+		BENCH_RUNNING,
+		BENCH_COMPLETE,
+	};
+
+	// If the level has not started after this many frames, something went wrong.
+	#define BENCH_MAX_LOAD_FRAMES 10000
+
+	static BenchmarkSettings s_settings =
+	{
+		"",		// level
+		1000,	// frameCount
+		60,		// warmupFrames
+		60.0,	// tickRate
+		false,	// floatRenderer
+		320,	// width
+		200,	// height
+		"",		// pathFile
+		"",		// outputFile
+	};
+	static BenchmarkState s_state = BENCH_INACTIVE;
+	static s32 s_frame = 0;
+	static s32 s_loadFrames = 0;
+	static u64 s_frameStart = 0;
+	static f64 s_freq = 0.0;
+	static char s_error[256] = "";
+
+	static std::vector<f64> s_frameTimes;
+	static std::vector<BenchmarkPose> s_path;
+
+	BenchmarkSettings* getSettings()
+	{
+		return &s_settings;
+	}
+
+	void enable(const char* level, s32 frameCount)
+	{
+		strncpy(s_settings.level, level, sizeof(s_settings.level) - 1);
+		s_settings.level[sizeof(s_settings.level) - 1] = 0;
+		if (frameCount > 0)
+		{
+			s_settings.frameCount = frameCount;
+		}
+		s_state = BENCH_LOADING;
+	}
+
+	bool isActive()
+	{
+		return s_state != BENCH_INACTIVE;
+	}
+
+	bool loadPath(const char* filename)
+	{
+		FileStream file;
+		if (!file.open(filename, FileStream::MODE_READ))
+		{
+			return false;
+		}
+		const size_t len = file.getSize();
+		std::vector<char> buffer(len + 1);
+		file.readBuffer(buffer.data(), (u32)len);
+		file.close();
+		buffer[len] = 0;
+
+		TFE_Parser parser;
+		parser.init(buffer.data(), len);
+		parser.addCommentString("#");
+
+		size_t bufferPos = 0;
+		while (bufferPos < len)
+		{
+			const char* line = parser.readLine(bufferPos, true);
+			if (!line) { break; }
+
+			BenchmarkPose pose = { 0 };
+			if (sscanf(line, "%f %f %f %f", &pose.x, &pose.y, &pose.z, &pose.yaw) >= 3)
+			{
+				s_path.push_back(pose);
+			}
+		}
+		return !s_path.empty();
+	}
+
+	bool start()
+	{
+		if (s_state == BENCH_INACTIVE) { return false; }
+
+		// The fixed point renderer only supports the original resolution.
+		if (!s_settings.floatRenderer)
+		{
+			s_settings.width = 320;
+			s_settings.height = 200;
+		}
+		s_settings.width  = std::max(4 * ((s_settings.width + 3) >> 2), 320);
+		s_settings.height = std::max(s_settings.height, 200);
+		s_settings.tickRate = std::max(s_settings.tickRate, 1.0);
+		s_settings.warmupFrames = std::max(s_settings.warmupFrames, 0);
+
+		s_path.clear();
+		if (s_settings.pathFile[0] && !loadPath(s_settings.pathFile))
+		{
+			fail("Cannot load the camera path.");
+			return false;
+		}
+
+		s_freq = 1.0 / f64(SDL_GetPerformanceFrequency());
+		s_frameTimes.clear();
+		s_frameTimes.reserve(s_settings.frameCount);
+		s_frame = 0;
+		s_loadFrames = 0;
+		s_error[0] = 0;
+
+		TFE_System::setFixedTimeStep(1.0 / s_settings.tickRate);
+		TFE_System::logWrite(LOG_MSG, "Benchmark", "Benchmark level '%s', %d frames, %s renderer at %dx%d.", s_settings.level, s_settings.frameCount,
+			s_settings.floatRenderer ? "float" : "fixed", s_settings.width, s_settings.height);
+		return true;
+	}
+
+	void levelStarted()
+	{
+		if (s_state != BENCH_LOADING) { return; }
+		s_state = BENCH_RUNNING;
+		s_frame = 0;
+	}
+
+	void levelEnded()
+	{
+		if (s_state != BENCH_RUNNING) { return; }
+		fail("The level ended before the benchmark was complete.");
+	}
+
+	void fail(const char* reason)
+	{
+		if (s_state == BENCH_INACTIVE || s_state == BENCH_COMPLETE) { return; }
+
+		strncpy(s_error, reason, sizeof(s_error) - 1);
+		s_error[sizeof(s_error) - 1] = 0;
+		s_state = BENCH_COMPLETE;
+		TFE_System::logWrite(LOG_ERROR, "Benchmark", "%s", reason);
+	}
+
+	bool isRunning()
+	{
+		return s_state == BENCH_RUNNING;
+	}
+
+	bool isComplete()
+	{
+		return s_state == BENCH_COMPLETE;
+	}
+
+	bool succeeded()
+	{
+		return s_state == BENCH_COMPLETE && !s_error[0] && s_frame >= getTotalFrames();
+	}
+
+	s32 getFrame()
+	{
+		return s_frame;
+	}
+
+	s32 getTotalFrames()
+	{
+		return s_settings.warmupFrames + s_settings.frameCount;
+	}
+
+	// The path is traversed once over the whole run, spending the same number of frames on each segment.
+	bool getCameraPose(s32 frame, BenchmarkPose* pose)
+	{
+		const s32 count = (s32)s_path.size();
+		if (!count) { return false; }
+		if (count == 1)
+		{
+			*pose = s_path[0];
+			return true;
+		}
+
+		const s32 lastFrame = std::max(getTotalFrames() - 1, 1);
+		const f64 t = f64(std::min(std::max(frame, 0), lastFrame)) * f64(count - 1) / f64(lastFrame);
+		const s32 index = std::min(s32(t), count - 2);
+		const f32 blend = f32(t - f64(index));
+
+		const BenchmarkPose* p0 = &s_path[index];
+		const BenchmarkPose* p1 = &s_path[index + 1];
+		// Turn the shortest way around.
+		f32 dYaw = fmodf(p1->yaw - p0->yaw, 360.0f);
+		if (dYaw >  180.0f) { dYaw -= 360.0f; }
+		if (dYaw < -180.0f) { dYaw += 360.0f; }
+
+		pose->x = p0->x + (p1->x - p0->x) * blend;
+		pose->y = p0->y + (p1->y - p0->y) * blend;
+		pose->z = p0->z + (p1->z - p0->z) * blend;
+		pose->yaw = p0->yaw + dYaw * blend;
+		return true;
+	}
+
+	void frameBegin()
+	{
+		if (s_state == BENCH_RUNNING && s_frame == s_settings.warmupFrames)
+		{
+			TFE_Profiler::resetZoneTotals();
+		}
+		s_frameStart = SDL_GetPerformanceCounter();
+	}
+
+	void frameEnd()
+	{
+		if (s_state == BENCH_LOADING)
+		{
+			s_loadFrames++;
+			if (s_loadFrames > BENCH_MAX_LOAD_FRAMES)
+			{
+				fail("The level did not load.");
+			}
+			return;
+		}
+		else if (s_state != BENCH_RUNNING)
+		{
+			return;
+		}
+
+		if (s_frame >= s_settings.warmupFrames)
+		{
+			s_frameTimes.push_back(f64(SDL_GetPerformanceCounter() - s_frameStart) * s_freq);
+		}
+		s_frame++;
+
+		if (s_frame >= getTotalFrames())
+		{
+			s_state = BENCH_COMPLETE;
+		}
+	}
+
+	// Nearest rank percentile of the sorted frame times.
+	f64 getPercentile(const std::vector<f64>& sorted, f64 percent)
+	{
+		if (sorted.empty()) { return 0.0; }
+		const size_t count = sorted.size();
+		size_t rank = size_t(percent / 100.0 * f64(count) + 0.999999);
+		rank = std::min(std::max(rank, size_t(1)), count);
+		return sorted[rank - 1];
+	}
+
+	void appendString(std::string& out, const char* str)
+	{
+		out += '"';
+		for (const char* c = str; *c; c++)
+		{
+			if (*c == '"' || *c == '\\') { out += '\\'; }
+			out += *c;
+		}
+		out += '"';
+	}
+
+	void appendValue(std::string& out, const char* fmt, ...)
+	{
+		char value[256];
+		va_list arg;
+		va_start(arg, fmt);
+		vsnprintf(value, sizeof(value), fmt, arg);
+		va_end(arg);
+		out += value;
+	}
+
+	void writeResults()
+	{
+		std::vector<f64> sorted = s_frameTimes;
+		std::sort(sorted.begin(), sorted.end());
+
+		f64 total = 0.0;
+		for (size_t i = 0; i < sorted.size(); i++)
+		{
+			total += sorted[i];
+		}
+		const f64 average = sorted.empty() ? 0.0 : total / f64(sorted.size());
+
+		std::string out = "{\n  \"level\": ";
+		appendString(out, s_settings.level);
+		appendValue(out, ",\n  \"renderer\": \"%s\",\n  \"width\": %d,\n  \"height\": %d,\n  \"tickRate\": %g,\n",
+			s_settings.floatRenderer ? "float" : "fixed", s_settings.width, s_settings.height, s_settings.tickRate);
+		appendValue(out, "  \"warmupFrames\": %d,\n  \"frames\": %d,\n  \"cameraPath\": %s,\n",
+			s_settings.warmupFrames, (s32)sorted.size(), s_path.empty() ? "false" : "true");
+		if (s_error[0])
+		{
+			out += "  \"error\": ";
+			appendString(out, s_error);
+			out += ",\n";
+		}
+
+		// Frame times are in milliseconds.
+		appendValue(out, "  \"frameTimeMs\": { \"avg\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f },\n",
+			average * 1000.0, sorted.empty() ? 0.0 : sorted.front() * 1000.0, getPercentile(sorted, 50.0) * 1000.0,
+			getPercentile(sorted, 90.0) * 1000.0, getPercentile(sorted, 99.0) * 1000.0, sorted.empty() ? 0.0 : sorted.back() * 1000.0);
+
+		out += "  \"zones\": [";
+		const u32 zoneCount = TFE_Profiler::getZoneTotalCount();
+		bool first = true;
+		for (u32 i = 0; i < zoneCount; i++)
+		{
+			TFE_ZoneTotal zone;
+			TFE_Profiler::getZoneTotal(i, &zone);
+			if (!zone.frameCount) { continue; }
+
+			out += first ? "\n    { \"name\": " : ",\n    { \"name\": ";
+			appendString(out, zone.name);
+			out += ", \"func\": ";
+			appendString(out, zone.func);
+			appendValue(out, ", \"totalMs\": %.4f, \"frames\": %u, \"avgMs\": %.4f }", zone.timeTotal * 1000.0, zone.frameCount,
+				zone.timeTotal * 1000.0 / f64(zone.frameCount));
+			first = false;
+		}
+		out += first ? "]\n}\n" : "\n  ]\n}\n";
+
+		fputs(out.c_str(), stdout);
+		fflush(stdout);
+
+		if (s_settings.outputFile[0])
+		{
+			FileStream file;
+			if (file.open(s_settings.outputFile, FileStream::MODE_WRITE))
+			{
+				file.writeBuffer(out.c_str(), (u32)out.length());
+				file.close();
+			}
+			else
+			{
+				TFE_System::logWrite(LOG_ERROR, "Benchmark", "Cannot write benchmark results to '%s'.", s_settings.outputFile);
+			}
+		}
+	}
+}
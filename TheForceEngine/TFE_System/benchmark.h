@@ -0,0 +1,70 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine Benchmark
+// Deterministic benchmark run started from the command line:
+//   --benchmark LEVEL [frameCount]
+//   --benchmark-renderer fixed|float
+//   --benchmark-res width height     (float renderer only)
+//   --benchmark-path file            (lines of "x y z yawInDegrees")
+//   --benchmark-warmup frameCount
+//   --benchmark-tickrate rate
+//   --benchmark-out file
+//
+// The game runs with a fixed time step so every run simulates the
+// same frames, the camera either follows the path or turns in place.
+// When done, frame time percentiles and profiler zone totals are
+// written as JSON to stdout (and the output file if given).
+//////////////////////////////////////////////////////////////////////
+#include "types.h"
+#include <TFE_FileSystem/paths.h>
+
+namespace TFE_Benchmark
+{
+	struct BenchmarkSettings
+	{
+		char level[64];
+		s32  frameCount;
+		s32  warmupFrames;
+		f64  tickRate;
+		bool floatRenderer;
+		s32  width;
+		s32  height;
+		char pathFile[TFE_MAX_PATH];
+		char outputFile[TFE_MAX_PATH];
+	};
+
+	// Camera pose in the same units as the "warp" console command, yaw in degrees.
+	struct BenchmarkPose
+	{
+		f32 x, y, z;
+		f32 yaw;
+	};
+
+	BenchmarkSettings* getSettings();
+	// Enable the benchmark, called while parsing the command line.
+	void enable(const char* level, s32 frameCount);
+	bool isActive();
+
+	// Called once the game is about to start, sets the fixed time step and loads the camera path.
+	bool start();
+	// Called by the game once the level is loaded and ready to render.
+	void levelStarted();
+	// Called by the game if the level ends before all of the frames have been rendered.
+	void levelEnded();
+	void fail(const char* reason);
+
+	bool isRunning();
+	bool isComplete();
+	// True if every frame was rendered without an error.
+	bool succeeded();
+	// Frames since the level started, including the warmup frames.
+	s32  getFrame();
+	s32  getTotalFrames();
+	// Returns false if there is no camera path.
+	bool getCameraPose(s32 frame, BenchmarkPose* pose);
+
+	void frameBegin();
+	void frameEnd();
+
+	void writeResults();
+}
@@ -0,0 +1,339 @@
+#include <cstring>
+
+#include "frameLatency.h"
+#include "system.h"
+#include "profiler.h"
+#include <TFE_RenderBackend/renderBackend.h>
+#include <algorithm>
+#include <thread>
+
+namespace TFE_FrameLatency
+{
+	#define LATENCY_HISTORY 256			// frames used for the statistics.
+	#define LATENCY_COST_FRAMES 32		// frames used to estimate the frame cost in low latency mode.
+	#define LATENCY_MAX_DISPLAY_DELAY 2
+	#define LATENCY_MIN_MARGIN 0.001	// seconds left between the expected swap and the vertical blank.
+	#define LATENCY_REFRESH_CHECK 1.0	// seconds between refresh rate queries, which are costly.
+	#define LATENCY_MIN_SLACK 0.001		// seconds before the target where the wait stops sleeping.
+	#define LATENCY_SLACK_DECAY 0.0001	// seconds per frame the sleep slack goes back down.
+	#define LATENCY_MAX_SLACK 0.25		// fraction of the refresh period, limits the time spent spinning.
+	#define LATENCY_NOT_STAMPED -1.0f
+
+	// The input that a simulation, render or displayed frame is based on.
+	struct InputSource
+	{
+		u64  sample;	// the first input sample that was not yet consumed.
+		u64  event;		// the oldest input event that was not yet consumed.
+		bool valid;
+		bool hasEvent;
+	};
+
+	struct LatencyFrame
+	{
+		f32 stage[LSTAMP_COUNT];	// milliseconds since the start of the frame.
+		f32 inputToDisplay;
+		f32 eventToDisplay;
+		f32 wait;
+	};
+
+	static u64  s_stamp[LSTAMP_COUNT];
+	static bool s_stamped[LSTAMP_COUNT];
+
+	static InputSource s_pending;		// sampled but not consumed by the simulation yet.
+	static InputSource s_simulated;		// consumed by the last simulation.
+	static InputSource s_rendered;		// reflected by the last render.
+	static InputSource s_uploadQueue[LATENCY_MAX_DISPLAY_DELAY + 1];
+	static InputSource s_displayed;		// reflected by the image sent to the display this frame.
+	static s32 s_displayDelay = 0;
+	static u64 s_lastEventDisplayed = 0;
+
+	static LatencyFrame s_history[LATENCY_HISTORY];
+	static s32 s_historyCount = 0;
+	static s32 s_historyIndex = 0;
+
+	// Low latency mode.
+	static bool s_lowLatency = false;
+	static f64  s_frameCost[LATENCY_COST_FRAMES];
+	static s32  s_frameCostIndex = 0;
+	static f64  s_margin = LATENCY_MIN_MARGIN;
+	static f64  s_sleepSlack = 0.002;
+	static f64  s_refreshRate = 0.0;
+	static u64  s_refreshCheck = 0;
+	static u64  s_lastSwap = 0;
+	static bool s_hasLastSwap = false;
+	static f64  s_wait = 0.0;
+
+	// Profiler counters, in microseconds.
+	static s32 s_inputToDisplayUs = 0;
+	static s32 s_eventToDisplayUs = 0;
+	static s32 s_waitUs = 0;
+
+	void lowLatencyWait();
+	void recordFrame(u64 swapTime);
+
+	void init()
+	{
+		TFE_COUNTER(s_inputToDisplayUs, "Input to Display (us)");
+		TFE_COUNTER(s_eventToDisplayUs, "Input Event to Display (us)");
+		TFE_COUNTER(s_waitUs, "Low Latency Wait (us)");
+		resetStats();
+	}
+
+	f64 ticksToSeconds(u64 start, u64 end)
+	{
+		return end >= start ? TFE_System::convertFromTicksToSeconds(end - start) : -TFE_System::convertFromTicksToSeconds(start - end);
+	}
+
+	u64 secondsToTicks(f64 seconds)
+	{
+		return u64(seconds / TFE_System::convertFromTicksToSeconds(1));
+	}
+
+	void frameBegin()
+	{
+		s_wait = 0.0;
+		if (s_lowLatency)
+		{
+			lowLatencyWait();
+		}
+
+		memset(s_stamped, 0, sizeof(s_stamped));
+		stamp(LSTAMP_FRAME_BEGIN);
+	}
+
+	void stamp(LatencyStamp type)
+	{
+		const u64 time = TFE_System::getCurrentTimeInTicks();
+		s_stamp[type] = time;
+		s_stamped[type] = true;
+
+		switch (type)
+		{
+			case LSTAMP_INPUT:
+			{
+				if (!s_pending.valid)
+				{
+					s_pending.sample = time;
+					s_pending.valid = true;
+				}
+			} break;
+			case LSTAMP_SIM_END:
+			{
+				if (s_pending.valid)
+				{
+					s_simulated = s_pending;
+					memset(&s_pending, 0, sizeof(InputSource));
+				}
+			} break;
+			case LSTAMP_RENDER_END:
+			{
+				// If the render happened before the simulation this frame, it shows the previous simulation.
+				s_rendered = s_simulated;
+			} break;
+			case LSTAMP_UPLOAD:
+			{
+				for (s32 i = s_displayDelay; i > 0; i--)
+				{
+					s_uploadQueue[i] = s_uploadQueue[i - 1];
+				}
+				s_uploadQueue[0] = s_rendered;
+				s_displayed = s_uploadQueue[s_displayDelay];
+			} break;
+			case LSTAMP_SWAP_BEGIN:
+			{
+				if (s_stamped[LSTAMP_INPUT])
+				{
+					s_frameCost[s_frameCostIndex] = ticksToSeconds(s_stamp[LSTAMP_INPUT], time);
+					s_frameCostIndex = (s_frameCostIndex + 1) % LATENCY_COST_FRAMES;
+				}
+			} break;
+			case LSTAMP_SWAP_END:
+			{
+				recordFrame(time);
+			} break;
+		}
+	}
+
+	void inputEvent(u32 ageMs)
+	{
+		const u64 time = TFE_System::getCurrentTimeInTicks();
+		const u64 age = std::min(secondsToTicks(f64(ageMs) * 0.001), time);
+		const u64 eventTime = time - age;
+		if (!s_pending.hasEvent || eventTime < s_pending.event)
+		{
+			s_pending.event = eventTime;
+			s_pending.hasEvent = true;
+		}
+	}
+
+	void setDisplayDelay(s32 frames)
+	{
+		s_displayDelay = std::max(0, std::min(frames, LATENCY_MAX_DISPLAY_DELAY));
+		memset(s_uploadQueue, 0, sizeof(s_uploadQueue));
+	}
+
+	void enableLowLatency(bool enable)
+	{
+		if (enable == s_lowLatency) { return; }
+		s_lowLatency = enable;
+		s_margin = LATENCY_MIN_MARGIN;
+		s_refreshRate = 0.0;
+		memset(s_frameCost, 0, sizeof(s_frameCost));
+	}
+
+	bool lowLatencyEnabled()
+	{
+		return s_lowLatency;
+	}
+
+	// Wait so that the input is sampled as late as possible while still making the next vertical blank.
+	void lowLatencyWait()
+	{
+		if (!TFE_System::getVSync() || !s_hasLastSwap) { return; }
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		if (s_refreshRate <= 0.0 || ticksToSeconds(s_refreshCheck, start) > LATENCY_REFRESH_CHECK)
+		{
+			s_refreshRate = f64(TFE_RenderBackend::getDisplayRefreshRate());
+			s_refreshCheck = start;
+		}
+		if (s_refreshRate <= 0.0) { return; }
+
+		// The swap returns at a vertical blank, so the next one is a refresh period later.
+		// Use the most expensive recent frame so that a single slow frame does not miss it.
+		const f64 period = 1.0 / s_refreshRate;
+		// A single long sleep (a context switch or a window drag) should not make the wait spin for the rest of the session.
+		s_sleepSlack = std::max(s_sleepSlack - LATENCY_SLACK_DECAY, LATENCY_MIN_SLACK);
+		f64 cost = 0.0;
+		for (s32 i = 0; i < LATENCY_COST_FRAMES; i++)
+		{
+			cost = std::max(cost, s_frameCost[i]);
+		}
+		const f64 wait = period - ticksToSeconds(s_lastSwap, start) - cost - s_margin;
+		if (wait <= 0.0) { return; }
+
+		TFE_ZONE("Low Latency Wait");
+		const u64 target = start + secondsToTicks(wait);
+		u64 time = start;
+		while (time < target)
+		{
+			if (ticksToSeconds(time, target) > s_sleepSlack)
+			{
+				TFE_System::sleep(1);
+				// Sleep granularity depends on the system, never sleep when it could overshoot the target.
+				const u64 wake = TFE_System::getCurrentTimeInTicks();
+				s_sleepSlack = std::min(std::max(s_sleepSlack, ticksToSeconds(time, wake) + 0.0005), period * LATENCY_MAX_SLACK);
+				time = wake;
+			}
+			else
+			{
+				std::this_thread::yield();
+				time = TFE_System::getCurrentTimeInTicks();
+			}
+		}
+		s_wait = ticksToSeconds(start, time);
+	}
+
+	void recordFrame(u64 swapTime)
+	{
+		// A swap that came more than half a period late missed the vertical blank, so leave more room.
+		if (s_lowLatency && s_hasLastSwap && s_refreshRate > 0.0)
+		{
+			const f64 period = 1.0 / s_refreshRate;
+			if (ticksToSeconds(s_lastSwap, swapTime) > period * 1.5)
+			{
+				s_margin = std::min(s_margin + 0.0005, period * 0.5);
+			}
+			else
+			{
+				s_margin = std::max(s_margin - 0.00001, LATENCY_MIN_MARGIN);
+			}
+		}
+		s_lastSwap = swapTime;
+		s_hasLastSwap = true;
+
+		s_waitUs = s32(s_wait * 1000000.0);
+		// Only frames that displayed a new render are measured.
+		if (!s_stamped[LSTAMP_UPLOAD] || !s_displayed.valid) { return; }
+
+		LatencyFrame* frame = &s_history[s_historyIndex];
+		for (s32 i = 0; i < LSTAMP_COUNT; i++)
+		{
+			frame->stage[i] = s_stamped[i] ? f32(ticksToSeconds(s_stamp[LSTAMP_FRAME_BEGIN], s_stamp[i]) * 1000.0) : LATENCY_NOT_STAMPED;
+		}
+		frame->inputToDisplay = f32(ticksToSeconds(s_displayed.sample, swapTime) * 1000.0);
+		frame->wait = f32(s_wait * 1000.0);
+
+		// The response to an event is only counted the first time it is displayed.
+		frame->eventToDisplay = LATENCY_NOT_STAMPED;
+		if (s_displayed.hasEvent && s_displayed.event != s_lastEventDisplayed)
+		{
+			frame->eventToDisplay = f32(ticksToSeconds(s_displayed.event, swapTime) * 1000.0);
+			s_lastEventDisplayed = s_displayed.event;
+			s_eventToDisplayUs = s32(frame->eventToDisplay * 1000.0f);
+		}
+		s_inputToDisplayUs = s32(frame->inputToDisplay * 1000.0f);
+
+		s_historyIndex = (s_historyIndex + 1) % LATENCY_HISTORY;
+		s_historyCount = std::min(s_historyCount + 1, LATENCY_HISTORY);
+	}
+
+	void addSample(LatencyStageStats* stats, s32* count, f32 value)
+	{
+		if (value < 0.0f) { return; }
+		stats->ave += f64(value);
+		stats->max = std::max(stats->max, f64(value));
+		(*count)++;
+	}
+
+	void finishSamples(LatencyStageStats* stats, s32 count)
+	{
+		stats->ave = count ? stats->ave / f64(count) : 0.0;
+	}
+
+	void getStats(LatencyStats* stats)
+	{
+		memset(stats, 0, sizeof(LatencyStats));
+		stats->displayDelay = s_displayDelay;
+		stats->lowLatency = s_lowLatency && TFE_System::getVSync();
+
+		s32 stageCount[LSTAMP_COUNT] = { 0 };
+		s32 waitCount = 0;
+		f32 inputToDisplay[LATENCY_HISTORY];
+		for (s32 f = 0; f < s_historyCount; f++)
+		{
+			const LatencyFrame* frame = &s_history[f];
+			for (s32 i = 0; i < LSTAMP_COUNT; i++)
+			{
+				addSample(&stats->stage[i], &stageCount[i], frame->stage[i]);
+			}
+			addSample(&stats->inputToDisplay, &stats->frameCount, frame->inputToDisplay);
+			addSample(&stats->eventToDisplay, &stats->eventFrameCount, frame->eventToDisplay);
+			addSample(&stats->wait, &waitCount, frame->wait);
+			inputToDisplay[f] = frame->inputToDisplay;
+		}
+		for (s32 i = 0; i < LSTAMP_COUNT; i++)
+		{
+			finishSamples(&stats->stage[i], stageCount[i]);
+		}
+		finishSamples(&stats->inputToDisplay, stats->frameCount);
+		finishSamples(&stats->eventToDisplay, stats->eventFrameCount);
+		finishSamples(&stats->wait, waitCount);
+
+		if (s_historyCount)
+		{
+			const s32 index95 = (s_historyCount * 95) / 100;
+			std::nth_element(inputToDisplay, inputToDisplay + index95, inputToDisplay + s_historyCount);
+			stats->inputToDisplay95 = f64(inputToDisplay[index95]);
+		}
+	}
+
+	void resetStats()
+	{
+		s_historyCount = 0;
+		s_historyIndex = 0;
+		s_inputToDisplayUs = 0;
+		s_eventToDisplayUs = 0;
+		s_waitUs = 0;
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine Frame Latency
+// Per-frame timestamps from input sampling to the buffer swap, used to
+// measure how long it takes for input to reach the display:
+//   input sample -> simulation end -> render end -> upload -> swap
+// Input is followed through the frame that consumed it, so a render
+// that happens before the simulation (as in the Dark Forces main task)
+// or an asynchronous framebuffer upload is counted correctly.
+//
+// Low latency mode (vsync only) delays input sampling and simulation
+// until just before the next vertical blank, based on the measured
+// cost of recent frames.
+//////////////////////////////////////////////////////////////////////
+#include "types.h"
+
+enum LatencyStamp
+{
+	LSTAMP_FRAME_BEGIN = 0,
+	LSTAMP_INPUT,			// events polled and input sampled.
+	LSTAMP_SIM_END,			// the simulation consumed the input.
+	LSTAMP_RENDER_END,		// the virtual framebuffer is complete.
+	LSTAMP_UPLOAD,			// the virtual framebuffer has been handed to the GPU.
+	LSTAMP_SWAP_BEGIN,
+	LSTAMP_SWAP_END,
+	LSTAMP_COUNT
+};
+
+struct LatencyStageStats
+{
+	f64 ave;	// milliseconds
+	f64 max;
+};
+
+struct LatencyStats
+{
+	s32 frameCount;			// frames that displayed a new render.
+	s32 eventFrameCount;	// frames that displayed the response to an input event.
+	s32 displayDelay;		// extra frames added by the framebuffer upload.
+	bool lowLatency;
+
+	// Time of each stamp since the start of the frame, after the low latency wait.
+	LatencyStageStats stage[LSTAMP_COUNT];
+	LatencyStageStats inputToDisplay;
+	LatencyStageStats eventToDisplay;
+	LatencyStageStats wait;
+	f64 inputToDisplay95;
+};
+
+namespace TFE_FrameLatency
+{
+	void init();
+
+	// Called at the start of each frame, waits in low latency mode.
+	void frameBegin();
+	void stamp(LatencyStamp type);
+	// An input event was received 'ageMs' milliseconds ago.
+	void inputEvent(u32 ageMs);
+
+	// Frames rendered to the virtual display are shown 'frames' swaps later.
+	void setDisplayDelay(s32 frames);
+	void enableLowLatency(bool enable);
+	bool lowLatencyEnabled();
+
+	void getStats(LatencyStats* stats);
+	void resetStats();
+}
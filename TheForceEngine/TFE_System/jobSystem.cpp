@@ -0,0 +1,153 @@
+#include <cstring>
+#include <cstdio>
+
+#include "jobSystem.h"
+#include "system.h"
+#include "profiler.h"
+#include <TFE_System/Threads/thread.h>
+#include <TFE_System/Threads/signal.h>
+#include <SDL.h>
+#include <algorithm>
+
+namespace TFE_Jobs
+{
+	struct JobWorker
+	{
+		Thread* thread;
+		Signal* start;
+		Signal* done;
+	};
+
+	static JobWorker s_workers[MAX_JOB_WORKERS];
+	static s32 s_workerCount = 0;
+	static atomic_bool s_runWorkers;
+
+	// The current job, only valid between the start and done signals.
+	static JobFunc s_func = nullptr;
+	static void* s_userData = nullptr;
+	static s32 s_count = 0;
+	static atomic_s32 s_nextIndex;
+
+	void processItems()
+	{
+		for (s32 i = s_nextIndex.fetch_add(1); i < s_count; i = s_nextIndex.fetch_add(1))
+		{
+			s_func(i, s_userData);
+		}
+	}
+
+	TFE_THREADRET TFE_STDCALL jobs_workerFunc(void* userData)
+	{
+		JobWorker* worker = (JobWorker*)userData;
+
+		char name[64];
+		sprintf(name, "JobWorker%d", s32(worker - s_workers) + 1);
+		TFE_Profiler::setThreadName(name);
+
+		while (1)
+		{
+			worker->start->wait();
+			if (!s_runWorkers.load()) { break; }
+
+			processItems();
+			worker->done->fire();
+		}
+		TFE_Profiler::releaseThread();
+		return (TFE_THREADRET)0;
+	}
+
+	void init(s32 workerCount)
+	{
+		shutdown();
+		if (workerCount < 0)
+		{
+			workerCount = SDL_GetCPUCount() - 1;
+		}
+		workerCount = std::min(std::max(workerCount, 0), MAX_JOB_WORKERS);
+
+		s_runWorkers.store(true);
+		for (s32 i = 0; i < workerCount; i++)
+		{
+			JobWorker* worker = &s_workers[i];
+			worker->start = Signal::create();
+			worker->done  = Signal::create();
+
+			char name[64];
+			sprintf(name, "JobWorker%d", i + 1);
+			worker->thread = Thread::create(name, jobs_workerFunc, worker);
+			s_workerCount++;
+
+			if (!worker->thread || !worker->thread->run())
+			{
+				TFE_System::logWrite(LOG_ERROR, "Jobs", "Cannot start job worker thread %d.", i + 1);
+				shutdown();
+				return;
+			}
+		}
+		TFE_System::logWrite(LOG_MSG, "Jobs", "Job system started with %d worker threads.", s_workerCount);
+	}
+
+	void shutdown()
+	{
+		if (!s_workerCount) { return; }
+
+		s_runWorkers.store(false);
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			s_workers[i].start->fire();
+		}
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			JobWorker* worker = &s_workers[i];
+			if (worker->thread)
+			{
+				worker->thread->waitOnExit();
+				delete worker->thread;
+			}
+			delete worker->start;
+			delete worker->done;
+		}
+		memset(s_workers, 0, sizeof(s_workers));
+		s_workerCount = 0;
+	}
+
+	s32 getWorkerCount()
+	{
+		return s_workerCount;
+	}
+
+	void run(JobFunc func, void* userData, s32 count)
+	{
+		if (count <= 0) { return; }
+
+		// Only wake up as many workers as there are items beyond the first.
+		const s32 workerCount = std::min(s_workerCount, count - 1);
+		if (workerCount <= 0)
+		{
+			for (s32 i = 0; i < count; i++)
+			{
+				func(i, userData);
+			}
+			return;
+		}
+
+		s_func = func;
+		s_userData = userData;
+		s_count = count;
+		s_nextIndex.store(0);
+		for (s32 i = 0; i < workerCount; i++)
+		{
+			s_workers[i].start->fire();
+		}
+
+		processItems();
+
+		for (s32 i = 0; i < workerCount; i++)
+		{
+			s_workers[i].done->wait();
+		}
+		s_func = nullptr;
+		s_userData = nullptr;
+		s_count = 0;
+	}
+}
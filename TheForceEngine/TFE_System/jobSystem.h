@@ -0,0 +1,26 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Job System
+// A small pool of worker threads used to process independent items
+// in parallel, such as reading and decompressing assets during load.
+// The calling thread takes part in the work and run() only returns
+// once every item has been processed.
+//////////////////////////////////////////////////////////////////////
+#include "types.h"
+
+namespace TFE_Jobs
+{
+	#define MAX_JOB_WORKERS 15
+
+	// Called once per item, from any thread. Jobs must not touch
+	// memory regions, logging or other non-thread safe systems.
+	typedef void(*JobFunc)(s32 index, void* userData);
+
+	// workerCount < 0 = use the number of cores minus one.
+	void init(s32 workerCount = -1);
+	void shutdown();
+	s32  getWorkerCount();
+
+	// Call func(i, userData) for i in [0, count).
+	void run(JobFunc func, void* userData, s32 count);
+}
@@ -219,3 +219,72 @@ void TFE_Parser::tokenizeLine(const char* line, TokenList& tokens)
 		tokens.push_back(curToken);
 	}
 }
+
+// Same rules as the TokenList version, but the tokens are written into the fixed size list buffer.
+void TFE_Parser::tokenizeLine(const char* line, TokenViewList& tokens)
+{
+	tokens.count = 0;
+
+	const size_t len = strlen(line);
+	// first move past leading whitespace and ending white space.
+	size_t start = 0, end = 0;
+	for (size_t c = 0; c < len; c++)
+	{
+		if (!isWhitespace(line[c]))
+		{
+			if (start == 0 && end == 0) { start = c; }
+			end = c + 1;
+		}
+	}
+
+	// next start reading tokens, each token is copied into the list buffer with a null terminator.
+	char* buffer = tokens.buffer;
+	const u32 bufferEnd = TFE_MAX_LINE_TOKEN_CHARS - 1;
+	u32 tokenStart = 0;
+	u32 writePos = 0;
+	auto addToken = [&]()
+	{
+		buffer[writePos++] = 0;
+		if (tokens.count < TFE_MAX_LINE_TOKENS)
+		{
+			tokens.tokens[tokens.count++] = { buffer + tokenStart, writePos - tokenStart - 1 };
+		}
+		tokenStart = writePos;
+	};
+
+	bool inQuote = false;
+	// TODO: Add an option to allow white space in tokens when not in quotes, but still remove trailing/ending whitespace.
+	// This is useful for names.
+	for (size_t c = start; c < end && writePos < bufferEnd; c++)
+	{
+		if (line[c] == '"')
+		{
+			if (inQuote && writePos == tokenStart)
+			{
+				addToken();
+			}
+			inQuote = !inQuote;
+		}
+		else if (!inQuote && (isWhitespace(line[c]) || isSeparator(line[c])))
+		{
+			if (writePos > tokenStart)
+			{
+				addToken();
+			}
+		}
+		else if (!inQuote && m_enableColorSeperator && line[c] == ':')
+		{
+			buffer[writePos++] = line[c];
+			addToken();
+		}
+		else
+		{
+			buffer[writePos++] = line[c];
+		}
+	}
+
+	if (writePos > tokenStart)
+	{
+		addToken();
+	}
+}
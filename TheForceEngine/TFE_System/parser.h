@@ -7,9 +7,43 @@
 #include "types.h"
 #include <vector>
 #include <string>
+#include <cstring>
 
 typedef std::vector<std::string> TokenList;
 
+#define TFE_MAX_LINE_TOKENS 128
+#define TFE_MAX_LINE_TOKEN_CHARS 4096
+
+// A token in a TokenViewList, null terminated.
+struct TokenView
+{
+	const char* str;
+	u32 len;
+
+	const char* c_str() const { return str; }
+	size_t length() const { return len; }
+};
+
+// Fixed capacity token list that never allocates.
+// Tokens are views into a copy of the line held by the list, so they stay valid until the next tokenizeLine() call.
+struct TokenViewList
+{
+	TokenView tokens[TFE_MAX_LINE_TOKENS];
+	char buffer[TFE_MAX_LINE_TOKEN_CHARS];
+	u32 count = 0;
+
+	size_t size() const { return count; }
+	const TokenView& operator[](size_t index) const { return tokens[index]; }
+
+	// Remove the first 'removeCount' tokens, the remaining tokens stay valid.
+	void popFront(u32 removeCount)
+	{
+		removeCount = removeCount < count ? removeCount : count;
+		memmove(tokens, tokens + removeCount, sizeof(TokenView) * (count - removeCount));
+		count -= removeCount;
+	}
+};
+
 class TFE_Parser
 {
 public:
@@ -35,6 +69,9 @@ public:
 	// Split a line into tokens using space, comma or equals as separators.
 	// Note strings with spaces still work, they need to be closed in quotes, which are removed upon tokenizing.
 	void tokenizeLine(const char* line, TokenList& tokens);
+	// Same as above but without allocating, tokens past TFE_MAX_LINE_TOKENS and characters past
+	// TFE_MAX_LINE_TOKEN_CHARS are dropped. Use the TokenList version when lines may be longer.
+	void tokenizeLine(const char* line, TokenViewList& tokens);
 
 private:
 	const char* m_buffer;
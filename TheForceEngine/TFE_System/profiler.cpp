@@ -1,36 +1,108 @@
 #include <cstring>
+#include <cstdio>
 
 #include "profiler.h"
+#include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/paths.h>
 #include <assert.h>
 #include <algorithm>
 #include <vector>
 #include <string>
 #include <map>
 
-// TODO: Support call "paths" - with seperate time per path.
-
 namespace TFE_Profiler
 {
 	#define ZONE_BUFFER_COUNT 2
 	#define MAX_ZONE_STACK 256
-	
+	#define MAX_ZONES 1024
+	#define MAX_PROFILE_THREADS 32
+	#define THREAD_EVENT_COUNT 65536	// must be a power of two.
+	#define ZONE_ACTIVE_FRAMES 60		// keep listing a call path for this many frames after it was last entered.
+
+	enum ZoneEventType : u32
+	{
+		ZEVENT_BEGIN = 0,
+		ZEVENT_END,
+	};
+
+	enum ThreadSlotState : u32
+	{
+		SLOT_FREE = 0,
+		SLOT_ACTIVE,
+		SLOT_RELEASED,	// the owning thread is done, free once drained.
+	};
+
+	// A zone is a single TFE_ZONE call site.
 	struct Zone
 	{
-		u32  id;
-		u32  level = 0;
-		u32  parent = NULL_ZONE;
-		u64  path;
-		u64  frame;
 		char name[64];
 		char func[64];
 		u32  lineNumber;
 
-		f64  timeInZone[ZONE_BUFFER_COUNT];
-		f64  timeInZoneAve;
-		f64  fractOfParentAve;
+		u64  frame;
+		f64  timeTotal;
+		u32  frameCount;
+	};
 
+	// A call path is a zone reached through a specific chain of parent zones on a specific thread.
+	struct PathNode
+	{
+		u32  zoneId;
+		u32  parent;
+		u32  root;
+		u32  level;
 		u32  child = NULL_ZONE;
 		u32  sibling = NULL_ZONE;
+		u64  frame = 0;
+
+		f64  timeInZone[ZONE_BUFFER_COUNT] = { 0 };
+		f64  timeInZoneAve = 0.0;
+		f64  fractOfParentAve = 0.0;
+	};
+
+	struct ThreadRoot
+	{
+		char name[32];
+		u32  node;
+	};
+
+	struct ZoneEvent
+	{
+		u32 zoneId;
+		u32 type;
+		u64 time;
+	};
+
+	struct StackEntry
+	{
+		u32  node;
+		u32  zoneId;
+		u64  time;
+		bool traced;
+	};
+
+	// Events are written by the owning thread (producer) and read by the main thread in frameEnd() (consumer).
+	struct ThreadEvents
+	{
+		atomic_u32 state;
+		std::atomic<u64> head;
+		std::atomic<u64> tail;
+		atomic_u32 dropped;
+		char name[32];
+		ZoneEvent* events;
+
+		// Consumer state.
+		u32 root = NULL_ZONE;
+		u32 stackDepth;
+		StackEntry stack[MAX_ZONE_STACK];
+	};
+
+	struct TraceEvent
+	{
+		u32 zoneId;
+		u16 thread;
+		u16 type;
+		u64 time;
 	};
 
 	struct Counter
@@ -42,123 +114,175 @@ namespace TFE_Profiler
 		char name[64];
 	};
 
-	typedef std::map<std::string, u32> ZoneMap;
-	typedef std::vector<Zone> ZoneList;
+	typedef std::map<std::string, u32> CounterMap;
+	typedef std::vector<PathNode> PathList;
 	typedef std::vector<u32> SortedZoneList;
 	typedef std::vector<Counter> CounterList;
 
-	static ZoneMap  s_zoneMap;
-	static ZoneList s_zoneList;
+	static Zone s_zones[MAX_ZONES];
+	static atomic_u32 s_zoneCount(0);
+	static atomic_bool s_registerLock(false);
+
+	static ThreadEvents s_threads[MAX_PROFILE_THREADS];
+	static atomic_u32 s_threadCount(0);
+	static atomic_u32 s_threadIndex(0);
+	static thread_local ThreadEvents* s_threadEvents = nullptr;
+	static thread_local bool s_threadZonesEnabled = true;
+	static thread_local bool s_threadRegistered = false;
+
+	static PathList s_pathList;
+	static std::vector<ThreadRoot> s_threadRoots;
 	static SortedZoneList s_sortedZoneList;
-	static SortedZoneList s_roots;
+	static std::vector<u32> s_sortedIndex;
 
-	static ZoneMap  s_counterMap;
+	static CounterMap  s_counterMap;
 	static CounterList s_counterList;
 
 	static u64 s_frameBegin;
 	static f64 s_frameTime;
 	static u32 s_readBuffer = 0;
 	static u32 s_writeBuffer = 1;
-	static u32 s_level;
-	static u32 s_maxLevel;
-	static u32 s_zoneStack[MAX_ZONE_STACK];
 	static u64 s_currentFrame = 1;
-	static u64 s_currentPath;
 
-	void addZoneChild(u32 parentId, u32 zoneId)
+	static std::vector<TraceEvent> s_traceEvents;
+	static s32 s_traceFrames = 0;
+	static bool s_traceActive = false;
+	static char s_tracePath[TFE_MAX_PATH];
+
+	void writeTrace();
+
+	/////////////////////////////////////////////
+	// Producer side, called from any thread.
+	/////////////////////////////////////////////
+	void lockRegistration()
 	{
-		Zone& parent = s_zoneList[parentId];
-		Zone& zone = s_zoneList[zoneId];
-		// This has already been added.
-		if (zone.sibling != NULL_ZONE)
-		{
-			return;
-		}
+		while (s_registerLock.exchange(true, std::memory_order_acquire)) {}
+	}
+
+	void unlockRegistration()
+	{
+		s_registerLock.store(false, std::memory_order_release);
+	}
 
-		if (parent.child == zoneId)
+	u32 registerZone(const char* name, const char* func, u32 lineNumber)
+	{
+		lockRegistration();
+		const u32 id = s_zoneCount.load();
+		if (id >= MAX_ZONES)
 		{
-			return;
+			unlockRegistration();
+			return NULL_ZONE;
 		}
-		else if (parent.child == NULL_ZONE)
+
+		Zone* zone = &s_zones[id];
+		strncpy(zone->name, name, 63);
+		strncpy(zone->func, func, 63);
+		zone->name[63] = 0;
+		zone->func[63] = 0;
+		zone->lineNumber = lineNumber;
+		zone->frame = 0;
+		zone->timeTotal = 0.0;
+		zone->frameCount = 0;
+		s_zoneCount.store(id + 1, std::memory_order_release);
+		unlockRegistration();
+
+		return id;
+	}
+
+	ThreadEvents* registerThread(const char* name)
+	{
+		ThreadEvents* thread = nullptr;
+		lockRegistration();
+		for (u32 i = 0; i < MAX_PROFILE_THREADS; i++)
 		{
-			parent.child = zoneId;
+			if (s_threads[i].state.load(std::memory_order_acquire) == SLOT_FREE)
+			{
+				thread = &s_threads[i];
+				break;
+			}
 		}
-		else
+		if (thread)
 		{
-			Zone* child = &s_zoneList[parent.child];
-			while (1)
+			if (!thread->events)
+			{
+				thread->events = new ZoneEvent[THREAD_EVENT_COUNT];
+			}
+			if (name)
+			{
+				strncpy(thread->name, name, 31);
+				thread->name[31] = 0;
+			}
+			else
 			{
-				if (child->sibling == zoneId)
-				{
-					return;
-				}
-				else if (child->sibling == NULL_ZONE)
-				{
-					child->sibling = zoneId;
-					break;
-				}
-				child = &s_zoneList[child->sibling];
-			};
+				sprintf(thread->name, "Thread %u", s_threadIndex.load() + 1);
+			}
+			s_threadIndex++;
+			thread->head.store(0);
+			thread->tail.store(0);
+			thread->dropped.store(0);
+			thread->state.store(SLOT_ACTIVE, std::memory_order_release);
+			s_threadCount = std::max(s_threadCount.load(), u32(thread - s_threads) + 1);
 		}
+		unlockRegistration();
+		return thread;
 	}
 
-	u32 beginZone(const char* name, const char* func, u32 lineNumber)
+	void setThreadName(const char* name)
 	{
-		ZoneMap::iterator iZone = s_zoneMap.find(name);
-		u32 id = 0;
+		if (s_threadRegistered) { return; }
+		s_threadEvents = registerThread(name);
+		s_threadRegistered = true;
+	}
 
-		if (iZone == s_zoneMap.end())
-		{
-			id = (u32)s_zoneList.size();
-
-			Zone zone;
-			zone.id = id;
-			zone.path = s_currentPath;
-			zone.timeInZone[s_readBuffer]  = 0;
-			zone.timeInZone[s_writeBuffer] = 0;
-			zone.timeInZoneAve = 0.0;
-			zone.fractOfParentAve = 0.0;
-			zone.frame = 0;
-			
-			s_zoneList.push_back(zone);
-			s_zoneMap[name] = id;
-		}
-		else
+	void releaseThread()
+	{
+		if (s_threadEvents)
 		{
-			id = iZone->second;
+			s_threadEvents->state.store(SLOT_RELEASED, std::memory_order_release);
 		}
+		s_threadEvents = nullptr;
+		s_threadRegistered = false;
+	}
 
-		Zone& zone = s_zoneList[id];
-		strcpy(zone.name, name);
-		strcpy(zone.func, func);
-		zone.lineNumber = lineNumber;
-		zone.level = s_level;
+	void setThreadZonesEnabled(bool enable)
+	{
+		s_threadZonesEnabled = enable;
+	}
 
-		zone.parent = s_level > 0 ? s_zoneStack[s_level - 1] : NULL_ZONE;
-		if (zone.parent == NULL_ZONE)
-		{
-			s_roots.push_back(id);
-		}
-		else
+	void pushEvent(u32 id, u32 type)
+	{
+		if (id == NULL_ZONE || !s_threadZonesEnabled) { return; }
+		if (!s_threadRegistered) { setThreadName(nullptr); }
+
+		ThreadEvents* thread = s_threadEvents;
+		if (!thread) { return; }
+
+		const u64 head = thread->head.load(std::memory_order_relaxed);
+		if (head - thread->tail.load(std::memory_order_acquire) >= THREAD_EVENT_COUNT)
 		{
-			addZoneChild(zone.parent, zone.id);
+			thread->dropped++;
+			return;
 		}
+		ZoneEvent* evt = &thread->events[head & (THREAD_EVENT_COUNT - 1)];
+		evt->zoneId = id;
+		evt->type = type;
+		evt->time = TFE_System::getCurrentTimeInTicks();
+		thread->head.store(head + 1, std::memory_order_release);
+	}
 
-		s_zoneStack[s_level] = id;
-		s_level++;
-
-		return id;
+	void beginZone(u32 id)
+	{
+		pushEvent(id, ZEVENT_BEGIN);
 	}
 
-	void endZone(u32 id, u64 dt)
+	void endZone(u32 id)
 	{
-		s_zoneList[id].timeInZone[s_writeBuffer] += TFE_System::convertFromTicksToSeconds(dt);
-		s_level--;
+		pushEvent(id, ZEVENT_END);
 	}
 
 	void addCounter(const char* name, s32* counter)
 	{
-		ZoneMap::iterator iCounter = s_counterMap.find(name);
+		CounterMap::iterator iCounter = s_counterMap.find(name);
 		if (iCounter == s_counterMap.end())
 		{
 			const u32 id = (u32)s_counterList.size();
@@ -174,95 +298,311 @@ namespace TFE_Profiler
 		}
 	}
 
-	void frameBegin()
+	/////////////////////////////////////////////
+	// Consumer side, main thread only.
+	/////////////////////////////////////////////
+	u32 allocNode(u32 zoneId, u32 parent, u32 root, u32 level)
 	{
-		std::swap(s_readBuffer, s_writeBuffer);
-		s_level = 0;
-		s_maxLevel = 0;
-		s_roots.clear();
+		const u32 id = (u32)s_pathList.size();
+		PathNode node;
+		node.zoneId = zoneId;
+		node.parent = parent;
+		node.root = root;
+		node.level = level;
+		s_pathList.push_back(node);
+		return id;
+	}
 
-		// Swap buffers, s_readBuffer is safe to read in the middle of the next frame.
-		const size_t zoneCount = s_zoneList.size();
-		for (size_t i = 0; i < zoneCount; i++)
+	// Threads that are recreated with the same name (such as worker threads) share a root.
+	u32 getThreadRoot(const char* name)
+	{
+		const size_t count = s_threadRoots.size();
+		for (size_t i = 0; i < count; i++)
 		{
-			s_zoneList[i].timeInZone[s_writeBuffer] = 0;
+			if (strcmp(s_threadRoots[i].name, name) == 0)
+			{
+				return s_threadRoots[i].node;
+			}
 		}
 
-		// Copy counter values from the frame, so that the results can be used
-	    // in the middle of the next frame.
-		const size_t counterCount = s_counterList.size();
-		for (size_t i = 0; i < counterCount; i++)
+		ThreadRoot root;
+		strcpy(root.name, name);
+		root.node = allocNode(NULL_ZONE, NULL_ZONE, (u32)count, 0);
+		s_threadRoots.push_back(root);
+		return root.node;
+	}
+
+	u32 getChildNode(u32 parentId, u32 zoneId)
+	{
+		u32 prev = NULL_ZONE;
+		for (u32 child = s_pathList[parentId].child; child != NULL_ZONE; child = s_pathList[child].sibling)
 		{
-			s_counterList[i].prevValue = *s_counterList[i].ptr;
+			if (s_pathList[child].zoneId == zoneId) { return child; }
+			prev = child;
 		}
 
-		s_frameBegin = TFE_System::getCurrentTimeInTicks();
+		const PathNode& parent = s_pathList[parentId];
+		const u32 level = parent.zoneId == NULL_ZONE ? 0 : parent.level + 1;
+		const u32 id = allocNode(zoneId, parentId, parent.root, level);
+		if (prev == NULL_ZONE)
+		{
+			s_pathList[parentId].child = id;
+		}
+		else
+		{
+			s_pathList[prev].sibling = id;
+		}
+		return id;
+	}
+
+	void addTraceEvent(ThreadEvents* thread, u32 zoneId, u32 type, u64 time)
+	{
+		TraceEvent evt;
+		evt.zoneId = zoneId;
+		evt.thread = u16(thread - s_threads);
+		evt.type = u16(type);
+		evt.time = time;
+		s_traceEvents.push_back(evt);
+	}
+
+	void processEvent(ThreadEvents* thread, const ZoneEvent* evt)
+	{
+		if (evt->type == ZEVENT_BEGIN)
+		{
+			if (thread->stackDepth >= MAX_ZONE_STACK) { return; }
+
+			const u32 parent = thread->stackDepth ? thread->stack[thread->stackDepth - 1].node : thread->root;
+			StackEntry* entry = &thread->stack[thread->stackDepth++];
+			entry->node = getChildNode(parent, evt->zoneId);
+			entry->zoneId = evt->zoneId;
+			entry->time = evt->time;
+			entry->traced = s_traceActive;
+			if (entry->traced) { addTraceEvent(thread, evt->zoneId, ZEVENT_BEGIN, evt->time); }
+			return;
+		}
+
+		// Find the matching begin, events may be missing if the ring buffer overflowed.
+		s32 index = s32(thread->stackDepth) - 1;
+		for (; index >= 0 && thread->stack[index].zoneId != evt->zoneId; index--);
+		if (index < 0) { return; }
+
+		while (s32(thread->stackDepth) > index)
+		{
+			StackEntry* entry = &thread->stack[--thread->stackDepth];
+			const f64 dt = TFE_System::convertFromTicksToSeconds(evt->time - entry->time);
+
+			PathNode* node = &s_pathList[entry->node];
+			node->timeInZone[s_writeBuffer] += dt;
+			node->frame = s_currentFrame;
+
+			Zone* zone = &s_zones[entry->zoneId];
+			zone->timeTotal += dt;
+			if (zone->frame != s_currentFrame)
+			{
+				zone->frame = s_currentFrame;
+				zone->frameCount++;
+			}
+			if (entry->traced) { addTraceEvent(thread, entry->zoneId, ZEVENT_END, evt->time); }
+		}
+	}
+
+	void drainThread(ThreadEvents* thread)
+	{
+		const u32 state = thread->state.load(std::memory_order_acquire);
+		if (state == SLOT_FREE) { return; }
+		if (thread->root == NULL_ZONE)
+		{
+			thread->root = getThreadRoot(thread->name);
+			thread->stackDepth = 0;
+		}
+
+		const u64 head = thread->head.load(std::memory_order_acquire);
+		for (u64 e = thread->tail.load(std::memory_order_relaxed); e < head; e++)
+		{
+			processEvent(thread, &thread->events[e & (THREAD_EVENT_COUNT - 1)]);
+		}
+		thread->tail.store(head, std::memory_order_release);
+
+		const u32 dropped = thread->dropped.exchange(0);
+		if (dropped)
+		{
+			TFE_System::logWrite(LOG_WARNING, "Profiler", "Thread '%s' dropped %u zone events, its event buffer is full.", thread->name, dropped);
+		}
+
+		// The owning thread has exited and every event has been processed, so the slot can be reused.
+		if (state == SLOT_RELEASED)
+		{
+			thread->root = NULL_ZONE;
+			thread->stackDepth = 0;
+			thread->state.store(SLOT_FREE, std::memory_order_release);
+		}
 	}
 
 	void traverseZoneTree(u32 id)
 	{
-		if (id == NULL_ZONE) { return; }
-		Zone* zone = &s_zoneList[id];
-		// Make sure zones are only inserted once for now.
-		if (zone->frame != s_currentFrame)
+		for (u32 child = s_pathList[id].child; child != NULL_ZONE; child = s_pathList[child].sibling)
 		{
-			s_sortedZoneList.push_back(id);
+			const PathNode* node = &s_pathList[child];
+			if (node->frame + ZONE_ACTIVE_FRAMES < s_currentFrame) { continue; }
+
+			s_sortedIndex[child] = (u32)s_sortedZoneList.size();
+			s_sortedZoneList.push_back(child);
+			traverseZoneTree(child);
 		}
-		zone->frame = s_currentFrame;
-		
-		while (zone->child != NULL_ZONE)
+	}
+
+	void frameBegin()
+	{
+		std::swap(s_readBuffer, s_writeBuffer);
+
+		// Swap buffers, s_readBuffer is safe to read in the middle of the next frame.
+		const size_t nodeCount = s_pathList.size();
+		for (size_t i = 0; i < nodeCount; i++)
 		{
-			traverseZoneTree(zone->child);
-			zone = &s_zoneList[zone->child];
+			s_pathList[i].timeInZone[s_writeBuffer] = 0;
 		}
 
-		zone = &s_zoneList[id];
-		while (zone->sibling != NULL_ZONE)
+		// Copy counter values from the frame, so that the results can be used
+	    // in the middle of the next frame.
+		const size_t counterCount = s_counterList.size();
+		for (size_t i = 0; i < counterCount; i++)
 		{
-			traverseZoneTree(zone->sibling);
-			zone = &s_zoneList[zone->sibling];
+			s_counterList[i].prevValue = *s_counterList[i].ptr;
 		}
+
+		s_frameBegin = TFE_System::getCurrentTimeInTicks();
 	}
 
 	void frameEnd()
 	{
 		s_frameTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - s_frameBegin);
-		const size_t zoneCount = s_zoneList.size();
 		const f64 expBlend = 0.99;
 
-		// Sort Zones
+		// Gather the events from every thread.
+		const u32 threadCount = s_threadCount.load();
+		for (u32 t = 0; t < threadCount; t++)
+		{
+			drainThread(&s_threads[t]);
+		}
+
+		// Sort call paths, depth first per thread.
+		const size_t nodeCount = s_pathList.size();
 		s_sortedZoneList.clear();
-		const size_t rootCount = s_roots.size();
+		s_sortedIndex.resize(nodeCount);
+		const size_t rootCount = s_threadRoots.size();
 		for (size_t r = 0; r < rootCount; r++)
 		{
-			traverseZoneTree(s_roots[r]);
+			traverseZoneTree(s_threadRoots[r].node);
 		}
 
-		// First compute delta times for each zone.
-		for (size_t i = 0; i < zoneCount; i++)
+		for (size_t i = 0; i < nodeCount; i++)
 		{
-			s_zoneList[i].timeInZoneAve = expBlend * s_zoneList[i].timeInZoneAve + (1.0 - expBlend)*s_zoneList[i].timeInZone[s_writeBuffer];
+			PathNode* node = &s_pathList[i];
+			if (node->zoneId == NULL_ZONE) { continue; }
+
+			const f64 time = node->timeInZone[s_writeBuffer];
+			const PathNode* parent = &s_pathList[node->parent];
+			const f64 parentTime = (parent->zoneId != NULL_ZONE) ? parent->timeInZone[s_writeBuffer] : s_frameTime;
+
+			node->timeInZoneAve = expBlend * node->timeInZoneAve + (1.0 - expBlend)*time;
+			// Avoid NAN when the parent took no measurable time, once that happens the average never fixes itself.
+			node->fractOfParentAve = expBlend * node->fractOfParentAve + (1.0 - expBlend)*(parentTime > 0.0 ? time / parentTime : 0.0);
 		}
 
-		// Then handle percentage of parent and clear
-		for (size_t i = 0; i < zoneCount; i++)
+		if (s_traceActive)
 		{
-			f64 parentTime = (s_zoneList[i].parent != NULL_ZONE) ? s_zoneList[s_zoneList[i].parent].timeInZone[s_writeBuffer] : s_frameTime;
-			s_zoneList[i].fractOfParentAve = expBlend * s_zoneList[i].fractOfParentAve + (1.0 - expBlend)*s_zoneList[i].timeInZone[s_writeBuffer] / parentTime;
-			// Handle the rare case the parentTime = 0 causing s_zoneList[i].fractOfParentAve to become NAN. Once that happens it will never fix itself
-			// because we are doing an average. So fix it manually.
-			if (isnan(s_zoneList[i].fractOfParentAve))
+			s_traceFrames--;
+			if (s_traceFrames <= 0)
 			{
-				s_zoneList[i].fractOfParentAve = 0.0;
+				writeTrace();
 			}
-
-			s_zoneList[i].child = NULL_ZONE;
-			s_zoneList[i].sibling = NULL_ZONE;
 		}
 
 		s_currentFrame++;
 	}
 
+	/////////////////////////////////////////////
+	// Chrome trace export
+	/////////////////////////////////////////////
+	bool beginTrace(s32 frameCount, const char* filePath)
+	{
+		if (s_traceActive || frameCount <= 0 || !filePath || !filePath[0]) { return false; }
+
+		strncpy(s_tracePath, filePath, TFE_MAX_PATH - 1);
+		s_tracePath[TFE_MAX_PATH - 1] = 0;
+		s_traceFrames = frameCount;
+		s_traceActive = true;
+		s_traceEvents.clear();
+		return true;
+	}
+
+	bool isTraceActive()
+	{
+		return s_traceActive;
+	}
+
+	void writeJsonString(std::string& out, const char* str)
+	{
+		out += '"';
+		for (; *str; str++)
+		{
+			if (*str == '"' || *str == '\\') { out += '\\'; }
+			out += *str;
+		}
+		out += '"';
+	}
+
+	void writeTrace()
+	{
+		s_traceActive = false;
+
+		std::string out;
+		char line[256];
+		out.reserve(s_traceEvents.size() * 80 + 1024);
+		out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+		// Name each thread.
+		const u32 threadCount = s_threadCount.load();
+		for (u32 t = 0; t < threadCount; t++)
+		{
+			if (s_threads[t].state.load() == SLOT_FREE) { continue; }
+			sprintf(line, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", t);
+			out += line;
+			writeJsonString(out, s_threads[t].name);
+			out += "}},\n";
+		}
+
+		const size_t count = s_traceEvents.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			const TraceEvent* evt = &s_traceEvents[i];
+			const Zone* zone = &s_zones[evt->zoneId];
+			out += "{\"name\":";
+			writeJsonString(out, zone->name);
+			sprintf(line, ",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%0.3f,\"pid\":1,\"tid\":%u}", zone->func, evt->type == ZEVENT_BEGIN ? 'B' : 'E',
+				TFE_System::convertFromTicksToSeconds(evt->time) * 1000000.0, evt->thread);
+			out += line;
+			out += (i + 1 < count) ? ",\n" : "\n";
+		}
+		out += "]}\n";
+
+		FileStream file;
+		if (file.open(s_tracePath, FileStream::MODE_WRITE))
+		{
+			file.writeBuffer(out.c_str(), (u32)out.length());
+			file.close();
+			TFE_System::logWrite(LOG_MSG, "Profiler", "Wrote %u trace events to '%s'.", (u32)count, s_tracePath);
+		}
+		else
+		{
+			TFE_System::logWrite(LOG_ERROR, "Profiler", "Cannot write trace file '%s'.", s_tracePath);
+		}
+		s_traceEvents.clear();
+	}
+
+	/////////////////////////////////////////////
+	// Profile data
+	/////////////////////////////////////////////
 	u32 getZoneCount()
 	{
 		return (u32)s_sortedZoneList.size();
@@ -272,15 +612,43 @@ namespace TFE_Profiler
 	{
 		if (index >= (u32)s_sortedZoneList.size()) { return; }
 
-		Zone& zone = s_zoneList[s_sortedZoneList[index]];
+		PathNode& node = s_pathList[s_sortedZoneList[index]];
+		Zone& zone = s_zones[node.zoneId];
 		info->name = zone.name;
 		info->func = zone.func;
-		info->level = zone.level;
+		info->thread = s_threadRoots[node.root].name;
+		info->level = node.level;
 		info->lineNumber = zone.lineNumber;
-		info->timeInZone = zone.timeInZone[s_readBuffer];
-		info->timeInZoneAve = zone.timeInZoneAve;
-		info->fractOfParentAve = zone.fractOfParentAve;
-		info->parentId = zone.parent;
+		info->timeInZone = node.timeInZone[s_readBuffer];
+		info->timeInZoneAve = node.timeInZoneAve;
+		info->fractOfParentAve = node.fractOfParentAve;
+		info->parentId = (s_pathList[node.parent].zoneId != NULL_ZONE) ? s_sortedIndex[node.parent] : NULL_ZONE;
+	}
+
+	void resetZoneTotals()
+	{
+		const u32 zoneCount = s_zoneCount.load();
+		for (u32 i = 0; i < zoneCount; i++)
+		{
+			s_zones[i].timeTotal = 0.0;
+			s_zones[i].frameCount = 0;
+		}
+	}
+
+	u32 getZoneTotalCount()
+	{
+		return s_zoneCount.load(std::memory_order_acquire);
+	}
+
+	void getZoneTotal(u32 index, TFE_ZoneTotal* total)
+	{
+		if (index >= getZoneTotalCount()) { return; }
+
+		Zone& zone = s_zones[index];
+		total->name = zone.name;
+		total->func = zone.func;
+		total->timeTotal = zone.timeTotal;
+		total->frameCount = zone.frameCount;
 	}
 
 	f64 getTimeInFrame()
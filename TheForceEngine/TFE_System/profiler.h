@@ -3,7 +3,10 @@
 // The Force Engine Profiler
 // Simple "zone" based profiler.
 // Add TFE_PROFILE_ENABLED to preprocessor defines in the build to enable.
-// Currently does not respect the call path, that is TODO.
+// Each TFE_ZONE call site registers a zone ID once, after that entering
+// and leaving a zone only writes begin/end events into a lock-free ring
+// buffer owned by the current thread. The main thread drains the rings
+// at the end of each frame and accumulates time per call path.
 //////////////////////////////////////////////////////////////////////
 
 #include "types.h"
@@ -14,8 +17,10 @@
 #define TOKENPASTE(x, y) x ## y
 #define TOKENPASTE2(x, y) TOKENPASTE(x, y)
 #ifdef  TFE_PROFILE_ENABLED
-#define TFE_ZONE(name)  TFE_Profiler_Zone TOKENPASTE2(__localZone, __LINE__)(name, __FUNCTION__, __LINE__)
-#define TFE_ZONE_BEGIN(varName, name)  TFE_Profiler_ZoneManual varName(name, __FUNCTION__, __LINE__)
+#define TFE_ZONE(name)  static const u32 TOKENPASTE2(__zoneId, __LINE__) = TFE_Profiler::registerZone(name, __FUNCTION__, __LINE__); \
+                        TFE_Profiler_Zone TOKENPASTE2(__localZone, __LINE__)(TOKENPASTE2(__zoneId, __LINE__))
+#define TFE_ZONE_BEGIN(varName, name)  static const u32 TOKENPASTE2(varName, _zoneId) = TFE_Profiler::registerZone(name, __FUNCTION__, __LINE__); \
+                                       TFE_Profiler_ZoneManual varName(TOKENPASTE2(varName, _zoneId))
 #define TFE_ZONE_END(varName)  varName.end()
 #define TFE_FRAME_BEGIN() TFE_Profiler::frameBegin()
 #define TFE_FRAME_END() TFE_Profiler::frameEnd()
@@ -32,18 +37,29 @@
 #define NULL_ZONE 0xffffffff
 
 #ifdef TFE_PROFILE_ENABLED
+// One entry per call path, in depth-first order per thread.
 struct TFE_ZoneInfo
 {
 	char* name;
 	char* func;
+	char* thread;
 	u32  lineNumber;
 	u32  level;
-	u32  parentId;
+	u32  parentId;	// index of the parent entry or NULL_ZONE.
 	f64  timeInZone;
 	f64  timeInZoneAve;
 	f64  fractOfParentAve;
 };
 
+// Time accumulated in a zone since the last call to resetZoneTotals().
+struct TFE_ZoneTotal
+{
+	char* name;
+	char* func;
+	f64  timeTotal;
+	u32  frameCount;	// number of frames the zone was entered.
+};
+
 struct TFE_CounterInfo
 {
 	char* name;
@@ -53,19 +69,36 @@ struct TFE_CounterInfo
 namespace TFE_Profiler
 {
 	// The main profiling API is used through Macros which can be disabled based on build flags.
-	u32  beginZone(const char* name, const char* func, u32 lineNumber);
-	void endZone(u32 id, u64 dt);
+	u32  registerZone(const char* name, const char* func, u32 lineNumber);
+	void beginZone(u32 id);
+	void endZone(u32 id);
 		
 	void frameBegin();
 	void frameEnd();
 
 	void addCounter(const char* name, s32* counter);
+	// Zones can be recorded from any thread. Threads should name themselves before
+	// entering zones (otherwise they show up as "Thread N") and release their event
+	// buffer before exiting.
+	void setThreadName(const char* name);
+	void releaseThread();
+	void setThreadZonesEnabled(bool enable);
+
+	// Record every zone event for the next 'frameCount' frames and then write them
+	// to 'filePath' in the Chrome trace event format (chrome://tracing, Perfetto).
+	bool beginTrace(s32 frameCount, const char* filePath);
+	bool isTraceActive();
 
 	// Profile data API, this is used directly.
 	f64  getTimeInFrame();
 
 	u32  getZoneCount();
 	void getZoneInfo(u32 index, TFE_ZoneInfo* info);
+
+	// Zone totals cover every zone ever entered, not just the current frame.
+	void resetZoneTotals();
+	u32  getZoneTotalCount();
+	void getZoneTotal(u32 index, TFE_ZoneTotal* total);
 	
 	u32  getCounterCount();
 	void getCounterInfo(u32 index, TFE_CounterInfo* info);
@@ -74,38 +107,32 @@ namespace TFE_Profiler
 class TFE_Profiler_Zone
 {
 public:
-	TFE_Profiler_Zone(const char* name, const char* func, u32 lineNumber)
+	TFE_Profiler_Zone(u32 id) : m_id(id)
 	{
-		m_time = TFE_System::getCurrentTimeInTicks();
-		m_id = TFE_Profiler::beginZone(name, func, lineNumber);
+		TFE_Profiler::beginZone(m_id);
 	}
 
 	~TFE_Profiler_Zone()
 	{
-		const u64 deltaTime = TFE_System::getCurrentTimeInTicks() - m_time;
-		TFE_Profiler::endZone(m_id, deltaTime);
+		TFE_Profiler::endZone(m_id);
 	}
 private:
-	u64 m_time;
-	s32 m_id;
+	u32 m_id;
 };
 
 class TFE_Profiler_ZoneManual
 {
 public:
-	TFE_Profiler_ZoneManual(const char* name, const char* func, u32 lineNumber)
+	TFE_Profiler_ZoneManual(u32 id) : m_id(id)
 	{
-		m_time = TFE_System::getCurrentTimeInTicks();
-		m_id = TFE_Profiler::beginZone(name, func, lineNumber);
+		TFE_Profiler::beginZone(m_id);
 	}
 
 	void end()
 	{
-		const u64 deltaTime = TFE_System::getCurrentTimeInTicks() - m_time;
-		TFE_Profiler::endZone(m_id, deltaTime);
+		TFE_Profiler::endZone(m_id);
 	}
 private:
-	u64 m_time;
-	s32 m_id;
+	u32 m_id;
 };
 #endif
@@ -38,6 +38,7 @@ namespace TFE_System
 	static bool s_systemUiRequestPosted = false;
 
 	static s32 s_missedFrameCount = 0;
+	static f64 s_fixedTimeStep = 0.0;
 
 	static char s_versionString[64];
 
@@ -97,8 +98,27 @@ namespace TFE_System
 		return dt;
 	}
 
+	// Used for deterministic runs (such as benchmarks), time advances by exactly 'dt' every frame
+	// regardless of how long the frame actually took. Set to 0 to go back to real time.
+	void setFixedTimeStep(f64 dt)
+	{
+		s_fixedTimeStep = dt > 0.0 ? dt : 0.0;
+	}
+
 	void update()
 	{
+		if (s_fixedTimeStep > 0.0)
+		{
+			s_time += u64(s_fixedTimeStep / s_freq + 0.5);
+			if (s_resetStartTime)
+			{
+				s_startTime = s_time;
+				s_resetStartTime = false;
+			}
+			s_dt = s_fixedTimeStep;
+			return;
+		}
+
 		// This assumes that SDL_GetPerformanceCounter() is monotonic.
 		// However if errors do occur, the dt clamp later should limit the side effects.
 		const u64 curTime = SDL_GetPerformanceCounter();
@@ -28,6 +28,8 @@ namespace TFE_System
 	bool getVSync();
 
 	void update();
+	// Advance time by a fixed amount every update instead of the real elapsed time (0 = real time).
+	void setFixedTimeStep(f64 dt);
 	f64 updateThreadLocal(u64* localTime);
 
 	// Timing
@@ -16,8 +16,12 @@
 #include <TFE_Input/inputMapping.h>
 #include <TFE_Settings/settings.h>
 #include <TFE_System/system.h>
+#include <TFE_System/benchmark.h>
+#include <TFE_System/frameLatency.h>
+#include <TFE_System/jobSystem.h>
 #include <TFE_System/CrashHandler/crashHandler.h>
 #include <TFE_Jedi/Task/task.h>
+#include <TFE_Jedi/Renderer/virtualFramebuffer.h>
 #include <TFE_Asset/paletteAsset.h>
 #include <TFE_Asset/imageAsset.h>
 #include <TFE_Ui/ui.h>
@@ -66,6 +70,25 @@ static IGame* s_curGame = nullptr;
 
 void parseOption(const char* name, const std::vector<const char*>& values, bool longName);
 
+bool isInputEvent(const SDL_Event& Event)
+{
+	switch (Event.type)
+	{
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+		case SDL_TEXTINPUT:
+		case SDL_MOUSEMOTION:
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+		case SDL_MOUSEWHEEL:
+		case SDL_CONTROLLERAXISMOTION:
+		case SDL_CONTROLLERBUTTONDOWN:
+		case SDL_CONTROLLERBUTTONUP:
+			return true;
+	}
+	return false;
+}
+
 void handleEvent(SDL_Event& Event)
 {
 	TFE_Ui::setUiInput(&Event);
@@ -151,9 +174,17 @@ void handleEvent(SDL_Event& Event)
 				else if (code == KeyboardCode::KEY_F2 && (TFE_Input::keyDown(KEY_LALT) || TFE_Input::keyDown(KEY_RALT)))
 				{
 					static u64 _gifIndex = 0;
-					static bool _recording = false;
 
-					if (!_recording)
+					// The 8-bit recording stops by itself when the resolution changes, so ask the recorders instead of tracking the state here.
+					if (TFE_Jedi::vfb_isRecording())
+					{
+						TFE_Jedi::vfb_endRecording();
+					}
+					else if (TFE_RenderBackend::isGifRecording())
+					{
+						TFE_RenderBackend::stopGifRecording();
+					}
+					else
 					{
 						char screenshotDir[TFE_MAX_PATH];
 						TFE_Paths::appendPath(TFE_PathType::PATH_USER_DOCUMENTS, "Screenshots/", screenshotDir);
@@ -162,13 +193,12 @@ void handleEvent(SDL_Event& Event)
 						sprintf(gifPath, "%stfe_gif_%s_%llu.gif", screenshotDir, s_screenshotTime, _gifIndex);
 						_gifIndex++;
 
-						TFE_RenderBackend::startGifRecording(gifPath);
-						_recording = true;
-					}
-					else
-					{
-						TFE_RenderBackend::stopGifRecording();
-						_recording = false;
+						// The software renderer can record its 8-bit output directly, without GPU readback or color quantization.
+						const bool indexedRecording = s_curGame && TFE_Settings::getGraphicsSettings()->indexedGifRecording && TFE_Jedi::vfb_beginRecording(gifPath);
+						if (!indexedRecording)
+						{
+							TFE_RenderBackend::startGifRecording(gifPath);
+						}
 					}
 				}
 			}
@@ -445,6 +475,7 @@ int main(int argc, char* argv[])
 	TFE_CrashHandler::setProcessExceptionHandlers();
 	TFE_CrashHandler::setThreadExceptionHandlers();
 	#endif
+	TFE_Profiler::setThreadName("Main");
 
 	// Paths
 	bool pathsSet = true;
@@ -515,6 +546,7 @@ int main(int argc, char* argv[])
 	TFE_Settings_Window* windowSettings = TFE_Settings::getWindowSettings();
 	TFE_Settings_Graphics* graphics = TFE_Settings::getGraphicsSettings();
 	TFE_System::init(s_refreshRate, graphics->vsync, c_gitVersion);
+	TFE_FrameLatency::init();
 	
 	// Setup the GPU Device and Window.
 	u32 windowFlags = 0;
@@ -543,6 +575,7 @@ int main(int argc, char* argv[])
 	TFE_FrontEndUI::initConsole();
 	TFE_Audio::init();
 	TFE_MidiPlayer::init();
+	TFE_Jobs::init();
 	TFE_Polygon::init();
 	TFE_Image::init();
 	TFE_Jedi::inf_init();
@@ -561,14 +594,35 @@ int main(int argc, char* argv[])
 	// Optional Reticle.
 	reticle_init();
 
+	// Benchmark mode: skip the menus and launch the level directly.
+	char benchLevelArg[TFE_MAX_PATH];
+	char* benchArgs[] = { argv[0], benchLevelArg, (char*)"-c0" };
+	if (TFE_Benchmark::isActive() && TFE_Benchmark::start())
+	{
+		// Vsync would hide the real frame times.
+		TFE_RenderBackend::enableVsync(false);
+
+		sprintf(benchLevelArg, "-l%s", TFE_Benchmark::getSettings()->level);
+		TFE_FrontEndUI::setAppState(APP_STATE_GAME);
+		setAppState(APP_STATE_GAME, TFE_ARRAYSIZE(benchArgs), benchArgs);
+		if (s_curState != APP_STATE_GAME)
+		{
+			TFE_Benchmark::fail("Cannot run the game.");
+		}
+	}
+
 	// Game loop
 	u32 frame = 0u;
 	bool showPerf = false;
 	bool relativeMode = false;
 	TFE_System::logWrite(LOG_MSG, "Progam Flow", "The Force Engine Game Loop Started");
-	while (s_loop && !TFE_System::quitMessagePosted())
+	while (s_loop && !TFE_System::quitMessagePosted() && !TFE_Benchmark::isComplete())
 	{
 		TFE_FRAME_BEGIN();
+		TFE_Benchmark::frameBegin();
+		// Low latency mode waits here, before input is sampled.
+		TFE_FrameLatency::enableLowLatency(graphics->lowLatencyMode && !TFE_Benchmark::isActive());
+		TFE_FrameLatency::frameBegin();
 		
 		bool enableRelative = TFE_Input::relativeModeEnabled();
 		if (enableRelative != relativeMode)
@@ -579,7 +633,14 @@ int main(int argc, char* argv[])
 
 		// System events
 		SDL_Event event;
-		while (SDL_PollEvent(&event)) { handleEvent(event); }
+		while (SDL_PollEvent(&event))
+		{
+			if (isInputEvent(event))
+			{
+				TFE_FrameLatency::inputEvent(SDL_GetTicks() - event.common.timestamp);
+			}
+			handleEvent(event);
+		}
 
 		// Handle mouse state.
 		s32 mouseX, mouseY;
@@ -588,7 +649,12 @@ int main(int argc, char* argv[])
 		SDL_GetMouseState(&mouseAbsX, &mouseAbsY);
 		TFE_Input::setRelativeMousePos(mouseX, mouseY);
 		TFE_Input::setMousePos(mouseAbsX, mouseAbsY);
-		inputMapping_updateInput();
+		// Benchmark runs are not affected by the mouse or keyboard.
+		if (!TFE_Benchmark::isActive())
+		{
+			inputMapping_updateInput();
+		}
+		TFE_FrameLatency::stamp(LSTAMP_INPUT);
 
 		AppState appState = TFE_FrontEndUI::update();
 		if (appState == APP_STATE_QUIT)
@@ -690,12 +756,23 @@ int main(int argc, char* argv[])
 			{
 				s_curGame->loopGame();
 				endInputFrame = TFE_Jedi::task_run() != 0;
+				// The input is consumed once the input frame ends, the game may still render in endFrame().
+				if (endInputFrame)
+				{
+					TFE_FrameLatency::stamp(LSTAMP_SIM_END);
+				}
+				s_curGame->endFrame();
 			}
 		}
 		else
 		{
 			TFE_RenderBackend::clearWindow();
 		}
+		// The input is consumed once the input frame ends.
+		if (endInputFrame && s_curState != APP_STATE_GAME)
+		{
+			TFE_FrameLatency::stamp(LSTAMP_SIM_END);
+		}
 		TFE_FrontEndUI::draw(s_curState == APP_STATE_MENU || s_curState == APP_STATE_NO_GAME_DATA, s_curState == APP_STATE_NO_GAME_DATA);
 
 		bool swap = s_curState != APP_STATE_EDITOR && (s_curState != APP_STATE_MENU || TFE_FrontEndUI::isConfigMenuOpen());
@@ -719,8 +796,19 @@ int main(int argc, char* argv[])
 		{
 			TFE_FRAME_END();
 		}
+		TFE_Benchmark::frameEnd();
+	}
+
+	// Scripts running the benchmark rely on the exit code to detect failed or interrupted runs.
+	bool benchmarkFailed = false;
+	if (TFE_Benchmark::isActive())
+	{
+		TFE_Benchmark::writeResults();
+		benchmarkFailed = !TFE_Benchmark::succeeded();
 	}
 
+	// Finish the GIF if the application is closed while recording.
+	TFE_Jedi::vfb_endRecording();
 	if (s_curGame)
 	{
 		freeGame(s_curGame);
@@ -734,6 +822,7 @@ int main(int argc, char* argv[])
 	TFE_FrontEndUI::shutdown();
 	TFE_Audio::shutdown();
 	TFE_MidiPlayer::destroy();
+	TFE_Jobs::shutdown();
 	TFE_Polygon::shutdown();
 	TFE_Image::shutdown();
 	TFE_Jedi::inf_shutdown();
@@ -745,7 +834,7 @@ int main(int argc, char* argv[])
 		
 	TFE_System::logWrite(LOG_MSG, "Progam Flow", "The Force Engine Game Loop Ended.");
 	TFE_System::logClose();
-	return PROGRAM_SUCCESS;
+	return benchmarkFailed ? PROGRAM_ERROR : PROGRAM_SUCCESS;
 }
 
 // TODO: Implement the various options.
@@ -809,5 +898,43 @@ void parseOption(const char* name, const std::vector<const char*>& values, bool
 			// --nocutscenes
 			TFE_System::logWrite(LOG_MSG, "CommandLine", "Disable cutscenes and title screen.");
 		}
+		else if (strcasecmp(name, "benchmark") == 0 && values.size() >= 1)	// Run a deterministic benchmark on a level and exit.
+		{
+			// --benchmark SECBASE 1000
+			const s32 frameCount = values.size() >= 2 ? strtol(values[1], nullptr, 10) : 0;
+			TFE_Benchmark::enable(values[0], frameCount);
+			TFE_System::logWrite(LOG_MSG, "CommandLine", "Benchmark level: %s", values[0]);
+		}
+		else if (strcasecmp(name, "benchmark-renderer") == 0 && values.size() >= 1)
+		{
+			// --benchmark-renderer fixed|float
+			TFE_Benchmark::getSettings()->floatRenderer = strcasecmp(values[0], "float") == 0;
+		}
+		else if (strcasecmp(name, "benchmark-res") == 0 && values.size() >= 2)
+		{
+			// --benchmark-res 1280 800
+			TFE_Benchmark::getSettings()->width  = strtol(values[0], nullptr, 10);
+			TFE_Benchmark::getSettings()->height = strtol(values[1], nullptr, 10);
+		}
+		else if (strcasecmp(name, "benchmark-path") == 0 && values.size() >= 1)
+		{
+			// --benchmark-path path.txt
+			strncpy(TFE_Benchmark::getSettings()->pathFile, values[0], TFE_MAX_PATH - 1);
+		}
+		else if (strcasecmp(name, "benchmark-out") == 0 && values.size() >= 1)
+		{
+			// --benchmark-out results.json
+			strncpy(TFE_Benchmark::getSettings()->outputFile, values[0], TFE_MAX_PATH - 1);
+		}
+		else if (strcasecmp(name, "benchmark-warmup") == 0 && values.size() >= 1)
+		{
+			// --benchmark-warmup 60
+			TFE_Benchmark::getSettings()->warmupFrames = strtol(values[0], nullptr, 10);
+		}
+		else if (strcasecmp(name, "benchmark-tickrate") == 0 && values.size() >= 1)
+		{
+			// --benchmark-tickrate 60
+			TFE_Benchmark::getSettings()->tickRate = strtod(values[0], nullptr);
+		}
 	}
 }
\ No newline at end of file